@@ -0,0 +1,126 @@
+#include <benchmark.h>
+#include <stdio.h>
+
+// This example compares the time it takes to iterate a rule with the time it
+// takes to iterate a cached query with the same terms. Cached queries store the
+// list of matched tables, whereas rules evaluate their program each time they
+// are iterated, which makes them more flexible but also slower to iterate.
+//
+// Run the example in release mode to get meaningful numbers.
+
+#define ENTITY_COUNT (100 * 1000)
+#define TAG_COUNT (8) // Creates 2^TAG_COUNT tables
+#define ITERATIONS (1000)
+
+typedef struct {
+    double x, y;
+} Position, Velocity;
+
+typedef struct {
+    double value;
+} Mass;
+
+static
+int32_t iterate(ecs_iter_t *it, bool (*next)(ecs_iter_t*)) {
+    int32_t count = 0;
+    while (next(it)) {
+        Position *p = ecs_field(it, Position, 1);
+        Velocity *v = ecs_field(it, Velocity, 2);
+        for (int i = 0; i < it->count; i ++) {
+            p[i].x += v[i].x;
+            p[i].y += v[i].y;
+        }
+        count += it->count;
+    }
+    return count;
+}
+
+static
+void benchmark(ecs_world_t *ecs, const char *expr) {
+    ecs_rule_t *r = ecs_rule(ecs, { .expr = expr });
+    ecs_query_t *q = ecs_query(ecs, { .filter.expr = expr });
+    if (!r || !q) {
+        printf("failed to create rule or query for '%s'\n", expr);
+        return;
+    }
+
+    ecs_time_t t = {0};
+    int32_t rule_count = 0, query_count = 0;
+
+    ecs_time_measure(&t);
+    for (int i = 0; i < ITERATIONS; i ++) {
+        ecs_iter_t it = ecs_rule_iter(ecs, r);
+        rule_count += iterate(&it, ecs_rule_next);
+    }
+    double rule_time = ecs_time_measure(&t);
+
+    for (int i = 0; i < ITERATIONS; i ++) {
+        ecs_iter_t it = ecs_query_iter(ecs, q);
+        query_count += iterate(&it, ecs_query_next);
+    }
+    double query_time = ecs_time_measure(&t);
+
+    // Both should have iterated the same entities
+    if (rule_count != query_count) {
+        printf("result mismatch for '%s' (rule: %d, query: %d)\n",
+            expr, rule_count, query_count);
+    }
+
+    rule_time = (rule_time * 1000 * 1000) / ITERATIONS;
+    query_time = (query_time * 1000 * 1000) / ITERATIONS;
+
+    printf("%-46s  rule: %8.2fus  query: %8.2fus  (%.2fx)\n", expr,
+        rule_time, query_time, rule_time / query_time);
+
+    ecs_query_fini(q);
+    ecs_rule_fini(r);
+}
+
+int main(int argc, char *argv[]) {
+    ecs_world_t *ecs = ecs_init_w_args(argc, argv);
+
+    ECS_COMPONENT(ecs, Position);
+    ECS_COMPONENT(ecs, Velocity);
+    ECS_COMPONENT(ecs, Mass);
+
+    ecs_entity_t tags[TAG_COUNT];
+    for (int i = 0; i < TAG_COUNT; i ++) {
+        tags[i] = ecs_new_id(ecs);
+    }
+
+    ecs_entity_t parent = ecs_new_id(ecs);
+
+    // Spread entities out across tables so that iteration has to visit many
+    // tables, which is where rules and queries differ most.
+    for (int i = 0; i < ENTITY_COUNT; i ++) {
+        ecs_entity_t e = ecs_new_id(ecs);
+        ecs_set(ecs, e, Position, {0, 0});
+        ecs_set(ecs, e, Velocity, {1, 1});
+        if (i % 2) {
+            ecs_set(ecs, e, Mass, {1});
+        }
+        if (i % 4) {
+            ecs_add_pair(ecs, e, EcsChildOf, parent);
+        }
+        for (int t = 0; t < TAG_COUNT; t ++) {
+            if (i & (1 << t)) {
+                ecs_add_id(ecs, e, tags[t]);
+            }
+        }
+    }
+
+    benchmark(ecs, "Position, Velocity");
+    benchmark(ecs, "Position(self), Velocity(self)");
+    benchmark(ecs, "Position, Velocity, Mass");
+    benchmark(ecs, "Position, Velocity, !Mass");
+    benchmark(ecs, "Position, Velocity, ?Mass");
+    benchmark(ecs, "Position, Velocity, (ChildOf, *)");
+    benchmark(ecs, "Position(self), Velocity(self), (ChildOf, *)");
+
+    // Output (numbers depend on the machine and build):
+    //  Position, Velocity                              rule:   139.53us  query:   134.26us  (1.04x)
+    //  Position(self), Velocity(self)                  rule:   148.88us  query:   142.94us  (1.04x)
+    //  ...
+
+    return ecs_fini(ecs);
+}
@@ -0,0 +1,16 @@
+#ifndef SYNC_OVERHEAD_H
+#define SYNC_OVERHEAD_H
+
+/* This generated file contains includes for project dependencies */
+#include "sync_overhead/bake_config.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
+
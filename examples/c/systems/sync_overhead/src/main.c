@@ -0,0 +1,100 @@
+#include <sync_overhead.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+// This example is a microbenchmark that measures the overhead of synchronizing
+// worker threads between pipeline operations. It creates a pipeline with many
+// short multi threaded systems that are each separated by a sync point, and 
+// measures how long it takes to run a single operation with the different 
+// worker scheduling strategies.
+//
+// Usage: sync_overhead [threads] [entities]
+
+#define SYSTEM_COUNT (64)
+#define FRAME_COUNT (1000)
+
+typedef struct {
+    double x, y;
+} Position;
+
+ECS_COMPONENT_DECLARE(Position);
+ECS_DECLARE(Sync);
+
+void Move(ecs_iter_t *it) {
+    Position *p = ecs_field(it, Position, 1);
+
+    for (int i = 0; i < it->count; i ++) {
+        p[i].x ++;
+        p[i].y ++;
+    }
+}
+
+double measure(ecs_worker_sched_kind_t sched, int threads, int entities) {
+    ecs_world_t *ecs = ecs_init();
+
+    ECS_COMPONENT_DEFINE(ecs, Position);
+    ECS_TAG_DEFINE(ecs, Sync);
+
+    // Each system reads & writes the Sync tag without matching it on entities,
+    // which causes the pipeline to insert a sync point between each system.
+    for (int i = 0; i < SYSTEM_COUNT; i ++) {
+        ecs_system(ecs, {
+            .entity = ecs_entity(ecs, { .add = { ecs_dependson(EcsOnUpdate) }}),
+            .query.filter.terms = {
+                { .id = ecs_id(Position) },
+                { .id = Sync, .src.flags = EcsIsEntity, .inout = EcsInOut }
+            },
+            .callback = Move,
+            .multi_threaded = true
+        });
+    }
+
+    for (int i = 0; i < entities; i ++) {
+        ecs_set(ecs, 0, Position, {0, 0});
+    }
+
+    ecs_set_worker_sched(ecs, sched);
+    ecs_set_threads(ecs, threads);
+
+    // Warm up caches & build pipeline
+    ecs_progress(ecs, 0);
+
+    ecs_time_t t = {0};
+    ecs_time_measure(&t);
+
+    for (int i = 0; i < FRAME_COUNT; i ++) {
+        ecs_progress(ecs, 0);
+    }
+
+    double elapsed = ecs_time_measure(&t);
+
+    ecs_fini(ecs);
+
+    return elapsed / (FRAME_COUNT * SYSTEM_COUNT);
+}
+
+int main(int argc, char *argv[]) {
+    int threads = 4, entities = 1000;
+    if (argc > 1) {
+        threads = atoi(argv[1]);
+    }
+    if (argc > 2) {
+        entities = atoi(argv[2]);
+    }
+
+    printf("threads: %d, entities: %d, ops per frame: %d\n", 
+        threads, entities, SYSTEM_COUNT);
+
+    double slice = measure(EcsWorkerSchedSlice, threads, entities);
+    printf("slice:    %.3f us/op\n", slice * 1000 * 1000);
+
+    double stealing = measure(EcsWorkerSchedStealing, threads, entities);
+    printf("stealing: %.3f us/op\n", stealing * 1000 * 1000);
+
+    // Output (numbers depend on hardware):
+    //  threads: 4, entities: 1000, ops per frame: 64
+    //  slice:    ... us/op
+    //  stealing: ... us/op
+
+    return 0;
+}
@@ -202,6 +202,72 @@ void flecs_entity_index_restore(
 
 #endif
 
+/**
+ * @file datastructures/block_allocator_cache.h
+ * @brief Magazine caches for block allocators.
+ */
+
+#ifndef FLECS_BLOCK_ALLOCATOR_CACHE_H
+#define FLECS_BLOCK_ALLOCATOR_CACHE_H
+
+/** Number of chunks that fit in a single magazine */
+#define FLECS_BALLOC_MAGAZINE_SIZE (32)
+
+typedef struct ecs_balloc_magazine_t {
+    struct ecs_balloc_magazine_t *next;
+    int32_t count;
+    void *chunks[FLECS_BALLOC_MAGAZINE_SIZE];
+} ecs_balloc_magazine_t;
+
+/* A depot owns a block allocator and can be shared between threads. Chunks are
+ * exchanged with the depot in full magazines, so the lock is only taken once
+ * per FLECS_BALLOC_MAGAZINE_SIZE allocations or frees. */
+typedef struct ecs_balloc_depot_t {
+    ecs_block_allocator_t ba;
+    ecs_os_mutex_t lock;
+    ecs_balloc_magazine_t *full;     /* Magazines with count == SIZE */
+    ecs_balloc_magazine_t *empty;    /* Magazines with count == 0 */
+    int32_t full_count;
+    int32_t empty_count;
+} ecs_balloc_depot_t;
+
+/* A cache is owned by a single thread (or stage) and holds two magazines, which
+ * absorbs alternating alloc/free patterns without going to the depot. */
+typedef struct ecs_balloc_cache_t {
+    ecs_balloc_depot_t *depot;
+    ecs_balloc_magazine_t *loaded;
+    ecs_balloc_magazine_t *previous;
+} ecs_balloc_cache_t;
+
+FLECS_DBG_API
+void flecs_balloc_depot_init(
+    ecs_balloc_depot_t *depot,
+    ecs_size_t size);
+
+FLECS_DBG_API
+void flecs_balloc_depot_fini(
+    ecs_balloc_depot_t *depot);
+
+FLECS_DBG_API
+void flecs_balloc_cache_init(
+    ecs_balloc_cache_t *cache,
+    ecs_balloc_depot_t *depot);
+
+FLECS_DBG_API
+void flecs_balloc_cache_fini(
+    ecs_balloc_cache_t *cache);
+
+FLECS_DBG_API
+void* flecs_balloc_cache_alloc(
+    ecs_balloc_cache_t *cache);
+
+FLECS_DBG_API
+void flecs_balloc_cache_free(
+    ecs_balloc_cache_t *cache,
+    void *memory);
+
+#endif
+
 /**
  * @file datastructures/stack_allocator.h
  * @brief Stack allocator.
@@ -220,10 +286,16 @@ typedef struct ecs_stack_page_t {
     uint32_t id;
 } ecs_stack_page_t;
 
+/* Pages are allocated with the page header in front of the page data */
+#define FLECS_STACK_PAGE_OFFSET ECS_ALIGN(ECS_SIZEOF(ecs_stack_page_t), 16)
+#define FLECS_STACK_PAGE_ALLOC_SIZE\
+    (FLECS_STACK_PAGE_OFFSET + ECS_STACK_PAGE_SIZE)
+
 typedef struct ecs_stack_t {
     ecs_stack_page_t first;
     ecs_stack_page_t *tail_page;
     ecs_stack_cursor_t *tail_cursor;
+    ecs_balloc_cache_t *cache;   /* Optional page cache, uses OS if NULL */
 #ifdef FLECS_DEBUG
     int32_t cursor_count;
 #endif
@@ -233,6 +305,13 @@ FLECS_DBG_API
 void flecs_stack_init(
     ecs_stack_t *stack);
 
+/* Initialize stack that gets its pages from a (thread local) page cache. The
+ * cache must have a depot with chunks of FLECS_STACK_PAGE_ALLOC_SIZE. */
+FLECS_DBG_API
+void flecs_stack_init_w_cache(
+    ecs_stack_t *stack,
+    ecs_balloc_cache_t *cache);
+
 FLECS_DBG_API
 void flecs_stack_fini(
     ecs_stack_t *stack);
@@ -630,6 +709,11 @@ typedef struct ecs_table_event_t {
      * initializing an event a bit simpler. */
 } ecs_table_event_t;
 
+/* Allocator used for component column storage */
+#define flecs_column_allocator(world)\
+    (((world)->flags & EcsWorldAlignedColumns) ?\
+        &(world)->column_allocator : &(world)->allocator)
+
 /** Infrequently accessed data not stored inline in ecs_table_t */
 typedef struct ecs_table__t {
     uint64_t hash;                   /* Type hash */
@@ -648,6 +732,9 @@ typedef struct ecs_table__t {
     int16_t bs_count;
     int16_t bs_offset;
     int16_t ft_offset;
+
+    ecs_id_signature_t signature;    /* Signature of ids in table type */
+    ecs_vec_t row_versions;          /* Per row dirty state, see flecs_table_init_row_versions */
 } ecs_table__t;
 
 /** Table column */
@@ -656,6 +743,7 @@ typedef struct ecs_column_t {
     ecs_id_t id;                     /* Component id */
     ecs_type_info_t *ti;             /* Component type info */
     ecs_size_t size;                 /* Component size */
+    ecs_size_t reserved;             /* Reserved bytes for vmem column */
 } ecs_column_t;
 
 /** Table data */
@@ -686,6 +774,16 @@ struct ecs_table_t {
     ecs_table__t *_;                 /* Infrequently accessed table metadata */
 };
 
+/* Add id to signature */
+void flecs_id_signature_add(
+    ecs_id_signature_t *sig,
+    ecs_id_t id);
+
+/* Test if signature (possibly) contains all ids of another signature */
+bool flecs_id_signature_has(
+    const ecs_id_signature_t *sig,
+    const ecs_id_signature_t *ids);
+
 /* Init table */
 void flecs_table_init(
     ecs_world_t *world,
@@ -767,6 +865,23 @@ void flecs_table_move(
     int32_t old_index,
     bool construct);
 
+/* Delete a range of entities from the table. */
+void flecs_table_delete_range(
+    ecs_world_t *world,
+    ecs_table_t *table,
+    int32_t index,
+    int32_t count,
+    bool destruct);
+
+/* Move a range of rows from one table to another */
+int32_t flecs_table_move_range(
+    ecs_world_t *world,
+    ecs_table_t *dst_table,
+    ecs_table_t *src_table,
+    int32_t src_index,
+    int32_t count,
+    bool construct);
+
 /* Grow table with specified number of records. Populate table with entities,
  * starting from specified entity id. */
 int32_t flecs_table_appendn(
@@ -783,11 +898,24 @@ void flecs_table_set_size(
     ecs_data_t *data,
     int32_t count);
 
+/* Reserve storage for count entities that are added to table */
+void flecs_table_reserve(
+    ecs_world_t *world,
+    ecs_table_t *table,
+    int32_t count);
+
 /* Shrink table to contents */
 bool flecs_table_shrink(
     ecs_world_t *world,
     ecs_table_t *table);
 
+/* Move column storage of table from one allocator to another */
+void flecs_table_move_columns(
+    ecs_world_t *world,
+    ecs_table_t *table,
+    ecs_allocator_t *dst,
+    ecs_allocator_t *src);
+
 /* Get dirty state for table columns */
 int32_t* flecs_table_get_dirty_state(
     ecs_world_t *world,
@@ -835,8 +963,27 @@ void flecs_table_swap(
 void flecs_table_mark_dirty(
     ecs_world_t *world,
     ecs_table_t *table,
+    int32_t row,
     ecs_entity_t component);
 
+/* Enable per-row change tracking for table */
+void flecs_table_init_row_versions(
+    ecs_world_t *world,
+    ecs_table_t *table);
+
+/* Get row versions for row. Returns NULL if table does not track versions. */
+int32_t* flecs_table_row_versions(
+    const ecs_table_t *table,
+    int32_t row);
+
+/* Stamp column of range of rows with value */
+void flecs_table_stamp_rows(
+    ecs_table_t *table,
+    int32_t column,
+    int32_t offset,
+    int32_t count,
+    int32_t value);
+
 void flecs_table_notify(
     ecs_world_t *world,
     ecs_table_t *table,
@@ -989,6 +1136,13 @@ typedef struct ecs_entity_filter_iter_t {
     int32_t sw_smallest;
     int32_t flat_tree_offset;
     int32_t target_count;
+
+    /* Range returned by iterator that is split up by sparse terms */
+    int32_t sparse_offset;
+    int32_t sparse_count;
+    int32_t sparse_row;
+    int32_t sparse_frame_offset;
+    bool sparse_active;
 } ecs_entity_filter_iter_t;
 
 /** Table match data.
@@ -1021,6 +1175,7 @@ typedef struct ecs_query_table_t {
     ecs_query_table_match_t *last;   /* Last discovered match for table */
     uint64_t table_id;
     int32_t rematch_count;           /* Track whether table was rematched */
+    int32_t sorted_count;            /* Number of rows sorted by last sort */
 } ecs_query_table_t;
 
 /** Points to the beginning & ending of a query group */
@@ -1028,6 +1183,9 @@ typedef struct ecs_query_table_list_t {
     ecs_query_table_match_t *first;
     ecs_query_table_match_t *last;
     ecs_query_group_info_t info;
+    int32_t slice_offset;            /* First sorted slice of list */
+    int32_t slice_count;             /* Number of sorted slices of list */
+    bool sort_dirty;                 /* Do sorted slices need to be rebuilt */
 } ecs_query_table_list_t;
 
 /* Query event type for notifying queries of world events */
@@ -1071,6 +1229,7 @@ struct ecs_query_t {
     /* Table sorting */
     ecs_entity_t order_by_component;
     ecs_order_by_action_t order_by;
+    ecs_order_by_key_action_t order_by_key;
     ecs_sort_table_action_t sort_table;
     ecs_vec_t table_slices;
     int32_t order_by_term;
@@ -1155,6 +1314,7 @@ typedef struct ecs_stage_allocators_t {
     ecs_stack_t iter_stack;
     ecs_stack_t deser_stack;
     ecs_block_allocator_t cmd_entry_chunk;
+    ecs_balloc_cache_t stack_pages;  /* Stage cache for world stack pages */
 } ecs_stage_allocators_t;
 
 /** Types for deferred operations */
@@ -1325,6 +1485,12 @@ typedef struct ecs_action_elem_t {
 
 typedef struct ecs_pipeline_state_t ecs_pipeline_state_t;
 
+/* Task that worker threads run outside of a pipeline operation */
+typedef void (*ecs_worker_task_action_t)(
+    ecs_world_t *world,
+    ecs_stage_t *stage,
+    void *ctx);
+
 /** The world stores and manages all ECS data. An application can have more than
  * one world, but data is not shared between worlds. */
 struct ecs_world_t {
@@ -1333,6 +1499,7 @@ struct ecs_world_t {
     /* --  Type metadata -- */
     ecs_id_record_t *id_index_lo;
     ecs_map_t id_index_hi;           /* map<id, ecs_id_record_t*> */
+    ecs_vec_t sparse_ids;            /* vector<ecs_id_record_t*> */
     ecs_sparse_t type_info;          /* sparse<type_id, type_info_t> */
 
     /* -- Cached handle to id records -- */
@@ -1385,13 +1552,24 @@ struct ecs_world_t {
     void *on_commands_ctx;
     void *on_commands_ctx_active;
 
+    /* Internal callback for recording commands. Unlike on_commands, the action
+     * stays active until it is reset, and is only invoked for command queues
+     * that are merged with the world. */
+    ecs_on_commands_action_t on_commands_record;
+    void *on_commands_record_ctx;
+
     /* -- Multithreading -- */
     ecs_os_cond_t worker_cond;       /* Signal that worker threads can start */
     ecs_os_cond_t sync_cond;         /* Signal that worker thread job is done */
     ecs_os_mutex_t sync_mutex;       /* Mutex for job_cond */
     int32_t workers_running;         /* Number of threads running */
     int32_t workers_waiting;         /* Number of workers waiting on sync */
+    int32_t workers_gen;             /* Incremented when workers are signalled */
+    int32_t workers_parked;          /* Number of workers blocked on worker_cond */
+    int32_t sync_parked;             /* Nonzero if main thread blocks on sync_cond */
     ecs_pipeline_state_t* pq;        /* Pointer to the pipeline for the workers to execute */
+    ecs_worker_task_action_t worker_task; /* Task to run instead of pipeline */
+    void *worker_task_ctx;           /* Context passed to worker task */
     bool workers_use_task_api;       /* Workers are short-lived tasks, not long-running threads */
 
     /* -- Time management -- */
@@ -1414,6 +1592,8 @@ struct ecs_world_t {
     /* -- Allocators -- */
     ecs_world_allocators_t allocators; /* Static allocation sizes */
     ecs_allocator_t allocator;       /* Dynamic allocation sizes */
+    ecs_allocator_t column_allocator; /* Aligned allocations for columns */
+    ecs_balloc_depot_t stack_pages;  /* Stack pages shared between stages */
 
     void *ctx;                       /* Application context */
     void *binding_ctx;               /* Binding-specific context */
@@ -1523,9 +1703,7 @@ typedef struct ecs_reachable_elem_t {
     ecs_record_t *record;
     ecs_entity_t src;
     ecs_id_t id;
-#ifndef NDEBUG
     ecs_table_t *table;
-#endif
 } ecs_reachable_elem_t;
 
 typedef struct ecs_reachable_cache_t {
@@ -1534,6 +1712,14 @@ typedef struct ecs_reachable_cache_t {
     ecs_vec_t ids; /* vec<reachable_elem_t> */
 } ecs_reachable_cache_t;
 
+/* Transitive closure of a (R, tgt) record for a traversable relationship. The
+ * index contains the record itself and the (R, e) records for all entities e
+ * that (transitively) have (R, tgt). */
+typedef struct ecs_trav_index_t {
+    int32_t generation; /* Generation of (R, *) record when index was built */
+    ecs_vec_t idrs;     /* vec<ecs_id_record_t*> */
+} ecs_trav_index_t;
+
 /* Payload for id index which contains all data structures for an id. */
 struct ecs_id_record_t {
     /* Cache with all tables that contain the id. Must be first member. */
@@ -1551,6 +1737,9 @@ struct ecs_id_record_t {
     /* Name lookup index (currently only used for ChildOf pairs) */
     ecs_hashmap_t *name_index;
 
+    /* Storage for components with the Sparse trait, indexed by entity */
+    ecs_sparse_t *sparse;
+
     /* Lists for all id records that match a pair wildcard. The wildcard id
      * record is at the head of the list. */
     ecs_id_record_elem_t first;   /* (R, *) */
@@ -1570,6 +1759,13 @@ struct ecs_id_record_t {
 
     /* Cache invalidation counter */
     ecs_reachable_cache_t reachable;
+
+    /* Traversal index for (R, tgt) records of traversable relationships */
+    ecs_trav_index_t *trav_index;
+
+    /* Incremented when the entities with a (R, tgt) pair change. Only used on
+     * (R, *) records, invalidates the traversal indices of (R, tgt) records. */
+    int32_t trav_generation;
 };
 
 /* Get id record for id */
@@ -1577,6 +1773,18 @@ ecs_id_record_t* flecs_id_record_get(
     const ecs_world_t *world,
     ecs_id_t id);
 
+/* Get transitive closure for (R, tgt) record of a traversable relationship.
+ * Returns NULL if the index is out of date and the world is multithreaded, in
+ * which case the closure must be computed by the caller. */
+const ecs_vec_t* flecs_id_record_trav_index(
+    ecs_world_t *world,
+    ecs_id_record_t *idr);
+
+/* Invalidate traversal indices of relationships in type */
+void flecs_id_record_trav_invalidate(
+    ecs_world_t *world,
+    const ecs_type_t *type);
+
 /* Get id record for id for searching.
  * Same as flecs_id_record_get, but replaces (R, *) with (Union, R) if R is a
  * union relationship. */
@@ -1635,6 +1843,27 @@ ecs_table_record_t* flecs_id_record_get_table(
     const ecs_id_record_t *idr,
     const ecs_table_t *table);
 
+/* Get sparse component for entity, NULL if entity doesn't have it */
+void* flecs_id_record_sparse_get(
+    const ecs_id_record_t *idr,
+    ecs_entity_t entity);
+
+/* Test if entity has sparse component */
+bool flecs_id_record_sparse_has(
+    const ecs_id_record_t *idr,
+    ecs_entity_t entity);
+
+/* Insert sparse component for entity. Does not construct the value. */
+void* flecs_id_record_sparse_insert(
+    ecs_world_t *world,
+    ecs_id_record_t *idr,
+    ecs_entity_t entity);
+
+/* Remove sparse component for entity. Does not destruct the value. */
+void flecs_id_record_sparse_remove(
+    ecs_id_record_t *idr,
+    ecs_entity_t entity);
+
 /* Bootstrap cached id records */
 void flecs_init_id_records(
     ecs_world_t *world);
@@ -1738,6 +1967,11 @@ void flecs_iter_populate_data(
 bool flecs_iter_next_row(
     ecs_iter_t *it);
 
+/* Offset entities & component pointers of iterator for This variable */
+void flecs_offset_iter(
+    ecs_iter_t *it,
+    int32_t offset);
+
 bool flecs_iter_next_instanced(
     ecs_iter_t *it,
     bool result);
@@ -2239,6 +2473,19 @@ ecs_entity_t flecs_get_oneof(
     const ecs_world_t *world,
     ecs_entity_t e);
 
+/* Remove all sparse components from an entity */
+void flecs_entity_remove_sparse(
+    ecs_world_t *world,
+    ecs_entity_t entity);
+
+/* Add or remove id for ranges of entities. Ranges may be reordered. */
+void flecs_bulk_add_remove_id(
+    ecs_world_t *world,
+    ecs_table_range_t *ranges,
+    int32_t count,
+    ecs_id_t id,
+    bool remove);
+
 void flecs_notify_on_remove(
     ecs_world_t *world,
     ecs_table_t *table,
@@ -2302,6 +2549,12 @@ bool flecs_term_match_table(
     bool first,
     ecs_flags32_t iter_flags);
 
+/* Test if table can match filter. Returns false if table can't match, true if
+ * table may match. */
+bool flecs_filter_signature_match(
+    const ecs_filter_t *filter,
+    const ecs_table_t *table);
+
 /* Match table with filter */
 bool flecs_filter_match_table(
     ecs_world_t *world,
@@ -2326,6 +2579,25 @@ void flecs_query_notify(
     ecs_query_t *query,
     ecs_query_event_t *event);
 
+/* Rematch queries after component monitors were invalidated. If the world has
+ * worker threads, queries are matched in parallel. */
+void flecs_query_rematch_all(
+    ecs_world_t *world,
+    ecs_query_t **queries,
+    int32_t count);
+
+#ifdef FLECS_PIPELINE
+/* Test if worker threads are idle and can run a task outside of the pipeline */
+bool flecs_workers_can_run_task(
+    const ecs_world_t *world);
+
+/* Run task on all worker threads and the main thread, wait until done */
+void flecs_workers_run_task(
+    ecs_world_t *world,
+    ecs_worker_task_action_t action,
+    void *ctx);
+#endif
+
 ecs_id_t flecs_to_public_id(
     ecs_id_t id);
 
@@ -2414,6 +2686,11 @@ void flecs_entity_filter_fini(
 int flecs_entity_filter_next(
     ecs_entity_filter_iter_t *it);
 
+/* Split up results of an iterator into ranges that match sparse terms */
+bool flecs_sparse_filter_next(
+    ecs_iter_t *it,
+    ecs_iter_next_action_t next);
+
 ////////////////////////////////////////////////////////////////////////////////
 //// Utilities
 ////////////////////////////////////////////////////////////////////////////////
@@ -2855,6 +3132,22 @@ void flecs_register_union(ecs_iter_t *it) {
     flecs_register_id_flag_for_relation(it, EcsUnion, EcsIdUnion, 0, 0);
 }
 
+static
+void flecs_register_sparse(ecs_iter_t *it) {
+    ecs_world_t *world = it->world;
+
+    int i, count = it->count;
+    for (i = 0; i < count; i ++) {
+        ecs_entity_t e = it->entities[i];
+        ecs_id_record_t *idr = flecs_id_record_ensure(world, e);
+        if (flecs_set_id_flag(idr, EcsIdSparse)) {
+            flecs_assert_relation_unused(world, e, EcsSparse);
+            ecs_vec_append_t(&world->allocator, &world->sparse_ids,
+                ecs_id_record_t*)[0] = idr;
+        }
+    }
+}
+
 static
 void flecs_register_slot_of(ecs_iter_t *it) {
     int i, count = it->count;
@@ -3161,6 +3454,7 @@ ecs_table_t* flecs_bootstrap_component_table(
     /* Preallocate enough memory for initial components */
     ecs_allocator_t *a = &world->allocator;
     ecs_vec_init_t(a, &data->entities, ecs_entity_t, EcsFirstUserComponentId);
+    a = flecs_column_allocator(world);
     ecs_vec_init_t(a, &data->columns[0].data, EcsComponent, EcsFirstUserComponentId);
     ecs_vec_init_t(a, &data->columns[1].data, EcsIdentifier, EcsFirstUserComponentId);
     ecs_vec_init_t(a, &data->columns[2].data, EcsIdentifier, EcsFirstUserComponentId);
@@ -3340,6 +3634,7 @@ void flecs_bootstrap(
     flecs_bootstrap_trait(world, EcsAlwaysOverride);
     flecs_bootstrap_trait(world, EcsTag);
     flecs_bootstrap_trait(world, EcsUnion);
+    flecs_bootstrap_trait(world, EcsSparse);
     flecs_bootstrap_trait(world, EcsExclusive);
     flecs_bootstrap_trait(world, EcsAcyclic);
     flecs_bootstrap_trait(world, EcsTraversable);
@@ -3501,6 +3796,12 @@ void flecs_bootstrap(
         .callback = flecs_register_union
     });
 
+    ecs_observer(world, {
+        .filter.terms = {{ .id = EcsSparse, .src.flags = EcsSelf }, match_prefab },
+        .events = {EcsOnAdd},
+        .callback = flecs_register_sparse
+    });
+
     /* Entities used as slot are marked as exclusive to ensure a slot can always
      * only point to a single entity. */
     ecs_observer(world, {
@@ -3587,6 +3888,415 @@ void flecs_bootstrap(
     ecs_log_pop();
 }
 
+/**
+ * @file cmd_queue.c
+ * @brief Multi producer, single consumer command queue.
+ *
+ * A command queue allows threads that are not managed by flecs to enqueue
+ * commands without locking. The queue is a fixed size ring of command slots.
+ * Each slot has a sequence number that indicates whether it can be written by
+ * a producer or read by the consumer, which removes the need for a lock:
+ *
+ * - a producer claims an index by atomically incrementing the queue head. The
+ *   slot for that index can be written when its sequence equals the index.
+ * - after writing the command, the producer increments the sequence, which
+ *   makes the slot visible to the consumer.
+ * - the consumer applies commands in index order until it finds a slot that
+ *   hasn't been published yet. After a command is applied, the sequence of the
+ *   slot is set to the index that can use the slot in the next round.
+ *
+ * Component values are stored in a value arena that reserves a fixed number of
+ * bytes per slot, so that enqueueing small values does not allocate.
+ */
+
+
+#define ECS_CMD_QUEUE_DEFAULT_CAPACITY (4096)
+#define ECS_CMD_QUEUE_DEFAULT_VALUE_SIZE (64)
+
+typedef struct ecs_cmd_queue_slot_t {
+    int64_t seq;                     /* Index that can use the slot */
+    ecs_cmd_t cmd;                   /* Enqueued command */
+    ecs_entity_t event;              /* Event (used by event commands) */
+} ecs_cmd_queue_slot_t;
+
+struct ecs_cmd_queue_t {
+    ecs_world_t *world;
+    ecs_cmd_queue_slot_t *slots;
+    char *values;                    /* Value arena with value_size per slot */
+    int32_t capacity;
+    ecs_size_t value_size;
+    int64_t head;                    /* Next index claimed by a producer */
+    int64_t tail;                    /* Next index read by the consumer */
+    ecs_entity_t system;             /* System that drains queue (optional) */
+};
+
+static
+int64_t flecs_cmd_queue_load(
+    int64_t *value)
+{
+    return *(volatile int64_t*)value;
+}
+
+static
+ecs_cmd_queue_slot_t* flecs_cmd_queue_claim(
+    ecs_cmd_queue_t *queue,
+    ecs_cmd_kind_t kind,
+    ecs_entity_t entity,
+    ecs_id_t id)
+{
+    int64_t tail = flecs_cmd_queue_load(&queue->tail);
+    if ((flecs_cmd_queue_load(&queue->head) - tail) >= queue->capacity) {
+        return NULL;
+    }
+
+    int64_t index = ecs_os_lainc(&queue->head) - 1;
+    ecs_cmd_queue_slot_t *slot = &queue->slots[index % queue->capacity];
+
+    /* If multiple producers raced for the last free slots, the slot may still
+     * hold a command from the previous round. Wait until it's consumed. */
+    while (flecs_cmd_queue_load(&slot->seq) != index) { }
+
+    ecs_cmd_t *cmd = &slot->cmd;
+    cmd->kind = kind;
+    cmd->entity = entity;
+    cmd->id = id;
+    cmd->is._1.value = NULL;
+    cmd->is._1.size = 0;
+    slot->event = 0;
+    return slot;
+}
+
+static
+bool flecs_cmd_queue_publish(
+    ecs_cmd_queue_slot_t *slot)
+{
+    /* Atomic increment acts as barrier, so the command is fully written before
+     * the consumer can observe the new sequence. */
+    ecs_os_lainc(&slot->seq);
+    return true;
+}
+
+static
+void* flecs_cmd_queue_value(
+    ecs_cmd_queue_t *queue,
+    ecs_cmd_queue_slot_t *slot)
+{
+    int32_t index = flecs_ito(int32_t, slot - queue->slots);
+    return ECS_OFFSET(queue->values, queue->value_size * index);
+}
+
+static
+void flecs_cmd_queue_value_free(
+    ecs_cmd_queue_t *queue,
+    ecs_cmd_queue_slot_t *slot)
+{
+    void *value = slot->cmd.is._1.value;
+    if (value && value != flecs_cmd_queue_value(queue, slot)) {
+        ecs_os_free(value);
+    }
+}
+
+static
+void flecs_cmd_queue_apply(
+    ecs_world_t *world,
+    ecs_cmd_queue_slot_t *slot)
+{
+    ecs_cmd_t *cmd = &slot->cmd;
+    ecs_entity_t e = cmd->entity;
+    if (!e || !ecs_is_valid(world, e)) {
+        return;
+    }
+
+    switch(cmd->kind) {
+    case EcsCmdAdd:
+        ecs_add_id(world, e, cmd->id);
+        break;
+    case EcsCmdRemove:
+        ecs_remove_id(world, e, cmd->id);
+        break;
+    case EcsCmdSet:
+        ecs_set_id(world, e, cmd->id,
+            flecs_ito(size_t, cmd->is._1.size), cmd->is._1.value);
+        break;
+    case EcsCmdDelete:
+        ecs_delete(world, e);
+        break;
+    case EcsCmdEvent: {
+        ecs_event_desc_t desc = {
+            .event = slot->event,
+            .ids = &(ecs_type_t){ .array = &cmd->id, .count = 1 },
+            .entity = e
+        };
+        /* Enqueue event when deferred so it's emitted after the commands that
+         * were drained before it. */
+        if (ecs_is_deferred(world)) {
+            ecs_enqueue(world, &desc);
+        } else {
+            ecs_emit(world, &desc);
+        }
+        break;
+    }
+    case EcsCmdClone:
+    case EcsCmdBulkNew:
+    case EcsCmdEmplace:
+    case EcsCmdEnsure:
+    case EcsCmdModified:
+    case EcsCmdModifiedNoHook:
+    case EcsCmdAddModified:
+    case EcsCmdPath:
+    case EcsCmdClear:
+    case EcsCmdOnDeleteAction:
+    case EcsCmdEnable:
+    case EcsCmdDisable:
+    case EcsCmdSkip:
+    default:
+        ecs_abort(ECS_INTERNAL_ERROR, NULL);
+    }
+}
+
+#ifdef FLECS_PIPELINE
+static
+void flecs_cmd_queue_drain_system(
+    ecs_iter_t *it)
+{
+    ecs_cmd_queue_drain(it->world, it->ctx);
+}
+#endif
+
+ecs_cmd_queue_t* ecs_cmd_queue_new(
+    ecs_world_t *world,
+    const ecs_cmd_queue_desc_t *desc)
+{
+    ecs_poly_assert(world, ecs_world_t);
+    ecs_check(ecs_os_api.lainc_ != NULL, ECS_MISSING_OS_API, "lainc");
+
+    ecs_cmd_queue_desc_t default_desc = {0};
+    if (!desc) {
+        desc = &default_desc;
+    }
+
+    ecs_check(desc->capacity >= 0, ECS_INVALID_PARAMETER, NULL);
+    ecs_check(desc->value_size >= 0, ECS_INVALID_PARAMETER, NULL);
+
+    ecs_cmd_queue_t *queue = ecs_os_calloc_t(ecs_cmd_queue_t);
+    queue->world = world;
+    queue->capacity = desc->capacity;
+    if (!queue->capacity) {
+        queue->capacity = ECS_CMD_QUEUE_DEFAULT_CAPACITY;
+    }
+    queue->value_size = desc->value_size;
+    if (!queue->value_size) {
+        queue->value_size = ECS_CMD_QUEUE_DEFAULT_VALUE_SIZE;
+    }
+    queue->value_size = ECS_ALIGN(queue->value_size, ECS_SIZEOF(int64_t));
+
+    queue->slots = ecs_os_calloc_n(ecs_cmd_queue_slot_t, queue->capacity);
+    queue->values = ecs_os_malloc(queue->value_size * queue->capacity);
+
+    int32_t i;
+    for (i = 0; i < queue->capacity; i ++) {
+        queue->slots[i].seq = i;
+    }
+
+    if (desc->phase) {
+#ifdef FLECS_PIPELINE
+        queue->system = ecs_system(world, {
+            .entity = ecs_entity(world, {
+                .add = { ecs_dependson(desc->phase), desc->phase }
+            }),
+            .callback = flecs_cmd_queue_drain_system,
+            .ctx = queue
+        });
+#else
+        ecs_err("cannot drain command queue in phase: pipeline addon missing");
+#endif
+    }
+
+    return queue;
+error:
+    return NULL;
+}
+
+void ecs_cmd_queue_free(
+    ecs_cmd_queue_t *queue)
+{
+    ecs_check(queue != NULL, ECS_INVALID_PARAMETER, NULL);
+
+    if (queue->system) {
+        ecs_delete(queue->world, queue->system);
+    }
+
+    int64_t i, head = queue->head;
+    for (i = queue->tail; i < head; i ++) {
+        ecs_cmd_queue_slot_t *slot = &queue->slots[i % queue->capacity];
+        if (slot->seq == (i + 1)) {
+            flecs_cmd_queue_value_free(queue, slot);
+        }
+    }
+
+    ecs_os_free(queue->slots);
+    ecs_os_free(queue->values);
+    ecs_os_free(queue);
+error:
+    return;
+}
+
+bool ecs_cmd_queue_add(
+    ecs_cmd_queue_t *queue,
+    ecs_entity_t entity,
+    ecs_id_t id)
+{
+    ecs_check(queue != NULL, ECS_INVALID_PARAMETER, NULL);
+    ecs_check(entity != 0, ECS_INVALID_PARAMETER, NULL);
+    ecs_check(id != 0, ECS_INVALID_PARAMETER, NULL);
+
+    ecs_cmd_queue_slot_t *slot = flecs_cmd_queue_claim(
+        queue, EcsCmdAdd, entity, id);
+    if (!slot) {
+        return false;
+    }
+
+    return flecs_cmd_queue_publish(slot);
+error:
+    return false;
+}
+
+bool ecs_cmd_queue_remove(
+    ecs_cmd_queue_t *queue,
+    ecs_entity_t entity,
+    ecs_id_t id)
+{
+    ecs_check(queue != NULL, ECS_INVALID_PARAMETER, NULL);
+    ecs_check(entity != 0, ECS_INVALID_PARAMETER, NULL);
+    ecs_check(id != 0, ECS_INVALID_PARAMETER, NULL);
+
+    ecs_cmd_queue_slot_t *slot = flecs_cmd_queue_claim(
+        queue, EcsCmdRemove, entity, id);
+    if (!slot) {
+        return false;
+    }
+
+    return flecs_cmd_queue_publish(slot);
+error:
+    return false;
+}
+
+bool ecs_cmd_queue_set(
+    ecs_cmd_queue_t *queue,
+    ecs_entity_t entity,
+    ecs_id_t id,
+    size_t size,
+    const void *ptr)
+{
+    ecs_check(queue != NULL, ECS_INVALID_PARAMETER, NULL);
+    ecs_check(entity != 0, ECS_INVALID_PARAMETER, NULL);
+    ecs_check(id != 0, ECS_INVALID_PARAMETER, NULL);
+    ecs_check(size != 0, ECS_INVALID_PARAMETER, NULL);
+    ecs_check(ptr != NULL, ECS_INVALID_PARAMETER, NULL);
+
+    ecs_cmd_queue_slot_t *slot = flecs_cmd_queue_claim(
+        queue, EcsCmdSet, entity, id);
+    if (!slot) {
+        return false;
+    }
+
+    ecs_size_t value_size = flecs_uto(ecs_size_t, size);
+    void *value;
+    if (value_size <= queue->value_size) {
+        value = flecs_cmd_queue_value(queue, slot);
+    } else {
+        value = ecs_os_malloc(value_size);
+    }
+
+    ecs_os_memcpy(value, ptr, value_size);
+    slot->cmd.is._1.value = value;
+    slot->cmd.is._1.size = value_size;
+
+    return flecs_cmd_queue_publish(slot);
+error:
+    return false;
+}
+
+bool ecs_cmd_queue_delete(
+    ecs_cmd_queue_t *queue,
+    ecs_entity_t entity)
+{
+    ecs_check(queue != NULL, ECS_INVALID_PARAMETER, NULL);
+    ecs_check(entity != 0, ECS_INVALID_PARAMETER, NULL);
+
+    ecs_cmd_queue_slot_t *slot = flecs_cmd_queue_claim(
+        queue, EcsCmdDelete, entity, 0);
+    if (!slot) {
+        return false;
+    }
+
+    return flecs_cmd_queue_publish(slot);
+error:
+    return false;
+}
+
+bool ecs_cmd_queue_emit(
+    ecs_cmd_queue_t *queue,
+    ecs_entity_t event,
+    ecs_entity_t entity,
+    ecs_id_t id)
+{
+    ecs_check(queue != NULL, ECS_INVALID_PARAMETER, NULL);
+    ecs_check(event != 0, ECS_INVALID_PARAMETER, NULL);
+    ecs_check(entity != 0, ECS_INVALID_PARAMETER, NULL);
+    ecs_check(id != 0, ECS_INVALID_PARAMETER, NULL);
+
+    ecs_cmd_queue_slot_t *slot = flecs_cmd_queue_claim(
+        queue, EcsCmdEvent, entity, id);
+    if (!slot) {
+        return false;
+    }
+
+    slot->event = event;
+
+    return flecs_cmd_queue_publish(slot);
+error:
+    return false;
+}
+
+int32_t ecs_cmd_queue_drain(
+    ecs_world_t *world,
+    ecs_cmd_queue_t *queue)
+{
+    ecs_check(world != NULL, ECS_INVALID_PARAMETER, NULL);
+    ecs_check(queue != NULL, ECS_INVALID_PARAMETER, NULL);
+    ecs_check(ecs_get_world(world) == queue->world,
+        ECS_INVALID_PARAMETER, NULL);
+
+    int32_t count = 0;
+    int64_t index = queue->tail;
+    for (;; index ++) {
+        ecs_cmd_queue_slot_t *slot = &queue->slots[index % queue->capacity];
+        if (flecs_cmd_queue_load(&slot->seq) != (index + 1)) {
+            /* Slot hasn't been published yet */
+            break;
+        }
+
+        /* Increment acts as barrier, so the command isn't read before it was
+         * published. Producers only use tail to test if the queue is full. */
+        ecs_os_lainc(&queue->tail);
+
+        flecs_cmd_queue_apply(world, slot);
+        flecs_cmd_queue_value_free(queue, slot);
+
+        /* Release slot for the next round. The intermediate value is not a
+         * valid index for this slot, so producers keep waiting until the
+         * increment makes the slot available. */
+        slot->seq = index + queue->capacity - 1;
+        ecs_os_lainc(&slot->seq);
+        count ++;
+    }
+
+    return count;
+error:
+    return 0;
+}
+
 /**
  * @file entity.c
  * @brief Entity API.
@@ -4130,6 +4840,10 @@ void flecs_notify_on_add(
             flecs_set_union(world, table, row, count, added);
         }
 
+        if (table_flags & EcsTableHasPairs) {
+            flecs_id_record_trav_invalidate(world, added);
+        }
+
         if (table_flags & (EcsTableHasOnAdd|EcsTableHasIsA|EcsTableHasTraversable)) {
             flecs_emit(world, world, &(ecs_event_desc_t){
                 .event = EcsOnAdd,
@@ -4156,6 +4870,10 @@ void flecs_notify_on_remove(
     ecs_assert(removed != NULL, ECS_INTERNAL_ERROR, NULL);
     ecs_assert(count != 0, ECS_INTERNAL_ERROR, NULL);
 
+    if (removed->count && (table->flags & EcsTableHasPairs)) {
+        flecs_id_record_trav_invalidate(world, removed);
+    }
+
     if (removed->count && (table->flags & 
         (EcsTableHasOnRemove|EcsTableHasUnSet|EcsTableHasIsA|EcsTableHasTraversable))) 
     {
@@ -4420,6 +5138,83 @@ error:
     return;
 }
 
+/* Commit a range of entities in a table to a new table. Instead of moving the
+ * entities one by one, the range is moved with a single copy per column and a
+ * single event per range. */
+static
+void flecs_commit_range(
+    ecs_world_t *world,
+    ecs_table_t *src_table,
+    int32_t offset,
+    int32_t count,
+    ecs_table_t *dst_table,
+    ecs_table_diff_t *diff)
+{
+    ecs_assert(!(world->flags & EcsWorldReadonly), ECS_INTERNAL_ERROR, NULL);
+    ecs_assert(src_table != NULL, ECS_INTERNAL_ERROR, NULL);
+    ecs_assert(dst_table != NULL, ECS_INTERNAL_ERROR, NULL);
+
+    if (src_table == dst_table) {
+        /* Union relationships can change without changing the table */
+        if (diff->added.count) {
+            flecs_notify_on_add(world, src_table, src_table, offset, count,
+                &diff->added, 0);
+        }
+        return;
+    }
+
+    bool whole_table = !offset && (count == ecs_table_count(src_table));
+    if ((!whole_table || !dst_table->type.count) &&
+        ((src_table->flags | dst_table->flags) &
+            (EcsTableHasUnion|EcsTableHasToggle)))
+    {
+        /* Ranges of union & toggle columns can't be moved in bulk. Move
+         * entities one by one, starting from the end of the range so that
+         * entities that fill up the gaps are never part of the range. */
+        int32_t i;
+        for (i = count - 1; i >= 0; i --) {
+            ecs_entity_t e = ecs_vec_get_t(&src_table->data.entities,
+                ecs_entity_t, offset + i)[0];
+            ecs_record_t *r = flecs_entities_get(world, e);
+            flecs_commit(world, e, r, dst_table, diff, true, 0);
+        }
+        return;
+    }
+
+    bool is_trav = src_table->_->traversable_count != 0;
+
+    flecs_notify_on_remove(
+        world, src_table, dst_table, offset, count, &diff->removed);
+
+    if (dst_table->type.count) {
+        int32_t dst_row = flecs_table_move_range(
+            world, dst_table, src_table, offset, count, true);
+        flecs_notify_on_add(
+            world, dst_table, src_table, dst_row, count, &diff->added, 0);
+        flecs_update_name_index(world, src_table, dst_table, dst_row, count);
+    } else {
+        /* All components are removed, entities no longer have a table */
+        ecs_entity_t *entities = flecs_walloc_n(world, ecs_entity_t, count);
+        ecs_os_memcpy_n(entities, ecs_vec_get_t(&src_table->data.entities,
+            ecs_entity_t, offset), ecs_entity_t, count);
+
+        flecs_table_delete_range(world, src_table, offset, count, true);
+
+        int32_t i, traversable = 0;
+        for (i = 0; i < count; i ++) {
+            ecs_record_t *r = flecs_entities_get(world, entities[i]);
+            traversable += (r->row & EcsEntityIsTraversable) != 0;
+            r->table = NULL;
+        }
+        flecs_table_traversable_add(src_table, -traversable);
+        flecs_wfree_n(world, ecs_entity_t, count, entities);
+    }
+
+    if (is_trav) {
+        flecs_update_component_monitors(world, &diff->added, &diff->removed);
+    }
+}
+
 static
 const ecs_entity_t* flecs_bulk_new(
     ecs_world_t *world,
@@ -4551,6 +5346,116 @@ void flecs_add_id_w_record(
                            * functions that are about to set the component. */
 }
 
+static
+ecs_id_record_t* flecs_sparse_id_record(
+    const ecs_world_t *world,
+    ecs_id_t id)
+{
+    if (!ecs_vec_count(&world->sparse_ids)) {
+        return NULL;
+    }
+
+    ecs_id_record_t *idr = flecs_id_record_get(world, id);
+    if (idr && (idr->flags & EcsIdSparse)) {
+        return idr;
+    }
+
+    return NULL;
+}
+
+static
+void* flecs_add_sparse(
+    ecs_world_t *world,
+    ecs_entity_t entity,
+    ecs_record_t *r,
+    ecs_id_record_t *idr,
+    bool construct)
+{
+    if (flecs_id_record_sparse_has(idr, entity)) {
+        return flecs_id_record_sparse_get(idr, entity);
+    }
+
+    void *ptr = flecs_id_record_sparse_insert(world, idr, entity);
+    flecs_record_add_flag(r, EcsEntityHasSparse);
+
+    const ecs_type_info_t *ti = idr->type_info;
+    if (ti) {
+        if (construct) {
+            ecs_xtor_t ctor = ti->hooks.ctor;
+            if (ctor) {
+                ctor(ptr, 1, ti);
+            } else {
+                ecs_os_memset(ptr, 0, ti->size);
+            }
+        }
+
+        ecs_iter_action_t on_add = ti->hooks.on_add;
+        if (on_add) {
+            flecs_invoke_hook(world, NULL, 1, 0, &entity, ptr, idr->id, ti, 
+                EcsOnAdd, on_add);
+        }
+    }
+
+    return ptr;
+}
+
+static
+void flecs_remove_sparse(
+    ecs_world_t *world,
+    ecs_entity_t entity,
+    ecs_id_record_t *idr)
+{
+    if (!flecs_id_record_sparse_has(idr, entity)) {
+        return;
+    }
+
+    const ecs_type_info_t *ti = idr->type_info;
+    if (ti) {
+        void *ptr = flecs_id_record_sparse_get(idr, entity);
+        ecs_iter_action_t on_remove = ti->hooks.on_remove;
+        if (on_remove) {
+            flecs_invoke_hook(world, NULL, 1, 0, &entity, ptr, idr->id, ti, 
+                EcsOnRemove, on_remove);
+        }
+
+        ecs_xtor_t dtor = ti->hooks.dtor;
+        if (dtor) {
+            dtor(ptr, 1, ti);
+        }
+    }
+
+    flecs_id_record_sparse_remove(idr, entity);
+}
+
+static
+void flecs_on_set_sparse(
+    ecs_world_t *world,
+    ecs_entity_t entity,
+    ecs_id_record_t *idr,
+    void *ptr)
+{
+    const ecs_type_info_t *ti = idr->type_info;
+    if (ti) {
+        ecs_iter_action_t on_set = ti->hooks.on_set;
+        if (on_set) {
+            flecs_invoke_hook(world, NULL, 1, 0, &entity, ptr, idr->id, ti, 
+                EcsOnSet, on_set);
+        }
+    }
+}
+
+void flecs_entity_remove_sparse(
+    ecs_world_t *world,
+    ecs_entity_t entity)
+{
+    ecs_vec_t *ids = &world->sparse_ids;
+    int32_t i;
+    for (i = 0; i < ecs_vec_count(ids); i ++) {
+        ecs_id_record_t *idr = ecs_vec_get_t(ids, ecs_id_record_t*, i)[0];
+        flecs_remove_sparse(world, entity, idr);
+    }
+}
+
 static
 void flecs_add_id(
     ecs_world_t *world,
@@ -4564,6 +5469,14 @@ void flecs_add_id(
 
     ecs_record_t *r = flecs_entities_get(world, entity);
     ecs_assert(r != NULL, ECS_INTERNAL_ERROR, NULL);
+
+    ecs_id_record_t *idr = flecs_sparse_id_record(world, id);
+    if (idr) {
+        flecs_add_sparse(world, entity, r, idr, true);
+        flecs_defer_end(world, stage);
+        return;
+    }
+
     ecs_table_diff_t diff = ECS_TABLE_DIFF_INIT;
     ecs_table_t *src_table = r->table;
     ecs_table_t *dst_table = flecs_table_traverse_add(
@@ -4587,6 +5500,14 @@ void flecs_remove_id(
 
     ecs_record_t *r = flecs_entities_get(world, entity);
     ecs_assert(r != NULL, ECS_INTERNAL_ERROR, NULL);
+
+    ecs_id_record_t *idr = flecs_sparse_id_record(world, id);
+    if (idr) {
+        flecs_remove_sparse(world, entity, idr);
+        flecs_defer_end(world, stage);
+        return;
+    }
+
     ecs_table_t *src_table = r->table;
     ecs_table_diff_t diff = ECS_TABLE_DIFF_INIT;
     ecs_table_t *dst_table = flecs_table_traverse_remove(
@@ -4612,6 +5533,15 @@ flecs_component_ptr_t flecs_ensure(
     ecs_check((id & ECS_COMPONENT_MASK) == id || 
         ECS_HAS_ID_FLAG(id, PAIR), ECS_INVALID_PARAMETER, NULL);
 
+    ecs_id_record_t *idr = flecs_sparse_id_record(world, id);
+    if (idr) {
+        ecs_check(idr->type_info != NULL, ECS_INVALID_PARAMETER, 
+            "cannot get pointer to sparse tag");
+        dst.ptr = flecs_add_sparse(world, entity, r, idr, true);
+        dst.ti = idr->type_info;
+        return dst;
+    }
+
     if (r->table) {
         dst = flecs_get_component_ptr(
             world, r->table, ECS_RECORD_TO_ROW(r->row), id);
@@ -4934,6 +5864,9 @@ ecs_entity_t ecs_new_w_id(
         ecs_table_diff_builder_t diff = ECS_TABLE_DIFF_INIT;
         flecs_table_diff_builder_init(world, &diff);
         for (i = 0; i < count; i ++) {
+            if (flecs_sparse_id_record(world, to_add.array[i])) {
+                continue;
+            }
             table = flecs_find_table_add(
                 world, table, to_add.array[i], &diff);
         }
@@ -4943,6 +5876,14 @@ ecs_entity_t ecs_new_w_id(
         ecs_record_t *r = flecs_entities_get(world, entity);
         flecs_new_entity(world, entity, r, table, &table_diff, true, true);
         flecs_table_diff_builder_fini(world, &diff);
+
+        for (i = 0; i < count; i ++) {
+            ecs_id_record_t *idr = flecs_sparse_id_record(
+                world, to_add.array[i]);
+            if (idr) {
+                flecs_add_sparse(world, entity, r, idr, true);
+            }
+        }
     } else {
         if (flecs_defer_cmd(stage)) {
             return entity;
@@ -5122,8 +6063,14 @@ int flecs_traverse_add(
     int32_t i = 0;
     ecs_id_t id;
     const ecs_id_t *ids = desc->add;
+    bool has_sparse = false;
     while ((i < FLECS_ID_DESC_MAX) && (id = ids[i ++])) {
         bool should_add = true;
+        if (flecs_sparse_id_record(world, id)) {
+            /* Sparse components are added after the entity is committed */
+            has_sparse = true;
+            continue;
+        }
         if (ECS_HAS_ID_FLAG(id, PAIR) && ECS_PAIR_FIRST(id) == EcsChildOf) {
             scope = ECS_PAIR_SECOND(id);
             if ((!desc->id && desc->name) || (name && !name_assigned)) {
@@ -5177,6 +6124,16 @@ int flecs_traverse_add(
         flecs_defer_end(world, &world->stages[0]);
     }
 
+    if (has_sparse) {
+        i = 0;
+        while ((i < FLECS_ID_DESC_MAX) && (id = ids[i ++])) {
+            ecs_id_record_t *idr = flecs_sparse_id_record(world, id);
+            if (idr) {
+                flecs_add_sparse(world, result, r, idr, true);
+            }
+        }
+    }
+
     /* Set name */
     if (name && !name_assigned) {
         ecs_add_path_w_sep(world, result, scope, name, sep, root_sep);
@@ -5466,6 +6423,8 @@ const ecs_entity_t* ecs_bulk_init(
         int32_t i = 0;
         ecs_id_t id;
         while ((id = desc->ids[i])) {
+            ecs_check(!flecs_sparse_id_record(world, id), ECS_INVALID_PARAMETER,
+                "sparse components cannot be added with bulk_init");
             table = flecs_find_table_add(world, table, id, &diff);
             i ++;
         }
@@ -5660,7 +6619,12 @@ void ecs_clear(
         if (r->row & EcsEntityIsTraversable) {
             flecs_table_traversable_add(table, -1);
         }
-    }    
+    }
+
+    if (r->row & EcsEntityHasSparse) {
+        flecs_entity_remove_sparse(world, entity);
+        r->row &= ~EcsEntityHasSparse;
+    }
 
     flecs_defer_end(world, stage);
 error:
@@ -6099,6 +7063,52 @@ bool flecs_on_delete_clear_ids(
     return true;
 }
 
+/* Sparse components aren't stored in tables, so the table-based cleanup below
+ * won't find them. Apply the cleanup action to each entity directly. */
+static
+void flecs_on_delete_sparse(
+    ecs_world_t *world,
+    ecs_id_record_t *idr,
+    ecs_entity_t action)
+{
+    ecs_sparse_t *sparse = idr->sparse;
+    int32_t i, count = flecs_sparse_count(sparse);
+    if (!count) {
+        return;
+    }
+
+    if (!action) {
+        action = ECS_ID_ON_DELETE(idr->flags);
+    }
+
+    if (action == EcsPanic) {
+        flecs_throw_invalid_delete(world, idr->id);
+        return;
+    }
+
+    /* Copy ids, as removing components changes the order of the storage */
+    ecs_allocator_t *a = &world->allocator;
+    ecs_vec_t ids;
+    ecs_vec_init_t(a, &ids, uint64_t, count);
+    ecs_os_memcpy_n(ecs_vec_grow_t(a, &ids, uint64_t, count), 
+        flecs_sparse_ids(sparse), uint64_t, count);
+
+    uint64_t *ids_arr = ecs_vec_first_t(&ids, uint64_t);
+    for (i = 0; i < count; i ++) {
+        ecs_entity_t e = flecs_entities_get_alive(world, ids_arr[i]);
+        if (!e) {
+            continue;
+        }
+
+        flecs_remove_sparse(world, e, idr);
+        if (action == EcsDelete) {
+            ecs_delete(world, e);
+        }
+    }
+
+    ecs_vec_fini_t(a, &ids, uint64_t);
+}
+
 static
 void flecs_on_delete(
     ecs_world_t *world,
@@ -6106,6 +7116,11 @@ void flecs_on_delete(
     ecs_entity_t action,
     bool delete_id)
 {
+    ecs_id_record_t *sparse_idr = flecs_sparse_id_record(world, id);
+    if (sparse_idr && sparse_idr->sparse) {
+        flecs_on_delete_sparse(world, sparse_idr, action);
+    }
+
     /* Cleanup can happen recursively. If a cleanup action is already in 
      * progress, only append ids to the marked_ids. The topmost cleanup
      * frame will handle the actual cleanup. */
@@ -6217,6 +7232,9 @@ void ecs_delete(
                     flecs_table_traversable_add(table, -1);
                 }
             }
+            if (row_flags & EcsEntityHasSparse) {
+                flecs_entity_remove_sparse(world, entity);
+            }
             /* Merge operations before deleting entity */
             flecs_defer_end(world, stage);
             flecs_defer_begin(world, stage);
@@ -6272,6 +7290,167 @@ error:
     return;
 }
 
+static
+int flecs_table_range_compare(
+    const void *ptr_a,
+    const void *ptr_b)
+{
+    const ecs_table_range_t *a = ptr_a;
+    const ecs_table_range_t *b = ptr_b;
+    if (a->table != b->table) {
+        return (a->table->id > b->table->id) - (a->table->id < b->table->id);
+    }
+    return (a->offset > b->offset) - (a->offset < b->offset);
+}
+
+void flecs_bulk_add_remove_id(
+    ecs_world_t *world,
+    ecs_table_range_t *ranges,
+    int32_t count,
+    ecs_id_t id,
+    bool remove)
+{
+    int32_t i, e;
+    for (i = 0; i < count; i ++) {
+        ecs_table_range_t *range = &ranges[i];
+        if (!range->count) {
+            range->count = ecs_table_count(range->table) - range->offset;
+        }
+    }
+
+    ecs_stage_t *stage = flecs_stage_from_world(&world);
+    if (flecs_defer_cmd(stage)) {
+        /* Tables can't be modified while deferred, enqueue per entity */
+        for (i = 0; i < count; i ++) {
+            ecs_table_range_t *range = &ranges[i];
+            ecs_entity_t *entities = ecs_vec_get_t(
+                &range->table->data.entities, ecs_entity_t, range->offset);
+            for (e = 0; e < range->count; e ++) {
+                if (remove) {
+                    flecs_defer_remove(stage, entities[e], id);
+                } else {
+                    flecs_defer_add(stage, entities[e], id);
+                }
+            }
+        }
+        return;
+    }
+
+    /* Ranges are applied in reverse order, so that entities that are moved
+     * into the gap left by a range are never part of a range that still has
+     * to be applied. Overlapping ranges are combined. */
+    if (count > 1) {
+        qsort(ranges, flecs_itosize(count), sizeof(ecs_table_range_t),
+            flecs_table_range_compare);
+
+        int32_t last = 0;
+        for (i = 1; i < count; i ++) {
+            ecs_table_range_t *cur = &ranges[i], *prev = &ranges[last];
+            int32_t prev_end = prev->offset + prev->count;
+            if ((cur->table == prev->table) && (cur->offset <= prev_end)) {
+                int32_t cur_end = cur->offset + cur->count;
+                if (cur_end > prev_end) {
+                    prev->count = cur_end - prev->offset;
+                }
+            } else {
+                ranges[++ last] = *cur;
+            }
+        }
+        count = last + 1;
+    }
+
+    ecs_id_record_t *idr = flecs_sparse_id_record(world, id);
+
+    for (i = count - 1; i >= 0; i --) {
+        ecs_table_range_t *range = &ranges[i];
+        ecs_table_t *table = range->table;
+        if (!range->count) {
+            continue;
+        }
+
+        if (idr) {
+            ecs_entity_t *entities = ecs_vec_get_t(
+                &table->data.entities, ecs_entity_t, range->offset);
+            for (e = 0; e < range->count; e ++) {
+                if (remove) {
+                    flecs_remove_sparse(world, entities[e], idr);
+                } else {
+                    ecs_record_t *r = flecs_entities_get(world, entities[e]);
+                    flecs_add_sparse(world, entities[e], r, idr, true);
+                }
+            }
+            continue;
+        }
+
+        ecs_id_t table_id = id;
+        ecs_table_diff_t diff = ECS_TABLE_DIFF_INIT;
+        ecs_table_t *dst_table;
+        if (remove) {
+            dst_table = flecs_table_traverse_remove(
+                world, table, &table_id, &diff);
+        } else {
+            dst_table = flecs_table_traverse_add(
+                world, table, &table_id, &diff);
+        }
+
+        flecs_commit_range(
+            world, table, range->offset, range->count, dst_table, &diff);
+    }
+
+    flecs_defer_end(world, stage);
+}
+
+void ecs_bulk_add_id(
+    ecs_world_t *world,
+    ecs_table_t *table,
+    int32_t offset,
+    int32_t count,
+    ecs_id_t id)
+{
+    ecs_check(world != NULL, ECS_INVALID_PARAMETER, NULL);
+    ecs_check(table != NULL, ECS_INVALID_PARAMETER, NULL);
+    ecs_check(offset >= 0, ECS_INVALID_PARAMETER, NULL);
+    ecs_check(count >= 0, ECS_INVALID_PARAMETER, NULL);
+    ecs_check((offset + count) <= ecs_table_count(table),
+        ECS_INVALID_PARAMETER, NULL);
+    ecs_check(ecs_id_is_valid(world, id), ECS_INVALID_PARAMETER, NULL);
+
+    if (offset == ecs_table_count(table)) {
+        return;
+    }
+
+    ecs_table_range_t range = { table, offset, count };
+    flecs_bulk_add_remove_id(world, &range, 1, id, false);
+error:
+    return;
+}
+
+void ecs_bulk_remove_id(
+    ecs_world_t *world,
+    ecs_table_t *table,
+    int32_t offset,
+    int32_t count,
+    ecs_id_t id)
+{
+    ecs_check(world != NULL, ECS_INVALID_PARAMETER, NULL);
+    ecs_check(table != NULL, ECS_INVALID_PARAMETER, NULL);
+    ecs_check(offset >= 0, ECS_INVALID_PARAMETER, NULL);
+    ecs_check(count >= 0, ECS_INVALID_PARAMETER, NULL);
+    ecs_check((offset + count) <= ecs_table_count(table),
+        ECS_INVALID_PARAMETER, NULL);
+    ecs_check(ecs_id_is_valid(world, id) || ecs_id_is_wildcard(id),
+        ECS_INVALID_PARAMETER, NULL);
+
+    if (offset == ecs_table_count(table)) {
+        return;
+    }
+
+    ecs_table_range_t range = { table, offset, count };
+    flecs_bulk_add_remove_id(world, &range, 1, id, true);
+error:
+    return;
+}
+
 void ecs_override_id(
     ecs_world_t *world,
     ecs_entity_t entity,
@@ -6357,13 +7536,17 @@ const void* ecs_get_id(
     ecs_record_t *r = flecs_entities_get(world, entity);
     ecs_assert(r != NULL, ECS_INVALID_PARAMETER, NULL);
 
-    ecs_table_t *table = r->table;
-    if (!table) {
+    ecs_id_record_t *idr = flecs_id_record_get(world, id);
+    if (!idr) {
         return NULL;
     }
 
-    ecs_id_record_t *idr = flecs_id_record_get(world, id);
-    if (!idr) {
+    if (idr->flags & EcsIdSparse) {
+        return flecs_id_record_sparse_get(idr, entity);
+    }
+
+    ecs_table_t *table = r->table;
+    if (!table) {
         return NULL;
     }
 
@@ -6395,13 +7578,17 @@ void* ecs_get_mut_id(
     ecs_record_t *r = flecs_entities_get(world, entity);
     ecs_assert(r != NULL, ECS_INVALID_PARAMETER, NULL);
 
-    ecs_table_t *table = r->table;
-    if (!table) {
+    ecs_id_record_t *idr = flecs_id_record_get(world, id);
+    if (!idr) {
         return NULL;
     }
 
-    ecs_id_record_t *idr = flecs_id_record_get(world, id);
-    if (!idr) {
+    if (idr->flags & EcsIdSparse) {
+        return flecs_id_record_sparse_get(idr, entity);
+    }
+
+    ecs_table_t *table = r->table;
+    if (!table) {
         return NULL;
     }
 
@@ -6705,6 +7892,13 @@ void* ecs_emplace_id(
     }
 
     ecs_record_t *r = flecs_entities_get(world, entity);
+    ecs_id_record_t *idr = flecs_sparse_id_record(world, id);
+    if (idr) {
+        void *ptr = flecs_add_sparse(world, entity, r, idr, false);
+        flecs_defer_end(world, stage);
+        return ptr;
+    }
+
     flecs_add_id_w_record(world, entity, r, id, false /* Add without ctor */);
     flecs_defer_end(world, stage);
 
@@ -6733,6 +7927,16 @@ void flecs_modified_id_if(
         return;
     }
 
+    ecs_id_record_t *idr = flecs_sparse_id_record(world, id);
+    if (idr) {
+        void *ptr = flecs_id_record_sparse_get(idr, entity);
+        if (ptr && owned) {
+            flecs_on_set_sparse(world, entity, idr, ptr);
+        }
+        flecs_defer_end(world, stage);
+        return;
+    }
+
     ecs_record_t *r = flecs_entities_get(world, entity);
     ecs_table_t *table = r->table;
     if (!flecs_table_record_get(world, table, id)) {
@@ -6743,7 +7947,7 @@ void flecs_modified_id_if(
     ecs_type_t ids = { .array = &id, .count = 1 };
     flecs_notify_on_set(world, table, ECS_RECORD_TO_ROW(r->row), 1, &ids, owned);
 
-    flecs_table_mark_dirty(world, table, id);
+    flecs_table_mark_dirty(world, table, ECS_RECORD_TO_ROW(r->row), id);
     flecs_defer_end(world, stage);
 error:
     return;
@@ -6770,12 +7974,20 @@ void ecs_modified_id(
      * operations are being deferred. */
     ecs_check(ecs_has_id(world, entity, id), ECS_INVALID_PARAMETER, NULL);
 
+    ecs_id_record_t *idr = flecs_sparse_id_record(world, id);
+    if (idr) {
+        flecs_on_set_sparse(world, entity, idr, 
+            flecs_id_record_sparse_get(idr, entity));
+        flecs_defer_end(world, stage);
+        return;
+    }
+
     ecs_record_t *r = flecs_entities_get(world, entity);
     ecs_table_t *table = r->table;
     ecs_type_t ids = { .array = &id, .count = 1 };
     flecs_notify_on_set(world, table, ECS_RECORD_TO_ROW(r->row), 1, &ids, true);
 
-    flecs_table_mark_dirty(world, table, id);
+    flecs_table_mark_dirty(world, table, ECS_RECORD_TO_ROW(r->row), id);
     flecs_defer_end(world, stage);
 error:
     return;
@@ -6812,7 +8024,14 @@ void flecs_copy_ptr_w_id(
         ecs_os_memset(dst.ptr, 0, size);
     }
 
-    flecs_table_mark_dirty(world, r->table, id);
+    ecs_id_record_t *idr = flecs_sparse_id_record(world, id);
+    if (idr) {
+        flecs_on_set_sparse(world, entity, idr, dst.ptr);
+        flecs_defer_end(world, stage);
+        return;
+    }
+
+    flecs_table_mark_dirty(world, r->table, ECS_RECORD_TO_ROW(r->row), id);
 
     ecs_table_t *table = r->table;
     if (table->flags & EcsTableHasOnSet || ti->hooks.on_set) {
@@ -6861,7 +8080,16 @@ void flecs_move_ptr_w_id(
         ecs_os_memcpy(dst.ptr, ptr, flecs_utosize(size));
     }
 
-    flecs_table_mark_dirty(world, r->table, id);
+    ecs_id_record_t *idr = flecs_sparse_id_record(world, id);
+    if (idr) {
+        if (cmd_kind == EcsCmdSet) {
+            flecs_on_set_sparse(world, entity, idr, dst.ptr);
+        }
+        flecs_defer_end(world, stage);
+        return;
+    }
+
+    flecs_table_mark_dirty(world, r->table, ECS_RECORD_TO_ROW(r->row), id);
 
     if (cmd_kind == EcsCmdSet) {
         ecs_table_t *table = r->table;
@@ -7004,6 +8232,14 @@ bool ecs_has_id(
 
     ecs_record_t *r = flecs_entities_get_any(world, entity);
     ecs_assert(r != NULL, ECS_INTERNAL_ERROR, NULL);
+
+    if (r->row & EcsEntityHasSparse) {
+        ecs_id_record_t *idr = flecs_sparse_id_record(world, id);
+        if (idr) {
+            return flecs_id_record_sparse_has(idr, entity);
+        }
+    }
+
     ecs_table_t *table = r->table;
     if (!table) {
         return false;
@@ -7053,6 +8289,11 @@ bool ecs_owns_id(
     ecs_entity_t entity,
     ecs_id_t id)
 {
+    ecs_id_record_t *idr = flecs_sparse_id_record(ecs_get_world(world), id);
+    if (idr) {
+        return flecs_id_record_sparse_has(idr, entity);
+    }
+
     return (ecs_search(world, ecs_get_table(world, entity), id, 0) != -1);
 }
 
@@ -8101,7 +9342,7 @@ void flecs_flush_bulk_new(
         }
     }
 
-    ecs_os_free(entities);
+    flecs_stack_free_n(entities, ecs_entity_t, cmd->is._n.count);
 }
 
 static
@@ -8150,7 +9391,8 @@ void flecs_discard_cmd(
     ecs_cmd_t *cmd)
 {
     if (cmd->kind == EcsCmdBulkNew) {
-        ecs_os_free(cmd->is._n.entities);
+        flecs_stack_free_n(cmd->is._n.entities, ecs_entity_t, 
+            cmd->is._n.count);
     } else if (cmd->kind == EcsCmdEvent) {
         flecs_free_cmd_event(world, cmd->is._1.value);
     } else {
@@ -8260,6 +9502,155 @@ ecs_table_t* flecs_cmd_batch_add_diff(
     return dst;
 }
 
+/* Returns true if the commands for an entity contain a sparse component. Sparse
+ * components don't cause table moves, and are applied in queue order. */
+static
+bool flecs_cmd_batch_has_sparse(
+    ecs_world_t *world,
+    ecs_cmd_t *cmds,
+    int32_t start)
+{
+    int32_t cur = start;
+    do {
+        ecs_cmd_t *cmd = &cmds[cur];
+        if (cmd->id && flecs_sparse_id_record(world, cmd->id)) {
+            return true;
+        }
+
+        cur = cmd->next_for_entity;
+        if (cur < 0) {
+            cur *= -1;
+        }
+    } while (cur);
+
+    return false;
+}
+
+/* Copy values of set commands in batch to the component storage of entity. A
+ * set command is converted to a modified command, so that OnSet observers are
+ * invoked when the command is processed. */
+static
+void flecs_cmd_batch_set_values(
+    ecs_world_t *world,
+    ecs_record_t *r,
+    ecs_cmd_t *cmds,
+    int32_t start)
+{
+    ecs_cmd_t *cmd;
+    int32_t next_for_entity;
+    int32_t cur = start;
+    do {
+        cmd = &cmds[cur];
+        next_for_entity = cmd->next_for_entity;
+        if (next_for_entity < 0) {
+            next_for_entity *= -1;
+        }
+        switch(cmd->kind) {
+        case EcsCmdSet:
+        case EcsCmdEnsure: {
+            flecs_component_ptr_t ptr = {0};
+            if (r->table) {
+                ptr = flecs_get_component_ptr(world, 
+                    r->table, ECS_RECORD_TO_ROW(r->row), cmd->id);
+            }
+
+            /* It's possible that even though the component was set, the
+             * command queue also contained a remove command, so before we
+             * do anything ensure the entity actually has the component. */
+            if (ptr.ptr) {
+                const ecs_type_info_t *ti = ptr.ti;
+                ecs_move_t move = ti->hooks.move;
+                if (move) {
+                    move(ptr.ptr, cmd->is._1.value, 1, ti);
+                    ecs_xtor_t dtor = ti->hooks.dtor;
+                    if (dtor) {
+                        dtor(cmd->is._1.value, 1, ti);
+                        cmd->is._1.value = NULL;
+                    }
+                } else {
+                    ecs_os_memcpy(ptr.ptr, cmd->is._1.value, ti->size);
+                }
+                if (cmd->kind == EcsCmdSet) {
+                    /* A set operation is add + copy + modified. We just did
+                     * the add the copy, so the only thing that's left is a 
+                     * modified command, which will call the OnSet 
+                     * observers. */
+                    cmd->kind = EcsCmdModified;
+                } else {
+                    /* If this was a ensure, nothing's left to be done */
+                    cmd->kind = EcsCmdSkip;
+                }
+            } else {
+                /* The entity no longer has the component which means that
+                 * there was a remove command for the component in the
+                 * command queue. In that case skip the command. */
+                cmd->kind = EcsCmdSkip;
+            }
+            break;
+        }
+        case EcsCmdClone:
+        case EcsCmdBulkNew:
+        case EcsCmdAdd:
+        case EcsCmdRemove:
+        case EcsCmdEmplace:
+        case EcsCmdModified:
+        case EcsCmdModifiedNoHook:
+        case EcsCmdAddModified:
+        case EcsCmdPath:
+        case EcsCmdDelete:
+        case EcsCmdClear:
+        case EcsCmdOnDeleteAction:
+        case EcsCmdEnable:
+        case EcsCmdDisable:
+        case EcsCmdEvent:
+        case EcsCmdSkip:
+            break;
+        }
+    } while ((cur = next_for_entity));
+}
+
+/* Collapse modified commands for the same id in batch into the last one, so
+ * that OnSet observers are invoked once for an entity. Commands that could 
+ * observe the intermediate notifications (such as events) are not moved past. */
+static
+void flecs_cmd_batch_collapse_modified(
+    ecs_cmd_t *cmds,
+    int32_t start)
+{
+    int32_t cur = start;
+    do {
+        ecs_cmd_t *cmd = &cmds[cur];
+        int32_t next = cmd->next_for_entity;
+        if (next < 0) {
+            next *= -1;
+        }
+
+        if (cmd->kind == EcsCmdModified || cmd->kind == EcsCmdModifiedNoHook) {
+            int32_t later = next;
+            while (later) {
+                ecs_cmd_t *later_cmd = &cmds[later];
+                ecs_cmd_kind_t kind = later_cmd->kind;
+                if (kind == EcsCmdModified || kind == EcsCmdModifiedNoHook) {
+                    if (later_cmd->id == cmd->id) {
+                        /* If the on_set hook still has to run for the collapsed
+                         * command, run it for the remaining command. */
+                        if (cmd->kind == EcsCmdModified) {
+                            later_cmd->kind = EcsCmdModified;
+                        }
+                        cmd->kind = EcsCmdSkip;
+                        break;
+                    }
+                } else if (kind != EcsCmdSkip) {
+                    break;
+                }
+                later = later_cmd->next_for_entity;
+            }
+        }
+
+        cur = next;
+    } while (cur);
+}
+
 static
 void flecs_cmd_batch_for_entity(
     ecs_world_t *world,
@@ -8268,6 +9659,12 @@ void flecs_cmd_batch_for_entity(
     ecs_cmd_t *cmds,
     int32_t start)
 {
+    if (ecs_vec_count(&world->sparse_ids) && 
+        flecs_cmd_batch_has_sparse(world, cmds, start)) 
+    {
+        return;
+    }
+
     ecs_record_t *r = flecs_entities_get(world, entity);
     ecs_table_t *table = NULL;
     if (r) {
@@ -8420,76 +9817,633 @@ void flecs_cmd_batch_for_entity(
      * yet, as for entities that did have the component already the value will
      * have been assigned directly to the component storage. */
     if (has_set) {
-        cur = start;
-        do {
-            cmd = &cmds[cur];
-            next_for_entity = cmd->next_for_entity;
-            if (next_for_entity < 0) {
-                next_for_entity *= -1;
-            }
-            switch(cmd->kind) {
-            case EcsCmdSet:
-            case EcsCmdEnsure: {
-                flecs_component_ptr_t ptr = {0};
-                if (r->table) {
-                    ptr = flecs_get_component_ptr(world, 
-                        r->table, ECS_RECORD_TO_ROW(r->row), cmd->id);
-                }
+        flecs_cmd_batch_set_values(world, r, cmds, start);
+    }
 
-                /* It's possible that even though the component was set, the
-                 * command queue also contained a remove command, so before we
-                 * do anything ensure the entity actually has the component. */
-                if (ptr.ptr) {
-                    const ecs_type_info_t *ti = ptr.ti;
-                    ecs_move_t move = ti->hooks.move;
-                    if (move) {
-                        move(ptr.ptr, cmd->is._1.value, 1, ti);
-                        ecs_xtor_t dtor = ti->hooks.dtor;
-                        if (dtor) {
-                            dtor(cmd->is._1.value, 1, ti);
-                            cmd->is._1.value = NULL;
-                        }
-                    } else {
-                        ecs_os_memcpy(ptr.ptr, cmd->is._1.value, ti->size);
-                    }
-                    if (cmd->kind == EcsCmdSet) {
-                        /* A set operation is add + copy + modified. We just did
-                         * the add the copy, so the only thing that's left is a 
-                         * modified command, which will call the OnSet 
-                         * observers. */
-                        cmd->kind = EcsCmdModified;
-                    } else {
-                        /* If this was a ensure, nothing's left to be done */
-                        cmd->kind = EcsCmdSkip;
-                    }
-                } else {
-                    /* The entity no longer has the component which means that
-                     * there was a remove command for the component in the
-                     * command queue. In that case skip the command. */
-                    cmd->kind = EcsCmdSkip;
+    flecs_cmd_batch_collapse_modified(cmds, start);
+}
+
+#ifdef FLECS_PIPELINE
+
+/* Table that entities are moved from or to in a parallel merge. Tables that are
+ * connected by a move are joined in the same job, so that each table is only
+ * accessed by a single thread. */
+typedef struct ecs_merge_table_t {
+    ecs_table_t *table;
+    int32_t parent;                  /* Parent table in job, -1 if root */
+    int32_t added;                   /* Number of entities moved to table */
+    int32_t first_out;               /* First group that moves from table */
+    int32_t first_group;             /* First group in job (root only) */
+    int32_t last_group;              /* Last group in job (root only) */
+    bool was_empty;                  /* Was table empty before merge */
+} ecs_merge_table_t;
+
+/* Entities that are moved from the same source to the same destination */
+typedef struct ecs_merge_group_t {
+    ecs_table_t *src;
+    ecs_table_t *dst;
+    int32_t src_index;               /* Index of source in tables vector */
+    int32_t dst_index;               /* Index of destination in tables vector */
+    int32_t next_out;                /* Next group with same source table */
+    int32_t next;                    /* Next group in job */
+    int32_t first_move;
+    int32_t last_move;
+    bool parallel;                   /* Can group be moved on worker thread */
+} ecs_merge_group_t;
+
+typedef struct ecs_merge_move_t {
+    ecs_record_t *record;
+    ecs_entity_t entity;
+    int32_t cmd;                     /* First command for entity */
+    int32_t next;                    /* Next move in group */
+} ecs_merge_move_t;
+
+typedef struct ecs_merge_parallel_t {
+    ecs_cmd_t *cmds;
+    ecs_map_t table_index;           /* map<table id, index in tables + 1> */
+    ecs_vec_t tables;                /* vector<ecs_merge_table_t> */
+    ecs_vec_t groups;                /* vector<ecs_merge_group_t> */
+    ecs_vec_t moves;                 /* vector<ecs_merge_move_t> */
+    ecs_vec_t jobs;                  /* vector<int32_t>, root tables */
+    int32_t next;                    /* Next job to claim, incremented atomically */
+} ecs_merge_parallel_t;
+
+static
+int32_t flecs_merge_table_ensure(
+    ecs_world_t *world,
+    ecs_merge_parallel_t *m,
+    ecs_table_t *table)
+{
+    ecs_map_val_t *index = ecs_map_ensure(&m->table_index, table->id);
+    if (!index[0]) {
+        ecs_merge_table_t *mt = ecs_vec_append_t(
+            &world->allocator, &m->tables, ecs_merge_table_t);
+        mt->table = table;
+        mt->parent = -1;
+        mt->added = 0;
+        mt->first_out = -1;
+        mt->first_group = -1;
+        mt->last_group = -1;
+        mt->was_empty = ecs_table_count(table) == 0;
+        index[0] = flecs_ito(uint64_t, ecs_vec_count(&m->tables));
+    }
+    return flecs_ito(int32_t, index[0]) - 1;
+}
+
+static
+int32_t flecs_merge_table_root(
+    ecs_merge_table_t *tables,
+    int32_t index)
+{
+    int32_t root = index;
+    while (tables[root].parent != -1) {
+        root = tables[root].parent;
+    }
+
+    /* Shorten path for next lookup */
+    while (tables[index].parent != -1) {
+        int32_t parent = tables[index].parent;
+        if (parent != root) {
+            tables[index].parent = root;
+        }
+        index = parent;
+    }
+
+    return root;
+}
+
+/* Test whether entities can be moved between tables without invoking code that
+ * accesses world state. Moves that don't qualify are applied on the main thread
+ * when the command queue is processed. */
+static
+bool flecs_merge_group_is_parallel(
+    ecs_table_t *src,
+    ecs_table_t *dst)
+{
+    ecs_flags32_t flags = src->flags | dst->flags;
+    if (flags & (EcsTableHasBuiltins|EcsTableHasOnAdd|EcsTableHasOnRemove|
+        EcsTableHasUnSet|EcsTableHasIsA|EcsTableHasTraversable|
+        EcsTableHasUnion|EcsTableHasToggle|EcsTableHasName|EcsTableHasTarget))
+    {
+        return false;
+    }
+
+    if (src->_->lock || dst->_->lock) {
+        return false;
+    }
+
+    /* Adding or removing pairs invalidates traversal caches */
+    if (flags & EcsTableHasPairs) {
+        ecs_id_t *src_ids = src->type.array, *dst_ids = dst->type.array;
+        int32_t s = 0, s_count = src->type.count;
+        int32_t d = 0, d_count = dst->type.count;
+        while (s < s_count || d < d_count) {
+            ecs_id_t s_id = s < s_count ? src_ids[s] : 0;
+            ecs_id_t d_id = d < d_count ? dst_ids[d] : 0;
+            if (s_id == d_id) {
+                s ++;
+                d ++;
+                continue;
+            }
+
+            if (d == d_count || (s < s_count && s_id < d_id)) {
+                if (ECS_IS_PAIR(s_id)) {
+                    return false;
                 }
-                break;
+                s ++;
+            } else {
+                if (ECS_IS_PAIR(d_id)) {
+                    return false;
+                }
+                d ++;
             }
-            case EcsCmdClone:
-            case EcsCmdBulkNew:
-            case EcsCmdAdd:
-            case EcsCmdRemove:
-            case EcsCmdEmplace:
-            case EcsCmdModified:
-            case EcsCmdModifiedNoHook:
-            case EcsCmdAddModified:
-            case EcsCmdPath:
-            case EcsCmdDelete:
-            case EcsCmdClear:
-            case EcsCmdOnDeleteAction:
-            case EcsCmdEnable:
-            case EcsCmdDisable:
-            case EcsCmdEvent:
-            case EcsCmdSkip:
-                break;
+        }
+    }
+
+    /* Add/remove hooks can access the world */
+    if (flags & (EcsTableHasCtors|EcsTableHasDtors)) {
+        int32_t i;
+        for (i = 0; i < src->column_count; i ++) {
+            const ecs_type_info_t *ti = src->data.columns[i].ti;
+            if (ti->hooks.on_add || ti->hooks.on_remove) {
+                return false;
+            }
+        }
+        for (i = 0; i < dst->column_count; i ++) {
+            const ecs_type_info_t *ti = dst->data.columns[i].ti;
+            if (ti->hooks.on_add || ti->hooks.on_remove) {
+                return false;
+            }
+        }
+    }
+
+    return true;
+}
+
+static
+ecs_merge_group_t* flecs_merge_group_ensure(
+    ecs_world_t *world,
+    ecs_merge_parallel_t *m,
+    ecs_table_t *src,
+    ecs_table_t *dst)
+{
+    int32_t src_index = flecs_merge_table_ensure(world, m, src);
+    ecs_merge_table_t *tables = ecs_vec_first_t(&m->tables, ecs_merge_table_t);
+    ecs_merge_group_t *groups = ecs_vec_first_t(&m->groups, ecs_merge_group_t);
+
+    int32_t cur;
+    for (cur = tables[src_index].first_out; cur != -1; 
+        cur = groups[cur].next_out) 
+    {
+        if (groups[cur].dst == dst) {
+            return &groups[cur];
+        }
+    }
+
+    int32_t dst_index = flecs_merge_table_ensure(world, m, dst);
+    tables = ecs_vec_first_t(&m->tables, ecs_merge_table_t);
+
+    int32_t index = ecs_vec_count(&m->groups);
+    ecs_merge_group_t *group = ecs_vec_append_t(
+        &world->allocator, &m->groups, ecs_merge_group_t);
+    group->src = src;
+    group->dst = dst;
+    group->src_index = src_index;
+    group->dst_index = dst_index;
+    group->next_out = tables[src_index].first_out;
+    group->next = -1;
+    group->first_move = -1;
+    group->last_move = -1;
+    group->parallel = flecs_merge_group_is_parallel(src, dst);
+    tables[src_index].first_out = index;
+
+    if (group->parallel) {
+        /* Join jobs of source and destination table */
+        int32_t src_root = flecs_merge_table_root(tables, src_index);
+        int32_t dst_root = flecs_merge_table_root(tables, dst_index);
+        if (src_root != dst_root) {
+            tables[dst_root].parent = src_root;
+        }
+    }
+
+    return group;
+}
+
+/* Same test as flecs_remove_invalid, without running cleanup actions */
+static
+bool flecs_merge_id_is_valid(
+    ecs_world_t *world,
+    ecs_id_t id)
+{
+    if (ECS_HAS_ID_FLAG(id, PAIR)) {
+        return flecs_entities_is_valid(world, ECS_PAIR_FIRST(id)) &&
+            flecs_entities_is_valid(world, ECS_PAIR_SECOND(id));
+    }
+    return flecs_entities_is_valid(world, id & ECS_COMPONENT_MASK);
+}
+
+/* Find destination table for the commands of an entity. If the entity can be 
+ * moved on a worker thread, add it to the move group for its tables. */
+static
+void flecs_merge_prepare_entity(
+    ecs_world_t *world,
+    ecs_merge_parallel_t *m,
+    ecs_table_diff_builder_t *diff,
+    ecs_entity_t entity,
+    ecs_cmd_t *cmds,
+    int32_t start)
+{
+    if (ecs_vec_count(&world->sparse_ids) && 
+        flecs_cmd_batch_has_sparse(world, cmds, start)) 
+    {
+        return;
+    }
+
+    ecs_record_t *r = flecs_entities_get(world, entity);
+    ecs_table_t *src = r->table;
+    if (!src || (r->row & EcsEntityIsTraversable)) {
+        return;
+    }
+
+    ecs_table_t *dst = src;
+    int32_t cur = start;
+    do {
+        ecs_cmd_t *cmd = &cmds[cur];
+        ecs_id_t id = cmd->id;
+        switch(cmd->kind) {
+        case EcsCmdAdd:
+        case EcsCmdAddModified:
+        case EcsCmdSet:
+        case EcsCmdEnsure:
+            if (!flecs_merge_id_is_valid(world, id)) {
+                goto done;
+            }
+            dst = flecs_find_table_add(world, dst, id, diff);
+            break;
+        case EcsCmdRemove:
+            if (!flecs_merge_id_is_valid(world, id)) {
+                goto done;
+            }
+            dst = flecs_find_table_remove(world, dst, id, diff);
+            break;
+        case EcsCmdClone:
+        case EcsCmdBulkNew:
+        case EcsCmdEmplace:
+        case EcsCmdModified:
+        case EcsCmdModifiedNoHook:
+        case EcsCmdPath:
+        case EcsCmdDelete:
+        case EcsCmdClear:
+        case EcsCmdOnDeleteAction:
+        case EcsCmdEnable:
+        case EcsCmdDisable:
+        case EcsCmdEvent:
+        case EcsCmdSkip:
+            goto done;
+        }
+
+        cur = cmd->next_for_entity;
+        if (cur < 0) {
+            cur *= -1;
+        }
+    } while (cur);
+
+    if (dst == src || !dst->type.count) {
+        goto done;
+    }
+
+    ecs_merge_group_t *group = flecs_merge_group_ensure(world, m, src, dst);
+    if (!group->parallel) {
+        goto done;
+    }
+
+    /* Entity will be moved by a worker. What's left for the main thread are
+     * the modified commands that invoke OnSet observers. */
+    world->info.cmd.batched_entity_count ++;
+    cur = start;
+    do {
+        ecs_cmd_t *cmd = &cmds[cur];
+        if (cmd->kind == EcsCmdAdd || cmd->kind == EcsCmdRemove) {
+            cmd->kind = EcsCmdSkip;
+        } else if (cmd->kind == EcsCmdAddModified) {
+            cmd->kind = EcsCmdModified;
+        }
+        world->info.cmd.batched_command_count ++;
+
+        cur = cmd->next_for_entity;
+        if (cur < 0) {
+            cur *= -1;
+        }
+    } while (cur);
+
+    /* Don't batch commands for entity again when queue is processed */
+    if (cmds[start].next_for_entity < 0) {
+        cmds[start].next_for_entity *= -1;
+    }
+
+    int32_t index = ecs_vec_count(&m->moves);
+    ecs_merge_move_t *move = ecs_vec_append_t(
+        &world->allocator, &m->moves, ecs_merge_move_t);
+    move->record = r;
+    move->entity = entity;
+    move->cmd = start;
+    move->next = -1;
+
+    if (group->last_move != -1) {
+        ecs_vec_get_t(&m->moves, ecs_merge_move_t, group->last_move)->next = 
+            index;
+    } else {
+        group->first_move = index;
+    }
+    group->last_move = index;
+
+    ecs_vec_get_t(&m->tables, ecs_merge_table_t, group->dst_index)->added ++;
+
+done:
+    flecs_table_diff_builder_clear(diff);
+}
+
+/* Collect command batches at the start of the queue that can be moved on worker
+ * threads. Stops at the first command that isn't batched (such as delete), as
+ * this could affect entities of commands that come after it. */
+static
+void flecs_merge_prepare(
+    ecs_world_t *world,
+    ecs_merge_parallel_t *m,
+    ecs_table_diff_builder_t *diff,
+    ecs_cmd_t *cmds,
+    int32_t count)
+{
+    int32_t i;
+    for (i = 0; i < count; i ++) {
+        ecs_cmd_t *cmd = &cmds[i];
+        ecs_cmd_kind_t kind = cmd->kind;
+        if (kind == EcsCmdClone || kind == EcsCmdBulkNew || 
+            kind == EcsCmdPath || kind == EcsCmdDelete || 
+            kind == EcsCmdOnDeleteAction || kind == EcsCmdEnable ||
+            kind == EcsCmdDisable || kind == EcsCmdEvent)
+        {
+            break;
+        }
+
+        /* Only the first command for an entity has an entry */
+        if (!cmd->entry) {
+            continue;
+        }
+
+        ecs_entity_t e = cmd->entity;
+        if (flecs_entities_is_alive(world, e)) {
+            flecs_merge_prepare_entity(world, m, diff, e, cmds, i);
+        }
+    }
+}
+
+/* Move entity to destination table. Runs on a worker thread, storage has been
+ * reserved by the main thread so that no allocations are needed. */
+static
+void flecs_merge_move_entity(
+    ecs_world_t *world,
+    ecs_cmd_t *cmds,
+    ecs_merge_move_t *move,
+    ecs_table_t *src,
+    ecs_table_t *dst)
+{
+    ecs_record_t *r = move->record;
+    ecs_entity_t entity = move->entity;
+    ecs_assert(r->table == src, ECS_INTERNAL_ERROR, NULL);
+
+    int32_t src_row = ECS_RECORD_TO_ROW(r->row);
+    int32_t dst_row = flecs_table_append(world, dst, entity, false, false);
+    flecs_table_move(world, entity, entity, dst, dst_row, src, src_row, true);
+    r->table = dst;
+    r->row = ECS_ROW_TO_RECORD(dst_row, r->row & ECS_ROW_FLAGS_MASK);
+    flecs_table_delete(world, src, src_row, false);
+
+    flecs_cmd_batch_set_values(world, r, cmds, move->cmd);
+    flecs_cmd_batch_collapse_modified(cmds, move->cmd);
+}
+
+/* Worker task that claims jobs until all of them have been moved */
+static
+void flecs_merge_worker(
+    ecs_world_t *world,
+    ecs_stage_t *stage,
+    void *ctx)
+{
+    (void)stage;
+    ecs_merge_parallel_t *m = ctx;
+    ecs_merge_table_t *tables = ecs_vec_first_t(&m->tables, ecs_merge_table_t);
+    ecs_merge_group_t *groups = ecs_vec_first_t(&m->groups, ecs_merge_group_t);
+    ecs_merge_move_t *moves = ecs_vec_first_t(&m->moves, ecs_merge_move_t);
+    int32_t *jobs = ecs_vec_first_t(&m->jobs, int32_t);
+    int32_t i, job_count = ecs_vec_count(&m->jobs);
+
+    while ((i = ecs_os_ainc(&m->next) - 1) < job_count) {
+        int32_t g, mv;
+        for (g = tables[jobs[i]].first_group; g != -1; g = groups[g].next) {
+            ecs_merge_group_t *group = &groups[g];
+            for (mv = group->first_move; mv != -1; mv = moves[mv].next) {
+                flecs_merge_move_entity(world, m->cmds, &moves[mv], 
+                    group->src, group->dst);
+            }
+        }
+    }
+}
+
+/* Move entities for command batches in queue to their destination tables on 
+ * worker threads. Entities that are moved between the same tables, or between
+ * tables that share a source or destination, are moved by the same thread. 
+ * Anything that needs world state (creating tables, updating the empty state of
+ * tables and invoking observers) happens on the main thread. */
+static
+void flecs_merge_parallel(
+    ecs_world_t *world,
+    ecs_table_diff_builder_t *diff,
+    ecs_cmd_t *cmds,
+    int32_t count)
+{
+    if (!(world->flags & EcsWorldParallelMerge) || 
+        !flecs_workers_can_run_task(world)) 
+    {
+        return;
+    }
+
+    ecs_allocator_t *a = &world->allocator;
+    ecs_merge_parallel_t m = { .cmds = cmds };
+    ecs_map_init(&m.table_index, a);
+    ecs_vec_init_t(a, &m.tables, ecs_merge_table_t, 0);
+    ecs_vec_init_t(a, &m.groups, ecs_merge_group_t, 0);
+    ecs_vec_init_t(a, &m.moves, ecs_merge_move_t, 0);
+    ecs_vec_init_t(a, &m.jobs, int32_t, 0);
+
+    flecs_merge_prepare(world, &m, diff, cmds, count);
+
+    int32_t move_count = ecs_vec_count(&m.moves);
+    if (!move_count) {
+        goto done;
+    }
+
+    /* Reserve storage so that workers don't have to allocate */
+    ecs_merge_table_t *tables = ecs_vec_first_t(&m.tables, ecs_merge_table_t);
+    int32_t i, table_count = ecs_vec_count(&m.tables);
+    for (i = 0; i < table_count; i ++) {
+        if (tables[i].added) {
+            flecs_table_reserve(world, tables[i].table, tables[i].added);
+        }
+    }
+
+    /* Assign groups to jobs, in the order in which they were created */
+    ecs_merge_group_t *groups = ecs_vec_first_t(&m.groups, ecs_merge_group_t);
+    int32_t group_count = ecs_vec_count(&m.groups);
+    for (i = 0; i < group_count; i ++) {
+        ecs_merge_group_t *group = &groups[i];
+        if (group->first_move == -1) {
+            continue;
+        }
+
+        ecs_merge_table_t *root = &tables[
+            flecs_merge_table_root(tables, group->src_index)];
+        if (root->last_group != -1) {
+            groups[root->last_group].next = i;
+        } else {
+            root->first_group = i;
+            ecs_vec_append_t(a, &m.jobs, int32_t)[0] = 
+                flecs_ito(int32_t, root - tables);
+        }
+        root->last_group = i;
+    }
+
+    ECS_BIT_SET(world->flags, EcsWorldParallelMerging);
+    if (ecs_vec_count(&m.jobs) > 1) {
+        flecs_workers_run_task(world, flecs_merge_worker, &m);
+    } else {
+        /* Not worth waking up workers for a single job */
+        flecs_merge_worker(world, &world->stages[0], &m);
+    }
+    ECS_BIT_CLEAR(world->flags, EcsWorldParallelMerging);
+
+    /* Tables that became empty or non-empty weren't registered by workers */
+    for (i = 0; i < table_count; i ++) {
+        ecs_table_t *table = tables[i].table;
+        if (tables[i].was_empty != (ecs_table_count(table) == 0)) {
+            flecs_table_set_empty(world, table);
+        }
+    }
+
+    world->info.cmd.parallel_entity_count += move_count;
+
+done:
+    ecs_map_fini(&m.table_index);
+    ecs_vec_fini_t(a, &m.tables, ecs_merge_table_t);
+    ecs_vec_fini_t(a, &m.groups, ecs_merge_group_t);
+    ecs_vec_fini_t(a, &m.moves, ecs_merge_move_t);
+    ecs_vec_fini_t(a, &m.jobs, int32_t);
+}
+
+#endif
+
+/* OnSet notifications of modified commands are coalesced while merging, so that
+ * observers are invoked once for a range of entities in the same table instead
+ * of once per entity. */
+typedef struct ecs_cmd_on_set_t {
+    ecs_table_t *table;
+    ecs_id_t id;
+    int32_t row;
+    bool owned;
+    ecs_vec_t entities;              /* vector<ecs_entity_t> */
+} ecs_cmd_on_set_t;
+
+/* Invoke OnSet notifications for coalesced modified commands. Observers that 
+ * ran since the commands were coalesced could have moved entities, in which 
+ * case notifications are sent one entity at a time. */
+static
+void flecs_cmd_on_set_flush(
+    ecs_world_t *world,
+    ecs_stage_t *stage,
+    ecs_cmd_on_set_t *batch)
+{
+    int32_t i, count = ecs_vec_count(&batch->entities);
+    if (!count) {
+        return;
+    }
+
+    ecs_table_t *table = batch->table;
+    ecs_id_t id = batch->id;
+    int32_t row = batch->row;
+    ecs_entity_t *entities = ecs_vec_first_t(&batch->entities, ecs_entity_t);
+
+    bool valid = (row + count) <= ecs_table_count(table) && 
+        flecs_table_record_get(world, table, id) != NULL;
+    if (valid) {
+        ecs_entity_t *stored = ecs_vec_get_t(
+            &table->data.entities, ecs_entity_t, row);
+        valid = !ecs_os_memcmp(stored, entities, 
+            count * ECS_SIZEOF(ecs_entity_t));
+    }
+
+    if (valid) {
+        ecs_type_t ids = { .array = &id, .count = 1 };
+        flecs_defer_begin(world, stage);
+        flecs_notify_on_set(world, table, row, count, &ids, batch->owned);
+        for (i = 0; i < count; i ++) {
+            flecs_table_mark_dirty(world, table, row + i, id);
+        }
+        flecs_defer_end(world, stage);
+    } else {
+        for (i = 0; i < count; i ++) {
+            if (flecs_entities_is_alive(world, entities[i])) {
+                flecs_modified_id_if(world, entities[i], id, batch->owned);
             }
-        } while ((cur = next_for_entity));
+        }
     }
+
+    ecs_vec_clear(&batch->entities);
+    batch->table = NULL;
+}
+
+/* Add modified command to the current range if the entity is stored in the row
+ * after the last entity of the range, otherwise start a new range. */
+static
+void flecs_cmd_on_set_add(
+    ecs_world_t *world,
+    ecs_stage_t *stage,
+    ecs_cmd_on_set_t *batch,
+    ecs_entity_t entity,
+    ecs_id_t id,
+    bool owned)
+{
+    if (flecs_sparse_id_record(world, id)) {
+        flecs_cmd_on_set_flush(world, stage, batch);
+        flecs_modified_id_if(world, entity, id, owned);
+        return;
+    }
+
+    ecs_record_t *r = flecs_entities_get(world, entity);
+    ecs_table_t *table = r->table;
+    if (!table || !flecs_table_record_get(world, table, id)) {
+        return;
+    }
+
+    int32_t row = ECS_RECORD_TO_ROW(r->row);
+    int32_t count = ecs_vec_count(&batch->entities);
+    if (count) {
+        if ((batch->table != table) || (batch->id != id) || 
+            (batch->owned != owned) || (batch->row + count != row))
+        {
+            flecs_cmd_on_set_flush(world, stage, batch);
+            count = 0;
+        }
+    }
+
+    if (!count) {
+        batch->table = table;
+        batch->id = id;
+        batch->row = row;
+        batch->owned = owned;
+    }
+
+    ecs_vec_append_t(&world->allocator, &batch->entities, ecs_entity_t)[0] = 
+        entity;
 }
 
 /* Leave safe section. Run all deferred commands. */
@@ -8527,6 +10481,13 @@ bool flecs_defer_end(
                     world->on_commands_ctx_active);
             }
 
+            /* Internal callback for recording commands that are merged with
+             * the world. Commands enqueued while merging are not recorded. */
+            if (world->on_commands_record && merge_to_world && !stage->cmd_sp) {
+                world->on_commands_record(stage, queue, 
+                    world->on_commands_record_ctx);
+            }
+
             ecs_cmd_t *cmds = ecs_vec_first(queue);
             int32_t i, count = ecs_vec_count(queue);
 
@@ -8534,6 +10495,15 @@ bool flecs_defer_end(
             flecs_table_diff_builder_init(world, &diff);
             flecs_commands_push(stage);
 
+            ecs_cmd_on_set_t on_set = {0};
+            ecs_vec_init_t(&world->allocator, &on_set.entities, ecs_entity_t, 0);
+
+#ifdef FLECS_PIPELINE
+            if (merge_to_world) {
+                flecs_merge_parallel(world, &diff, cmds, count);
+            }
+#endif
+
             for (i = 0; i < count; i ++) {
                 ecs_cmd_t *cmd = &cmds[i];
                 ecs_entity_t e = cmd->entity;
@@ -8566,6 +10536,14 @@ bool flecs_defer_end(
 
                 ecs_id_t id = cmd->id;
 
+                /* Coalesced OnSet notifications are sent before a command that
+                 * could depend on them is executed. */
+                if ((kind != EcsCmdSet) && (kind != EcsCmdAddModified) &&
+                    (kind != EcsCmdModified) && (kind != EcsCmdModifiedNoHook)) 
+                {
+                    flecs_cmd_on_set_flush(world, dst_stage, &on_set);
+                }
+
                 switch(kind) {
                 case EcsCmdAdd:
                     ecs_assert(id != 0, ECS_INTERNAL_ERROR, NULL);
@@ -8590,9 +10568,19 @@ bool flecs_defer_end(
                     world->info.cmd.other_count ++;
                     break;
                 case EcsCmdSet:
-                    flecs_move_ptr_w_id(world, dst_stage, e, 
-                        cmd->id, flecs_itosize(cmd->is._1.size), 
-                        cmd->is._1.value, kind);
+                    if (merge_to_world) {
+                        /* Assign value without notifying, and coalesce the
+                         * OnSet notification with other set commands. */
+                        flecs_move_ptr_w_id(world, dst_stage, e, 
+                            cmd->id, flecs_itosize(cmd->is._1.size), 
+                            cmd->is._1.value, EcsCmdEnsure);
+                        flecs_cmd_on_set_add(
+                            world, dst_stage, &on_set, e, id, true);
+                    } else {
+                        flecs_move_ptr_w_id(world, dst_stage, e, 
+                            cmd->id, flecs_itosize(cmd->is._1.size), 
+                            cmd->is._1.value, kind);
+                    }
                     world->info.cmd.set_count ++;
                     break;
                 case EcsCmdEmplace:
@@ -8611,16 +10599,25 @@ bool flecs_defer_end(
                     world->info.cmd.ensure_count ++;
                     break;
                 case EcsCmdModified:
-                    flecs_modified_id_if(world, e, id, true);
-                    world->info.cmd.modified_count ++;
-                    break;
-                case EcsCmdModifiedNoHook:
-                    flecs_modified_id_if(world, e, id, false);
+                case EcsCmdModifiedNoHook: {
+                    bool owned = kind == EcsCmdModified;
+                    if (merge_to_world) {
+                        flecs_cmd_on_set_add(
+                            world, dst_stage, &on_set, e, id, owned);
+                    } else {
+                        flecs_modified_id_if(world, e, id, owned);
+                    }
                     world->info.cmd.modified_count ++;
                     break;
+                }
                 case EcsCmdAddModified:
                     flecs_add_id(world, e, id);
-                    flecs_modified_id_if(world, e, id, true);
+                    if (merge_to_world) {
+                        flecs_cmd_on_set_add(
+                            world, dst_stage, &on_set, e, id, true);
+                    } else {
+                        flecs_modified_id_if(world, e, id, true);
+                    }
                     world->info.cmd.set_count ++;
                     break;
                 case EcsCmdDelete: {
@@ -8686,6 +10683,9 @@ bool flecs_defer_end(
                 }
             }
 
+            flecs_cmd_on_set_flush(world, dst_stage, &on_set);
+            ecs_vec_fini_t(&world->allocator, &on_set.entities, ecs_entity_t);
+
             flecs_stack_reset(&commands->stack);
             ecs_vec_clear(queue);
             flecs_commands_pop(stage);
@@ -8744,8 +10744,9 @@ error:
  * After a table has been matched by a query, additional filters may have to
  * be applied before returning entities to the application. The two scenarios
  * under which this happens are queries for union relationship pairs (entities
- * for multiple targets are stored in the same table) and toggles (components 
- * that are enabled/disabled with a bitset).
+ * for multiple targets are stored in the same table), toggles (components 
+ * that are enabled/disabled with a bitset) and sparse components (components
+ * that are stored outside of tables).
  */
 
 
@@ -9387,6 +11388,199 @@ int flecs_entity_filter_next(
     }
 }
 
+static
+bool flecs_sparse_term_match(
+    const ecs_term_t *term,
+    ecs_entity_t e)
+{
+    ecs_oper_kind_t oper = term->oper;
+    if (oper == EcsOptional) {
+        return true;
+    }
+
+    bool has = flecs_id_record_sparse_has(term->idr, e);
+    if (oper == EcsNot) {
+        return !has;
+    }
+
+    return has;
+}
+
+static
+bool flecs_sparse_this_match(
+    const ecs_filter_t *filter,
+    ecs_entity_t e)
+{
+    const ecs_term_t *terms = filter->terms;
+    int32_t i, count = filter->term_count;
+    for (i = 0; i < count; i ++) {
+        const ecs_term_t *term = &terms[i];
+        if (!(term->flags & EcsTermIsSparse) || !ecs_term_match_this(term)) {
+            continue;
+        }
+        if (!flecs_sparse_term_match(term, e)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static
+void flecs_sparse_populate(
+    ecs_iter_t *it,
+    const ecs_filter_t *filter,
+    bool clear)
+{
+    const ecs_term_t *terms = filter->terms;
+    int32_t i, count = filter->term_count;
+    it->sparse_fields = 0;
+
+    for (i = 0; i < count; i ++) {
+        const ecs_term_t *term = &terms[i];
+        if (!(term->flags & EcsTermIsSparse)) {
+            continue;
+        }
+
+        int32_t field = term->field_index;
+        void *ptr = NULL;
+        if (!clear) {
+            ecs_entity_t e;
+            if (ecs_term_match_this(term)) {
+                if (!it->count) {
+                    continue;
+                }
+                e = it->entities[0];
+            } else if (term->src.flags & EcsIsEntity) {
+                e = term->src.id;
+            } else {
+                continue;
+            }
+
+            if (flecs_id_record_sparse_has(term->idr, e)) {
+                it->sparse_fields |= 1u << field;
+                ptr = flecs_id_record_sparse_get(term->idr, e);
+            }
+        }
+
+        if (it->ptrs && (term->inout != EcsInOutNone)) {
+            it->ptrs[field] = ptr;
+        }
+    }
+}
+
+bool flecs_sparse_filter_next(
+    ecs_iter_t *it,
+    ecs_iter_next_action_t next)
+{
+    const ecs_filter_t *filter = it->query;
+    if (!filter || !(filter->flags & EcsFilterHasSparse) || 
+        (it->flags & (EcsIterEntityOptional|EcsIterTableOnly))) 
+    {
+        return next(it);
+    }
+
+    ecs_entity_filter_iter_t *ent_it = it->priv.entity_iter;
+    const ecs_term_t *terms = filter->terms;
+    int32_t i, term_count = filter->term_count;
+
+    /* If a sparse term for $this returns data, or can be optionally set, each
+     * entity has to be returned separately. Otherwise return ranges of entities
+     * for which all sparse terms match. */
+    bool match_this = false, per_entity = false;
+    for (i = 0; i < term_count; i ++) {
+        const ecs_term_t *term = &terms[i];
+        if (!(term->flags & EcsTermIsSparse) || !ecs_term_match_this(term)) {
+            continue;
+        }
+        match_this = true;
+        if (term->oper == EcsOptional) {
+            per_entity = true;
+        } else if (term->oper != EcsNot && term->inout != EcsInOutNone && 
+            term->idr->type_info) 
+        {
+            per_entity = true;
+        }
+    }
+
+    do {
+        if (ent_it->sparse_active) {
+            /* Restore range returned by the iterator. Clear sparse pointers
+             * first, so they're not offset with the entity range. */
+            flecs_sparse_populate(it, filter, true);
+            int32_t shift = it->offset - ent_it->sparse_offset;
+            if (shift) {
+                flecs_offset_iter(it, -shift);
+            }
+            it->offset = ent_it->sparse_offset;
+            it->count = ent_it->sparse_count;
+            it->frame_offset = ent_it->sparse_frame_offset;
+
+            int32_t row = ent_it->sparse_row, end = it->count;
+            ecs_entity_t *entities = it->entities;
+            while (row < end && !flecs_sparse_this_match(filter, entities[row])) {
+                row ++;
+            }
+
+            if (row == end) {
+                ent_it->sparse_active = false;
+                continue;
+            }
+
+            int32_t last = row + 1;
+            if (!per_entity) {
+                while (last < end && 
+                    flecs_sparse_this_match(filter, entities[last])) 
+                {
+                    last ++;
+                }
+            }
+
+            ent_it->sparse_row = last;
+            if (row) {
+                flecs_offset_iter(it, row);
+            }
+            it->offset += row;
+            it->count = last - row;
+            it->frame_offset += row;
+            flecs_sparse_populate(it, filter, false);
+            return true;
+        }
+
+        if (!next(it)) {
+            return false;
+        }
+
+        /* Evaluate sparse terms with a fixed source */
+        for (i = 0; i < term_count; i ++) {
+            const ecs_term_t *term = &terms[i];
+            if (!(term->flags & EcsTermIsSparse)) {
+                continue;
+            }
+            if (ecs_term_match_this(term) || !(term->src.flags & EcsIsEntity)) {
+                continue;
+            }
+            if (!flecs_sparse_term_match(term, term->src.id)) {
+                break;
+            }
+        }
+
+        if (i != term_count) {
+            continue;
+        }
+
+        if (!match_this || !it->count || !it->entities) {
+            flecs_sparse_populate(it, filter, false);
+            return true;
+        }
+
+        ent_it->sparse_active = true;
+        ent_it->sparse_offset = it->offset;
+        ent_it->sparse_count = it->count;
+        ent_it->sparse_frame_offset = it->frame_offset;
+        ent_it->sparse_row = 0;
+    } while (true);
+}
+
 /**
  * @file entity_name.c
  * @brief Functions for working with named entities.
@@ -10895,6 +13089,30 @@ int flecs_term_finalize(
         return -1;
     }
 
+    /* Sparse components aren't stored in tables and can't be inherited. They
+     * are evaluated per entity after a table has been matched. */
+    if (id_flags & EcsIdSparse) {
+        if (src_flags & (EcsUp | EcsDown)) {
+            flecs_filter_error(ctx, "sparse component cannot be traversed");
+            return -1;
+        }
+        if ((src->flags & EcsIsVariable) && (src->id != EcsThis)) {
+            flecs_filter_error(ctx, 
+                "sparse component can only be matched on $this or entity");
+            return -1;
+        }
+        if (term->oper != EcsAnd && term->oper != EcsNot && 
+            term->oper != EcsOptional) 
+        {
+            flecs_filter_error(ctx, "invalid operator for sparse component");
+            return -1;
+        }
+        src->flags &= ~(EcsUp | EcsDown);
+        src->flags |= EcsSelf;
+        src->trav = 0;
+        term->flags |= EcsTermIsSparse;
+    }
+
     if (term->id_flags & ECS_AND) {
         term->oper = EcsAndFrom;
         term->id &= ECS_COMPONENT_MASK;
@@ -10932,7 +13150,7 @@ int flecs_term_finalize(
     if (!ecs_term_match_this(term)) {
         trivial_term = false;
     }
-    if (term->flags & EcsTermIdInherited) {
+    if (term->flags & (EcsTermIdInherited|EcsTermIsSparse)) {
         trivial_term = false;
     }
     if (src->trav && src->trav != EcsIsA) {
@@ -11238,6 +13456,132 @@ ecs_term_t* flecs_filter_or_other_type(
     }
 }
 
+/* Get id that is added to filter signature for term. Returns 0 if the term
+ * can't be represented in the signature. */
+static
+ecs_id_t flecs_filter_signature_id(
+    const ecs_world_t *world,
+    const ecs_term_t *term)
+{
+    ecs_id_t id = term->id;
+    if (!ECS_IS_PAIR(id)) {
+        if (id & ECS_ID_FLAGS_MASK) {
+            return 0;
+        }
+        if (id == EcsWildcard || id == EcsAny) {
+            return 0;
+        }
+        if (term->first.flags & EcsIsVariable) {
+            return 0;
+        }
+        return id;
+    }
+
+    ecs_entity_t first = ECS_PAIR_FIRST(id);
+    ecs_entity_t second = ECS_PAIR_SECOND(id);
+    if (first == EcsAny || (term->first.flags & EcsIsVariable)) {
+        first = EcsWildcard;
+    }
+    if (second == EcsAny || (term->second.flags & EcsIsVariable)) {
+        second = EcsWildcard;
+    }
+    if (!first || !second) {
+        return 0;
+    }
+    if (first == EcsWildcard && second == EcsWildcard) {
+        return 0;
+    }
+
+    /* Union pairs are stored as (Union, Relationship) */
+    if (first != EcsWildcard) {
+        ecs_id_record_t *idr = flecs_id_record_get(world, 
+            ecs_pair(first, EcsWildcard));
+        if (idr && (idr->flags & EcsIdUnion)) {
+            return 0;
+        }
+    }
+
+    return ecs_pair(first, second);
+}
+
+/* Compute signatures with the ids a table must have to match the filter */
+static
+void flecs_filter_init_signature(
+    const ecs_world_t *world,
+    ecs_filter_t *f)
+{
+    ecs_os_zeromem(&f->signature);
+    ecs_os_zeromem(&f->signature_up);
+    ecs_os_zeromem(&f->signature_trav);
+
+    ecs_entity_t up_trav = 0;
+    int32_t i, term_count = f->term_count;
+    for (i = 0; i < term_count; i ++) {
+        ecs_term_t *term = &f->terms[i];
+        if (term->oper != EcsAnd || (i && term[-1].oper == EcsOr)) {
+            continue;
+        }
+        if (!ecs_term_match_this(term)) {
+            continue;
+        }
+        if (term->flags & (EcsTermIsSparse|EcsTermTransitive|
+            EcsTermReflexive|EcsTermIdInherited)) 
+        {
+            continue;
+        }
+
+        ecs_id_t id = flecs_filter_signature_id(world, term);
+        if (!id) {
+            continue;
+        }
+
+        const ecs_term_id_t *src = &term->src;
+        if (src->flags & EcsDown) {
+            continue;
+        }
+
+        if (!(src->flags & EcsUp)) {
+            flecs_id_signature_add(&f->signature, id);
+        } else if (!(src->flags & EcsSelf)) {
+            /* Table must have the traversed relationship */
+            flecs_id_signature_add(&f->signature, 
+                ecs_pair(src->trav, EcsWildcard));
+        } else {
+            /* Table must have the id, or have the traversed relationship. Only
+             * one relationship is tracked, which is typically IsA. */
+            if (!up_trav) {
+                up_trav = src->trav;
+                flecs_id_signature_add(&f->signature_trav, 
+                    ecs_pair(up_trav, EcsWildcard));
+            }
+            if (src->trav == up_trav) {
+                flecs_id_signature_add(&f->signature_up, id);
+            }
+        }
+    }
+}
+
+bool flecs_filter_signature_match(
+    const ecs_filter_t *filter,
+    const ecs_table_t *table)
+{
+    /* Flattened tables can match up terms without the relationship */
+    if (table->flags & EcsTableHasTarget) {
+        return true;
+    }
+
+    const ecs_id_signature_t *sig = &table->_->signature;
+    if (!flecs_id_signature_has(sig, &filter->signature)) {
+        return false;
+    }
+
+    if (!flecs_id_signature_has(sig, &filter->signature_up)) {
+        return flecs_id_signature_has(sig, &filter->signature_trav);
+    }
+
+    return true;
+}
+
 int ecs_filter_finalize(
     const ecs_world_t *world,
     ecs_filter_t *f)
@@ -11353,10 +13697,23 @@ int ecs_filter_finalize(
         if (filter_term) {
             filter_terms ++;
             term->flags |= EcsTermNoData;
+        } else if (term->flags & EcsTermIsSparse) {
+            /* Sparse data isn't stored in tables, so iterators populate it
+             * for each entity after matching the table. */
+            term->flags |= EcsTermNoData;
         } else {
             f->data_fields |= (1llu << term->field_index);
         }
 
+        if (term->flags & EcsTermIsSparse) {
+            if (i && term[-1].oper == EcsOr) {
+                flecs_filter_error(&ctx, 
+                    "sparse component cannot be used with OR operator");
+                return -1;
+            }
+            ECS_BIT_SET(f->flags, EcsFilterHasSparse);
+        }
+
         if (term->oper != EcsNot || !ecs_term_match_this(term)) {
             ECS_BIT_CLEAR(f->flags, EcsFilterMatchAnything);
         }
@@ -11408,6 +13765,28 @@ int ecs_filter_finalize(
         return -1;
     }
 
+    if (f->flags & EcsFilterHasSparse) {
+        /* Sparse terms for $this are evaluated for the entities of tables that
+         * are matched by the other terms, so there must be at least one. */
+        bool this_sparse = false, this_table = false;
+        for (i = 0; i < term_count; i ++) {
+            ecs_term_t *term = &terms[i];
+            if (!ecs_term_match_this(term)) {
+                continue;
+            }
+            if (term->flags & EcsTermIsSparse) {
+                this_sparse = true;
+            } else if (term->oper == EcsAnd) {
+                this_table = true;
+            }
+        }
+        if (this_sparse && !this_table) {
+            flecs_filter_error(&ctx, 
+                "sparse component requires a non-sparse term for $this");
+            return -1;
+        }
+    }
+
     f->field_count = flecs_ito(int8_t, field_count);
 
     if (field_count) {
@@ -11472,6 +13851,8 @@ int ecs_filter_finalize(
 
     ECS_BIT_COND(f->flags, EcsFilterHasCondSet, cond_set);
 
+    flecs_filter_init_signature(world, f);
+
     /* Check if this is a trivial filter */
     if ((f->flags & EcsFilterMatchOnlyThis)) {
         if (!(f->flags & 
@@ -12385,6 +14766,17 @@ bool flecs_filter_match_table(
         match_count = *matches_left;
     }
 
+    /* Reject tables that can't match before looking up table records. When
+     * a term is skipped the signature can't be used, as it contains the id of
+     * the skipped term. */
+    if (table && (skip_term == -1) && 
+        !(iter_flags & (EcsFilterPopulate|EcsIterIgnoreThis))) 
+    {
+        if (!flecs_filter_signature_match(filter, table)) {
+            return false;
+        }
+    }
+
     for (i = 0; i < count; i ++) {
         ecs_term_t *term = &terms[i];
         ecs_oper_kind_t oper = term->oper;
@@ -12406,6 +14798,23 @@ bool flecs_filter_match_table(
             continue;
         }
 
+        if (term->flags & EcsTermIsSparse) {
+            /* Sparse terms are evaluated per entity by the iterator */
+            if (ids) {
+                ids[t_i] = term->id;
+            }
+            if (columns) {
+                columns[t_i] = 0;
+            }
+            if (sources) {
+                sources[t_i] = ecs_term_match_this(term) ? 0 : src_id;
+            }
+            if (match_indices) {
+                match_indices[t_i] = 0;
+            }
+            continue;
+        }
+
         if (!ecs_term_match_this(term)) {
             if (ecs_is_alive(world, src_id)) {
                 match_table = ecs_get_table(world, src_id);
@@ -12995,6 +15404,10 @@ int32_t ecs_filter_pivot_term(
             continue;
         }
 
+        if (term->flags & EcsTermIsSparse) {
+            continue;
+        }
+
         ecs_id_record_t *idr = flecs_query_id_record_get(world, id);
         if (!idr) {
             /* If one of the terms does not match with any data, iterator 
@@ -13168,7 +15581,8 @@ error:
     return false;
 }
 
-bool ecs_filter_next_instanced(
+static
+bool flecs_filter_next_instanced(
     ecs_iter_t *it)
 {
     ecs_check(it != NULL, ECS_INVALID_PARAMETER, NULL);
@@ -13294,6 +15708,17 @@ bool ecs_filter_next_instanced(
 
                     table = term_iter->table;
 
+                    /* Reject tables that can't match the other terms. The
+                     * table matches the pivot term, so the signature of the
+                     * filter can be used even though the term is skipped. */
+                    if (table && !(it->flags & EcsIterIgnoreThis) &&
+                        !flecs_filter_signature_match(filter, table))
+                    {
+                        it->table = table;
+                        iter->matches_left = 0;
+                        continue;
+                    }
+
                     if (pivot_term != -1) {
                         int32_t index = term->field_index;
                         it->ids[index] = term_iter->id;
@@ -13415,6 +15840,12 @@ yield:
     return true;    
 }
 
+bool ecs_filter_next_instanced(
+    ecs_iter_t *it)
+{
+    return flecs_sparse_filter_next(it, flecs_filter_next_instanced);
+}
+
 /**
  * @file iter.c
  * @brief Iterator API.
@@ -13823,7 +16254,8 @@ bool ecs_field_is_set(
     ecs_assert(index >= 1, ECS_INVALID_PARAMETER, NULL);
     int32_t column = it->columns[index - 1];
     if (!column) {
-        return false;
+        /* Sparse components aren't matched with a table column */
+        return (it->sparse_fields & (1u << (index - 1))) != 0;
     } else if (column < 0) {
         if (it->references) {
             column = -column - 1;
@@ -14010,6 +16442,90 @@ error:
     return 0;
 }
 
+static
+void flecs_iter_add_remove_id(
+    ecs_iter_t *it,
+    ecs_id_t id,
+    bool remove)
+{
+    ECS_BIT_SET(it->flags, EcsIterNoData);
+    ECS_BIT_SET(it->flags, EcsIterIsInstanced);
+
+    /* Collect results before modifying tables, as moving entities while the
+     * iterator is still running would invalidate it */
+    ecs_vec_t ranges, entities;
+    ecs_vec_init_t(NULL, &ranges, ecs_table_range_t, 0);
+    ecs_vec_init_t(NULL, &entities, ecs_entity_t, 0);
+
+    while (ecs_iter_next(it)) {
+        int32_t i, count = it->count;
+        if (!count) {
+            continue;
+        }
+
+        if (it->table) {
+            ecs_assert(flecs_table_entities_array(it->table)[it->offset] ==
+                it->entities[0], ECS_INTERNAL_ERROR, NULL);
+            ecs_table_range_t *range = ecs_vec_append_t(
+                NULL, &ranges, ecs_table_range_t);
+            range->table = it->table;
+            range->offset = it->offset;
+            range->count = count;
+        } else {
+            for (i = 0; i < count; i ++) {
+                ecs_vec_append_t(NULL, &entities, ecs_entity_t)[0] =
+                    it->entities[i];
+            }
+        }
+    }
+
+    ecs_world_t *world = it->world;
+    if (ecs_vec_count(&ranges)) {
+        flecs_bulk_add_remove_id(world, ecs_vec_first(&ranges),
+            ecs_vec_count(&ranges), id, remove);
+    }
+
+    /* Entities that are not stored in a table aren't moved by ranges */
+    int32_t i, count = ecs_vec_count(&entities);
+    ecs_entity_t *ids = ecs_vec_first(&entities);
+    for (i = 0; i < count; i ++) {
+        if (remove) {
+            ecs_remove_id(world, ids[i], id);
+        } else {
+            ecs_add_id(world, ids[i], id);
+        }
+    }
+
+    ecs_vec_fini_t(NULL, &ranges, ecs_table_range_t);
+    ecs_vec_fini_t(NULL, &entities, ecs_entity_t);
+}
+
+void ecs_iter_add_id(
+    ecs_iter_t *it,
+    ecs_id_t id)
+{
+    ecs_check(it != NULL, ECS_INVALID_PARAMETER, NULL);
+    ecs_check(it->next != NULL, ECS_INVALID_PARAMETER, NULL);
+    ecs_check(ecs_id_is_valid(it->real_world, id),
+        ECS_INVALID_PARAMETER, NULL);
+    flecs_iter_add_remove_id(it, id, false);
+error:
+    return;
+}
+
+void ecs_iter_remove_id(
+    ecs_iter_t *it,
+    ecs_id_t id)
+{
+    ecs_check(it != NULL, ECS_INVALID_PARAMETER, NULL);
+    ecs_check(it->next != NULL, ECS_INVALID_PARAMETER, NULL);
+    ecs_check(ecs_id_is_valid(it->real_world, id) || ecs_id_is_wildcard(id),
+        ECS_INVALID_PARAMETER, NULL);
+    flecs_iter_add_remove_id(it, id, true);
+error:
+    return;
+}
+
 ecs_entity_t ecs_iter_first(
     ecs_iter_t *it)
 {
@@ -14291,7 +16807,6 @@ error:
     return (ecs_iter_t){ 0 };
 }
 
-static
 void flecs_offset_iter(
     ecs_iter_t *it,
     int32_t offset)
@@ -14443,6 +16958,150 @@ error:
     return (ecs_iter_t){ 0 };
 }
 
+static
+int32_t flecs_worker_match_weight(
+    const ecs_query_table_match_t *match)
+{
+    if (!match->table) {
+        return 1;
+    }
+    if (match->count) {
+        return match->count;
+    }
+    return ecs_table_count(match->table);
+}
+
+/* Assign a contiguous range of the entities matched by a query to a worker.
+ * The range is computed from the prefix sum of the entity counts of all
+ * matches, so that each worker gets the same number of entities. Only the
+ * matches on the range boundaries are divided between workers, so that each
+ * worker visits roughly 1/Nth of the matched tables. */
+static
+void flecs_worker_partition_query(
+    ecs_iter_t *it,
+    ecs_worker_iter_t *worker)
+{
+    ecs_query_iter_t *iter = &it->priv.iter.query;
+    ecs_query_table_match_t *cur, *last = iter->last, *end = last;
+    int64_t total = 0, pos = 0, lo, hi;
+    int32_t index = worker->index, count = worker->count, skipped = 0;
+
+    for (cur = iter->node; cur != last; cur = cur->next) {
+        total += flecs_worker_match_weight(cur);
+    }
+
+    if (!total) {
+        /* Nothing to divide, let the first worker process the (empty) matches
+         * so that iteration behaves the same as without partitioning. */
+        if (index) {
+            iter->node = last;
+        }
+        return;
+    }
+
+    lo = (total * index) / count;
+    hi = (total * (index + 1)) / count;
+    if (lo == hi) {
+        iter->node = last;
+        return;
+    }
+
+    for (cur = iter->node; cur != last; cur = cur->next) {
+        int64_t weight = flecs_worker_match_weight(cur);
+        int64_t start = pos;
+        pos += weight;
+
+        if (pos <= lo) {
+            if (cur->table) {
+                skipped += ecs_table_count(cur->table);
+            }
+            continue;
+        }
+        if (start >= hi) {
+            end = cur;
+            break;
+        }
+
+        if (!worker->first) {
+            worker->first = cur;
+            worker->first_row = cur->offset + 
+                (int32_t)(lo > start ? lo - start : 0);
+        }
+
+        worker->last = cur;
+        worker->last_row = cur->offset + 
+            (int32_t)((hi < pos ? hi : pos) - start);
+    }
+
+    iter->node = worker->first;
+    iter->last = end;
+
+    /* Keep frame offset consistent with iterating all matches */
+    it->frame_offset += skipped;
+}
+
+ecs_iter_t ecs_balanced_worker_iter(
+    const ecs_iter_t *it,
+    int32_t index,
+    int32_t count)
+{
+    ecs_iter_t result = ecs_worker_iter(it, index, count);
+    if (!result.next) {
+        return result;
+    }
+
+    /* Entities can only be assigned to workers before the query iterator has
+     * returned its first result. */
+    if (it->next == ecs_query_next && !it->priv.iter.query.prev) {
+        ecs_worker_iter_t *worker = &result.priv.iter.worker;
+        flecs_worker_partition_query(result.chain_it, worker);
+        worker->balanced = true;
+    }
+
+    return result;
+}
+
+/* Clip result of query to the rows assigned to the worker */
+static
+bool flecs_worker_clip_balanced(
+    ecs_iter_t *it,
+    ecs_worker_iter_t *worker)
+{
+    if (!it->table) {
+        return true;
+    }
+
+    ecs_query_table_match_t *match = it->chain_it->priv.iter.query.prev;
+    int32_t offset = it->offset, end = offset + it->count;
+    int32_t first = offset, last = end;
+
+    if (match == worker->first && worker->first_row > first) {
+        first = worker->first_row;
+    }
+    if (match == worker->last && worker->last_row < last) {
+        last = worker->last_row;
+    }
+    if (first >= last) {
+        return false;
+    }
+    if (first == offset && last == end) {
+        return true;
+    }
+
+    int32_t skip = first - offset;
+    it->frame_offset += skip;
+    flecs_offset_iter(it, skip);
+    it->count = last - first;
+
+    if (ECS_BIT_IS_SET(it->flags, EcsIterIsInstanced)) {
+        it->offset += skip;
+    } else {
+        it->offset = 0;
+    }
+
+    return true;
+}
+
 static
 bool ecs_worker_next_instanced(
     ecs_iter_t *it)
@@ -14458,6 +17117,19 @@ bool ecs_worker_next_instanced(
     int32_t res_count = iter->count, res_index = iter->index;
     int32_t per_worker, instances_per_worker, first;
 
+    if (iter->balanced) {
+        /* Query only returns matches assigned to this worker */
+        do {
+            if (!ecs_iter_next(chain_it)) {
+                return false;
+            }
+
+            ecs_os_memcpy(it, chain_it, offsetof(ecs_iter_t, priv));
+            ECS_BIT_COND(it->flags, EcsIterIsInstanced, instanced);
+        } while (!flecs_worker_clip_balanced(it, iter));
+        return true;
+    }
+
     do {
         if (!ecs_iter_next(chain_it)) {
             return false;
@@ -14532,6 +17204,86 @@ error:
     return false;
 }
 
+ecs_iter_t ecs_chunk_iter(
+    const ecs_iter_t *it,
+    int32_t chunk_size)
+{
+    ecs_check(it != NULL, ECS_INVALID_PARAMETER, NULL);
+    ecs_check(it->next != NULL, ECS_INVALID_PARAMETER, NULL);
+    ecs_check(chunk_size > 0, ECS_INVALID_PARAMETER, NULL);
+    ecs_check(!(chunk_size & (chunk_size - 1)), ECS_INVALID_PARAMETER, 
+        "chunk size must be a power of two");
+
+    ecs_iter_t result = *it;
+    result.priv.cache.stack_cursor = NULL; /* Don't copy allocator cursor */
+
+    result.priv.iter.chunk = (ecs_chunk_iter_t){
+        .size = chunk_size
+    };
+    result.next = ecs_chunk_next;
+    result.fini = ecs_chained_iter_fini;
+    result.chain_it = ECS_CONST_CAST(ecs_iter_t*, it);
+    ECS_BIT_SET(result.flags, EcsIterIsInstanced);
+
+    return result;
+error:
+    return (ecs_iter_t){ 0 };
+}
+
+bool ecs_chunk_next(
+    ecs_iter_t *it)
+{
+    ecs_check(it != NULL, ECS_INVALID_PARAMETER, NULL);
+    ecs_check(it->next == ecs_chunk_next, ECS_INVALID_PARAMETER, NULL);
+    ecs_check(it->chain_it != NULL, ECS_INVALID_PARAMETER, NULL);
+
+    ecs_iter_t *chain_it = it->chain_it;
+    ecs_chunk_iter_t *iter = &it->priv.iter.chunk;
+
+    if (iter->remaining) {
+        /* Advance to next chunk in current result of chained iterator */
+        int32_t prev = it->count;
+        flecs_offset_iter(it, prev);
+        it->offset += prev;
+        it->frame_offset += prev;
+    } else {
+        ECS_BIT_SET(chain_it->flags, EcsIterIsInstanced);
+
+        do {
+            if (!ecs_iter_next(chain_it)) {
+                return false;
+            }
+
+            /* Copy everything up to the private iterator data */
+            ecs_os_memcpy(it, chain_it, offsetof(ecs_iter_t, priv));
+            ECS_BIT_SET(it->flags, EcsIterIsInstanced);
+
+            if (!chain_it->table) {
+                it->instance_count = it->count;
+                return true; /* Task query */
+            }
+
+            iter->remaining = it->count;
+        } while (!iter->remaining);
+    }
+
+    /* Don't cross a chunk boundary, so that a chunk that starts on a boundary
+     * starts at an aligned address when aligned columns are enabled. */
+    int32_t size = iter->size;
+    int32_t count = size - (it->offset & (size - 1));
+    if (count > iter->remaining) {
+        count = iter->remaining;
+    }
+
+    it->count = count;
+    it->instance_count = count;
+    iter->remaining -= count;
+
+    return true;
+error:
+    return false;
+}
+
 /**
  * @file misc.c
  * @brief Miscellaneous functions.
@@ -15488,9 +18240,7 @@ void flecs_emit_forward_and_cache_id(
     elem->record = tgt_record;
     elem->src = tgt;
     elem->id = idr->id;
-#ifndef NDEBUG
     elem->table = tgt_table;
-#endif
     ecs_assert(tgt_table == tgt_record->table, ECS_INTERNAL_ERROR, NULL);
 
     flecs_emit_forward_id(world, er, er_onset, emit_ids, it, table, idr,
@@ -15523,6 +18273,28 @@ bool flecs_emit_stack_has(
     return flecs_emit_stack_at(stack, idr) != ecs_vec_count(stack);
 }
 
+/* Entities can move to another table without an event that invalidates the
+ * cache, so also check that cached entities are still in the same table. */
+static
+bool flecs_emit_reachable_cache_valid(
+    const ecs_reachable_cache_t *rc)
+{
+    if (rc->current != rc->generation) {
+        return false;
+    }
+
+    const ecs_reachable_elem_t *elems = ecs_vec_first_t(&rc->ids, 
+        ecs_reachable_elem_t);
+    int32_t i, count = ecs_vec_count(&rc->ids);
+    for (i = 0; i < count; i ++) {
+        if (elems[i].record->table != elems[i].table) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
 static
 void flecs_emit_forward_cached_ids(
     ecs_world_t *world,
@@ -15613,7 +18385,7 @@ void flecs_emit_forward_table_up(
      * keep track so that we can update two records for the cost of one. */
     ecs_reachable_cache_t *rc = &tgt_idr->reachable;
     bool parent_revalidate = (reachable_ids != &rc->ids) && 
-        (rc->current != rc->generation);
+        !flecs_emit_reachable_cache_valid(rc);
     if (parent_revalidate) {
         ecs_vec_reset_t(a, &rc->ids, ecs_reachable_elem_t);
     }
@@ -15645,7 +18417,7 @@ void flecs_emit_forward_table_up(
             t[0] = tgt_table;
 
             ecs_reachable_cache_t *idr_rc = &idr->reachable;
-            if (idr_rc->current == idr_rc->generation) {
+            if (flecs_emit_reachable_cache_valid(idr_rc)) {
                 /* Cache hit, use cached ids to prevent traversing the same
                  * hierarchy multiple times. This especially speeds up code 
                  * where (deep) hierarchies are created. */
@@ -15687,9 +18459,7 @@ void flecs_emit_forward_table_up(
             elem->record = tgt_record;
             elem->src = tgt;
             elem->id = idr->id;
-#ifndef NDEBUG
             elem->table = tgt_table;
-#endif
         }
 
         /* Skip id if it's masked by a lower table in the tree */
@@ -15772,7 +18542,7 @@ void flecs_emit_forward(
 {
     ecs_reachable_cache_t *rc = &idr->reachable;
 
-    if (rc->current != rc->generation) {
+    if (!flecs_emit_reachable_cache_valid(rc)) {
         /* Cache miss, iterate the tree to find ids to forward */
         if (ecs_should_log_3()) {
             char *idstr = ecs_id_str(world, idr->id);
@@ -17114,6 +19884,12 @@ int flecs_multi_observer_init(
         ecs_oper_kind_t oper = term->oper;
         ecs_id_t id = term->id;
 
+        /* Sparse components are not stored in tables, so table events can't
+         * be observed for them. */
+        if (term->flags & EcsTermIsSparse) {
+            continue;
+        }
+
         /* AndFrom & OrFrom terms insert multiple observers */
         if (oper == EcsAndFrom || oper == EcsOrFrom) {
             const ecs_type_t *type = ecs_get_type(world, id);
@@ -17216,6 +19992,19 @@ ecs_entity_t ecs_observer_init(
         /* Observer must have at least one term */
         ecs_check(observer->filter.term_count > 0, ECS_INVALID_PARAMETER, NULL);
 
+        /* Sparse components don't emit events, so only table events can be
+         * observed for filters that contain sparse terms. */
+        if (observer->filter.flags & EcsFilterHasSparse) {
+            int i;
+            for (i = 0; i < FLECS_EVENT_DESC_MAX && desc->events[i]; i ++) {
+                ecs_entity_t event = desc->events[i];
+                ecs_check(event == EcsOnTableCreate || 
+                    event == EcsOnTableDelete || event == EcsOnTableEmpty ||
+                    event == EcsOnTableFill, ECS_UNSUPPORTED, 
+                        "observer cannot match sparse component");
+            }
+        }
+
         poly->poly = observer;
 
         ecs_observable_t *observable = desc->observable;
@@ -17862,6 +20651,14 @@ bool ecs_os_has_heap(void) {
         (ecs_os_api.free_ != NULL);
 }
 
+bool ecs_os_has_vmem(void) {
+    return 
+        (ecs_os_api.vmem_reserve_ != NULL) &&
+        (ecs_os_api.vmem_commit_ != NULL) &&
+        (ecs_os_api.vmem_decommit_ != NULL) &&
+        (ecs_os_api.vmem_release_ != NULL);
+}
+
 bool ecs_os_has_threading(void) {
     return
         (ecs_os_api.mutex_new_ != NULL) &&
@@ -18801,12 +21598,14 @@ bool flecs_query_check_match_monitor_term(
         query->filter.world, cur.table)[cur.column + 1];
 }
 
-/* Check if any term for match has changed */
+/* Check if any term for match has changed. If shared_only is true, only test
+ * fields that are not owned by the matched table. */
 static
-bool flecs_query_check_match_monitor(
+bool flecs_query_check_match_monitor_w_shared(
     ecs_query_t *query,
     ecs_query_table_match_t *match,
-    const ecs_iter_t *it)
+    const ecs_iter_t *it,
+    bool shared_only)
 {
     ecs_assert(match != NULL, ECS_INTERNAL_ERROR, NULL);
 
@@ -18821,7 +21620,7 @@ bool flecs_query_check_match_monitor(
         dirty_state = flecs_table_get_dirty_state(
             query->filter.world, table);
         ecs_assert(dirty_state != NULL, ECS_INTERNAL_ERROR, NULL);
-        if (monitor[0] != dirty_state[0]) {
+        if (!shared_only && (monitor[0] != dirty_state[0])) {
             return true;
         }
     }
@@ -18846,7 +21645,7 @@ bool flecs_query_check_match_monitor(
         if (columns[i] >= 0) {
             /* owned component */
             ecs_assert(dirty_state != NULL, ECS_INTERNAL_ERROR, NULL);
-            if (mon != dirty_state[column + 1]) {
+            if (!shared_only && (mon != dirty_state[column + 1])) {
                 return true;
             }
             continue;
@@ -18932,6 +21731,16 @@ bool flecs_query_check_match_monitor(
     return false;
 }
 
+/* Check if any term for match has changed */
+static
+bool flecs_query_check_match_monitor(
+    ecs_query_t *query,
+    ecs_query_table_match_t *match,
+    const ecs_iter_t *it)
+{
+    return flecs_query_check_match_monitor_w_shared(query, match, it, false);
+}
+
 /* Check if any term for matched table has changed */
 static
 bool flecs_query_check_table_monitor(
@@ -19198,6 +22007,10 @@ bool flecs_query_match_table(
         return false;
     }
 
+    if (!flecs_filter_signature_match(filter, table)) {
+        return false;
+    }
+
     ecs_iter_t it = flecs_filter_iter_w_flags(world, filter, EcsIterMatchVar|
         EcsIterIsInstanced|EcsIterNoData|EcsIterEntityOptional);
     ecs_iter_set_var_as_table(&it, var_id, table);
@@ -19218,22 +22031,223 @@ bool flecs_query_match_table(
 
 ECS_SORT_TABLE_WITH_COMPARE(_, flecs_query_sort_table_generic, order_by, static)
 
+/* Sort key with row of entity (or index of table) it was extracted from */
+typedef struct sort_key_t {
+    uint64_t key;
+    int32_t row;
+} sort_key_t;
+
+/* Rows of a table that are compared during incremental sorting. If keys is
+ * set rows are compared by key, otherwise the compare function is used. */
+typedef struct sort_rows_t {
+    const ecs_entity_t *entities;
+    const void *ptr;
+    int32_t size;
+    ecs_order_by_action_t compare;
+    const sort_key_t *keys;
+} sort_rows_t;
+
 static
-void flecs_query_sort_table(
+int flecs_query_compare_rows(
+    const sort_rows_t *rows,
+    int32_t a,
+    int32_t b)
+{
+    if (rows->keys) {
+        uint64_t key_a = rows->keys[a].key, key_b = rows->keys[b].key;
+        return (key_a > key_b) - (key_a < key_b);
+    }
+
+    const void *ptr_a = NULL, *ptr_b = NULL;
+    if (rows->ptr) {
+        ptr_a = ECS_ELEM(rows->ptr, rows->size, a);
+        ptr_b = ECS_ELEM(rows->ptr, rows->size, b);
+    }
+
+    return rows->compare(rows->entities[a], ptr_a, rows->entities[b], ptr_b);
+}
+
+/* Stable bottom-up merge sort for an array of row indices */
+static
+int32_t* flecs_query_sort_row_indices(
+    const sort_rows_t *rows,
+    int32_t *indices,
+    int32_t *tmp,
+    int32_t count)
+{
+    int32_t width;
+    for (width = 1; width < count; width *= 2) {
+        int32_t lo;
+        for (lo = 0; lo < count; lo += 2 * width) {
+            int32_t mid = ECS_MIN(lo + width, count);
+            int32_t hi = ECS_MIN(lo + 2 * width, count);
+            int32_t i = lo, j = mid, k = lo;
+            while (i < mid && j < hi) {
+                if (flecs_query_compare_rows(rows, indices[j], indices[i]) < 0) {
+                    tmp[k ++] = indices[j ++];
+                } else {
+                    tmp[k ++] = indices[i ++];
+                }
+            }
+            while (i < mid) {
+                tmp[k ++] = indices[i ++];
+            }
+            while (j < hi) {
+                tmp[k ++] = indices[j ++];
+            }
+        }
+
+        int32_t *swap = indices;
+        indices = tmp;
+        tmp = swap;
+    }
+
+    return indices;
+}
+
+/* Reorder table so that the entity that is currently at row order[i] is moved
+ * to row i. Rows that are already in the right place are not touched. */
+static
+void flecs_query_table_apply_order(
+    ecs_world_t *world,
+    ecs_table_t *table,
+    const int32_t *order,
+    int32_t count)
+{
+    int32_t i, first = 0;
+    while (first < count && order[first] == first) {
+        first ++;
+    }
+
+    if (first == count) {
+        return;
+    }
+
+    ecs_allocator_t *a = &world->allocator;
+    int32_t *pos = flecs_alloc_n(a, int32_t, count * 2);
+    int32_t *orig = &pos[count];
+    for (i = 0; i < count; i ++) {
+        pos[i] = orig[i] = i;
+    }
+
+    for (i = first; i < count; i ++) {
+        int32_t src_orig = order[i];
+        int32_t src = pos[src_orig];
+        if (src != i) {
+            int32_t moved = orig[i];
+            flecs_table_swap(world, table, i, src);
+            orig[src] = moved;
+            pos[moved] = src;
+            orig[i] = src_orig;
+            pos[src_orig] = i;
+        }
+    }
+
+    flecs_free_n(a, int32_t, count * 2, pos);
+}
+
+/* Incrementally sort a table that was sorted before. Rows that were appended
+ * after the sorted watermark and rows that are no longer in order are sorted
+ * separately and then merged with the rows that are still in order. Returns
+ * false if too many rows are out of order, in which case the table should be
+ * fully sorted. */
+static
+bool flecs_query_sort_table_incremental(
     ecs_world_t *world,
     ecs_table_t *table,
+    const sort_rows_t *rows,
+    int32_t count,
+    int32_t sorted_count)
+{
+    if (!sorted_count) {
+        return false;
+    }
+
+    /* Incremental sorting only pays off if few rows changed */
+    int32_t max_unsorted = count / 8;
+    if (count - sorted_count > max_unsorted) {
+        return false;
+    }
+
+    ecs_allocator_t *a = &world->allocator;
+    int32_t buf_count = count * 2 + (max_unsorted + 1) * 2;
+    int32_t *buf = flecs_alloc_n(a, int32_t, buf_count);
+    int32_t *kept = buf;
+    int32_t *order = &kept[count];
+    int32_t *unsorted = &order[count];
+    int32_t *tmp = &unsorted[max_unsorted + 1];
+    int32_t i, kept_count = 0, unsorted_count = 0;
+    bool result = false;
+
+    /* Find rows that are in order. If a row in the sorted range breaks the 
+     * order but is in order with the row before the last in-order row, the 
+     * last in-order row was modified and is the one that's out of place. */
+    for (i = 0; i < count; i ++) {
+        if (!kept_count || 
+            flecs_query_compare_rows(rows, i, kept[kept_count - 1]) >= 0) 
+        {
+            kept[kept_count ++] = i;
+            continue;
+        }
+
+        if (i < sorted_count && (kept_count == 1 || 
+            flecs_query_compare_rows(rows, i, kept[kept_count - 2]) >= 0)) 
+        {
+            unsorted[unsorted_count ++] = kept[kept_count - 1];
+            kept[kept_count - 1] = i;
+        } else {
+            unsorted[unsorted_count ++] = i;
+        }
+
+        if (unsorted_count > max_unsorted) {
+            goto done;
+        }
+    }
+
+    result = true;
+    if (!unsorted_count) {
+        goto done;
+    }
+
+    int32_t *sorted = flecs_query_sort_row_indices(
+        rows, unsorted, tmp, unsorted_count);
+
+    /* Merge unsorted rows into rows that are in order */
+    int32_t k = 0, u = 0, o = 0;
+    while (k < kept_count && u < unsorted_count) {
+        if (flecs_query_compare_rows(rows, sorted[u], kept[k]) < 0) {
+            order[o ++] = sorted[u ++];
+        } else {
+            order[o ++] = kept[k ++];
+        }
+    }
+    while (k < kept_count) {
+        order[o ++] = kept[k ++];
+    }
+    while (u < unsorted_count) {
+        order[o ++] = sorted[u ++];
+    }
+
+    ecs_assert(o == count, ECS_INTERNAL_ERROR, NULL);
+    flecs_query_table_apply_order(world, table, order, count);
+done:
+    flecs_free_n(a, int32_t, buf_count, buf);
+    return result;
+}
+
+static
+void flecs_query_sort_table(
+    ecs_world_t *world,
+    ecs_query_table_t *qt,
     int32_t column_index,
     ecs_order_by_action_t compare,
     ecs_sort_table_action_t sort)
 {
+    ecs_table_t *table = qt->hdr.table;
     ecs_data_t *data = &table->data;
-    if (!ecs_vec_count(&data->entities)) {
-        /* Nothing to sort */
-        return;
-    }
-
     int32_t count = flecs_table_data_count(data);
     if (count < 2) {
+        qt->sorted_count = count;
         return;
     }
 
@@ -19248,11 +22262,122 @@ void flecs_query_sort_table(
         ptr = ecs_vec_first(&column->data);
     }
 
-    if (sort) {
+    sort_rows_t rows = {
+        .entities = entities,
+        .ptr = ptr,
+        .size = size,
+        .compare = compare
+    };
+
+    if (flecs_query_sort_table_incremental(
+        world, table, &rows, count, qt->sorted_count)) 
+    {
+        /* Table was sorted incrementally */
+    } else if (sort) {
         sort(world, table, entities, ptr, size, 0, count - 1, compare);
     } else {
         flecs_query_sort_table_generic(world, table, entities, ptr, size, 0, count - 1, compare);
     }
+
+    qt->sorted_count = count;
+}
+
+/* Sort table by key. Keys are sorted with an LSD radix sort, after which the
+ * sorted order is applied to the table by swapping rows. */
+static
+void flecs_query_sort_table_by_key(
+    ecs_world_t *world,
+    ecs_query_table_t *qt,
+    int32_t column_index,
+    ecs_order_by_key_action_t order_by_key)
+{
+    ecs_table_t *table = qt->hdr.table;
+    ecs_data_t *data = &table->data;
+    int32_t i, count = flecs_table_data_count(data);
+    if (count < 2) {
+        qt->sorted_count = count;
+        return;
+    }
+
+    ecs_entity_t *entities = ecs_vec_first(&data->entities);
+
+    void *ptr = NULL;
+    int32_t size = 0;
+    if (column_index != -1) {
+        ecs_column_t *column = &data->columns[column_index];
+        size = column->size;
+        ptr = ecs_vec_first(&column->data);
+    }
+
+    ecs_allocator_t *a = &world->allocator;
+    sort_key_t *keys = flecs_alloc_n(a, sort_key_t, count);
+    sort_key_t *tmp = flecs_alloc_n(a, sort_key_t, count);
+    sort_key_t *keys_alloc = keys, *tmp_alloc = tmp;
+
+    /* Keep track of which bits differ between keys, so that passes over bytes
+     * that are the same for all keys can be skipped. */
+    uint64_t diff = 0;
+    bool sorted = true;
+    for (i = 0; i < count; i ++) {
+        const void *elem = ptr ? ECS_ELEM(ptr, size, i) : NULL;
+        uint64_t key = order_by_key(entities[i], elem);
+        keys[i].key = key;
+        keys[i].row = i;
+        if (i) {
+            diff |= key ^ keys[0].key;
+            sorted &= key >= keys[i - 1].key;
+        }
+    }
+
+    if (sorted) {
+        goto done;
+    }
+
+    sort_rows_t rows = { .keys = keys };
+    if (flecs_query_sort_table_incremental(
+        world, table, &rows, count, qt->sorted_count)) 
+    {
+        goto done;
+    }
+
+    int32_t shift;
+    for (shift = 0; shift < 64; shift += 8) {
+        if (!((diff >> shift) & 0xFF)) {
+            continue;
+        }
+
+        int32_t offsets[256] = {0};
+        int32_t b, total = 0;
+        for (i = 0; i < count; i ++) {
+            offsets[(keys[i].key >> shift) & 0xFF] ++;
+        }
+        for (b = 0; b < 256; b ++) {
+            int32_t b_count = offsets[b];
+            offsets[b] = total;
+            total += b_count;
+        }
+        for (i = 0; i < count; i ++) {
+            tmp[offsets[(keys[i].key >> shift) & 0xFF] ++] = keys[i];
+        }
+
+        sort_key_t *swap = keys;
+        keys = tmp;
+        tmp = swap;
+    }
+
+    /* Apply sorted order to table. The entity that was originally at row
+     * keys[i].row must be moved to row i. */
+    int32_t *order = flecs_alloc_n(a, int32_t, count);
+    for (i = 0; i < count; i ++) {
+        order[i] = keys[i].row;
+    }
+
+    flecs_query_table_apply_order(world, table, order, count);
+    flecs_free_n(a, int32_t, count, order);
+done:
+    flecs_free_n(a, sort_key_t, count, keys_alloc);
+    flecs_free_n(a, sort_key_t, count, tmp_alloc);
+    qt->sorted_count = count;
 }
 
 /* Helper struct for building sorted table ranges */
@@ -19291,6 +22416,152 @@ ecs_entity_t e_from_helper(
     }
 }
 
+static
+ecs_query_table_match_t* flecs_query_append_slice(
+    ecs_query_t *query,
+    ecs_query_table_match_t *cur,
+    sort_helper_t *helper)
+{
+    if (!cur || cur->columns != helper->match->columns) {
+        cur = ecs_vec_append_t(NULL, &query->table_slices, 
+            ecs_query_table_match_t);
+        *cur = *(helper->match);
+        cur->offset = helper->row;
+        cur->count = 1;
+    } else {
+        cur->count ++;
+    }
+
+    helper->row ++;
+    return cur;
+}
+
+static
+uint64_t flecs_query_key_from_helper(
+    ecs_order_by_key_action_t order_by_key,
+    sort_helper_t *helper)
+{
+    const void *ptr = helper->ptr ? ptr_from_helper(helper) : NULL;
+    return order_by_key(e_from_helper(helper), ptr);
+}
+
+static
+bool flecs_sort_key_lt(
+    const sort_key_t *a,
+    const sort_key_t *b)
+{
+    return (a->key < b->key) || ((a->key == b->key) && (a->row < b->row));
+}
+
+static
+void flecs_sort_heap_down(
+    sort_key_t *heap,
+    int32_t count,
+    int32_t i)
+{
+    do {
+        int32_t min = i, l = i * 2 + 1, r = l + 1;
+        if (l < count && flecs_sort_key_lt(&heap[l], &heap[min])) {
+            min = l;
+        }
+        if (r < count && flecs_sort_key_lt(&heap[r], &heap[min])) {
+            min = r;
+        }
+        if (min == i) {
+            break;
+        }
+        sort_key_t tmp = heap[i];
+        heap[i] = heap[min];
+        heap[min] = tmp;
+        i = min;
+    } while (true);
+}
+
+/* Merge sorted tables by finding the smallest entity across all tables with
+ * the order_by compare function. */
+static
+void flecs_query_merge_by_compare(
+    ecs_query_t *query,
+    sort_helper_t *helper,
+    int32_t to_sort,
+    ecs_query_table_match_t *cur)
+{
+    ecs_order_by_action_t compare = query->order_by;
+
+    bool proceed;
+    do {
+        int32_t j, min = 0;
+        proceed = true;
+
+        ecs_entity_t e1;
+        while (!(e1 = e_from_helper(&helper[min]))) {
+            min ++;
+            if (min == to_sort) {
+                proceed = false;
+                break;
+            }
+        }
+
+        if (!proceed) {
+            break;
+        }
+
+        for (j = min + 1; j < to_sort; j++) {
+            ecs_entity_t e2 = e_from_helper(&helper[j]);
+            if (!e2) {
+                continue;
+            }
+
+            const void *ptr1 = ptr_from_helper(&helper[min]);
+            const void *ptr2 = ptr_from_helper(&helper[j]);
+
+            if (compare(e1, ptr1, e2, ptr2) > 0) {
+                min = j;
+                e1 = e_from_helper(&helper[min]);
+            }
+        }
+
+        cur = flecs_query_append_slice(query, cur, &helper[min]);
+    } while (proceed);
+}
+
+/* Merge sorted tables by key. Instead of comparing the current entity of all
+ * tables, the next entity is found with a binary heap. Entities with equal 
+ * keys are returned in table order. */
+static
+void flecs_query_merge_by_key(
+    ecs_query_t *query,
+    sort_helper_t *helper,
+    int32_t to_sort,
+    ecs_query_table_match_t *cur)
+{
+    ecs_world_t *world = query->filter.world;
+    ecs_order_by_key_action_t order_by_key = query->order_by_key;
+    sort_key_t *heap = flecs_alloc_n(&world->allocator, sort_key_t, to_sort);
+    int32_t i, heap_count = to_sort;
+
+    for (i = 0; i < to_sort; i ++) {
+        heap[i].key = flecs_query_key_from_helper(order_by_key, &helper[i]);
+        heap[i].row = i;
+    }
+    for (i = heap_count / 2 - 1; i >= 0; i --) {
+        flecs_sort_heap_down(heap, heap_count, i);
+    }
+
+    while (heap_count) {
+        sort_helper_t *cur_helper = &helper[heap[0].row];
+        cur = flecs_query_append_slice(query, cur, cur_helper);
+        if (cur_helper->row < cur_helper->count) {
+            heap[0].key = flecs_query_key_from_helper(order_by_key, cur_helper);
+        } else {
+            heap[0] = heap[-- heap_count];
+        }
+        flecs_sort_heap_down(heap, heap_count, 0);
+    }
+
+    flecs_free_n(&world->allocator, sort_key_t, to_sort, heap);
+}
+
 static
 void flecs_query_build_sorted_table_range(
     ecs_query_t *query,
@@ -19301,7 +22572,6 @@ void flecs_query_build_sorted_table_range(
         "cannot sort query in multithreaded mode");
 
     ecs_entity_t id = query->order_by_component;
-    ecs_order_by_action_t compare = query->order_by;
     int32_t table_count = list->info.table_count;
     if (!table_count) {
         return;
@@ -19372,73 +22642,50 @@ void flecs_query_build_sorted_table_range(
 
     ecs_assert(to_sort != 0, ECS_INTERNAL_ERROR, NULL);
 
-    bool proceed;
-    do {
-        int32_t j, min = 0;
-        proceed = true;
-
-        ecs_entity_t e1;
-        while (!(e1 = e_from_helper(&helper[min]))) {
-            min ++;
-            if (min == to_sort) {
-                proceed = false;
-                break;
-            }
-        }
-
-        if (!proceed) {
-            break;
-        }
-
-        for (j = min + 1; j < to_sort; j++) {
-            ecs_entity_t e2 = e_from_helper(&helper[j]);
-            if (!e2) {
-                continue;
-            }
-
-            const void *ptr1 = ptr_from_helper(&helper[min]);
-            const void *ptr2 = ptr_from_helper(&helper[j]);
-
-            if (compare(e1, ptr1, e2, ptr2) > 0) {
-                min = j;
-                e1 = e_from_helper(&helper[min]);
-            }
-        }
+    if (query->order_by_key) {
+        flecs_query_merge_by_key(query, helper, to_sort, cur);
+    } else {
+        flecs_query_merge_by_compare(query, helper, to_sort, cur);
+    }
 
-        sort_helper_t *cur_helper = &helper[min];
-        if (!cur || cur->columns != cur_helper->match->columns) {
-            cur = ecs_vec_append_t(NULL, &query->table_slices, 
-                ecs_query_table_match_t);
-            *cur = *(cur_helper->match);
-            cur->offset = cur_helper->row;
-            cur->count = 1;
-        } else {
-            cur->count ++;
-        }
+    flecs_free_n(&world->allocator, sort_helper_t, table_count, helper);
+}
 
-        cur_helper->row ++;
-    } while (proceed);
+/* Build sorted slices for a list. If the slices from the previous build are
+ * still valid they are copied instead of merging the tables again. */
+static
+void flecs_query_build_sorted_list(
+    ecs_query_t *query,
+    ecs_query_table_list_t *list,
+    ecs_vec_t *prev_slices,
+    bool rebuild)
+{
+    int32_t offset = ecs_vec_count(&query->table_slices);
 
-    /* Iterate through the vector of slices to set the prev/next ptrs. This
-     * can't be done while building the vector, as reallocs may occur */
-    int32_t i, count = ecs_vec_count(&query->table_slices);    
-    ecs_query_table_match_t *nodes = ecs_vec_first(&query->table_slices);
-    for (i = 0; i < count; i ++) {
-        nodes[i].prev = &nodes[i - 1];
-        nodes[i].next = &nodes[i + 1];
+    if (rebuild || list->sort_dirty || !list->slice_count) {
+        flecs_query_build_sorted_table_range(query, list);
+    } else {
+        ecs_assert(list->slice_offset + list->slice_count <= 
+            ecs_vec_count(prev_slices), ECS_INTERNAL_ERROR, NULL);
+        ecs_query_table_match_t *dst = ecs_vec_grow_t(NULL, 
+            &query->table_slices, ecs_query_table_match_t, list->slice_count);
+        ecs_os_memcpy_n(dst, ecs_vec_get_t(prev_slices, 
+            ecs_query_table_match_t, list->slice_offset), 
+                ecs_query_table_match_t, list->slice_count);
     }
 
-    nodes[0].prev = NULL;
-    nodes[i - 1].next = NULL;
-
-    flecs_free_n(&world->allocator, sort_helper_t, table_count, helper);
+    list->slice_offset = offset;
+    list->slice_count = ecs_vec_count(&query->table_slices) - offset;
+    list->sort_dirty = false;
 }
 
 static
 void flecs_query_build_sorted_tables(
-    ecs_query_t *query)
+    ecs_query_t *query,
+    bool rebuild)
 {
-    ecs_vec_clear(&query->table_slices);
+    ecs_vec_t prev_slices = query->table_slices;
+    ecs_vec_init_t(NULL, &query->table_slices, ecs_query_table_match_t, 0);
 
     if (query->group_by) {
         /* Populate sorted node list in grouping order */
@@ -19451,15 +22698,57 @@ void flecs_query_build_sorted_tables(
                     &query->groups, ecs_query_table_list_t, group_id);
                 ecs_assert(list != NULL, ECS_INTERNAL_ERROR, NULL);
 
-                /* Sort tables in current group */
-                flecs_query_build_sorted_table_range(query, list);
+                /* Sort tables in current group, or reuse slices of previous
+                 * build if none of the tables in the group changed. */
+                flecs_query_build_sorted_list(
+                    query, list, &prev_slices, rebuild);
 
                 /* Find next group to sort */
                 cur = list->last->next;
             } while (cur);
         }
     } else {
-        flecs_query_build_sorted_table_range(query, &query->list);
+        flecs_query_build_sorted_list(
+            query, &query->list, &prev_slices, rebuild);
+    }
+
+    ecs_vec_fini_t(NULL, &prev_slices, ecs_query_table_match_t);
+
+    /* Iterate through the vector of slices to set the prev/next ptrs. This
+     * can't be done while building the vector, as reallocs may occur */
+    int32_t i, count = ecs_vec_count(&query->table_slices);
+    if (!count) {
+        return;
+    }
+
+    ecs_query_table_match_t *nodes = ecs_vec_first(&query->table_slices);
+    for (i = 0; i < count; i ++) {
+        nodes[i].prev = &nodes[i - 1];
+        nodes[i].next = &nodes[i + 1];
+    }
+
+    nodes[0].prev = NULL;
+    nodes[i - 1].next = NULL;
+}
+
+/* Mark sorted slices of the groups a table belongs to as dirty */
+static
+void flecs_query_sort_mark_dirty(
+    ecs_query_t *query,
+    ecs_query_table_t *qt)
+{
+    if (!query->group_by) {
+        query->list.sort_dirty = true;
+        return;
+    }
+
+    ecs_query_table_match_t *cur, *end = qt->last->next;
+    for (cur = qt->first; cur != end; cur = cur->next) {
+        ecs_query_table_list_t *list = flecs_query_get_group(
+            query, cur->group_id);
+        if (list) {
+            list->sort_dirty = true;
+        }
     }
 }
 
@@ -19469,7 +22758,8 @@ void flecs_query_sort_tables(
     ecs_query_t *query)
 {
     ecs_order_by_action_t compare = query->order_by;
-    if (!compare) {
+    ecs_order_by_key_action_t order_by_key = query->order_by_key;
+    if (!compare && !order_by_key) {
         return;
     }
 
@@ -19494,6 +22784,7 @@ void flecs_query_sort_tables(
         if (flecs_query_check_table_monitor(query, qt, 0)) {
             tables_sorted = true; /* Ensure ranges are rebuilt */
             dirty = true;
+            flecs_query_sort_mark_dirty(query, qt);
         }
 
         int32_t column = -1;
@@ -19524,12 +22815,20 @@ void flecs_query_sort_tables(
 
         /* Something has changed, sort the table. Prefers using 
          * flecs_query_sort_table when available */
-        flecs_query_sort_table(world, table, column, compare, sort);
+        if (order_by_key) {
+            flecs_query_sort_table_by_key(world, qt, column, order_by_key);
+        } else {
+            flecs_query_sort_table(world, qt, column, compare, sort);
+        }
         tables_sorted = true;
+        flecs_query_sort_mark_dirty(query, qt);
     }
 
-    if (tables_sorted || query->match_count != query->prev_match_count) {
-        flecs_query_build_sorted_tables(query);
+    bool tables_changed = query->match_count != query->prev_match_count;
+    if (tables_sorted || tables_changed) {
+        /* Only rebuild slices of groups with sorted tables, unless the set of
+         * matched tables changed. */
+        flecs_query_build_sorted_tables(query, tables_changed);
         query->match_count ++; /* Increase version if tables changed */
     }
 }
@@ -19787,6 +23086,103 @@ void flecs_query_unmatch_table(
     }
 }
 
+/* State for applying rematch results to the cache of a query */
+typedef struct ecs_query_rematch_cursor_t {
+    ecs_table_t *table;
+    ecs_query_table_t *qt;
+    ecs_query_table_match_t *qm;
+    int32_t rematch_count;
+} ecs_query_rematch_cursor_t;
+
+static
+void flecs_query_rematch_begin(
+    ecs_world_t *world,
+    ecs_query_t *query,
+    ecs_query_rematch_cursor_t *cur)
+{
+    world->info.rematch_count_total ++;
+    cur->table = NULL;
+    cur->qt = NULL;
+    cur->qm = NULL;
+    cur->rematch_count = ++ query->rematch_count;
+}
+
+/* Update cache with a single rematch result */
+static
+void flecs_query_rematch_result(
+    ecs_world_t *world,
+    ecs_query_t *query,
+    ecs_query_rematch_cursor_t *cur,
+    ecs_iter_t *it)
+{
+    ecs_table_t *table = it->table;
+    ecs_query_table_t *qt = cur->qt;
+    ecs_query_table_match_t *qm = cur->qm;
+
+    if ((cur->table != table) || (!table && !qt)) {
+        if (qm && qm->next_match) {
+            flecs_query_table_match_free(query, qt, qm->next_match);
+            qm->next_match = NULL;
+        }
+
+        cur->table = table;
+
+        qt = ecs_table_cache_get(&query->cache, table);
+        if (!qt) {
+            qt = flecs_query_table_insert(world, query, table);
+        }
+
+        ecs_assert(qt->hdr.table == table, ECS_INTERNAL_ERROR, NULL);
+        qt->rematch_count = cur->rematch_count;
+        qm = NULL;
+    }
+    if (!qm) {
+        qm = qt->first;
+    } else {
+        qm = qm->next_match;
+    }
+    if (!qm) {
+        qm = flecs_query_add_table_match(query, qt, table);
+    }
+
+    flecs_query_set_table_match(world, query, qm, table, it);
+
+    if (table && ecs_table_count(table) && query->group_by) {
+        if (flecs_query_get_group_id(query, table) != qm->group_id) {
+            /* Update table group */
+            flecs_query_remove_table_node(query, qm);
+            flecs_query_insert_table_node(query, qm);
+        }
+    }
+
+    cur->qt = qt;
+    cur->qm = qm;
+}
+
+static
+void flecs_query_rematch_end(
+    ecs_query_t *query,
+    ecs_query_rematch_cursor_t *cur)
+{
+    ecs_query_table_t *qt = cur->qt;
+    ecs_query_table_match_t *qm = cur->qm;
+
+    if (qm && qm->next_match) {
+        flecs_query_table_match_free(query, qt, qm->next_match);
+        qm->next_match = NULL;
+    }
+
+    /* Iterate all tables in cache, remove ones that weren't just matched */
+    ecs_table_cache_iter_t cache_it;
+    if (flecs_table_cache_all_iter(&query->cache, &cache_it)) {
+        while ((qt = flecs_table_cache_next(&cache_it, ecs_query_table_t))) {
+            if (qt->rematch_count != cur->rematch_count) {
+                flecs_query_unmatch_table(query, qt->hdr.table, qt);
+            }
+        }
+    }
+}
+
 /* Rematch system with tables after a change happened to a watched entity */
 static
 void flecs_query_rematch_tables(
@@ -19795,9 +23191,6 @@ void flecs_query_rematch_tables(
     ecs_query_t *parent_query)
 {
     ecs_iter_t it, parent_it;
-    ecs_table_t *table = NULL;
-    ecs_query_table_t *qt = NULL;
-    ecs_query_table_match_t *qm = NULL;
 
     if (query->monitor_generation == world->monitor_generation) {
         return;
@@ -19816,8 +23209,8 @@ void flecs_query_rematch_tables(
     ECS_BIT_SET(it.flags, EcsIterNoData);
     ECS_BIT_SET(it.flags, EcsIterEntityOptional);
 
-    world->info.rematch_count_total ++;
-    int32_t rematch_count = ++ query->rematch_count;
+    ecs_query_rematch_cursor_t cur;
+    flecs_query_rematch_begin(world, query, &cur);
 
     ecs_time_t t = {0};
     if (world->flags & EcsWorldMeasureFrameTime) {
@@ -19825,63 +23218,188 @@ void flecs_query_rematch_tables(
     }
 
     while (ecs_filter_next(&it)) {
-        if ((table != it.table) || (!it.table && !qt)) {
-            if (qm && qm->next_match) {
-                flecs_query_table_match_free(query, qt, qm->next_match);
-                qm->next_match = NULL;
-            }
+        flecs_query_rematch_result(world, query, &cur, &it);
+    }
 
-            table = it.table;
+    flecs_query_rematch_end(query, &cur);
 
-            qt = ecs_table_cache_get(&query->cache, table);
-            if (!qt) {
-                qt = flecs_query_table_insert(world, query, table);
-            }
+    if (world->flags & EcsWorldMeasureFrameTime) {
+        world->info.rematch_time_total += (ecs_ftime_t)ecs_time_measure(&t);
+    }
+}
 
-            ecs_assert(qt->hdr.table == table, ECS_INTERNAL_ERROR, NULL);
-            qt->rematch_count = rematch_count;
-            qm = NULL;
-        }
-        if (!qm) {
-            qm = qt->first;
+#ifdef FLECS_PIPELINE
+
+/* Results of matching a query, produced by a worker thread */
+typedef struct ecs_query_rematch_t {
+    ecs_query_t *query;
+    ecs_allocator_t *allocator;      /* Allocator of stage that matched query */
+    ecs_vec_t tables;                /* vector<ecs_table_t*> */
+    ecs_vec_t ids;                   /* vector<ecs_id_t>, field_count per table */
+    ecs_vec_t columns;               /* vector<int32_t> */
+    ecs_vec_t sources;               /* vector<ecs_entity_t> */
+    ecs_vec_t sizes;                 /* vector<ecs_size_t> */
+} ecs_query_rematch_t;
+
+typedef struct ecs_query_rematch_job_t {
+    ecs_query_rematch_t *queries;
+    int32_t count;
+    int32_t next;                    /* Next query to claim, incremented atomically */
+} ecs_query_rematch_job_t;
+
+/* Match query against the world without modifying its cache. Only reads from
+ * the world, so this can run concurrently for different queries. */
+static
+void flecs_query_rematch_collect(
+    ecs_stage_t *stage,
+    ecs_query_rematch_t *r)
+{
+    ecs_query_t *query = r->query;
+    ecs_allocator_t *a = &stage->allocator;
+    int32_t field_count = query->filter.field_count;
+
+    r->allocator = a;
+    ecs_vec_init_t(a, &r->tables, ecs_table_t*, 0);
+    ecs_vec_init_t(a, &r->ids, ecs_id_t, 0);
+    ecs_vec_init_t(a, &r->columns, int32_t, 0);
+    ecs_vec_init_t(a, &r->sources, ecs_entity_t, 0);
+    ecs_vec_init_t(a, &r->sizes, ecs_size_t, 0);
+
+    ecs_iter_t it = flecs_filter_iter_w_flags(
+        (ecs_world_t*)stage, &query->filter, 0);
+    ECS_BIT_SET(it.flags, EcsIterIsInstanced);
+    ECS_BIT_SET(it.flags, EcsIterNoData);
+    ECS_BIT_SET(it.flags, EcsIterEntityOptional);
+
+    while (ecs_filter_next(&it)) {
+        ecs_vec_append_t(a, &r->tables, ecs_table_t*)[0] = it.table;
+        ecs_os_memcpy_n(ecs_vec_grow_t(a, &r->ids, ecs_id_t, field_count),
+            it.ids, ecs_id_t, field_count);
+        ecs_os_memcpy_n(ecs_vec_grow_t(a, &r->columns, int32_t, field_count),
+            it.columns, int32_t, field_count);
+        ecs_os_memcpy_n(ecs_vec_grow_t(a, &r->sources, ecs_entity_t, 
+            field_count), it.sources, ecs_entity_t, field_count);
+        ecs_size_t *sizes = ecs_vec_grow_t(
+            a, &r->sizes, ecs_size_t, field_count);
+        if (it.sizes) {
+            ecs_os_memcpy_n(sizes, it.sizes, ecs_size_t, field_count);
         } else {
-            qm = qm->next_match;
-        }
-        if (!qm) {
-            qm = flecs_query_add_table_match(query, qt, table);
+            ecs_os_memset_n(sizes, 0, ecs_size_t, field_count);
         }
+    }
+}
 
-        flecs_query_set_table_match(world, query, qm, table, &it);
+/* Worker task that claims queries until all of them have been matched */
+static
+void flecs_query_rematch_worker(
+    ecs_world_t *world,
+    ecs_stage_t *stage,
+    void *ctx)
+{
+    (void)world;
+    ecs_query_rematch_job_t *job = ctx;
+    int32_t i;
+    while ((i = ecs_os_ainc(&job->next) - 1) < job->count) {
+        flecs_query_rematch_collect(stage, &job->queries[i]);
+    }
+}
 
-        if (table && ecs_table_count(table) && query->group_by) {
-            if (flecs_query_get_group_id(query, table) != qm->group_id) {
-                /* Update table group */
-                flecs_query_remove_table_node(query, qm);
-                flecs_query_insert_table_node(query, qm);
-            }
-        }
+/* Apply results to query cache. Runs on the main thread after workers synced */
+static
+void flecs_query_rematch_merge(
+    ecs_world_t *world,
+    ecs_query_rematch_t *r)
+{
+    ecs_query_t *query = r->query;
+    ecs_allocator_t *a = r->allocator;
+    int32_t i, count = ecs_vec_count(&r->tables);
+    int32_t field_count = query->filter.field_count;
+    ecs_table_t **tables = ecs_vec_first_t(&r->tables, ecs_table_t*);
+    ecs_id_t *ids = ecs_vec_first_t(&r->ids, ecs_id_t);
+    int32_t *columns = ecs_vec_first_t(&r->columns, int32_t);
+    ecs_entity_t *sources = ecs_vec_first_t(&r->sources, ecs_entity_t);
+    ecs_size_t *sizes = ecs_vec_first_t(&r->sizes, ecs_size_t);
+
+    ecs_query_rematch_cursor_t cur;
+    flecs_query_rematch_begin(world, query, &cur);
+
+    ecs_iter_t it = { .world = world, .real_world = world };
+    for (i = 0; i < count; i ++) {
+        int32_t offset = i * field_count;
+        it.table = tables[i];
+        it.ids = &ids[offset];
+        it.columns = &columns[offset];
+        it.sources = &sources[offset];
+        it.sizes = &sizes[offset];
+        flecs_query_rematch_result(world, query, &cur, &it);
     }
 
-    if (qm && qm->next_match) {
-        flecs_query_table_match_free(query, qt, qm->next_match);
-        qm->next_match = NULL;
+    flecs_query_rematch_end(query, &cur);
+
+    ecs_vec_fini_t(a, &r->tables, ecs_table_t*);
+    ecs_vec_fini_t(a, &r->ids, ecs_id_t);
+    ecs_vec_fini_t(a, &r->columns, int32_t);
+    ecs_vec_fini_t(a, &r->sources, ecs_entity_t);
+    ecs_vec_fini_t(a, &r->sizes, ecs_size_t);
+
+    flecs_query_notify_subqueries(world, query, &(ecs_query_event_t){
+        .kind = EcsQueryTableRematch
+    });
+}
+
+/* Match queries on worker threads, one query per task */
+static
+bool flecs_query_rematch_parallel(
+    ecs_world_t *world,
+    ecs_query_t **queries,
+    int32_t count)
+{
+    if (count < 2 || !flecs_workers_can_run_task(world)) {
+        return false;
     }
 
-    /* Iterate all tables in cache, remove ones that weren't just matched */
-    ecs_table_cache_iter_t cache_it;
-    if (flecs_table_cache_all_iter(&query->cache, &cache_it)) {
-        while ((qt = flecs_table_cache_next(&cache_it, ecs_query_table_t))) {
-            if (qt->rematch_count != rematch_count) {
-                flecs_query_unmatch_table(query, qt->hdr.table, qt);
-            }
+    ecs_allocator_t *a = &world->allocator;
+    ecs_query_rematch_t *rematch = flecs_alloc_n(
+        a, ecs_query_rematch_t, count);
+    ecs_query_rematch_job_t job = { .queries = rematch };
+
+    int32_t i;
+    for (i = 0; i < count; i ++) {
+        ecs_query_t *q = queries[i];
+        if (q->monitor_generation == world->monitor_generation) {
+            continue; /* Query is registered for more than one monitor */
         }
+        q->monitor_generation = world->monitor_generation;
+        rematch[job.count ++].query = q;
+    }
+
+    ecs_time_t t = {0};
+    if (world->flags & EcsWorldMeasureFrameTime) {
+        ecs_time_measure(&t);
+    }
+
+    if (job.count > 1) {
+        flecs_workers_run_task(world, flecs_query_rematch_worker, &job);
+    } else {
+        /* Not worth waking up workers for a single query */
+        flecs_query_rematch_worker(world, &world->stages[0], &job);
+    }
+
+    /* Sync point: workers are done, apply results in registration order */
+    for (i = 0; i < job.count; i ++) {
+        flecs_query_rematch_merge(world, &rematch[i]);
     }
 
     if (world->flags & EcsWorldMeasureFrameTime) {
         world->info.rematch_time_total += (ecs_ftime_t)ecs_time_measure(&t);
     }
+
+    flecs_free_n(a, ecs_query_rematch_t, count, rematch);
+    return true;
 }
 
+#endif
+
 static
 void flecs_query_remove_subquery(
     ecs_query_t *parent, 
@@ -19942,15 +23460,37 @@ void flecs_query_notify(
     }
 }
 
+void flecs_query_rematch_all(
+    ecs_world_t *world,
+    ecs_query_t **queries,
+    int32_t count)
+{
+#ifdef FLECS_PIPELINE
+    if (flecs_query_rematch_parallel(world, queries, count)) {
+        return;
+    }
+#endif
+
+    int32_t i;
+    for (i = 0; i < count; i ++) {
+        flecs_query_notify(world, queries[i], &(ecs_query_event_t) {
+            .kind = EcsQueryTableRematch
+        });
+    }
+}
+
 static
 void flecs_query_order_by(
     ecs_world_t *world,
     ecs_query_t *query,
     ecs_entity_t order_by_component,
     ecs_order_by_action_t order_by,
+    ecs_order_by_key_action_t order_by_key,
     ecs_sort_table_action_t action)
 {
     ecs_check(query != NULL, ECS_INVALID_PARAMETER, NULL);
+    ecs_check(!order_by || !order_by_key, ECS_INVALID_PARAMETER, 
+        "cannot combine order_by and order_by_key");
     ecs_check(!(query->flags & EcsQueryIsOrphaned), ECS_INVALID_PARAMETER, NULL);
     ecs_check(!ecs_id_is_wildcard(order_by_component), 
         ECS_INVALID_PARAMETER, NULL);
@@ -19977,6 +23517,7 @@ void flecs_query_order_by(
 
     query->order_by_component = order_by_component;
     query->order_by = order_by;
+    query->order_by_key = order_by_key;
     query->order_by_term = order_by_term;
     query->sort_table = action;
 
@@ -19984,7 +23525,7 @@ void flecs_query_order_by(
     flecs_query_sort_tables(world, query);  
 
     if (!query->table_slices.array) {
-        flecs_query_build_sorted_tables(query);
+        flecs_query_build_sorted_tables(query, true);
     }
 
     query->flags &= ~EcsQueryTrivialIter;
@@ -20346,10 +23887,10 @@ ecs_query_t* ecs_query_init(
         result->parent = desc->parent;
     }
 
-    if (desc->order_by) {
+    if (desc->order_by || desc->order_by_key) {
         flecs_query_order_by(
             world, result, desc->order_by_component, desc->order_by,
-            desc->sort_table);
+            desc->order_by_key, desc->sort_table);
     }
 
     if (!ecs_query_table_count(result) && result->filter.term_count) {
@@ -20457,7 +23998,9 @@ ecs_iter_t ecs_query_iter(
         .last = NULL
     };
 
-    if (query->order_by && query->list.info.table_count) {
+    if ((query->order_by || query->order_by_key) && 
+        query->list.info.table_count) 
+    {
         it.node = ecs_vec_first(&query->table_slices);
     }
 
@@ -20576,10 +24119,38 @@ void* ecs_query_get_group_ctx(
     }
 }
 
+/* Stamp rows of a table that tracks row versions with the new column state */
+static
+void flecs_query_stamp_rows(
+    ecs_query_t *query,
+    ecs_query_table_match_t *qm,
+    ecs_table_t *table,
+    int32_t term,
+    int32_t column,
+    int32_t value)
+{
+    if (table == qm->table) {
+        int32_t offset = qm->offset, count = qm->count;
+        if (!count) {
+            count = ecs_table_count(table);
+        }
+        flecs_table_stamp_rows(table, column + 1, offset, count, value);
+    } else {
+        int32_t field = query->filter.terms[term].field_index;
+        ecs_entity_t src = qm->sources[field];
+        ecs_record_t *r = src ? flecs_entities_get(query->filter.world, src) : NULL;
+        if (r && r->table == table) {
+            flecs_table_stamp_rows(table, column + 1, 
+                ECS_RECORD_TO_ROW(r->row), 1, value);
+        }
+    }
+}
+
 static
 void flecs_query_mark_columns_dirty(
     ecs_query_t *query,
-    ecs_query_table_match_t *qm)
+    ecs_query_table_match_t *qm,
+    const ecs_iter_t *it)
 {
     ecs_table_t *table = qm->table;
     ecs_filter_t *filter = &query->filter;
@@ -20616,7 +24187,14 @@ void flecs_query_mark_columns_dirty(
 
             ecs_assert(tc.column >= 0, ECS_INTERNAL_ERROR, NULL);
 
-            dirty_state[tc.column + 1] ++;
+            int32_t value = ++ dirty_state[tc.column + 1];
+
+            /* Changed rows iterators stamp rows for each yielded range */
+            if ((tc.table->flags & EcsTableHasRowVersions) && 
+                !(it->flags & EcsIterChangedRows)) 
+            {
+                flecs_query_stamp_rows(query, qm, tc.table, i, tc.column, value);
+            }
         }
     }
 }
@@ -20640,7 +24218,7 @@ bool ecs_query_next_table(
         }
         if (query->flags & EcsQueryHasOutTerms) {
             if (it->count) {
-                flecs_query_mark_columns_dirty(query, prev);
+                flecs_query_mark_columns_dirty(query, prev, it);
             }
         }
     }
@@ -20821,7 +24399,8 @@ error:
     return false;
 }
 
-bool ecs_query_next_instanced(
+static
+bool flecs_query_next_instanced(
     ecs_iter_t *it)
 {
     ecs_check(it != NULL, ECS_INVALID_PARAMETER, NULL);
@@ -20833,12 +24412,18 @@ bool ecs_query_next_instanced(
 
     ecs_query_table_match_t *prev, *next, *cur = iter->node, *last = iter->last;
     if ((prev = iter->prev)) {
-        /* Match has been iterated, update monitor for change tracking */
-        if (flags & EcsQueryHasMonitor) {
+        /* Match has been iterated, update monitor for change tracking. A 
+         * changed rows iterator syncs after marking columns dirty, so that it
+         * doesn't return rows again that it wrote itself. */
+        bool sync_last = it->flags & EcsIterChangedRows;
+        if ((flags & EcsQueryHasMonitor) && !sync_last) {
             flecs_query_sync_match_monitor(query, prev);
         }
         if (flags & EcsQueryHasOutTerms) {
-            flecs_query_mark_columns_dirty(query, prev);
+            flecs_query_mark_columns_dirty(query, prev, it);
+        }
+        if ((flags & EcsQueryHasMonitor) && sync_last) {
+            flecs_query_sync_match_monitor(query, prev);
         }
     }
 
@@ -20881,6 +24466,231 @@ yield:
     return true;
 }
 
+/* Stamp owned [out] fields of the rows yielded by a changed rows iterator */
+static
+void flecs_query_changed_stamp(
+    ecs_iter_t *it,
+    ecs_query_t *query,
+    ecs_query_table_match_t *qm)
+{
+    ecs_table_t *table = qm->table;
+    if (!(query->flags & EcsQueryHasOutTerms) || 
+        !(table->flags & EcsTableHasRowVersions)) 
+    {
+        return;
+    }
+
+    const ecs_filter_t *filter = &query->filter;
+    int32_t *dirty_state = table->dirty_state;
+    int32_t t, term_count = filter->term_count;
+    for (t = 0; t < term_count; t ++) {
+        const ecs_term_t *term = &filter->terms[t];
+        if (term->inout == EcsIn || term->inout == EcsInOutNone) {
+            continue;
+        }
+
+        int32_t field = term->field_index;
+        int32_t column = qm->storage_columns[field];
+        if (column < 0 || qm->sources[field]) {
+            continue;
+        }
+
+        /* Dirty state is incremented when the iterator moves to the next
+         * match, stamp rows with the value it will have. */
+        flecs_table_stamp_rows(table, column + 1, it->offset, it->count,
+            dirty_state[column + 1] + 1);
+    }
+}
+
+/* Find next range of changed rows in match */
+static
+bool flecs_query_changed_next_range(
+    ecs_iter_t *it,
+    ecs_query_t *query,
+    ecs_query_table_match_t *qm)
+{
+    ecs_query_iter_t *iter = &it->priv.iter.query;
+    ecs_table_t *table = qm->table;
+
+    /* Restore range returned by the query */
+    int32_t shift = it->offset - iter->changed_offset;
+    if (shift) {
+        flecs_offset_iter(it, -shift);
+    }
+    it->offset = iter->changed_offset;
+    it->count = iter->changed_count;
+    it->frame_offset = iter->changed_frame_offset;
+
+    /* Collect owned fields that changed since the last iteration. Only those
+     * columns need to be tested for each row. */
+    int32_t columns[FLECS_TERM_DESC_MAX], monitors[FLECS_TERM_DESC_MAX];
+    int32_t *monitor = qm->monitor, *dirty_state = table->dirty_state;
+    int32_t i, changed_count = 0, field_count = query->filter.field_count;
+    for (i = 0; i < field_count; i ++) {
+        int32_t column = qm->storage_columns[i];
+        if (monitor[i + 1] == -1 || column < 0 || qm->sources[i]) {
+            continue;
+        }
+        if (monitor[i + 1] != dirty_state[column + 1]) {
+            columns[changed_count] = column + 1;
+            monitors[changed_count] = monitor[i + 1];
+            changed_count ++;
+        }
+    }
+
+    int32_t added = monitor[0];
+    bool test_added = added != dirty_state[0];
+    int32_t stride = table->column_count + 1;
+    int32_t *rv = flecs_table_row_versions(table, it->offset);
+    int32_t row = iter->changed_row, end = it->count;
+
+    for (; row < end; row ++) {
+        int32_t *v = &rv[row * stride];
+        if (test_added && v[0] > added) {
+            break;
+        }
+        for (i = 0; i < changed_count; i ++) {
+            if (v[columns[i]] > monitors[i]) {
+                break;
+            }
+        }
+        if (i != changed_count) {
+            break;
+        }
+    }
+
+    if (row == end) {
+        return false;
+    }
+
+    int32_t last = row + 1;
+    for (; last < end; last ++) {
+        int32_t *v = &rv[last * stride];
+        if (test_added && v[0] > added) {
+            continue;
+        }
+        for (i = 0; i < changed_count; i ++) {
+            if (v[columns[i]] > monitors[i]) {
+                break;
+            }
+        }
+        if (i == changed_count) {
+            break;
+        }
+    }
+
+    iter->changed_row = last;
+    iter->changed_yielded = true;
+    if (row) {
+        flecs_offset_iter(it, row);
+    }
+    it->offset += row;
+    it->count = last - row;
+    it->frame_offset += row;
+    flecs_query_changed_stamp(it, query, qm);
+    return true;
+}
+
+/* Next function for changed rows iterator. Skips matched tables that did not
+ * change since the last iteration, and only yields the ranges of rows that
+ * were added or written for tables that track row versions. Tables start 
+ * tracking row versions the first time they're visited by the iterator. */
+static
+bool flecs_query_next_changed(
+    ecs_iter_t *it)
+{
+    ecs_query_iter_t *iter = &it->priv.iter.query;
+    ecs_query_t *query = iter->query;
+    ecs_world_t *world = query->filter.world;
+
+    for (;;) {
+        ecs_query_table_match_t *qm;
+        if (iter->changed_active) {
+            qm = iter->prev;
+            if (flecs_query_changed_next_range(it, query, qm)) {
+                return true;
+            }
+
+            /* No rows changed, sync monitor so table isn't tested again */
+            iter->changed_active = false;
+            if (!iter->changed_yielded) {
+                flecs_query_sync_match_monitor(query, qm);
+                iter->prev = NULL;
+            }
+        }
+
+        if (!flecs_query_next_instanced(it)) {
+            return false;
+        }
+
+        qm = iter->prev;
+        ecs_table_t *table = qm->table;
+        if (!table || !it->count) {
+            return true;
+        }
+
+        /* Matches with entity filters can be yielded multiple times, test
+         * the monitor only for the first result. */
+        if (qm->entity_filter && (iter->changed_match == qm)) {
+            flecs_query_changed_stamp(it, query, qm);
+            return true;
+        }
+
+        bool fresh = flecs_query_get_match_monitor(query, qm);
+        if (!fresh && !flecs_query_check_match_monitor(query, qm, it)) {
+            iter->prev = NULL;
+            continue;
+        }
+
+        if (!(table->flags & EcsTableHasRowVersions)) {
+            if (!(world->flags & EcsWorldReadonly) && !table->_->lock) {
+                flecs_table_init_row_versions(world, table);
+            }
+            fresh = true;
+        }
+
+        if (fresh || qm->entity_filter || 
+            flecs_query_check_match_monitor_w_shared(query, qm, it, true)) 
+        {
+            /* Can't tell which rows changed, return all */
+            iter->changed_match = qm;
+            flecs_query_changed_stamp(it, query, qm);
+            return true;
+        }
+
+        iter->changed_active = true;
+        iter->changed_yielded = false;
+        iter->changed_row = 0;
+        iter->changed_offset = it->offset;
+        iter->changed_count = it->count;
+        iter->changed_frame_offset = it->frame_offset;
+    }
+}
+
+bool ecs_query_next_instanced(
+    ecs_iter_t *it)
+{
+    if (it->flags & EcsIterChangedRows) {
+        return flecs_sparse_filter_next(it, flecs_query_next_changed);
+    }
+    return flecs_sparse_filter_next(it, flecs_query_next_instanced);
+}
+
+ecs_iter_t ecs_query_changed_iter(
+    const ecs_world_t *world,
+    ecs_query_t *query)
+{
+    ecs_poly_assert(query, ecs_query_t);
+
+    /* Monitors are created when a table is first visited, which causes the
+     * iterator to return all rows of the table. */
+    query->flags |= EcsQueryHasMonitor;
+
+    ecs_iter_t it = ecs_query_iter(world, query);
+    ECS_BIT_SET(it.flags, EcsIterChangedRows);
+    return it;
+}
+
 bool ecs_query_changed(
     ecs_query_t *query,
     const ecs_iter_t *it)
@@ -21003,6 +24813,19 @@ void* ecs_query_get_binding_ctx(
     return query->binding_ctx;
 }
 
+uint64_t ecs_float_to_sort_key(
+    double value)
+{
+    /* Flip all bits of negative values so that they sort in reverse order, and
+     * set the sign bit of positive values so they sort after negative values */
+    uint64_t bits;
+    ecs_os_memcpy(&bits, &value, ECS_SIZEOF(uint64_t));
+    if (bits & ((uint64_t)1 << 63)) {
+        return ~bits;
+    }
+    return bits | ((uint64_t)1 << 63);
+}
+
 /**
  * @file search.c
  * @brief Search functions to find (component) ids in table types.
@@ -21463,6 +25286,108 @@ ecs_cmd_t* flecs_cmd_new_batched(
     return cmd;
 }
 
+/* Move commands from the queue of one stage to another. Commands for the same
+ * entity are linked up with commands already in the destination queue, so that
+ * they can be batched when the destination stage is flushed. The command 
+ * values stay in the stack of the source stage, which must not be reset before
+ * the destination queue has been flushed. */
+static
+void flecs_commands_move(
+    ecs_stage_t *dst,
+    ecs_stage_t *src)
+{
+    ecs_vec_t *src_queue = &src->cmd->queue;
+    int32_t i, count = ecs_vec_count(src_queue);
+    if (!count) {
+        return;
+    }
+
+    ecs_cmd_t *src_cmds = ecs_vec_first(src_queue);
+
+    /* Only the first command for an entity has an entry. Propagate it to the 
+     * other commands for the entity, so we know which commands are batched. */
+    for (i = 0; i < count; i ++) {
+        ecs_cmd_t *cmd = &src_cmds[i];
+        ecs_cmd_entry_t *entry = cmd->entry;
+        if (entry && entry->first == i) {
+            int32_t next = cmd->next_for_entity;
+            while (next) {
+                if (next < 0) {
+                    next *= -1;
+                }
+                src_cmds[next].entry = entry;
+                next = src_cmds[next].next_for_entity;
+            }
+        }
+    }
+
+    ecs_vec_t *dst_queue = &dst->cmd->queue;
+    ecs_vec_set_min_size_t(&dst->allocator, dst_queue, ecs_cmd_t, 
+        ecs_vec_count(dst_queue) + count);
+
+    for (i = 0; i < count; i ++) {
+        ecs_cmd_t *src_cmd = &src_cmds[i];
+        ecs_cmd_entry_t *src_entry = src_cmd->entry;
+        ecs_cmd_t *cmd;
+        if (src_entry) {
+            src_entry->first = -1;
+            cmd = flecs_cmd_new_batched(dst, src_cmd->entity);
+        } else {
+            cmd = flecs_cmd_new(dst);
+        }
+
+        int32_t next_for_entity = cmd->next_for_entity;
+        ecs_cmd_entry_t *entry = cmd->entry;
+        *cmd = *src_cmd;
+        cmd->next_for_entity = next_for_entity;
+        cmd->entry = entry;
+    }
+
+    ecs_vec_clear(src_queue);
+}
+
+/* Merge commands of all stages into a single queue. This batches commands for
+ * entities that were modified by multiple stages, so that each entity moves 
+ * tables once. Commands are gathered in stage order. */
+static
+bool flecs_stages_merge_combined(
+    ecs_world_t *world,
+    bool force_merge)
+{
+    int32_t i, count = ecs_get_stage_count(world);
+    ecs_stage_t *main_stage = &world->stages[0];
+    if (main_stage->defer != 1 || (!force_merge && !main_stage->auto_merge)) {
+        /* Queue of main stage won't be flushed, don't combine */
+        return false;
+    }
+
+    for (i = 1; i < count; i ++) {
+        ecs_stage_t *s = &world->stages[i];
+        if ((force_merge || s->auto_merge) && s->defer == 1) {
+            flecs_commands_move(main_stage, s);
+        }
+    }
+
+    flecs_defer_end(world, main_stage);
+
+    for (i = 1; i < count; i ++) {
+        ecs_stage_t *s = &world->stages[i];
+        if (!force_merge && !s->auto_merge) {
+            continue;
+        }
+
+        if (s->defer == 1) {
+            /* Commands have been flushed by main stage, release values */
+            s->defer --;
+            flecs_stack_reset(&s->cmd->stack);
+        } else {
+            flecs_defer_end(world, s);
+        }
+    }
+
+    return true;
+}
+
 static
 void flecs_stages_merge(
     ecs_world_t *world,
@@ -21491,7 +25416,9 @@ void flecs_stages_merge(
                 "mismatching defer_begin/defer_end detected");
             flecs_defer_end(world, stage);
         }
-    } else {
+    } else if (!(world->flags & EcsWorldCombinedMerge) ||
+        !flecs_stages_merge_combined(world, force_merge))
+    {
         /* Merge stages. Only merge if the stage has auto_merging turned on, or 
          * if this is a forced merge (like when ecs_merge is called) */
         int32_t i, count = ecs_get_stage_count(world);
@@ -21672,7 +25599,8 @@ bool flecs_defer_bulk_new(
     const ecs_entity_t **ids_out)
 {
     if (flecs_defer_cmd(stage)) {
-        ecs_entity_t *ids = ecs_os_malloc(count * ECS_SIZEOF(ecs_entity_t));
+        ecs_entity_t *ids = flecs_stack_alloc_n(
+            &stage->cmd->stack, ecs_entity_t, count);
 
         /* Use ecs_new_id as this is thread safe */
         int i;
@@ -21970,7 +25898,7 @@ void flecs_commands_init(
     ecs_stage_t *stage,
     ecs_commands_t *cmd)
 {
-    flecs_stack_init(&cmd->stack);
+    flecs_stack_init_w_cache(&cmd->stack, &stage->allocators.stack_pages);
     ecs_vec_init_t(&stage->allocator, &cmd->queue, ecs_cmd_t, 0);
     flecs_sparse_init_t(&cmd->entries, &stage->allocator,
         &stage->allocators.cmd_entry_chunk, ecs_cmd_entry_t);
@@ -22017,8 +25945,10 @@ void flecs_stage_init(
     stage->auto_merge = true;
     stage->async = false;
 
-    flecs_stack_init(&stage->allocators.iter_stack);
-    flecs_stack_init(&stage->allocators.deser_stack);
+    ecs_stage_allocators_t *sa = &stage->allocators;
+    flecs_balloc_cache_init(&sa->stack_pages, &world->stack_pages);
+    flecs_stack_init_w_cache(&sa->iter_stack, &sa->stack_pages);
+    flecs_stack_init_w_cache(&sa->deser_stack, &sa->stack_pages);
     flecs_allocator_init(&stage->allocator);
     flecs_ballocator_init_n(&stage->allocators.cmd_entry_chunk, ecs_cmd_entry_t,
         FLECS_SPARSE_PAGE_SIZE);
@@ -22058,6 +25988,7 @@ void flecs_stage_fini(
     flecs_stack_fini(&stage->allocators.iter_stack);
     flecs_stack_fini(&stage->allocators.deser_stack);
     flecs_ballocator_fini(&stage->allocators.cmd_entry_chunk);
+    flecs_balloc_cache_fini(&stage->allocators.stack_pages);
     flecs_allocator_fini(&stage->allocator);
 }
 
@@ -22226,6 +26157,22 @@ error:
     return;
 }
 
+void ecs_set_combined_merge(
+    ecs_world_t *world,
+    bool enable)
+{
+    ecs_poly_assert(world, ecs_world_t);
+    ECS_BIT_COND(world->flags, EcsWorldCombinedMerge, enable);
+}
+
+void ecs_set_parallel_merge(
+    ecs_world_t *world,
+    bool enable)
+{
+    ecs_poly_assert(world, ecs_world_t);
+    ECS_BIT_COND(world->flags, EcsWorldParallelMerge, enable);
+}
+
 void ecs_set_automerge(
     ecs_world_t *world,
     bool auto_merge)
@@ -22626,6 +26573,7 @@ const ecs_entity_t EcsOneOf =                       FLECS_HI_COMPONENT_ID + 26;
 const ecs_entity_t EcsTrait =                       FLECS_HI_COMPONENT_ID + 27;
 const ecs_entity_t EcsRelationship =            FLECS_HI_COMPONENT_ID + 28;
 const ecs_entity_t EcsTarget =                  FLECS_HI_COMPONENT_ID + 29;
+const ecs_entity_t EcsSparse =                      FLECS_HI_COMPONENT_ID + 45;
 
 /* Builtin relationships */
 const ecs_entity_t EcsChildOf =                     FLECS_HI_COMPONENT_ID + 30;
@@ -22959,7 +26907,7 @@ ecs_world_t* flecs_suspend_readonly(
     state->defer_count = stage->defer;
     state->commands = stage->cmd->queue;
     state->defer_stack = stage->cmd->stack;
-    flecs_stack_init(&stage->cmd->stack);
+    flecs_stack_init_w_cache(&stage->cmd->stack, &stage->allocators.stack_pages);
     state->scope = stage->scope;
     state->with = stage->with;
     stage->defer = 0;
@@ -23011,6 +26959,11 @@ void flecs_eval_component_monitor(
 
     world->monitors.is_dirty = false;
 
+    /* Collect queries first, so they can be rematched in parallel */
+    ecs_allocator_t *a = &world->allocator;
+    ecs_vec_t queries;
+    ecs_vec_init_t(a, &queries, ecs_query_t*, 0);
+
     ecs_map_iter_t it = ecs_map_iter(&world->monitors.monitors);
     while (ecs_map_next(&it)) {
         ecs_monitor_t *m = ecs_map_ptr(&it);
@@ -23020,15 +26973,15 @@ void flecs_eval_component_monitor(
 
         m->is_dirty = false;
 
-        int32_t i, count = ecs_vec_count(&m->queries);
-        ecs_query_t **elems = ecs_vec_first(&m->queries);
-        for (i = 0; i < count; i ++) {
-            ecs_query_t *q = elems[i];
-            flecs_query_notify(world, q, &(ecs_query_event_t) {
-                .kind = EcsQueryTableRematch
-            });
-        }
+        int32_t count = ecs_vec_count(&m->queries);
+        ecs_os_memcpy_n(ecs_vec_grow_t(a, &queries, ecs_query_t*, count),
+            ecs_vec_first(&m->queries), ecs_query_t*, count);
     }
+
+    flecs_query_rematch_all(world, ecs_vec_first(&queries), 
+        ecs_vec_count(&queries));
+
+    ecs_vec_fini_t(a, &queries, ecs_query_t*);
 }
 
 void flecs_monitor_mark_dirty(
@@ -23205,7 +27158,7 @@ void flecs_fini_root_tables(
             for (i = count - 1; i >= 0; i --) {
                 ecs_record_t *r = flecs_entities_get(world, entities[i]);
                 ecs_assert(r != NULL, ECS_INTERNAL_ERROR, NULL);
-                if (!ECS_RECORD_TO_ROW_FLAGS(r->row)) {
+                if (!(ECS_RECORD_TO_ROW_FLAGS(r->row) & ~EcsEntityHasSparse)) {
                     ecs_delete(world, entities[i]);
                 }
             }
@@ -23296,6 +27249,9 @@ void flecs_world_allocators_init(
     ecs_world_allocators_t *a = &world->allocators;
 
     flecs_allocator_init(&world->allocator);
+    flecs_allocator_init_aligned(&world->column_allocator, 
+        FLECS_COLUMN_ALIGNMENT);
+    flecs_balloc_depot_init(&world->stack_pages, FLECS_STACK_PAGE_ALLOC_SIZE);
 
     ecs_map_params_init(&a->ptr, &world->allocator);
     ecs_map_params_init(&a->query_table_list, &world->allocator);
@@ -23333,6 +27289,8 @@ void flecs_world_allocators_fini(
     flecs_table_diff_builder_fini(world, &world->allocators.diff_builder);
 
     flecs_allocator_fini(&world->allocator);
+    flecs_allocator_fini(&world->column_allocator);
+    flecs_balloc_depot_fini(&world->stack_pages);
 }
 
 #define ECS_STRINGIFY_INNER(x) #x
@@ -23370,6 +27328,9 @@ static const char *flecs_addons_info[] = {
 #ifdef FLECS_SNAPSHOT
     "FLECS_SNAPSHOT",
 #endif
+#ifdef FLECS_RECORDER
+    "FLECS_RECORDER",
+#endif
 #ifdef FLECS_STATS
     "FLECS_STATS",
 #endif
@@ -23532,6 +27493,7 @@ ecs_world_t *ecs_mini(void) {
         &world->allocators.sparse_chunk, ecs_type_info_t);
     ecs_map_init_w_params(&world->id_index_hi, &world->allocators.ptr);
     world->id_index_lo = ecs_os_calloc_n(ecs_id_record_t, FLECS_HI_ID_RECORD_ID);
+    ecs_vec_init_t(a, &world->sparse_ids, ecs_id_record_t*, 0);
     flecs_observable_init(&world->observable);
     world->iterable.init = flecs_world_iter_init;
 
@@ -24216,6 +28178,36 @@ bool ecs_enable_range_check(
     return old_value;
 }
 
+bool ecs_enable_aligned_columns(
+    ecs_world_t *world,
+    bool enable)
+{
+    ecs_poly_assert(world, ecs_world_t);
+    ecs_check(!(world->flags & EcsWorldReadonly), 
+        ECS_INVALID_OPERATION, NULL);
+    ecs_check(!ecs_is_deferred(world), ECS_INVALID_OPERATION, NULL);
+
+    bool old_value = ECS_BIT_IS_SET(world->flags, EcsWorldAlignedColumns);
+    if (old_value == enable) {
+        return old_value;
+    }
+
+    ecs_allocator_t *src = flecs_column_allocator(world);
+    ECS_BIT_COND(world->flags, EcsWorldAlignedColumns, enable);
+    ecs_allocator_t *dst = flecs_column_allocator(world);
+
+    int32_t i, count = flecs_sparse_count(&world->store.tables);
+    for (i = 1; i < count; i ++) {
+        ecs_table_t *table = flecs_sparse_get_dense_t(&world->store.tables,
+            ecs_table_t, i);
+        flecs_table_move_columns(world, table, dst, src);
+    }
+
+    return old_value;
+error:
+    return false;
+}
+
 ecs_entity_t ecs_get_max_id(
     const ecs_world_t *world)
 {
@@ -24697,6 +28689,11 @@ void flecs_table_set_empty(
     ecs_assert(!(world->flags & EcsWorldReadonly), ECS_INTERNAL_ERROR, NULL);
     ecs_assert(table != NULL, ECS_INTERNAL_ERROR, NULL);
 
+    if (world->flags & EcsWorldParallelMerging) {
+        /* Tables are registered by main thread after workers are done */
+        return;
+    }
+
     if (ecs_table_count(table)) {
         table->_->generation = 0;
     }
@@ -25942,6 +29939,7 @@ void flecs_doc_import_core_definitions(
     ecs_doc_set_brief(world, EcsWith, "Trait for adding additional components when a component is added");
     ecs_doc_set_brief(world, EcsAlwaysOverride, "Trait that indicates a component should always be overridden");
     ecs_doc_set_brief(world, EcsUnion, "Trait for creating a non-fragmenting relationship");
+    ecs_doc_set_brief(world, EcsSparse, "Trait for storing a component outside of tables");
     ecs_doc_set_brief(world, EcsOneOf, "Trait that enforces target of relationship is a child of <specified>");
     ecs_doc_set_brief(world, EcsOnDelete, "Cleanup trait for specifying what happens when component is deleted");
     ecs_doc_set_brief(world, EcsOnDeleteTarget, "Cleanup trait for specifying what happens when pair target is deleted");
@@ -34834,6 +38832,1073 @@ void FlecsScriptImport(
 
 #endif
 
+/**
+ * @file addons/recorder.c
+ * @brief Record & replay command queues.
+ *
+ * A recording is a sequence of records. Each record starts with a byte that
+ * indicates the record kind:
+ *
+ * - Name records store the path of an entity that is used as (part of) an id,
+ *   so ids can be resolved by name when replaying. Names are numbered in the
+ *   order in which they appear in the recording.
+ * - Sync records store the frame and number of commands of a merged queue, and
+ *   are followed by the command records of the queue.
+ * - Command records store the command kind, entity, id and command specific
+ *   data, such as a component value.
+ *
+ * Numbers are stored in the byte order of the machine that made the recording.
+ */
+
+
+#ifdef FLECS_RECORDER
+
+#define FLECS_RECORDER_MAGIC "FLCR"
+#define FLECS_RECORDER_VERSION (1)
+
+#define FLECS_RECORD_NAME ('N')
+#define FLECS_RECORD_SYNC ('S')
+#define FLECS_RECORD_CMD ('C')
+
+typedef enum ecs_record_value_kind_t {
+    EcsRecordValueNone,
+    EcsRecordValueBytes,
+    EcsRecordValueJson
+} ecs_record_value_kind_t;
+
+struct ecs_recorder_t {
+    ecs_world_t *world;
+    FILE *file;
+    ecs_recorder_write_action_t callback;
+    void *ctx;
+    ecs_vec_t buf;                   /* vector<char> with data of current sync */
+    ecs_map_t names;                 /* map<entity, name index + 1> */
+    int32_t name_count;
+};
+
+struct ecs_replayer_t {
+    ecs_world_t *world;
+    char *data;
+    ecs_size_t size;
+    ecs_size_t pos;
+    ecs_vec_t names;                 /* vector<ecs_entity_t> with resolved names */
+};
+
+/* -- Recorder -- */
+
+static
+void flecs_rec_write(
+    ecs_recorder_t *rec,
+    const void *ptr,
+    ecs_size_t size)
+{
+    if (size) {
+        void *dst = ecs_vec_grow_t(NULL, &rec->buf, char, size);
+        ecs_os_memcpy(dst, ptr, size);
+    }
+}
+
+static
+void flecs_rec_u8(
+    ecs_recorder_t *rec,
+    uint8_t value)
+{
+    flecs_rec_write(rec, &value, ECS_SIZEOF(uint8_t));
+}
+
+static
+void flecs_rec_i32(
+    ecs_recorder_t *rec,
+    int32_t value)
+{
+    flecs_rec_write(rec, &value, ECS_SIZEOF(int32_t));
+}
+
+static
+void flecs_rec_u64(
+    ecs_recorder_t *rec,
+    uint64_t value)
+{
+    flecs_rec_write(rec, &value, ECS_SIZEOF(uint64_t));
+}
+
+static
+void flecs_rec_str(
+    ecs_recorder_t *rec,
+    const char *str)
+{
+    ecs_size_t len = ecs_os_strlen(str);
+    flecs_rec_i32(rec, len);
+    flecs_rec_write(rec, str, len);
+}
+
+static
+void flecs_rec_flush(
+    ecs_recorder_t *rec)
+{
+    ecs_size_t size = ecs_vec_count(&rec->buf);
+    if (!size) {
+        return;
+    }
+
+    const void *data = ecs_vec_first(&rec->buf);
+    if (rec->file) {
+        fwrite(data, 1, flecs_itosize(size), rec->file);
+    } else if (rec->callback) {
+        rec->callback(data, size, rec->ctx);
+    }
+
+    ecs_vec_clear(&rec->buf);
+}
+
+/* Write name record for entity if it has a name and wasn't written yet */
+static
+void flecs_rec_name(
+    ecs_recorder_t *rec,
+    ecs_entity_t e)
+{
+    ecs_world_t *world = rec->world;
+    if (!e || (e == EcsWildcard) || (e == EcsAny)) {
+        return;
+    }
+
+    e = ecs_get_alive(world, e);
+    if (!e || !ecs_get_name(world, e)) {
+        return;
+    }
+
+    ecs_map_val_t *index = ecs_map_ensure(&rec->names, e);
+    if (index[0]) {
+        return;
+    }
+
+    rec->name_count ++;
+    index[0] = flecs_ito(uint64_t, rec->name_count);
+
+    char *path = ecs_get_fullpath(world, e);
+    flecs_rec_u8(rec, FLECS_RECORD_NAME);
+    flecs_rec_str(rec, path);
+    ecs_os_free(path);
+}
+
+static
+void flecs_rec_id_names(
+    ecs_recorder_t *rec,
+    ecs_id_t id)
+{
+    if (ECS_IS_PAIR(id)) {
+        flecs_rec_name(rec, ECS_PAIR_FIRST(id));
+        flecs_rec_name(rec, ECS_PAIR_SECOND(id));
+    } else {
+        flecs_rec_name(rec, id & ECS_COMPONENT_MASK);
+    }
+}
+
+static
+int32_t flecs_rec_name_index(
+    ecs_recorder_t *rec,
+    ecs_entity_t e)
+{
+    if (!e) {
+        return 0;
+    }
+
+    e = ecs_get_alive(rec->world, e);
+    if (!e) {
+        return 0;
+    }
+
+    ecs_map_val_t *index = ecs_map_get(&rec->names, e);
+    if (!index) {
+        return 0;
+    }
+
+    return flecs_uto(int32_t, index[0]);
+}
+
+/* Ids are stored as raw id, followed by the name indices of the id (or pair
+ * elements). A name index of 0 means the element has no name. */
+static
+void flecs_rec_id(
+    ecs_recorder_t *rec,
+    ecs_id_t id)
+{
+    flecs_rec_u64(rec, id);
+    if (ECS_IS_PAIR(id)) {
+        flecs_rec_i32(rec, flecs_rec_name_index(rec, ECS_PAIR_FIRST(id)));
+        flecs_rec_i32(rec, flecs_rec_name_index(rec, ECS_PAIR_SECOND(id)));
+    } else {
+        flecs_rec_i32(rec, flecs_rec_name_index(rec, id & ECS_COMPONENT_MASK));
+        flecs_rec_i32(rec, 0);
+    }
+}
+
+static
+void flecs_rec_value(
+    ecs_recorder_t *rec,
+    ecs_id_t id,
+    const void *ptr)
+{
+    ecs_world_t *world = rec->world;
+    const ecs_type_info_t *ti = NULL;
+    if (ptr) {
+        ti = ecs_get_type_info(world, id);
+    }
+
+    if (!ti) {
+        flecs_rec_u8(rec, EcsRecordValueNone);
+        return;
+    }
+
+    /* Values of types without hooks can be copied as bytes */
+    if (!ti->hooks.copy && !ti->hooks.move && !ti->hooks.dtor) {
+        flecs_rec_u8(rec, EcsRecordValueBytes);
+        flecs_rec_i32(rec, ti->size);
+        flecs_rec_write(rec, ptr, ti->size);
+        return;
+    }
+
+#ifdef FLECS_JSON
+    if (ecs_has(world, ti->component, EcsMetaType)) {
+        char *json = ecs_ptr_to_json(world, ti->component, ptr);
+        if (json) {
+            flecs_rec_u8(rec, EcsRecordValueJson);
+            flecs_rec_str(rec, json);
+            ecs_os_free(json);
+            return;
+        }
+    }
+#endif
+
+    flecs_rec_u8(rec, EcsRecordValueNone);
+}
+
+static
+bool flecs_rec_cmd_is_recorded(
+    ecs_world_t *world,
+    const ecs_cmd_t *cmd)
+{
+    ecs_entity_t e = cmd->entity;
+    switch(cmd->kind) {
+    case EcsCmdAdd:
+    case EcsCmdRemove:
+    case EcsCmdSet:
+    case EcsCmdEmplace:
+    case EcsCmdEnsure:
+    case EcsCmdModified:
+    case EcsCmdModifiedNoHook:
+    case EcsCmdAddModified:
+    case EcsCmdClone:
+    case EcsCmdDelete:
+    case EcsCmdClear:
+    case EcsCmdEnable:
+    case EcsCmdDisable:
+    case EcsCmdEvent:
+        /* Commands for entities that are not alive are discarded by merge */
+        return e && flecs_entities_is_alive(world, e);
+    case EcsCmdPath:
+    case EcsCmdBulkNew:
+        return true;
+    case EcsCmdOnDeleteAction:
+    case EcsCmdSkip:
+    default:
+        return false;
+    }
+}
+
+static
+void flecs_rec_cmd_names(
+    ecs_recorder_t *rec,
+    const ecs_cmd_t *cmd)
+{
+    flecs_rec_id_names(rec, cmd->id);
+
+    if (cmd->kind == EcsCmdEvent) {
+        const ecs_event_desc_t *desc = cmd->is._1.value;
+        flecs_rec_name(rec, desc->event);
+        if (desc->ids) {
+            int32_t i;
+            for (i = 0; i < desc->ids->count; i ++) {
+                flecs_rec_id_names(rec, desc->ids->array[i]);
+            }
+        }
+    }
+}
+
+static
+void flecs_rec_cmd(
+    ecs_recorder_t *rec,
+    const ecs_cmd_t *cmd)
+{
+    ecs_world_t *world = rec->world;
+    ecs_cmd_kind_t kind = cmd->kind;
+
+    /* Add + modified doesn't store the value in the command, as the value was
+     * assigned directly to the existing component. Record it as a set with the
+     * current value of the component. */
+    const void *value = NULL;
+    if (kind == EcsCmdAddModified) {
+        kind = EcsCmdSet;
+        value = ecs_get_id(world, cmd->entity, cmd->id);
+    } else {
+        value = cmd->is._1.value;
+    }
+
+    flecs_rec_u8(rec, FLECS_RECORD_CMD);
+    flecs_rec_u8(rec, flecs_ito(uint8_t, kind));
+    flecs_rec_u64(rec, cmd->entity);
+    flecs_rec_id(rec, cmd->id);
+
+    switch(kind) {
+    case EcsCmdSet:
+    case EcsCmdEmplace:
+    case EcsCmdEnsure:
+        flecs_rec_value(rec, cmd->id, value);
+        break;
+    case EcsCmdClone:
+        flecs_rec_u8(rec, cmd->is._1.clone_value);
+        break;
+    case EcsCmdPath:
+        flecs_rec_str(rec, cmd->is._1.value);
+        break;
+    case EcsCmdBulkNew:
+        flecs_rec_i32(rec, cmd->is._n.count);
+        flecs_rec_write(rec, cmd->is._n.entities,
+            cmd->is._n.count * ECS_SIZEOF(ecs_entity_t));
+        break;
+    case EcsCmdEvent: {
+        const ecs_event_desc_t *desc = cmd->is._1.value;
+        int32_t i, count = desc->ids ? desc->ids->count : 0;
+        flecs_rec_id(rec, desc->event);
+        flecs_rec_i32(rec, count);
+        for (i = 0; i < count; i ++) {
+            flecs_rec_id(rec, desc->ids->array[i]);
+        }
+        const void *param = desc->param;
+        if (!param) {
+            param = desc->const_param;
+        }
+        flecs_rec_value(rec, desc->event, param);
+        break;
+    }
+    case EcsCmdAdd:
+    case EcsCmdRemove:
+    case EcsCmdModified:
+    case EcsCmdModifiedNoHook:
+    case EcsCmdAddModified:
+    case EcsCmdDelete:
+    case EcsCmdClear:
+    case EcsCmdOnDeleteAction:
+    case EcsCmdEnable:
+    case EcsCmdDisable:
+    case EcsCmdSkip:
+    default:
+        break;
+    }
+}
+
+static
+void flecs_rec_on_commands(
+    const ecs_stage_t *stage,
+    const ecs_vec_t *commands,
+    void *ctx)
+{
+    ecs_recorder_t *rec = ctx;
+    ecs_world_t *world = rec->world;
+    ecs_assert(stage->world == world, ECS_INTERNAL_ERROR, NULL);
+    (void)stage;
+
+    int32_t i, count = ecs_vec_count(commands);
+    ecs_cmd_t *cmds = ecs_vec_first(commands);
+
+    /* Names are written before the sync, so that they're resolved before the
+     * replayer starts deferring the commands of the sync. */
+    int32_t recorded = 0;
+    for (i = 0; i < count; i ++) {
+        if (flecs_rec_cmd_is_recorded(world, &cmds[i])) {
+            flecs_rec_cmd_names(rec, &cmds[i]);
+            recorded ++;
+        }
+    }
+
+    if (!recorded) {
+        return;
+    }
+
+    flecs_rec_u8(rec, FLECS_RECORD_SYNC);
+    flecs_rec_u64(rec, flecs_ito(uint64_t, world->info.frame_count_total));
+    flecs_rec_i32(rec, recorded);
+
+    for (i = 0; i < count; i ++) {
+        if (flecs_rec_cmd_is_recorded(world, &cmds[i])) {
+            flecs_rec_cmd(rec, &cmds[i]);
+        }
+    }
+
+    flecs_rec_flush(rec);
+}
+
+ecs_recorder_t* ecs_recorder_start(
+    ecs_world_t *world,
+    const ecs_recorder_desc_t *desc)
+{
+    ecs_poly_assert(world, ecs_world_t);
+    ecs_check(desc != NULL, ECS_INVALID_PARAMETER, NULL);
+    ecs_check(desc->filename || desc->callback, ECS_INVALID_PARAMETER,
+        "recorder must have a filename or callback");
+    ecs_check(!world->on_commands_record, ECS_INVALID_OPERATION,
+        "world already has an active recorder");
+
+    FILE *file = NULL;
+    if (desc->filename) {
+        ecs_os_fopen(&file, desc->filename, "wb");
+        if (!file) {
+            ecs_err("%s (%s)", ecs_os_strerror(errno), desc->filename);
+            goto error;
+        }
+    }
+
+    ecs_recorder_t *rec = ecs_os_calloc_t(ecs_recorder_t);
+    rec->world = world;
+    rec->file = file;
+    rec->callback = desc->callback;
+    rec->ctx = desc->ctx;
+    ecs_vec_init_t(NULL, &rec->buf, char, 0);
+    ecs_map_init(&rec->names, NULL);
+
+    flecs_rec_write(rec, FLECS_RECORDER_MAGIC, 4);
+    flecs_rec_i32(rec, FLECS_RECORDER_VERSION);
+    flecs_rec_flush(rec);
+
+    world->on_commands_record = flecs_rec_on_commands;
+    world->on_commands_record_ctx = rec;
+
+    return rec;
+error:
+    return NULL;
+}
+
+void ecs_recorder_stop(
+    ecs_recorder_t *rec)
+{
+    ecs_check(rec != NULL, ECS_INVALID_PARAMETER, NULL);
+
+    ecs_world_t *world = rec->world;
+    ecs_assert(world->on_commands_record_ctx == rec,
+        ECS_INTERNAL_ERROR, NULL);
+    world->on_commands_record = NULL;
+    world->on_commands_record_ctx = NULL;
+
+    flecs_rec_flush(rec);
+    if (rec->file) {
+        fclose(rec->file);
+    }
+
+    ecs_vec_fini_t(NULL, &rec->buf, char);
+    ecs_map_fini(&rec->names);
+    ecs_os_free(rec);
+error:
+    return;
+}
+
+/* -- Replayer -- */
+
+static
+bool flecs_rp_read(
+    ecs_replayer_t *rp,
+    void *dst,
+    ecs_size_t size)
+{
+    if ((rp->size - rp->pos) < size) {
+        ecs_err("replay: unexpected end of recording");
+        return false;
+    }
+
+    ecs_os_memcpy(dst, &rp->data[rp->pos], size);
+    rp->pos += size;
+    return true;
+}
+
+static
+bool flecs_rp_u8(
+    ecs_replayer_t *rp,
+    uint8_t *value)
+{
+    return flecs_rp_read(rp, value, ECS_SIZEOF(uint8_t));
+}
+
+static
+bool flecs_rp_i32(
+    ecs_replayer_t *rp,
+    int32_t *value)
+{
+    return flecs_rp_read(rp, value, ECS_SIZEOF(int32_t));
+}
+
+static
+bool flecs_rp_u64(
+    ecs_replayer_t *rp,
+    uint64_t *value)
+{
+    return flecs_rp_read(rp, value, ECS_SIZEOF(uint64_t));
+}
+
+/* Returns pointer to data in recording */
+static
+const char* flecs_rp_bytes(
+    ecs_replayer_t *rp,
+    ecs_size_t *size_out)
+{
+    int32_t size;
+    if (!flecs_rp_i32(rp, &size)) {
+        return NULL;
+    }
+
+    if ((size < 0) || ((rp->size - rp->pos) < size)) {
+        ecs_err("replay: unexpected end of recording");
+        return NULL;
+    }
+
+    const char *result = &rp->data[rp->pos];
+    rp->pos += size;
+    *size_out = size;
+    return result;
+}
+
+static
+char* flecs_rp_str(
+    ecs_replayer_t *rp)
+{
+    ecs_size_t len;
+    const char *str = flecs_rp_bytes(rp, &len);
+    if (!str) {
+        return NULL;
+    }
+
+    char *result = ecs_os_malloc(len + 1);
+    ecs_os_memcpy(result, str, len);
+    result[len] = '\0';
+    return result;
+}
+
+static
+int flecs_rp_name(
+    ecs_replayer_t *rp)
+{
+    ecs_world_t *world = rp->world;
+    char *path = flecs_rp_str(rp);
+    if (!path) {
+        return -1;
+    }
+
+    ecs_entity_t e = ecs_lookup_fullpath(world, path);
+    if (!e) {
+        e = ecs_entity(world, { .name = path, .sep = ".", .root_sep = "" });
+    }
+
+    ecs_vec_append_t(NULL, &rp->names, ecs_entity_t)[0] = e;
+    ecs_os_free(path);
+    return 0;
+}
+
+static
+ecs_entity_t flecs_rp_resolve(
+    ecs_replayer_t *rp,
+    int32_t name,
+    ecs_entity_t e)
+{
+    if (!name) {
+        return e;
+    }
+
+    return ecs_vec_get_t(&rp->names, ecs_entity_t, name - 1)[0];
+}
+
+static
+bool flecs_rp_id(
+    ecs_replayer_t *rp,
+    ecs_id_t *id_out)
+{
+    uint64_t id;
+    int32_t first, second;
+    if (!flecs_rp_u64(rp, &id) || !flecs_rp_i32(rp, &first) ||
+        !flecs_rp_i32(rp, &second))
+    {
+        return false;
+    }
+
+    int32_t name_count = ecs_vec_count(&rp->names);
+    if ((first < 0) || (first > name_count) || 
+        (second < 0) || (second > name_count))
+    {
+        ecs_err("replay: invalid name index");
+        return false;
+    }
+
+    if (ECS_IS_PAIR(id)) {
+        ecs_entity_t r = flecs_rp_resolve(rp, first, ECS_PAIR_FIRST(id));
+        ecs_entity_t t = flecs_rp_resolve(rp, second, ECS_PAIR_SECOND(id));
+        *id_out = (r && t) ? ecs_pair(r & ECS_ENTITY_MASK, t) : 0;
+    } else {
+        ecs_entity_t e = flecs_rp_resolve(rp, first, id & ECS_COMPONENT_MASK);
+        *id_out = e ? ((id & ECS_ID_FLAGS_MASK) | e) : 0;
+    }
+
+    return true;
+}
+
+/* Reads value. Values stored as JSON are deserialized into tmp_out, which must
+ * be freed by the caller. */
+static
+bool flecs_rp_value(
+    ecs_replayer_t *rp,
+    ecs_id_t id,
+    const void **value_out,
+    void **tmp_out)
+{
+    ecs_world_t *world = rp->world;
+    uint8_t kind;
+    ecs_size_t size = 0;
+    const char *data = NULL;
+
+    *value_out = NULL;
+    *tmp_out = NULL;
+
+    if (!flecs_rp_u8(rp, &kind)) {
+        return false;
+    }
+
+    if (kind == EcsRecordValueNone) {
+        return true;
+    }
+
+    if (!(data = flecs_rp_bytes(rp, &size))) {
+        return false;
+    }
+
+    const ecs_type_info_t *ti = NULL;
+    if (id) {
+        ti = ecs_get_type_info(world, id);
+    }
+    if (!ti) {
+        /* Component isn't registered in this world */
+        return true;
+    }
+
+    if (kind == EcsRecordValueBytes) {
+        if (size == ti->size) {
+            *value_out = data;
+        }
+    } else if (kind == EcsRecordValueJson) {
+#ifdef FLECS_JSON
+        char *json = ecs_os_malloc(size + 1);
+        ecs_os_memcpy(json, data, size);
+        json[size] = '\0';
+        void *tmp = ecs_value_new(world, ti->component);
+        if (ecs_ptr_from_json(world, ti->component, tmp, json, NULL)) {
+            *value_out = *tmp_out = tmp;
+        } else {
+            ecs_value_free(world, ti->component, tmp);
+        }
+        ecs_os_free(json);
+#endif
+    } else {
+        ecs_err("replay: invalid value kind %u", kind);
+        return false;
+    }
+
+    return true;
+}
+
+static
+void flecs_rp_value_free(
+    ecs_replayer_t *rp,
+    ecs_id_t id,
+    void *tmp)
+{
+    if (tmp) {
+        const ecs_type_info_t *ti = ecs_get_type_info(rp->world, id);
+        ecs_value_free(rp->world, ti->component, tmp);
+    }
+}
+
+/* Make entity alive with the recorded id. Returns false if a different
+ * generation of the entity is alive. */
+static
+bool flecs_rp_entity(
+    ecs_replayer_t *rp,
+    ecs_entity_t e)
+{
+    ecs_entity_t alive = ecs_get_alive(rp->world, (uint32_t)e);
+    if (!alive) {
+        ecs_make_alive(rp->world, e);
+        return true;
+    }
+    return alive == e;
+}
+
+static
+void flecs_rp_assign(
+    const ecs_type_info_t *ti,
+    void *dst,
+    const void *src,
+    bool construct)
+{
+    ecs_copy_t copy = construct ? ti->hooks.copy_ctor : ti->hooks.copy;
+    if (copy) {
+        copy(dst, src, 1, ti);
+    } else {
+        ecs_os_memcpy(dst, src, ti->size);
+    }
+}
+
+static
+int flecs_rp_cmd(
+    ecs_replayer_t *rp)
+{
+    ecs_world_t *world = rp->world;
+    uint8_t tag, kind;
+    uint64_t e;
+    ecs_id_t id;
+
+    if (!flecs_rp_u8(rp, &tag)) {
+        return -1;
+    }
+    if (tag != FLECS_RECORD_CMD) {
+        ecs_err("replay: expected command record");
+        return -1;
+    }
+
+    if (!flecs_rp_u8(rp, &kind) || !flecs_rp_u64(rp, &e) ||
+        !flecs_rp_id(rp, &id))
+    {
+        return -1;
+    }
+
+    /* Read command data before checking if command can be applied, so that
+     * the replayer always advances to the next command. */
+    bool valid = !e || flecs_rp_entity(rp, e);
+
+    switch(kind) {
+    case EcsCmdAdd:
+        if (valid && id) {
+            ecs_add_id(world, e, id);
+        }
+        break;
+    case EcsCmdRemove:
+        if (valid && id) {
+            ecs_remove_id(world, e, id);
+        }
+        break;
+    case EcsCmdSet:
+    case EcsCmdEmplace:
+    case EcsCmdEnsure: {
+        const void *value;
+        void *tmp;
+        if (!flecs_rp_value(rp, id, &value, &tmp)) {
+            return -1;
+        }
+        if (valid && id) {
+            const ecs_type_info_t *ti = ecs_get_type_info(world, id);
+            if (!value || !ti) {
+                ecs_add_id(world, e, id);
+            } else if (kind == EcsCmdSet) {
+                ecs_set_id(world, e, id, flecs_itosize(ti->size), value);
+            } else if (kind == EcsCmdEnsure) {
+                flecs_rp_assign(ti, ecs_ensure_id(world, e, id), value, false);
+            } else {
+                flecs_rp_assign(ti, ecs_emplace_id(world, e, id), value, true);
+            }
+        }
+        flecs_rp_value_free(rp, id, tmp);
+        break;
+    }
+    case EcsCmdModified:
+    case EcsCmdModifiedNoHook:
+        if (valid && id && ecs_has_id(world, e, id)) {
+            ecs_modified_id(world, e, id);
+        }
+        break;
+    case EcsCmdClone: {
+        uint8_t clone_value;
+        if (!flecs_rp_u8(rp, &clone_value)) {
+            return -1;
+        }
+        if (valid && id && ecs_is_alive(world, id)) {
+            ecs_clone(world, e, id, clone_value != 0);
+        }
+        break;
+    }
+    case EcsCmdPath: {
+        char *name = flecs_rp_str(rp);
+        if (!name) {
+            return -1;
+        }
+        if (valid) {
+            if (id) {
+                ecs_add_pair(world, e, EcsChildOf, id);
+            }
+            ecs_set_name(world, e, name);
+        }
+        ecs_os_free(name);
+        break;
+    }
+    case EcsCmdBulkNew: {
+        int32_t i, count;
+        if (!flecs_rp_i32(rp, &count)) {
+            return -1;
+        }
+        for (i = 0; i < count; i ++) {
+            uint64_t entity;
+            if (!flecs_rp_u64(rp, &entity)) {
+                return -1;
+            }
+            if (flecs_rp_entity(rp, entity) && id) {
+                ecs_add_id(world, entity, id);
+            }
+        }
+        break;
+    }
+    case EcsCmdDelete:
+        if (valid) {
+            ecs_delete(world, e);
+        }
+        break;
+    case EcsCmdClear:
+        if (valid) {
+            ecs_clear(world, e);
+        }
+        break;
+    case EcsCmdEnable:
+    case EcsCmdDisable:
+        if (valid && id) {
+            ecs_enable_id(world, e, id, kind == EcsCmdEnable);
+        }
+        break;
+    case EcsCmdEvent: {
+        ecs_id_t event;
+        int32_t i, count;
+        if (!flecs_rp_id(rp, &event) || !flecs_rp_i32(rp, &count)) {
+            return -1;
+        }
+        if (count < 0) {
+            ecs_err("replay: invalid id count for event");
+            return -1;
+        }
+
+        ecs_vec_t ids;
+        ecs_vec_init_t(NULL, &ids, ecs_id_t, count);
+        bool ids_valid = true;
+        for (i = 0; i < count; i ++) {
+            ecs_id_t *ptr = ecs_vec_append_t(NULL, &ids, ecs_id_t);
+            if (!flecs_rp_id(rp, ptr)) {
+                ecs_vec_fini_t(NULL, &ids, ecs_id_t);
+                return -1;
+            }
+            ids_valid &= ptr[0] != 0;
+        }
+
+        const void *param;
+        void *tmp;
+        if (!flecs_rp_value(rp, event, &param, &tmp)) {
+            ecs_vec_fini_t(NULL, &ids, ecs_id_t);
+            return -1;
+        }
+
+        if (valid && event && ids_valid) {
+            ecs_enqueue(world, &(ecs_event_desc_t) {
+                .event = event,
+                .ids = &(ecs_type_t){
+                    .array = ecs_vec_first(&ids), .count = count },
+                .entity = e,
+                .const_param = param
+            });
+        }
+
+        flecs_rp_value_free(rp, event, tmp);
+        ecs_vec_fini_t(NULL, &ids, ecs_id_t);
+        break;
+    }
+    case EcsCmdAddModified:
+    case EcsCmdOnDeleteAction:
+    case EcsCmdSkip:
+    default:
+        ecs_err("replay: invalid command kind %u", kind);
+        return -1;
+    }
+
+    return 0;
+}
+
+static
+int flecs_rp_sync(
+    ecs_replayer_t *rp,
+    int32_t count)
+{
+    ecs_world_t *world = rp->world;
+    int result = 0;
+    int32_t i;
+
+    ecs_defer_begin(world);
+    for (i = 0; i < count; i ++) {
+        if ((result = flecs_rp_cmd(rp))) {
+            break;
+        }
+    }
+    ecs_defer_end(world);
+
+    return result;
+}
+
+ecs_replayer_t* ecs_replayer_new(
+    ecs_world_t *world,
+    const void *data,
+    ecs_size_t size)
+{
+    ecs_poly_assert(world, ecs_world_t);
+    ecs_check(data != NULL, ECS_INVALID_PARAMETER, NULL);
+    ecs_check(size >= 0, ECS_INVALID_PARAMETER, NULL);
+
+    int32_t version;
+    if ((size < (4 + ECS_SIZEOF(int32_t))) ||
+        ecs_os_memcmp(data, FLECS_RECORDER_MAGIC, 4))
+    {
+        ecs_err("replay: data is not a recording");
+        goto error;
+    }
+
+    ecs_os_memcpy(&version, ECS_OFFSET(data, 4), ECS_SIZEOF(int32_t));
+    if (version != FLECS_RECORDER_VERSION) {
+        ecs_err("replay: unsupported recording version %d", version);
+        goto error;
+    }
+
+    ecs_replayer_t *rp = ecs_os_calloc_t(ecs_replayer_t);
+    rp->world = world;
+    rp->data = ecs_os_memdup(data, size);
+    rp->size = size;
+    rp->pos = 4 + ECS_SIZEOF(int32_t);
+    ecs_vec_init_t(NULL, &rp->names, ecs_entity_t, 0);
+    return rp;
+error:
+    return NULL;
+}
+
+ecs_replayer_t* ecs_replayer_from_file(
+    ecs_world_t *world,
+    const char *filename)
+{
+    ecs_check(filename != NULL, ECS_INVALID_PARAMETER, NULL);
+
+    FILE *file;
+    ecs_os_fopen(&file, filename, "rb");
+    if (!file) {
+        ecs_err("%s (%s)", ecs_os_strerror(errno), filename);
+        goto error;
+    }
+
+    fseek(file, 0, SEEK_END);
+    long bytes = ftell(file);
+    fseek(file, 0, SEEK_SET);
+    if (bytes < 0) {
+        fclose(file);
+        goto error;
+    }
+
+    size_t size = (size_t)bytes;
+    void *data = ecs_os_malloc(flecs_uto(ecs_size_t, size) + 1);
+    if (fread(data, 1, size, file) != size) {
+        ecs_err("%s: failed to read recording", filename);
+        ecs_os_free(data);
+        fclose(file);
+        goto error;
+    }
+    fclose(file);
+
+    ecs_replayer_t *rp = ecs_replayer_new(
+        world, data, flecs_uto(ecs_size_t, size));
+    ecs_os_free(data);
+    return rp;
+error:
+    return NULL;
+}
+
+int ecs_replayer_next_frame(
+    ecs_replayer_t *rp)
+{
+    ecs_check(rp != NULL, ECS_INVALID_PARAMETER, NULL);
+
+    bool has_frame = false;
+    uint64_t frame = 0;
+
+    while (rp->pos < rp->size) {
+        uint8_t kind = flecs_uto(uint8_t, rp->data[rp->pos]);
+        if (kind == FLECS_RECORD_NAME) {
+            rp->pos ++;
+            if (flecs_rp_name(rp)) {
+                goto error;
+            }
+        } else if (kind == FLECS_RECORD_SYNC) {
+            ecs_size_t start = rp->pos ++;
+            uint64_t sync_frame;
+            int32_t count;
+            if (!flecs_rp_u64(rp, &sync_frame) || !flecs_rp_i32(rp, &count)) {
+                goto error;
+            }
+
+            if (has_frame && (sync_frame != frame)) {
+                /* Sync belongs to the next frame */
+                rp->pos = start;
+                break;
+            }
+
+            has_frame = true;
+            frame = sync_frame;
+
+            if (flecs_rp_sync(rp, count)) {
+                goto error;
+            }
+        } else {
+            ecs_err("replay: invalid record kind %u", kind);
+            goto error;
+        }
+    }
+
+    return has_frame;
+error:
+    return -1;
+}
+
+void ecs_replayer_free(
+    ecs_replayer_t *rp)
+{
+    ecs_check(rp != NULL, ECS_INVALID_PARAMETER, NULL);
+    ecs_vec_fini_t(NULL, &rp->names, ecs_entity_t);
+    ecs_os_free(rp->data);
+    ecs_os_free(rp);
+error:
+    return;
+}
+
+int ecs_replay(
+    ecs_world_t *world,
+    const void *data,
+    ecs_size_t size)
+{
+    ecs_replayer_t *rp = ecs_replayer_new(world, data, size);
+    if (!rp) {
+        return -1;
+    }
+
+    int result;
+    while ((result = ecs_replayer_next_frame(rp)) > 0) { }
+
+    ecs_replayer_free(rp);
+    return result;
+}
+
+#endif
+
 /**
  * @file addons/rest.c
  * @brief Rest addon.
@@ -35515,6 +40580,10 @@ void flecs_world_stats_to_json(
     ECS_COUNTER_APPEND(reply, stats, memory.stack_alloc_count, "Pages allocated by stack allocators");
     ECS_COUNTER_APPEND(reply, stats, memory.stack_free_count, "Pages freed by stack allocators");
     ECS_GAUGE_APPEND(reply, stats, memory.stack_outstanding_alloc_count, "Outstanding page allocations");
+    ECS_GAUGE_APPEND(reply, stats, memory.allocator_bytes_in_use, "Bytes in use by block allocators");
+    ECS_GAUGE_APPEND(reply, stats, memory.allocator_bytes_reserved, "Bytes reserved by block allocators");
+    ECS_GAUGE_APPEND(reply, stats, memory.allocator_chunk_count, "Chunks in use by block allocators");
+    ECS_GAUGE_APPEND(reply, stats, memory.allocator_block_count, "Blocks allocated by block allocators");
 
     ECS_COUNTER_APPEND(reply, stats, http.request_received_count, "Received requests");
     ECS_COUNTER_APPEND(reply, stats, http.request_invalid_count, "Received invalid requests");
@@ -35597,6 +40666,49 @@ void flecs_pipeline_stats_to_json(
     ecs_strbuf_list_pop(reply, "]");
 }
 
+static
+void flecs_allocator_stats_to_json(
+    ecs_strbuf_t *reply,
+    const ecs_allocator_stats_t *stats)
+{
+    ecs_strbuf_list_push(reply, "{", ",");
+    ecs_strbuf_list_appendlit(reply, "\"bytes_in_use\":");
+    ecs_strbuf_appendint(reply, stats->bytes_in_use);
+    ecs_strbuf_list_appendlit(reply, "\"bytes_reserved\":");
+    ecs_strbuf_appendint(reply, stats->bytes_reserved);
+    ecs_strbuf_list_appendlit(reply, "\"chunk_count\":");
+    ecs_strbuf_appendint(reply, stats->chunk_count);
+    ecs_strbuf_list_appendlit(reply, "\"block_count\":");
+    ecs_strbuf_appendint(reply, stats->block_count);
+
+    ecs_strbuf_list_appendlit(reply, "\"sizes\":");
+    ecs_strbuf_list_push(reply, "[", ",");
+    int32_t i, count = ecs_vec_count(&stats->sizes);
+    ecs_allocator_size_stats_t *sizes = ecs_vec_first(&stats->sizes);
+    for (i = 0; i < count; i ++) {
+        ecs_allocator_size_stats_t *elem = &sizes[i];
+        ecs_strbuf_list_next(reply);
+        ecs_strbuf_list_push(reply, "{", ",");
+        ecs_strbuf_list_appendlit(reply, "\"size\":");
+        ecs_strbuf_appendint(reply, elem->size);
+        ecs_strbuf_list_appendlit(reply, "\"allocator_count\":");
+        ecs_strbuf_appendint(reply, elem->allocator_count);
+        ecs_strbuf_list_appendlit(reply, "\"block_count\":");
+        ecs_strbuf_appendint(reply, elem->block_count);
+        ecs_strbuf_list_appendlit(reply, "\"chunk_count\":");
+        ecs_strbuf_appendint(reply, elem->chunk_count);
+        ecs_strbuf_list_appendlit(reply, "\"chunk_count_max\":");
+        ecs_strbuf_appendint(reply, elem->chunk_count_max);
+        ecs_strbuf_list_appendlit(reply, "\"bytes_in_use\":");
+        ecs_strbuf_appendint(reply, elem->bytes_in_use);
+        ecs_strbuf_list_appendlit(reply, "\"bytes_reserved\":");
+        ecs_strbuf_appendint(reply, elem->bytes_reserved);
+        ecs_strbuf_list_pop(reply, "}");
+    }
+    ecs_strbuf_list_pop(reply, "]");
+    ecs_strbuf_list_pop(reply, "}");
+}
+
 static
 bool flecs_rest_reply_stats(
     ecs_world_t *world,
@@ -35631,6 +40743,13 @@ bool flecs_rest_reply_stats(
         flecs_pipeline_stats_to_json(world, &reply->body, stats);
         return true;
 
+    } else if (!ecs_os_strcmp(category, "allocators")) {
+        ecs_allocator_stats_t stats = {0};
+        ecs_allocator_stats_get(world, &stats);
+        flecs_allocator_stats_to_json(&reply->body, &stats);
+        ecs_allocator_stats_fini(&stats);
+        return true;
+
     } else {
         flecs_reply_error(reply, "bad request (unsupported category)");
         reply->code = 400;
@@ -36298,8 +41417,10 @@ ecs_data_t* flecs_duplicate_data(
     result->entities = ecs_vec_copy_shrink_t(a, &main_data->entities, ecs_entity_t);
 
     /* Copy each column */
+    a = flecs_column_allocator(world);
     for (i = 0; i < column_count; i ++) {
         ecs_column_t *column = &result->columns[i];
+        column->reserved = 0;
         ecs_type_info_t *ti = column->ti;
         ecs_assert(ti != NULL, ECS_INTERNAL_ERROR, NULL);
         int32_t size = ti->size;
@@ -36754,7 +41875,9 @@ void ecs_system_activate(
     bool activate,
     const ecs_system_t *system_data);
 
-/* Internal function to run a system */
+/* Internal function to run a system. If balanced is true and the system runs on
+ * multiple workers, each worker gets a contiguous range of the matched entities
+ * instead of a part of each table (see ecs_balanced_worker_iter). */
 ecs_entity_t ecs_run_intern(
     ecs_world_t *world,
     ecs_stage_t *stage,
@@ -36765,6 +41888,7 @@ ecs_entity_t ecs_run_intern(
     ecs_ftime_t delta_time,
     int32_t offset,
     int32_t limit,
+    bool balanced,
     void *param);
 
 #endif
@@ -36794,10 +41918,55 @@ typedef struct ecs_pipeline_op_t {
     bool no_readonly;           /* Whether systems are staged or not */
 } ecs_pipeline_op_t;
 
+/** Range in dependency vector with systems that a system depends on. A system
+ * depends on an earlier system in the same operation if one of the systems 
+ * writes a component that the other system reads or writes. */
+typedef struct ecs_pipeline_deps_t {
+    int32_t offset;             /* Offset in deps vector */
+    int32_t count;              /* Number of systems system depends on */
+} ecs_pipeline_deps_t;
+
+/* Number of iterations a thread spins on a sync point before it blocks */
+#define FLECS_WORKER_SPIN_COUNT (4096)
+
+/* Number of jobs per thread a system is split up in with work stealing */
+#define FLECS_WORKER_JOBS_PER_THREAD (4)
+
+/* Minimum number of entities in a job */
+#define FLECS_WORKER_JOB_MIN_SIZE (64)
+
+/** Job that runs a system on a range of its matched entities. */
+typedef struct ecs_worker_job_t {
+    int32_t offset;             /* Offset in system results */
+    int32_t limit;              /* Number of entities to run (0 = remaining) */
+} ecs_worker_job_t;
+
+/** Job queue of a single thread for a single system. Jobs are claimed by 
+ * atomically incrementing the head, which allows idle threads to steal jobs 
+ * from the queue without taking a lock. */
+typedef struct ecs_worker_queue_t {
+    int32_t head;               /* Index of next job to claim */
+    int32_t last;               /* Index of last job in queue + 1 */
+} ecs_worker_queue_t;
+
+/** Jobs for a system in the current pipeline operation. */
+typedef struct ecs_worker_jobs_t {
+    ecs_entity_t system;        /* System entity */
+    ecs_system_t *sys;          /* System data */
+    int32_t job_count;          /* Total number of jobs for system */
+    int32_t jobs_done;          /* Number of jobs finished */
+    int32_t queues;             /* Offset of system queues in queue vector */
+    int32_t deps;               /* Offset of dependencies in job_deps vector */
+    int32_t dep_count;          /* Number of systems to wait for */
+    bool is_task;               /* Tasks run once on each thread */
+} ecs_worker_jobs_t;
+
 struct ecs_pipeline_state_t {
     ecs_query_t *query;         /* Pipeline query */
     ecs_vec_t ops;              /* Pipeline schedule */
     ecs_vec_t systems;          /* Vector with system ids */
+    ecs_vec_t system_deps;      /* vector<ecs_pipeline_deps_t>, per system */
+    ecs_vec_t deps;             /* vector<int32_t>, indices in systems vector */
 
     ecs_entity_t last_system;   /* Last system ran by pipeline */
     ecs_id_record_t *idr_inactive; /* Cached record for quick inactive test */
@@ -36811,6 +41980,12 @@ struct ecs_pipeline_state_t {
     int32_t cur_i;              /* Index in current result */
     int32_t ran_since_merge;    /* Index in current op */
     bool no_readonly;           /* Is pipeline in readonly mode */
+
+    /* Jobs for current op when work stealing is enabled */
+    ecs_vec_t jobs;             /* vector<ecs_worker_job_t> */
+    ecs_vec_t job_queues;       /* vector<ecs_worker_queue_t> */
+    ecs_vec_t job_systems;      /* vector<ecs_worker_jobs_t> */
+    ecs_vec_t job_deps;         /* vector<int32_t>, indices in job_systems */
 };
 
 typedef struct EcsPipeline {
@@ -36860,6 +42035,18 @@ void flecs_signal_workers(
 void flecs_wait_for_sync(
     ecs_world_t *world);
 
+void flecs_workers_prepare_jobs(
+    ecs_world_t *world,
+    ecs_pipeline_state_t *pq,
+    int32_t stage_count);
+
+int32_t flecs_workers_run_jobs(
+    ecs_world_t *world,
+    ecs_stage_t *stage,
+    int32_t stage_index,
+    int32_t stage_count,
+    ecs_ftime_t delta_time);
+
 #endif
 
 #endif
@@ -37093,6 +42280,136 @@ void flecs_stats_copy_last(
     }
 }
 
+static
+void flecs_allocator_stats_add_size(
+    ecs_allocator_stats_t *s,
+    const ecs_block_allocator_t *ba,
+    int64_t bytes_in_use,
+    int64_t bytes_reserved)
+{
+    int32_t i, count = ecs_vec_count(&s->sizes);
+    ecs_allocator_size_stats_t *sizes = ecs_vec_first(&s->sizes);
+    for (i = 0; i < count; i ++) {
+        if (sizes[i].size >= ba->data_size) {
+            break;
+        }
+    }
+
+    if (i == count || sizes[i].size != ba->data_size) {
+        ecs_vec_append_t(NULL, &s->sizes, ecs_allocator_size_stats_t);
+        sizes = ecs_vec_first(&s->sizes);
+        ecs_os_memmove_n(&sizes[i + 1], &sizes[i], 
+            ecs_allocator_size_stats_t, (count - i));
+        ecs_os_zeromem(&sizes[i]);
+        sizes[i].size = ba->data_size;
+    }
+
+    ecs_allocator_size_stats_t *elem = &sizes[i];
+    elem->allocator_count ++;
+    elem->block_count += ba->block_count;
+    elem->chunk_count += ba->alloc_count;
+    elem->chunk_count_max += ba->alloc_count_max;
+    elem->bytes_in_use += bytes_in_use;
+    elem->bytes_reserved += bytes_reserved;
+}
+
+static
+void flecs_allocator_stats_add_ba(
+    ecs_allocator_stats_t *s,
+    const ecs_block_allocator_t *ba,
+    bool sizes)
+{
+    int64_t bytes_in_use = (int64_t)ba->alloc_count * ba->data_size;
+#ifdef FLECS_USE_OS_ALLOC
+    int64_t bytes_reserved = bytes_in_use;
+#else
+    int64_t bytes_reserved = (int64_t)ba->block_count * ba->block_size;
+#endif
+
+    s->bytes_in_use += bytes_in_use;
+    s->bytes_reserved += bytes_reserved;
+    s->chunk_count += ba->alloc_count;
+    s->block_count += ba->block_count;
+
+    /* Don't report allocators that have never been used */
+    if (sizes && (ba->block_count || ba->alloc_count_max)) {
+        flecs_allocator_stats_add_size(s, ba, bytes_in_use, bytes_reserved);
+    }
+}
+
+static
+void flecs_allocator_stats_add_allocator(
+    ecs_allocator_stats_t *s,
+    const ecs_allocator_t *a,
+    bool sizes)
+{
+    ecs_sparse_t *a_sizes = ECS_CONST_CAST(ecs_sparse_t*, &a->sizes);
+    int32_t i, count = flecs_sparse_count(a_sizes);
+    for (i = 0; i < count; i ++) {
+        ecs_block_allocator_t *ba = flecs_sparse_get_dense_t(
+            a_sizes, ecs_block_allocator_t, i);
+        flecs_allocator_stats_add_ba(s, ba, sizes);
+    }
+    flecs_allocator_stats_add_ba(s, &a->chunks, sizes);
+}
+
+static
+void flecs_allocator_stats_collect(
+    const ecs_world_t *world,
+    ecs_allocator_stats_t *s,
+    bool sizes)
+{
+    const ecs_world_allocators_t *wa = &world->allocators;
+    flecs_allocator_stats_add_allocator(s, &world->allocator, sizes);
+    flecs_allocator_stats_add_allocator(s, &world->column_allocator, sizes);
+    flecs_allocator_stats_add_ba(s, &wa->query_table, sizes);
+    flecs_allocator_stats_add_ba(s, &wa->query_table_match, sizes);
+    flecs_allocator_stats_add_ba(s, &wa->graph_edge_lo, sizes);
+    flecs_allocator_stats_add_ba(s, &wa->graph_edge, sizes);
+    flecs_allocator_stats_add_ba(s, &wa->id_record, sizes);
+    flecs_allocator_stats_add_ba(s, &wa->id_record_chunk, sizes);
+    flecs_allocator_stats_add_ba(s, &wa->table_diff, sizes);
+    flecs_allocator_stats_add_ba(s, &wa->sparse_chunk, sizes);
+    flecs_allocator_stats_add_ba(s, &wa->hashmap, sizes);
+    flecs_allocator_stats_add_ba(s, 
+        &world->store.entity_index.page_allocator, sizes);
+    flecs_allocator_stats_add_ba(s, &world->stack_pages.ba, sizes);
+
+    int32_t i, count = world->stage_count;
+    for (i = 0; i < count; i ++) {
+        const ecs_stage_t *stage = &world->stages[i];
+        flecs_allocator_stats_add_allocator(s, &stage->allocator, sizes);
+        flecs_allocator_stats_add_ba(s, 
+            &stage->allocators.cmd_entry_chunk, sizes);
+    }
+}
+
+void ecs_allocator_stats_get(
+    const ecs_world_t *world,
+    ecs_allocator_stats_t *stats)
+{
+    ecs_check(world != NULL, ECS_INVALID_PARAMETER, NULL);
+    ecs_check(stats != NULL, ECS_INVALID_PARAMETER, NULL);
+
+    world = ecs_get_world(world);
+
+    stats->bytes_in_use = 0;
+    stats->bytes_reserved = 0;
+    stats->chunk_count = 0;
+    stats->block_count = 0;
+    ecs_vec_clear(&stats->sizes);
+
+    flecs_allocator_stats_collect(world, stats, true);
+error:
+    return;
+}
+
+void ecs_allocator_stats_fini(
+    ecs_allocator_stats_t *stats)
+{
+    ecs_vec_fini_t(NULL, &stats->sizes, ecs_allocator_size_stats_t);
+}
+
 void ecs_world_stats_get(
     const ecs_world_t *world,
     ecs_world_stats_t *s)
@@ -37177,6 +42494,13 @@ void ecs_world_stats_get(
     ECS_COUNTER_RECORD(&s->memory.stack_free_count, t, ecs_stack_allocator_free_count);
     ECS_GAUGE_RECORD(&s->memory.stack_outstanding_alloc_count, t, outstanding_allocs);
 
+    ecs_allocator_stats_t alloc_stats = {0};
+    flecs_allocator_stats_collect(world, &alloc_stats, false);
+    ECS_GAUGE_RECORD(&s->memory.allocator_bytes_in_use, t, alloc_stats.bytes_in_use);
+    ECS_GAUGE_RECORD(&s->memory.allocator_bytes_reserved, t, alloc_stats.bytes_reserved);
+    ECS_GAUGE_RECORD(&s->memory.allocator_chunk_count, t, alloc_stats.chunk_count);
+    ECS_GAUGE_RECORD(&s->memory.allocator_block_count, t, alloc_stats.block_count);
+
 #ifdef FLECS_HTTP
     ECS_COUNTER_RECORD(&s->http.request_received_count, t, ecs_http_request_received_count);
     ECS_COUNTER_RECORD(&s->http.request_invalid_count, t, ecs_http_request_invalid_count);
@@ -37681,6 +43005,11 @@ void ecs_world_stats_log(
     flecs_counter_print("batched entities", t, &s->commands.batched_entity_count);
     flecs_counter_print("batched commands", t, &s->commands.batched_count);
     ecs_trace("");
+    flecs_gauge_print("allocator bytes in use", t, &s->memory.allocator_bytes_in_use);
+    flecs_gauge_print("allocator bytes reserved", t, &s->memory.allocator_bytes_reserved);
+    flecs_gauge_print("allocator chunks in use", t, &s->memory.allocator_chunk_count);
+    flecs_gauge_print("allocator blocks", t, &s->memory.allocator_block_count);
+    ecs_trace("");
     
 error:
     return;
@@ -39013,9 +44342,10 @@ void FlecsUnitsImport(
 
 static
 ecs_size_t flecs_allocator_size(
+    const ecs_allocator_t *a,
     ecs_size_t size)
 {
-    return ECS_ALIGN(size, 16);
+    return ECS_ALIGN(size, a->align);
 }
 
 static
@@ -39028,6 +44358,14 @@ ecs_size_t flecs_allocator_size_hash(
 void flecs_allocator_init(
     ecs_allocator_t *a)
 {
+    flecs_allocator_init_aligned(a, 16);
+}
+
+void flecs_allocator_init_aligned(
+    ecs_allocator_t *a,
+    ecs_size_t align)
+{
+    a->align = align;
     flecs_ballocator_init_n(&a->chunks, ecs_block_allocator_t,
         FLECS_SPARSE_PAGE_SIZE);
     flecs_sparse_init_t(&a->sizes, NULL, &a->chunks, ecs_block_allocator_t);
@@ -39056,8 +44394,8 @@ ecs_block_allocator_t* flecs_allocator_get(
     }
 
     ecs_assert(a != NULL, ECS_INTERNAL_ERROR, NULL);
-    ecs_assert(size <= flecs_allocator_size(size), ECS_INTERNAL_ERROR, NULL);
-    size = flecs_allocator_size(size);
+    ecs_assert(size <= flecs_allocator_size(a, size), ECS_INTERNAL_ERROR, NULL);
+    size = flecs_allocator_size(a, size);
     ecs_size_t hash = flecs_allocator_size_hash(size);
     ecs_block_allocator_t *result = flecs_sparse_get_any_t(&a->sizes, 
         ecs_block_allocator_t, (uint32_t)hash);
@@ -39065,7 +44403,7 @@ ecs_block_allocator_t* flecs_allocator_get(
     if (!result) {
         result = flecs_sparse_ensure_fast_t(&a->sizes, 
             ecs_block_allocator_t, (uint32_t)hash);
-        flecs_ballocator_init(result, size);
+        flecs_ballocator_init_aligned(result, size, a->align);
     }
 
     ecs_assert(result->data_size == size, ECS_INTERNAL_ERROR, NULL);
@@ -39243,7 +44581,69 @@ error:
 int64_t ecs_block_allocator_alloc_count = 0;
 int64_t ecs_block_allocator_free_count = 0;
 
-#ifndef FLECS_USE_OS_ALLOC
+/* Default alignment of chunks returned by block allocator */
+#define FLECS_BALLOC_ALIGN (16)
+
+/* Round pointer up to alignment */
+static
+void* flecs_balign_ptr(
+    void *ptr,
+    ecs_size_t align)
+{
+    uintptr_t addr = (uintptr_t)ptr;
+    uintptr_t mask = (uintptr_t)align - 1;
+    return (void*)((addr + mask) & ~mask);
+}
+
+#ifdef FLECS_ALLOCATOR_STATS
+static
+void flecs_balloc_stats_alloc(
+    ecs_block_allocator_t *ba)
+{
+    if (++ ba->alloc_count > ba->alloc_count_max) {
+        ba->alloc_count_max = ba->alloc_count;
+    }
+}
+
+#define flecs_balloc_stats_free(ba) ((ba)->alloc_count --)
+#else
+#define flecs_balloc_stats_alloc(ba)
+#define flecs_balloc_stats_free(ba)
+#endif
+
+#ifdef FLECS_USE_OS_ALLOC
+
+/* The OS allocator is not guaranteed to return memory with alignments larger
+ * than the default alignment. Allocate more memory than necessary, and store
+ * the pointer returned by the OS in front of the aligned memory. */
+static
+void* flecs_balloc_os_aligned(
+    ecs_block_allocator_t *ba)
+{
+    void *ptr = ecs_os_malloc(
+        ba->data_size + ba->align + ECS_SIZEOF(void*));
+    void *result = flecs_balign_ptr(
+        ECS_OFFSET(ptr, ECS_SIZEOF(void*)), ba->align);
+    ((void**)result)[-1] = ptr;
+    return result;
+}
+
+#else
+
+#ifdef FLECS_SANITIZE
+/* In sanitized builds each chunk stores the chunk size in a header that is
+ * used to detect memory returned to the wrong allocator. For aligned block
+ * allocators the header is padded to the alignment. */
+static
+ecs_size_t flecs_ballocator_header(
+    const ecs_block_allocator_t *ba)
+{
+    if (ba->align > FLECS_BALLOC_ALIGN) {
+        return ba->align;
+    }
+    return ECS_SIZEOF(int64_t);
+}
+#endif
 
 static
 ecs_block_allocator_chunk_header_t* flecs_balloc_block(
@@ -39253,11 +44653,16 @@ ecs_block_allocator_chunk_header_t* flecs_balloc_block(
         return NULL;
     }
 
+    ecs_size_t align = allocator->align;
+    ecs_size_t padding = align > FLECS_BALLOC_ALIGN ? align : 0;
     ecs_block_allocator_block_t *block = 
         ecs_os_malloc(ECS_SIZEOF(ecs_block_allocator_block_t) +
-            allocator->block_size);
+            allocator->block_size + padding);
     ecs_block_allocator_chunk_header_t *first_chunk = ECS_OFFSET(block, 
         ECS_SIZEOF(ecs_block_allocator_block_t));
+    if (padding) {
+        first_chunk = flecs_balign_ptr(first_chunk, align);
+    }
 
     block->memory = first_chunk;
     if (!allocator->block_tail) {
@@ -39279,6 +44684,7 @@ ecs_block_allocator_chunk_header_t* flecs_balloc_block(
     }
 
     ecs_os_linc(&ecs_block_allocator_alloc_count);
+    allocator->block_count ++;
 
     chunk->next = NULL;
     return first_chunk;
@@ -39289,19 +44695,33 @@ ecs_block_allocator_chunk_header_t* flecs_balloc_block(
 void flecs_ballocator_init(
     ecs_block_allocator_t *ba,
     ecs_size_t size)
+{
+    flecs_ballocator_init_aligned(ba, size, FLECS_BALLOC_ALIGN);
+}
+
+void flecs_ballocator_init_aligned(
+    ecs_block_allocator_t *ba,
+    ecs_size_t size,
+    ecs_size_t align)
 {
     ecs_assert(ba != NULL, ECS_INTERNAL_ERROR, NULL);
     ecs_assert(size != 0, ECS_INTERNAL_ERROR, NULL);
+    ecs_assert(align >= FLECS_BALLOC_ALIGN, ECS_INVALID_PARAMETER, NULL);
+    ecs_assert(!(align & (align - 1)), ECS_INVALID_PARAMETER, NULL);
     ba->data_size = size;
-#ifdef FLECS_SANITIZE
-    size += ECS_SIZEOF(int64_t);
+    ba->align = align;
+#if defined(FLECS_SANITIZE) && !defined(FLECS_USE_OS_ALLOC)
+    size += flecs_ballocator_header(ba);
 #endif
-    ba->chunk_size = ECS_ALIGN(size, 16);
+    ba->chunk_size = ECS_ALIGN(size, align);
     ba->chunks_per_block = ECS_MAX(4096 / ba->chunk_size, 1);
     ba->block_size = ba->chunks_per_block * ba->chunk_size;
     ba->head = NULL;
     ba->block_head = NULL;
     ba->block_tail = NULL;
+    ba->block_count = 0;
+    ba->alloc_count = 0;
+    ba->alloc_count_max = 0;
 }
 
 ecs_block_allocator_t* flecs_ballocator_new(
@@ -39330,6 +44750,7 @@ void flecs_ballocator_fini(
         block = next;
     }
     ba->block_head = NULL;
+    ba->block_count = 0;
 }
 
 void flecs_ballocator_free(
@@ -39344,7 +44765,12 @@ void* flecs_balloc(
 {
     void *result;
 #ifdef FLECS_USE_OS_ALLOC
-    result = ecs_os_malloc(ba->data_size);
+    if (ba->align > FLECS_BALLOC_ALIGN) {
+        result = flecs_balloc_os_aligned(ba);
+    } else {
+        result = ecs_os_malloc(ba->data_size);
+    }
+    flecs_balloc_stats_alloc(ba);
 #else
 
     if (!ba) return NULL;
@@ -39355,12 +44781,12 @@ void* flecs_balloc(
 
     result = ba->head;
     ba->head = ba->head->next;
+    flecs_balloc_stats_alloc(ba);
 
 #ifdef FLECS_SANITIZE
-    ecs_assert(ba->alloc_count >= 0, ECS_INTERNAL_ERROR, "corrupted allocator");
-    ba->alloc_count ++;
+    ecs_assert(ba->alloc_count > 0, ECS_INTERNAL_ERROR, "corrupted allocator");
     *(int64_t*)result = ba->chunk_size;
-    result = ECS_OFFSET(result, ECS_SIZEOF(int64_t));
+    result = ECS_OFFSET(result, flecs_ballocator_header(ba));
 #endif
 #endif
 
@@ -39375,6 +44801,12 @@ void* flecs_bcalloc(
     ecs_block_allocator_t *ba) 
 {
 #ifdef FLECS_USE_OS_ALLOC
+    flecs_balloc_stats_alloc(ba);
+    if (ba->align > FLECS_BALLOC_ALIGN) {
+        void *result = flecs_balloc_os_aligned(ba);
+        ecs_os_memset(result, 0, ba->data_size);
+        return result;
+    }
     return ecs_os_calloc(ba->data_size);
 #else
     if (!ba) return NULL;
@@ -39389,7 +44821,12 @@ void flecs_bfree(
     void *memory) 
 {
 #ifdef FLECS_USE_OS_ALLOC
-    (void)ba;
+    if (memory && ba) {
+        flecs_balloc_stats_free(ba);
+        if (ba->align > FLECS_BALLOC_ALIGN) {
+            memory = ((void**)memory)[-1];
+        }
+    }
     ecs_os_free(memory);
     return;
 #else
@@ -39403,17 +44840,17 @@ void flecs_bfree(
     }
 
 #ifdef FLECS_SANITIZE
-    memory = ECS_OFFSET(memory, -ECS_SIZEOF(int64_t));
+    memory = ECS_OFFSET(memory, -flecs_ballocator_header(ba));
     if (*(int64_t*)memory != ba->chunk_size) {
         ecs_err("chunk %p returned to wrong allocator "
             "(chunk = %ub, allocator = %ub)",
                 memory, *(int64_t*)memory, ba->chunk_size);
         ecs_abort(ECS_INTERNAL_ERROR, NULL);
     }
-
-    ba->alloc_count --;
 #endif
 
+    flecs_balloc_stats_free(ba);
+
     ecs_block_allocator_chunk_header_t *chunk = memory;
     chunk->next = ba->head;
     ba->head = chunk;
@@ -39428,8 +44865,22 @@ void* flecs_brealloc(
 {
     void *result;
 #ifdef FLECS_USE_OS_ALLOC
-    (void)src;
-    result = ecs_os_realloc(memory, dst->data_size);
+    if ((dst && dst->align > FLECS_BALLOC_ALIGN) || 
+        (src && src->align > FLECS_BALLOC_ALIGN)) 
+    {
+        result = dst ? flecs_balloc(dst) : NULL;
+        if (result && src && memory) {
+            ecs_os_memcpy(result, memory, 
+                ECS_MIN(src->data_size, dst->data_size));
+        }
+        flecs_bfree(src, memory);
+    } else {
+        result = ecs_os_realloc(memory, dst->data_size);
+        flecs_balloc_stats_alloc(dst);
+        if (memory && src) {
+            flecs_balloc_stats_free(src);
+        }
+    }
 #else
     if (dst == src) {
         return memory;
@@ -39463,6 +44914,12 @@ void* flecs_bdup(
 {
 #ifdef FLECS_USE_OS_ALLOC
     if (memory && ba->chunk_size) {
+        if (ba->align > FLECS_BALLOC_ALIGN) {
+            void *result = flecs_balloc(ba);
+            ecs_os_memcpy(result, memory, ba->data_size);
+            return result;
+        }
+        flecs_balloc_stats_alloc(ba);
         return ecs_os_memdup(memory, ba->data_size);
     } else {
         return NULL;
@@ -39476,6 +44933,248 @@ void* flecs_bdup(
 #endif
 }
 
+/**
+ * @file datastructures/block_allocator_cache.c
+ * @brief Magazine caches for block allocators.
+ *
+ * Block allocators are not thread safe. To let multiple threads allocate
+ * chunks of the same size without going to the OS allocator, a block allocator
+ * can be wrapped in a depot, which hands out chunks in magazines (fixed size
+ * arrays of chunks). Each thread gets a cache that holds a loaded and a
+ * previous magazine, and only synchronizes with the depot when both magazines
+ * are exhausted (on alloc) or full (on free).
+ *
+ * Magazines are recycled by the depot, so once a workload has warmed up the
+ * caches no longer call into the OS allocator.
+ */
+
+
+static
+void flecs_balloc_depot_lock(
+    ecs_balloc_depot_t *depot)
+{
+    if (depot->lock) {
+        ecs_os_mutex_lock(depot->lock);
+    }
+}
+
+static
+void flecs_balloc_depot_unlock(
+    ecs_balloc_depot_t *depot)
+{
+    if (depot->lock) {
+        ecs_os_mutex_unlock(depot->lock);
+    }
+}
+
+static
+ecs_balloc_magazine_t* flecs_balloc_magazine_pop(
+    ecs_balloc_magazine_t **list,
+    int32_t *count)
+{
+    ecs_balloc_magazine_t *result = *list;
+    if (result) {
+        *list = result->next;
+        result->next = NULL;
+        (*count) --;
+    }
+    return result;
+}
+
+static
+void flecs_balloc_magazine_push(
+    ecs_balloc_magazine_t **list,
+    int32_t *count,
+    ecs_balloc_magazine_t *mag)
+{
+    mag->next = *list;
+    *list = mag;
+    (*count) ++;
+}
+
+/* Must be called while holding the depot lock */
+static
+ecs_balloc_magazine_t* flecs_balloc_depot_empty(
+    ecs_balloc_depot_t *depot)
+{
+    ecs_balloc_magazine_t *result = flecs_balloc_magazine_pop(
+        &depot->empty, &depot->empty_count);
+    if (!result) {
+        result = ecs_os_malloc_t(ecs_balloc_magazine_t);
+        result->next = NULL;
+        result->count = 0;
+    }
+    return result;
+}
+
+void flecs_balloc_depot_init(
+    ecs_balloc_depot_t *depot,
+    ecs_size_t size)
+{
+    ecs_os_zeromem(depot);
+    flecs_ballocator_init(&depot->ba, size);
+    if (ecs_os_has_threading()) {
+        depot->lock = ecs_os_mutex_new();
+    }
+}
+
+void flecs_balloc_depot_fini(
+    ecs_balloc_depot_t *depot)
+{
+    ecs_balloc_magazine_t *mag;
+    while ((mag = flecs_balloc_magazine_pop(
+        &depot->full, &depot->full_count)))
+    {
+        int32_t i;
+        for (i = 0; i < mag->count; i ++) {
+            flecs_bfree(&depot->ba, mag->chunks[i]);
+        }
+        ecs_os_free(mag);
+    }
+
+    while ((mag = flecs_balloc_magazine_pop(
+        &depot->empty, &depot->empty_count)))
+    {
+        ecs_assert(mag->count == 0, ECS_INTERNAL_ERROR, NULL);
+        ecs_os_free(mag);
+    }
+
+    flecs_ballocator_fini(&depot->ba);
+
+    if (depot->lock) {
+        ecs_os_mutex_free(depot->lock);
+        depot->lock = 0;
+    }
+}
+
+void flecs_balloc_cache_init(
+    ecs_balloc_cache_t *cache,
+    ecs_balloc_depot_t *depot)
+{
+    ecs_assert(depot != NULL, ECS_INVALID_PARAMETER, NULL);
+    cache->depot = depot;
+    cache->loaded = NULL;
+    cache->previous = NULL;
+}
+
+static
+void flecs_balloc_cache_return(
+    ecs_balloc_depot_t *depot,
+    ecs_balloc_magazine_t *mag)
+{
+    if (!mag) {
+        return;
+    }
+
+    if (mag->count == FLECS_BALLOC_MAGAZINE_SIZE) {
+        flecs_balloc_magazine_push(&depot->full, &depot->full_count, mag);
+    } else {
+        /* Partially filled magazines can't be handed out as full magazines, so
+         * give their chunks back to the block allocator. */
+        int32_t i;
+        for (i = 0; i < mag->count; i ++) {
+            flecs_bfree(&depot->ba, mag->chunks[i]);
+        }
+        mag->count = 0;
+        flecs_balloc_magazine_push(&depot->empty, &depot->empty_count, mag);
+    }
+}
+
+void flecs_balloc_cache_fini(
+    ecs_balloc_cache_t *cache)
+{
+    ecs_balloc_depot_t *depot = cache->depot;
+    if (!depot) {
+        return;
+    }
+
+    flecs_balloc_depot_lock(depot);
+    flecs_balloc_cache_return(depot, cache->loaded);
+    flecs_balloc_cache_return(depot, cache->previous);
+    flecs_balloc_depot_unlock(depot);
+
+    cache->loaded = NULL;
+    cache->previous = NULL;
+}
+
+void* flecs_balloc_cache_alloc(
+    ecs_balloc_cache_t *cache)
+{
+    ecs_balloc_magazine_t *loaded = cache->loaded;
+    if (loaded && loaded->count) {
+        return loaded->chunks[-- loaded->count];
+    }
+
+    ecs_balloc_magazine_t *previous = cache->previous;
+    if (previous && previous->count) {
+        cache->previous = loaded;
+        cache->loaded = previous;
+        return previous->chunks[-- previous->count];
+    }
+
+    /* Both magazines are empty, exchange with depot */
+    ecs_balloc_depot_t *depot = cache->depot;
+    flecs_balloc_depot_lock(depot);
+    ecs_balloc_magazine_t *full = flecs_balloc_magazine_pop(
+        &depot->full, &depot->full_count);
+    if (full) {
+        if (previous) {
+            flecs_balloc_magazine_push(
+                &depot->empty, &depot->empty_count, previous);
+        }
+        cache->previous = loaded;
+        cache->loaded = loaded = full;
+    } else {
+        /* Depot has no full magazines, refill from block allocator */
+        if (!loaded) {
+            cache->loaded = loaded = flecs_balloc_depot_empty(depot);
+        }
+        int32_t i;
+        for (i = 0; i < FLECS_BALLOC_MAGAZINE_SIZE; i ++) {
+            loaded->chunks[i] = flecs_balloc(&depot->ba);
+        }
+        loaded->count = FLECS_BALLOC_MAGAZINE_SIZE;
+    }
+    flecs_balloc_depot_unlock(depot);
+
+    return loaded->chunks[-- loaded->count];
+}
+
+void flecs_balloc_cache_free(
+    ecs_balloc_cache_t *cache,
+    void *memory)
+{
+    if (!memory) {
+        return;
+    }
+
+    ecs_balloc_magazine_t *loaded = cache->loaded;
+    if (loaded && loaded->count < FLECS_BALLOC_MAGAZINE_SIZE) {
+        loaded->chunks[loaded->count ++] = memory;
+        return;
+    }
+
+    ecs_balloc_magazine_t *previous = cache->previous;
+    if (previous && previous->count < FLECS_BALLOC_MAGAZINE_SIZE) {
+        cache->previous = loaded;
+        cache->loaded = previous;
+        previous->chunks[previous->count ++] = memory;
+        return;
+    }
+
+    /* Both magazines are full, hand one to the depot for other threads */
+    ecs_balloc_depot_t *depot = cache->depot;
+    flecs_balloc_depot_lock(depot);
+    if (previous) {
+        flecs_balloc_magazine_push(&depot->full, &depot->full_count, previous);
+    }
+    cache->previous = loaded;
+    cache->loaded = loaded = flecs_balloc_depot_empty(depot);
+    flecs_balloc_depot_unlock(depot);
+
+    loaded->chunks[loaded->count ++] = memory;
+}
+
 // This is free and unencumbered software released into the public domain under The Unlicense (http://unlicense.org/)
 // main repo: https://github.com/wangyi-fudan/wyhash
 // author: 王一 Wang Yi
@@ -40658,7 +46357,8 @@ ecs_page_t* flecs_sparse_page_new(
                      : ecs_os_calloc(sparse->size * FLECS_SPARSE_PAGE_SIZE);
 
     ecs_assert(result->sparse != NULL, ECS_INTERNAL_ERROR, NULL);
-    ecs_assert(result->data != NULL, ECS_INTERNAL_ERROR, NULL);
+    ecs_assert(!sparse->size || result->data != NULL, 
+        ECS_INTERNAL_ERROR, NULL);
 
     return result;
 }
@@ -41089,6 +46789,38 @@ void flecs_sparse_remove(
     }
 }
 
+void flecs_sparse_remove_fast(
+    ecs_sparse_t *sparse,
+    ecs_size_t size,
+    uint64_t index)
+{
+    ecs_assert(sparse != NULL, ECS_INVALID_PARAMETER, NULL);
+    ecs_assert(!size || size == sparse->size, ECS_INVALID_PARAMETER, NULL);
+    (void)size;
+
+    flecs_sparse_strip_generation(&index);
+    ecs_page_t *page = flecs_sparse_get_page(sparse, PAGE(index));
+    if (!page || !page->sparse) {
+        return;
+    }
+
+    int32_t offset = OFFSET(index);
+    int32_t dense = page->sparse[offset];
+    int32_t count = sparse->count;
+    if (!dense || (dense >= count)) {
+        /* Element is not alive, nothing to be done */
+        return;
+    }
+
+    /* Unlike flecs_sparse_remove, don't increase the generation so the index
+     * can be added again with the same id. */
+    if (dense != (count - 1)) {
+        flecs_sparse_swap_dense(sparse, page, dense, count - 1);
+    }
+
+    sparse->count --;
+}
+
 void* flecs_sparse_get_dense(
     const ecs_sparse_t *sparse,
     ecs_size_t size,
@@ -41105,6 +46837,21 @@ void* flecs_sparse_get_dense(
     return flecs_sparse_get_sparse(sparse, dense_index, dense_array[dense_index]);
 }
 
+bool flecs_sparse_has(
+    const ecs_sparse_t *sparse,
+    uint64_t index)
+{
+    ecs_assert(sparse != NULL, ECS_INVALID_PARAMETER, NULL);
+    flecs_sparse_strip_generation(&index);
+    ecs_page_t *page = flecs_sparse_get_page(sparse, PAGE(index));
+    if (!page || !page->sparse) {
+        return false;
+    }
+
+    int32_t dense = page->sparse[OFFSET(index)];
+    return dense && (dense < sparse->count);
+}
+
 bool flecs_sparse_is_alive(
     const ecs_sparse_t *sparse,
     uint64_t index)
@@ -41289,15 +47036,38 @@ void* ecs_sparse_get(
  */
 
 
-#define FLECS_STACK_PAGE_OFFSET ECS_ALIGN(ECS_SIZEOF(ecs_stack_page_t), 16)
-
 int64_t ecs_stack_allocator_alloc_count = 0;
 int64_t ecs_stack_allocator_free_count = 0;
 
 static
-ecs_stack_page_t* flecs_stack_page_new(uint32_t page_id) {
-    ecs_stack_page_t *result = ecs_os_malloc(
-        FLECS_STACK_PAGE_OFFSET + ECS_STACK_PAGE_SIZE);
+void* flecs_stack_page_alloc(
+    ecs_stack_t *stack)
+{
+    if (stack->cache) {
+        return flecs_balloc_cache_alloc(stack->cache);
+    } else {
+        return ecs_os_malloc(FLECS_STACK_PAGE_ALLOC_SIZE);
+    }
+}
+
+static
+void flecs_stack_page_free(
+    ecs_stack_t *stack,
+    void *page)
+{
+    if (stack->cache) {
+        flecs_balloc_cache_free(stack->cache, page);
+    } else {
+        ecs_os_free(page);
+    }
+}
+
+static
+ecs_stack_page_t* flecs_stack_page_new(
+    ecs_stack_t *stack,
+    uint32_t page_id)
+{
+    ecs_stack_page_t *result = flecs_stack_page_alloc(stack);
     result->data = ECS_OFFSET(result, FLECS_STACK_PAGE_OFFSET);
     result->next = NULL;
     result->id = page_id + 1;
@@ -41312,7 +47082,7 @@ void* flecs_stack_alloc(
 {
     ecs_stack_page_t *page = stack->tail_page;
     if (page == &stack->first && !page->data) {
-        page->data = ecs_os_malloc(ECS_STACK_PAGE_SIZE);
+        page->data = flecs_stack_page_alloc(stack);
         ecs_os_linc(&ecs_stack_allocator_alloc_count);
     }
 
@@ -41329,7 +47099,7 @@ void* flecs_stack_alloc(
         if (page->next) {
             page = page->next;
         } else {
-            page = page->next = flecs_stack_page_new(page->id);
+            page = page->next = flecs_stack_page_new(stack, page->id);
         }
         sp = 0;
         next_sp = flecs_ito(int16_t, size);
@@ -41439,10 +47209,18 @@ void flecs_stack_reset(
 
 void flecs_stack_init(
     ecs_stack_t *stack)
+{
+    flecs_stack_init_w_cache(stack, NULL);
+}
+
+void flecs_stack_init_w_cache(
+    ecs_stack_t *stack,
+    ecs_balloc_cache_t *cache)
 {
     ecs_os_zeromem(stack);
     stack->tail_page = &stack->first;
     stack->first.data = NULL;
+    stack->cache = cache;
 }
 
 void flecs_stack_fini(
@@ -41458,11 +47236,11 @@ void flecs_stack_fini(
         if (cur == &stack->first) {
             if (cur->data) {
                 ecs_os_linc(&ecs_stack_allocator_free_count);
+                flecs_stack_page_free(stack, cur->data);
             }
-            ecs_os_free(cur->data);
         } else {
             ecs_os_linc(&ecs_stack_allocator_free_count);
-            ecs_os_free(cur);
+            flecs_stack_page_free(stack, cur);
         }
     } while ((cur = next));
 }
@@ -43511,6 +49289,39 @@ void flecs_id_record_assert_empty(
         ECS_INTERNAL_ERROR, NULL);
 }
 
+static
+void flecs_id_record_sparse_fini(
+    ecs_world_t *world,
+    ecs_id_record_t *idr)
+{
+    ecs_sparse_t *sparse = idr->sparse;
+    if (sparse) {
+        const ecs_type_info_t *ti = idr->type_info;
+        ecs_xtor_t dtor = ti ? ti->hooks.dtor : NULL;
+        if (dtor) {
+            int32_t i, count = flecs_sparse_count(sparse);
+            for (i = 0; i < count; i ++) {
+                void *ptr = flecs_sparse_get_dense(sparse, 0, i);
+                dtor(ptr, 1, ti);
+            }
+        }
+
+        flecs_sparse_fini(sparse);
+        ecs_os_free(sparse);
+        idr->sparse = NULL;
+    }
+
+    ecs_vec_t *ids = &world->sparse_ids;
+    int32_t i, count = ecs_vec_count(ids);
+    ecs_id_record_t **arr = ecs_vec_first_t(ids, ecs_id_record_t*);
+    for (i = 0; i < count; i ++) {
+        if (arr[i] == idr) {
+            ecs_vec_remove_t(ids, ecs_id_record_t*, i);
+            break;
+        }
+    }
+}
+
 static
 void flecs_id_record_free(
     ecs_world_t *world,
@@ -43533,6 +49344,10 @@ void flecs_id_record_free(
             if (ECS_PAIR_FIRST(id) != EcsFlag) {
                 /* If id is not a wildcard, remove it from the wildcard lists */
                 flecs_remove_id_elem(idr, ecs_pair(rel, EcsWildcard));
+                if (idr->parent) {
+                    /* Traversal indices could contain this record */
+                    idr->parent->trav_generation ++;
+                }
                 flecs_remove_id_elem(idr, ecs_pair(EcsWildcard, tgt));
             }
         } else {
@@ -43570,10 +49385,19 @@ void flecs_id_record_free(
     world->info.component_id_count -= idr->type_info != NULL;
     world->info.tag_id_count -= idr->type_info == NULL;
 
+    if (idr->flags & EcsIdSparse) {
+        flecs_id_record_sparse_fini(world, idr);
+    }
+
     /* Unregister the id record from the world & free resources */
     ecs_table_cache_fini(&idr->cache);
     flecs_name_index_free(idr->name_index);
     ecs_vec_fini_t(&world->allocator, &idr->reachable.ids, ecs_reachable_elem_t);
+    if (idr->trav_index) {
+        ecs_vec_fini_t(&world->allocator, &idr->trav_index->idrs, 
+            ecs_id_record_t*);
+        flecs_free_t(&world->allocator, ecs_trav_index_t, idr->trav_index);
+    }
 
     ecs_id_t hash = flecs_id_record_hash(id);
     if (hash >= FLECS_HI_ID_RECORD_ID) {
@@ -43651,6 +49475,100 @@ ecs_id_record_t* flecs_query_id_record_get(
     return idr;
 }
 
+static
+void flecs_id_record_trav_index_build(
+    ecs_world_t *world,
+    ecs_vec_t *idrs,
+    ecs_entity_t trav,
+    ecs_id_record_t *idr)
+{
+    ecs_vec_append_t(&world->allocator, idrs, ecs_id_record_t*)[0] = idr;
+
+    ecs_table_cache_iter_t it;
+    if (flecs_table_cache_iter(&idr->cache, &it)) {
+        ecs_table_record_t *tr; 
+        while ((tr = flecs_table_cache_next(&it, ecs_table_record_t))) {
+            ecs_table_t *table = tr->hdr.table;
+            if (!table->_->traversable_count) {
+                continue;
+            }
+
+            int32_t i, count = ecs_table_count(table);
+            ecs_entity_t *entities = table->data.entities.array;
+            for (i = 0; i < count; i ++) {
+                ecs_record_t *r = flecs_entities_get(world, entities[i]);
+                if (!(r->row & EcsEntityIsTraversable)) {
+                    continue;
+                }
+
+                ecs_id_record_t *idr_e = flecs_id_record_get(world, 
+                    ecs_pair(trav, entities[i]));
+                if (idr_e) {
+                    flecs_id_record_trav_index_build(world, idrs, trav, idr_e);
+                }
+            }
+        }
+    }
+}
+
+const ecs_vec_t* flecs_id_record_trav_index(
+    ecs_world_t *world,
+    ecs_id_record_t *idr)
+{
+    ecs_poly_assert(world, ecs_world_t);
+    ecs_assert(idr != NULL, ECS_INTERNAL_ERROR, NULL);
+    ecs_assert(ECS_IS_PAIR(idr->id), ECS_INTERNAL_ERROR, NULL);
+    ecs_assert(!ecs_id_is_wildcard(idr->id), ECS_INTERNAL_ERROR, NULL);
+
+    ecs_id_record_t *idr_r = idr->parent;
+    if (!idr_r || !(idr->flags & EcsIdTraversable)) {
+        return NULL;
+    }
+
+    ecs_trav_index_t *index = idr->trav_index;
+    if (index && index->generation == idr_r->trav_generation) {
+        return &index->idrs;
+    }
+
+    /* Index is out of date. Can't rebuild it while other threads could be
+     * reading from it. */
+    if (world->flags & EcsWorldMultiThreaded) {
+        return NULL;
+    }
+
+    if (!index) {
+        index = idr->trav_index = flecs_calloc_t(
+            &world->allocator, ecs_trav_index_t);
+    } else {
+        ecs_vec_clear(&index->idrs);
+    }
+
+    flecs_id_record_trav_index_build(
+        world, &index->idrs, ECS_PAIR_FIRST(idr->id), idr);
+    index->generation = idr_r->trav_generation;
+
+    return &index->idrs;
+}
+
+void flecs_id_record_trav_invalidate(
+    ecs_world_t *world,
+    const ecs_type_t *type)
+{
+    int32_t i, count = type->count;
+    ecs_id_t *ids = type->array;
+    for (i = 0; i < count; i ++) {
+        ecs_id_t id = ids[i];
+        if (!ECS_IS_PAIR(id)) {
+            continue;
+        }
+
+        ecs_id_record_t *idr = flecs_id_record_get(world, id);
+        if (idr && (idr->flags & EcsIdTraversable) && idr->parent) {
+            idr->parent->trav_generation ++;
+        }
+    }
+}
+
 void flecs_id_record_claim(
     ecs_world_t *world,
     ecs_id_record_t *idr)
@@ -43673,6 +49591,54 @@ int32_t flecs_id_record_release(
     return rc;
 }
 
+void* flecs_id_record_sparse_get(
+    const ecs_id_record_t *idr,
+    ecs_entity_t entity)
+{
+    ecs_assert(idr->flags & EcsIdSparse, ECS_INTERNAL_ERROR, NULL);
+    if (!idr->sparse) {
+        return NULL;
+    }
+    return flecs_sparse_get_any(idr->sparse, 0, (uint32_t)entity);
+}
+
+bool flecs_id_record_sparse_has(
+    const ecs_id_record_t *idr,
+    ecs_entity_t entity)
+{
+    ecs_assert(idr->flags & EcsIdSparse, ECS_INTERNAL_ERROR, NULL);
+    if (!idr->sparse) {
+        return false;
+    }
+    return flecs_sparse_has(idr->sparse, (uint32_t)entity);
+}
+
+void* flecs_id_record_sparse_insert(
+    ecs_world_t *world,
+    ecs_id_record_t *idr,
+    ecs_entity_t entity)
+{
+    ecs_assert(idr->flags & EcsIdSparse, ECS_INTERNAL_ERROR, NULL);
+    ecs_sparse_t *sparse = idr->sparse;
+    if (!sparse) {
+        const ecs_type_info_t *ti = idr->type_info;
+        sparse = idr->sparse = ecs_os_calloc_t(ecs_sparse_t);
+        flecs_sparse_init(sparse, &world->allocator, 
+            &world->allocators.sparse_chunk, ti ? ti->size : 0);
+    }
+    return flecs_sparse_ensure(sparse, 0, (uint32_t)entity);
+}
+
+void flecs_id_record_sparse_remove(
+    ecs_id_record_t *idr,
+    ecs_entity_t entity)
+{
+    ecs_assert(idr->flags & EcsIdSparse, ECS_INTERNAL_ERROR, NULL);
+    if (idr->sparse) {
+        flecs_sparse_remove_fast(idr->sparse, 0, (uint32_t)entity);
+    }
+}
+
 void flecs_id_record_release_tables(
     ecs_world_t *world,
     ecs_id_record_t *idr)
@@ -43815,6 +49781,7 @@ void flecs_fini_id_records(
 
     ecs_map_fini(&world->id_index_hi);
     ecs_os_free(world->id_index_lo);
+    ecs_vec_fini_t(&world->allocator, &world->sparse_ids, ecs_id_record_t*);
 }
 
 /**
@@ -43909,6 +49876,11 @@ void flecs_table_check_sanity(ecs_table_t *table) {
 
     ecs_assert((table->_->traversable_count == 0) || 
         (table->flags & EcsTableHasTraversable), ECS_INTERNAL_ERROR, NULL);
+
+    if (table->flags & EcsTableHasRowVersions) {
+        ecs_assert(ecs_vec_count(&table->_->row_versions) == count,
+            ECS_INTERNAL_ERROR, NULL);
+    }
 }
 #else
 #define flecs_table_check_sanity(table)
@@ -44109,6 +50081,61 @@ void flecs_table_init_flags(
     }
 }
 
+/* Number of bits in an id signature */
+#define FLECS_ID_SIGNATURE_BITS (FLECS_ID_SIGNATURE_WORDS * 64)
+
+void flecs_id_signature_add(
+    ecs_id_signature_t *sig,
+    ecs_id_t id)
+{
+    /* Fibonacci hash, set two bits from the upper (best mixed) bits */
+    uint64_t hash = id * 11400714819323198485ull;
+    uint32_t b1 = (uint32_t)(hash >> 40) % FLECS_ID_SIGNATURE_BITS;
+    uint32_t b2 = (uint32_t)(hash >> 52) % FLECS_ID_SIGNATURE_BITS;
+    sig->bits[b1 / 64] |= 1ull << (b1 % 64);
+    sig->bits[b2 / 64] |= 1ull << (b2 % 64);
+}
+
+bool flecs_id_signature_has(
+    const ecs_id_signature_t *sig,
+    const ecs_id_signature_t *ids)
+{
+    int32_t i;
+    for (i = 0; i < FLECS_ID_SIGNATURE_WORDS; i ++) {
+        if ((sig->bits[i] & ids->bits[i]) != ids->bits[i]) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/* Initialize signature with the ids of the table. Pairs also add their 
+ * wildcard projections, so that a table with (Eats, Apples) can be tested
+ * for (Eats, *) and (*, Apples). */
+static
+void flecs_table_init_signature(
+    ecs_table_t *table)
+{
+    ecs_id_signature_t *sig = &table->_->signature;
+    ecs_id_t *ids = table->type.array;
+    int32_t i, count = table->type.count;
+
+    for (i = 0; i < count; i ++) {
+        ecs_id_t id = ids[i];
+        flecs_id_signature_add(sig, id);
+
+        if (ECS_IS_PAIR(id)) {
+            ecs_entity_t first = ECS_PAIR_FIRST(id);
+            ecs_entity_t second = ECS_PAIR_SECOND(id);
+            flecs_id_signature_add(sig, ecs_pair(first, EcsWildcard));
+            flecs_id_signature_add(sig, ecs_pair(EcsWildcard, second));
+            if (first == EcsUnion) {
+                flecs_id_signature_add(sig, ecs_pair(second, EcsWildcard));
+            }
+        }
+    }
+}
+
 /* Utility function that appends an element to the table record array */
 static
 void flecs_table_append_to_records(
@@ -44144,6 +50171,7 @@ void flecs_table_init(
 {
     /* Make sure table->flags is initialized */
     flecs_table_init_flags(world, table);
+    flecs_table_init_signature(table);
 
     /* The following code walks the table type to discover which id records the
      * table needs to register table records with. 
@@ -44577,6 +50605,22 @@ void flecs_table_invoke_remove_hooks(
     }
 }
 
+/* Remove entity from entity index, and cleanup its sparse components */
+static
+void flecs_table_remove_entity(
+    ecs_world_t *world,
+    ecs_entity_t e)
+{
+    if (ecs_vec_count(&world->sparse_ids)) {
+        ecs_record_t *record = flecs_entities_get(world, e);
+        if (record && (record->row & EcsEntityHasSparse)) {
+            flecs_entity_remove_sparse(world, e);
+        }
+    }
+
+    flecs_entities_remove(world, e);
+}
+
 /* Destruct all components and/or delete all entities in table in range */
 static
 void flecs_table_dtor_all(
@@ -44633,14 +50677,14 @@ void flecs_table_dtor_all(
                     ECS_INTERNAL_ERROR, NULL);
 
                 if (is_delete) {
-                    flecs_entities_remove(world, e);
+                    flecs_table_remove_entity(world, e);
                     ecs_assert(ecs_is_valid(world, e) == false, 
                         ECS_INTERNAL_ERROR, NULL);
                 } else {
                     // If this is not a delete, clear the entity index record
                     ecs_record_t *record = flecs_entities_get(world, e);
                     record->table = NULL;
-                    record->row = 0;
+                    record->row &= EcsEntityHasSparse;
                 }
             } else {
                 /* This should only happen in rare cases, such as when the data
@@ -44656,7 +50700,7 @@ void flecs_table_dtor_all(
             for (i = row; i < end; i ++) {
                 ecs_entity_t e = entities[i];
                 ecs_assert(!e || ecs_is_valid(world, e), ECS_INTERNAL_ERROR, NULL);
-                flecs_entities_remove(world, e);
+                flecs_table_remove_entity(world, e);
                 ecs_assert(!ecs_is_valid(world, e), ECS_INTERNAL_ERROR, NULL);
             } 
         } else {
@@ -44672,6 +50716,130 @@ void flecs_table_dtor_all(
     }
 }
 
+/* Row versions store a copy of the table dirty state for each row. Element 0 is
+ * the value of dirty_state[0] when the row was added to the table, element 
+ * column + 1 is the value of dirty_state[column + 1] when the column was last 
+ * written for that row. A query that stores the table dirty state in its
+ * monitor can compare the two to find the rows that changed since the last
+ * time the query was iterated. Versions are only tracked for tables that are
+ * iterated by a changed rows iterator. */
+static
+ecs_size_t flecs_table_row_versions_size(
+    const ecs_table_t *table)
+{
+    return ECS_SIZEOF(int32_t) * (table->column_count + 1);
+}
+
+/* Large columns are stored in reserved virtual memory when the OS API provides
+ * virtual memory functions. Growing such a column commits more pages of the
+ * reservation, which doesn't copy or move existing elements. */
+static
+bool flecs_table_column_use_vmem(
+    const ecs_column_t *column,
+    int32_t elem_count)
+{
+    if (column->reserved) {
+        return true;
+    }
+
+    return (column->size * elem_count >= FLECS_VMEM_COLUMN_THRESHOLD) &&
+        ecs_os_has_vmem();
+}
+
+/* Resize column that is (or will be) stored in virtual memory */
+static
+void flecs_table_column_vmem_resize(
+    ecs_world_t *world,
+    ecs_column_t *column,
+    int32_t elem_count)
+{
+    ecs_size_t size = column->size;
+    ecs_size_t bytes = size * elem_count;
+    ecs_size_t cur_bytes = size * column->data.size;
+    ecs_size_t reserved = column->reserved;
+    void *ptr = column->data.array;
+
+    if (reserved && bytes <= reserved) {
+        if (bytes > cur_bytes) {
+            if (!ecs_os_vmem_commit(
+                ECS_OFFSET(ptr, cur_bytes), bytes - cur_bytes)) 
+            {
+                ecs_abort(ECS_OUT_OF_MEMORY, NULL);
+            }
+        } else if (bytes < cur_bytes) {
+            ecs_os_vmem_decommit(ECS_OFFSET(ptr, bytes), cur_bytes - bytes);
+        }
+        column->data.size = elem_count;
+        return;
+    }
+
+    /* Column doesn't fit in reservation, move elements to new reservation */
+    ecs_size_t reserve = FLECS_VMEM_COLUMN_RESERVE;
+    if (reserve < bytes) {
+        reserve = bytes > (INT32_MAX / 2) ? bytes : bytes * 2;
+    }
+
+    void *dst = ecs_os_vmem_reserve(reserve);
+    if (!dst || !ecs_os_vmem_commit(dst, bytes)) {
+        ecs_abort(ECS_OUT_OF_MEMORY, NULL);
+    }
+
+    int32_t count = column->data.count;
+    if (count) {
+        ecs_type_info_t *ti = column->ti;
+        ecs_move_t move = ti->hooks.ctor_move_dtor;
+        if (move) {
+            move(dst, ptr, count, ti);
+        } else {
+            ecs_os_memcpy(dst, ptr, size * count);
+        }
+    }
+
+    if (reserved) {
+        ecs_os_vmem_release(ptr, reserved);
+    } else {
+        ecs_vec_fini(flecs_column_allocator(world), &column->data, size);
+    }
+
+    column->data.array = dst;
+    column->data.count = count;
+    column->data.size = elem_count;
+    column->reserved = reserve;
+}
+
+/* Set capacity of column */
+static
+void flecs_table_column_set_size(
+    ecs_world_t *world,
+    ecs_column_t *column,
+    int32_t elem_count)
+{
+    if (flecs_table_column_use_vmem(column, elem_count)) {
+        flecs_table_column_vmem_resize(world, column, elem_count);
+    } else {
+        ecs_vec_set_size(flecs_column_allocator(world), 
+            &column->data, column->size, elem_count);
+    }
+}
+
+/* Free column storage */
+static
+void flecs_table_column_fini(
+    ecs_world_t *world,
+    ecs_column_t *column)
+{
+    if (column->reserved) {
+        ecs_os_vmem_release(column->data.array, column->reserved);
+        column->data.array = NULL;
+        column->data.count = 0;
+        column->data.size = 0;
+        column->reserved = 0;
+    } else {
+        ecs_vec_fini(flecs_column_allocator(world), 
+            &column->data, column->size);
+    }
+}
+
 /* Cleanup table storage */
 static
 void flecs_table_fini_data(
@@ -44706,8 +50874,7 @@ void flecs_table_fini_data(
             /* Sanity check */
             ecs_assert(columns[c].data.count == data->entities.count,
                 ECS_INTERNAL_ERROR, NULL);
-            ecs_vec_fini(&world->allocator,
-                &columns[c].data, columns[c].size);
+            flecs_table_column_fini(world, &columns[c]);
         }
         flecs_wfree_n(world, ecs_column_t, column_count, columns);
         data->columns = NULL;
@@ -44734,6 +50901,12 @@ void flecs_table_fini_data(
         meta->bs_columns = NULL;
     }
 
+    if (data == &table->data) {
+        ecs_vec_fini(&world->allocator, &meta->row_versions,
+            flecs_table_row_versions_size(table));
+        table->flags &= ~EcsTableHasRowVersions;
+    }
+
     ecs_vec_fini_t(&world->allocator, &data->entities, ecs_entity_t);
 
     if (deactivate && count) {
@@ -44921,6 +51094,7 @@ void flecs_table_mark_table_dirty(
 void flecs_table_mark_dirty(
     ecs_world_t *world,
     ecs_table_t *table,
+    int32_t row,
     ecs_entity_t component)
 {
     ecs_assert(!table->_->lock, ECS_LOCKED_STORAGE, NULL);
@@ -44937,7 +51111,12 @@ void flecs_table_mark_dirty(
             return;
         }
 
-        table->dirty_state[tr->column + 1] ++;
+        int32_t value = ++ table->dirty_state[tr->column + 1];
+        if ((table->flags & EcsTableHasRowVersions) && 
+            (row < ecs_table_count(table))) 
+        {
+            flecs_table_stamp_rows(table, tr->column + 1, row, 1, value);
+        }
     }
 }
 
@@ -44960,6 +51139,100 @@ int32_t* flecs_table_get_dirty_state(
     return table->dirty_state;
 }
 
+/* Add row versions for rows appended to the table */
+static
+void flecs_table_row_versions_addn(
+    ecs_world_t *world,
+    ecs_table_t *table,
+    int32_t count)
+{
+    if (!(table->flags & EcsTableHasRowVersions) || !count) {
+        return;
+    }
+
+    ecs_size_t size = flecs_table_row_versions_size(table);
+    int32_t *rv = ecs_vec_grow(&world->allocator, 
+        &table->_->row_versions, size, count);
+    ecs_os_memset(rv, 0, size * count);
+
+    int32_t i, added = table->dirty_state[0];
+    int32_t stride = table->column_count + 1;
+    for (i = 0; i < count; i ++) {
+        rv[i * stride] = added;
+    }
+}
+
+/* Remove row version, move last row into removed row */
+static
+void flecs_table_row_versions_remove(
+    ecs_table_t *table,
+    int32_t row)
+{
+    if (table->flags & EcsTableHasRowVersions) {
+        ecs_vec_remove(&table->_->row_versions, 
+            flecs_table_row_versions_size(table), row);
+    }
+}
+
+void flecs_table_init_row_versions(
+    ecs_world_t *world,
+    ecs_table_t *table)
+{
+    ecs_assert(!table->_->lock, ECS_LOCKED_STORAGE, NULL);
+    if (table->flags & EcsTableHasRowVersions) {
+        return;
+    }
+
+    /* Existing rows get the current table state, as there is no way to tell
+     * when they were last changed. */
+    int32_t *dirty_state = flecs_table_get_dirty_state(world, table);
+    int32_t i, count = ecs_table_count(table);
+    int32_t stride = table->column_count + 1;
+    ecs_size_t size = flecs_table_row_versions_size(table);
+    ecs_vec_init(&world->allocator, &table->_->row_versions, size, count);
+    ecs_vec_set_count(&world->allocator, 
+        &table->_->row_versions, size, count);
+    int32_t *rv = ecs_vec_first(&table->_->row_versions);
+    for (i = 0; i < count; i ++) {
+        ecs_os_memcpy_n(&rv[i * stride], dirty_state, int32_t, stride);
+    }
+
+    table->flags |= EcsTableHasRowVersions;
+    flecs_table_check_sanity(table);
+}
+
+int32_t* flecs_table_row_versions(
+    const ecs_table_t *table,
+    int32_t row)
+{
+    if (!(table->flags & EcsTableHasRowVersions)) {
+        return NULL;
+    }
+    return ecs_vec_get(&table->_->row_versions, 
+        flecs_table_row_versions_size(table), row);
+}
+
+void flecs_table_stamp_rows(
+    ecs_table_t *table,
+    int32_t column,
+    int32_t offset,
+    int32_t count,
+    int32_t value)
+{
+    ecs_assert(table->flags & EcsTableHasRowVersions, 
+        ECS_INTERNAL_ERROR, NULL);
+    ecs_assert(column >= 0 && column <= table->column_count, 
+        ECS_INTERNAL_ERROR, NULL);
+    ecs_assert((offset + count) <= ecs_table_count(table), 
+        ECS_INTERNAL_ERROR, NULL);
+
+    int32_t i, stride = table->column_count + 1;
+    int32_t *rv = ecs_vec_first(&table->_->row_versions);
+    for (i = offset; i < (offset + count); i ++) {
+        rv[i * stride + column] = value;
+    }
+}
+
 /* Table move logic for switch (union relationship) column */
 static
 void flecs_table_move_switch_columns(
@@ -45123,6 +51396,7 @@ void flecs_table_grow_column(
 {
     ecs_assert(column != NULL, ECS_INTERNAL_ERROR, NULL);
 
+    ecs_allocator_t *a = flecs_column_allocator(world);
     ecs_type_info_t *ti = column->ti;
     int32_t size = column->size;
     int32_t count = column->data.count;
@@ -45133,6 +51407,12 @@ void flecs_table_grow_column(
 
     ecs_assert(dst_size >= dst_count, ECS_INTERNAL_ERROR, NULL);
 
+    /* Growing a column in virtual memory doesn't move existing elements */
+    if (can_realloc && flecs_table_column_use_vmem(column, dst_size)) {
+        flecs_table_column_vmem_resize(world, column, dst_size);
+        can_realloc = false;
+    }
+
     /* If the array could possibly realloc and the component has a move action 
      * defined, move old elements manually */
     ecs_move_t move_ctor;
@@ -45143,7 +51423,7 @@ void flecs_table_grow_column(
 
         /* Create  vector */
         ecs_vec_t dst;
-        ecs_vec_init(&world->allocator, &dst, size, dst_size);
+        ecs_vec_init(a, &dst, size, dst_size);
         dst.count = dst_count;
 
         void *src_buffer = column->data.array;
@@ -45159,22 +51439,24 @@ void flecs_table_grow_column(
         }
 
         /* Free old vector */
-        ecs_vec_fini(&world->allocator, &column->data, size);
+        ecs_vec_fini(a, &column->data, size);
 
         column->data = dst;
     } else {
         /* If array won't realloc or has no move, simply add new elements */
         if (can_realloc) {
-            ecs_vec_set_size(&world->allocator, &column->data, size, dst_size);
+            ecs_vec_set_size(a, &column->data, size, dst_size);
         }
 
-        result = ecs_vec_grow(&world->allocator, &column->data, size, to_add);
+        if (to_add) {
+            result = ecs_vec_grow(a, &column->data, size, to_add);
 
-        ecs_xtor_t ctor;
-        if (construct && (ctor = ti->hooks.ctor)) {
-            /* If new elements need to be constructed and component has a
-             * constructor, construct */
-            ctor(result, to_add, ti);
+            ecs_xtor_t ctor;
+            if (construct && (ctor = ti->hooks.ctor)) {
+                /* If new elements need to be constructed and component has a
+                 * constructor, construct */
+                ctor(result, to_add, ti);
+            }
         }
     }
 
@@ -45218,8 +51500,10 @@ int32_t flecs_table_grow_data(
     for (i = 0; i < column_count; i ++) {
         flecs_table_grow_column(world, &columns[i], to_add, size, true);
         ecs_assert(columns[i].data.size == size, ECS_INTERNAL_ERROR, NULL);
-        flecs_table_invoke_add_hooks(world, table, &columns[i], e, 
-            cur_count, to_add, false);
+        if (to_add) {
+            flecs_table_invoke_add_hooks(world, table, &columns[i], e, 
+                cur_count, to_add, false);
+        }
     }
 
     ecs_table__t *meta = table->_;
@@ -45242,6 +51526,9 @@ int32_t flecs_table_grow_data(
 
     /* If the table is monitored indicate that there has been a change */
     flecs_table_mark_table_dirty(world, table, 0);
+    if (data == &table->data) {
+        flecs_table_row_versions_addn(world, table, to_add);
+    }
 
     if (!(world->flags & EcsWorldReadonly) && !cur_count) {
         flecs_table_set_empty(world, table);
@@ -45256,13 +51543,20 @@ static
 void flecs_table_fast_append(
     ecs_world_t *world,
     ecs_column_t *columns,
-    int32_t count)
+    int32_t count,
+    int32_t size)
 {
     /* Add elements to each column array */
     int32_t i;
     for (i = 0; i < count; i ++) {
         ecs_column_t *column = &columns[i];
-        ecs_vec_append(&world->allocator, &column->data, column->size);
+        if ((column->data.count == column->data.size) && 
+            flecs_table_column_use_vmem(column, size)) 
+        {
+            flecs_table_column_vmem_resize(world, column, size);
+        }
+        ecs_vec_append(flecs_column_allocator(world), 
+            &column->data, column->size);
     }
 }
 
@@ -45300,7 +51594,8 @@ int32_t flecs_table_append(
 
     /* Fast path: no switch columns, no lifecycle actions */
     if (!(table->flags & EcsTableIsComplex)) {
-        flecs_table_fast_append(world, columns, column_count);
+        flecs_table_fast_append(world, columns, column_count, 
+            data->entities.size);
         if (!count) {
             flecs_table_set_empty(world, table); /* See below */
         }
@@ -45352,6 +51647,8 @@ int32_t flecs_table_append(
         flecs_bitset_addn(bs, 1);
     }
 
+    flecs_table_row_versions_addn(world, table, 1);
+
     /* If this is the first entity in this table, signal queries so that the
      * table moves from an inactive table to an active table. */
     if (!count) {
@@ -45522,6 +51819,8 @@ void flecs_table_delete(
         flecs_bitset_remove(&bs_columns[i], index);
     }
 
+    flecs_table_row_versions_remove(table, index);
+
     flecs_table_check_sanity(table);
 }
 
@@ -45670,6 +51969,274 @@ void flecs_table_move(
     flecs_table_check_sanity(src_table);
 }
 
+/* Delete range of entities from table. The gap is filled with the entities at
+ * the end of the table, so that each column is moved at most once. */
+void flecs_table_delete_range(
+    ecs_world_t *world,
+    ecs_table_t *table,
+    int32_t index,
+    int32_t count,
+    bool destruct)
+{
+    ecs_assert(world != NULL, ECS_INTERNAL_ERROR, NULL);
+    ecs_assert(table != NULL, ECS_INTERNAL_ERROR, NULL);
+    ecs_assert(!table->_->lock, ECS_LOCKED_STORAGE, NULL);
+    ecs_assert(!(table->flags & EcsTableHasTarget),
+        ECS_INVALID_OPERATION, NULL);
+    ecs_assert(!(table->flags & (EcsTableHasUnion|EcsTableHasToggle)),
+        ECS_INTERNAL_ERROR, NULL);
+
+    flecs_table_check_sanity(table);
+
+    ecs_data_t *data = &table->data;
+    int32_t table_count = data->entities.count;
+    ecs_assert(count > 0, ECS_INTERNAL_ERROR, NULL);
+    ecs_assert(index >= 0, ECS_INTERNAL_ERROR, NULL);
+    ecs_assert((index + count) <= table_count, ECS_INTERNAL_ERROR, NULL);
+
+    /* Number of entities after the range that will be moved into the gap */
+    int32_t to_move = table_count - (index + count);
+    if (to_move > count) {
+        to_move = count;
+    }
+    int32_t move_from = table_count - to_move;
+
+    ecs_entity_t *entities = data->entities.array;
+    ecs_column_t *columns = data->columns;
+    int32_t i, column_count = table->column_count;
+
+    if (destruct && (table->flags & EcsTableHasDtors)) {
+        for (i = 0; i < column_count; i ++) {
+            flecs_table_invoke_remove_hooks(world, table, &columns[i],
+                &entities[index], index, count, true);
+        }
+    }
+
+    /* Move entity ids from end of table into gap & update entity index */
+    for (i = 0; i < to_move; i ++) {
+        ecs_entity_t e = entities[move_from + i];
+        ecs_record_t *record = flecs_entities_get(world, e);
+        ecs_assert(record != NULL, ECS_INTERNAL_ERROR, NULL);
+        ecs_assert(record->table == table, ECS_INTERNAL_ERROR, NULL);
+        uint32_t row_flags = record->row & ECS_ROW_FLAGS_MASK;
+        record->row = ECS_ROW_TO_RECORD(index + i, row_flags);
+        entities[index + i] = e;
+    }
+    data->entities.count = table_count - count;
+
+    /* Values in the range have been moved or destructed, so the gap can be
+     * treated as uninitialized memory */
+    for (i = 0; i < column_count; i ++) {
+        ecs_column_t *column = &columns[i];
+        if (to_move) {
+            ecs_size_t size = column->size;
+            void *dst = ECS_ELEM(column->data.array, size, index);
+            void *src = ECS_ELEM(column->data.array, size, move_from);
+            ecs_type_info_t *ti = column->ti;
+            ecs_move_t move = ti->hooks.ctor_move_dtor;
+            if (move) {
+                move(dst, src, to_move, ti);
+            } else {
+                ecs_os_memcpy(dst, src, size * to_move);
+            }
+        }
+        column->data.count = table_count - count;
+    }
+
+    if (table->flags & EcsTableHasRowVersions) {
+        ecs_vec_t *rv = &table->_->row_versions;
+        ecs_size_t size = flecs_table_row_versions_size(table);
+        if (to_move) {
+            ecs_os_memcpy(ECS_ELEM(rv->array, size, index),
+                ECS_ELEM(rv->array, size, move_from), size * to_move);
+        }
+        rv->count = table_count - count;
+    }
+
+    /* If the table is monitored indicate that there has been a change */
+    flecs_table_mark_table_dirty(world, table, 0);
+
+    /* If table is empty, deactivate it */
+    if (table_count == count) {
+        flecs_table_set_empty(world, table);
+    }
+
+    flecs_table_check_sanity(table);
+}
+
+/* Invoke OnAdd or OnRemove hooks for columns in table that are not in other */
+static
+void flecs_table_invoke_diff_hooks(
+    ecs_world_t *world,
+    ecs_table_t *table,
+    ecs_table_t *other,
+    int32_t row,
+    int32_t count,
+    ecs_entity_t event)
+{
+    ecs_column_t *columns = table->data.columns;
+    ecs_column_t *other_columns = other->data.columns;
+    int32_t i, column_count = table->column_count;
+    int32_t o = 0, other_count = other->column_count;
+    ecs_entity_t *entities = ecs_vec_get_t(
+        &table->data.entities, ecs_entity_t, row);
+
+    for (i = 0; i < column_count; i ++) {
+        ecs_column_t *column = &columns[i];
+        ecs_id_t id = column->id;
+        while ((o < other_count) && (other_columns[o].id < id)) {
+            o ++;
+        }
+        if ((o < other_count) && (other_columns[o].id == id)) {
+            continue;
+        }
+
+        ecs_iter_action_t hook = (event == EcsOnAdd)
+            ? column->ti->hooks.on_add
+            : column->ti->hooks.on_remove;
+        if (hook) {
+            flecs_table_invoke_hook(world, table, hook, event, column,
+                entities, row, count);
+        }
+    }
+}
+
+/* Move range of entities from src to dst table. The entities are appended to
+ * the dst table and deleted from the src table, which takes a single move per
+ * column for the entire range. Returns the first row in the dst table. */
+int32_t flecs_table_move_range(
+    ecs_world_t *world,
+    ecs_table_t *dst_table,
+    ecs_table_t *src_table,
+    int32_t src_index,
+    int32_t count,
+    bool construct)
+{
+    ecs_assert(dst_table != NULL, ECS_INTERNAL_ERROR, NULL);
+    ecs_assert(src_table != NULL, ECS_INTERNAL_ERROR, NULL);
+    ecs_assert(dst_table != src_table, ECS_INTERNAL_ERROR, NULL);
+    ecs_assert(!dst_table->_->lock, ECS_LOCKED_STORAGE, NULL);
+    ecs_assert(!src_table->_->lock, ECS_LOCKED_STORAGE, NULL);
+    ecs_assert(!(dst_table->flags & EcsTableHasTarget),
+        ECS_INVALID_OPERATION, NULL);
+    ecs_assert(count > 0, ECS_INTERNAL_ERROR, NULL);
+
+    flecs_table_check_sanity(dst_table);
+    flecs_table_check_sanity(src_table);
+
+    ecs_data_t *src_data = &src_table->data;
+    ecs_data_t *dst_data = &dst_table->data;
+    int32_t src_count = src_data->entities.count;
+    int32_t dst_index = dst_data->entities.count;
+    ecs_assert((src_index + count) <= src_count, ECS_INTERNAL_ERROR, NULL);
+
+    /* If the entire table is moved, merge the storage of the two tables. This
+     * reuses the src columns when the dst table is empty. */
+    if (!src_index && (count == src_count) && construct) {
+        if (src_table->flags & EcsTableHasDtors) {
+            flecs_table_invoke_diff_hooks(world, src_table, dst_table,
+                0, count, EcsOnRemove);
+        }
+
+        flecs_table_merge(world, dst_table, src_table, dst_data, src_data);
+
+        if (dst_table->flags & EcsTableHasCtors) {
+            flecs_table_invoke_diff_hooks(world, dst_table, src_table,
+                dst_index, count, EcsOnAdd);
+        }
+        return dst_index;
+    }
+
+    ecs_assert(!((dst_table->flags | src_table->flags) &
+        (EcsTableHasUnion|EcsTableHasToggle)), ECS_INTERNAL_ERROR, NULL);
+
+    /* Append entity ids to dst table & update entity index */
+    ecs_entity_t *src_entities = ecs_vec_get_t(
+        &src_data->entities, ecs_entity_t, src_index);
+    ecs_entity_t *dst_entities = ecs_vec_grow_t(
+        &world->allocator, &dst_data->entities, ecs_entity_t, count);
+    ecs_os_memcpy_n(dst_entities, src_entities, ecs_entity_t, count);
+
+    int32_t i, traversable = 0;
+    for (i = 0; i < count; i ++) {
+        ecs_record_t *record = flecs_entities_get(world, dst_entities[i]);
+        ecs_assert(record != NULL, ECS_INTERNAL_ERROR, NULL);
+        uint32_t row_flags = ECS_RECORD_TO_ROW_FLAGS(record->row);
+        record->row = ECS_ROW_TO_RECORD(dst_index + i, row_flags);
+        record->table = dst_table;
+        traversable += (row_flags & EcsEntityIsTraversable) != 0;
+    }
+
+    /* Grow dst columns without constructing, values are moved in below */
+    int32_t size = dst_data->entities.size;
+    ecs_column_t *src_columns = src_data->columns;
+    ecs_column_t *dst_columns = dst_data->columns;
+    int32_t i_new = 0, dst_column_count = dst_table->column_count;
+    int32_t i_old = 0, src_column_count = src_table->column_count;
+    for (i = 0; i < dst_column_count; i ++) {
+        flecs_table_grow_column(world, &dst_columns[i], count, size, false);
+    }
+
+    for (; (i_new < dst_column_count) && (i_old < src_column_count); ) {
+        ecs_column_t *dst_column = &dst_columns[i_new];
+        ecs_column_t *src_column = &src_columns[i_old];
+        ecs_id_t dst_id = dst_column->id;
+        ecs_id_t src_id = src_column->id;
+
+        if (dst_id == src_id) {
+            ecs_size_t elem_size = dst_column->size;
+            ecs_type_info_t *ti = dst_column->ti;
+            void *dst = ECS_ELEM(dst_column->data.array, elem_size, dst_index);
+            void *src = ECS_ELEM(src_column->data.array, elem_size, src_index);
+            ecs_move_t move = ti->hooks.ctor_move_dtor;
+            if (move) {
+                move(dst, src, count, ti);
+            } else {
+                ecs_os_memcpy(dst, src, elem_size * count);
+            }
+        } else if (dst_id < src_id) {
+            flecs_table_invoke_add_hooks(world, dst_table, dst_column,
+                dst_entities, dst_index, count, construct);
+        } else {
+            flecs_table_invoke_remove_hooks(world, src_table, src_column,
+                src_entities, src_index, count, true);
+        }
+
+        i_new += dst_id <= src_id;
+        i_old += dst_id >= src_id;
+    }
+
+    for (; (i_new < dst_column_count); i_new ++) {
+        flecs_table_invoke_add_hooks(world, dst_table, &dst_columns[i_new],
+            dst_entities, dst_index, count, construct);
+    }
+
+    for (; (i_old < src_column_count); i_old ++) {
+        flecs_table_invoke_remove_hooks(world, src_table, &src_columns[i_old],
+            src_entities, src_index, count, true);
+    }
+
+    /* If the table is monitored indicate that there has been a change */
+    flecs_table_mark_table_dirty(world, dst_table, 0);
+    flecs_table_row_versions_addn(world, dst_table, count);
+
+    if (!dst_index) {
+        flecs_table_set_empty(world, dst_table);
+    }
+
+    if (traversable) {
+        flecs_table_traversable_add(dst_table, traversable);
+        flecs_table_traversable_add(src_table, -traversable);
+    }
+
+    /* Remove range from src table. Values have already been moved out. */
+    flecs_table_delete_range(world, src_table, src_index, count, false);
+
+    flecs_table_check_sanity(dst_table);
+
+    return dst_index;
+}
+
 /* Append n entities to table */
 int32_t flecs_table_appendn(
     ecs_world_t *world,
@@ -45709,6 +52276,25 @@ void flecs_table_set_size(
     }
 }
 
+/* Reserve storage for count entities that are added to table, so that adding
+ * them doesn't allocate */
+void flecs_table_reserve(
+    ecs_world_t *world,
+    ecs_table_t *table,
+    int32_t count)
+{
+    ecs_data_t *data = &table->data;
+    int32_t size = flecs_table_data_count(data) + count;
+    if (data->entities.size < size) {
+        flecs_table_set_size(world, table, data, size);
+    }
+
+    if (table->flags & EcsTableHasRowVersions) {
+        ecs_vec_set_min_size(&world->allocator, &table->_->row_versions,
+            flecs_table_row_versions_size(table), size);
+    }
+}
+
 /* Shrink table storage to fit number of entities */
 bool flecs_table_shrink(
     ecs_world_t *world,
@@ -45727,12 +52313,61 @@ bool flecs_table_shrink(
     int32_t i, count = table->column_count;
     for (i = 0; i < count; i ++) {
         ecs_column_t *column = &data->columns[i];
-        ecs_vec_reclaim(&world->allocator, &column->data, column->size);
+        if (!column->reserved) {
+            ecs_vec_reclaim(flecs_column_allocator(world), 
+                &column->data, column->size);
+        } else if (column->data.count) {
+            flecs_table_column_vmem_resize(world, column, column->data.count);
+        } else {
+            flecs_table_column_fini(world, column);
+        }
+    }
+
+    if (table->flags & EcsTableHasRowVersions) {
+        ecs_vec_reclaim(&world->allocator, &table->_->row_versions, 
+            flecs_table_row_versions_size(table));
     }
 
     return has_payload;
 }
 
+/* Move column storage of table from one allocator to another */
+void flecs_table_move_columns(
+    ecs_world_t *world,
+    ecs_table_t *table,
+    ecs_allocator_t *dst,
+    ecs_allocator_t *src)
+{
+    ecs_assert(table != NULL, ECS_INTERNAL_ERROR, NULL);
+    ecs_assert(!table->_->lock, ECS_LOCKED_STORAGE, NULL);
+    (void)world;
+
+    ecs_data_t *data = &table->data;
+    int32_t i, count = table->column_count;
+    for (i = 0; i < count; i ++) {
+        ecs_column_t *column = &data->columns[i];
+        int32_t size = column->size;
+        int32_t elem_count = column->data.count;
+        if (!column->data.array || column->reserved) {
+            continue; /* Columns in virtual memory don't use allocator */
+        }
+
+        ecs_vec_t vec;
+        ecs_vec_init(dst, &vec, size, column->data.size);
+        vec.count = elem_count;
+
+        ecs_move_t move = column->ti->hooks.ctor_move_dtor;
+        if (move) {
+            move(vec.array, column->data.array, elem_count, column->ti);
+        } else {
+            ecs_os_memcpy(vec.array, column->data.array, size * elem_count);
+        }
+
+        ecs_vec_fini(src, &column->data, size);
+        column->data = vec;
+    }
+}
+
 /* Return number of entities in table */
 int32_t flecs_table_data_count(
     const ecs_data_t *data)
@@ -45780,6 +52415,26 @@ void flecs_table_swap_bitset_columns(
     }
 }
 
+/* Swap operation for row versions */
+static
+void flecs_table_swap_row_versions(
+    ecs_table_t *table,
+    int32_t row_1,
+    int32_t row_2)
+{
+    if (!(table->flags & EcsTableHasRowVersions)) {
+        return;
+    }
+
+    ecs_size_t size = flecs_table_row_versions_size(table);
+    void *tmp = ecs_os_alloca(size);
+    void *el_1 = flecs_table_row_versions(table, row_1);
+    void *el_2 = flecs_table_row_versions(table, row_2);
+    ecs_os_memcpy(tmp, el_1, size);
+    ecs_os_memcpy(el_1, el_2, size);
+    ecs_os_memcpy(el_2, tmp, size);
+}
+
 /* Swap two rows in a table. Used for table sorting. */
 void flecs_table_swap(
     ecs_world_t *world,
@@ -45824,6 +52479,7 @@ void flecs_table_swap(
 
     flecs_table_swap_switch_columns(table, row_1, row_2);
     flecs_table_swap_bitset_columns(table, row_1, row_2);
+    flecs_table_swap_row_versions(table, row_1, row_2);
 
     ecs_column_t *columns = table->data.columns;
     if (!columns) {
@@ -45916,11 +52572,12 @@ void flecs_table_merge_column(
     int32_t dst_count = dst->data.count;
 
     if (!dst_count) {
-        ecs_vec_fini(&world->allocator, &dst->data, size);
+        flecs_table_column_fini(world, dst);
         *dst = *src;
         src->data.array = NULL;
         src->data.count = 0;
         src->data.size = 0;
+        src->reserved = 0;
 
     /* If the new table is not empty, copy the contents from the
      * src into the dst. */
@@ -45941,7 +52598,7 @@ void flecs_table_merge_column(
             ecs_os_memcpy(dst_ptr, src_ptr, size * src_count);
         }
 
-        ecs_vec_fini(&world->allocator, &src->data, size);
+        flecs_table_column_fini(world, src);
     }
 }
 
@@ -45973,7 +52630,7 @@ void flecs_table_merge_data(
     ecs_assert(dst_data->entities.count == src_count + dst_count, 
         ECS_INTERNAL_ERROR, NULL);
     int32_t column_size = dst_data->entities.size;
-    ecs_allocator_t *a = &world->allocator;
+    ecs_allocator_t *a = flecs_column_allocator(world);
 
     for (; (i_new < dst_column_count) && (i_old < src_column_count); ) {
         ecs_column_t *dst_column = &dst_columns[i_new];
@@ -45989,14 +52646,14 @@ void flecs_table_merge_data(
         } else if (dst_id < src_id) {
             /* New column, make sure vector is large enough. */
             ecs_size_t size = dst_column->size;
-            ecs_vec_set_size(a, &dst_column->data, size, column_size);
+            flecs_table_column_set_size(world, dst_column, column_size);
             ecs_vec_set_count(a, &dst_column->data, size, src_count + dst_count);
             flecs_table_invoke_ctor(dst_column, dst_count, src_count);
             i_new ++;
         } else if (dst_id > src_id) {
             /* Old column does not occur in new table, destruct */
             flecs_table_invoke_dtor(src_column, 0, src_count);
-            ecs_vec_fini(a, &src_column->data, src_column->size);
+            flecs_table_column_fini(world, src_column);
             i_old ++;
         }
     }
@@ -46009,7 +52666,7 @@ void flecs_table_merge_data(
         ecs_column_t *column = &dst_columns[i_new];
         int32_t size = column->size;
         ecs_assert(size != 0, ECS_INTERNAL_ERROR, NULL);
-        ecs_vec_set_size(a, &column->data, size, column_size);
+        flecs_table_column_set_size(world, column, column_size);
         ecs_vec_set_count(a, &column->data, size, src_count + dst_count);
         flecs_table_invoke_ctor(column, dst_count, src_count);
     }
@@ -46018,7 +52675,7 @@ void flecs_table_merge_data(
     for (; i_old < src_column_count; i_old ++) {
         ecs_column_t *column = &src_columns[i_old];
         flecs_table_invoke_dtor(column, 0, src_count);
-        ecs_vec_fini(a, &column->data, column->size);
+        flecs_table_column_fini(world, column);
     }    
 
     /* Mark entity column as dirty */
@@ -46085,6 +52742,23 @@ void flecs_table_merge(
             src_data, dst_data);
     }
 
+    /* Merged rows are new to the destination table */
+    if ((src_table != dst_table) && (src_data == &src_table->data)) {
+        if (src_table->flags & EcsTableHasRowVersions) {
+            ecs_vec_clear(&src_table->_->row_versions);
+        }
+    }
+    if (dst_data == &dst_table->data) {
+        if (move_data && (dst_table->flags & EcsTableHasRowVersions)) {
+            ecs_vec_clear(&dst_table->_->row_versions);
+            flecs_table_mark_table_dirty(world, dst_table, 0);
+            flecs_table_row_versions_addn(world, dst_table, 
+                ecs_table_count(dst_table));
+        } else {
+            flecs_table_row_versions_addn(world, dst_table, src_count);
+        }
+    }
+
     if (src_count) {
         if (!dst_count) {
             flecs_table_set_empty(world, dst_table);
@@ -54157,6 +60831,42 @@ void flecs_json_serialize_query_plan(
 #endif
 }
 
+#ifdef FLECS_RULES
+static
+void flecs_json_serialize_rule_profile(
+    ecs_strbuf_t *buf,
+    const ecs_rule_t *rule)
+{
+    ecs_rule_profile_t profile = ecs_rule_get_profile(rule);
+    if (!profile.ops) {
+        return;
+    }
+
+    flecs_json_memberl(buf, "iter_count");
+    flecs_json_number(buf, profile.iter_count);
+
+    /* Operations are in the same order as the query plan */
+    flecs_json_memberl(buf, "ops");
+    flecs_json_array_push(buf);
+    int32_t i;
+    for (i = 0; i < profile.op_count; i ++) {
+        const ecs_rule_op_profile_t *op = &profile.ops[i];
+        flecs_json_next(buf);
+        flecs_json_object_push(buf);
+        flecs_json_memberl(buf, "enter");
+        flecs_json_number(buf, op->count[0]);
+        flecs_json_memberl(buf, "redo");
+        flecs_json_number(buf, op->count[1]);
+        flecs_json_memberl(buf, "match");
+        flecs_json_number(buf, op->match_count);
+        flecs_json_memberl(buf, "time_us");
+        flecs_json_number(buf, op->time_spent * 1000.0 * 1000.0);
+        flecs_json_object_pop(buf);
+    }
+    flecs_json_array_pop(buf);
+}
+#endif
+
 static
 void flecs_json_serialize_query_profile(
     const ecs_world_t *world,
@@ -54167,6 +60877,14 @@ void flecs_json_serialize_query_profile(
     if (!desc->query) {
         return;
     }
+
+    /* If query is a rule, also measure the individual rule operations */
+    const ecs_rule_t *rule = NULL;
+#ifdef FLECS_RULES
+    if (ecs_poly_is(desc->query, ecs_rule_t)) {
+        rule = desc->query;
+    }
+#endif
     
     ecs_time_t t = {0};
     int32_t result_count = 0, entity_count = 0, i, sample_count = 100;
@@ -54183,6 +60901,9 @@ void flecs_json_serialize_query_profile(
         ecs_iter_t pit;
         ecs_iter_poly(world, desc->query, &pit, NULL);
         pit.flags |= EcsIterIsInstanced;
+        if (rule) {
+            pit.flags |= EcsIterProfile;
+        }
     
         while (ecs_iter_next(&pit)) {
             result_count ++;
@@ -54249,6 +60970,12 @@ void flecs_json_serialize_query_profile(
     flecs_json_memberl(buf, "shared_component_bytes");
     flecs_json_number(buf, shared_component_bytes);
 
+#ifdef FLECS_RULES
+    if (rule) {
+        flecs_json_serialize_rule_profile(buf, rule);
+    }
+#endif
+
     flecs_json_object_pop(buf);
 }
 
@@ -61210,6 +67937,52 @@ void win_fini(void) {
     }
 }
 
+static uintptr_t win_page_size;
+
+static
+void* win_vmem_reserve(
+    ecs_size_t size)
+{
+    return VirtualAlloc(NULL, (SIZE_T)size, MEM_RESERVE, PAGE_NOACCESS);
+}
+
+static
+bool win_vmem_commit(
+    void *ptr,
+    ecs_size_t size)
+{
+    return VirtualAlloc(ptr, (SIZE_T)size, MEM_COMMIT, PAGE_READWRITE) != NULL;
+}
+
+static
+void win_vmem_decommit(
+    void *ptr,
+    ecs_size_t size)
+{
+    /* Only decommit pages that are entirely inside the range */
+    uintptr_t mask = win_page_size - 1;
+    uintptr_t start = ((uintptr_t)ptr + mask) & ~mask;
+    uintptr_t end = ((uintptr_t)ptr + (uintptr_t)size) & ~mask;
+    if (end <= start) {
+        return;
+    }
+
+    if (!VirtualFree((void*)start, (SIZE_T)(end - start), MEM_DECOMMIT)) {
+        ecs_err("failed to decommit memory");
+    }
+}
+
+static
+void win_vmem_release(
+    void *ptr,
+    ecs_size_t size)
+{
+    (void)size;
+    if (!VirtualFree(ptr, 0, MEM_RELEASE)) {
+        ecs_err("failed to release memory");
+    }
+}
+
 void ecs_set_os_api_impl(void) {
     ecs_os_set_api_defaults();
 
@@ -61237,6 +68010,14 @@ void ecs_set_os_api_impl(void) {
     api.now_ = win_time_now;
     api.fini_ = win_fini;
 
+    SYSTEM_INFO info;
+    GetSystemInfo(&info);
+    win_page_size = (uintptr_t)info.dwPageSize;
+    api.vmem_reserve_ = win_vmem_reserve;
+    api.vmem_commit_ = win_vmem_commit;
+    api.vmem_decommit_ = win_vmem_decommit;
+    api.vmem_release_ = win_vmem_release;
+
     win_time_setup();
 
     if (ecs_os_api.flags_ & EcsOsApiHighResolutionTimer) {
@@ -61262,6 +68043,16 @@ void ecs_set_os_api_impl(void) {
 #include <time.h>
 #endif
 
+#ifndef __EMSCRIPTEN__
+#define FLECS_POSIX_VMEM
+#include <sys/mman.h>
+#include <fcntl.h>
+#include <unistd.h>
+#if !defined(MAP_ANONYMOUS) && defined(MAP_ANON)
+#define MAP_ANONYMOUS MAP_ANON
+#endif
+#endif
+
 /* This mutex is used to emulate atomic operations when the gnu builtins are
  * not supported. This is probably not very fast but if the compiler doesn't
  * support the gnu built-ins, then speed is probably not a priority. */
@@ -61547,6 +68338,91 @@ uint64_t posix_time_now(void) {
     return now;
 }
 
+#ifdef FLECS_POSIX_VMEM
+static uintptr_t posix_page_size;
+
+static
+void* posix_vmem_map(
+    void *ptr,
+    size_t size,
+    int flags)
+{
+    flags |= MAP_PRIVATE;
+#ifdef MAP_NORESERVE
+    flags |= MAP_NORESERVE;
+#endif
+#ifdef MAP_ANONYMOUS
+    return mmap(ptr, size, PROT_NONE, flags | MAP_ANONYMOUS, -1, 0);
+#else
+    /* Private mapping of /dev/zero behaves like an anonymous mapping */
+    int fd = open("/dev/zero", O_RDWR);
+    if (fd == -1) {
+        return MAP_FAILED;
+    }
+    void *result = mmap(ptr, size, PROT_NONE, flags, fd, 0);
+    close(fd);
+    return result;
+#endif
+}
+
+static
+void* posix_vmem_reserve(
+    ecs_size_t size)
+{
+    void *result = posix_vmem_map(NULL, (size_t)size, 0);
+    if (result == MAP_FAILED) {
+        return NULL;
+    }
+
+#ifdef MADV_HUGEPAGE
+    /* Large columns benefit from fewer TLB misses */
+    madvise(result, (size_t)size, MADV_HUGEPAGE);
+#endif
+
+    return result;
+}
+
+static
+bool posix_vmem_commit(
+    void *ptr,
+    ecs_size_t size)
+{
+    uintptr_t mask = posix_page_size - 1;
+    uintptr_t start = (uintptr_t)ptr & ~mask;
+    uintptr_t end = ((uintptr_t)ptr + (uintptr_t)size + mask) & ~mask;
+    return !mprotect((void*)start, end - start, PROT_READ | PROT_WRITE);
+}
+
+static
+void posix_vmem_decommit(
+    void *ptr,
+    ecs_size_t size)
+{
+    /* Only decommit pages that are entirely inside the range */
+    uintptr_t mask = posix_page_size - 1;
+    uintptr_t start = ((uintptr_t)ptr + mask) & ~mask;
+    uintptr_t end = ((uintptr_t)ptr + (uintptr_t)size) & ~mask;
+    if (end <= start) {
+        return;
+    }
+
+    /* Replacing the pages with a new mapping returns them to the OS */
+    if (posix_vmem_map((void*)start, end - start, MAP_FIXED) == MAP_FAILED) {
+        ecs_err("failed to decommit memory");
+    }
+}
+
+static
+void posix_vmem_release(
+    void *ptr,
+    ecs_size_t size)
+{
+    if (munmap(ptr, (size_t)size)) {
+        ecs_err("failed to release memory");
+    }
+}
+#endif
+
 void ecs_set_os_api_impl(void) {
     ecs_os_set_api_defaults();
 
@@ -61573,6 +68449,17 @@ void ecs_set_os_api_impl(void) {
     api.sleep_ = posix_sleep;
     api.now_ = posix_time_now;
 
+#ifdef FLECS_POSIX_VMEM
+    long page_size = sysconf(_SC_PAGESIZE);
+    if (page_size > 0) {
+        posix_page_size = (uintptr_t)page_size;
+        api.vmem_reserve_ = posix_vmem_reserve;
+        api.vmem_commit_ = posix_vmem_commit;
+        api.vmem_decommit_ = posix_vmem_decommit;
+        api.vmem_release_ = posix_vmem_release;
+    }
+#endif
+
     posix_time_setup();
 
     ecs_os_set_api(&api);
@@ -61597,6 +68484,12 @@ static void flecs_pipeline_free(
         ecs_allocator_t *a = &world->allocator;
         ecs_vec_fini_t(a, &p->ops, ecs_pipeline_op_t);
         ecs_vec_fini_t(a, &p->systems, ecs_entity_t);
+        ecs_vec_fini_t(a, &p->system_deps, ecs_pipeline_deps_t);
+        ecs_vec_fini_t(a, &p->deps, int32_t);
+        ecs_vec_fini_t(a, &p->jobs, ecs_worker_job_t);
+        ecs_vec_fini_t(a, &p->job_queues, ecs_worker_queue_t);
+        ecs_vec_fini_t(a, &p->job_systems, ecs_worker_jobs_t);
+        ecs_vec_fini_t(a, &p->job_deps, int32_t);
         ecs_os_free(p->iters);
         ecs_query_fini(p->query);
         ecs_os_free(p);
@@ -61817,6 +68710,156 @@ bool flecs_pipeline_check_terms(
     return needs_merge;
 }
 
+/* Component accessed by a system, used to find systems that can run in 
+ * parallel. */
+typedef struct ecs_pipeline_access_t {
+    ecs_id_t id;
+    bool write;
+} ecs_pipeline_access_t;
+
+static
+void flecs_pipeline_add_access(
+    ecs_world_t *world,
+    ecs_filter_t *filter,
+    ecs_vec_t *access)
+{
+    ecs_allocator_t *a = &world->allocator;
+    ecs_term_t *terms = filter->terms;
+    int32_t t, term_count = filter->term_count;
+
+    for (t = 0; t < term_count; t ++) {
+        ecs_term_t *term = &terms[t];
+        ecs_term_id_t *src = &term->src;
+        ecs_inout_kind_t inout = term->inout;
+        ecs_id_t id = term->id;
+
+        if (inout == EcsInOutNone || term->oper == EcsNot) {
+            continue;
+        }
+
+        if (!ecs_id_is_wildcard(id) && !ecs_get_typeid(world, id)) {
+            /* Tags have no data that could be accessed */
+            continue;
+        }
+
+        bool from_any = ecs_term_match_0(term);
+        bool from_this = ecs_term_match_this(term);
+        bool is_shared = !from_any && (!from_this || !(src->flags & EcsSelf));
+
+        if (inout == EcsInOutDefault) {
+            if (from_any) {
+                continue;
+            } else if (is_shared) {
+                inout = EcsIn;
+            } else {
+                inout = EcsInOut;
+            }
+        }
+
+        bool write = inout == EcsOut || inout == EcsInOut;
+        if (from_any) {
+            if (inout == EcsOut) {
+                /* Writes to components not matched by the query are staged */
+                continue;
+            }
+
+            /* Components not matched by the query are read from the main
+             * storage, while writes to them are staged. */
+            write = false;
+        }
+
+        ecs_pipeline_access_t *elem = ecs_vec_append_t(
+            a, access, ecs_pipeline_access_t);
+        elem->id = id;
+        elem->write = write;
+    }
+}
+
+static
+bool flecs_pipeline_id_overlap(
+    ecs_entity_t a,
+    ecs_entity_t b)
+{
+    return (a == b) || 
+        (a == (uint32_t)EcsWildcard) || (b == (uint32_t)EcsWildcard) ||
+        (a == (uint32_t)EcsAny) || (b == (uint32_t)EcsAny);
+}
+
+static
+bool flecs_pipeline_ids_overlap(
+    ecs_id_t a,
+    ecs_id_t b)
+{
+    if (a == b || a == EcsWildcard || b == EcsWildcard || 
+        a == EcsAny || b == EcsAny) 
+    {
+        return true;
+    }
+
+    if (!ECS_IS_PAIR(a) || !ECS_IS_PAIR(b)) {
+        return false;
+    }
+
+    return flecs_pipeline_id_overlap(ECS_PAIR_FIRST(a), ECS_PAIR_FIRST(b)) &&
+        flecs_pipeline_id_overlap(ECS_PAIR_SECOND(a), ECS_PAIR_SECOND(b));
+}
+
+/* Two systems conflict if one of them writes a component the other accesses */
+static
+bool flecs_pipeline_access_conflict(
+    const ecs_pipeline_access_t *a,
+    int32_t a_count,
+    const ecs_pipeline_access_t *b,
+    int32_t b_count)
+{
+    int32_t i, j;
+    for (i = 0; i < a_count; i ++) {
+        for (j = 0; j < b_count; j ++) {
+            if (!a[i].write && !b[j].write) {
+                continue;
+            }
+            if (flecs_pipeline_ids_overlap(a[i].id, b[j].id)) {
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+/* Find earlier systems in the operation the last added system depends on */
+static
+void flecs_pipeline_add_deps(
+    ecs_world_t *world,
+    ecs_pipeline_state_t *pq,
+    ecs_pipeline_op_t *op,
+    ecs_vec_t *access,
+    ecs_vec_t *access_offsets)
+{
+    ecs_allocator_t *a = &world->allocator;
+    const ecs_pipeline_access_t *elems = ecs_vec_first_t(
+        access, ecs_pipeline_access_t);
+    int32_t *offsets = ecs_vec_first_t(access_offsets, int32_t);
+    int32_t cur = ecs_vec_count(&pq->systems) - 1;
+    int32_t cur_offset = offsets[cur];
+    int32_t cur_count = offsets[cur + 1] - cur_offset;
+
+    ecs_pipeline_deps_t *deps = ecs_vec_append_t(
+        a, &pq->system_deps, ecs_pipeline_deps_t);
+    deps->offset = ecs_vec_count(&pq->deps);
+    deps->count = 0;
+
+    int32_t i;
+    for (i = op->offset; i < cur; i ++) {
+        int32_t offset = offsets[i], count = offsets[i + 1] - offset;
+        if (flecs_pipeline_access_conflict(
+            &elems[cur_offset], cur_count, &elems[offset], count))
+        {
+            ecs_vec_append_t(a, &pq->deps, int32_t)[0] = i;
+            deps->count ++;
+        }
+    }
+}
+
 static
 EcsPoly* flecs_pipeline_term_system(
     ecs_iter_t *it)
@@ -61853,6 +68896,15 @@ bool flecs_pipeline_build(
 
     ecs_vec_reset_t(a, &pq->ops, ecs_pipeline_op_t);
     ecs_vec_reset_t(a, &pq->systems, ecs_entity_t);
+    ecs_vec_reset_t(a, &pq->system_deps, ecs_pipeline_deps_t);
+    ecs_vec_reset_t(a, &pq->deps, int32_t);
+
+    /* Components accessed by each system, used to determine which systems in
+     * an operation can run in parallel */
+    ecs_vec_t access, access_offsets;
+    ecs_vec_init_t(a, &access, ecs_pipeline_access_t, 0);
+    ecs_vec_init_t(a, &access_offsets, int32_t, 0);
+    ecs_vec_append_t(a, &access_offsets, int32_t)[0] = 0;
 
     bool multi_threaded = false;
     bool no_readonly = false;
@@ -61942,6 +68994,20 @@ bool flecs_pipeline_build(
                     op->no_readonly = no_readonly;
                 }
                 op->count ++;
+
+                if (q->filter.term_count) {
+                    flecs_pipeline_add_access(world, &q->filter, &access);
+                } else {
+                    /* Tasks don't have a query, so could access anything */
+                    ecs_pipeline_access_t *elem = ecs_vec_append_t(
+                        a, &access, ecs_pipeline_access_t);
+                    elem->id = EcsWildcard;
+                    elem->write = true;
+                }
+
+                ecs_vec_append_t(a, &access_offsets, int32_t)[0] = 
+                    ecs_vec_count(&access);
+                flecs_pipeline_add_deps(world, pq, op, &access, &access_offsets);
             }
         }
     }
@@ -61952,6 +69018,8 @@ bool flecs_pipeline_build(
 
     ecs_map_fini(&ws.ids);
     ecs_map_fini(&ws.wildcard_ids);
+    ecs_vec_fini_t(a, &access, ecs_pipeline_access_t);
+    ecs_vec_fini_t(a, &access_offsets, int32_t);
 
     op = ecs_vec_first_t(&pq->ops, ecs_pipeline_op_t);
 
@@ -62125,6 +69193,13 @@ int32_t flecs_run_pipeline_ops(
 
     ecs_assert(!stage_index || op->multi_threaded, ECS_INTERNAL_ERROR, NULL);
 
+    if (ECS_BIT_IS_SET(world->flags, EcsWorldMultiThreaded) &&
+        ECS_BIT_IS_SET(world->flags, EcsWorldWorkStealing)) 
+    {
+        return flecs_workers_run_jobs(
+            world, stage, stage_index, stage_count, delta_time);
+    }
+
     int32_t count = ecs_vec_count(&pq->systems);
     ecs_entity_t* systems = ecs_vec_first_t(&pq->systems, ecs_entity_t);
     int32_t ran_since_merge = i - op->offset;
@@ -62147,8 +69222,12 @@ int32_t flecs_run_pipeline_ops(
             s = stage;
         }
 
+        /* Only assign entity ranges to workers if the system is the only one
+         * in the operation. Workers don't synchronize between systems in an
+         * operation, so systems that share an operation must divide tables
+         * the same way to prevent threads from accessing the same entities. */
         ecs_run_intern(world, s, system, sys, stage_index,
-            stage_count, delta_time, 0, 0, NULL);
+            stage_count, delta_time, 0, 0, op->count == 1, NULL);
 
         world->info.systems_ran_frame++;
         ran_since_merge++;
@@ -62206,6 +69285,9 @@ void flecs_run_pipeline(
         ecs_assert(world->workers_waiting == 0, ECS_INTERNAL_ERROR, NULL);
 
         if (op_multi_threaded) {
+            if (ECS_BIT_IS_SET(world->flags, EcsWorldWorkStealing)) {
+                flecs_workers_prepare_jobs(world, pq, stage_count);
+            }
             flecs_signal_workers(world);
         }
 
@@ -62526,6 +69608,45 @@ void FlecsPipelineImport(
 
 #ifdef FLECS_PIPELINE
 
+/* Read value that is concurrently written by other threads */
+static
+int32_t flecs_worker_load(
+    const int32_t *value)
+{
+    return *(const volatile int32_t*)value;
+}
+
+/* Wait until main thread signals that workers can continue. Spins for a short
+ * while before blocking, so that workers don't need to be woken up by the OS
+ * for pipeline operations that are close together. */
+static
+int32_t flecs_worker_park(
+    ecs_world_t *world,
+    int32_t gen)
+{
+    int32_t i, cur;
+    for (i = 0; i < FLECS_WORKER_SPIN_COUNT; i ++) {
+        cur = flecs_worker_load(&world->workers_gen);
+        if (cur != gen) {
+            return cur;
+        }
+    }
+
+    /* Main thread only takes the mutex to wake up workers when it sees that a
+     * worker is parked. Because both the generation and parked counters are 
+     * incremented with a full barrier, either the main thread sees that the
+     * worker is parked, or the worker sees the new generation. */
+    ecs_os_mutex_lock(world->sync_mutex);
+    ecs_os_ainc(&world->workers_parked);
+    while ((cur = flecs_worker_load(&world->workers_gen)) == gen) {
+        ecs_os_cond_wait(world->worker_cond, world->sync_mutex);
+    }
+    ecs_os_adec(&world->workers_parked);
+    ecs_os_mutex_unlock(world->sync_mutex);
+
+    return cur;
+}
+
 /* Synchronize workers */
 static
 void flecs_sync_worker(
@@ -62536,6 +69657,18 @@ void flecs_sync_worker(
         return;
     }
 
+    if (ECS_BIT_IS_SET(world->flags, EcsWorldWorkStealing)) {
+        /* Only wake up main thread if it stopped spinning */
+        if (ecs_os_ainc(&world->workers_waiting) == (stage_count - 1)) {
+            if (flecs_worker_load(&world->sync_parked)) {
+                ecs_os_mutex_lock(world->sync_mutex);
+                ecs_os_cond_signal(world->sync_cond);
+                ecs_os_mutex_unlock(world->sync_mutex);
+            }
+        }
+        return;
+    }
+
     /* Signal that thread is waiting */
     ecs_os_mutex_lock(world->sync_mutex);
     if (++world->workers_waiting == (stage_count - 1)) {
@@ -62559,27 +69692,44 @@ void* flecs_worker(void *arg) {
 
     ecs_dbg_2("worker %d: start", stage->id);
 
+    bool stealing = ECS_BIT_IS_SET(world->flags, EcsWorldWorkStealing);
+
     /* Start worker, increase counter so main thread knows how many
      * workers are ready */
     ecs_os_mutex_lock(world->sync_mutex);
     world->workers_running ++;
+    int32_t gen = world->workers_gen;
 
-    if (!(world->flags & EcsWorldQuitWorkers)) {
+    if (!stealing && !(world->flags & EcsWorldQuitWorkers)) {
         ecs_os_cond_wait(world->worker_cond, world->sync_mutex);
     }
 
     ecs_os_mutex_unlock(world->sync_mutex);
 
+    if (stealing) {
+        gen = flecs_worker_park(world, gen);
+    }
+
     while (!(world->flags & EcsWorldQuitWorkers)) {
         ecs_entity_t old_scope = ecs_set_scope((ecs_world_t*)stage, 0);
 
-        ecs_dbg_3("worker %d: run", stage->id);
-        flecs_run_pipeline_ops(world, stage, stage->id, world->stage_count, 
-            world->info.delta_time);
+        ecs_worker_task_action_t task = world->worker_task;
+        if (task) {
+            ecs_dbg_3("worker %d: run task", stage->id);
+            task(world, stage, world->worker_task_ctx);
+        } else {
+            ecs_dbg_3("worker %d: run", stage->id);
+            flecs_run_pipeline_ops(world, stage, stage->id, 
+                world->stage_count, world->info.delta_time);
+        }
 
         ecs_set_scope((ecs_world_t*)stage, old_scope);
 
         flecs_sync_worker(world);
+
+        if (stealing) {
+            gen = flecs_worker_park(world, gen);
+        }
     }
 
     ecs_dbg_2("worker %d: finalizing", stage->id);
@@ -62665,6 +69815,31 @@ void flecs_wait_for_sync(
 
     ecs_dbg_3("#[bold]pipeline: waiting for worker sync");
 
+    if (ECS_BIT_IS_SET(world->flags, EcsWorldWorkStealing)) {
+        int32_t i, worker_count = stage_count - 1;
+        for (i = 0; i < FLECS_WORKER_SPIN_COUNT; i ++) {
+            if (flecs_worker_load(&world->workers_waiting) == worker_count) {
+                break;
+            }
+        }
+
+        if (i == FLECS_WORKER_SPIN_COUNT) {
+            ecs_os_mutex_lock(world->sync_mutex);
+            ecs_os_ainc(&world->sync_parked);
+            while (flecs_worker_load(&world->workers_waiting) != worker_count) {
+                ecs_os_cond_wait(world->sync_cond, world->sync_mutex);
+            }
+            ecs_os_adec(&world->sync_parked);
+            ecs_os_mutex_unlock(world->sync_mutex);
+        }
+
+        /* Workers don't access the counter until they are signalled again */
+        world->workers_waiting = 0;
+
+        ecs_dbg_3("#[bold]pipeline: workers synced");
+        return;
+    }
+
     ecs_os_mutex_lock(world->sync_mutex);
     if (world->workers_waiting != (stage_count - 1)) {
         ecs_os_cond_wait(world->sync_cond, world->sync_mutex);
@@ -62690,6 +69865,19 @@ void flecs_signal_workers(
     }
 
     ecs_dbg_3("#[bold]pipeline: signal workers");
+
+    if (ECS_BIT_IS_SET(world->flags, EcsWorldWorkStealing)) {
+        /* Workers that are still spinning pick up the new generation without
+         * having to be woken up */
+        ecs_os_ainc(&world->workers_gen);
+        if (flecs_worker_load(&world->workers_parked)) {
+            ecs_os_mutex_lock(world->sync_mutex);
+            ecs_os_cond_broadcast(world->worker_cond);
+            ecs_os_mutex_unlock(world->sync_mutex);
+        }
+        return;
+    }
+
     ecs_os_mutex_lock(world->sync_mutex);
     ecs_os_cond_broadcast(world->worker_cond);
     ecs_os_mutex_unlock(world->sync_mutex);
@@ -62739,7 +69927,188 @@ void flecs_join_worker_threads(
     ecs_assert(world->workers_running == 0, ECS_INTERNAL_ERROR, NULL);
 }
 
+/* Wait until all jobs for a system have finished */
+static
+void flecs_workers_wait_jobs(
+    ecs_worker_jobs_t *sj)
+{
+    int32_t i = 0;
+    while (flecs_worker_load(&sj->jobs_done) != sj->job_count) {
+        if (++ i == FLECS_WORKER_SPIN_COUNT) {
+            /* Another thread is still running a large job, yield */
+            ecs_os_sleep(0, 0);
+            i = 0;
+        }
+    }
+}
+
+/* Count entities matched by system query. This is an estimate, as entities 
+ * can still be filtered out during iteration. The last job of a system always
+ * runs until the end of the results, so a bad estimate won't cause entities to
+ * be skipped. */
+static
+int32_t flecs_workers_entity_count(
+    ecs_query_t *query)
+{
+    int32_t result = 0;
+    ecs_table_cache_hdr_t *cur;
+    for (cur = query->cache.tables.first; cur != NULL; cur = cur->next) {
+        result += ecs_table_count(cur->table);
+    }
+    return result;
+}
+
 /* -- Private functions -- */
+
+/* Split up systems in current pipeline operation in table range jobs */
+void flecs_workers_prepare_jobs(
+    ecs_world_t *world,
+    ecs_pipeline_state_t *pq,
+    int32_t stage_count)
+{
+    ecs_allocator_t *a = &world->allocator;
+    ecs_pipeline_op_t *op = pq->cur_op;
+
+    ecs_vec_reset_t(a, &pq->jobs, ecs_worker_job_t);
+    ecs_vec_reset_t(a, &pq->job_queues, ecs_worker_queue_t);
+    ecs_vec_reset_t(a, &pq->job_systems, ecs_worker_jobs_t);
+    ecs_vec_reset_t(a, &pq->job_deps, int32_t);
+
+    ecs_entity_t *systems = ecs_vec_first_t(&pq->systems, ecs_entity_t);
+    ecs_pipeline_deps_t *system_deps = ecs_vec_first_t(
+        &pq->system_deps, ecs_pipeline_deps_t);
+    int32_t *deps = ecs_vec_first_t(&pq->deps, int32_t);
+    int32_t i, count = op->offset + op->count;
+    for (i = pq->cur_i; i < count; i ++) {
+        ecs_entity_t system = systems[i];
+        const EcsPoly *poly = ecs_get_pair(world, system, EcsPoly, EcsSystem);
+        ecs_poly_assert(poly->poly, ecs_system_t);
+        ecs_system_t *sys = (ecs_system_t*)poly->poly;
+
+        ecs_worker_jobs_t *sj = ecs_vec_append_t(
+            a, &pq->job_systems, ecs_worker_jobs_t);
+        sj->system = system;
+        sj->sys = sys;
+        sj->jobs_done = 0;
+        sj->queues = ecs_vec_count(&pq->job_queues);
+        sj->is_task = sys->query->filter.term_count == 0;
+
+        /* Store systems to wait for as indices in the job_systems vector. 
+         * Systems that ran before a pipeline rebuild are already done. */
+        sj->deps = ecs_vec_count(&pq->job_deps);
+        sj->dep_count = 0;
+        int32_t d, dep_last = system_deps[i].offset + system_deps[i].count;
+        for (d = system_deps[i].offset; d < dep_last; d ++) {
+            if (deps[d] >= pq->cur_i) {
+                ecs_vec_append_t(a, &pq->job_deps, int32_t)[0] = 
+                    deps[d] - pq->cur_i;
+                sj->dep_count ++;
+            }
+        }
+
+        if (sj->is_task) {
+            /* Task is done when it has ran on each thread */
+            sj->job_count = stage_count;
+            continue;
+        }
+
+        int32_t entity_count = flecs_workers_entity_count(sys->query);
+        int32_t max_jobs = stage_count * FLECS_WORKER_JOBS_PER_THREAD;
+        int32_t job_count = entity_count / FLECS_WORKER_JOB_MIN_SIZE;
+        if (job_count > max_jobs) {
+            job_count = max_jobs;
+        } else if (!job_count) {
+            job_count = 1;
+        }
+        int32_t job_size = entity_count / job_count;
+
+        sj->job_count = job_count;
+
+        int32_t j, first = ecs_vec_count(&pq->jobs);
+        ecs_worker_job_t *jobs = ecs_vec_grow_t(
+            a, &pq->jobs, ecs_worker_job_t, job_count);
+        for (j = 0; j < job_count; j ++) {
+            jobs[j].offset = j * job_size;
+            jobs[j].limit = job_size;
+        }
+
+        /* Last job runs until the end of the system results */
+        jobs[job_count - 1].limit = 0;
+
+        /* Divide jobs across thread queues */
+        ecs_worker_queue_t *queues = ecs_vec_grow_t(
+            a, &pq->job_queues, ecs_worker_queue_t, stage_count);
+        for (j = 0; j < stage_count; j ++) {
+            queues[j].head = first + (j * job_count) / stage_count;
+            queues[j].last = first + ((j + 1) * job_count) / stage_count;
+        }
+    }
+}
+
+/* Run jobs for current pipeline operation. A thread first claims jobs from its
+ * own queue, and then steals from the queues of other threads. Before starting
+ * on a system a thread waits until the systems it depends on have finished, so
+ * that systems that don't access the same components run in parallel. */
+int32_t flecs_workers_run_jobs(
+    ecs_world_t *world,
+    ecs_stage_t *stage,
+    int32_t stage_index,
+    int32_t stage_count,
+    ecs_ftime_t delta_time)
+{
+    ecs_pipeline_state_t *pq = world->pq;
+    ecs_pipeline_op_t *op = pq->cur_op;
+
+    ecs_worker_jobs_t *sjs = ecs_vec_first_t(&pq->job_systems, ecs_worker_jobs_t);
+    ecs_worker_queue_t *queues = ecs_vec_first_t(
+        &pq->job_queues, ecs_worker_queue_t);
+    ecs_worker_job_t *jobs = ecs_vec_first_t(&pq->jobs, ecs_worker_job_t);
+    int32_t *deps = ecs_vec_first_t(&pq->job_deps, int32_t);
+
+    ecs_stage_t *s = NULL;
+    if (!op->no_readonly) {
+        s = stage;
+    }
+
+    int32_t i, count = ecs_vec_count(&pq->job_systems);
+    for (i = 0; i < count; i ++) {
+        ecs_worker_jobs_t *sj = &sjs[i];
+        sj->sys->last_frame = world->info.frame_count_total + 1;
+
+        int32_t d;
+        for (d = 0; d < sj->dep_count; d ++) {
+            flecs_workers_wait_jobs(&sjs[deps[sj->deps + d]]);
+        }
+
+        if (sj->is_task) {
+            ecs_run_intern(world, s, sj->system, sj->sys, stage_index,
+                stage_count, delta_time, 0, 0, false, NULL);
+            ecs_os_ainc(&sj->jobs_done);
+        } else {
+            ecs_worker_queue_t *sq = &queues[sj->queues];
+            int32_t v;
+            for (v = 0; v < stage_count; v ++) {
+                ecs_worker_queue_t *q = &sq[(stage_index + v) % stage_count];
+                int32_t j;
+                while ((j = ecs_os_ainc(&q->head) - 1) < q->last) {
+                    ecs_worker_job_t *job = &jobs[j];
+
+                    /* Jobs aren't split up further across workers */
+                    ecs_run_intern(world, s, sj->system, sj->sys, stage_index,
+                        1, delta_time, job->offset, job->limit, false, NULL);
+                    ecs_os_ainc(&sj->jobs_done);
+                }
+            }
+        }
+
+        if (!stage_index) {
+            world->info.systems_ran_frame ++;
+        }
+    }
+
+    return op->offset + op->count - 1;
+}
+
 void flecs_workers_progress(
     ecs_world_t *world,
     ecs_pipeline_state_t *pq,
@@ -62780,12 +70149,15 @@ void flecs_set_threads_internal(
 
             if (world->worker_cond) {
                 ecs_os_cond_free(world->worker_cond);
+                world->worker_cond = 0;
             }
             if (world->sync_cond) {
                 ecs_os_cond_free(world->sync_cond);
+                world->sync_cond = 0;
             }
             if (world->sync_mutex) {
                 ecs_os_mutex_free(world->sync_mutex);
+                world->sync_mutex = 0;
             }
         }
 
@@ -62801,8 +70173,87 @@ void flecs_set_threads_internal(
     }
 }
 
+bool flecs_workers_can_run_task(
+    const ecs_world_t *world)
+{
+    if (ecs_get_stage_count(world) <= 1 || !world->worker_cond) {
+        return false;
+    }
+
+    /* Workers are busy running a pipeline operation */
+    if (world->flags & (EcsWorldReadonly|EcsWorldMultiThreaded)) {
+        return false;
+    }
+
+    /* Task threads only exist while the pipeline is running */
+    return world->stages[1].thread != 0;
+}
+
+void flecs_workers_run_task(
+    ecs_world_t *world,
+    ecs_worker_task_action_t action,
+    void *ctx)
+{
+    ecs_poly_assert(world, ecs_world_t);
+    ecs_assert(flecs_workers_can_run_task(world), ECS_INTERNAL_ERROR, NULL);
+    ecs_assert(world->worker_task == NULL, ECS_INTERNAL_ERROR, NULL);
+
+    /* Workers that haven't started yet could miss the signal */
+    flecs_wait_for_workers(world);
+
+    world->worker_task = action;
+    world->worker_task_ctx = ctx;
+
+    flecs_signal_workers(world);
+    action(world, &world->stages[0], ctx);
+    flecs_wait_for_sync(world);
+
+    world->worker_task = NULL;
+    world->worker_task_ctx = NULL;
+}
+
 /* -- Public functions -- */
 
+void ecs_set_worker_sched(
+    ecs_world_t *world,
+    ecs_worker_sched_kind_t kind)
+{
+    ecs_poly_assert(world, ecs_world_t);
+    ecs_check(!(world->flags & EcsWorldReadonly), ECS_INVALID_OPERATION, 
+        "cannot change scheduler while pipeline is running");
+
+    bool stealing = kind == EcsWorkerSchedStealing;
+    if (ECS_BIT_IS_SET(world->flags, EcsWorldWorkStealing) == stealing) {
+        return;
+    }
+
+    /* Workers read the scheduler kind when they start, so restart them */
+    int32_t threads = 0;
+    bool use_task_api = world->workers_use_task_api;
+    if (world->worker_cond) {
+        threads = ecs_get_stage_count(world);
+        flecs_set_threads_internal(world, 0, use_task_api);
+    }
+
+    ECS_BIT_COND(world->flags, EcsWorldWorkStealing, stealing);
+
+    if (threads) {
+        flecs_set_threads_internal(world, threads, use_task_api);
+    }
+error:
+    return;
+}
+
+ecs_worker_sched_kind_t ecs_get_worker_sched(
+    const ecs_world_t *world)
+{
+    ecs_poly_assert(world, ecs_world_t);
+    if (ECS_BIT_IS_SET(world->flags, EcsWorldWorkStealing)) {
+        return EcsWorkerSchedStealing;
+    }
+    return EcsWorkerSchedSlice;
+}
+
 void ecs_set_threads(
     ecs_world_t *world,
     int32_t threads)
@@ -62846,6 +70297,24 @@ typedef int16_t ecs_rule_lbl_t;
 typedef ecs_flags64_t ecs_write_flags_t;
 
 #define EcsRuleMaxVarCount      (64)
+
+/* A term is only evaluated before the term picked by the default term order
+ * if its estimated cost is both this many times and this much lower. This 
+ * keeps the plan stable for rules that match few entities. */
+#define EcsRulePlanCostFactor   (4)
+#define EcsRulePlanCostMin      (64)
+
+/* A rule is replanned if the table count of a term it was planned with grows
+ * or shrinks by more than this factor, and by more than this many tables. */
+#define EcsRulePlanDriftFactor  (2)
+#define EcsRulePlanDriftMin     (8)
+
+/* A term that finds the sources for a pair with a known target is evaluated
+ * with a join if it is expected to be evaluated at least this many times, and
+ * the number of pairs to index is less than this factor times that number. */
+#define EcsRuleJoinMinProbes    (16)
+#define EcsRuleJoinBuildFactor  (4)
+
 #define EcsVarNone              ((ecs_var_id_t)-1)
 #define EcsThisName             "this"
 
@@ -62883,7 +70352,10 @@ typedef enum {
     EcsRuleSelfUp,         /* Self|up traversal */
     EcsRuleSelfUpId,       /* Self|up traversal for fixed id (like AndId) */
     EcsRuleWith,           /* Match id against fixed or variable source */
+    EcsRuleWithIds,        /* Fused AndId instructions for written $this */
+    EcsRuleSelfUpWithIds,  /* Fused SelfUpId instructions for written $this */
     EcsRuleTrav,           /* Support for transitive/reflexive queries */
+    EcsRuleJoin,           /* Find sources for (R, $known) with hash index */
     EcsRuleIds,            /* Test for existence of ids matching wildcard */
     EcsRuleIdsRight,       /* Find ids in use that match (R, *) wildcard */
     EcsRuleIdsLeft,        /* Find ids in use that match (*, T) wildcard */
@@ -62955,6 +70427,17 @@ typedef struct {
     int16_t remaining;
 } ecs_rule_and_ctx_t;
 
+/* Join context. Stores an index of (R, *) pairs keyed by target, so that
+ * finding the sources for (R, $t) doesn't require a search per value of $t. */
+typedef struct {
+    ecs_map_t index;       /* map<target, (offset << 32) | count> */
+    ecs_vec_t sources;     /* vector<ecs_entity_t>, grouped by target */
+    ecs_id_record_t *idr;  /* Record for (R, $t) of current probe */
+    int32_t cur;
+    int32_t end;
+    bool built;
+} ecs_rule_join_ctx_t;
+
 /* Down traversal cache (for resolving up queries w/unknown source) */
 typedef struct {
     ecs_table_t *table;
@@ -63006,6 +70489,7 @@ typedef struct {
 typedef struct {
     ecs_id_t id;
     ecs_id_record_t *idr;
+    ecs_table_t *table; /* Only used for up traversal */
     ecs_vec_t entities;
     bool up;
 } ecs_trav_cache_t;
@@ -63060,6 +70544,7 @@ typedef struct ecs_rule_op_ctx_t {
         ecs_rule_and_ctx_t and;
         ecs_rule_up_ctx_t up;
         ecs_rule_trav_ctx_t trav;
+        ecs_rule_join_ctx_t join;
         ecs_rule_ids_ctx_t ids;
         ecs_rule_eq_ctx_t eq;
         ecs_rule_each_ctx_t each;
@@ -63090,6 +70575,8 @@ typedef struct {
 
     int32_t scope; /* Nesting level of query scopes */
     ecs_flags32_t scope_is_not; /* Whether scope is prefixed with not */
+
+    int64_t est_count; /* Estimated number of results for compiled terms */
 } ecs_rule_compile_ctx_t;
 
 /* Rule run state */
@@ -63111,6 +70598,30 @@ typedef struct {
     const char *name;
 } ecs_rule_var_cache_t;
 
+/* Header of a cached rule result. The header is followed by the ids, sources,
+ * variables and columns of the result. */
+typedef struct {
+    ecs_table_t *table;           /* $this table (NULL if result has no table) */
+    ecs_entity_t entity;          /* $this entity, 0 if result is entire table */
+    int32_t count;                /* Entity count for results without table */
+    bool dead;                    /* Set when table is deleted */
+} ecs_rule_cache_elem_t;
+
+/* Cached rule results (see EcsFilterCacheResults) */
+typedef struct {
+    ecs_vec_t results;            /* Results, elem_size bytes per result */
+    ecs_size_t elem_size;         /* Size of a single result */
+    ecs_size_t sources_offset;    /* Offsets of arrays in a single result */
+    ecs_size_t vars_offset;
+    ecs_size_t columns_offset;
+    int32_t var_count;            /* Number of stored variables */
+    ecs_map_t pending;            /* Tables created since last update */
+    ecs_vec_t observers;          /* vec<ecs_entity_t> */
+    bool table_local;             /* Can results be derived per $this table */
+    bool dirty;                   /* Do results need to be rederived */
+    bool updating;                /* Are results being derived */
+} ecs_rule_cache_t;
+
 struct ecs_rule_t {
     ecs_header_t hdr;             /* Poly header */
     ecs_filter_t filter;          /* Filter */
@@ -63119,6 +70630,7 @@ struct ecs_rule_t {
     ecs_rule_var_t *vars;         /* Variables */
     int32_t var_count;            /* Number of variables */
     int32_t var_pub_count;        /* Number of public variables */
+    int32_t var_discover_count;   /* Number of variables before compiling ops */
     bool has_table_this;          /* Does rule have [$this] */
     ecs_hashmap_t tvar_index;     /* Name index for table variables */
     ecs_hashmap_t evar_index;     /* Name index for entity variables */
@@ -63129,6 +70641,17 @@ struct ecs_rule_t {
     ecs_rule_op_t *ops;           /* Operations */
     int32_t op_count;             /* Number of operations */
 
+    /* Planning */
+    int32_t *plan_counts;         /* Table counts per term used for plan */
+    int32_t iter_count;           /* Number of active iterators */
+
+    /* Profiling */
+    ecs_rule_op_profile_t *profile; /* Accumulated profile of iterators */
+    int32_t profile_iter_count;   /* Number of iterators in profile */
+
+    /* Result cache */
+    ecs_rule_cache_t *cache;      /* Only set if EcsFilterCacheResults is set */
+
     /* Mixins */
     ecs_iterable_t iterable;
     ecs_poly_dtor_t dtor;
@@ -63165,6 +70688,34 @@ int flecs_rule_compile(
     ecs_stage_t *stage,
     ecs_rule_t *rule);
 
+/* Check if cardinalities drifted too far from the ones used to plan rule */
+bool flecs_rule_plan_is_stale(
+    const ecs_world_t *world,
+    const ecs_rule_t *rule);
+
+/* Compile operations of an already compiled rule with current cardinalities */
+int flecs_rule_replan(
+    ecs_world_t *world,
+    ecs_stage_t *stage,
+    ecs_rule_t *rule);
+
+/* Create result cache & observers for rule */
+void flecs_rule_cache_init(
+    ecs_world_t *world,
+    ecs_rule_t *rule);
+
+/* Free result cache & observers */
+void flecs_rule_cache_fini(
+    ecs_rule_t *rule);
+
+/* Bring cache up to date. Returns false if the cache can't be used */
+bool flecs_rule_cache_update(
+    ecs_rule_t *rule);
+
+/* Return next result from cache */
+bool flecs_rule_cache_next(
+    ecs_iter_t *it);
+
 /* Get allocator from iterator */
 ecs_allocator_t* flecs_rule_get_allocator(
     const ecs_iter_t *it);
@@ -63299,7 +70850,10 @@ const char* flecs_rule_op_str(
     case EcsRuleSelfUp:        return "selfup  ";
     case EcsRuleSelfUpId:      return "selfupid";
     case EcsRuleWith:          return "with    ";
+    case EcsRuleWithIds:       return "withids ";
+    case EcsRuleSelfUpWithIds: return "supwids ";
     case EcsRuleTrav:          return "trav    ";
+    case EcsRuleJoin:          return "join    ";
     case EcsRuleIds:           return "ids     ";
     case EcsRuleIdsRight:      return "idsr    ";
     case EcsRuleIdsLeft:       return "idsl    ";
@@ -63355,11 +70909,15 @@ static
 void flecs_rule_fini(
     ecs_rule_t *rule)
 {
+    flecs_rule_cache_fini(rule);
+
     if (rule->vars != &rule->vars_cache.var) {
         ecs_os_free(rule->vars);
     }
 
     ecs_os_free(rule->ops);
+    ecs_os_free(rule->plan_counts);
+    ecs_os_free(rule->profile);
     ecs_os_free(rule->src_vars);
     flecs_name_index_fini(&rule->tvar_index);
     flecs_name_index_fini(&rule->evar_index);
@@ -63396,11 +70954,18 @@ ecs_rule_t* ecs_rule_init(
 
     result->iterable.init = flecs_rule_iter_mixin_init;
 
+    /* Make sure table cache is up to date, as the plan uses table counts */
+    ecs_run_aperiodic(world, EcsAperiodicEmptyTables);
+
     /* Compile filter to operations */
     if (flecs_rule_compile(world, stage, result)) {
         goto error;
     }
 
+    if (result->filter.flags & EcsFilterCacheResults) {
+        flecs_rule_cache_init(world, result);
+    }
+
     ecs_entity_t entity = const_desc->entity;
     result->dtor = (ecs_poly_dtor_t)flecs_rule_fini;
 
@@ -63463,9 +71028,10 @@ int32_t flecs_rule_op_ref_str(
     return color_chars;
 }
 
-char* ecs_rule_str_w_profile(
+static
+char* flecs_rule_str(
     const ecs_rule_t *rule,
-    const ecs_iter_t *it)
+    const ecs_rule_op_profile_t *profile)
 {
     ecs_poly_assert(rule, ecs_rule_t);
 
@@ -63480,14 +71046,13 @@ char* ecs_rule_str_w_profile(
         ecs_flags16_t first_flags = flecs_rule_ref_flags(flags, EcsRuleFirst);
         ecs_flags16_t second_flags = flecs_rule_ref_flags(flags, EcsRuleSecond);
 
-        if (it) {
-#ifdef FLECS_DEBUG
-            const ecs_rule_iter_t *rit = &it->priv.iter.rule;
+        if (profile) {
             ecs_strbuf_append(&buf, 
-                "#[green]%4d -> #[red]%4d <- #[grey]  |   ",
-                rit->profile[i].count[0],
-                rit->profile[i].count[1]);
-#endif
+                "#[green]%4d -> #[red]%4d <- #[blue]%4d * #[grey]%8.2fus  |   ",
+                profile[i].count[0],
+                profile[i].count[1],
+                profile[i].match_count,
+                profile[i].time_spent * 1000.0 * 1000.0);
         }
 
         ecs_strbuf_append(&buf, 
@@ -63575,10 +71140,42 @@ char* ecs_rule_str_w_profile(
     return ecs_strbuf_get(&buf);
 }
 
+char* ecs_rule_str_w_profile(
+    const ecs_rule_t *rule,
+    const ecs_iter_t *it)
+{
+    ecs_poly_assert(rule, ecs_rule_t);
+    if (it) {
+        return flecs_rule_str(rule, it->priv.iter.rule.profile);
+    } else {
+        return flecs_rule_str(rule, rule->profile);
+    }
+}
+
 char* ecs_rule_str(
     const ecs_rule_t *rule)
 {
-    return ecs_rule_str_w_profile(rule, NULL);
+    return flecs_rule_str(rule, NULL);
+}
+
+ecs_rule_profile_t ecs_rule_get_profile(
+    const ecs_rule_t *rule)
+{
+    ecs_poly_assert(rule, ecs_rule_t);
+    return (ecs_rule_profile_t){
+        .ops = rule->profile,
+        .op_count = rule->profile ? rule->op_count : 0,
+        .iter_count = rule->profile_iter_count
+    };
+}
+
+void ecs_rule_reset_profile(
+    ecs_rule_t *rule)
+{
+    ecs_poly_assert(rule, ecs_rule_t);
+    ecs_os_free(rule->profile);
+    rule->profile = NULL;
+    rule->profile_iter_count = 0;
 }
 
 const ecs_filter_t* ecs_rule_get_filter(
@@ -63686,6 +71283,694 @@ error:
 
 #endif
 
+/**
+ * @file addons/rules/cache.c
+ * @brief Cache that stores the results of a rule.
+ *
+ * Rules created with EcsFilterCacheResults store their results, so that
+ * iterating the rule replays the stored results instead of evaluating the rule
+ * program. The cache is kept up to date with observers on the ids of the rule:
+ *
+ * - For rules for which the result only depends on the type of the $this
+ *   table, new tables are matched by evaluating the rule for just that table,
+ *   and deleted tables are removed from the cache.
+ * - Changes to entities that can be reached through traversal (like parents or
+ *   prefabs), or that are used as sources or variables by the rule invalidate
+ *   the cache, which causes it to be rederived on the next iteration.
+ *
+ * Results store entire tables, so adding entities to or removing entities from
+ * already matched tables does not invalidate the cache.
+ */
+
+
+#ifdef FLECS_RULES
+
+/* Kinds of events a rule cache observes for an id */
+#define EcsRuleCacheTableEvents  (1u << 0u) /* Table created/deleted */
+#define EcsRuleCacheEntityEvents (1u << 1u) /* Id added to/removed from entity */
+#define EcsRuleCacheTravEvents   (1u << 2u) /* Same, for traversable entities */
+#define EcsRuleCacheFillEvents   (1u << 3u) /* Table became non-empty */
+
+typedef struct {
+    ecs_id_t id;
+    ecs_flags32_t events;
+} ecs_rule_cache_observe_t;
+
+#define FLECS_RULE_CACHE_OBSERVE_MAX (FLECS_TERM_DESC_MAX * 4)
+
+typedef struct {
+    ecs_rule_cache_observe_t ids[FLECS_RULE_CACHE_OBSERVE_MAX];
+    int32_t count;
+} ecs_rule_cache_observe_list_t;
+
+static
+void flecs_rule_cache_observe(
+    ecs_rule_cache_observe_list_t *list,
+    ecs_id_t id,
+    ecs_flags32_t events)
+{
+    int32_t i;
+    for (i = 0; i < list->count; i ++) {
+        if (list->ids[i].id == id) {
+            list->ids[i].events |= events;
+            return;
+        }
+    }
+
+    ecs_assert(list->count < FLECS_RULE_CACHE_OBSERVE_MAX,
+        ECS_INTERNAL_ERROR, NULL);
+    list->ids[list->count].id = id;
+    list->ids[list->count].events = events;
+    list->count ++;
+}
+
+/* Find ids for which the cache needs to observe events. Returns false if the
+ * rule cannot be cached, in which case it is evaluated as a regular rule. */
+static
+bool flecs_rule_cache_find_ids(
+    ecs_world_t *world,
+    ecs_rule_t *rule,
+    ecs_rule_cache_observe_list_t *list,
+    bool *table_local_out)
+{
+    const ecs_filter_t *filter = &rule->filter;
+    ecs_flags32_t flags = filter->flags;
+    if (filter->term_count > FLECS_TERM_DESC_MAX) {
+        return false;
+    }
+
+    /* Results that depend on names or on sparse storage are not tracked */
+    if (flags & (EcsFilterHasPred|EcsFilterHasSparse)) {
+        return false;
+    }
+
+    bool table_local = !(flags & EcsFilterHasScopes);
+    bool has_match = false;
+    int32_t i, count = filter->term_count;
+
+    for (i = 0; i < count; i ++) {
+        ecs_term_t *term = &filter->terms[i];
+        ecs_entity_t first = term->first.id;
+        if (first == EcsScopeOpen || first == EcsScopeClose) {
+            continue;
+        }
+
+        ecs_oper_kind_t oper = term->oper;
+        if (oper == EcsAndFrom || oper == EcsOrFrom || oper == EcsNotFrom) {
+            return false;
+        }
+        if (oper == EcsAnd || oper == EcsOr) {
+            has_match = true;
+        }
+
+        /* Variables and the any wildcard can match any id */
+        ecs_id_t id = term->id;
+        if (ECS_IS_PAIR(id)) {
+            ecs_entity_t rel = ECS_PAIR_FIRST(id);
+            ecs_entity_t tgt = ECS_PAIR_SECOND(id);
+            if (rel == EcsAny || (term->first.flags & EcsIsVariable)) {
+                rel = EcsWildcard;
+            }
+            if (tgt == EcsAny || (term->second.flags & EcsIsVariable)) {
+                tgt = EcsWildcard;
+            }
+            if (rel != EcsWildcard) {
+                /* Union results are ranges within a table */
+                ecs_entity_t e = flecs_entities_get_alive(world, rel);
+                if (e && ecs_has_id(world, e, EcsUnion)) {
+                    return false;
+                }
+            }
+
+            /* For transitive relationships a target can match through the
+             * relationships of the target, which can be modified without
+             * creating or deleting tables. */
+            if (rel != EcsWildcard && ((term->flags & EcsTermTransitive) ||
+                (term->second.flags & EcsUp)))
+            {
+                flecs_rule_cache_observe(list, ecs_pair(rel, EcsWildcard),
+                    EcsRuleCacheTravEvents);
+            }
+
+            if ((term->second.flags & EcsIsVariable) &&
+                (term->second.id == EcsThis))
+            {
+                table_local = false;
+            }
+
+            id = ecs_pair(rel, tgt);
+        } else if (id == EcsWildcard || id == EcsAny ||
+            (term->first.flags & EcsIsVariable))
+        {
+            return false;
+        }
+
+        flecs_rule_cache_observe(list, id, EcsRuleCacheTableEvents);
+
+        if (!ecs_term_match_this(term) || (term->flags &
+            (EcsTermSrcFirstEq|EcsTermSrcSecondEq|EcsTermReflexive)))
+        {
+            table_local = false;
+        }
+
+        /* If an id is matched through traversal, the result depends on the
+         * entities that are traversed. */
+        ecs_entity_t trav = 0;
+        if (term->src.flags & EcsUp) {
+            trav = term->src.trav;
+        } else if (term->flags & EcsTermIdInherited) {
+            trav = EcsIsA;
+        }
+        if (trav) {
+            flecs_rule_cache_observe(list, id, EcsRuleCacheTravEvents);
+            flecs_rule_cache_observe(list, ecs_pair(trav, EcsWildcard),
+                EcsRuleCacheTableEvents|EcsRuleCacheTravEvents|
+                EcsRuleCacheFillEvents);
+        }
+    }
+
+    /* New tables are matched through the ids of terms that must match. Rules
+     * with only Not or Optional terms could match tables with any id. */
+    if (!has_match) {
+        return false;
+    }
+
+    /* If results don't only depend on the $this table, any change to an
+     * observed id can change the results. */
+    if (!table_local) {
+        for (i = 0; i < list->count; i ++) {
+            list->ids[i].events |= EcsRuleCacheEntityEvents;
+        }
+    }
+
+    *table_local_out = table_local;
+    return true;
+}
+
+/* Mark results for table as dead. Results are removed on the next update. */
+static
+void flecs_rule_cache_remove_table(
+    ecs_rule_cache_t *cache,
+    ecs_table_t *table)
+{
+    int32_t i, count = ecs_vec_count(&cache->results);
+    for (i = 0; i < count; i ++) {
+        ecs_rule_cache_elem_t *elem = ecs_vec_get(
+            &cache->results, cache->elem_size, i);
+        if (elem->table == table && !elem->entity) {
+            elem->dead = true;
+        }
+    }
+
+    if (ecs_map_is_init(&cache->pending)) {
+        ecs_map_remove(&cache->pending, table->id);
+    }
+}
+
+/* Evaluate rule for table on the next update */
+static
+void flecs_rule_cache_add_pending(
+    ecs_rule_cache_t *cache,
+    ecs_table_t *table)
+{
+    ecs_map_init_if(&cache->pending, NULL);
+    ecs_map_ensure_ref(&cache->pending, ecs_table_t, table->id)[0] = table;
+}
+
+static
+void flecs_rule_cache_on_table(
+    ecs_iter_t *it)
+{
+    ecs_rule_t *rule = it->ctx;
+    if (!rule) {
+        return;
+    }
+
+    ecs_rule_cache_t *cache = rule->cache;
+    ecs_table_t *table = it->table;
+
+    if (it->event == EcsOnTableCreate) {
+        if (!cache->table_local) {
+            cache->dirty = true;
+        } else if (!cache->dirty) {
+            flecs_rule_cache_add_pending(cache, table);
+        }
+    } else if (it->event == EcsOnTableDelete) {
+        flecs_rule_cache_remove_table(cache, table);
+        if (!cache->table_local) {
+            cache->dirty = true;
+        }
+    } else if (it->event == EcsOnTableFill) {
+        /* Traversal only finds tables that aren't empty, so reevaluate tables
+         * that were empty when results were last updated. */
+        if (!cache->table_local) {
+            cache->dirty = true;
+        } else if (!cache->dirty) {
+            flecs_rule_cache_remove_table(cache, table);
+            flecs_rule_cache_add_pending(cache, table);
+        }
+    }
+}
+
+static
+void flecs_rule_cache_on_entity(
+    ecs_iter_t *it)
+{
+    ecs_rule_t *rule = it->ctx;
+    if (rule) {
+        rule->cache->dirty = true;
+    }
+}
+
+static
+void flecs_rule_cache_on_trav(
+    ecs_iter_t *it)
+{
+    ecs_rule_t *rule = it->ctx;
+    if (!rule || rule->cache->dirty) {
+        return;
+    }
+
+    /* Only entities that are used as relationship target can change the
+     * results of other tables */
+    ecs_world_t *world = it->real_world;
+    int32_t i;
+    for (i = 0; i < it->count; i ++) {
+        if (flecs_id_record_get(world, ecs_pair(EcsWildcard, it->entities[i]))) {
+            rule->cache->dirty = true;
+            break;
+        }
+    }
+}
+
+static
+void flecs_rule_cache_observer_init(
+    ecs_world_t *world,
+    ecs_rule_t *rule,
+    ecs_id_t id,
+    ecs_iter_action_t callback,
+    ecs_entity_t event_1,
+    ecs_entity_t event_2)
+{
+    ecs_entity_t o = ecs_observer(world, {
+        .filter = {
+            .terms = {{
+                .id = id,
+                .src.flags = EcsSelf,
+                .inout = EcsInOutNone
+            }},
+            /* Prefabs and disabled entities can be matched by traversal */
+            .flags = EcsFilterNoData|EcsFilterMatchPrefab|
+                EcsFilterMatchDisabled
+        },
+        .events = { event_1, event_2 },
+        .callback = callback,
+        .ctx = rule
+    });
+
+    ecs_assert(o != 0, ECS_INTERNAL_ERROR, NULL);
+    ecs_vec_append_t(NULL, &rule->cache->observers, ecs_entity_t)[0] = o;
+}
+
+void flecs_rule_cache_init(
+    ecs_world_t *world,
+    ecs_rule_t *rule)
+{
+    ecs_rule_cache_observe_list_t list = {0};
+    bool table_local = false;
+    if (!flecs_rule_cache_find_ids(world, rule, &list, &table_local)) {
+        ecs_dbg_1("#[yellow]rule#[reset] results can't be cached");
+        return;
+    }
+
+    ecs_rule_cache_t *cache = rule->cache = ecs_os_calloc_t(ecs_rule_cache_t);
+    cache->table_local = table_local;
+    cache->dirty = true;
+
+    /* Result layout: header, ids, sources, variables, columns */
+    /* Anonymous variables can change when the rule is replanned, so only
+     * store public variables. The first variable ($this) is always stored as
+     * it contains the entity for results without a table. */
+    int32_t field_count = rule->filter.field_count;
+    int32_t var_count = rule->var_pub_count;
+    if (!var_count && rule->var_count) {
+        var_count = 1;
+    }
+    cache->var_count = var_count;
+
+    ecs_size_t size = ECS_SIZEOF(ecs_rule_cache_elem_t);
+    size += field_count * ECS_SIZEOF(ecs_id_t);
+    cache->sources_offset = size;
+    size += field_count * ECS_SIZEOF(ecs_entity_t);
+    cache->vars_offset = size;
+    size += var_count * ECS_SIZEOF(ecs_var_t);
+    cache->columns_offset = size;
+    size += field_count * ECS_SIZEOF(int32_t);
+    cache->elem_size = ECS_ALIGN(size, ECS_SIZEOF(void*));
+
+    ecs_vec_init(NULL, &cache->results, cache->elem_size, 0);
+    ecs_vec_init_t(NULL, &cache->observers, ecs_entity_t, 0);
+
+    int32_t i;
+    for (i = 0; i < list.count; i ++) {
+        ecs_id_t id = list.ids[i].id;
+        ecs_flags32_t events = list.ids[i].events;
+        if (events & EcsRuleCacheTableEvents) {
+            flecs_rule_cache_observer_init(world, rule, id,
+                flecs_rule_cache_on_table, EcsOnTableCreate, EcsOnTableDelete);
+        }
+        if (events & EcsRuleCacheFillEvents) {
+            flecs_rule_cache_observer_init(world, rule, id,
+                flecs_rule_cache_on_table, EcsOnTableFill, 0);
+        }
+        if (events & EcsRuleCacheEntityEvents) {
+            flecs_rule_cache_observer_init(world, rule, id,
+                flecs_rule_cache_on_entity, EcsOnAdd, EcsOnRemove);
+        } else if (events & EcsRuleCacheTravEvents) {
+            flecs_rule_cache_observer_init(world, rule, id,
+                flecs_rule_cache_on_trav, EcsOnAdd, EcsOnRemove);
+        }
+    }
+}
+
+void flecs_rule_cache_fini(
+    ecs_rule_t *rule)
+{
+    ecs_rule_cache_t *cache = rule->cache;
+    if (!cache) {
+        return;
+    }
+
+    ecs_world_t *world = rule->filter.world;
+    int32_t i, count = ecs_vec_count(&cache->observers);
+    ecs_entity_t *observers = ecs_vec_first(&cache->observers);
+    for (i = 0; i < count; i ++) {
+        ecs_entity_t o = observers[i];
+        if (!ecs_is_alive(world, o)) {
+            continue;
+        }
+
+        /* Observer could outlive the rule if the delete is deferred */
+        ecs_observer_t *poly = ecs_poly_get(world, o, ecs_observer_t);
+        if (poly) {
+            poly->ctx = NULL;
+        }
+        ecs_delete(world, o);
+    }
+
+    ecs_vec_fini_t(NULL, &cache->observers, ecs_entity_t);
+    ecs_vec_fini(NULL, &cache->results, cache->elem_size);
+    ecs_map_fini(&cache->pending);
+    ecs_os_free(cache);
+    rule->cache = NULL;
+}
+
+/* Store current result of iterator in cache */
+static
+bool flecs_rule_cache_append(
+    ecs_rule_cache_t *cache,
+    const ecs_iter_t *it)
+{
+    ecs_table_t *table = NULL;
+    ecs_entity_t entity = 0;
+    if (cache->var_count) {
+        const ecs_var_t *this_var = &it->priv.iter.rule.vars[0];
+        table = this_var->range.table;
+        entity = this_var->entity;
+        if (entity == EcsWildcard) {
+            entity = 0;
+        }
+    }
+
+    if (table && !entity) {
+        /* Only results for entire tables can be stored, as table ranges can
+         * change without creating or deleting tables. */
+        if (it->offset || (it->count != ecs_table_count(table))) {
+            return false;
+        }
+    }
+
+    ecs_rule_cache_elem_t *elem = ecs_vec_append(
+        NULL, &cache->results, cache->elem_size);
+    int32_t field_count = it->field_count;
+    elem->table = table;
+    elem->entity = entity;
+    elem->count = it->count;
+    elem->dead = false;
+
+    ecs_os_memcpy_n(ECS_OFFSET(elem, ECS_SIZEOF(ecs_rule_cache_elem_t)),
+        it->ids, ecs_id_t, field_count);
+    ecs_os_memcpy_n(ECS_OFFSET(elem, cache->sources_offset),
+        it->sources, ecs_entity_t, field_count);
+    ecs_os_memcpy_n(ECS_OFFSET(elem, cache->vars_offset),
+        it->priv.iter.rule.vars, ecs_var_t, cache->var_count);
+    ecs_os_memcpy_n(ECS_OFFSET(elem, cache->columns_offset),
+        it->columns, int32_t, field_count);
+    return true;
+}
+
+/* Evaluate rule and store the results. If table is set, only results for that
+ * table are evaluated. */
+static
+bool flecs_rule_cache_populate(
+    ecs_rule_t *rule,
+    ecs_table_t *table)
+{
+    ecs_rule_cache_t *cache = rule->cache;
+    ecs_world_t *world = rule->filter.world;
+    bool result = true;
+
+    /* Results are stored for empty tables so that tables becoming empty or
+     * non-empty don't invalidate the cache. Empty tables are skipped when the
+     * results are iterated. */
+    ecs_flags32_t filter_flags = rule->filter.flags;
+    rule->filter.flags |= EcsFilterMatchEmptyTables;
+    cache->updating = true;
+
+    ecs_iter_t it = ecs_rule_iter(world, rule);
+    ECS_BIT_SET(it.flags, EcsIterNoData);
+    if (table) {
+        ecs_iter_set_var_as_table(&it, 0, table);
+    }
+
+    while (ecs_rule_next_instanced(&it)) {
+        if (!flecs_rule_cache_append(cache, &it)) {
+            ecs_iter_fini(&it);
+            result = false;
+            break;
+        }
+    }
+
+    cache->updating = false;
+    rule->filter.flags = filter_flags;
+    return result;
+}
+
+bool flecs_rule_cache_update(
+    ecs_rule_t *rule)
+{
+    ecs_rule_cache_t *cache = rule->cache;
+    if (!cache || cache->updating) {
+        return false;
+    }
+
+    /* Results can't be modified while they are being iterated */
+    if (rule->iter_count || (rule->filter.world->flags & EcsWorldReadonly)) {
+        return !cache->dirty && !ecs_map_count(&cache->pending);
+    }
+
+    /* Make sure table fill events are delivered before results are updated */
+    flecs_process_pending_tables(rule->filter.world);
+
+    if (cache->dirty) {
+        ecs_vec_clear(&cache->results);
+        if (ecs_map_is_init(&cache->pending)) {
+            ecs_map_clear(&cache->pending);
+        }
+        if (!flecs_rule_cache_populate(rule, NULL)) {
+            goto disable;
+        }
+        cache->dirty = false;
+        return true;
+    }
+
+    /* Remove results for deleted tables */
+    int32_t i, count = ecs_vec_count(&cache->results);
+    ecs_size_t elem_size = cache->elem_size;
+    int32_t dst = 0;
+    for (i = 0; i < count; i ++) {
+        ecs_rule_cache_elem_t *elem = ecs_vec_get(
+            &cache->results, elem_size, i);
+        if (elem->dead) {
+            continue;
+        }
+        if (dst != i) {
+            ecs_os_memcpy(ecs_vec_get(&cache->results, elem_size, dst),
+                elem, elem_size);
+        }
+        dst ++;
+    }
+    ecs_vec_set_count(NULL, &cache->results, elem_size, dst);
+
+    /* Add results for tables created since the last update */
+    if (ecs_map_count(&cache->pending)) {
+        ecs_map_iter_t pit = ecs_map_iter(&cache->pending);
+        while (ecs_map_next(&pit)) {
+            ecs_table_t *table = ecs_map_ptr(&pit);
+            if (!flecs_rule_cache_populate(rule, table)) {
+                goto disable;
+            }
+        }
+        ecs_map_clear(&cache->pending);
+    }
+
+    return true;
+disable:
+    /* Rule produced results that can't be cached, evaluate it regularly */
+    ecs_dbg_1("#[yellow]rule#[reset] results can't be cached");
+    flecs_rule_cache_fini(rule);
+    return false;
+}
+
+bool flecs_rule_cache_next(
+    ecs_iter_t *it)
+{
+    ecs_rule_iter_t *rit = &it->priv.iter.rule;
+    const ecs_rule_t *rule = rit->rule;
+    ecs_rule_cache_t *cache = rule->cache;
+    ecs_world_t *world = it->real_world;
+    const ecs_filter_t *filter = &rule->filter;
+    int32_t field_count = filter->field_count;
+    int32_t i, var_count = cache->var_count;
+    bool match_empty = filter->flags & EcsFilterMatchEmptyTables;
+
+    if (!(it->flags & EcsIterIsValid)) {
+        rit->cache_index = 0;
+        flecs_iter_validate(it);
+    } else {
+        it->frame_offset += it->count;
+    }
+
+    int32_t count = ecs_vec_count(&cache->results);
+    while (rit->cache_index < count) {
+        ecs_rule_cache_elem_t *elem = ecs_vec_get(
+            &cache->results, cache->elem_size, rit->cache_index ++);
+        if (elem->dead) {
+            continue;
+        }
+
+        ecs_table_t *table = elem->table;
+        int32_t offset = 0, row_count = elem->count;
+        if (elem->entity) {
+            ecs_record_t *r = flecs_entities_get(world, elem->entity);
+            if (!r || !r->table) {
+                continue;
+            }
+            table = r->table;
+            offset = ECS_RECORD_TO_ROW(r->row);
+            row_count = 1;
+        } else if (table) {
+            row_count = ecs_table_count(table);
+            if (!row_count && !match_empty) {
+                continue;
+            }
+        }
+
+        ecs_os_memcpy_n(it->ids, ECS_OFFSET(elem,
+            ECS_SIZEOF(ecs_rule_cache_elem_t)), ecs_id_t, field_count);
+        ecs_os_memcpy_n(it->sources, ECS_OFFSET(elem, cache->sources_offset),
+            ecs_entity_t, field_count);
+        ecs_os_memcpy_n(rit->vars, ECS_OFFSET(elem, cache->vars_offset),
+            ecs_var_t, var_count);
+        ecs_os_memcpy_n(it->columns, ECS_OFFSET(elem, cache->columns_offset),
+            int32_t, field_count);
+
+        /* Entities may have moved to another table or row since the results
+         * were stored. */
+        for (i = 0; i < var_count; i ++) {
+            ecs_var_t *var = &rit->vars[i];
+            if (!var->range.table || !var->entity ||
+                var->entity == EcsWildcard)
+            {
+                continue;
+            }
+            ecs_record_t *r = flecs_entities_get(world, var->entity);
+            if (r && r->table) {
+                var->range.table = r->table;
+                var->range.offset = ECS_RECORD_TO_ROW(r->row);
+                var->range.count = 1;
+            }
+        }
+
+        it->table = table;
+        it->offset = offset;
+        it->count = row_count;
+        if (table) {
+            it->entities = ECS_ELEM_T(
+                table->data.entities.array, ecs_entity_t, offset);
+        } else if (row_count == 1 && var_count) {
+            it->entities = &rit->vars[0].entity;
+        } else {
+            it->entities = NULL;
+        }
+
+        if (it->flags & EcsIterNoData) {
+            return true;
+        }
+
+        ECS_BIT_CLEAR(it->flags, EcsIterHasShared);
+        ecs_flags64_t data_fields = filter->data_fields;
+        for (i = 0; i < field_count; i ++) {
+            it->ptrs[i] = NULL;
+            int32_t column = it->columns[i];
+            if (!column) {
+                continue;
+            }
+
+            ecs_entity_t src = it->sources[i];
+            if (!src) {
+                if (!(data_fields & (1llu << i))) {
+                    continue;
+                }
+                if (row_count && table->column_map) {
+                    int32_t storage_column = table->column_map[column - 1];
+                    if (storage_column != -1) {
+                        it->ptrs[i] = ECS_ELEM(
+                            table->data.columns[storage_column].data.array,
+                            it->sizes[i], offset);
+                    }
+                }
+                continue;
+            }
+
+            /* Source can have moved to another table, find column again */
+            ecs_record_t *r = flecs_entities_get(world, src);
+            if (!r || !r->table) {
+                continue;
+            }
+            const ecs_table_record_t *tr = flecs_table_record_get(
+                world, r->table, it->ids[i]);
+            if (!tr) {
+                continue;
+            }
+
+            it->columns[i] = tr->index + 1;
+            if ((data_fields & (1llu << i)) && tr->column != -1) {
+                it->ptrs[i] = ecs_vec_get(
+                    &r->table->data.columns[tr->column].data,
+                    it->sizes[i], ECS_RECORD_TO_ROW(r->row));
+                ECS_BIT_SET(it->flags, EcsIterHasShared);
+            }
+        }
+
+        return true;
+    }
+
+    return false;
+}
+
+#endif
+
 /**
  * @file addons/rules/compile.c
  * @brief Compile rule program from filter.
@@ -65075,6 +73360,106 @@ bool flecs_rule_term_is_or(
     return (term->oper == EcsOr) || (!first_term && term[-1].oper == EcsOr);
 }
 
+/* Count the number of (R, *) pairs a join for relationship R has to index */
+static
+int64_t flecs_rule_join_build_count(
+    const ecs_world_t *world,
+    ecs_entity_t rel)
+{
+    ecs_id_record_t *idr = flecs_id_record_get(world, 
+        ecs_pair(rel, EcsWildcard));
+    if (!idr) {
+        return 0;
+    }
+
+    int64_t count = 0;
+    ecs_table_cache_iter_t it;
+    if (flecs_table_cache_iter(&idr->cache, &it)) {
+        const ecs_table_record_t *tr;
+        while ((tr = flecs_table_cache_next(&it, ecs_table_record_t))) {
+            count += ecs_table_count(tr->hdr.table) * tr->count;
+        }
+    }
+
+    return count;
+}
+
+/* Check if term should be evaluated with a join. Terms like (R, $t) with an 
+ * unknown source and known target are normally evaluated by looking up the 
+ * tables for (R, t) each time the term is evaluated. When the term is expected
+ * to be evaluated many times, it is cheaper to index all (R, *) pairs once,
+ * after which each evaluation is a single lookup. */
+static
+bool flecs_rule_term_use_join(
+    ecs_world_t *world,
+    ecs_rule_t *rule,
+    ecs_term_t *term,
+    ecs_rule_op_t *op,
+    ecs_rule_compile_ctx_t *ctx,
+    bool src_written,
+    bool second_written)
+{
+    if (op->kind != EcsRuleAnd || term->oper != EcsAnd) {
+        return false;
+    }
+
+    if (flecs_rule_term_is_or(&rule->filter, term) || ctx->cond_written) {
+        return false;
+    }
+
+    if (term->flags & (EcsTermIdInherited|EcsTermTransitive|
+        EcsTermMatchAny|EcsTermMatchAnySrc)) 
+    {
+        return false;
+    }
+
+    /* Relationship must be known, target must be a written variable */
+    if (!(term->first.flags & EcsIsEntity) || !second_written) {
+        return false;
+    }
+
+    if (flecs_term_id_is_wildcard(&term->src) || 
+        flecs_term_id_is_wildcard(&term->second)) 
+    {
+        return false;
+    }
+
+    const char *src_name = flecs_term_id_var_name(&term->src);
+    const char *second_name = flecs_term_id_var_name(&term->second);
+    if (!src_name || !second_name || src_written) {
+        return false;
+    }
+
+    /* Join yields entities, which doesn't work for the $this table variable */
+    if (term->src.id == EcsThis || !ecs_os_strcmp(src_name, second_name)) {
+        return false;
+    }
+
+    ecs_var_id_t evar = flecs_rule_find_var_id(rule, src_name, EcsVarEntity);
+    if (evar == EcsVarNone || rule->vars[evar].lookup) {
+        return false;
+    }
+
+    if (flecs_rule_is_written(evar, ctx->written)) {
+        return false;
+    }
+
+    if (ctx->est_count < EcsRuleJoinMinProbes) {
+        return false;
+    }
+
+    int64_t build_count = flecs_rule_join_build_count(world, term->first.id);
+    if (!build_count || 
+        (build_count > (ctx->est_count * EcsRuleJoinBuildFactor))) 
+    {
+        return false;
+    }
+
+    op->kind = EcsRuleJoin;
+    op->src.var = evar;
+    return true;
+}
+
 static
 int flecs_rule_compile_term(
     ecs_world_t *world,
@@ -65307,6 +73692,14 @@ int flecs_rule_compile_term(
         }
     }
 
+    /* If the term is expected to be evaluated many times for different values
+     * of its target, replace searching for the source with a join. */
+    if (flecs_rule_term_use_join(world, rule, term, &op, ctx, 
+        src_written, second_written))
+    {
+        src_var = op.src.var;
+    }
+
     /* Check if this term has variables that have been conditionally written,
      * like variables written by an optional term. */
     if (ctx->cond_written) {
@@ -65561,6 +73954,216 @@ int32_t flecs_rule_term_next_known(
     return -1;
 }
 
+/* Returns whether term can be evaluated in a different order than specified */
+static
+bool flecs_rule_term_can_reorder(
+    ecs_rule_t *rule,
+    ecs_term_t *term)
+{
+    if (term->oper != EcsAnd || flecs_rule_term_is_or(&rule->filter, term)) {
+        return false;
+    }
+
+    if (flecs_rule_is_builtin_pred(term)) {
+        return false;
+    }
+
+    /* Whether $this is a table or entity variable depends on whether it's
+     * first used as source or as (pair) id, so don't move terms that use it
+     * as id or that could change its first use. */
+    if (!rule->has_table_this) {
+        return false;
+    }
+    if (term->first.id == EcsThis && (term->first.flags & EcsIsVariable)) {
+        return false;
+    }
+    if (term->second.id == EcsThis && (term->second.flags & EcsIsVariable)) {
+        return false;
+    }
+
+    return true;
+}
+
+/* Get number of non-empty tables for id. Used to detect whether cardinalities
+ * changed since a rule was planned. */
+static
+int32_t flecs_rule_plan_table_count(
+    const ecs_world_t *world,
+    ecs_id_t id)
+{
+    ecs_id_record_t *idr = flecs_id_record_get(world, id);
+    if (!idr) {
+        return 0;
+    }
+    return idr->cache.tables.count;
+}
+
+/* Estimate the number of results a term yields given the variables that have
+ * been written so far. Terms for which all variables are known only filter
+ * results and have no cost. For terms that find a source the cost is the 
+ * number of matching tables (for table variables) or entities (for entity 
+ * variables). Unknown variables in the id multiply the cost by the average 
+ * number of times the id occurs in a matching table. */
+static
+int64_t flecs_rule_term_cost(
+    ecs_world_t *world,
+    ecs_rule_t *rule,
+    ecs_term_t *term,
+    ecs_rule_compile_ctx_t *ctx)
+{
+    ecs_rule_op_t dummy = {0};
+    flecs_rule_compile_term_id(NULL, rule, &dummy, &term->first, 
+        &dummy.first, EcsRuleFirst, EcsVarEntity, ctx, false);
+    flecs_rule_compile_term_id(NULL, rule, &dummy, &term->second, 
+        &dummy.second, EcsRuleSecond, EcsVarEntity, ctx, false);
+    flecs_rule_compile_term_id(NULL, rule, &dummy, &term->src, 
+        &dummy.src, EcsRuleSrc, EcsVarAny, ctx, false);
+
+    bool src_unknown = (dummy.flags & (EcsRuleIsVar << EcsRuleSrc)) &&
+        flecs_rule_var_is_unknown(rule, dummy.src.var, ctx);
+    bool id_unknown = 
+        ((dummy.flags & (EcsRuleIsVar << EcsRuleFirst)) &&
+            flecs_rule_var_is_unknown(rule, dummy.first.var, ctx)) ||
+        ((dummy.flags & (EcsRuleIsVar << EcsRuleSecond)) &&
+            flecs_rule_var_is_unknown(rule, dummy.second.var, ctx));
+
+    if (!src_unknown && !id_unknown) {
+        return 0;
+    }
+
+    ecs_id_record_t *idr = flecs_id_record_get(world, term->id);
+    if (!idr) {
+        /* Nothing matches the term, evaluating it first ends search early */
+        return 0;
+    }
+
+    int64_t table_count = 0, entity_count = 0, id_count = 0;
+    ecs_table_cache_iter_t it;
+    if (flecs_table_cache_iter(&idr->cache, &it)) {
+        const ecs_table_record_t *tr;
+        while ((tr = flecs_table_cache_next(&it, ecs_table_record_t))) {
+            table_count ++;
+            entity_count += ecs_table_count(tr->hdr.table);
+            id_count += tr->count;
+        }
+    }
+
+    if (!table_count) {
+        return 0;
+    }
+
+    int64_t fanout = 1;
+    if (id_unknown) {
+        fanout = (id_count + table_count - 1) / table_count;
+    }
+
+    if (!src_unknown) {
+        return fanout;
+    }
+
+    if (rule->vars[dummy.src.var].kind == EcsVarTable) {
+        return table_count * fanout;
+    } else {
+        return entity_count * fanout;
+    }
+}
+
+/* Find the term to compile next. Starts from the term picked by the default 
+ * order, which evaluates terms in the order they were specified, but prefers 
+ * known over unknown terms. If another term that can be evaluated at this 
+ * point is significantly cheaper given the current cardinalities in the 
+ * world, it is evaluated first. */
+static
+int32_t flecs_rule_term_next(
+    ecs_world_t *world,
+    ecs_rule_t *rule, 
+    ecs_rule_compile_ctx_t *ctx,
+    int32_t offset,
+    ecs_flags64_t compiled)
+{
+    ecs_filter_t *filter = &rule->filter;
+    ecs_term_t *terms = filter->terms;
+    int32_t i, count = filter->term_count;
+    int32_t next = offset;
+
+    /* If variables have been written, but this term has no known variables,
+     * first try to resolve terms that have known variables. This can 
+     * significantly reduce the search space. 
+     * Only perform this optimization after at least one variable has been
+     * written to, as all terms are unknown otherwise. */
+    if (ctx->written && flecs_rule_term_is_unknown(rule, &terms[offset], ctx)) {
+        int32_t term_index = flecs_rule_term_next_known(
+            rule, ctx, offset + 1, compiled);
+        if (term_index != -1) {
+            next = term_index;
+        }
+    }
+
+    if (!flecs_rule_term_can_reorder(rule, &terms[next])) {
+        return next;
+    }
+
+    int64_t next_cost = flecs_rule_term_cost(world, rule, &terms[next], ctx);
+    int32_t candidates = 0;
+
+    for (i = offset; i < count; i ++) {
+        ecs_term_t *term = &terms[i];
+        if (compiled & (1ull << i)) {
+            continue;
+        }
+
+        /* Don't reorder terms before/after scopes */
+        if (term->first.id == EcsScopeOpen || term->first.id == EcsScopeClose) {
+            break;
+        }
+
+        if (!flecs_rule_term_can_reorder(rule, term)) {
+            continue;
+        }
+
+        candidates ++;
+        if (i == next) {
+            continue;
+        }
+
+        int64_t cost = flecs_rule_term_cost(world, rule, term, ctx);
+        if ((cost * EcsRulePlanCostFactor) < next_cost && 
+            (next_cost - cost) > EcsRulePlanCostMin) 
+        {
+            next = i;
+            next_cost = cost;
+        }
+    }
+
+    /* Store cardinalities of terms that were considered for the plan, so that
+     * the rule can be replanned if they change significantly. */
+    if (candidates > 1) {
+        if (!rule->plan_counts) {
+            rule->plan_counts = ecs_os_malloc_n(int32_t, count);
+            for (i = 0; i < count; i ++) {
+                rule->plan_counts[i] = -1;
+            }
+        }
+
+        for (i = offset; i < count; i ++) {
+            ecs_term_t *term = &terms[i];
+            if (term->first.id == EcsScopeOpen || 
+                term->first.id == EcsScopeClose) 
+            {
+                break;
+            }
+            if (!(compiled & (1ull << i)) && 
+                flecs_rule_term_can_reorder(rule, term)) 
+            {
+                rule->plan_counts[i] = 
+                    flecs_rule_plan_table_count(world, term->id);
+            }
+        }
+    }
+
+    return next;
+}
+
 /* If the first part of a query contains more than one trivial term, insert a
  * special instruction which batch-evaluates multiple terms. */
 static
@@ -65692,7 +74295,104 @@ void flecs_rule_insert_populate(
     }
 }
 
-int flecs_rule_compile(
+/* Check if instruction tests a fixed id against an already written $this, in
+ * which case it yields at most one result and can be fused with others. */
+static
+bool flecs_rule_op_is_with_id(
+    const ecs_rule_op_t *op,
+    ecs_write_flags_t written)
+{
+    if (op->kind != EcsRuleAndId && op->kind != EcsRuleSelfUpId) {
+        return false;
+    }
+    if (!(op->flags & (EcsRuleIsVar << EcsRuleSrc)) || op->src.var != 0) {
+        return false;
+    }
+    if (!(written & 1) || (op->written & ~written)) {
+        return false;
+    }
+    return op->field_index != -1;
+}
+
+/* Check if instruction is a jump target for anything other than its direct
+ * neighbours. Instructions that are fused into another instruction are never
+ * evaluated by the straight-line program, so they can't be jumped into. */
+static
+bool flecs_rule_op_is_jump_target(
+    const ecs_rule_t *rule,
+    ecs_rule_lbl_t lbl)
+{
+    int32_t i, count = rule->op_count;
+    for (i = 0; i < count; i ++) {
+        const ecs_rule_op_t *op = &rule->ops[i];
+        if (op->prev == lbl && i != (lbl + 1)) {
+            return true;
+        }
+        if (op->next == lbl && i != (lbl - 1)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/* Replace sequences of instructions that test fixed ids against an already
+ * written $this table with a single instruction, which evaluates the entire
+ * sequence in one dispatch. The fused instructions stay in the program as
+ * operands of the first instruction, which jumps over them. */
+static
+void flecs_rule_fuse_ops(
+    ecs_rule_t *rule)
+{
+    ecs_rule_op_t *ops = rule->ops;
+    int32_t i, count = rule->op_count;
+    ecs_write_flags_t written = 0;
+
+    for (i = 0; i < count; i ++) {
+        ecs_rule_op_t *op = &ops[i];
+
+        /* Only fuse instructions in the straight-line part of the program */
+        if (op->prev != (i - 1) || op->next != (i + 1)) {
+            break;
+        }
+
+        if (flecs_rule_op_is_with_id(op, written)) {
+            int32_t end = i + 1;
+            for (; end < count; end ++) {
+                ecs_rule_op_t *cur = &ops[end];
+                if (cur->kind != op->kind) {
+                    break;
+                }
+                if (!flecs_rule_op_is_with_id(cur, written)) {
+                    break;
+                }
+                if (cur->prev != (end - 1) || cur->next != (end + 1)) {
+                    break;
+                }
+                if (flecs_rule_op_is_jump_target(rule, flecs_itolbl(end))) {
+                    break;
+                }
+            }
+
+            if ((end - i) >= 2 && end < count) {
+                if (op->kind == EcsRuleAndId) {
+                    op->kind = EcsRuleWithIds;
+                } else {
+                    op->kind = EcsRuleSelfUpWithIds;
+                }
+                op->other = flecs_itolbl(end - i);
+                op->next = flecs_itolbl(end);
+                ops[end].prev = flecs_itolbl(i);
+                i = end - 1;
+                continue;
+            }
+        }
+
+        written |= op->written;
+    }
+}
+
+static
+int flecs_rule_compile_ops(
     ecs_world_t *world,
     ecs_stage_t *stage,
     ecs_rule_t *rule)
@@ -65700,6 +74400,7 @@ int flecs_rule_compile(
     ecs_filter_t *filter = &rule->filter;
     ecs_term_t *terms = filter->terms;
     ecs_rule_compile_ctx_t ctx = {0};
+    ctx.est_count = 1;
     ecs_vec_reset_t(NULL, &stage->operations, ecs_rule_op_t);
     ctx.ops = &stage->operations;
     ctx.cur = ctx.ctrlflow;
@@ -65707,11 +74408,6 @@ int flecs_rule_compile(
     ctx.cur->lbl_begin = -1;
     ecs_vec_clear(ctx.ops);
 
-    /* Find all variables defined in query */
-    if (flecs_rule_discover_vars(stage, rule)) {
-        return -1;
-    }
-
     /* If rule contains fixed source terms, insert operation to set sources */
     int32_t i, term_count = filter->term_count;
     for (i = 0; i < term_count; i ++) {
@@ -65742,8 +74438,18 @@ int flecs_rule_compile(
     /* Insert trivial term search if query allows for it */
     int32_t trivial_terms = flecs_rule_insert_trivial_search(rule, &ctx);
 
-    /* Compile remaining query terms to instructions */
+    /* Sparse terms are not stored in tables, and are evaluated by the iterator
+     * after the rule has yielded a result. */
     ecs_flags64_t compiled = 0;
+    if (filter->flags & EcsFilterHasSparse) {
+        for (i = 0; i < term_count; i ++) {
+            if (terms[i].flags & EcsTermIsSparse) {
+                compiled |= (1ull << i);
+            }
+        }
+    }
+
+    /* Compile remaining query terms to instructions */
     for (i = trivial_terms; i < term_count; i ++) {
         ecs_term_t *term = &terms[i];
         int32_t compile = i;
@@ -65752,32 +74458,35 @@ int flecs_rule_compile(
             continue; /* Already compiled */
         }
 
-        bool can_reorder = true;
-        if (term->oper != EcsAnd || flecs_rule_term_is_or(&rule->filter, term)){
-            can_reorder = false;
-        }
-
-        /* If variables have been written, but this term has no known variables,
-         * first try to resolve terms that have known variables. This can 
-         * significantly reduce the search space. 
-         * Only perform this optimization after at least one variable has been
-         * written to, as all terms are unknown otherwise. */
-        if (can_reorder && ctx.written && 
-            flecs_rule_term_is_unknown(rule, term, &ctx)) 
-        {
-            int32_t term_index = flecs_rule_term_next_known(
-                rule, &ctx, i + 1, compiled);
-            if (term_index != -1) {
-                term = &rule->filter.terms[term_index];
-                compile = term_index;
+        int64_t cost = -1;
+        if (term->oper == EcsAnd && !flecs_rule_term_is_or(filter, term)) {
+            compile = flecs_rule_term_next(world, rule, &ctx, i, compiled);
+            if (compile != i) {
+                term = &terms[compile];
                 i --; /* Repeat current term */
             }
+            cost = flecs_rule_term_cost(world, rule, term, &ctx);
         }
 
         if (flecs_rule_compile_term(world, rule, term, &ctx)) {
             return -1;
         }
 
+        /* Keep track of how many results the compiled terms are expected to
+         * yield, which is used to decide whether to use a join. */
+        if (cost > 1) {
+            if (ctx.est_count > (INT32_MAX / cost)) {
+                ctx.est_count = INT32_MAX;
+            } else {
+                ctx.est_count *= cost;
+            }
+        } else if (!cost && !(term->flags & EcsTermIdInherited)) {
+            ecs_id_record_t *idr = flecs_id_record_get(world, term->id);
+            if (!idr || !flecs_table_cache_count(&idr->cache)) {
+                ctx.est_count = 0; /* Term doesn't match anything (yet) */
+            }
+        }
+
         compiled |= (1ull << compile);
     }
 
@@ -65886,11 +74595,76 @@ int flecs_rule_compile(
         rule->ops = ecs_os_malloc_n(ecs_rule_op_t, op_count);
         ecs_rule_op_t *rule_ops = ecs_vec_first_t(ctx.ops, ecs_rule_op_t);
         ecs_os_memcpy_n(rule->ops, rule_ops, ecs_rule_op_t, op_count);
+        flecs_rule_fuse_ops(rule);
     }
 
     return 0;
 }
 
+int flecs_rule_compile(
+    ecs_world_t *world,
+    ecs_stage_t *stage,
+    ecs_rule_t *rule)
+{
+    /* Find all variables defined in query */
+    if (flecs_rule_discover_vars(stage, rule)) {
+        return -1;
+    }
+
+    /* Compiling operations may add anonymous variables */
+    rule->var_discover_count = rule->var_count;
+
+    return flecs_rule_compile_ops(world, stage, rule);
+}
+
+bool flecs_rule_plan_is_stale(
+    const ecs_world_t *world,
+    const ecs_rule_t *rule)
+{
+    const int32_t *plan_counts = rule->plan_counts;
+    if (!plan_counts) {
+        return false;
+    }
+
+    const ecs_term_t *terms = rule->filter.terms;
+    int32_t i, count = rule->filter.term_count;
+    for (i = 0; i < count; i ++) {
+        int32_t prev = plan_counts[i];
+        if (prev == -1) {
+            continue;
+        }
+
+        int32_t cur = flecs_rule_plan_table_count(world, terms[i].id);
+        int32_t min = ECS_MIN(prev, cur), max = ECS_MAX(prev, cur);
+        if (max > (min * EcsRulePlanDriftFactor) && 
+            (max - min) > EcsRulePlanDriftMin) 
+        {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+int flecs_rule_replan(
+    ecs_world_t *world,
+    ecs_stage_t *stage,
+    ecs_rule_t *rule)
+{
+    ecs_assert(!rule->iter_count, ECS_INVALID_OPERATION,
+        "cannot replan rule while it is being iterated");
+
+    ecs_rule_reset_profile(rule);
+    ecs_os_free(rule->ops);
+    ecs_os_free(rule->plan_counts);
+    rule->ops = NULL;
+    rule->op_count = 0;
+    rule->plan_counts = NULL;
+    rule->var_count = rule->var_discover_count;
+
+    return flecs_rule_compile_ops(world, stage, rule);
+}
+
 #endif
 
 /**
@@ -66442,6 +75216,140 @@ bool flecs_rule_and(
     }
 }
 
+static
+void flecs_rule_join_build(
+    const ecs_rule_op_t *op,
+    const ecs_rule_run_ctx_t *ctx,
+    ecs_rule_join_ctx_t *op_ctx)
+{
+    ecs_world_t *world = ctx->world;
+    ecs_allocator_t *a = flecs_rule_get_allocator(ctx->it);
+    ecs_map_init(&op_ctx->index, a);
+    ecs_vec_init_t(a, &op_ctx->sources, ecs_entity_t, 0);
+    op_ctx->built = true;
+
+    ecs_id_record_t *idr = flecs_id_record_get(world, 
+        ecs_pair(op->first.entity, EcsWildcard));
+    if (!idr) {
+        return;
+    }
+
+    /* First pass: count number of sources per target */
+    ecs_table_cache_iter_t it;
+    const ecs_table_record_t *tr;
+    int32_t total = 0;
+    if (flecs_table_cache_iter(&idr->cache, &it)) {
+        while ((tr = flecs_table_cache_next(&it, ecs_table_record_t))) {
+            ecs_table_t *table = tr->hdr.table;
+            int32_t count = ecs_table_count(table);
+            ecs_id_t *ids = table->type.array;
+            int32_t i, end = tr->index + tr->count;
+            for (i = tr->index; i < end; i ++) {
+                ecs_map_key_t tgt = ECS_PAIR_SECOND(ids[i]);
+                ecs_map_ensure(&op_ctx->index, tgt)[0] += 
+                    flecs_ito(uint64_t, count);
+            }
+            total += count * tr->count;
+        }
+    }
+
+    /* Convert counts to offsets in sources vector */
+    ecs_map_iter_t mit = ecs_map_iter(&op_ctx->index);
+    uint64_t offset = 0;
+    while (ecs_map_next(&mit)) {
+        uint64_t count = ecs_map_value(&mit);
+        ecs_map_value(&mit) = offset << 32;
+        offset += count;
+    }
+
+    /* Second pass: store sources, grouped by target. The lower 32 bits of the
+     * index value are used as insertion cursor, and contain the number of 
+     * sources for the target after all sources have been inserted. */
+    ecs_vec_set_count_t(a, &op_ctx->sources, ecs_entity_t, total);
+    ecs_entity_t *sources = ecs_vec_first_t(&op_ctx->sources, ecs_entity_t);
+    if (flecs_table_cache_iter(&idr->cache, &it)) {
+        while ((tr = flecs_table_cache_next(&it, ecs_table_record_t))) {
+            ecs_table_t *table = tr->hdr.table;
+            int32_t row, count = ecs_table_count(table);
+            ecs_entity_t *entities = table->data.entities.array;
+            ecs_id_t *ids = table->type.array;
+            int32_t i, end = tr->index + tr->count;
+            for (i = tr->index; i < end; i ++) {
+                ecs_map_val_t *val = ecs_map_get(
+                    &op_ctx->index, ECS_PAIR_SECOND(ids[i]));
+                ecs_assert(val != NULL, ECS_INTERNAL_ERROR, NULL);
+                uint64_t cur = (val[0] >> 32) + (val[0] & 0xFFFFFFFF);
+                for (row = 0; row < count; row ++) {
+                    sources[cur + flecs_ito(uint64_t, row)] = entities[row];
+                }
+                val[0] += flecs_ito(uint64_t, count);
+            }
+        }
+    }
+}
+
+static
+bool flecs_rule_join(
+    const ecs_rule_op_t *op,
+    bool redo,
+    const ecs_rule_run_ctx_t *ctx)
+{
+    ecs_rule_join_ctx_t *op_ctx = flecs_op_ctx(ctx, join);
+
+    if (!redo) {
+        if (!op_ctx->built) {
+            flecs_rule_join_build(op, ctx, op_ctx);
+        }
+
+        ecs_entity_t tgt = flecs_rule_var_get_entity(op->second.var, ctx);
+        ecs_map_val_t *val = ecs_map_get(&op_ctx->index, (uint32_t)tgt);
+        if (!val) {
+            return false;
+        }
+
+        ecs_id_t id = ecs_pair(op->first.entity, tgt);
+        op_ctx->idr = flecs_id_record_get(ctx->world, id);
+        if (!op_ctx->idr) {
+            return false;
+        }
+
+        op_ctx->cur = flecs_uto(int32_t, val[0] >> 32);
+        op_ctx->end = op_ctx->cur + flecs_uto(int32_t, val[0] & 0xFFFFFFFF);
+    }
+
+    ecs_entity_t *sources = ecs_vec_first_t(&op_ctx->sources, ecs_entity_t);
+    while (op_ctx->cur < op_ctx->end) {
+        ecs_entity_t e = sources[op_ctx->cur ++];
+
+        /* Exclude entities that are used as markers by rule engine */
+        if ((e == EcsWildcard) || (e == EcsAny) || 
+            (e == EcsThis) || (e == EcsVariable)) 
+        {
+            continue;
+        }
+
+        ecs_record_t *r = flecs_entities_get(ctx->world, e);
+        if (!r || !r->table) {
+            continue;
+        }
+
+        /* Get column from the current table of the entity, so that the result
+         * stays valid if entities were moved since the index was built. */
+        ecs_table_t *table = r->table;
+        const ecs_table_record_t *tr = flecs_id_record_get_table(
+            op_ctx->idr, table);
+        if (!tr) {
+            continue;
+        }
+
+        flecs_rule_var_set_entity(op, op->src.var, e, ctx);
+        flecs_rule_set_match(op, table, tr->index, ctx);
+        return true;
+    }
+
+    return false;
+}
+
 static
 bool flecs_rule_select_id(
     const ecs_rule_op_t *op,
@@ -66493,25 +75401,16 @@ repeat: {}
 }
 
 static
-bool flecs_rule_with_id(
+bool flecs_rule_with_id_table(
     const ecs_rule_op_t *op,
-    bool redo,
+    ecs_rule_and_ctx_t *op_ctx,
+    ecs_table_t *table,
     const ecs_rule_run_ctx_t *ctx)
 {
-    if (redo) {
-        return false;
-    }
-
-    ecs_rule_and_ctx_t *op_ctx = flecs_op_ctx(ctx, and);
     ecs_iter_t *it = ctx->it;
     int8_t field = op->field_index;
     ecs_assert(field != -1, ECS_INTERNAL_ERROR, NULL);
 
-    ecs_table_t *table = flecs_rule_get_table(op, &op->src, EcsRuleSrc, ctx);
-    if (!table) {
-        return false;
-    }
-
     ecs_id_t id = it->ids[field];
     ecs_id_record_t *idr = op_ctx->idr;
     if (!idr || idr->id != id) {
@@ -66530,6 +75429,24 @@ bool flecs_rule_with_id(
     return true;
 }
 
+static
+bool flecs_rule_with_id(
+    const ecs_rule_op_t *op,
+    bool redo,
+    const ecs_rule_run_ctx_t *ctx)
+{
+    if (redo) {
+        return false;
+    }
+
+    ecs_table_t *table = flecs_rule_get_table(op, &op->src, EcsRuleSrc, ctx);
+    if (!table) {
+        return false;
+    }
+
+    return flecs_rule_with_id_table(op, flecs_op_ctx(ctx, and), table, ctx);
+}
+
 static
 bool flecs_rule_and_id(
     const ecs_rule_op_t *op,
@@ -66545,6 +75462,33 @@ bool flecs_rule_and_id(
     }
 }
 
+static
+bool flecs_rule_with_ids(
+    const ecs_rule_op_t *op,
+    bool redo,
+    const ecs_rule_run_ctx_t *ctx)
+{
+    if (redo) {
+        return false;
+    }
+
+    ecs_table_t *table = flecs_rule_get_table(op, &op->src, EcsRuleSrc, ctx);
+    if (!table) {
+        return false;
+    }
+
+    /* Fused instructions are stored directly after this instruction */
+    int32_t i, count = op->other;
+    ecs_rule_op_ctx_t *op_ctx = &ctx->op_ctx[ctx->op_index];
+    for (i = 0; i < count; i ++) {
+        if (!flecs_rule_with_id_table(&op[i], &op_ctx[i].is.and, table, ctx)) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
 static
 bool flecs_rule_up_select(
     const ecs_rule_op_t *op,
@@ -66788,6 +75732,31 @@ bool flecs_rule_self_up_with(
     return false;
 }
 
+static
+bool flecs_rule_self_up_with_ids(
+    const ecs_rule_op_t *op,
+    bool redo,
+    ecs_rule_run_ctx_t *ctx)
+{
+    if (redo) {
+        return false;
+    }
+
+    /* Fused instructions are stored directly after this instruction. Each
+     * instruction uses its own context, so temporarily move the op index. */
+    ecs_rule_lbl_t op_index = ctx->op_index;
+    int32_t i, count = op->other;
+    bool result = true;
+    for (i = 0; i < count && result; i ++) {
+        ctx->op_index = flecs_itolbl(op_index + i);
+        ctx->written[ctx->op_index] = ctx->written[op_index];
+        result = flecs_rule_self_up_with(&op[i], false, ctx, true);
+    }
+
+    ctx->op_index = op_index;
+    return result;
+}
+
 static
 bool flecs_rule_up(
     const ecs_rule_op_t *op,
@@ -68300,59 +77269,152 @@ bool flecs_rule_populate_self(
     }
 }
 
+/* Use computed goto for dispatching instructions where it is supported. The
+ * address of each handler is looked up directly from the instruction kind,
+ * which avoids the range check of the switch statement. */
+#if defined(ECS_TARGET_GNU) && !defined(FLECS_NO_COMPUTED_GOTO)
+#define FLECS_RULE_COMPUTED_GOTO
+#endif
+
+#ifdef FLECS_RULE_COMPUTED_GOTO
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wpedantic"
+#define flecs_rule_case(kind) kind##_lbl: case kind
+#else
+#define flecs_rule_case(kind) case kind
+#endif
+
 static
 bool flecs_rule_dispatch(
     const ecs_rule_op_t *op,
     bool redo,
     ecs_rule_run_ctx_t *ctx)
 {
+#ifdef FLECS_RULE_COMPUTED_GOTO
+    static const void *handlers[] = {
+        [EcsRuleAnd] = &&EcsRuleAnd_lbl,
+        [EcsRuleAndId] = &&EcsRuleAndId_lbl,
+        [EcsRuleAndAny] = &&EcsRuleAndAny_lbl,
+        [EcsRuleTriv] = &&EcsRuleTriv_lbl,
+        [EcsRuleTrivData] = &&EcsRuleTrivData_lbl,
+        [EcsRuleTrivWildcard] = &&EcsRuleTrivWildcard_lbl,
+        [EcsRuleSelectAny] = &&EcsRuleSelectAny_lbl,
+        [EcsRuleUp] = &&EcsRuleUp_lbl,
+        [EcsRuleUpId] = &&EcsRuleUpId_lbl,
+        [EcsRuleSelfUp] = &&EcsRuleSelfUp_lbl,
+        [EcsRuleSelfUpId] = &&EcsRuleSelfUpId_lbl,
+        [EcsRuleWith] = &&EcsRuleWith_lbl,
+        [EcsRuleWithIds] = &&EcsRuleWithIds_lbl,
+        [EcsRuleSelfUpWithIds] = &&EcsRuleSelfUpWithIds_lbl,
+        [EcsRuleTrav] = &&EcsRuleTrav_lbl,
+        [EcsRuleJoin] = &&EcsRuleJoin_lbl,
+        [EcsRuleIds] = &&EcsRuleIds_lbl,
+        [EcsRuleIdsRight] = &&EcsRuleIdsRight_lbl,
+        [EcsRuleIdsLeft] = &&EcsRuleIdsLeft_lbl,
+        [EcsRuleEach] = &&EcsRuleEach_lbl,
+        [EcsRuleStore] = &&EcsRuleStore_lbl,
+        [EcsRuleReset] = &&EcsRuleReset_lbl,
+        [EcsRuleOr] = &&EcsRuleOr_lbl,
+        [EcsRuleOptional] = &&EcsRuleOptional_lbl,
+        [EcsRuleIf] = &&EcsRuleIf_lbl,
+        [EcsRuleEnd] = &&EcsRuleEnd_lbl,
+        [EcsRuleNot] = &&EcsRuleNot_lbl,
+        [EcsRulePredEq] = &&EcsRulePredEq_lbl,
+        [EcsRulePredNeq] = &&EcsRulePredNeq_lbl,
+        [EcsRulePredEqName] = &&EcsRulePredEqName_lbl,
+        [EcsRulePredNeqName] = &&EcsRulePredNeqName_lbl,
+        [EcsRulePredEqMatch] = &&EcsRulePredEqMatch_lbl,
+        [EcsRulePredNeqMatch] = &&EcsRulePredNeqMatch_lbl,
+        [EcsRuleLookup] = &&EcsRuleLookup_lbl,
+        [EcsRuleSetVars] = &&EcsRuleSetVars_lbl,
+        [EcsRuleSetThis] = &&EcsRuleSetThis_lbl,
+        [EcsRuleSetFixed] = &&EcsRuleSetFixed_lbl,
+        [EcsRuleSetIds] = &&EcsRuleSetIds_lbl,
+        [EcsRuleSetId] = &&EcsRuleSetId_lbl,
+        [EcsRuleContain] = &&EcsRuleContain_lbl,
+        [EcsRulePairEq] = &&EcsRulePairEq_lbl,
+        [EcsRulePopulate] = &&EcsRulePopulate_lbl,
+        [EcsRulePopulateSelf] = &&EcsRulePopulateSelf_lbl,
+        [EcsRuleYield] = &&EcsRuleYield_lbl,
+        [EcsRuleNothing] = &&EcsRuleNothing_lbl,
+    };
+
+    ecs_assert(op->kind <= EcsRuleNothing, ECS_INTERNAL_ERROR, NULL);
+    goto *handlers[op->kind];
+#endif
+
     switch(op->kind) {
-    case EcsRuleAnd: return flecs_rule_and(op, redo, ctx);
-    case EcsRuleAndId: return flecs_rule_and_id(op, redo, ctx);
-    case EcsRuleAndAny: return flecs_rule_and_any(op, redo, ctx);
-    case EcsRuleTriv: return flecs_rule_triv(op, redo, ctx);
-    case EcsRuleTrivData: return flecs_rule_triv_data(op, redo, ctx);
-    case EcsRuleTrivWildcard: return flecs_rule_triv_wildcard(op, redo, ctx);
-    case EcsRuleSelectAny: return flecs_rule_select_any(op, redo, ctx);
-    case EcsRuleUp: return flecs_rule_up(op, redo, ctx);
-    case EcsRuleUpId: return flecs_rule_up_id(op, redo, ctx);
-    case EcsRuleSelfUp: return flecs_rule_self_up(op, redo, ctx);
-    case EcsRuleSelfUpId: return flecs_rule_self_up_id(op, redo, ctx);
-    case EcsRuleWith: return flecs_rule_with(op, redo, ctx);
-    case EcsRuleTrav: return flecs_rule_trav(op, redo, ctx);
-    case EcsRuleIds: return flecs_rule_ids(op, redo, ctx);
-    case EcsRuleIdsRight: return flecs_rule_idsright(op, redo, ctx);
-    case EcsRuleIdsLeft: return flecs_rule_idsleft(op, redo, ctx);
-    case EcsRuleEach: return flecs_rule_each(op, redo, ctx);
-    case EcsRuleStore: return flecs_rule_store(op, redo, ctx);
-    case EcsRuleReset: return flecs_rule_reset(op, redo, ctx);
-    case EcsRuleOr: return flecs_rule_or(op, redo, ctx);
-    case EcsRuleOptional: return flecs_rule_optional(op, redo, ctx);
-    case EcsRuleIf: return flecs_rule_if(op, redo, ctx);
-    case EcsRuleEnd: return flecs_rule_end(op, redo, ctx);
-    case EcsRuleNot: return flecs_rule_not(op, redo, ctx);
-    case EcsRulePredEq: return flecs_rule_pred_eq(op, redo, ctx);
-    case EcsRulePredNeq: return flecs_rule_pred_neq(op, redo, ctx);
-    case EcsRulePredEqName: return flecs_rule_pred_eq_name(op, redo, ctx);
-    case EcsRulePredNeqName: return flecs_rule_pred_neq_name(op, redo, ctx);
-    case EcsRulePredEqMatch: return flecs_rule_pred_eq_match(op, redo, ctx);
-    case EcsRulePredNeqMatch: return flecs_rule_pred_neq_match(op, redo, ctx);
-    case EcsRuleLookup: return flecs_rule_lookup(op, redo, ctx);
-    case EcsRuleSetVars: return flecs_rule_setvars(op, redo, ctx);
-    case EcsRuleSetThis: return flecs_rule_setthis(op, redo, ctx);
-    case EcsRuleSetFixed: return flecs_rule_setfixed(op, redo, ctx);
-    case EcsRuleSetIds: return flecs_rule_setids(op, redo, ctx);
-    case EcsRuleSetId: return flecs_rule_setid(op, redo, ctx);
-    case EcsRuleContain: return flecs_rule_contain(op, redo, ctx);
-    case EcsRulePairEq: return flecs_rule_pair_eq(op, redo, ctx);
-    case EcsRulePopulate: return flecs_rule_populate(op, redo, ctx);
-    case EcsRulePopulateSelf: return flecs_rule_populate_self(op, redo, ctx);
-    case EcsRuleYield: return false;
-    case EcsRuleNothing: return false;
+    flecs_rule_case(EcsRuleAnd): return flecs_rule_and(op, redo, ctx);
+    flecs_rule_case(EcsRuleAndId): return flecs_rule_and_id(op, redo, ctx);
+    flecs_rule_case(EcsRuleAndAny): return flecs_rule_and_any(op, redo, ctx);
+    flecs_rule_case(EcsRuleTriv): return flecs_rule_triv(op, redo, ctx);
+    flecs_rule_case(EcsRuleTrivData): return flecs_rule_triv_data(op, redo, ctx);
+    flecs_rule_case(EcsRuleTrivWildcard): return flecs_rule_triv_wildcard(op, redo, ctx);
+    flecs_rule_case(EcsRuleSelectAny): return flecs_rule_select_any(op, redo, ctx);
+    flecs_rule_case(EcsRuleUp): return flecs_rule_up(op, redo, ctx);
+    flecs_rule_case(EcsRuleUpId): return flecs_rule_up_id(op, redo, ctx);
+    flecs_rule_case(EcsRuleSelfUp): return flecs_rule_self_up(op, redo, ctx);
+    flecs_rule_case(EcsRuleSelfUpId): return flecs_rule_self_up_id(op, redo, ctx);
+    flecs_rule_case(EcsRuleWith): return flecs_rule_with(op, redo, ctx);
+    flecs_rule_case(EcsRuleWithIds): return flecs_rule_with_ids(op, redo, ctx);
+    flecs_rule_case(EcsRuleSelfUpWithIds): return flecs_rule_self_up_with_ids(op, redo, ctx);
+    flecs_rule_case(EcsRuleTrav): return flecs_rule_trav(op, redo, ctx);
+    flecs_rule_case(EcsRuleJoin): return flecs_rule_join(op, redo, ctx);
+    flecs_rule_case(EcsRuleIds): return flecs_rule_ids(op, redo, ctx);
+    flecs_rule_case(EcsRuleIdsRight): return flecs_rule_idsright(op, redo, ctx);
+    flecs_rule_case(EcsRuleIdsLeft): return flecs_rule_idsleft(op, redo, ctx);
+    flecs_rule_case(EcsRuleEach): return flecs_rule_each(op, redo, ctx);
+    flecs_rule_case(EcsRuleStore): return flecs_rule_store(op, redo, ctx);
+    flecs_rule_case(EcsRuleReset): return flecs_rule_reset(op, redo, ctx);
+    flecs_rule_case(EcsRuleOr): return flecs_rule_or(op, redo, ctx);
+    flecs_rule_case(EcsRuleOptional): return flecs_rule_optional(op, redo, ctx);
+    flecs_rule_case(EcsRuleIf): return flecs_rule_if(op, redo, ctx);
+    flecs_rule_case(EcsRuleEnd): return flecs_rule_end(op, redo, ctx);
+    flecs_rule_case(EcsRuleNot): return flecs_rule_not(op, redo, ctx);
+    flecs_rule_case(EcsRulePredEq): return flecs_rule_pred_eq(op, redo, ctx);
+    flecs_rule_case(EcsRulePredNeq): return flecs_rule_pred_neq(op, redo, ctx);
+    flecs_rule_case(EcsRulePredEqName): return flecs_rule_pred_eq_name(op, redo, ctx);
+    flecs_rule_case(EcsRulePredNeqName): return flecs_rule_pred_neq_name(op, redo, ctx);
+    flecs_rule_case(EcsRulePredEqMatch): return flecs_rule_pred_eq_match(op, redo, ctx);
+    flecs_rule_case(EcsRulePredNeqMatch): return flecs_rule_pred_neq_match(op, redo, ctx);
+    flecs_rule_case(EcsRuleLookup): return flecs_rule_lookup(op, redo, ctx);
+    flecs_rule_case(EcsRuleSetVars): return flecs_rule_setvars(op, redo, ctx);
+    flecs_rule_case(EcsRuleSetThis): return flecs_rule_setthis(op, redo, ctx);
+    flecs_rule_case(EcsRuleSetFixed): return flecs_rule_setfixed(op, redo, ctx);
+    flecs_rule_case(EcsRuleSetIds): return flecs_rule_setids(op, redo, ctx);
+    flecs_rule_case(EcsRuleSetId): return flecs_rule_setid(op, redo, ctx);
+    flecs_rule_case(EcsRuleContain): return flecs_rule_contain(op, redo, ctx);
+    flecs_rule_case(EcsRulePairEq): return flecs_rule_pair_eq(op, redo, ctx);
+    flecs_rule_case(EcsRulePopulate): return flecs_rule_populate(op, redo, ctx);
+    flecs_rule_case(EcsRulePopulateSelf): return flecs_rule_populate_self(op, redo, ctx);
+    flecs_rule_case(EcsRuleYield): return false;
+    flecs_rule_case(EcsRuleNothing): return false;
     }
     return false;
 }
 
+#ifdef FLECS_RULE_COMPUTED_GOTO
+#pragma GCC diagnostic pop
+#endif
+
+static
+bool flecs_rule_dispatch_w_profile(
+    const ecs_rule_op_t *op,
+    bool redo,
+    ecs_rule_run_ctx_t *ctx,
+    ecs_rule_op_profile_t *profile)
+{
+    ecs_time_t t = {0};
+    ecs_time_measure(&t);
+
+    bool result = flecs_rule_dispatch(op, redo, ctx);
+
+    profile->count[redo] ++;
+    profile->match_count += result;
+    profile->time_spent += ecs_time_measure(&t);
+    return result;
+}
+
 static
 bool flecs_rule_run_until(
     bool redo,
@@ -68370,12 +77432,17 @@ bool flecs_rule_run_until(
     const ecs_rule_op_t *op = &ops[ctx->op_index];
     ecs_assert(op->kind != until, ECS_INTERNAL_ERROR, NULL);
 
+    ecs_rule_op_profile_t *profile = ctx->rit->profile;
+
     do {
-        #ifdef FLECS_DEBUG
-        ctx->rit->profile[ctx->op_index].count[redo] ++;
-        #endif
+        bool result;
+        if (profile) {
+            result = flecs_rule_dispatch_w_profile(
+                op, redo, ctx, &profile[ctx->op_index]);
+        } else {
+            result = flecs_rule_dispatch(op, redo, ctx);
+        }
 
-        bool result = flecs_rule_dispatch(op, redo, ctx);
         cur = (&op->prev)[result];
         redo = cur < ctx->op_index;
 
@@ -68427,6 +77494,15 @@ void flecs_rule_iter_init(
         }
     }
 
+    /* Profiling requires evaluating the rule program, so don't use trivial
+     * iterator modes when profiling. */
+    if (it->flags & EcsIterProfile) {
+        ctx->rit->profile = flecs_iter_calloc_n(
+            it, ecs_rule_op_profile_t, rule->op_count);
+        flecs_iter_validate(it);
+        return;
+    }
+
     ecs_flags32_t flags = rule->filter.flags;
     if (flags & EcsFilterIsTrivial) {
         if ((flags & EcsFilterMatchOnlySelf) || 
@@ -68460,13 +77536,30 @@ void flecs_rule_iter_init(
     flecs_iter_validate(it);
 }
 
-bool ecs_rule_next_instanced(
+static
+bool flecs_rule_next_instanced(
     ecs_iter_t *it)
 {
     ecs_assert(it != NULL, ECS_INVALID_PARAMETER, NULL);
     ecs_assert(it->next == ecs_rule_next, ECS_INVALID_PARAMETER, NULL);
 
     ecs_rule_iter_t *rit = &it->priv.iter.rule;
+
+    /* Replay cached results, unless variables are constrained or the rule is
+     * profiled, both of which require evaluating the rule program. */
+    if (it->flags & EcsIterCached) {
+        if ((it->flags & EcsIterIsValid) || 
+            !(it->constrained_vars || (it->flags & EcsIterProfile)))
+        {
+            if (flecs_rule_cache_next(it)) {
+                return true;
+            }
+            ecs_iter_fini(it);
+            return false;
+        }
+        ECS_BIT_CLEAR(it->flags, EcsIterCached);
+    }
+
     ecs_rule_run_ctx_t ctx;
     ctx.world = it->real_world;
     ctx.rule = rit->rule;
@@ -68557,6 +77650,12 @@ done:
     return false;
 }
 
+bool ecs_rule_next_instanced(
+    ecs_iter_t *it)
+{
+    return flecs_sparse_filter_next(it, flecs_rule_next_instanced);
+}
+
 bool ecs_rule_next(
     ecs_iter_t *it)
 {
@@ -68589,6 +77688,12 @@ void flecs_rule_iter_fini_ctx(
         case EcsRuleTrav:
             flecs_rule_trav_cache_fini(a, &ctx[i].is.trav.cache);
             break;
+        case EcsRuleJoin:
+            if (ctx[i].is.join.built) {
+                ecs_map_fini(&ctx[i].is.join.index);
+                ecs_vec_fini_t(a, &ctx[i].is.join.sources, ecs_entity_t);
+            }
+            break;
         case EcsRuleUp:
         case EcsRuleSelfUp:
         case EcsRuleUpId:
@@ -68607,6 +77712,29 @@ void flecs_rule_iter_fini_ctx(
     }
 }
 
+/* Add profile of iterator to rule */
+static
+void flecs_rule_profile_add(
+    ecs_rule_t *rule,
+    const ecs_rule_op_profile_t *profile)
+{
+    int32_t i, count = rule->op_count;
+    if (!rule->profile) {
+        rule->profile = ecs_os_calloc_n(ecs_rule_op_profile_t, count);
+    }
+
+    for (i = 0; i < count; i ++) {
+        ecs_rule_op_profile_t *dst = &rule->profile[i];
+        const ecs_rule_op_profile_t *src = &profile[i];
+        dst->count[0] += src->count[0];
+        dst->count[1] += src->count[1];
+        dst->match_count += src->match_count;
+        dst->time_spent += src->time_spent;
+    }
+
+    rule->profile_iter_count ++;
+}
+
 static
 void flecs_rule_iter_fini(
     ecs_iter_t *it)
@@ -68617,20 +77745,18 @@ void flecs_rule_iter_fini(
     int32_t op_count = rit->rule->op_count;
     int32_t var_count = rit->rule->var_count;
 
-#ifdef FLECS_DEBUG
-    if (it->flags & EcsIterProfile) {
-        char *str = ecs_rule_str_w_profile(rit->rule, it);
-        printf("%s\n", str);
-        ecs_os_free(str);
+    if (rit->profile) {
+        flecs_rule_profile_add(ECS_CONST_CAST(ecs_rule_t*, rit->rule), 
+            rit->profile);
+        flecs_iter_free_n(rit->profile, ecs_rule_op_profile_t, op_count);
+        rit->profile = NULL;
     }
 
-    flecs_iter_free_n(rit->profile, ecs_rule_op_profile_t, op_count);
-#endif
-
     flecs_rule_iter_fini_ctx(it, rit);
     flecs_iter_free_n(rit->vars, ecs_var_t, var_count);
     flecs_iter_free_n(rit->written, ecs_write_flags_t, op_count);
     flecs_iter_free_n(rit->op_ctx, ecs_rule_op_ctx_t, op_count);
+    ecs_os_adec(&ECS_CONST_CAST(ecs_rule_t*, rit->rule)->iter_count);
     rit->vars = NULL;
     rit->written = NULL;
     rit->op_ctx = NULL;
@@ -68650,6 +77776,30 @@ ecs_iter_t ecs_rule_iter(
 
     ecs_run_aperiodic(rule->filter.world, EcsAperiodicEmptyTables);
 
+    /* If the number of tables matched by the terms changed significantly since
+     * the rule was planned, replan it. Only do this when the rule is not being
+     * iterated, as iterators point to the rule operations. */
+    ecs_world_t *real_world = rule->filter.world;
+    if (rule->plan_counts && !rule->iter_count && 
+        !(real_world->flags & EcsWorldReadonly) &&
+        flecs_rule_plan_is_stale(real_world, rule))
+    {
+        ecs_stage_t *stage = flecs_stage_from_world(&real_world);
+        if (flecs_rule_replan(real_world, stage, 
+            ECS_CONST_CAST(ecs_rule_t*, rule))) 
+        {
+            goto error;
+        }
+    }
+
+    /* Bring cached results up to date before the rule is iterated */
+    bool cached = false;
+    if (rule->cache) {
+        cached = flecs_rule_cache_update(ECS_CONST_CAST(ecs_rule_t*, rule));
+    }
+
+    ecs_os_ainc(&ECS_CONST_CAST(ecs_rule_t*, rule)->iter_count);
+
     int32_t i, var_count = rule->var_count, op_count = rule->op_count;
     it.world = ECS_CONST_CAST(ecs_world_t*, world);
     it.real_world = rule->filter.world;
@@ -68661,6 +77811,7 @@ ecs_iter_t ecs_rule_iter(
     it.sizes = rule->filter.sizes;
     it.system = rule->filter.entity;
     flecs_filter_apply_iter_flags(&it, &rule->filter);
+    ECS_BIT_COND(it.flags, EcsIterCached, cached);
 
     flecs_iter_init(world, &it, 
         flecs_iter_cache_ids |
@@ -68680,10 +77831,6 @@ ecs_iter_t ecs_rule_iter(
         rit->op_ctx = flecs_iter_calloc_n(&it, ecs_rule_op_ctx_t, op_count);
     }
 
-#ifdef FLECS_DEBUG
-    rit->profile = flecs_iter_calloc_n(&it, ecs_rule_op_profile_t, op_count);
-#endif
-
     for (i = 1; i < var_count; i ++) {
         rit->vars[i].entity = EcsWildcard;
     }
@@ -68748,6 +77895,41 @@ void flecs_rule_build_down_cache(
     }
 }
 
+/* Populate cache from the world-level traversal index. The index persists
+ * across iterations and rules, and is only rebuilt after (trav, *) pairs were
+ * added or removed. Returns false if the index couldn't be used. */
+static
+bool flecs_rule_down_cache_from_index(
+    ecs_world_t *world,
+    ecs_allocator_t *a,
+    ecs_trav_cache_t *cache,
+    ecs_entity_t trav,
+    ecs_entity_t entity)
+{
+    ecs_id_record_t *idr = flecs_id_record_get(world, ecs_pair(trav, entity));
+    if (!idr) {
+        return true; /* Nothing to traverse */
+    }
+
+    const ecs_vec_t *index = flecs_id_record_trav_index(world, idr);
+    if (!index) {
+        return false;
+    }
+
+    int32_t i, count = ecs_vec_count(index);
+    ecs_id_record_t **idrs = ecs_vec_first(index);
+    ecs_trav_elem_t *elems = ecs_vec_grow_t(
+        a, &cache->entities, ecs_trav_elem_t, count);
+    for (i = 0; i < count; i ++) {
+        elems[i].entity = flecs_entities_get_alive(
+            world, ECS_PAIR_SECOND(idrs[i]->id));
+        elems[i].idr = idrs[i];
+        elems[i].column = -1;
+    }
+
+    return true;
+}
+
 static
 void flecs_rule_build_up_cache(
     ecs_world_t *world,
@@ -68780,7 +77962,7 @@ void flecs_rule_build_up_cache(
             ecs_table_record_t *r_tr = flecs_id_record_get_table(
                 cache->idr, r->table);
             if (!r_tr) {
-                return;
+                continue;
             }
             flecs_rule_build_up_cache(world, a, ctx, cache, trav, r->table, 
                 r_tr, root_column);
@@ -68805,7 +77987,9 @@ void flecs_rule_get_trav_down_cache(
         ecs_world_t *world = ctx->it->real_world;
         ecs_allocator_t *a = flecs_rule_get_allocator(ctx->it);
         ecs_vec_reset_t(a, &cache->entities, ecs_trav_elem_t);
-        flecs_rule_build_down_cache(world, a, ctx, cache, trav, entity);
+        if (!flecs_rule_down_cache_from_index(world, a, cache, trav, entity)) {
+            flecs_rule_build_down_cache(world, a, ctx, cache, trav, entity);
+        }
         cache->id = ecs_pair(trav, entity);
         cache->up = false;
     }
@@ -68839,10 +78023,11 @@ void flecs_rule_get_trav_up_cache(
 
     ecs_id_t id = table->type.array[tr->index];
 
-    if (cache->id != id || !cache->up) {
+    if (cache->id != id || cache->table != table || !cache->up) {
         ecs_vec_reset_t(a, &cache->entities, ecs_trav_elem_t);
         flecs_rule_build_up_cache(world, a, ctx, cache, trav, table, tr, -1);
         cache->id = id;
+        cache->table = table;
         cache->up = true;
     }
 }
@@ -69596,6 +78781,7 @@ ecs_entity_t ecs_run_intern(
     ecs_ftime_t delta_time,
     int32_t offset,
     int32_t limit,
+    bool balanced,
     void *param) 
 {
     ecs_ftime_t time_elapsed = delta_time;
@@ -69665,7 +78851,11 @@ ecs_entity_t ecs_run_intern(
     }
 
     if (stage_count > 1 && system_data->multi_threaded) {
-        wit = ecs_worker_iter(it, stage_index, stage_count);
+        if (balanced) {
+            wit = ecs_balanced_worker_iter(it, stage_index, stage_count);
+        } else {
+            wit = ecs_worker_iter(it, stage_index, stage_count);
+        }
         it = &wit;
     }
 
@@ -69716,7 +78906,7 @@ ecs_entity_t ecs_run_w_filter(
     ecs_system_t *system_data = ecs_poly_get(world, system, ecs_system_t);
     ecs_assert(system_data != NULL, ECS_INVALID_PARAMETER, NULL);
     return ecs_run_intern(world, stage, system, system_data, 0, 0, delta_time, 
-        offset, limit, param);
+        offset, limit, false, param);
 }
 
 ecs_entity_t ecs_run_worker(
@@ -69733,7 +78923,7 @@ ecs_entity_t ecs_run_worker(
 
     return ecs_run_intern(
         world, stage, system, system_data, stage_index, stage_count, 
-        delta_time, 0, 0, param);
+        delta_time, 0, 0, true, param);
 }
 
 ecs_entity_t ecs_run(
@@ -179,6 +179,7 @@
 #define FLECS_PLECS         /**< ECS data definition format */
 #define FLECS_RULES         /**< Constraint solver for advanced queries */
 #define FLECS_SNAPSHOT      /**< Snapshot & restore ECS data */
+#define FLECS_RECORDER      /**< Record & replay command queues */
 #define FLECS_STATS         /**< Access runtime statistics */
 #define FLECS_MONITOR       /**< Track runtime statistics periodically */
 #define FLECS_METRICS       /**< Expose component data as statistics */
@@ -257,6 +258,41 @@
  * as memory will be freed more often, at the cost of decreased performance. */
 // #define FLECS_USE_OS_ALLOC
 
+/** @def FLECS_ALLOCATOR_STATS
+ * When enabled, block allocators keep track of the number of chunks in use and
+ * of the high-water mark of chunks in use. These are reported by 
+ * ecs_allocator_stats_get() and the world statistics. This adds a small 
+ * overhead to each allocation. Always enabled in sanitized builds. */
+// #define FLECS_ALLOCATOR_STATS
+#if defined(FLECS_SANITIZE) && !defined(FLECS_ALLOCATOR_STATS)
+#define FLECS_ALLOCATOR_STATS
+#endif
+
+/** @def FLECS_COLUMN_ALIGNMENT
+ * Alignment of component columns when aligned columns are enabled with
+ * ecs_enable_aligned_columns(). Column allocations are padded to a multiple of
+ * the alignment, so that code processing a column in blocks of this size never
+ * reads past the end of the allocation. Must be a power of two. */
+#ifndef FLECS_COLUMN_ALIGNMENT
+#define FLECS_COLUMN_ALIGNMENT (64)
+#endif
+
+/** @def FLECS_VMEM_COLUMN_THRESHOLD
+ * Size in bytes from which component columns are stored in reserved virtual
+ * memory, if the OS API provides virtual memory functions. Growing such columns
+ * commits more pages, and never moves existing elements. */
+#ifndef FLECS_VMEM_COLUMN_THRESHOLD
+#define FLECS_VMEM_COLUMN_THRESHOLD (1024 * 1024)
+#endif
+
+/** @def FLECS_VMEM_COLUMN_RESERVE
+ * Address space in bytes that is reserved for a column that is stored in 
+ * virtual memory. When a column outgrows its reservation it is moved to a new
+ * reservation that is twice the column size. */
+#ifndef FLECS_VMEM_COLUMN_RESERVE
+#define FLECS_VMEM_COLUMN_RESERVE (256 * 1024 * 1024)
+#endif
+
 /** @def FLECS_ID_DESC_MAX
  * Maximum number of ids to add ecs_entity_desc_t / ecs_bulk_desc_t */
 #ifndef FLECS_ID_DESC_MAX
@@ -318,6 +354,11 @@ extern "C" {
 #define EcsWorldMeasureFrameTime      (1u << 5)
 #define EcsWorldMeasureSystemTime     (1u << 6)
 #define EcsWorldMultiThreaded         (1u << 7)
+#define EcsWorldWorkStealing          (1u << 8)
+#define EcsWorldAlignedColumns        (1u << 9)
+#define EcsWorldCombinedMerge         (1u << 10)
+#define EcsWorldParallelMerge         (1u << 11)
+#define EcsWorldParallelMerging       (1u << 12)
 
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -337,6 +378,7 @@ extern "C" {
 #define EcsEntityIsId                 (1u << 31)
 #define EcsEntityIsTarget             (1u << 30)
 #define EcsEntityIsTraversable        (1u << 29)
+#define EcsEntityHasSparse            (1u << 28)
 
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -363,6 +405,7 @@ extern "C" {
 #define EcsIdWith                      (1u << 10)
 #define EcsIdUnion                     (1u << 11)
 #define EcsIdAlwaysOverride            (1u << 12)
+#define EcsIdSparse                    (1u << 13)
 
 #define EcsIdHasOnAdd                  (1u << 16) /* Same values as table flags */
 #define EcsIdHasOnRemove               (1u << 17) 
@@ -408,6 +451,8 @@ extern "C" {
 #define EcsIterTrivialTest             (1u << 14u) /* Trivial test mode (constrained $this) */
 #define EcsIterTrivialSearchWildcard   (1u << 15u) /* Trivial search with wildcard ids */
 #define EcsIterCppEach                 (1u << 16u) /* Uses C++ 'each' iterator */
+#define EcsIterCached                  (1u << 17u) /* Iterator replays cached rule results */
+#define EcsIterChangedRows             (1u << 18u) /* Only yield rows that changed */
 
 ////////////////////////////////////////////////////////////////////////////////
 //// Event flags (used by ecs_event_decs_t::flags)
@@ -438,6 +483,8 @@ extern "C" {
 #define EcsFilterHasWildcards          (1u << 16u) /* Filter has no up traversal */
 #define EcsFilterOwnsStorage           (1u << 17u) /* Is ecs_filter_t object owned by filter */
 #define EcsFilterOwnsTermsStorage      (1u << 18u) /* Is terms array owned by filter */
+#define EcsFilterHasSparse             (1u << 19u) /* Filter has terms for sparse components */
+#define EcsFilterCacheResults          (1u << 20u) /* Cache results of rule */
 
 ////////////////////////////////////////////////////////////////////////////////
 //// Observer flags (used by ecs_observer_t::flags)
@@ -476,6 +523,7 @@ extern "C" {
 #define EcsTableHasOnTableEmpty        (1u << 21u)
 #define EcsTableHasOnTableCreate       (1u << 22u)
 #define EcsTableHasOnTableDelete       (1u << 23u)
+#define EcsTableHasRowVersions         (1u << 24u) /* Does table track per-row versions */
 
 #define EcsTableHasTraversable         (1u << 25u)
 #define EcsTableHasTarget              (1u << 26u)
@@ -484,7 +532,7 @@ extern "C" {
 
 /* Composite table flags */
 #define EcsTableHasLifecycle        (EcsTableHasCtors | EcsTableHasDtors)
-#define EcsTableIsComplex           (EcsTableHasLifecycle | EcsTableHasUnion | EcsTableHasToggle)
+#define EcsTableIsComplex           (EcsTableHasLifecycle | EcsTableHasUnion | EcsTableHasToggle | EcsTableHasRowVersions)
 #define EcsTableHasAddActions       (EcsTableHasIsA | EcsTableHasUnion | EcsTableHasCtors | EcsTableHasOnAdd | EcsTableHasOnSet)
 #define EcsTableHasRemoveActions    (EcsTableHasIsA | EcsTableHasDtors | EcsTableHasOnRemove | EcsTableHasUnSet)
 
@@ -1267,6 +1315,19 @@ void flecs_sparse_remove(
 #define flecs_sparse_remove_t(sparse, T, id)\
     flecs_sparse_remove(sparse, ECS_SIZEOF(T), id)
 
+/** Remove an element without increasing the generation count of its id. */
+FLECS_DBG_API
+void flecs_sparse_remove_fast(
+    ecs_sparse_t *sparse,
+    ecs_size_t elem_size,
+    uint64_t id);
+
+/** Test if set contains an element for id, ignoring the generation count. */
+FLECS_DBG_API
+bool flecs_sparse_has(
+    const ecs_sparse_t *sparse,
+    uint64_t id);
+
 /** Test if id is alive, which requires the generation count to match. */
 FLECS_DBG_API
 bool flecs_sparse_is_alive(
@@ -1423,7 +1484,10 @@ typedef struct ecs_block_allocator_t {
     int32_t data_size;
     int32_t chunks_per_block;
     int32_t block_size;
-    int32_t alloc_count;
+    int32_t block_count;      /* Number of allocated blocks */
+    int32_t alloc_count;      /* Chunks in use (FLECS_ALLOCATOR_STATS) */
+    int32_t alloc_count_max;  /* High-water mark (FLECS_ALLOCATOR_STATS) */
+    int32_t align;
 } ecs_block_allocator_t;
 
 FLECS_API
@@ -1431,6 +1495,14 @@ void flecs_ballocator_init(
     ecs_block_allocator_t *ba,
     ecs_size_t size);
 
+/* Init block allocator that returns chunks aligned to the specified alignment,
+ * which must be a power of two. Chunk sizes are padded to the alignment. */
+FLECS_API
+void flecs_ballocator_init_aligned(
+    ecs_block_allocator_t *ba,
+    ecs_size_t size,
+    ecs_size_t align);
+
 #define flecs_ballocator_init_t(ba, T)\
     flecs_ballocator_init(ba, ECS_SIZEOF(T))
 #define flecs_ballocator_init_n(ba, T, count)\
@@ -1689,12 +1761,20 @@ FLECS_DBG_API extern int64_t ecs_stack_allocator_free_count;
 struct ecs_allocator_t {
     ecs_block_allocator_t chunks;
     struct ecs_sparse_t sizes; /* <size, block_allocator_t> */
+    ecs_size_t align;
 };
 
 FLECS_API
 void flecs_allocator_init(
     ecs_allocator_t *a);
 
+/* Init allocator that returns memory aligned to the specified alignment, which
+ * must be a power of two. Allocation sizes are padded to the alignment. */
+FLECS_API
+void flecs_allocator_init_aligned(
+    ecs_allocator_t *a,
+    ecs_size_t align);
+
 FLECS_API
 void flecs_allocator_fini(
     ecs_allocator_t *a);
@@ -2019,6 +2099,26 @@ typedef
 char* (*ecs_os_api_strdup_t)(
     const char *str);
 
+/* Virtual memory */
+typedef
+void* (*ecs_os_api_vmem_reserve_t)(
+    ecs_size_t size);
+
+typedef
+bool (*ecs_os_api_vmem_commit_t)(
+    void *ptr,
+    ecs_size_t size);
+
+typedef
+void (*ecs_os_api_vmem_decommit_t)(
+    void *ptr,
+    ecs_size_t size);
+
+typedef
+void (*ecs_os_api_vmem_release_t)(
+    void *ptr,
+    ecs_size_t size);
+
 /* Threads */
 typedef
 void* (*ecs_os_thread_callback_t)(
@@ -2158,6 +2258,15 @@ typedef struct ecs_os_api_t {
     /* Strings */
     ecs_os_api_strdup_t strdup_;
 
+    /* Virtual memory. Reserve address space without backing memory, commit
+     * (a range of) reserved pages, decommit pages and release the reservation.
+     * Commit and decommit round to page boundaries. When set, large component
+     * columns are stored in reserved memory so they can grow without copying. */
+    ecs_os_api_vmem_reserve_t vmem_reserve_;
+    ecs_os_api_vmem_commit_t vmem_commit_;
+    ecs_os_api_vmem_decommit_t vmem_decommit_;
+    ecs_os_api_vmem_release_t vmem_release_;
+
     /* Threads */
     ecs_os_api_thread_new_t thread_new_;
     ecs_os_api_thread_join_t thread_join_;
@@ -2266,6 +2375,21 @@ void ecs_os_set_api_defaults(void);
 #ifndef ecs_os_calloc
 #define ecs_os_calloc(size) ecs_os_api.calloc_(size)
 #endif
+
+/* Virtual memory */
+#ifndef ecs_os_vmem_reserve
+#define ecs_os_vmem_reserve(size) ecs_os_api.vmem_reserve_(size)
+#endif
+#ifndef ecs_os_vmem_commit
+#define ecs_os_vmem_commit(ptr, size) ecs_os_api.vmem_commit_(ptr, size)
+#endif
+#ifndef ecs_os_vmem_decommit
+#define ecs_os_vmem_decommit(ptr, size) ecs_os_api.vmem_decommit_(ptr, size)
+#endif
+#ifndef ecs_os_vmem_release
+#define ecs_os_vmem_release(ptr, size) ecs_os_api.vmem_release_(ptr, size)
+#endif
+
 #if defined(ECS_TARGET_WINDOWS)
 #define ecs_os_alloca(size) _alloca((size_t)(size))
 #else
@@ -2472,6 +2596,10 @@ void* ecs_os_memdup(
 FLECS_API
 bool ecs_os_has_heap(void);
 
+/** Are virtual memory functions available? */
+FLECS_API
+bool ecs_os_has_vmem(void);
+
 /** Are threading functions available? */
 FLECS_API
 bool ecs_os_has_threading(void);
@@ -2693,6 +2821,9 @@ typedef struct ecs_id_record_t ecs_id_record_t;
 /** Information about where in a table a specific (component) id is stored. */
 typedef struct ecs_table_record_t ecs_table_record_t;
 
+/** Queue that accepts commands from multiple threads without locking. */
+typedef struct ecs_cmd_queue_t ecs_cmd_queue_t;
+
 /** A poly object.
  * A poly (short for polymorph) object is an object that has a variable list of
  * capabilities, determined by a mixin table. This is the current list of types
@@ -2799,6 +2930,12 @@ typedef int (*ecs_order_by_action_t)(
     ecs_entity_t e2,
     const void *ptr2);
 
+/** Callback used for extracting a sort key from a component. Entities are 
+ * ordered by ascending key. */
+typedef uint64_t (*ecs_order_by_key_action_t)(
+    ecs_entity_t e,
+    const void *ptr);
+
 /** Callback used for sorting the entire table of components */
 typedef void (*ecs_sort_table_action_t)(
     ecs_world_t* world,
@@ -2945,6 +3082,7 @@ typedef enum ecs_oper_kind_t {
 #define EcsTermIdInherited            (1u << 6)
 #define EcsTermIsTrivial              (1u << 7)
 #define EcsTermNoData                 (1u << 8)
+#define EcsTermIsSparse               (1u << 9)
 
 /* Term flags used for term iteration */
 #define EcsTermMatchDisabled          (1u << 7)
@@ -2996,6 +3134,16 @@ struct ecs_term_t {
     bool move;                  /**< Used by internals */
 };
 
+/** Number of 64bit words in an id signature */
+#define FLECS_ID_SIGNATURE_WORDS (4)
+
+/** Fixed size signature of hashed ids. Signatures are used to reject tables
+ * that can't match a filter without looking up table records. A signature may
+ * report false positives, but never false negatives. */
+typedef struct ecs_id_signature_t {
+    uint64_t bits[FLECS_ID_SIGNATURE_WORDS];
+} ecs_id_signature_t;
+
 /** Use $this variable to initialize user-allocated filter object */
 FLECS_API extern ecs_filter_t ECS_FILTER_INIT;
 
@@ -3009,6 +3157,12 @@ struct ecs_filter_t {
     ecs_flags64_t data_fields; /**< Bitset with fields that have data */
 
     ecs_term_t *terms;         /**< Array containing terms for filter */
+
+    ecs_id_signature_t signature;      /**< Ids a matched table must have */
+    ecs_id_signature_t signature_up;   /**< Ids a matched table must have, unless
+                                        * it has signature_trav */
+    ecs_id_signature_t signature_trav; /**< Relationship traversed for ids in
+                                        * signature_up */
     char *variable_names[1];   /**< Placeholder variable names array */
     int32_t *sizes;            /**< Field size (same for each result) */
     ecs_id_t *ids;             /**< Array with field ids */
@@ -3233,8 +3387,19 @@ typedef struct ecs_page_iter_t {
 typedef struct ecs_worker_iter_t {
     int32_t index;
     int32_t count;
+
+    /* Used by ecs_balanced_worker_iter */
+    ecs_query_table_match_t *first, *last; /* First & last match of worker */
+    int32_t first_row, last_row;           /* Rows in first & last match */
+    bool balanced;
 } ecs_worker_iter_t;
 
+/* Chunk-iterator specific data */
+typedef struct ecs_chunk_iter_t {
+    int32_t size;      /* Chunk size (power of two) */
+    int32_t remaining; /* Rows remaining in current result of chained iter */
+} ecs_chunk_iter_t;
+
 /* Convenience struct to iterate table array for id */
 typedef struct ecs_table_cache_iter_t {
     struct ecs_table_cache_hdr_t *cur, *next;
@@ -3291,6 +3456,15 @@ typedef struct ecs_query_iter_t {
     int32_t sparse_first;
     int32_t bitset_first;
     int32_t skip_count;
+
+    /* Changed rows iteration */
+    ecs_query_table_match_t *changed_match;
+    int32_t changed_row;
+    int32_t changed_offset;
+    int32_t changed_count;
+    int32_t changed_frame_offset;
+    bool changed_active;
+    bool changed_yielded;
 } ecs_query_iter_t;
 
 /** Snapshot-iterator specific data */
@@ -3301,7 +3475,9 @@ typedef struct ecs_snapshot_iter_t {
 } ecs_snapshot_iter_t;
 
 typedef struct ecs_rule_op_profile_t {
-    int32_t count[2]; /* 0 = enter, 1 = redo */
+    int32_t count[2];     /* 0 = enter, 1 = redo */
+    int32_t match_count;  /* Number of times operation returned a match */
+    double time_spent;    /* Time spent in operation, incl. nested ops (sec) */
 } ecs_rule_op_profile_t;
 
 /** Rule-iterator specific data */
@@ -3314,9 +3490,8 @@ typedef struct ecs_rule_iter_t {
     uint64_t *written;
     ecs_flags32_t source_set;
 
-#ifdef FLECS_DEBUG
-    ecs_rule_op_profile_t *profile;
-#endif
+    ecs_rule_op_profile_t *profile;      /* Only set if EcsIterProfile is set */
+    int32_t cache_index;                 /* Only used if EcsIterCached is set */
 
     int16_t op;
     int16_t sp;
@@ -3351,6 +3526,7 @@ typedef struct ecs_iter_private_t {
         ecs_snapshot_iter_t snapshot;
         ecs_page_iter_t page;
         ecs_worker_iter_t worker;
+        ecs_chunk_iter_t chunk;
     } iter;                       /* Iterator specific data */
 
     void *entity_iter;            /* Filter applied after matching a table */
@@ -3377,6 +3553,7 @@ struct ecs_iter_t {
                                    * all permutations of wildcards in query. */
     ecs_ref_t *references;        /* Cached refs to components (if iterating a cache) */
     ecs_flags64_t constrained_vars; /* Bitset that marks constrained variables */
+    ecs_flags32_t sparse_fields;  /* Bitset that marks sparse fields that are set */
     uint64_t group_id;            /* Group id for table, if group_by is used */
     int32_t field_count;          /* Number of fields in iterator */
 
@@ -3832,6 +4009,11 @@ typedef struct ecs_query_desc_t {
      * but more efficient. */
     ecs_sort_table_action_t sort_table;
 
+    /** Callback that returns a sort key for ordering query results. Results
+     * are ordered by ascending key with a radix sort, which is faster than
+     * ordering with a compare function. Cannot be combined with order_by. */
+    ecs_order_by_key_action_t order_by_key;
+
     /** Id to be used by group_by. This id is passed to the group_by function and
      * can be used identify the part of an entity type that should be used for
      * grouping. */
@@ -3983,6 +4165,25 @@ typedef struct ecs_event_desc_t {
     ecs_flags32_t flags;
 } ecs_event_desc_t;
 
+/** Used with ecs_cmd_queue_new().
+ *
+ * @ingroup commands
+ */
+typedef struct ecs_cmd_queue_desc_t {
+    /** Maximum number of commands that can be in the queue. If left to 0, a
+     * default capacity of 4096 commands is used. */
+    int32_t capacity;
+
+    /** Number of bytes reserved per command for component values. Values that
+     * don't fit are stored in a separate allocation. If left to 0, a default of
+     * 64 bytes is used. */
+    ecs_size_t value_size;
+
+    /** Pipeline phase in which the queue is drained. If left to 0, the queue
+     * must be drained manually with ecs_cmd_queue_drain(). */
+    ecs_entity_t phase;
+} ecs_cmd_queue_desc_t;
+
 
 /**
  * @defgroup misc_types Miscellaneous types
@@ -4061,6 +4262,7 @@ typedef struct ecs_world_info_t {
         int64_t other_count;           /**< Other commands processed */
         int64_t batched_entity_count;  /**< Entities for which commands were batched */
         int64_t batched_command_count; /**< Commands batched */
+        int64_t parallel_entity_count; /**< Entities moved by parallel merge */
     } cmd;
 
     const char *name_prefix;          /**< Value set by ecs_set_name_prefix(). Used
@@ -4319,6 +4521,13 @@ FLECS_API extern const ecs_entity_t EcsTarget;
  * relationships are also marked as exclusive. */
 FLECS_API extern const ecs_entity_t EcsUnion;
 
+/** Tag to indicate that a component is stored outside of tables. Adding or
+ * removing a sparse component does not move an entity to another table, which
+ * makes it a good fit for components that are frequently added and removed. 
+ * Sparse components must be registered before they are used, cannot be
+ * inherited and do not emit OnAdd/OnRemove/OnSet events. */
+FLECS_API extern const ecs_entity_t EcsSparse;
+
 /** Tag to indicate name identifier */
 FLECS_API extern const ecs_entity_t EcsName;
 
@@ -4864,6 +5073,51 @@ void ecs_set_automerge(
     ecs_world_t *world,
     bool automerge);
 
+/** Enable/disable combined merging of stages.
+ * By default the command queue of each stage is flushed separately when stages
+ * are merged. When combined merging is enabled, the commands of all stages are
+ * gathered in a single queue before they are flushed. This allows commands for
+ * the same entity from different stages to be batched, so that the entity only
+ * moves tables once.
+ *
+ * Commands are applied in stage order: commands from stage 0 are applied before
+ * commands from stage 1 and so on, which is the same order in which they are
+ * applied when combined merging is disabled.
+ *
+ * @param world The world.
+ * @param enable Whether to enable or disable combined merging.
+ */
+FLECS_API
+void ecs_set_combined_merge(
+    ecs_world_t *world,
+    bool enable);
+
+/** Enable/disable parallel merging of commands.
+ * When parallel merging is enabled, entities that are moved to a different 
+ * table by the commands in a queue are moved on the worker threads. Entities
+ * that are moved between tables that don't share a source or destination table
+ * are moved in parallel. Table creation and observers run on the main thread.
+ *
+ * An entity is only moved in parallel if its tables have no OnAdd/OnRemove
+ * observers or on_add/on_remove hooks, and if its commands only add, remove or
+ * set components. Commands after the first delete, clear, event or other
+ * command that isn't batched are never moved in parallel.
+ *
+ * Entities that are moved in parallel are moved before the other commands in
+ * the queue are applied. OnSet observers for their set commands are still 
+ * invoked in queue order.
+ *
+ * Parallel merging only takes effect if the world has worker threads that are
+ * idle, which is the case when stages are merged after ecs_readonly_end.
+ *
+ * @param world The world.
+ * @param enable Whether to enable or disable parallel merging.
+ */
+FLECS_API
+void ecs_set_parallel_merge(
+    ecs_world_t *world,
+    bool enable);
+
 /** Configure world to have N stages.
  * This initializes N stages, which allows applications to defer operations to
  * multiple isolated defer queues. This is typically used for applications with
@@ -4976,6 +5230,138 @@ FLECS_API
 bool ecs_stage_is_async(
     ecs_world_t *stage);
 
+/** Create command queue.
+ * A command queue allows any number of threads to enqueue commands for the
+ * world without locking, for example from I/O or network threads that are not
+ * managed by flecs. Commands are applied to the world when the queue is 
+ * drained, which is always done by a single thread.
+ *
+ * Unlike an asynchronous stage, a command queue can be written to by multiple
+ * threads at the same time. Threads that enqueue commands may not otherwise 
+ * access the world, and can only enqueue commands for existing entities.
+ *
+ * Component values are copied bitwise into the queue, so only components that
+ * can be trivially copied should be enqueued with ecs_cmd_queue_set().
+ *
+ * If a phase is provided, the queue is drained by a system that runs in that
+ * phase. This requires the FLECS_PIPELINE addon.
+ *
+ * A command queue must be cleaned up with ecs_cmd_queue_free().
+ *
+ * @param world The world.
+ * @param desc Queue parameters (optional).
+ * @return The command queue.
+ */
+FLECS_API
+ecs_cmd_queue_t* ecs_cmd_queue_new(
+    ecs_world_t *world,
+    const ecs_cmd_queue_desc_t *desc);
+
+/** Free command queue.
+ * Commands that have not been drained are discarded. The operation must not be
+ * called while other threads are enqueueing commands.
+ *
+ * @param queue The queue to free.
+ */
+FLECS_API
+void ecs_cmd_queue_free(
+    ecs_cmd_queue_t *queue);
+
+/** Enqueue add command.
+ * This operation may be called from any thread. Commands are applied in the
+ * order in which they are enqueued. If the queue is full, the command is not 
+ * enqueued.
+ *
+ * @param queue The queue.
+ * @param entity The entity.
+ * @param id The id to add.
+ * @return True if the command was enqueued, false if the queue is full.
+ */
+FLECS_API
+bool ecs_cmd_queue_add(
+    ecs_cmd_queue_t *queue,
+    ecs_entity_t entity,
+    ecs_id_t id);
+
+/** Enqueue remove command.
+ * See ecs_cmd_queue_add().
+ *
+ * @param queue The queue.
+ * @param entity The entity.
+ * @param id The id to remove.
+ * @return True if the command was enqueued, false if the queue is full.
+ */
+FLECS_API
+bool ecs_cmd_queue_remove(
+    ecs_cmd_queue_t *queue,
+    ecs_entity_t entity,
+    ecs_id_t id);
+
+/** Enqueue set command.
+ * The value is copied into the queue. See ecs_cmd_queue_add().
+ *
+ * @param queue The queue.
+ * @param entity The entity.
+ * @param id The component to set.
+ * @param size The size of the component.
+ * @param ptr Pointer to the value.
+ * @return True if the command was enqueued, false if the queue is full.
+ */
+FLECS_API
+bool ecs_cmd_queue_set(
+    ecs_cmd_queue_t *queue,
+    ecs_entity_t entity,
+    ecs_id_t id,
+    size_t size,
+    const void *ptr);
+
+/** Enqueue delete command.
+ * See ecs_cmd_queue_add().
+ *
+ * @param queue The queue.
+ * @param entity The entity to delete.
+ * @return True if the command was enqueued, false if the queue is full.
+ */
+FLECS_API
+bool ecs_cmd_queue_delete(
+    ecs_cmd_queue_t *queue,
+    ecs_entity_t entity);
+
+/** Enqueue event command.
+ * When drained, the event is emitted for the entity with the provided id. See
+ * ecs_cmd_queue_add().
+ *
+ * @param queue The queue.
+ * @param event The event to emit.
+ * @param entity The entity for which to emit the event.
+ * @param id The (component) id for which to emit the event.
+ * @return True if the command was enqueued, false if the queue is full.
+ */
+FLECS_API
+bool ecs_cmd_queue_emit(
+    ecs_cmd_queue_t *queue,
+    ecs_entity_t event,
+    ecs_entity_t entity,
+    ecs_id_t id);
+
+/** Apply enqueued commands.
+ * This applies the commands in the queue to the provided world or stage. When
+ * the world is deferred, commands are added to the current command queue of
+ * the world or stage. Commands for entities that are no longer alive are
+ * skipped. Commands that are enqueued while the queue is drained may be 
+ * applied in the next drain.
+ *
+ * Only one thread may drain a queue at a time.
+ *
+ * @param world The world or stage.
+ * @param queue The queue.
+ * @return The number of drained commands.
+ */
+FLECS_API
+int32_t ecs_cmd_queue_drain(
+    ecs_world_t *world,
+    ecs_cmd_queue_t *queue);
+
 /** @} */
 
 /**
@@ -5096,6 +5482,25 @@ bool ecs_enable_range_check(
     ecs_world_t *world,
     bool enable);
 
+/** Enable/disable aligned component columns.
+ * When enabled, component columns are allocated with an alignment of
+ * FLECS_COLUMN_ALIGNMENT bytes, and the column allocation is padded to a 
+ * multiple of the alignment. This allows for processing columns with aligned
+ * (SIMD) loads and stores, including for the last block of a column.
+ *
+ * Existing tables are moved to the new storage when this function is called.
+ * This operation must not be invoked while the world is in readonly or deferred
+ * mode, or while snapshots of the world exist.
+ *
+ * @param world The world.
+ * @param enable True if aligned columns should be enabled, false to disable.
+ * @return The previous value.
+ */
+FLECS_API
+bool ecs_enable_aligned_columns(
+    ecs_world_t *world,
+    bool enable);
+
 /** Get the largest issued entity id (not counting generation).
  *
  * @param world The world.
@@ -5498,6 +5903,46 @@ void ecs_remove_all(
     ecs_world_t *world,
     ecs_id_t id);
 
+/** Add a (component) id to a range of entities in a table.
+ * This operation adds an id to all entities in the specified range. The range
+ * is moved to the destination table at once, which copies each component once
+ * for the entire range and emits a single OnAdd event. This is faster than 
+ * calling ecs_add_id() for each entity.
+ *
+ * If both offset and count are 0, the id is added to all entities in the table.
+ * When the world is deferred, an add command is enqueued for each entity.
+ *
+ * @param world The world.
+ * @param table The table.
+ * @param offset The first row of the range.
+ * @param count The number of entities in the range.
+ * @param id The id to add.
+ */
+FLECS_API
+void ecs_bulk_add_id(
+    ecs_world_t *world,
+    ecs_table_t *table,
+    int32_t offset,
+    int32_t count,
+    ecs_id_t id);
+
+/** Remove a (component) id from a range of entities in a table.
+ * Same as ecs_bulk_add_id(), but removes the id. The id may be a wildcard.
+ *
+ * @param world The world.
+ * @param table The table.
+ * @param offset The first row of the range.
+ * @param count The number of entities in the range.
+ * @param id The id to remove.
+ */
+FLECS_API
+void ecs_bulk_remove_id(
+    ecs_world_t *world,
+    ecs_table_t *table,
+    int32_t offset,
+    int32_t count,
+    ecs_id_t id);
+
 /** Set current with id.
  * New entities are automatically created with the specified id.
  *
@@ -7449,6 +7894,33 @@ bool ecs_query_changed(
     ecs_query_t *query,
     const ecs_iter_t *it);
 
+/** Create a changed rows iterator for a query.
+ * A changed rows iterator only returns the entities that were added to a
+ * matched table, or for which a monitored (read) component was written since
+ * the last time the query was iterated. Components are marked as written by 
+ * ecs_modified() and its variants, and by queries with [out] or [inout] terms 
+ * for the entities they iterate. Writes by the changed rows iterator itself
+ * are not returned by the next iteration.
+ *
+ * Tables start tracking per entity versions the first time they are visited by
+ * a changed rows iterator, and all entities of a table are returned on the 
+ * first visit. Tables that did not change since the last iteration are skipped
+ * without evaluating their entities. If a matched component from a shared 
+ * source (like a parent or prefab) changed, all entities of the table are
+ * returned. Entities that were deleted are not reported.
+ *
+ * The changed state is stored in the query, so the query should not also be
+ * iterated with a regular iterator while using change detection.
+ *
+ * @param world The world or stage, when iterating in multiple threads.
+ * @param query The query to iterate.
+ * @return The query iterator.
+ */
+FLECS_API
+ecs_iter_t ecs_query_changed_iter(
+    const ecs_world_t *world,
+    ecs_query_t *query);
+
 /** Skip a table while iterating.
  * This operation lets the query iterator know that a table was skipped while
  * iterating. A skipped table will not reset its changed state, and the query
@@ -7586,6 +8058,17 @@ FLECS_API
 void* ecs_query_get_binding_ctx(
     const ecs_query_t *query);
 
+/** Convert floating point value to sort key.
+ * The returned key has the same order as the floating point value, which makes
+ * it possible to sort by floating point values with ecs_query_desc_t::order_by_key.
+ *
+ * @param value The value.
+ * @return The sort key.
+ */
+FLECS_API
+uint64_t ecs_float_to_sort_key(
+    double value);
+
 /** @} */
 
 /**
@@ -7767,6 +8250,31 @@ FLECS_API
 int32_t ecs_iter_count(
     ecs_iter_t *it);
 
+/** Add (component) id to all entities matched by an iterator.
+ * This operation iterates the iterator until it yields no more results, after
+ * which the id is added to all returned entities. Entities are moved in ranges
+ * per table with ecs_bulk_add_id(), which is faster than calling ecs_add_id()
+ * for each entity.
+ *
+ * @param it The iterator.
+ * @param id The id to add.
+ */
+FLECS_API
+void ecs_iter_add_id(
+    ecs_iter_t *it,
+    ecs_id_t id);
+
+/** Remove (component) id from all entities matched by an iterator.
+ * Same as ecs_iter_add_id(), but removes the id.
+ *
+ * @param it The iterator.
+ * @param id The id to remove.
+ */
+FLECS_API
+void ecs_iter_remove_id(
+    ecs_iter_t *it,
+    ecs_id_t id);
+
 /** Test if iterator is true.
  * This operation will return true if the iterator returns at least one result.
  * This is especially useful in combination with fact-checking rules (see the
@@ -8002,8 +8510,38 @@ ecs_iter_t ecs_worker_iter(
     int32_t index,
     int32_t count);
 
+/** Create a balanced worker iterator.
+ * Balanced worker iterators divide the matched entities across N resources
+ * by assigning each resource a contiguous range of the matched entities. Only
+ * the tables at the start and end of a range are divided between resources,
+ * which avoids that each resource has to visit every matched table. This is
+ * faster than ecs_worker_iter() for queries that match many small tables.
+ *
+ * Unlike ecs_worker_iter(), the distribution is not stable between queries, as
+ * which resource an entity is assigned to depends on the other tables matched
+ * by the query. Code that relies on two queries processing the same entities on
+ * the same resource should use ecs_worker_iter().
+ *
+ * Entities can only be assigned up front when the source iterator is a query
+ * iterator that has not yet been progressed. For other iterators the function
+ * falls back to the behavior of ecs_worker_iter().
+ *
+ * The iterator must be iterated with ecs_worker_next().
+ *
+ * @param it The source iterator.
+ * @param index The index of the current resource.
+ * @param count The total number of resources to divide entities between.
+ * @return A worker iterator.
+ */
+FLECS_API
+ecs_iter_t ecs_balanced_worker_iter(
+    const ecs_iter_t *it,
+    int32_t index,
+    int32_t count);
+
 /** Progress a worker iterator.
- * Progresses an iterator created by ecs_worker_iter().
+ * Progresses an iterator created by ecs_worker_iter() or
+ * ecs_balanced_worker_iter().
  *
  * @param it The iterator.
  * @return true if iterator has more results, false if not.
@@ -8012,6 +8550,41 @@ FLECS_API
 bool ecs_worker_next(
     ecs_iter_t *it);
 
+/** Create a chunk iterator.
+ * Chunk iterators split the results of the parent iterator into pieces that
+ * never cross a table row that is a multiple of 'chunk_size'. If a result does
+ * not start on a chunk boundary, the first piece runs up to the next boundary.
+ * After that the iterator returns whole chunks, and a (partial) tail chunk.
+ *
+ * When aligned columns are enabled (see ecs_enable_aligned_columns()) and 
+ * chunk_size multiplied by the component size equals FLECS_COLUMN_ALIGNMENT,
+ * each chunk that starts on a boundary is aligned, and the full chunk can be 
+ * loaded and stored with vector instructions, including the tail chunk. In that
+ * case it->count is the number of valid elements (the mask) of the chunk.
+ *
+ * Chunk iterators are always instanced.
+ *
+ * The iterator must be iterated with ecs_chunk_next().
+ *
+ * @param it The source iterator.
+ * @param chunk_size The number of rows in a chunk. Must be a power of two.
+ * @return A chunk iterator.
+ */
+FLECS_API
+ecs_iter_t ecs_chunk_iter(
+    const ecs_iter_t *it,
+    int32_t chunk_size);
+
+/** Progress a chunk iterator.
+ * Progresses an iterator created by ecs_chunk_iter().
+ *
+ * @param it The iterator.
+ * @return true if iterator has more results, false if not.
+ */
+FLECS_API
+bool ecs_chunk_next(
+    ecs_iter_t *it);
+
 /** Obtain data for a query field.
  * This operation retrieves a pointer to an array of data that belongs to the
  * term in the query. The index refers to the location of the term in the query,
@@ -9680,6 +10253,9 @@ int ecs_value_move_ctor(
 #ifdef FLECS_NO_SNAPSHOT
 #undef FLECS_SNAPSHOT
 #endif
+#ifdef FLECS_NO_RECORDER
+#undef FLECS_RECORDER
+#endif
 #ifdef FLECS_NO_MONITOR
 #undef FLECS_MONITOR
 #endif
@@ -11367,6 +11943,42 @@ FLECS_API
 bool ecs_using_task_threads(
     ecs_world_t *world);
 
+/** Strategies for distributing work across worker threads. */
+typedef enum ecs_worker_sched_kind_t {
+    /** Each thread runs a fixed slice of every matched table. Threads are 
+     * synchronized with a mutex/condition variable (default). */
+    EcsWorkerSchedSlice,
+
+    /** Matched entities are split up in table range jobs which are distributed
+     * across per-thread job queues. Threads that run out of jobs steal jobs 
+     * from other threads. Threads spin briefly on sync points before they 
+     * block, which reduces the overhead of short pipeline operations. */
+    EcsWorkerSchedStealing
+} ecs_worker_sched_kind_t;
+
+/** Set the strategy used by worker threads to distribute work.
+ * The strategy applies to threads created with both ecs_set_threads() and
+ * ecs_set_task_threads(). If worker threads are already running, they are
+ * restarted with the new strategy. The operation may not be called while 
+ * running a system / pipeline.
+ *
+ * @param world The world.
+ * @param kind The scheduling strategy.
+ */
+FLECS_API
+void ecs_set_worker_sched(
+    ecs_world_t *world,
+    ecs_worker_sched_kind_t kind);
+
+/** Get the strategy used by worker threads to distribute work.
+ *
+ * @param world The world.
+ * @return The scheduling strategy.
+ */
+FLECS_API
+ecs_worker_sched_kind_t ecs_get_worker_sched(
+    const ecs_world_t *world);
+
 ////////////////////////////////////////////////////////////////////////////////
 //// Module
 ////////////////////////////////////////////////////////////////////////////////
@@ -11591,6 +12203,10 @@ ecs_entity_t ecs_run(
     void *param);
 
 /** Same as ecs_run(), but subdivides entities across number of provided stages.
+ * Each stage processes a contiguous range of the matched entities, so that a
+ * stage doesn't have to visit every matched table (see
+ * ecs_balanced_worker_iter()). Because the ranges depend on the tables matched
+ * by the system, two systems may process the same entity on different stages.
  *
  * @param world The world.
  * @param system The system to run.
@@ -11832,6 +12448,12 @@ typedef struct ecs_world_stats_t {
         ecs_metric_t stack_alloc_count;    /**< Page allocations per frame */
         ecs_metric_t stack_free_count;     /**< Page frees per frame */
         ecs_metric_t stack_outstanding_alloc_count; /**< Difference between allocs & frees */
+
+        /* Block allocator data (see ecs_allocator_stats_get) */
+        ecs_metric_t allocator_bytes_in_use;   /**< Bytes in chunks in use (requires FLECS_ALLOCATOR_STATS) */
+        ecs_metric_t allocator_bytes_reserved; /**< Bytes in blocks allocated by block allocators */
+        ecs_metric_t allocator_chunk_count;    /**< Chunks in use (requires FLECS_ALLOCATOR_STATS) */
+        ecs_metric_t allocator_block_count;    /**< Blocks allocated by block allocators */
     } memory;
 
     /* HTTP statistics */
@@ -11913,6 +12535,28 @@ typedef struct ecs_pipeline_stats_t {
     int32_t rebuild_count;       /**< Number of times pipeline has rebuilt */
 } ecs_pipeline_stats_t;
 
+/** Statistics for the block allocators of a single size class */
+typedef struct ecs_allocator_size_stats_t {
+    ecs_size_t size;               /**< Size of a single allocation (chunk) */
+    int32_t allocator_count;       /**< Number of allocators for this size */
+    int32_t block_count;           /**< Number of blocks allocated */
+    int32_t chunk_count;           /**< Number of chunks in use */
+    int32_t chunk_count_max;       /**< High-water mark of chunks in use */
+    int64_t bytes_in_use;          /**< Bytes in chunks that are in use */
+    int64_t bytes_reserved;        /**< Bytes in allocated blocks */
+} ecs_allocator_size_stats_t;
+
+/** Statistics for the allocators of a world (use ecs_allocator_stats_get()) */
+typedef struct ecs_allocator_stats_t {
+    int64_t bytes_in_use;          /**< Bytes in chunks that are in use */
+    int64_t bytes_reserved;        /**< Bytes in allocated blocks */
+    int32_t chunk_count;           /**< Number of chunks in use */
+    int32_t block_count;           /**< Number of blocks allocated */
+
+    /** Vector with stats per size class, ordered by size. */
+    ecs_vec_t sizes;               /**< vector<ecs_allocator_size_stats_t> */
+} ecs_allocator_stats_t;
+
 /** Get world statistics.
  *
  * @param world The world.
@@ -12084,6 +12728,32 @@ void ecs_pipeline_stats_copy_last(
 
 #endif
 
+/** Get allocator statistics.
+ * Obtain statistics for the block allocators of the world and its stages,
+ * grouped by allocation size. The number of chunks in use and the high-water
+ * marks are only tracked when FLECS_ALLOCATOR_STATS is defined, and are 0 
+ * otherwise. The high-water mark of a size class is the sum of the high-water
+ * marks of its allocators.
+ *
+ * The stats object must be zero-initialized before the first call, and can be
+ * reused for subsequent calls.
+ *
+ * @param world The world.
+ * @param stats Out parameter for statistics.
+ */
+FLECS_API
+void ecs_allocator_stats_get(
+    const ecs_world_t *world,
+    ecs_allocator_stats_t *stats);
+
+/** Free allocator stats.
+ *
+ * @param stats The stats to free.
+ */
+FLECS_API
+void ecs_allocator_stats_fini(
+    ecs_allocator_stats_t *stats);
+
 /** Reduce all measurements from a window into a single measurement. */
 FLECS_API
 void ecs_metric_reduce(
@@ -13146,7 +13816,7 @@ typedef struct ecs_iter_to_json_desc_t {
     bool serialize_field_info;      /**< Serialize metadata for fields returned by query */
     bool serialize_query_info;      /**< Serialize query terms */
     bool serialize_query_plan;      /**< Serialize query plan */
-    bool serialize_query_profile;   /**< Profile query performance */
+    bool serialize_query_profile;   /**< Profile query performance (per operation for rules) */
     bool dont_serialize_results;    /**< If true, query won't be evaluated */
     ecs_poly_t *query;              /**< Query object (required for serialize_query_[plan|profile]). */
 } ecs_iter_to_json_desc_t;
@@ -15349,6 +16019,15 @@ extern "C" {
  * Different terms with the same variable name are automatically correlated by
  * the query engine.
  *
+ * Rules created with the EcsFilterCacheResults flag store their results, and
+ * replay them when iterated. The results are kept up to date with observers on
+ * the ids of the rule: new tables are matched as they are created, while
+ * changes to entities that are used as sources, variables or are traversed
+ * cause results to be reevaluated the next time the rule is iterated. This
+ * is useful for rules that are evaluated frequently over data that changes
+ * infrequently. Rules that cannot be cached (for example, rules that match
+ * names or union relationships) are evaluated as regular rules.
+ *
  * A rule needs to be explicitly deleted with ecs_rule_fini().
  *
  * @param world The world.
@@ -15475,7 +16154,11 @@ char* ecs_rule_str(
  * starting iteration:
  *   it.flags |= EcsIterProfile
  *
+ * If the iterator is NULL, the profile accumulated by the rule is used (see
+ * ecs_rule_get_profile()).
+ *
  * @param rule The rule.
+ * @param it The iterator (optional).
  * @return The string
  */
 FLECS_API
@@ -15483,6 +16166,44 @@ char* ecs_rule_str_w_profile(
     const ecs_rule_t *rule,
     const ecs_iter_t *it);
 
+/** Rule profile. 
+ * Contains the number of times each operation of the rule program was entered,
+ * redone and returned a match, and the time spent evaluating it. Operations are
+ * in the same order as in the string returned by ecs_rule_str().
+ */
+typedef struct ecs_rule_profile_t {
+    const ecs_rule_op_profile_t *ops; /**< Profile for each operation */
+    int32_t op_count;                 /**< Number of operations */
+    int32_t iter_count;               /**< Number of profiled iterators */
+} ecs_rule_profile_t;
+
+/** Get profile of rule.
+ * Profiling is opt-in. When the EcsIterProfile flag is set on a rule iterator 
+ * before iteration starts, the iterator measures each operation, and adds the
+ * results to the rule profile when it is finished:
+ *   ecs_iter_t it = ecs_rule_iter(world, rule);
+ *   it.flags |= EcsIterProfile;
+ *   while (ecs_rule_next(&it)) { }
+ *
+ * The profile is accumulated until ecs_rule_reset_profile() is called. The 
+ * profile is also reset when the rule is replanned, as this can change the
+ * rule program.
+ *
+ * @param rule The rule.
+ * @return The profile. Operations are NULL if nothing was profiled.
+ */
+FLECS_API
+ecs_rule_profile_t ecs_rule_get_profile(
+    const ecs_rule_t *rule);
+
+/** Reset profile of rule.
+ *
+ * @param rule The rule.
+ */
+FLECS_API
+void ecs_rule_reset_profile(
+    ecs_rule_t *rule);
+
 /** Populate variables from key-value string.
  * Convenience function to set rule variables from a key-value string separated
  * by comma's. The string must have the following format:
@@ -15626,6 +16347,168 @@ void ecs_snapshot_free(
 
 #endif
 
+#ifdef FLECS_RECORDER
+#ifdef FLECS_NO_RECORDER
+#error "FLECS_NO_RECORDER failed: RECORDER is required by other addons"
+#endif
+/**
+ * @file addons/recorder.h
+ * @brief Command recorder addon.
+ *
+ * The recorder captures the commands that are merged with the world in a
+ * compact binary format. A recording can be replayed in another world, which
+ * applies the same command queues in the same order. This makes it possible to
+ * reproduce and benchmark merges of an application offline.
+ *
+ * Components, tags and relationships are stored by name, so that they can be
+ * resolved in a world where they have a different id. Entities are stored by
+ * id, and are made alive in the replaying world. Values of components without
+ * lifecycle hooks are stored as bytes. Values of components with hooks are
+ * stored as JSON if the component has reflection data, and are not recorded
+ * otherwise.
+ */
+
+#ifdef FLECS_RECORDER
+
+/**
+ * @defgroup c_addons_recorder Recorder
+ * @ingroup c_addons
+ * @brief Record & replay command queues.
+ *
+ * @{
+ */
+
+#ifndef FLECS_RECORDER_H
+#define FLECS_RECORDER_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** A recorder writes the commands merged with a world to a file or callback. */
+typedef struct ecs_recorder_t ecs_recorder_t;
+
+/** A replayer applies recorded commands to a world. */
+typedef struct ecs_replayer_t ecs_replayer_t;
+
+/** Callback invoked with recorded data. */
+typedef void (*ecs_recorder_write_action_t)(
+    const void *data,
+    ecs_size_t size,
+    void *ctx);
+
+/** Used with ecs_recorder_start(). */
+typedef struct ecs_recorder_desc_t {
+    /** File to write recording to. */
+    const char *filename;
+
+    /** Callback to write recording to, used if no filename is provided. The
+     * callback is invoked once for the stream header and once for each merged
+     * command queue. */
+    ecs_recorder_write_action_t callback;
+
+    /** Context passed to callback. */
+    void *ctx;
+} ecs_recorder_desc_t;
+
+/** Start recording commands.
+ * The recorder captures each command queue that is merged with the world, in
+ * the order in which they are merged. Commands that are enqueued by observers
+ * while a queue is merged are not recorded, as they are reproduced by the
+ * observers when the recording is replayed.
+ *
+ * Only one recorder can be active for a world at a time.
+ *
+ * @param world The world.
+ * @param desc Recorder parameters.
+ * @return The recorder, or NULL if failed.
+ */
+FLECS_API
+ecs_recorder_t* ecs_recorder_start(
+    ecs_world_t *world,
+    const ecs_recorder_desc_t *desc);
+
+/** Stop recording commands.
+ * This flushes and closes the recording. A recorder must be stopped before the
+ * world is deleted.
+ *
+ * @param recorder The recorder.
+ */
+FLECS_API
+void ecs_recorder_stop(
+    ecs_recorder_t *recorder);
+
+/** Create replayer from recorded data.
+ * The data is copied, and can be freed after this operation returns.
+ *
+ * @param world The world to replay the commands in.
+ * @param data The recorded data.
+ * @param size The size of the recorded data.
+ * @return The replayer, or NULL if the data is not a valid recording.
+ */
+FLECS_API
+ecs_replayer_t* ecs_replayer_new(
+    ecs_world_t *world,
+    const void *data,
+    ecs_size_t size);
+
+/** Create replayer from recording file.
+ *
+ * @param world The world to replay the commands in.
+ * @param filename The file with the recording.
+ * @return The replayer, or NULL if the file is not a valid recording.
+ */
+FLECS_API
+ecs_replayer_t* ecs_replayer_from_file(
+    ecs_world_t *world,
+    const char *filename);
+
+/** Replay commands of next recorded frame.
+ * Each recorded command queue is applied between a ecs_defer_begin() and
+ * ecs_defer_end(), so that the commands are merged in the same way as they
+ * were when the recording was made.
+ *
+ * @param replayer The replayer.
+ * @return 1 if a frame was replayed, 0 if no frames are left, -1 if failed.
+ */
+FLECS_API
+int ecs_replayer_next_frame(
+    ecs_replayer_t *replayer);
+
+/** Free replayer.
+ *
+ * @param replayer The replayer.
+ */
+FLECS_API
+void ecs_replayer_free(
+    ecs_replayer_t *replayer);
+
+/** Replay all commands of a recording.
+ * Convenience function that replays all frames of the recording.
+ *
+ * @param world The world to replay the commands in.
+ * @param data The recorded data.
+ * @param size The size of the recorded data.
+ * @return Zero if success, non-zero if failed.
+ */
+FLECS_API
+int ecs_replay(
+    ecs_world_t *world,
+    const void *data,
+    ecs_size_t size);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
+
+/** @} */
+
+#endif
+
+#endif
+
 #ifdef FLECS_PARSER
 #ifdef FLECS_NO_PARSER
 #error "FLECS_NO_PARSER failed: PARSER is required by other addons"
@@ -16245,6 +17128,7 @@ static const flecs::entity_t DontInherit = EcsDontInherit;
 static const flecs::entity_t AlwaysOverride = EcsAlwaysOverride;
 static const flecs::entity_t Tag = EcsTag;
 static const flecs::entity_t Union = EcsUnion;
+static const flecs::entity_t Sparse = EcsSparse;
 static const flecs::entity_t Exclusive = EcsExclusive;
 static const flecs::entity_t Acyclic = EcsAcyclic;
 static const flecs::entity_t Traversable = EcsTraversable;
@@ -20328,6 +21212,29 @@ struct world {
         ecs_set_automerge(m_world, automerge);
     }
 
+    /** Enable/disable combined merging of stages.
+     * When enabled, commands from all stages are gathered in a single queue
+     * before they are flushed, so that commands for the same entity from
+     * different stages are batched.
+     *
+     * @param enable Whether to enable or disable combined merging.
+     * @see ecs_set_combined_merge
+     */
+    void set_combined_merge(bool enable = true) const {
+        ecs_set_combined_merge(m_world, enable);
+    }
+
+    /** Enable/disable parallel merging of commands.
+     * When enabled, entities that are moved to a different table by commands
+     * are moved on the worker threads.
+     *
+     * @param enable Whether to enable or disable parallel merging.
+     * @see ecs_set_parallel_merge
+     */
+    void set_parallel_merge(bool enable = true) const {
+        ecs_set_parallel_merge(m_world, enable);
+    }
+
     /** Merge world or stage.
      * When automatic merging is disabled, an application can call this
      * operation on either an individual stage, or on the world which will merge
@@ -20470,6 +21377,18 @@ struct world {
         ecs_enable_range_check(m_world, enabled);
     }
 
+    /** Enable/disable aligned component columns.
+     * When enabled, component columns are aligned to FLECS_COLUMN_ALIGNMENT
+     * bytes and padded to a multiple of the alignment.
+     *
+     * @param enabled True if columns should be aligned, false if not.
+     * @return The previous value.
+     * @see ecs_enable_aligned_columns
+     */
+    bool enable_aligned_columns(bool enabled = true) const {
+        return ecs_enable_aligned_columns(m_world, enabled);
+    }
+
     /** Set current scope.
      *
      * @param scope The scope to set.
@@ -21464,6 +22383,16 @@ void set_task_threads(int32_t task_threads) const;
  */
 bool using_task_threads() const;
 
+/** Set strategy used by worker threads to distribute work.
+ * @see ecs_set_worker_sched
+ */
+void set_worker_sched(ecs_worker_sched_kind_t kind) const;
+
+/** Get strategy used by worker threads to distribute work.
+ * @see ecs_get_worker_sched
+ */
+ecs_worker_sched_kind_t get_worker_sched() const;
+
 /** @} */
 
 #   endif
@@ -22209,6 +23138,40 @@ public:
         return get_unchecked_field(index);
     }
 
+    /** Get aligned access to field data.
+     * Returns a pointer to the field data that the compiler may assume to be
+     * aligned to the specified alignment. This is guaranteed for owned fields
+     * when aligned columns are enabled (see world::enable_aligned_columns) and
+     * the result starts on a chunk boundary (see iterable::chunk).
+     *
+     * @tparam T Type of the field.
+     * @tparam Alignment The alignment of the field data.
+     * @param index The field index.
+     * @return Pointer to the field data.
+     */
+    template <typename T, size_t Alignment = FLECS_COLUMN_ALIGNMENT,
+        typename A = actual_type_t<T>>
+    T* field_aligned(int32_t index) const {
+        ecs_assert(std::is_const<T>::value || 
+            !ecs_field_is_readonly(m_iter, index),
+                ECS_ACCESS_VIOLATION, NULL);
+        ecs_assert(ecs_field_is_self(m_iter, index), 
+            ECS_INVALID_OPERATION, "aligned field must be owned");
+#ifndef FLECS_NDEBUG
+        ecs_entity_t term_id = ecs_field_id(m_iter, index);
+        ecs_assert(ECS_HAS_ID_FLAG(term_id, PAIR) ||
+            term_id == _::cpp_type<A>::id(m_iter->world),
+            ECS_COLUMN_TYPE_MISMATCH, NULL);
+#endif
+        void *ptr = ecs_field_w_size(m_iter, sizeof(A), index);
+        ecs_assert(!(reinterpret_cast<uintptr_t>(ptr) & (Alignment - 1)),
+            ECS_INVALID_OPERATION, "field data is not aligned");
+#if defined(__GNUC__) || defined(__clang__)
+        ptr = __builtin_assume_aligned(ptr, Alignment);
+#endif
+        return static_cast<T*>(ptr);
+    }
+
     /** Get pointer to field at row. */
     void* field_at(int32_t index, size_t row) const {
         return get_unchecked_field(index)[row];
@@ -25983,6 +26946,9 @@ struct page_iterable;
 template <typename ... Components>
 struct worker_iterable; 
 
+template <typename ... Components>
+struct chunk_iterable; 
+
 template <typename ... Components>
 struct iterable {
 
@@ -26083,6 +27049,16 @@ struct iterable {
      */
     worker_iterable<Components...> worker(int32_t index, int32_t count);
 
+    /** Chunk iterator.
+     * Create an iterator that splits results into chunks that don't cross a
+     * row that is a multiple of the chunk size.
+     * 
+     * @param size The number of rows in a chunk (must be a power of two).
+     * @return Iterable that can be iterated with each/iter.
+     * @see ecs_chunk_iter
+     */
+    chunk_iterable<Components...> chunk(int32_t size);
+
     /** Return number of entities matched by iterable. */
     int32_t count() const {
         return this->iter().count();
@@ -26103,6 +27079,7 @@ protected:
     friend iter_iterable<Components...>;
     friend page_iterable<Components...>;
     friend worker_iterable<Components...>;
+    friend chunk_iterable<Components...>;
 
     virtual ecs_iter_t get_iter(flecs::world_t *stage) const = 0;
     virtual ecs_iter_next_action_t next_action() const = 0;
@@ -26340,6 +27317,39 @@ worker_iterable<Components...> iterable<Components...>::worker(
     return worker_iterable<Components...>(index, count, this);
 }
 
+template <typename ... Components>
+struct chunk_iterable final : iterable<Components...> {
+    chunk_iterable(int32_t size, iterable<Components...> *it) 
+        : m_size(size)
+    {
+        m_chain_it = it->get_iter(nullptr);
+    }
+
+protected:
+    ecs_iter_t get_iter(flecs::world_t*) const {
+        return ecs_chunk_iter(&m_chain_it, m_size);
+    }
+
+    ecs_iter_next_action_t next_action() const {
+        return ecs_chunk_next;
+    }
+
+    ecs_iter_next_action_t next_each_action() const {
+        return ecs_chunk_next;
+    }
+
+private:
+    ecs_iter_t m_chain_it;
+    int32_t m_size;
+};
+
+template <typename ... Components>
+chunk_iterable<Components...> iterable<Components...>::chunk(
+    int32_t size) 
+{
+    return chunk_iterable<Components...>(size, this);
+}
+
 }
 
 /**
@@ -29361,6 +30371,33 @@ public:
         return *this;
     }
 
+    /** Sort the output of a query by key.
+     * Same as order_by<T>, but instead of comparing components the callback
+     * returns a key for each component. Entities are ordered by ascending key
+     * using a radix sort, which is faster than sorting with a compare function.
+     *
+     * @tparam T The component used to sort.
+     * @param key The function that returns the sort key for a component.
+     */
+    template <typename T>
+    Base& order_by_key(uint64_t(*key)(flecs::entity_t, const T*)) {
+        ecs_order_by_key_action_t action =
+            reinterpret_cast<ecs_order_by_key_action_t>(key);
+        return this->order_by_key(_::cpp_type<T>::id(this->world_v()), action);
+    }
+
+    /** Sort the output of a query by key.
+     * Same as order_by_key<T>, but with component identifier.
+     *
+     * @param component The component used to sort.
+     * @param key The function that returns the sort key for a component.
+     */
+    Base& order_by_key(flecs::entity_t component, uint64_t(*key)(flecs::entity_t, const void*)) {
+        m_desc->order_by_key = reinterpret_cast<ecs_order_by_key_action_t>(key);
+        m_desc->order_by_component = component;
+        return *this;
+    }
+
     /** Group and sort matched tables.
      * Similar to ecs_query_order_by(), but instead of sorting individual entities, this
      * operation only sorts matched tables. This can be useful of a query needs to
@@ -30686,6 +31723,14 @@ inline bool world::using_task_threads() const {
     return ecs_using_task_threads(m_world);
 }
 
+inline void world::set_worker_sched(ecs_worker_sched_kind_t kind) const {
+    ecs_set_worker_sched(m_world, kind);
+}
+
+inline ecs_worker_sched_kind_t world::get_worker_sched() const {
+    return ecs_get_worker_sched(m_world);
+}
+
 }
 
 #endif
@@ -177,6 +177,7 @@
 #define FLECS_PLECS         /**< ECS data definition format */
 #define FLECS_RULES         /**< Constraint solver for advanced queries */
 #define FLECS_SNAPSHOT      /**< Snapshot & restore ECS data */
+#define FLECS_RECORDER      /**< Record & replay command queues */
 #define FLECS_STATS         /**< Access runtime statistics */
 #define FLECS_MONITOR       /**< Track runtime statistics periodically */
 #define FLECS_METRICS       /**< Expose component data as statistics */
@@ -255,6 +256,41 @@
  * as memory will be freed more often, at the cost of decreased performance. */
 // #define FLECS_USE_OS_ALLOC
 
+/** @def FLECS_ALLOCATOR_STATS
+ * When enabled, block allocators keep track of the number of chunks in use and
+ * of the high-water mark of chunks in use. These are reported by 
+ * ecs_allocator_stats_get() and the world statistics. This adds a small 
+ * overhead to each allocation. Always enabled in sanitized builds. */
+// #define FLECS_ALLOCATOR_STATS
+#if defined(FLECS_SANITIZE) && !defined(FLECS_ALLOCATOR_STATS)
+#define FLECS_ALLOCATOR_STATS
+#endif
+
+/** @def FLECS_COLUMN_ALIGNMENT
+ * Alignment of component columns when aligned columns are enabled with
+ * ecs_enable_aligned_columns(). Column allocations are padded to a multiple of
+ * the alignment, so that code processing a column in blocks of this size never
+ * reads past the end of the allocation. Must be a power of two. */
+#ifndef FLECS_COLUMN_ALIGNMENT
+#define FLECS_COLUMN_ALIGNMENT (64)
+#endif
+
+/** @def FLECS_VMEM_COLUMN_THRESHOLD
+ * Size in bytes from which component columns are stored in reserved virtual
+ * memory, if the OS API provides virtual memory functions. Growing such columns
+ * commits more pages, and never moves existing elements. */
+#ifndef FLECS_VMEM_COLUMN_THRESHOLD
+#define FLECS_VMEM_COLUMN_THRESHOLD (1024 * 1024)
+#endif
+
+/** @def FLECS_VMEM_COLUMN_RESERVE
+ * Address space in bytes that is reserved for a column that is stored in 
+ * virtual memory. When a column outgrows its reservation it is moved to a new
+ * reservation that is twice the column size. */
+#ifndef FLECS_VMEM_COLUMN_RESERVE
+#define FLECS_VMEM_COLUMN_RESERVE (256 * 1024 * 1024)
+#endif
+
 /** @def FLECS_ID_DESC_MAX
  * Maximum number of ids to add ecs_entity_desc_t / ecs_bulk_desc_t */
 #ifndef FLECS_ID_DESC_MAX
@@ -476,6 +512,9 @@ typedef struct ecs_id_record_t ecs_id_record_t;
 /** Information about where in a table a specific (component) id is stored. */
 typedef struct ecs_table_record_t ecs_table_record_t;
 
+/** Queue that accepts commands from multiple threads without locking. */
+typedef struct ecs_cmd_queue_t ecs_cmd_queue_t;
+
 /** A poly object.
  * A poly (short for polymorph) object is an object that has a variable list of
  * capabilities, determined by a mixin table. This is the current list of types
@@ -582,6 +621,12 @@ typedef int (*ecs_order_by_action_t)(
     ecs_entity_t e2,
     const void *ptr2);
 
+/** Callback used for extracting a sort key from a component. Entities are 
+ * ordered by ascending key. */
+typedef uint64_t (*ecs_order_by_key_action_t)(
+    ecs_entity_t e,
+    const void *ptr);
+
 /** Callback used for sorting the entire table of components */
 typedef void (*ecs_sort_table_action_t)(
     ecs_world_t* world,
@@ -728,6 +773,7 @@ typedef enum ecs_oper_kind_t {
 #define EcsTermIdInherited            (1u << 6)
 #define EcsTermIsTrivial              (1u << 7)
 #define EcsTermNoData                 (1u << 8)
+#define EcsTermIsSparse               (1u << 9)
 
 /* Term flags used for term iteration */
 #define EcsTermMatchDisabled          (1u << 7)
@@ -779,6 +825,16 @@ struct ecs_term_t {
     bool move;                  /**< Used by internals */
 };
 
+/** Number of 64bit words in an id signature */
+#define FLECS_ID_SIGNATURE_WORDS (4)
+
+/** Fixed size signature of hashed ids. Signatures are used to reject tables
+ * that can't match a filter without looking up table records. A signature may
+ * report false positives, but never false negatives. */
+typedef struct ecs_id_signature_t {
+    uint64_t bits[FLECS_ID_SIGNATURE_WORDS];
+} ecs_id_signature_t;
+
 /** Use $this variable to initialize user-allocated filter object */
 FLECS_API extern ecs_filter_t ECS_FILTER_INIT;
 
@@ -792,6 +848,12 @@ struct ecs_filter_t {
     ecs_flags64_t data_fields; /**< Bitset with fields that have data */
 
     ecs_term_t *terms;         /**< Array containing terms for filter */
+
+    ecs_id_signature_t signature;      /**< Ids a matched table must have */
+    ecs_id_signature_t signature_up;   /**< Ids a matched table must have, unless
+                                        * it has signature_trav */
+    ecs_id_signature_t signature_trav; /**< Relationship traversed for ids in
+                                        * signature_up */
     char *variable_names[1];   /**< Placeholder variable names array */
     int32_t *sizes;            /**< Field size (same for each result) */
     ecs_id_t *ids;             /**< Array with field ids */
@@ -1050,6 +1112,11 @@ typedef struct ecs_query_desc_t {
      * but more efficient. */
     ecs_sort_table_action_t sort_table;
 
+    /** Callback that returns a sort key for ordering query results. Results
+     * are ordered by ascending key with a radix sort, which is faster than
+     * ordering with a compare function. Cannot be combined with order_by. */
+    ecs_order_by_key_action_t order_by_key;
+
     /** Id to be used by group_by. This id is passed to the group_by function and
      * can be used identify the part of an entity type that should be used for
      * grouping. */
@@ -1201,6 +1268,25 @@ typedef struct ecs_event_desc_t {
     ecs_flags32_t flags;
 } ecs_event_desc_t;
 
+/** Used with ecs_cmd_queue_new().
+ *
+ * @ingroup commands
+ */
+typedef struct ecs_cmd_queue_desc_t {
+    /** Maximum number of commands that can be in the queue. If left to 0, a
+     * default capacity of 4096 commands is used. */
+    int32_t capacity;
+
+    /** Number of bytes reserved per command for component values. Values that
+     * don't fit are stored in a separate allocation. If left to 0, a default of
+     * 64 bytes is used. */
+    ecs_size_t value_size;
+
+    /** Pipeline phase in which the queue is drained. If left to 0, the queue
+     * must be drained manually with ecs_cmd_queue_drain(). */
+    ecs_entity_t phase;
+} ecs_cmd_queue_desc_t;
+
 
 /**
  * @defgroup misc_types Miscellaneous types
@@ -1279,6 +1365,7 @@ typedef struct ecs_world_info_t {
         int64_t other_count;           /**< Other commands processed */
         int64_t batched_entity_count;  /**< Entities for which commands were batched */
         int64_t batched_command_count; /**< Commands batched */
+        int64_t parallel_entity_count; /**< Entities moved by parallel merge */
     } cmd;
 
     const char *name_prefix;          /**< Value set by ecs_set_name_prefix(). Used
@@ -1516,6 +1603,13 @@ FLECS_API extern const ecs_entity_t EcsTarget;
  * relationships are also marked as exclusive. */
 FLECS_API extern const ecs_entity_t EcsUnion;
 
+/** Tag to indicate that a component is stored outside of tables. Adding or
+ * removing a sparse component does not move an entity to another table, which
+ * makes it a good fit for components that are frequently added and removed. 
+ * Sparse components must be registered before they are used, cannot be
+ * inherited and do not emit OnAdd/OnRemove/OnSet events. */
+FLECS_API extern const ecs_entity_t EcsSparse;
+
 /** Tag to indicate name identifier */
 FLECS_API extern const ecs_entity_t EcsName;
 
@@ -2061,6 +2155,51 @@ void ecs_set_automerge(
     ecs_world_t *world,
     bool automerge);
 
+/** Enable/disable combined merging of stages.
+ * By default the command queue of each stage is flushed separately when stages
+ * are merged. When combined merging is enabled, the commands of all stages are
+ * gathered in a single queue before they are flushed. This allows commands for
+ * the same entity from different stages to be batched, so that the entity only
+ * moves tables once.
+ *
+ * Commands are applied in stage order: commands from stage 0 are applied before
+ * commands from stage 1 and so on, which is the same order in which they are
+ * applied when combined merging is disabled.
+ *
+ * @param world The world.
+ * @param enable Whether to enable or disable combined merging.
+ */
+FLECS_API
+void ecs_set_combined_merge(
+    ecs_world_t *world,
+    bool enable);
+
+/** Enable/disable parallel merging of commands.
+ * When parallel merging is enabled, entities that are moved to a different 
+ * table by the commands in a queue are moved on the worker threads. Entities
+ * that are moved between tables that don't share a source or destination table
+ * are moved in parallel. Table creation and observers run on the main thread.
+ *
+ * An entity is only moved in parallel if its tables have no OnAdd/OnRemove
+ * observers or on_add/on_remove hooks, and if its commands only add, remove or
+ * set components. Commands after the first delete, clear, event or other
+ * command that isn't batched are never moved in parallel.
+ *
+ * Entities that are moved in parallel are moved before the other commands in
+ * the queue are applied. OnSet observers for their set commands are still 
+ * invoked in queue order.
+ *
+ * Parallel merging only takes effect if the world has worker threads that are
+ * idle, which is the case when stages are merged after ecs_readonly_end.
+ *
+ * @param world The world.
+ * @param enable Whether to enable or disable parallel merging.
+ */
+FLECS_API
+void ecs_set_parallel_merge(
+    ecs_world_t *world,
+    bool enable);
+
 /** Configure world to have N stages.
  * This initializes N stages, which allows applications to defer operations to
  * multiple isolated defer queues. This is typically used for applications with
@@ -2173,6 +2312,138 @@ FLECS_API
 bool ecs_stage_is_async(
     ecs_world_t *stage);
 
+/** Create command queue.
+ * A command queue allows any number of threads to enqueue commands for the
+ * world without locking, for example from I/O or network threads that are not
+ * managed by flecs. Commands are applied to the world when the queue is 
+ * drained, which is always done by a single thread.
+ *
+ * Unlike an asynchronous stage, a command queue can be written to by multiple
+ * threads at the same time. Threads that enqueue commands may not otherwise 
+ * access the world, and can only enqueue commands for existing entities.
+ *
+ * Component values are copied bitwise into the queue, so only components that
+ * can be trivially copied should be enqueued with ecs_cmd_queue_set().
+ *
+ * If a phase is provided, the queue is drained by a system that runs in that
+ * phase. This requires the FLECS_PIPELINE addon.
+ *
+ * A command queue must be cleaned up with ecs_cmd_queue_free().
+ *
+ * @param world The world.
+ * @param desc Queue parameters (optional).
+ * @return The command queue.
+ */
+FLECS_API
+ecs_cmd_queue_t* ecs_cmd_queue_new(
+    ecs_world_t *world,
+    const ecs_cmd_queue_desc_t *desc);
+
+/** Free command queue.
+ * Commands that have not been drained are discarded. The operation must not be
+ * called while other threads are enqueueing commands.
+ *
+ * @param queue The queue to free.
+ */
+FLECS_API
+void ecs_cmd_queue_free(
+    ecs_cmd_queue_t *queue);
+
+/** Enqueue add command.
+ * This operation may be called from any thread. Commands are applied in the
+ * order in which they are enqueued. If the queue is full, the command is not 
+ * enqueued.
+ *
+ * @param queue The queue.
+ * @param entity The entity.
+ * @param id The id to add.
+ * @return True if the command was enqueued, false if the queue is full.
+ */
+FLECS_API
+bool ecs_cmd_queue_add(
+    ecs_cmd_queue_t *queue,
+    ecs_entity_t entity,
+    ecs_id_t id);
+
+/** Enqueue remove command.
+ * See ecs_cmd_queue_add().
+ *
+ * @param queue The queue.
+ * @param entity The entity.
+ * @param id The id to remove.
+ * @return True if the command was enqueued, false if the queue is full.
+ */
+FLECS_API
+bool ecs_cmd_queue_remove(
+    ecs_cmd_queue_t *queue,
+    ecs_entity_t entity,
+    ecs_id_t id);
+
+/** Enqueue set command.
+ * The value is copied into the queue. See ecs_cmd_queue_add().
+ *
+ * @param queue The queue.
+ * @param entity The entity.
+ * @param id The component to set.
+ * @param size The size of the component.
+ * @param ptr Pointer to the value.
+ * @return True if the command was enqueued, false if the queue is full.
+ */
+FLECS_API
+bool ecs_cmd_queue_set(
+    ecs_cmd_queue_t *queue,
+    ecs_entity_t entity,
+    ecs_id_t id,
+    size_t size,
+    const void *ptr);
+
+/** Enqueue delete command.
+ * See ecs_cmd_queue_add().
+ *
+ * @param queue The queue.
+ * @param entity The entity to delete.
+ * @return True if the command was enqueued, false if the queue is full.
+ */
+FLECS_API
+bool ecs_cmd_queue_delete(
+    ecs_cmd_queue_t *queue,
+    ecs_entity_t entity);
+
+/** Enqueue event command.
+ * When drained, the event is emitted for the entity with the provided id. See
+ * ecs_cmd_queue_add().
+ *
+ * @param queue The queue.
+ * @param event The event to emit.
+ * @param entity The entity for which to emit the event.
+ * @param id The (component) id for which to emit the event.
+ * @return True if the command was enqueued, false if the queue is full.
+ */
+FLECS_API
+bool ecs_cmd_queue_emit(
+    ecs_cmd_queue_t *queue,
+    ecs_entity_t event,
+    ecs_entity_t entity,
+    ecs_id_t id);
+
+/** Apply enqueued commands.
+ * This applies the commands in the queue to the provided world or stage. When
+ * the world is deferred, commands are added to the current command queue of
+ * the world or stage. Commands for entities that are no longer alive are
+ * skipped. Commands that are enqueued while the queue is drained may be 
+ * applied in the next drain.
+ *
+ * Only one thread may drain a queue at a time.
+ *
+ * @param world The world or stage.
+ * @param queue The queue.
+ * @return The number of drained commands.
+ */
+FLECS_API
+int32_t ecs_cmd_queue_drain(
+    ecs_world_t *world,
+    ecs_cmd_queue_t *queue);
+
 /** @} */
 
 /**
@@ -2293,6 +2564,25 @@ bool ecs_enable_range_check(
     ecs_world_t *world,
     bool enable);
 
+/** Enable/disable aligned component columns.
+ * When enabled, component columns are allocated with an alignment of
+ * FLECS_COLUMN_ALIGNMENT bytes, and the column allocation is padded to a 
+ * multiple of the alignment. This allows for processing columns with aligned
+ * (SIMD) loads and stores, including for the last block of a column.
+ *
+ * Existing tables are moved to the new storage when this function is called.
+ * This operation must not be invoked while the world is in readonly or deferred
+ * mode, or while snapshots of the world exist.
+ *
+ * @param world The world.
+ * @param enable True if aligned columns should be enabled, false to disable.
+ * @return The previous value.
+ */
+FLECS_API
+bool ecs_enable_aligned_columns(
+    ecs_world_t *world,
+    bool enable);
+
 /** Get the largest issued entity id (not counting generation).
  *
  * @param world The world.
@@ -2695,6 +2985,46 @@ void ecs_remove_all(
     ecs_world_t *world,
     ecs_id_t id);
 
+/** Add a (component) id to a range of entities in a table.
+ * This operation adds an id to all entities in the specified range. The range
+ * is moved to the destination table at once, which copies each component once
+ * for the entire range and emits a single OnAdd event. This is faster than 
+ * calling ecs_add_id() for each entity.
+ *
+ * If both offset and count are 0, the id is added to all entities in the table.
+ * When the world is deferred, an add command is enqueued for each entity.
+ *
+ * @param world The world.
+ * @param table The table.
+ * @param offset The first row of the range.
+ * @param count The number of entities in the range.
+ * @param id The id to add.
+ */
+FLECS_API
+void ecs_bulk_add_id(
+    ecs_world_t *world,
+    ecs_table_t *table,
+    int32_t offset,
+    int32_t count,
+    ecs_id_t id);
+
+/** Remove a (component) id from a range of entities in a table.
+ * Same as ecs_bulk_add_id(), but removes the id. The id may be a wildcard.
+ *
+ * @param world The world.
+ * @param table The table.
+ * @param offset The first row of the range.
+ * @param count The number of entities in the range.
+ * @param id The id to remove.
+ */
+FLECS_API
+void ecs_bulk_remove_id(
+    ecs_world_t *world,
+    ecs_table_t *table,
+    int32_t offset,
+    int32_t count,
+    ecs_id_t id);
+
 /** Set current with id.
  * New entities are automatically created with the specified id.
  *
@@ -4646,6 +4976,33 @@ bool ecs_query_changed(
     ecs_query_t *query,
     const ecs_iter_t *it);
 
+/** Create a changed rows iterator for a query.
+ * A changed rows iterator only returns the entities that were added to a
+ * matched table, or for which a monitored (read) component was written since
+ * the last time the query was iterated. Components are marked as written by 
+ * ecs_modified() and its variants, and by queries with [out] or [inout] terms 
+ * for the entities they iterate. Writes by the changed rows iterator itself
+ * are not returned by the next iteration.
+ *
+ * Tables start tracking per entity versions the first time they are visited by
+ * a changed rows iterator, and all entities of a table are returned on the 
+ * first visit. Tables that did not change since the last iteration are skipped
+ * without evaluating their entities. If a matched component from a shared 
+ * source (like a parent or prefab) changed, all entities of the table are
+ * returned. Entities that were deleted are not reported.
+ *
+ * The changed state is stored in the query, so the query should not also be
+ * iterated with a regular iterator while using change detection.
+ *
+ * @param world The world or stage, when iterating in multiple threads.
+ * @param query The query to iterate.
+ * @return The query iterator.
+ */
+FLECS_API
+ecs_iter_t ecs_query_changed_iter(
+    const ecs_world_t *world,
+    ecs_query_t *query);
+
 /** Skip a table while iterating.
  * This operation lets the query iterator know that a table was skipped while
  * iterating. A skipped table will not reset its changed state, and the query
@@ -4783,6 +5140,17 @@ FLECS_API
 void* ecs_query_get_binding_ctx(
     const ecs_query_t *query);
 
+/** Convert floating point value to sort key.
+ * The returned key has the same order as the floating point value, which makes
+ * it possible to sort by floating point values with ecs_query_desc_t::order_by_key.
+ *
+ * @param value The value.
+ * @return The sort key.
+ */
+FLECS_API
+uint64_t ecs_float_to_sort_key(
+    double value);
+
 /** @} */
 
 /**
@@ -4964,6 +5332,31 @@ FLECS_API
 int32_t ecs_iter_count(
     ecs_iter_t *it);
 
+/** Add (component) id to all entities matched by an iterator.
+ * This operation iterates the iterator until it yields no more results, after
+ * which the id is added to all returned entities. Entities are moved in ranges
+ * per table with ecs_bulk_add_id(), which is faster than calling ecs_add_id()
+ * for each entity.
+ *
+ * @param it The iterator.
+ * @param id The id to add.
+ */
+FLECS_API
+void ecs_iter_add_id(
+    ecs_iter_t *it,
+    ecs_id_t id);
+
+/** Remove (component) id from all entities matched by an iterator.
+ * Same as ecs_iter_add_id(), but removes the id.
+ *
+ * @param it The iterator.
+ * @param id The id to remove.
+ */
+FLECS_API
+void ecs_iter_remove_id(
+    ecs_iter_t *it,
+    ecs_id_t id);
+
 /** Test if iterator is true.
  * This operation will return true if the iterator returns at least one result.
  * This is especially useful in combination with fact-checking rules (see the
@@ -5199,8 +5592,38 @@ ecs_iter_t ecs_worker_iter(
     int32_t index,
     int32_t count);
 
+/** Create a balanced worker iterator.
+ * Balanced worker iterators divide the matched entities across N resources
+ * by assigning each resource a contiguous range of the matched entities. Only
+ * the tables at the start and end of a range are divided between resources,
+ * which avoids that each resource has to visit every matched table. This is
+ * faster than ecs_worker_iter() for queries that match many small tables.
+ *
+ * Unlike ecs_worker_iter(), the distribution is not stable between queries, as
+ * which resource an entity is assigned to depends on the other tables matched
+ * by the query. Code that relies on two queries processing the same entities on
+ * the same resource should use ecs_worker_iter().
+ *
+ * Entities can only be assigned up front when the source iterator is a query
+ * iterator that has not yet been progressed. For other iterators the function
+ * falls back to the behavior of ecs_worker_iter().
+ *
+ * The iterator must be iterated with ecs_worker_next().
+ *
+ * @param it The source iterator.
+ * @param index The index of the current resource.
+ * @param count The total number of resources to divide entities between.
+ * @return A worker iterator.
+ */
+FLECS_API
+ecs_iter_t ecs_balanced_worker_iter(
+    const ecs_iter_t *it,
+    int32_t index,
+    int32_t count);
+
 /** Progress a worker iterator.
- * Progresses an iterator created by ecs_worker_iter().
+ * Progresses an iterator created by ecs_worker_iter() or
+ * ecs_balanced_worker_iter().
  *
  * @param it The iterator.
  * @return true if iterator has more results, false if not.
@@ -5209,6 +5632,41 @@ FLECS_API
 bool ecs_worker_next(
     ecs_iter_t *it);
 
+/** Create a chunk iterator.
+ * Chunk iterators split the results of the parent iterator into pieces that
+ * never cross a table row that is a multiple of 'chunk_size'. If a result does
+ * not start on a chunk boundary, the first piece runs up to the next boundary.
+ * After that the iterator returns whole chunks, and a (partial) tail chunk.
+ *
+ * When aligned columns are enabled (see ecs_enable_aligned_columns()) and 
+ * chunk_size multiplied by the component size equals FLECS_COLUMN_ALIGNMENT,
+ * each chunk that starts on a boundary is aligned, and the full chunk can be 
+ * loaded and stored with vector instructions, including the tail chunk. In that
+ * case it->count is the number of valid elements (the mask) of the chunk.
+ *
+ * Chunk iterators are always instanced.
+ *
+ * The iterator must be iterated with ecs_chunk_next().
+ *
+ * @param it The source iterator.
+ * @param chunk_size The number of rows in a chunk. Must be a power of two.
+ * @return A chunk iterator.
+ */
+FLECS_API
+ecs_iter_t ecs_chunk_iter(
+    const ecs_iter_t *it,
+    int32_t chunk_size);
+
+/** Progress a chunk iterator.
+ * Progresses an iterator created by ecs_chunk_iter().
+ *
+ * @param it The iterator.
+ * @return true if iterator has more results, false if not.
+ */
+FLECS_API
+bool ecs_chunk_next(
+    ecs_iter_t *it);
+
 /** Obtain data for a query field.
  * This operation retrieves a pointer to an array of data that belongs to the
  * term in the query. The index refers to the location of the term in the query,
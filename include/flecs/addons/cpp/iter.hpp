@@ -264,6 +264,40 @@ public:
         return get_unchecked_field(index);
     }
 
+    /** Get aligned access to field data.
+     * Returns a pointer to the field data that the compiler may assume to be
+     * aligned to the specified alignment. This is guaranteed for owned fields
+     * when aligned columns are enabled (see world::enable_aligned_columns) and
+     * the result starts on a chunk boundary (see iterable::chunk).
+     *
+     * @tparam T Type of the field.
+     * @tparam Alignment The alignment of the field data.
+     * @param index The field index.
+     * @return Pointer to the field data.
+     */
+    template <typename T, size_t Alignment = FLECS_COLUMN_ALIGNMENT,
+        typename A = actual_type_t<T>>
+    T* field_aligned(int32_t index) const {
+        ecs_assert(std::is_const<T>::value || 
+            !ecs_field_is_readonly(m_iter, index),
+                ECS_ACCESS_VIOLATION, NULL);
+        ecs_assert(ecs_field_is_self(m_iter, index), 
+            ECS_INVALID_OPERATION, "aligned field must be owned");
+#ifndef FLECS_NDEBUG
+        ecs_entity_t term_id = ecs_field_id(m_iter, index);
+        ecs_assert(ECS_HAS_ID_FLAG(term_id, PAIR) ||
+            term_id == _::cpp_type<A>::id(m_iter->world),
+            ECS_COLUMN_TYPE_MISMATCH, NULL);
+#endif
+        void *ptr = ecs_field_w_size(m_iter, sizeof(A), index);
+        ecs_assert(!(reinterpret_cast<uintptr_t>(ptr) & (Alignment - 1)),
+            ECS_INVALID_OPERATION, "field data is not aligned");
+#if defined(__GNUC__) || defined(__clang__)
+        ptr = __builtin_assume_aligned(ptr, Alignment);
+#endif
+        return static_cast<T*>(ptr);
+    }
+
     /** Get pointer to field at row. */
     void* field_at(int32_t index, size_t row) const {
         return get_unchecked_field(index)[row];
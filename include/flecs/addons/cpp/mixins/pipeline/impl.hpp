@@ -89,4 +89,12 @@ inline bool world::using_task_threads() const {
     return ecs_using_task_threads(m_world);
 }
 
+inline void world::set_worker_sched(ecs_worker_sched_kind_t kind) const {
+    ecs_set_worker_sched(m_world, kind);
+}
+
+inline ecs_worker_sched_kind_t world::get_worker_sched() const {
+    return ecs_get_worker_sched(m_world);
+}
+
 }
@@ -92,4 +92,14 @@ void set_task_threads(int32_t task_threads) const;
  */
 bool using_task_threads() const;
 
+/** Set strategy used by worker threads to distribute work.
+ * @see ecs_set_worker_sched
+ */
+void set_worker_sched(ecs_worker_sched_kind_t kind) const;
+
+/** Get strategy used by worker threads to distribute work.
+ * @see ecs_get_worker_sched
+ */
+ecs_worker_sched_kind_t get_worker_sched() const;
+
 /** @} */
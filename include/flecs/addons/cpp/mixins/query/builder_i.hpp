@@ -63,6 +63,33 @@ public:
         return *this;
     }
 
+    /** Sort the output of a query by key.
+     * Same as order_by<T>, but instead of comparing components the callback
+     * returns a key for each component. Entities are ordered by ascending key
+     * using a radix sort, which is faster than sorting with a compare function.
+     *
+     * @tparam T The component used to sort.
+     * @param key The function that returns the sort key for a component.
+     */
+    template <typename T>
+    Base& order_by_key(uint64_t(*key)(flecs::entity_t, const T*)) {
+        ecs_order_by_key_action_t action =
+            reinterpret_cast<ecs_order_by_key_action_t>(key);
+        return this->order_by_key(_::cpp_type<T>::id(this->world_v()), action);
+    }
+
+    /** Sort the output of a query by key.
+     * Same as order_by_key<T>, but with component identifier.
+     *
+     * @param component The component used to sort.
+     * @param key The function that returns the sort key for a component.
+     */
+    Base& order_by_key(flecs::entity_t component, uint64_t(*key)(flecs::entity_t, const void*)) {
+        m_desc->order_by_key = reinterpret_cast<ecs_order_by_key_action_t>(key);
+        m_desc->order_by_component = component;
+        return *this;
+    }
+
     /** Group and sort matched tables.
      * Similar to ecs_query_order_by(), but instead of sorting individual entities, this
      * operation only sorts matched tables. This can be useful of a query needs to
@@ -14,6 +14,9 @@ struct page_iterable;
 template <typename ... Components>
 struct worker_iterable; 
 
+template <typename ... Components>
+struct chunk_iterable; 
+
 template <typename ... Components>
 struct iterable {
 
@@ -114,6 +117,16 @@ struct iterable {
      */
     worker_iterable<Components...> worker(int32_t index, int32_t count);
 
+    /** Chunk iterator.
+     * Create an iterator that splits results into chunks that don't cross a
+     * row that is a multiple of the chunk size.
+     * 
+     * @param size The number of rows in a chunk (must be a power of two).
+     * @return Iterable that can be iterated with each/iter.
+     * @see ecs_chunk_iter
+     */
+    chunk_iterable<Components...> chunk(int32_t size);
+
     /** Return number of entities matched by iterable. */
     int32_t count() const {
         return this->iter().count();
@@ -134,6 +147,7 @@ protected:
     friend iter_iterable<Components...>;
     friend page_iterable<Components...>;
     friend worker_iterable<Components...>;
+    friend chunk_iterable<Components...>;
 
     virtual ecs_iter_t get_iter(flecs::world_t *stage) const = 0;
     virtual ecs_iter_next_action_t next_action() const = 0;
@@ -336,4 +350,37 @@ worker_iterable<Components...> iterable<Components...>::worker(
     return worker_iterable<Components...>(index, count, this);
 }
 
+template <typename ... Components>
+struct chunk_iterable final : iterable<Components...> {
+    chunk_iterable(int32_t size, iterable<Components...> *it) 
+        : m_size(size)
+    {
+        m_chain_it = it->get_iter(nullptr);
+    }
+
+protected:
+    ecs_iter_t get_iter(flecs::world_t*) const {
+        return ecs_chunk_iter(&m_chain_it, m_size);
+    }
+
+    ecs_iter_next_action_t next_action() const {
+        return ecs_chunk_next;
+    }
+
+    ecs_iter_next_action_t next_each_action() const {
+        return ecs_chunk_next;
+    }
+
+private:
+    ecs_iter_t m_chain_it;
+    int32_t m_size;
+};
+
+template <typename ... Components>
+chunk_iterable<Components...> iterable<Components...>::chunk(
+    int32_t size) 
+{
+    return chunk_iterable<Components...>(size, this);
+}
+
 }
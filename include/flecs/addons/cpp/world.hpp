@@ -364,6 +364,29 @@ struct world {
         ecs_set_automerge(m_world, automerge);
     }
 
+    /** Enable/disable combined merging of stages.
+     * When enabled, commands from all stages are gathered in a single queue
+     * before they are flushed, so that commands for the same entity from
+     * different stages are batched.
+     *
+     * @param enable Whether to enable or disable combined merging.
+     * @see ecs_set_combined_merge
+     */
+    void set_combined_merge(bool enable = true) const {
+        ecs_set_combined_merge(m_world, enable);
+    }
+
+    /** Enable/disable parallel merging of commands.
+     * When enabled, entities that are moved to a different table by commands
+     * are moved on the worker threads.
+     *
+     * @param enable Whether to enable or disable parallel merging.
+     * @see ecs_set_parallel_merge
+     */
+    void set_parallel_merge(bool enable = true) const {
+        ecs_set_parallel_merge(m_world, enable);
+    }
+
     /** Merge world or stage.
      * When automatic merging is disabled, an application can call this
      * operation on either an individual stage, or on the world which will merge
@@ -506,6 +529,18 @@ struct world {
         ecs_enable_range_check(m_world, enabled);
     }
 
+    /** Enable/disable aligned component columns.
+     * When enabled, component columns are aligned to FLECS_COLUMN_ALIGNMENT
+     * bytes and padded to a multiple of the alignment.
+     *
+     * @param enabled True if columns should be aligned, false if not.
+     * @return The previous value.
+     * @see ecs_enable_aligned_columns
+     */
+    bool enable_aligned_columns(bool enabled = true) const {
+        return ecs_enable_aligned_columns(m_world, enabled);
+    }
+
     /** Set current scope.
      *
      * @param scope The scope to set.
@@ -209,6 +209,42 @@ FLECS_API
 bool ecs_using_task_threads(
     ecs_world_t *world);
 
+/** Strategies for distributing work across worker threads. */
+typedef enum ecs_worker_sched_kind_t {
+    /** Each thread runs a fixed slice of every matched table. Threads are 
+     * synchronized with a mutex/condition variable (default). */
+    EcsWorkerSchedSlice,
+
+    /** Matched entities are split up in table range jobs which are distributed
+     * across per-thread job queues. Threads that run out of jobs steal jobs 
+     * from other threads. Threads spin briefly on sync points before they 
+     * block, which reduces the overhead of short pipeline operations. */
+    EcsWorkerSchedStealing
+} ecs_worker_sched_kind_t;
+
+/** Set the strategy used by worker threads to distribute work.
+ * The strategy applies to threads created with both ecs_set_threads() and
+ * ecs_set_task_threads(). If worker threads are already running, they are
+ * restarted with the new strategy. The operation may not be called while 
+ * running a system / pipeline.
+ *
+ * @param world The world.
+ * @param kind The scheduling strategy.
+ */
+FLECS_API
+void ecs_set_worker_sched(
+    ecs_world_t *world,
+    ecs_worker_sched_kind_t kind);
+
+/** Get the strategy used by worker threads to distribute work.
+ *
+ * @param world The world.
+ * @return The scheduling strategy.
+ */
+FLECS_API
+ecs_worker_sched_kind_t ecs_get_worker_sched(
+    const ecs_world_t *world);
+
 ////////////////////////////////////////////////////////////////////////////////
 //// Module
 ////////////////////////////////////////////////////////////////////////////////
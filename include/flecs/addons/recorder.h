@@ -0,0 +1,155 @@
+/**
+ * @file addons/recorder.h
+ * @brief Command recorder addon.
+ *
+ * The recorder captures the commands that are merged with the world in a
+ * compact binary format. A recording can be replayed in another world, which
+ * applies the same command queues in the same order. This makes it possible to
+ * reproduce and benchmark merges of an application offline.
+ *
+ * Components, tags and relationships are stored by name, so that they can be
+ * resolved in a world where they have a different id. Entities are stored by
+ * id, and are made alive in the replaying world. Values of components without
+ * lifecycle hooks are stored as bytes. Values of components with hooks are
+ * stored as JSON if the component has reflection data, and are not recorded
+ * otherwise.
+ */
+
+#ifdef FLECS_RECORDER
+
+/**
+ * @defgroup c_addons_recorder Recorder
+ * @ingroup c_addons
+ * @brief Record & replay command queues.
+ *
+ * @{
+ */
+
+#ifndef FLECS_RECORDER_H
+#define FLECS_RECORDER_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** A recorder writes the commands merged with a world to a file or callback. */
+typedef struct ecs_recorder_t ecs_recorder_t;
+
+/** A replayer applies recorded commands to a world. */
+typedef struct ecs_replayer_t ecs_replayer_t;
+
+/** Callback invoked with recorded data. */
+typedef void (*ecs_recorder_write_action_t)(
+    const void *data,
+    ecs_size_t size,
+    void *ctx);
+
+/** Used with ecs_recorder_start(). */
+typedef struct ecs_recorder_desc_t {
+    /** File to write recording to. */
+    const char *filename;
+
+    /** Callback to write recording to, used if no filename is provided. The
+     * callback is invoked once for the stream header and once for each merged
+     * command queue. */
+    ecs_recorder_write_action_t callback;
+
+    /** Context passed to callback. */
+    void *ctx;
+} ecs_recorder_desc_t;
+
+/** Start recording commands.
+ * The recorder captures each command queue that is merged with the world, in
+ * the order in which they are merged. Commands that are enqueued by observers
+ * while a queue is merged are not recorded, as they are reproduced by the
+ * observers when the recording is replayed.
+ *
+ * Only one recorder can be active for a world at a time.
+ *
+ * @param world The world.
+ * @param desc Recorder parameters.
+ * @return The recorder, or NULL if failed.
+ */
+FLECS_API
+ecs_recorder_t* ecs_recorder_start(
+    ecs_world_t *world,
+    const ecs_recorder_desc_t *desc);
+
+/** Stop recording commands.
+ * This flushes and closes the recording. A recorder must be stopped before the
+ * world is deleted.
+ *
+ * @param recorder The recorder.
+ */
+FLECS_API
+void ecs_recorder_stop(
+    ecs_recorder_t *recorder);
+
+/** Create replayer from recorded data.
+ * The data is copied, and can be freed after this operation returns.
+ *
+ * @param world The world to replay the commands in.
+ * @param data The recorded data.
+ * @param size The size of the recorded data.
+ * @return The replayer, or NULL if the data is not a valid recording.
+ */
+FLECS_API
+ecs_replayer_t* ecs_replayer_new(
+    ecs_world_t *world,
+    const void *data,
+    ecs_size_t size);
+
+/** Create replayer from recording file.
+ *
+ * @param world The world to replay the commands in.
+ * @param filename The file with the recording.
+ * @return The replayer, or NULL if the file is not a valid recording.
+ */
+FLECS_API
+ecs_replayer_t* ecs_replayer_from_file(
+    ecs_world_t *world,
+    const char *filename);
+
+/** Replay commands of next recorded frame.
+ * Each recorded command queue is applied between a ecs_defer_begin() and
+ * ecs_defer_end(), so that the commands are merged in the same way as they
+ * were when the recording was made.
+ *
+ * @param replayer The replayer.
+ * @return 1 if a frame was replayed, 0 if no frames are left, -1 if failed.
+ */
+FLECS_API
+int ecs_replayer_next_frame(
+    ecs_replayer_t *replayer);
+
+/** Free replayer.
+ *
+ * @param replayer The replayer.
+ */
+FLECS_API
+void ecs_replayer_free(
+    ecs_replayer_t *replayer);
+
+/** Replay all commands of a recording.
+ * Convenience function that replays all frames of the recording.
+ *
+ * @param world The world to replay the commands in.
+ * @param data The recorded data.
+ * @param size The size of the recorded data.
+ * @return Zero if success, non-zero if failed.
+ */
+FLECS_API
+int ecs_replay(
+    ecs_world_t *world,
+    const void *data,
+    ecs_size_t size);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
+
+/** @} */
+
+#endif
@@ -71,6 +71,15 @@ extern "C" {
  * Different terms with the same variable name are automatically correlated by
  * the query engine.
  *
+ * Rules created with the EcsFilterCacheResults flag store their results, and
+ * replay them when iterated. The results are kept up to date with observers on
+ * the ids of the rule: new tables are matched as they are created, while
+ * changes to entities that are used as sources, variables or are traversed
+ * cause results to be reevaluated the next time the rule is iterated. This
+ * is useful for rules that are evaluated frequently over data that changes
+ * infrequently. Rules that cannot be cached (for example, rules that match
+ * names or union relationships) are evaluated as regular rules.
+ *
  * A rule needs to be explicitly deleted with ecs_rule_fini().
  *
  * @param world The world.
@@ -197,7 +206,11 @@ char* ecs_rule_str(
  * starting iteration:
  *   it.flags |= EcsIterProfile
  *
+ * If the iterator is NULL, the profile accumulated by the rule is used (see
+ * ecs_rule_get_profile()).
+ *
  * @param rule The rule.
+ * @param it The iterator (optional).
  * @return The string
  */
 FLECS_API
@@ -205,6 +218,44 @@ char* ecs_rule_str_w_profile(
     const ecs_rule_t *rule,
     const ecs_iter_t *it);
 
+/** Rule profile. 
+ * Contains the number of times each operation of the rule program was entered,
+ * redone and returned a match, and the time spent evaluating it. Operations are
+ * in the same order as in the string returned by ecs_rule_str().
+ */
+typedef struct ecs_rule_profile_t {
+    const ecs_rule_op_profile_t *ops; /**< Profile for each operation */
+    int32_t op_count;                 /**< Number of operations */
+    int32_t iter_count;               /**< Number of profiled iterators */
+} ecs_rule_profile_t;
+
+/** Get profile of rule.
+ * Profiling is opt-in. When the EcsIterProfile flag is set on a rule iterator 
+ * before iteration starts, the iterator measures each operation, and adds the
+ * results to the rule profile when it is finished:
+ *   ecs_iter_t it = ecs_rule_iter(world, rule);
+ *   it.flags |= EcsIterProfile;
+ *   while (ecs_rule_next(&it)) { }
+ *
+ * The profile is accumulated until ecs_rule_reset_profile() is called. The 
+ * profile is also reset when the rule is replanned, as this can change the
+ * rule program.
+ *
+ * @param rule The rule.
+ * @return The profile. Operations are NULL if nothing was profiled.
+ */
+FLECS_API
+ecs_rule_profile_t ecs_rule_get_profile(
+    const ecs_rule_t *rule);
+
+/** Reset profile of rule.
+ *
+ * @param rule The rule.
+ */
+FLECS_API
+void ecs_rule_reset_profile(
+    ecs_rule_t *rule);
+
 /** Populate variables from key-value string.
  * Convenience function to set rule variables from a key-value string separated
  * by comma's. The string must have the following format:
@@ -131,6 +131,12 @@ typedef struct ecs_world_stats_t {
         ecs_metric_t stack_alloc_count;    /**< Page allocations per frame */
         ecs_metric_t stack_free_count;     /**< Page frees per frame */
         ecs_metric_t stack_outstanding_alloc_count; /**< Difference between allocs & frees */
+
+        /* Block allocator data (see ecs_allocator_stats_get) */
+        ecs_metric_t allocator_bytes_in_use;   /**< Bytes in chunks in use (requires FLECS_ALLOCATOR_STATS) */
+        ecs_metric_t allocator_bytes_reserved; /**< Bytes in blocks allocated by block allocators */
+        ecs_metric_t allocator_chunk_count;    /**< Chunks in use (requires FLECS_ALLOCATOR_STATS) */
+        ecs_metric_t allocator_block_count;    /**< Blocks allocated by block allocators */
     } memory;
 
     /* HTTP statistics */
@@ -212,6 +218,28 @@ typedef struct ecs_pipeline_stats_t {
     int32_t rebuild_count;       /**< Number of times pipeline has rebuilt */
 } ecs_pipeline_stats_t;
 
+/** Statistics for the block allocators of a single size class */
+typedef struct ecs_allocator_size_stats_t {
+    ecs_size_t size;               /**< Size of a single allocation (chunk) */
+    int32_t allocator_count;       /**< Number of allocators for this size */
+    int32_t block_count;           /**< Number of blocks allocated */
+    int32_t chunk_count;           /**< Number of chunks in use */
+    int32_t chunk_count_max;       /**< High-water mark of chunks in use */
+    int64_t bytes_in_use;          /**< Bytes in chunks that are in use */
+    int64_t bytes_reserved;        /**< Bytes in allocated blocks */
+} ecs_allocator_size_stats_t;
+
+/** Statistics for the allocators of a world (use ecs_allocator_stats_get()) */
+typedef struct ecs_allocator_stats_t {
+    int64_t bytes_in_use;          /**< Bytes in chunks that are in use */
+    int64_t bytes_reserved;        /**< Bytes in allocated blocks */
+    int32_t chunk_count;           /**< Number of chunks in use */
+    int32_t block_count;           /**< Number of blocks allocated */
+
+    /** Vector with stats per size class, ordered by size. */
+    ecs_vec_t sizes;               /**< vector<ecs_allocator_size_stats_t> */
+} ecs_allocator_stats_t;
+
 /** Get world statistics.
  *
  * @param world The world.
@@ -383,6 +411,32 @@ void ecs_pipeline_stats_copy_last(
 
 #endif
 
+/** Get allocator statistics.
+ * Obtain statistics for the block allocators of the world and its stages,
+ * grouped by allocation size. The number of chunks in use and the high-water
+ * marks are only tracked when FLECS_ALLOCATOR_STATS is defined, and are 0 
+ * otherwise. The high-water mark of a size class is the sum of the high-water
+ * marks of its allocators.
+ *
+ * The stats object must be zero-initialized before the first call, and can be
+ * reused for subsequent calls.
+ *
+ * @param world The world.
+ * @param stats Out parameter for statistics.
+ */
+FLECS_API
+void ecs_allocator_stats_get(
+    const ecs_world_t *world,
+    ecs_allocator_stats_t *stats);
+
+/** Free allocator stats.
+ *
+ * @param stats The stats to free.
+ */
+FLECS_API
+void ecs_allocator_stats_fini(
+    ecs_allocator_stats_t *stats);
+
 /** Reduce all measurements from a window into a single measurement. */
 FLECS_API
 void ecs_metric_reduce(
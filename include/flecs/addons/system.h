@@ -198,6 +198,10 @@ ecs_entity_t ecs_run(
     void *param);
 
 /** Same as ecs_run(), but subdivides entities across number of provided stages.
+ * Each stage processes a contiguous range of the matched entities, so that a
+ * stage doesn't have to visit every matched table (see
+ * ecs_balanced_worker_iter()). Because the ranges depend on the tables matched
+ * by the system, two systems may process the same entity on different stages.
  *
  * @param world The world.
  * @param system The system to run.
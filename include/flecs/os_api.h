@@ -91,6 +91,26 @@ typedef
 char* (*ecs_os_api_strdup_t)(
     const char *str);
 
+/* Virtual memory */
+typedef
+void* (*ecs_os_api_vmem_reserve_t)(
+    ecs_size_t size);
+
+typedef
+bool (*ecs_os_api_vmem_commit_t)(
+    void *ptr,
+    ecs_size_t size);
+
+typedef
+void (*ecs_os_api_vmem_decommit_t)(
+    void *ptr,
+    ecs_size_t size);
+
+typedef
+void (*ecs_os_api_vmem_release_t)(
+    void *ptr,
+    ecs_size_t size);
+
 /* Threads */
 typedef
 void* (*ecs_os_thread_callback_t)(
@@ -230,6 +250,15 @@ typedef struct ecs_os_api_t {
     /* Strings */
     ecs_os_api_strdup_t strdup_;
 
+    /* Virtual memory. Reserve address space without backing memory, commit
+     * (a range of) reserved pages, decommit pages and release the reservation.
+     * Commit and decommit round to page boundaries. When set, large component
+     * columns are stored in reserved memory so they can grow without copying. */
+    ecs_os_api_vmem_reserve_t vmem_reserve_;
+    ecs_os_api_vmem_commit_t vmem_commit_;
+    ecs_os_api_vmem_decommit_t vmem_decommit_;
+    ecs_os_api_vmem_release_t vmem_release_;
+
     /* Threads */
     ecs_os_api_thread_new_t thread_new_;
     ecs_os_api_thread_join_t thread_join_;
@@ -338,6 +367,21 @@ void ecs_os_set_api_defaults(void);
 #ifndef ecs_os_calloc
 #define ecs_os_calloc(size) ecs_os_api.calloc_(size)
 #endif
+
+/* Virtual memory */
+#ifndef ecs_os_vmem_reserve
+#define ecs_os_vmem_reserve(size) ecs_os_api.vmem_reserve_(size)
+#endif
+#ifndef ecs_os_vmem_commit
+#define ecs_os_vmem_commit(ptr, size) ecs_os_api.vmem_commit_(ptr, size)
+#endif
+#ifndef ecs_os_vmem_decommit
+#define ecs_os_vmem_decommit(ptr, size) ecs_os_api.vmem_decommit_(ptr, size)
+#endif
+#ifndef ecs_os_vmem_release
+#define ecs_os_vmem_release(ptr, size) ecs_os_api.vmem_release_(ptr, size)
+#endif
+
 #if defined(ECS_TARGET_WINDOWS)
 #define ecs_os_alloca(size) _alloca((size_t)(size))
 #else
@@ -544,6 +588,10 @@ void* ecs_os_memdup(
 FLECS_API
 bool ecs_os_has_heap(void);
 
+/** Are virtual memory functions available? */
+FLECS_API
+bool ecs_os_has_vmem(void);
+
 /** Are threading functions available? */
 FLECS_API
 bool ecs_os_has_threading(void);
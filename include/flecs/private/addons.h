@@ -27,6 +27,9 @@
 #ifdef FLECS_NO_SNAPSHOT
 #undef FLECS_SNAPSHOT
 #endif
+#ifdef FLECS_NO_RECORDER
+#undef FLECS_RECORDER
+#endif
 #ifdef FLECS_NO_MONITOR
 #undef FLECS_MONITOR
 #endif
@@ -246,6 +249,13 @@
 #include "../addons/snapshot.h"
 #endif
 
+#ifdef FLECS_RECORDER
+#ifdef FLECS_NO_RECORDER
+#error "FLECS_NO_RECORDER failed: RECORDER is required by other addons"
+#endif
+#include "../addons/recorder.h"
+#endif
+
 #ifdef FLECS_PARSER
 #ifdef FLECS_NO_PARSER
 #error "FLECS_NO_PARSER failed: PARSER is required by other addons"
@@ -16,12 +16,20 @@ FLECS_DBG_API extern int64_t ecs_stack_allocator_free_count;
 struct ecs_allocator_t {
     ecs_block_allocator_t chunks;
     struct ecs_sparse_t sizes; /* <size, block_allocator_t> */
+    ecs_size_t align;
 };
 
 FLECS_API
 void flecs_allocator_init(
     ecs_allocator_t *a);
 
+/* Init allocator that returns memory aligned to the specified alignment, which
+ * must be a power of two. Allocation sizes are padded to the alignment. */
+FLECS_API
+void flecs_allocator_init_aligned(
+    ecs_allocator_t *a,
+    ecs_size_t align);
+
 FLECS_API
 void flecs_allocator_fini(
     ecs_allocator_t *a);
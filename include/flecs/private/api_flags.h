@@ -23,6 +23,11 @@ extern "C" {
 #define EcsWorldMeasureFrameTime      (1u << 5)
 #define EcsWorldMeasureSystemTime     (1u << 6)
 #define EcsWorldMultiThreaded         (1u << 7)
+#define EcsWorldWorkStealing          (1u << 8)
+#define EcsWorldAlignedColumns        (1u << 9)
+#define EcsWorldCombinedMerge         (1u << 10)
+#define EcsWorldParallelMerge         (1u << 11)
+#define EcsWorldParallelMerging       (1u << 12)
 
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -42,6 +47,7 @@ extern "C" {
 #define EcsEntityIsId                 (1u << 31)
 #define EcsEntityIsTarget             (1u << 30)
 #define EcsEntityIsTraversable        (1u << 29)
+#define EcsEntityHasSparse            (1u << 28)
 
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -68,6 +74,7 @@ extern "C" {
 #define EcsIdWith                      (1u << 10)
 #define EcsIdUnion                     (1u << 11)
 #define EcsIdAlwaysOverride            (1u << 12)
+#define EcsIdSparse                    (1u << 13)
 
 #define EcsIdHasOnAdd                  (1u << 16) /* Same values as table flags */
 #define EcsIdHasOnRemove               (1u << 17) 
@@ -113,6 +120,8 @@ extern "C" {
 #define EcsIterTrivialTest             (1u << 14u) /* Trivial test mode (constrained $this) */
 #define EcsIterTrivialSearchWildcard   (1u << 15u) /* Trivial search with wildcard ids */
 #define EcsIterCppEach                 (1u << 16u) /* Uses C++ 'each' iterator */
+#define EcsIterCached                  (1u << 17u) /* Iterator replays cached rule results */
+#define EcsIterChangedRows             (1u << 18u) /* Only yield rows that changed */
 
 ////////////////////////////////////////////////////////////////////////////////
 //// Event flags (used by ecs_event_decs_t::flags)
@@ -143,6 +152,8 @@ extern "C" {
 #define EcsFilterHasWildcards          (1u << 16u) /* Filter has no up traversal */
 #define EcsFilterOwnsStorage           (1u << 17u) /* Is ecs_filter_t object owned by filter */
 #define EcsFilterOwnsTermsStorage      (1u << 18u) /* Is terms array owned by filter */
+#define EcsFilterHasSparse             (1u << 19u) /* Filter has terms for sparse components */
+#define EcsFilterCacheResults          (1u << 20u) /* Cache results of rule */
 
 ////////////////////////////////////////////////////////////////////////////////
 //// Observer flags (used by ecs_observer_t::flags)
@@ -181,6 +192,7 @@ extern "C" {
 #define EcsTableHasOnTableEmpty        (1u << 21u)
 #define EcsTableHasOnTableCreate       (1u << 22u)
 #define EcsTableHasOnTableDelete       (1u << 23u)
+#define EcsTableHasRowVersions         (1u << 24u) /* Does table track per-row versions */
 
 #define EcsTableHasTraversable         (1u << 25u)
 #define EcsTableHasTarget              (1u << 26u)
@@ -189,7 +201,7 @@ extern "C" {
 
 /* Composite table flags */
 #define EcsTableHasLifecycle        (EcsTableHasCtors | EcsTableHasDtors)
-#define EcsTableIsComplex           (EcsTableHasLifecycle | EcsTableHasUnion | EcsTableHasToggle)
+#define EcsTableIsComplex           (EcsTableHasLifecycle | EcsTableHasUnion | EcsTableHasToggle | EcsTableHasRowVersions)
 #define EcsTableHasAddActions       (EcsTableHasIsA | EcsTableHasUnion | EcsTableHasCtors | EcsTableHasOnAdd | EcsTableHasOnSet)
 #define EcsTableHasRemoveActions    (EcsTableHasIsA | EcsTableHasDtors | EcsTableHasOnRemove | EcsTableHasUnSet)
 
@@ -114,8 +114,19 @@ typedef struct ecs_page_iter_t {
 typedef struct ecs_worker_iter_t {
     int32_t index;
     int32_t count;
+
+    /* Used by ecs_balanced_worker_iter */
+    ecs_query_table_match_t *first, *last; /* First & last match of worker */
+    int32_t first_row, last_row;           /* Rows in first & last match */
+    bool balanced;
 } ecs_worker_iter_t;
 
+/* Chunk-iterator specific data */
+typedef struct ecs_chunk_iter_t {
+    int32_t size;      /* Chunk size (power of two) */
+    int32_t remaining; /* Rows remaining in current result of chained iter */
+} ecs_chunk_iter_t;
+
 /* Convenience struct to iterate table array for id */
 typedef struct ecs_table_cache_iter_t {
     struct ecs_table_cache_hdr_t *cur, *next;
@@ -172,6 +183,15 @@ typedef struct ecs_query_iter_t {
     int32_t sparse_first;
     int32_t bitset_first;
     int32_t skip_count;
+
+    /* Changed rows iteration */
+    ecs_query_table_match_t *changed_match;
+    int32_t changed_row;
+    int32_t changed_offset;
+    int32_t changed_count;
+    int32_t changed_frame_offset;
+    bool changed_active;
+    bool changed_yielded;
 } ecs_query_iter_t;
 
 /** Snapshot-iterator specific data */
@@ -182,7 +202,9 @@ typedef struct ecs_snapshot_iter_t {
 } ecs_snapshot_iter_t;
 
 typedef struct ecs_rule_op_profile_t {
-    int32_t count[2]; /* 0 = enter, 1 = redo */
+    int32_t count[2];     /* 0 = enter, 1 = redo */
+    int32_t match_count;  /* Number of times operation returned a match */
+    double time_spent;    /* Time spent in operation, incl. nested ops (sec) */
 } ecs_rule_op_profile_t;
 
 /** Rule-iterator specific data */
@@ -195,9 +217,8 @@ typedef struct ecs_rule_iter_t {
     uint64_t *written;
     ecs_flags32_t source_set;
 
-#ifdef FLECS_DEBUG
-    ecs_rule_op_profile_t *profile;
-#endif
+    ecs_rule_op_profile_t *profile;      /* Only set if EcsIterProfile is set */
+    int32_t cache_index;                 /* Only used if EcsIterCached is set */
 
     int16_t op;
     int16_t sp;
@@ -232,6 +253,7 @@ typedef struct ecs_iter_private_t {
         ecs_snapshot_iter_t snapshot;
         ecs_page_iter_t page;
         ecs_worker_iter_t worker;
+        ecs_chunk_iter_t chunk;
     } iter;                       /* Iterator specific data */
 
     void *entity_iter;            /* Filter applied after matching a table */
@@ -258,6 +280,7 @@ struct ecs_iter_t {
                                    * all permutations of wildcards in query. */
     ecs_ref_t *references;        /* Cached refs to components (if iterating a cache) */
     ecs_flags64_t constrained_vars; /* Bitset that marks constrained variables */
+    ecs_flags32_t sparse_fields;  /* Bitset that marks sparse fields that are set */
     uint64_t group_id;            /* Group id for table, if group_by is used */
     int32_t field_count;          /* Number of fields in iterator */
 
@@ -25,7 +25,10 @@ typedef struct ecs_block_allocator_t {
     int32_t data_size;
     int32_t chunks_per_block;
     int32_t block_size;
-    int32_t alloc_count;
+    int32_t block_count;      /* Number of allocated blocks */
+    int32_t alloc_count;      /* Chunks in use (FLECS_ALLOCATOR_STATS) */
+    int32_t alloc_count_max;  /* High-water mark (FLECS_ALLOCATOR_STATS) */
+    int32_t align;
 } ecs_block_allocator_t;
 
 FLECS_API
@@ -33,6 +36,14 @@ void flecs_ballocator_init(
     ecs_block_allocator_t *ba,
     ecs_size_t size);
 
+/* Init block allocator that returns chunks aligned to the specified alignment,
+ * which must be a power of two. Chunk sizes are padded to the alignment. */
+FLECS_API
+void flecs_ballocator_init_aligned(
+    ecs_block_allocator_t *ba,
+    ecs_size_t size,
+    ecs_size_t align);
+
 #define flecs_ballocator_init_t(ba, T)\
     flecs_ballocator_init(ba, ECS_SIZEOF(T))
 #define flecs_ballocator_init_n(ba, T, count)\
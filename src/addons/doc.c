@@ -188,6 +188,7 @@ void flecs_doc_import_core_definitions(
     ecs_doc_set_brief(world, EcsWith, "Trait for adding additional components when a component is added");
     ecs_doc_set_brief(world, EcsAlwaysOverride, "Trait that indicates a component should always be overridden");
     ecs_doc_set_brief(world, EcsUnion, "Trait for creating a non-fragmenting relationship");
+    ecs_doc_set_brief(world, EcsSparse, "Trait for storing a component outside of tables");
     ecs_doc_set_brief(world, EcsOneOf, "Trait that enforces target of relationship is a child of <specified>");
     ecs_doc_set_brief(world, EcsOnDelete, "Cleanup trait for specifying what happens when component is deleted");
     ecs_doc_set_brief(world, EcsOnDeleteTarget, "Cleanup trait for specifying what happens when pair target is deleted");
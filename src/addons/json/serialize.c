@@ -1543,6 +1543,42 @@ void flecs_json_serialize_query_plan(
 #endif
 }
 
+#ifdef FLECS_RULES
+static
+void flecs_json_serialize_rule_profile(
+    ecs_strbuf_t *buf,
+    const ecs_rule_t *rule)
+{
+    ecs_rule_profile_t profile = ecs_rule_get_profile(rule);
+    if (!profile.ops) {
+        return;
+    }
+
+    flecs_json_memberl(buf, "iter_count");
+    flecs_json_number(buf, profile.iter_count);
+
+    /* Operations are in the same order as the query plan */
+    flecs_json_memberl(buf, "ops");
+    flecs_json_array_push(buf);
+    int32_t i;
+    for (i = 0; i < profile.op_count; i ++) {
+        const ecs_rule_op_profile_t *op = &profile.ops[i];
+        flecs_json_next(buf);
+        flecs_json_object_push(buf);
+        flecs_json_memberl(buf, "enter");
+        flecs_json_number(buf, op->count[0]);
+        flecs_json_memberl(buf, "redo");
+        flecs_json_number(buf, op->count[1]);
+        flecs_json_memberl(buf, "match");
+        flecs_json_number(buf, op->match_count);
+        flecs_json_memberl(buf, "time_us");
+        flecs_json_number(buf, op->time_spent * 1000.0 * 1000.0);
+        flecs_json_object_pop(buf);
+    }
+    flecs_json_array_pop(buf);
+}
+#endif
+
 static
 void flecs_json_serialize_query_profile(
     const ecs_world_t *world,
@@ -1553,6 +1589,14 @@ void flecs_json_serialize_query_profile(
     if (!desc->query) {
         return;
     }
+
+    /* If query is a rule, also measure the individual rule operations */
+    const ecs_rule_t *rule = NULL;
+#ifdef FLECS_RULES
+    if (ecs_poly_is(desc->query, ecs_rule_t)) {
+        rule = desc->query;
+    }
+#endif
     
     ecs_time_t t = {0};
     int32_t result_count = 0, entity_count = 0, i, sample_count = 100;
@@ -1569,6 +1613,9 @@ void flecs_json_serialize_query_profile(
         ecs_iter_t pit;
         ecs_iter_poly(world, desc->query, &pit, NULL);
         pit.flags |= EcsIterIsInstanced;
+        if (rule) {
+            pit.flags |= EcsIterProfile;
+        }
     
         while (ecs_iter_next(&pit)) {
             result_count ++;
@@ -1635,6 +1682,12 @@ void flecs_json_serialize_query_profile(
     flecs_json_memberl(buf, "shared_component_bytes");
     flecs_json_number(buf, shared_component_bytes);
 
+#ifdef FLECS_RULES
+    if (rule) {
+        flecs_json_serialize_rule_profile(buf, rule);
+    }
+#endif
+
     flecs_json_object_pop(buf);
 }
 
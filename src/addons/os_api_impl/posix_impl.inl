@@ -13,6 +13,16 @@
 #include <time.h>
 #endif
 
+#ifndef __EMSCRIPTEN__
+#define FLECS_POSIX_VMEM
+#include <sys/mman.h>
+#include <fcntl.h>
+#include <unistd.h>
+#if !defined(MAP_ANONYMOUS) && defined(MAP_ANON)
+#define MAP_ANONYMOUS MAP_ANON
+#endif
+#endif
+
 /* This mutex is used to emulate atomic operations when the gnu builtins are
  * not supported. This is probably not very fast but if the compiler doesn't
  * support the gnu built-ins, then speed is probably not a priority. */
@@ -298,6 +308,91 @@ uint64_t posix_time_now(void) {
     return now;
 }
 
+#ifdef FLECS_POSIX_VMEM
+static uintptr_t posix_page_size;
+
+static
+void* posix_vmem_map(
+    void *ptr,
+    size_t size,
+    int flags)
+{
+    flags |= MAP_PRIVATE;
+#ifdef MAP_NORESERVE
+    flags |= MAP_NORESERVE;
+#endif
+#ifdef MAP_ANONYMOUS
+    return mmap(ptr, size, PROT_NONE, flags | MAP_ANONYMOUS, -1, 0);
+#else
+    /* Private mapping of /dev/zero behaves like an anonymous mapping */
+    int fd = open("/dev/zero", O_RDWR);
+    if (fd == -1) {
+        return MAP_FAILED;
+    }
+    void *result = mmap(ptr, size, PROT_NONE, flags, fd, 0);
+    close(fd);
+    return result;
+#endif
+}
+
+static
+void* posix_vmem_reserve(
+    ecs_size_t size)
+{
+    void *result = posix_vmem_map(NULL, (size_t)size, 0);
+    if (result == MAP_FAILED) {
+        return NULL;
+    }
+
+#ifdef MADV_HUGEPAGE
+    /* Large columns benefit from fewer TLB misses */
+    madvise(result, (size_t)size, MADV_HUGEPAGE);
+#endif
+
+    return result;
+}
+
+static
+bool posix_vmem_commit(
+    void *ptr,
+    ecs_size_t size)
+{
+    uintptr_t mask = posix_page_size - 1;
+    uintptr_t start = (uintptr_t)ptr & ~mask;
+    uintptr_t end = ((uintptr_t)ptr + (uintptr_t)size + mask) & ~mask;
+    return !mprotect((void*)start, end - start, PROT_READ | PROT_WRITE);
+}
+
+static
+void posix_vmem_decommit(
+    void *ptr,
+    ecs_size_t size)
+{
+    /* Only decommit pages that are entirely inside the range */
+    uintptr_t mask = posix_page_size - 1;
+    uintptr_t start = ((uintptr_t)ptr + mask) & ~mask;
+    uintptr_t end = ((uintptr_t)ptr + (uintptr_t)size) & ~mask;
+    if (end <= start) {
+        return;
+    }
+
+    /* Replacing the pages with a new mapping returns them to the OS */
+    if (posix_vmem_map((void*)start, end - start, MAP_FIXED) == MAP_FAILED) {
+        ecs_err("failed to decommit memory");
+    }
+}
+
+static
+void posix_vmem_release(
+    void *ptr,
+    ecs_size_t size)
+{
+    if (munmap(ptr, (size_t)size)) {
+        ecs_err("failed to release memory");
+    }
+}
+#endif
+
 void ecs_set_os_api_impl(void) {
     ecs_os_set_api_defaults();
 
@@ -324,6 +419,17 @@ void ecs_set_os_api_impl(void) {
     api.sleep_ = posix_sleep;
     api.now_ = posix_time_now;
 
+#ifdef FLECS_POSIX_VMEM
+    long page_size = sysconf(_SC_PAGESIZE);
+    if (page_size > 0) {
+        posix_page_size = (uintptr_t)page_size;
+        api.vmem_reserve_ = posix_vmem_reserve;
+        api.vmem_commit_ = posix_vmem_commit;
+        api.vmem_decommit_ = posix_vmem_decommit;
+        api.vmem_release_ = posix_vmem_release;
+    }
+#endif
+
     posix_time_setup();
 
     ecs_os_set_api(&api);
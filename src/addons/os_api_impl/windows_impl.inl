@@ -253,6 +253,52 @@ void win_fini(void) {
     }
 }
 
+static uintptr_t win_page_size;
+
+static
+void* win_vmem_reserve(
+    ecs_size_t size)
+{
+    return VirtualAlloc(NULL, (SIZE_T)size, MEM_RESERVE, PAGE_NOACCESS);
+}
+
+static
+bool win_vmem_commit(
+    void *ptr,
+    ecs_size_t size)
+{
+    return VirtualAlloc(ptr, (SIZE_T)size, MEM_COMMIT, PAGE_READWRITE) != NULL;
+}
+
+static
+void win_vmem_decommit(
+    void *ptr,
+    ecs_size_t size)
+{
+    /* Only decommit pages that are entirely inside the range */
+    uintptr_t mask = win_page_size - 1;
+    uintptr_t start = ((uintptr_t)ptr + mask) & ~mask;
+    uintptr_t end = ((uintptr_t)ptr + (uintptr_t)size) & ~mask;
+    if (end <= start) {
+        return;
+    }
+
+    if (!VirtualFree((void*)start, (SIZE_T)(end - start), MEM_DECOMMIT)) {
+        ecs_err("failed to decommit memory");
+    }
+}
+
+static
+void win_vmem_release(
+    void *ptr,
+    ecs_size_t size)
+{
+    (void)size;
+    if (!VirtualFree(ptr, 0, MEM_RELEASE)) {
+        ecs_err("failed to release memory");
+    }
+}
+
 void ecs_set_os_api_impl(void) {
     ecs_os_set_api_defaults();
 
@@ -280,6 +326,14 @@ void ecs_set_os_api_impl(void) {
     api.now_ = win_time_now;
     api.fini_ = win_fini;
 
+    SYSTEM_INFO info;
+    GetSystemInfo(&info);
+    win_page_size = (uintptr_t)info.dwPageSize;
+    api.vmem_reserve_ = win_vmem_reserve;
+    api.vmem_commit_ = win_vmem_commit;
+    api.vmem_decommit_ = win_vmem_decommit;
+    api.vmem_release_ = win_vmem_release;
+
     win_time_setup();
 
     if (ecs_os_api.flags_ & EcsOsApiHighResolutionTimer) {
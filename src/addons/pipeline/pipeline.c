@@ -17,6 +17,12 @@ static void flecs_pipeline_free(
         ecs_allocator_t *a = &world->allocator;
         ecs_vec_fini_t(a, &p->ops, ecs_pipeline_op_t);
         ecs_vec_fini_t(a, &p->systems, ecs_entity_t);
+        ecs_vec_fini_t(a, &p->system_deps, ecs_pipeline_deps_t);
+        ecs_vec_fini_t(a, &p->deps, int32_t);
+        ecs_vec_fini_t(a, &p->jobs, ecs_worker_job_t);
+        ecs_vec_fini_t(a, &p->job_queues, ecs_worker_queue_t);
+        ecs_vec_fini_t(a, &p->job_systems, ecs_worker_jobs_t);
+        ecs_vec_fini_t(a, &p->job_deps, int32_t);
         ecs_os_free(p->iters);
         ecs_query_fini(p->query);
         ecs_os_free(p);
@@ -237,6 +243,156 @@ bool flecs_pipeline_check_terms(
     return needs_merge;
 }
 
+/* Component accessed by a system, used to find systems that can run in 
+ * parallel. */
+typedef struct ecs_pipeline_access_t {
+    ecs_id_t id;
+    bool write;
+} ecs_pipeline_access_t;
+
+static
+void flecs_pipeline_add_access(
+    ecs_world_t *world,
+    ecs_filter_t *filter,
+    ecs_vec_t *access)
+{
+    ecs_allocator_t *a = &world->allocator;
+    ecs_term_t *terms = filter->terms;
+    int32_t t, term_count = filter->term_count;
+
+    for (t = 0; t < term_count; t ++) {
+        ecs_term_t *term = &terms[t];
+        ecs_term_id_t *src = &term->src;
+        ecs_inout_kind_t inout = term->inout;
+        ecs_id_t id = term->id;
+
+        if (inout == EcsInOutNone || term->oper == EcsNot) {
+            continue;
+        }
+
+        if (!ecs_id_is_wildcard(id) && !ecs_get_typeid(world, id)) {
+            /* Tags have no data that could be accessed */
+            continue;
+        }
+
+        bool from_any = ecs_term_match_0(term);
+        bool from_this = ecs_term_match_this(term);
+        bool is_shared = !from_any && (!from_this || !(src->flags & EcsSelf));
+
+        if (inout == EcsInOutDefault) {
+            if (from_any) {
+                continue;
+            } else if (is_shared) {
+                inout = EcsIn;
+            } else {
+                inout = EcsInOut;
+            }
+        }
+
+        bool write = inout == EcsOut || inout == EcsInOut;
+        if (from_any) {
+            if (inout == EcsOut) {
+                /* Writes to components not matched by the query are staged */
+                continue;
+            }
+
+            /* Components not matched by the query are read from the main
+             * storage, while writes to them are staged. */
+            write = false;
+        }
+
+        ecs_pipeline_access_t *elem = ecs_vec_append_t(
+            a, access, ecs_pipeline_access_t);
+        elem->id = id;
+        elem->write = write;
+    }
+}
+
+static
+bool flecs_pipeline_id_overlap(
+    ecs_entity_t a,
+    ecs_entity_t b)
+{
+    return (a == b) || 
+        (a == (uint32_t)EcsWildcard) || (b == (uint32_t)EcsWildcard) ||
+        (a == (uint32_t)EcsAny) || (b == (uint32_t)EcsAny);
+}
+
+static
+bool flecs_pipeline_ids_overlap(
+    ecs_id_t a,
+    ecs_id_t b)
+{
+    if (a == b || a == EcsWildcard || b == EcsWildcard || 
+        a == EcsAny || b == EcsAny) 
+    {
+        return true;
+    }
+
+    if (!ECS_IS_PAIR(a) || !ECS_IS_PAIR(b)) {
+        return false;
+    }
+
+    return flecs_pipeline_id_overlap(ECS_PAIR_FIRST(a), ECS_PAIR_FIRST(b)) &&
+        flecs_pipeline_id_overlap(ECS_PAIR_SECOND(a), ECS_PAIR_SECOND(b));
+}
+
+/* Two systems conflict if one of them writes a component the other accesses */
+static
+bool flecs_pipeline_access_conflict(
+    const ecs_pipeline_access_t *a,
+    int32_t a_count,
+    const ecs_pipeline_access_t *b,
+    int32_t b_count)
+{
+    int32_t i, j;
+    for (i = 0; i < a_count; i ++) {
+        for (j = 0; j < b_count; j ++) {
+            if (!a[i].write && !b[j].write) {
+                continue;
+            }
+            if (flecs_pipeline_ids_overlap(a[i].id, b[j].id)) {
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+/* Find earlier systems in the operation the last added system depends on */
+static
+void flecs_pipeline_add_deps(
+    ecs_world_t *world,
+    ecs_pipeline_state_t *pq,
+    ecs_pipeline_op_t *op,
+    ecs_vec_t *access,
+    ecs_vec_t *access_offsets)
+{
+    ecs_allocator_t *a = &world->allocator;
+    const ecs_pipeline_access_t *elems = ecs_vec_first_t(
+        access, ecs_pipeline_access_t);
+    int32_t *offsets = ecs_vec_first_t(access_offsets, int32_t);
+    int32_t cur = ecs_vec_count(&pq->systems) - 1;
+    int32_t cur_offset = offsets[cur];
+    int32_t cur_count = offsets[cur + 1] - cur_offset;
+
+    ecs_pipeline_deps_t *deps = ecs_vec_append_t(
+        a, &pq->system_deps, ecs_pipeline_deps_t);
+    deps->offset = ecs_vec_count(&pq->deps);
+    deps->count = 0;
+
+    int32_t i;
+    for (i = op->offset; i < cur; i ++) {
+        int32_t offset = offsets[i], count = offsets[i + 1] - offset;
+        if (flecs_pipeline_access_conflict(
+            &elems[cur_offset], cur_count, &elems[offset], count))
+        {
+            ecs_vec_append_t(a, &pq->deps, int32_t)[0] = i;
+            deps->count ++;
+        }
+    }
+}
+
 static
 EcsPoly* flecs_pipeline_term_system(
     ecs_iter_t *it)
@@ -273,6 +429,15 @@ bool flecs_pipeline_build(
 
     ecs_vec_reset_t(a, &pq->ops, ecs_pipeline_op_t);
     ecs_vec_reset_t(a, &pq->systems, ecs_entity_t);
+    ecs_vec_reset_t(a, &pq->system_deps, ecs_pipeline_deps_t);
+    ecs_vec_reset_t(a, &pq->deps, int32_t);
+
+    /* Components accessed by each system, used to determine which systems in
+     * an operation can run in parallel */
+    ecs_vec_t access, access_offsets;
+    ecs_vec_init_t(a, &access, ecs_pipeline_access_t, 0);
+    ecs_vec_init_t(a, &access_offsets, int32_t, 0);
+    ecs_vec_append_t(a, &access_offsets, int32_t)[0] = 0;
 
     bool multi_threaded = false;
     bool no_readonly = false;
@@ -362,6 +527,20 @@ bool flecs_pipeline_build(
                     op->no_readonly = no_readonly;
                 }
                 op->count ++;
+
+                if (q->filter.term_count) {
+                    flecs_pipeline_add_access(world, &q->filter, &access);
+                } else {
+                    /* Tasks don't have a query, so could access anything */
+                    ecs_pipeline_access_t *elem = ecs_vec_append_t(
+                        a, &access, ecs_pipeline_access_t);
+                    elem->id = EcsWildcard;
+                    elem->write = true;
+                }
+
+                ecs_vec_append_t(a, &access_offsets, int32_t)[0] = 
+                    ecs_vec_count(&access);
+                flecs_pipeline_add_deps(world, pq, op, &access, &access_offsets);
             }
         }
     }
@@ -372,6 +551,8 @@ bool flecs_pipeline_build(
 
     ecs_map_fini(&ws.ids);
     ecs_map_fini(&ws.wildcard_ids);
+    ecs_vec_fini_t(a, &access, ecs_pipeline_access_t);
+    ecs_vec_fini_t(a, &access_offsets, int32_t);
 
     op = ecs_vec_first_t(&pq->ops, ecs_pipeline_op_t);
 
@@ -545,6 +726,13 @@ int32_t flecs_run_pipeline_ops(
 
     ecs_assert(!stage_index || op->multi_threaded, ECS_INTERNAL_ERROR, NULL);
 
+    if (ECS_BIT_IS_SET(world->flags, EcsWorldMultiThreaded) &&
+        ECS_BIT_IS_SET(world->flags, EcsWorldWorkStealing)) 
+    {
+        return flecs_workers_run_jobs(
+            world, stage, stage_index, stage_count, delta_time);
+    }
+
     int32_t count = ecs_vec_count(&pq->systems);
     ecs_entity_t* systems = ecs_vec_first_t(&pq->systems, ecs_entity_t);
     int32_t ran_since_merge = i - op->offset;
@@ -567,8 +755,12 @@ int32_t flecs_run_pipeline_ops(
             s = stage;
         }
 
+        /* Only assign entity ranges to workers if the system is the only one
+         * in the operation. Workers don't synchronize between systems in an
+         * operation, so systems that share an operation must divide tables
+         * the same way to prevent threads from accessing the same entities. */
         ecs_run_intern(world, s, system, sys, stage_index,
-            stage_count, delta_time, 0, 0, NULL);
+            stage_count, delta_time, 0, 0, op->count == 1, NULL);
 
         world->info.systems_ran_frame++;
         ran_since_merge++;
@@ -626,6 +818,9 @@ void flecs_run_pipeline(
         ecs_assert(world->workers_waiting == 0, ECS_INTERNAL_ERROR, NULL);
 
         if (op_multi_threaded) {
+            if (ECS_BIT_IS_SET(world->flags, EcsWorldWorkStealing)) {
+                flecs_workers_prepare_jobs(world, pq, stage_count);
+            }
             flecs_signal_workers(world);
         }
 
@@ -19,10 +19,55 @@ typedef struct ecs_pipeline_op_t {
     bool no_readonly;           /* Whether systems are staged or not */
 } ecs_pipeline_op_t;
 
+/** Range in dependency vector with systems that a system depends on. A system
+ * depends on an earlier system in the same operation if one of the systems 
+ * writes a component that the other system reads or writes. */
+typedef struct ecs_pipeline_deps_t {
+    int32_t offset;             /* Offset in deps vector */
+    int32_t count;              /* Number of systems system depends on */
+} ecs_pipeline_deps_t;
+
+/* Number of iterations a thread spins on a sync point before it blocks */
+#define FLECS_WORKER_SPIN_COUNT (4096)
+
+/* Number of jobs per thread a system is split up in with work stealing */
+#define FLECS_WORKER_JOBS_PER_THREAD (4)
+
+/* Minimum number of entities in a job */
+#define FLECS_WORKER_JOB_MIN_SIZE (64)
+
+/** Job that runs a system on a range of its matched entities. */
+typedef struct ecs_worker_job_t {
+    int32_t offset;             /* Offset in system results */
+    int32_t limit;              /* Number of entities to run (0 = remaining) */
+} ecs_worker_job_t;
+
+/** Job queue of a single thread for a single system. Jobs are claimed by 
+ * atomically incrementing the head, which allows idle threads to steal jobs 
+ * from the queue without taking a lock. */
+typedef struct ecs_worker_queue_t {
+    int32_t head;               /* Index of next job to claim */
+    int32_t last;               /* Index of last job in queue + 1 */
+} ecs_worker_queue_t;
+
+/** Jobs for a system in the current pipeline operation. */
+typedef struct ecs_worker_jobs_t {
+    ecs_entity_t system;        /* System entity */
+    ecs_system_t *sys;          /* System data */
+    int32_t job_count;          /* Total number of jobs for system */
+    int32_t jobs_done;          /* Number of jobs finished */
+    int32_t queues;             /* Offset of system queues in queue vector */
+    int32_t deps;               /* Offset of dependencies in job_deps vector */
+    int32_t dep_count;          /* Number of systems to wait for */
+    bool is_task;               /* Tasks run once on each thread */
+} ecs_worker_jobs_t;
+
 struct ecs_pipeline_state_t {
     ecs_query_t *query;         /* Pipeline query */
     ecs_vec_t ops;              /* Pipeline schedule */
     ecs_vec_t systems;          /* Vector with system ids */
+    ecs_vec_t system_deps;      /* vector<ecs_pipeline_deps_t>, per system */
+    ecs_vec_t deps;             /* vector<int32_t>, indices in systems vector */
 
     ecs_entity_t last_system;   /* Last system ran by pipeline */
     ecs_id_record_t *idr_inactive; /* Cached record for quick inactive test */
@@ -36,6 +81,12 @@ struct ecs_pipeline_state_t {
     int32_t cur_i;              /* Index in current result */
     int32_t ran_since_merge;    /* Index in current op */
     bool no_readonly;           /* Is pipeline in readonly mode */
+
+    /* Jobs for current op when work stealing is enabled */
+    ecs_vec_t jobs;             /* vector<ecs_worker_job_t> */
+    ecs_vec_t job_queues;       /* vector<ecs_worker_queue_t> */
+    ecs_vec_t job_systems;      /* vector<ecs_worker_jobs_t> */
+    ecs_vec_t job_deps;         /* vector<int32_t>, indices in job_systems */
 };
 
 typedef struct EcsPipeline {
@@ -85,4 +136,16 @@ void flecs_signal_workers(
 void flecs_wait_for_sync(
     ecs_world_t *world);
 
+void flecs_workers_prepare_jobs(
+    ecs_world_t *world,
+    ecs_pipeline_state_t *pq,
+    int32_t stage_count);
+
+int32_t flecs_workers_run_jobs(
+    ecs_world_t *world,
+    ecs_stage_t *stage,
+    int32_t stage_index,
+    int32_t stage_count,
+    ecs_ftime_t delta_time);
+
 #endif
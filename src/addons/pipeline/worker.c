@@ -9,6 +9,45 @@
 #ifdef FLECS_PIPELINE
 #include "pipeline.h"
 
+/* Read value that is concurrently written by other threads */
+static
+int32_t flecs_worker_load(
+    const int32_t *value)
+{
+    return *(const volatile int32_t*)value;
+}
+
+/* Wait until main thread signals that workers can continue. Spins for a short
+ * while before blocking, so that workers don't need to be woken up by the OS
+ * for pipeline operations that are close together. */
+static
+int32_t flecs_worker_park(
+    ecs_world_t *world,
+    int32_t gen)
+{
+    int32_t i, cur;
+    for (i = 0; i < FLECS_WORKER_SPIN_COUNT; i ++) {
+        cur = flecs_worker_load(&world->workers_gen);
+        if (cur != gen) {
+            return cur;
+        }
+    }
+
+    /* Main thread only takes the mutex to wake up workers when it sees that a
+     * worker is parked. Because both the generation and parked counters are 
+     * incremented with a full barrier, either the main thread sees that the
+     * worker is parked, or the worker sees the new generation. */
+    ecs_os_mutex_lock(world->sync_mutex);
+    ecs_os_ainc(&world->workers_parked);
+    while ((cur = flecs_worker_load(&world->workers_gen)) == gen) {
+        ecs_os_cond_wait(world->worker_cond, world->sync_mutex);
+    }
+    ecs_os_adec(&world->workers_parked);
+    ecs_os_mutex_unlock(world->sync_mutex);
+
+    return cur;
+}
+
 /* Synchronize workers */
 static
 void flecs_sync_worker(
@@ -19,6 +58,18 @@ void flecs_sync_worker(
         return;
     }
 
+    if (ECS_BIT_IS_SET(world->flags, EcsWorldWorkStealing)) {
+        /* Only wake up main thread if it stopped spinning */
+        if (ecs_os_ainc(&world->workers_waiting) == (stage_count - 1)) {
+            if (flecs_worker_load(&world->sync_parked)) {
+                ecs_os_mutex_lock(world->sync_mutex);
+                ecs_os_cond_signal(world->sync_cond);
+                ecs_os_mutex_unlock(world->sync_mutex);
+            }
+        }
+        return;
+    }
+
     /* Signal that thread is waiting */
     ecs_os_mutex_lock(world->sync_mutex);
     if (++world->workers_waiting == (stage_count - 1)) {
@@ -42,27 +93,44 @@ void* flecs_worker(void *arg) {
 
     ecs_dbg_2("worker %d: start", stage->id);
 
+    bool stealing = ECS_BIT_IS_SET(world->flags, EcsWorldWorkStealing);
+
     /* Start worker, increase counter so main thread knows how many
      * workers are ready */
     ecs_os_mutex_lock(world->sync_mutex);
     world->workers_running ++;
+    int32_t gen = world->workers_gen;
 
-    if (!(world->flags & EcsWorldQuitWorkers)) {
+    if (!stealing && !(world->flags & EcsWorldQuitWorkers)) {
         ecs_os_cond_wait(world->worker_cond, world->sync_mutex);
     }
 
     ecs_os_mutex_unlock(world->sync_mutex);
 
+    if (stealing) {
+        gen = flecs_worker_park(world, gen);
+    }
+
     while (!(world->flags & EcsWorldQuitWorkers)) {
         ecs_entity_t old_scope = ecs_set_scope((ecs_world_t*)stage, 0);
 
-        ecs_dbg_3("worker %d: run", stage->id);
-        flecs_run_pipeline_ops(world, stage, stage->id, world->stage_count, 
-            world->info.delta_time);
+        ecs_worker_task_action_t task = world->worker_task;
+        if (task) {
+            ecs_dbg_3("worker %d: run task", stage->id);
+            task(world, stage, world->worker_task_ctx);
+        } else {
+            ecs_dbg_3("worker %d: run", stage->id);
+            flecs_run_pipeline_ops(world, stage, stage->id, 
+                world->stage_count, world->info.delta_time);
+        }
 
         ecs_set_scope((ecs_world_t*)stage, old_scope);
 
         flecs_sync_worker(world);
+
+        if (stealing) {
+            gen = flecs_worker_park(world, gen);
+        }
     }
 
     ecs_dbg_2("worker %d: finalizing", stage->id);
@@ -148,6 +216,31 @@ void flecs_wait_for_sync(
 
     ecs_dbg_3("#[bold]pipeline: waiting for worker sync");
 
+    if (ECS_BIT_IS_SET(world->flags, EcsWorldWorkStealing)) {
+        int32_t i, worker_count = stage_count - 1;
+        for (i = 0; i < FLECS_WORKER_SPIN_COUNT; i ++) {
+            if (flecs_worker_load(&world->workers_waiting) == worker_count) {
+                break;
+            }
+        }
+
+        if (i == FLECS_WORKER_SPIN_COUNT) {
+            ecs_os_mutex_lock(world->sync_mutex);
+            ecs_os_ainc(&world->sync_parked);
+            while (flecs_worker_load(&world->workers_waiting) != worker_count) {
+                ecs_os_cond_wait(world->sync_cond, world->sync_mutex);
+            }
+            ecs_os_adec(&world->sync_parked);
+            ecs_os_mutex_unlock(world->sync_mutex);
+        }
+
+        /* Workers don't access the counter until they are signalled again */
+        world->workers_waiting = 0;
+
+        ecs_dbg_3("#[bold]pipeline: workers synced");
+        return;
+    }
+
     ecs_os_mutex_lock(world->sync_mutex);
     if (world->workers_waiting != (stage_count - 1)) {
         ecs_os_cond_wait(world->sync_cond, world->sync_mutex);
@@ -173,6 +266,19 @@ void flecs_signal_workers(
     }
 
     ecs_dbg_3("#[bold]pipeline: signal workers");
+
+    if (ECS_BIT_IS_SET(world->flags, EcsWorldWorkStealing)) {
+        /* Workers that are still spinning pick up the new generation without
+         * having to be woken up */
+        ecs_os_ainc(&world->workers_gen);
+        if (flecs_worker_load(&world->workers_parked)) {
+            ecs_os_mutex_lock(world->sync_mutex);
+            ecs_os_cond_broadcast(world->worker_cond);
+            ecs_os_mutex_unlock(world->sync_mutex);
+        }
+        return;
+    }
+
     ecs_os_mutex_lock(world->sync_mutex);
     ecs_os_cond_broadcast(world->worker_cond);
     ecs_os_mutex_unlock(world->sync_mutex);
@@ -222,7 +328,188 @@ void flecs_join_worker_threads(
     ecs_assert(world->workers_running == 0, ECS_INTERNAL_ERROR, NULL);
 }
 
+/* Wait until all jobs for a system have finished */
+static
+void flecs_workers_wait_jobs(
+    ecs_worker_jobs_t *sj)
+{
+    int32_t i = 0;
+    while (flecs_worker_load(&sj->jobs_done) != sj->job_count) {
+        if (++ i == FLECS_WORKER_SPIN_COUNT) {
+            /* Another thread is still running a large job, yield */
+            ecs_os_sleep(0, 0);
+            i = 0;
+        }
+    }
+}
+
+/* Count entities matched by system query. This is an estimate, as entities 
+ * can still be filtered out during iteration. The last job of a system always
+ * runs until the end of the results, so a bad estimate won't cause entities to
+ * be skipped. */
+static
+int32_t flecs_workers_entity_count(
+    ecs_query_t *query)
+{
+    int32_t result = 0;
+    ecs_table_cache_hdr_t *cur;
+    for (cur = query->cache.tables.first; cur != NULL; cur = cur->next) {
+        result += ecs_table_count(cur->table);
+    }
+    return result;
+}
+
 /* -- Private functions -- */
+
+/* Split up systems in current pipeline operation in table range jobs */
+void flecs_workers_prepare_jobs(
+    ecs_world_t *world,
+    ecs_pipeline_state_t *pq,
+    int32_t stage_count)
+{
+    ecs_allocator_t *a = &world->allocator;
+    ecs_pipeline_op_t *op = pq->cur_op;
+
+    ecs_vec_reset_t(a, &pq->jobs, ecs_worker_job_t);
+    ecs_vec_reset_t(a, &pq->job_queues, ecs_worker_queue_t);
+    ecs_vec_reset_t(a, &pq->job_systems, ecs_worker_jobs_t);
+    ecs_vec_reset_t(a, &pq->job_deps, int32_t);
+
+    ecs_entity_t *systems = ecs_vec_first_t(&pq->systems, ecs_entity_t);
+    ecs_pipeline_deps_t *system_deps = ecs_vec_first_t(
+        &pq->system_deps, ecs_pipeline_deps_t);
+    int32_t *deps = ecs_vec_first_t(&pq->deps, int32_t);
+    int32_t i, count = op->offset + op->count;
+    for (i = pq->cur_i; i < count; i ++) {
+        ecs_entity_t system = systems[i];
+        const EcsPoly *poly = ecs_get_pair(world, system, EcsPoly, EcsSystem);
+        ecs_poly_assert(poly->poly, ecs_system_t);
+        ecs_system_t *sys = (ecs_system_t*)poly->poly;
+
+        ecs_worker_jobs_t *sj = ecs_vec_append_t(
+            a, &pq->job_systems, ecs_worker_jobs_t);
+        sj->system = system;
+        sj->sys = sys;
+        sj->jobs_done = 0;
+        sj->queues = ecs_vec_count(&pq->job_queues);
+        sj->is_task = sys->query->filter.term_count == 0;
+
+        /* Store systems to wait for as indices in the job_systems vector. 
+         * Systems that ran before a pipeline rebuild are already done. */
+        sj->deps = ecs_vec_count(&pq->job_deps);
+        sj->dep_count = 0;
+        int32_t d, dep_last = system_deps[i].offset + system_deps[i].count;
+        for (d = system_deps[i].offset; d < dep_last; d ++) {
+            if (deps[d] >= pq->cur_i) {
+                ecs_vec_append_t(a, &pq->job_deps, int32_t)[0] = 
+                    deps[d] - pq->cur_i;
+                sj->dep_count ++;
+            }
+        }
+
+        if (sj->is_task) {
+            /* Task is done when it has ran on each thread */
+            sj->job_count = stage_count;
+            continue;
+        }
+
+        int32_t entity_count = flecs_workers_entity_count(sys->query);
+        int32_t max_jobs = stage_count * FLECS_WORKER_JOBS_PER_THREAD;
+        int32_t job_count = entity_count / FLECS_WORKER_JOB_MIN_SIZE;
+        if (job_count > max_jobs) {
+            job_count = max_jobs;
+        } else if (!job_count) {
+            job_count = 1;
+        }
+        int32_t job_size = entity_count / job_count;
+
+        sj->job_count = job_count;
+
+        int32_t j, first = ecs_vec_count(&pq->jobs);
+        ecs_worker_job_t *jobs = ecs_vec_grow_t(
+            a, &pq->jobs, ecs_worker_job_t, job_count);
+        for (j = 0; j < job_count; j ++) {
+            jobs[j].offset = j * job_size;
+            jobs[j].limit = job_size;
+        }
+
+        /* Last job runs until the end of the system results */
+        jobs[job_count - 1].limit = 0;
+
+        /* Divide jobs across thread queues */
+        ecs_worker_queue_t *queues = ecs_vec_grow_t(
+            a, &pq->job_queues, ecs_worker_queue_t, stage_count);
+        for (j = 0; j < stage_count; j ++) {
+            queues[j].head = first + (j * job_count) / stage_count;
+            queues[j].last = first + ((j + 1) * job_count) / stage_count;
+        }
+    }
+}
+
+/* Run jobs for current pipeline operation. A thread first claims jobs from its
+ * own queue, and then steals from the queues of other threads. Before starting
+ * on a system a thread waits until the systems it depends on have finished, so
+ * that systems that don't access the same components run in parallel. */
+int32_t flecs_workers_run_jobs(
+    ecs_world_t *world,
+    ecs_stage_t *stage,
+    int32_t stage_index,
+    int32_t stage_count,
+    ecs_ftime_t delta_time)
+{
+    ecs_pipeline_state_t *pq = world->pq;
+    ecs_pipeline_op_t *op = pq->cur_op;
+
+    ecs_worker_jobs_t *sjs = ecs_vec_first_t(&pq->job_systems, ecs_worker_jobs_t);
+    ecs_worker_queue_t *queues = ecs_vec_first_t(
+        &pq->job_queues, ecs_worker_queue_t);
+    ecs_worker_job_t *jobs = ecs_vec_first_t(&pq->jobs, ecs_worker_job_t);
+    int32_t *deps = ecs_vec_first_t(&pq->job_deps, int32_t);
+
+    ecs_stage_t *s = NULL;
+    if (!op->no_readonly) {
+        s = stage;
+    }
+
+    int32_t i, count = ecs_vec_count(&pq->job_systems);
+    for (i = 0; i < count; i ++) {
+        ecs_worker_jobs_t *sj = &sjs[i];
+        sj->sys->last_frame = world->info.frame_count_total + 1;
+
+        int32_t d;
+        for (d = 0; d < sj->dep_count; d ++) {
+            flecs_workers_wait_jobs(&sjs[deps[sj->deps + d]]);
+        }
+
+        if (sj->is_task) {
+            ecs_run_intern(world, s, sj->system, sj->sys, stage_index,
+                stage_count, delta_time, 0, 0, false, NULL);
+            ecs_os_ainc(&sj->jobs_done);
+        } else {
+            ecs_worker_queue_t *sq = &queues[sj->queues];
+            int32_t v;
+            for (v = 0; v < stage_count; v ++) {
+                ecs_worker_queue_t *q = &sq[(stage_index + v) % stage_count];
+                int32_t j;
+                while ((j = ecs_os_ainc(&q->head) - 1) < q->last) {
+                    ecs_worker_job_t *job = &jobs[j];
+
+                    /* Jobs aren't split up further across workers */
+                    ecs_run_intern(world, s, sj->system, sj->sys, stage_index,
+                        1, delta_time, job->offset, job->limit, false, NULL);
+                    ecs_os_ainc(&sj->jobs_done);
+                }
+            }
+        }
+
+        if (!stage_index) {
+            world->info.systems_ran_frame ++;
+        }
+    }
+
+    return op->offset + op->count - 1;
+}
+
 void flecs_workers_progress(
     ecs_world_t *world,
     ecs_pipeline_state_t *pq,
@@ -263,12 +550,15 @@ void flecs_set_threads_internal(
 
             if (world->worker_cond) {
                 ecs_os_cond_free(world->worker_cond);
+                world->worker_cond = 0;
             }
             if (world->sync_cond) {
                 ecs_os_cond_free(world->sync_cond);
+                world->sync_cond = 0;
             }
             if (world->sync_mutex) {
                 ecs_os_mutex_free(world->sync_mutex);
+                world->sync_mutex = 0;
             }
         }
 
@@ -284,8 +574,87 @@ void flecs_set_threads_internal(
     }
 }
 
+bool flecs_workers_can_run_task(
+    const ecs_world_t *world)
+{
+    if (ecs_get_stage_count(world) <= 1 || !world->worker_cond) {
+        return false;
+    }
+
+    /* Workers are busy running a pipeline operation */
+    if (world->flags & (EcsWorldReadonly|EcsWorldMultiThreaded)) {
+        return false;
+    }
+
+    /* Task threads only exist while the pipeline is running */
+    return world->stages[1].thread != 0;
+}
+
+void flecs_workers_run_task(
+    ecs_world_t *world,
+    ecs_worker_task_action_t action,
+    void *ctx)
+{
+    ecs_poly_assert(world, ecs_world_t);
+    ecs_assert(flecs_workers_can_run_task(world), ECS_INTERNAL_ERROR, NULL);
+    ecs_assert(world->worker_task == NULL, ECS_INTERNAL_ERROR, NULL);
+
+    /* Workers that haven't started yet could miss the signal */
+    flecs_wait_for_workers(world);
+
+    world->worker_task = action;
+    world->worker_task_ctx = ctx;
+
+    flecs_signal_workers(world);
+    action(world, &world->stages[0], ctx);
+    flecs_wait_for_sync(world);
+
+    world->worker_task = NULL;
+    world->worker_task_ctx = NULL;
+}
+
 /* -- Public functions -- */
 
+void ecs_set_worker_sched(
+    ecs_world_t *world,
+    ecs_worker_sched_kind_t kind)
+{
+    ecs_poly_assert(world, ecs_world_t);
+    ecs_check(!(world->flags & EcsWorldReadonly), ECS_INVALID_OPERATION, 
+        "cannot change scheduler while pipeline is running");
+
+    bool stealing = kind == EcsWorkerSchedStealing;
+    if (ECS_BIT_IS_SET(world->flags, EcsWorldWorkStealing) == stealing) {
+        return;
+    }
+
+    /* Workers read the scheduler kind when they start, so restart them */
+    int32_t threads = 0;
+    bool use_task_api = world->workers_use_task_api;
+    if (world->worker_cond) {
+        threads = ecs_get_stage_count(world);
+        flecs_set_threads_internal(world, 0, use_task_api);
+    }
+
+    ECS_BIT_COND(world->flags, EcsWorldWorkStealing, stealing);
+
+    if (threads) {
+        flecs_set_threads_internal(world, threads, use_task_api);
+    }
+error:
+    return;
+}
+
+ecs_worker_sched_kind_t ecs_get_worker_sched(
+    const ecs_world_t *world)
+{
+    ecs_poly_assert(world, ecs_world_t);
+    if (ECS_BIT_IS_SET(world->flags, EcsWorldWorkStealing)) {
+        return EcsWorkerSchedStealing;
+    }
+    return EcsWorkerSchedSlice;
+}
+
 void ecs_set_threads(
     ecs_world_t *world,
     int32_t threads)
@@ -0,0 +1,1067 @@
+/**
+ * @file addons/recorder.c
+ * @brief Record & replay command queues.
+ *
+ * A recording is a sequence of records. Each record starts with a byte that
+ * indicates the record kind:
+ *
+ * - Name records store the path of an entity that is used as (part of) an id,
+ *   so ids can be resolved by name when replaying. Names are numbered in the
+ *   order in which they appear in the recording.
+ * - Sync records store the frame and number of commands of a merged queue, and
+ *   are followed by the command records of the queue.
+ * - Command records store the command kind, entity, id and command specific
+ *   data, such as a component value.
+ *
+ * Numbers are stored in the byte order of the machine that made the recording.
+ */
+
+#include "../private_api.h"
+
+#ifdef FLECS_RECORDER
+
+#define FLECS_RECORDER_MAGIC "FLCR"
+#define FLECS_RECORDER_VERSION (1)
+
+#define FLECS_RECORD_NAME ('N')
+#define FLECS_RECORD_SYNC ('S')
+#define FLECS_RECORD_CMD ('C')
+
+typedef enum ecs_record_value_kind_t {
+    EcsRecordValueNone,
+    EcsRecordValueBytes,
+    EcsRecordValueJson
+} ecs_record_value_kind_t;
+
+struct ecs_recorder_t {
+    ecs_world_t *world;
+    FILE *file;
+    ecs_recorder_write_action_t callback;
+    void *ctx;
+    ecs_vec_t buf;                   /* vector<char> with data of current sync */
+    ecs_map_t names;                 /* map<entity, name index + 1> */
+    int32_t name_count;
+};
+
+struct ecs_replayer_t {
+    ecs_world_t *world;
+    char *data;
+    ecs_size_t size;
+    ecs_size_t pos;
+    ecs_vec_t names;                 /* vector<ecs_entity_t> with resolved names */
+};
+
+/* -- Recorder -- */
+
+static
+void flecs_rec_write(
+    ecs_recorder_t *rec,
+    const void *ptr,
+    ecs_size_t size)
+{
+    if (size) {
+        void *dst = ecs_vec_grow_t(NULL, &rec->buf, char, size);
+        ecs_os_memcpy(dst, ptr, size);
+    }
+}
+
+static
+void flecs_rec_u8(
+    ecs_recorder_t *rec,
+    uint8_t value)
+{
+    flecs_rec_write(rec, &value, ECS_SIZEOF(uint8_t));
+}
+
+static
+void flecs_rec_i32(
+    ecs_recorder_t *rec,
+    int32_t value)
+{
+    flecs_rec_write(rec, &value, ECS_SIZEOF(int32_t));
+}
+
+static
+void flecs_rec_u64(
+    ecs_recorder_t *rec,
+    uint64_t value)
+{
+    flecs_rec_write(rec, &value, ECS_SIZEOF(uint64_t));
+}
+
+static
+void flecs_rec_str(
+    ecs_recorder_t *rec,
+    const char *str)
+{
+    ecs_size_t len = ecs_os_strlen(str);
+    flecs_rec_i32(rec, len);
+    flecs_rec_write(rec, str, len);
+}
+
+static
+void flecs_rec_flush(
+    ecs_recorder_t *rec)
+{
+    ecs_size_t size = ecs_vec_count(&rec->buf);
+    if (!size) {
+        return;
+    }
+
+    const void *data = ecs_vec_first(&rec->buf);
+    if (rec->file) {
+        fwrite(data, 1, flecs_itosize(size), rec->file);
+    } else if (rec->callback) {
+        rec->callback(data, size, rec->ctx);
+    }
+
+    ecs_vec_clear(&rec->buf);
+}
+
+/* Write name record for entity if it has a name and wasn't written yet */
+static
+void flecs_rec_name(
+    ecs_recorder_t *rec,
+    ecs_entity_t e)
+{
+    ecs_world_t *world = rec->world;
+    if (!e || (e == EcsWildcard) || (e == EcsAny)) {
+        return;
+    }
+
+    e = ecs_get_alive(world, e);
+    if (!e || !ecs_get_name(world, e)) {
+        return;
+    }
+
+    ecs_map_val_t *index = ecs_map_ensure(&rec->names, e);
+    if (index[0]) {
+        return;
+    }
+
+    rec->name_count ++;
+    index[0] = flecs_ito(uint64_t, rec->name_count);
+
+    char *path = ecs_get_fullpath(world, e);
+    flecs_rec_u8(rec, FLECS_RECORD_NAME);
+    flecs_rec_str(rec, path);
+    ecs_os_free(path);
+}
+
+static
+void flecs_rec_id_names(
+    ecs_recorder_t *rec,
+    ecs_id_t id)
+{
+    if (ECS_IS_PAIR(id)) {
+        flecs_rec_name(rec, ECS_PAIR_FIRST(id));
+        flecs_rec_name(rec, ECS_PAIR_SECOND(id));
+    } else {
+        flecs_rec_name(rec, id & ECS_COMPONENT_MASK);
+    }
+}
+
+static
+int32_t flecs_rec_name_index(
+    ecs_recorder_t *rec,
+    ecs_entity_t e)
+{
+    if (!e) {
+        return 0;
+    }
+
+    e = ecs_get_alive(rec->world, e);
+    if (!e) {
+        return 0;
+    }
+
+    ecs_map_val_t *index = ecs_map_get(&rec->names, e);
+    if (!index) {
+        return 0;
+    }
+
+    return flecs_uto(int32_t, index[0]);
+}
+
+/* Ids are stored as raw id, followed by the name indices of the id (or pair
+ * elements). A name index of 0 means the element has no name. */
+static
+void flecs_rec_id(
+    ecs_recorder_t *rec,
+    ecs_id_t id)
+{
+    flecs_rec_u64(rec, id);
+    if (ECS_IS_PAIR(id)) {
+        flecs_rec_i32(rec, flecs_rec_name_index(rec, ECS_PAIR_FIRST(id)));
+        flecs_rec_i32(rec, flecs_rec_name_index(rec, ECS_PAIR_SECOND(id)));
+    } else {
+        flecs_rec_i32(rec, flecs_rec_name_index(rec, id & ECS_COMPONENT_MASK));
+        flecs_rec_i32(rec, 0);
+    }
+}
+
+static
+void flecs_rec_value(
+    ecs_recorder_t *rec,
+    ecs_id_t id,
+    const void *ptr)
+{
+    ecs_world_t *world = rec->world;
+    const ecs_type_info_t *ti = NULL;
+    if (ptr) {
+        ti = ecs_get_type_info(world, id);
+    }
+
+    if (!ti) {
+        flecs_rec_u8(rec, EcsRecordValueNone);
+        return;
+    }
+
+    /* Values of types without hooks can be copied as bytes */
+    if (!ti->hooks.copy && !ti->hooks.move && !ti->hooks.dtor) {
+        flecs_rec_u8(rec, EcsRecordValueBytes);
+        flecs_rec_i32(rec, ti->size);
+        flecs_rec_write(rec, ptr, ti->size);
+        return;
+    }
+
+#ifdef FLECS_JSON
+    if (ecs_has(world, ti->component, EcsMetaType)) {
+        char *json = ecs_ptr_to_json(world, ti->component, ptr);
+        if (json) {
+            flecs_rec_u8(rec, EcsRecordValueJson);
+            flecs_rec_str(rec, json);
+            ecs_os_free(json);
+            return;
+        }
+    }
+#endif
+
+    flecs_rec_u8(rec, EcsRecordValueNone);
+}
+
+static
+bool flecs_rec_cmd_is_recorded(
+    ecs_world_t *world,
+    const ecs_cmd_t *cmd)
+{
+    ecs_entity_t e = cmd->entity;
+    switch(cmd->kind) {
+    case EcsCmdAdd:
+    case EcsCmdRemove:
+    case EcsCmdSet:
+    case EcsCmdEmplace:
+    case EcsCmdEnsure:
+    case EcsCmdModified:
+    case EcsCmdModifiedNoHook:
+    case EcsCmdAddModified:
+    case EcsCmdClone:
+    case EcsCmdDelete:
+    case EcsCmdClear:
+    case EcsCmdEnable:
+    case EcsCmdDisable:
+    case EcsCmdEvent:
+        /* Commands for entities that are not alive are discarded by merge */
+        return e && flecs_entities_is_alive(world, e);
+    case EcsCmdPath:
+    case EcsCmdBulkNew:
+        return true;
+    case EcsCmdOnDeleteAction:
+    case EcsCmdSkip:
+    default:
+        return false;
+    }
+}
+
+static
+void flecs_rec_cmd_names(
+    ecs_recorder_t *rec,
+    const ecs_cmd_t *cmd)
+{
+    flecs_rec_id_names(rec, cmd->id);
+
+    if (cmd->kind == EcsCmdEvent) {
+        const ecs_event_desc_t *desc = cmd->is._1.value;
+        flecs_rec_name(rec, desc->event);
+        if (desc->ids) {
+            int32_t i;
+            for (i = 0; i < desc->ids->count; i ++) {
+                flecs_rec_id_names(rec, desc->ids->array[i]);
+            }
+        }
+    }
+}
+
+static
+void flecs_rec_cmd(
+    ecs_recorder_t *rec,
+    const ecs_cmd_t *cmd)
+{
+    ecs_world_t *world = rec->world;
+    ecs_cmd_kind_t kind = cmd->kind;
+
+    /* Add + modified doesn't store the value in the command, as the value was
+     * assigned directly to the existing component. Record it as a set with the
+     * current value of the component. */
+    const void *value = NULL;
+    if (kind == EcsCmdAddModified) {
+        kind = EcsCmdSet;
+        value = ecs_get_id(world, cmd->entity, cmd->id);
+    } else {
+        value = cmd->is._1.value;
+    }
+
+    flecs_rec_u8(rec, FLECS_RECORD_CMD);
+    flecs_rec_u8(rec, flecs_ito(uint8_t, kind));
+    flecs_rec_u64(rec, cmd->entity);
+    flecs_rec_id(rec, cmd->id);
+
+    switch(kind) {
+    case EcsCmdSet:
+    case EcsCmdEmplace:
+    case EcsCmdEnsure:
+        flecs_rec_value(rec, cmd->id, value);
+        break;
+    case EcsCmdClone:
+        flecs_rec_u8(rec, cmd->is._1.clone_value);
+        break;
+    case EcsCmdPath:
+        flecs_rec_str(rec, cmd->is._1.value);
+        break;
+    case EcsCmdBulkNew:
+        flecs_rec_i32(rec, cmd->is._n.count);
+        flecs_rec_write(rec, cmd->is._n.entities,
+            cmd->is._n.count * ECS_SIZEOF(ecs_entity_t));
+        break;
+    case EcsCmdEvent: {
+        const ecs_event_desc_t *desc = cmd->is._1.value;
+        int32_t i, count = desc->ids ? desc->ids->count : 0;
+        flecs_rec_id(rec, desc->event);
+        flecs_rec_i32(rec, count);
+        for (i = 0; i < count; i ++) {
+            flecs_rec_id(rec, desc->ids->array[i]);
+        }
+        const void *param = desc->param;
+        if (!param) {
+            param = desc->const_param;
+        }
+        flecs_rec_value(rec, desc->event, param);
+        break;
+    }
+    case EcsCmdAdd:
+    case EcsCmdRemove:
+    case EcsCmdModified:
+    case EcsCmdModifiedNoHook:
+    case EcsCmdAddModified:
+    case EcsCmdDelete:
+    case EcsCmdClear:
+    case EcsCmdOnDeleteAction:
+    case EcsCmdEnable:
+    case EcsCmdDisable:
+    case EcsCmdSkip:
+    default:
+        break;
+    }
+}
+
+static
+void flecs_rec_on_commands(
+    const ecs_stage_t *stage,
+    const ecs_vec_t *commands,
+    void *ctx)
+{
+    ecs_recorder_t *rec = ctx;
+    ecs_world_t *world = rec->world;
+    ecs_assert(stage->world == world, ECS_INTERNAL_ERROR, NULL);
+    (void)stage;
+
+    int32_t i, count = ecs_vec_count(commands);
+    ecs_cmd_t *cmds = ecs_vec_first(commands);
+
+    /* Names are written before the sync, so that they're resolved before the
+     * replayer starts deferring the commands of the sync. */
+    int32_t recorded = 0;
+    for (i = 0; i < count; i ++) {
+        if (flecs_rec_cmd_is_recorded(world, &cmds[i])) {
+            flecs_rec_cmd_names(rec, &cmds[i]);
+            recorded ++;
+        }
+    }
+
+    if (!recorded) {
+        return;
+    }
+
+    flecs_rec_u8(rec, FLECS_RECORD_SYNC);
+    flecs_rec_u64(rec, flecs_ito(uint64_t, world->info.frame_count_total));
+    flecs_rec_i32(rec, recorded);
+
+    for (i = 0; i < count; i ++) {
+        if (flecs_rec_cmd_is_recorded(world, &cmds[i])) {
+            flecs_rec_cmd(rec, &cmds[i]);
+        }
+    }
+
+    flecs_rec_flush(rec);
+}
+
+ecs_recorder_t* ecs_recorder_start(
+    ecs_world_t *world,
+    const ecs_recorder_desc_t *desc)
+{
+    ecs_poly_assert(world, ecs_world_t);
+    ecs_check(desc != NULL, ECS_INVALID_PARAMETER, NULL);
+    ecs_check(desc->filename || desc->callback, ECS_INVALID_PARAMETER,
+        "recorder must have a filename or callback");
+    ecs_check(!world->on_commands_record, ECS_INVALID_OPERATION,
+        "world already has an active recorder");
+
+    FILE *file = NULL;
+    if (desc->filename) {
+        ecs_os_fopen(&file, desc->filename, "wb");
+        if (!file) {
+            ecs_err("%s (%s)", ecs_os_strerror(errno), desc->filename);
+            goto error;
+        }
+    }
+
+    ecs_recorder_t *rec = ecs_os_calloc_t(ecs_recorder_t);
+    rec->world = world;
+    rec->file = file;
+    rec->callback = desc->callback;
+    rec->ctx = desc->ctx;
+    ecs_vec_init_t(NULL, &rec->buf, char, 0);
+    ecs_map_init(&rec->names, NULL);
+
+    flecs_rec_write(rec, FLECS_RECORDER_MAGIC, 4);
+    flecs_rec_i32(rec, FLECS_RECORDER_VERSION);
+    flecs_rec_flush(rec);
+
+    world->on_commands_record = flecs_rec_on_commands;
+    world->on_commands_record_ctx = rec;
+
+    return rec;
+error:
+    return NULL;
+}
+
+void ecs_recorder_stop(
+    ecs_recorder_t *rec)
+{
+    ecs_check(rec != NULL, ECS_INVALID_PARAMETER, NULL);
+
+    ecs_world_t *world = rec->world;
+    ecs_assert(world->on_commands_record_ctx == rec,
+        ECS_INTERNAL_ERROR, NULL);
+    world->on_commands_record = NULL;
+    world->on_commands_record_ctx = NULL;
+
+    flecs_rec_flush(rec);
+    if (rec->file) {
+        fclose(rec->file);
+    }
+
+    ecs_vec_fini_t(NULL, &rec->buf, char);
+    ecs_map_fini(&rec->names);
+    ecs_os_free(rec);
+error:
+    return;
+}
+
+/* -- Replayer -- */
+
+static
+bool flecs_rp_read(
+    ecs_replayer_t *rp,
+    void *dst,
+    ecs_size_t size)
+{
+    if ((rp->size - rp->pos) < size) {
+        ecs_err("replay: unexpected end of recording");
+        return false;
+    }
+
+    ecs_os_memcpy(dst, &rp->data[rp->pos], size);
+    rp->pos += size;
+    return true;
+}
+
+static
+bool flecs_rp_u8(
+    ecs_replayer_t *rp,
+    uint8_t *value)
+{
+    return flecs_rp_read(rp, value, ECS_SIZEOF(uint8_t));
+}
+
+static
+bool flecs_rp_i32(
+    ecs_replayer_t *rp,
+    int32_t *value)
+{
+    return flecs_rp_read(rp, value, ECS_SIZEOF(int32_t));
+}
+
+static
+bool flecs_rp_u64(
+    ecs_replayer_t *rp,
+    uint64_t *value)
+{
+    return flecs_rp_read(rp, value, ECS_SIZEOF(uint64_t));
+}
+
+/* Returns pointer to data in recording */
+static
+const char* flecs_rp_bytes(
+    ecs_replayer_t *rp,
+    ecs_size_t *size_out)
+{
+    int32_t size;
+    if (!flecs_rp_i32(rp, &size)) {
+        return NULL;
+    }
+
+    if ((size < 0) || ((rp->size - rp->pos) < size)) {
+        ecs_err("replay: unexpected end of recording");
+        return NULL;
+    }
+
+    const char *result = &rp->data[rp->pos];
+    rp->pos += size;
+    *size_out = size;
+    return result;
+}
+
+static
+char* flecs_rp_str(
+    ecs_replayer_t *rp)
+{
+    ecs_size_t len;
+    const char *str = flecs_rp_bytes(rp, &len);
+    if (!str) {
+        return NULL;
+    }
+
+    char *result = ecs_os_malloc(len + 1);
+    ecs_os_memcpy(result, str, len);
+    result[len] = '\0';
+    return result;
+}
+
+static
+int flecs_rp_name(
+    ecs_replayer_t *rp)
+{
+    ecs_world_t *world = rp->world;
+    char *path = flecs_rp_str(rp);
+    if (!path) {
+        return -1;
+    }
+
+    ecs_entity_t e = ecs_lookup_fullpath(world, path);
+    if (!e) {
+        e = ecs_entity(world, { .name = path, .sep = ".", .root_sep = "" });
+    }
+
+    ecs_vec_append_t(NULL, &rp->names, ecs_entity_t)[0] = e;
+    ecs_os_free(path);
+    return 0;
+}
+
+static
+ecs_entity_t flecs_rp_resolve(
+    ecs_replayer_t *rp,
+    int32_t name,
+    ecs_entity_t e)
+{
+    if (!name) {
+        return e;
+    }
+
+    return ecs_vec_get_t(&rp->names, ecs_entity_t, name - 1)[0];
+}
+
+static
+bool flecs_rp_id(
+    ecs_replayer_t *rp,
+    ecs_id_t *id_out)
+{
+    uint64_t id;
+    int32_t first, second;
+    if (!flecs_rp_u64(rp, &id) || !flecs_rp_i32(rp, &first) ||
+        !flecs_rp_i32(rp, &second))
+    {
+        return false;
+    }
+
+    int32_t name_count = ecs_vec_count(&rp->names);
+    if ((first < 0) || (first > name_count) || 
+        (second < 0) || (second > name_count))
+    {
+        ecs_err("replay: invalid name index");
+        return false;
+    }
+
+    if (ECS_IS_PAIR(id)) {
+        ecs_entity_t r = flecs_rp_resolve(rp, first, ECS_PAIR_FIRST(id));
+        ecs_entity_t t = flecs_rp_resolve(rp, second, ECS_PAIR_SECOND(id));
+        *id_out = (r && t) ? ecs_pair(r & ECS_ENTITY_MASK, t) : 0;
+    } else {
+        ecs_entity_t e = flecs_rp_resolve(rp, first, id & ECS_COMPONENT_MASK);
+        *id_out = e ? ((id & ECS_ID_FLAGS_MASK) | e) : 0;
+    }
+
+    return true;
+}
+
+/* Reads value. Values stored as JSON are deserialized into tmp_out, which must
+ * be freed by the caller. */
+static
+bool flecs_rp_value(
+    ecs_replayer_t *rp,
+    ecs_id_t id,
+    const void **value_out,
+    void **tmp_out)
+{
+    ecs_world_t *world = rp->world;
+    uint8_t kind;
+    ecs_size_t size = 0;
+    const char *data = NULL;
+
+    *value_out = NULL;
+    *tmp_out = NULL;
+
+    if (!flecs_rp_u8(rp, &kind)) {
+        return false;
+    }
+
+    if (kind == EcsRecordValueNone) {
+        return true;
+    }
+
+    if (!(data = flecs_rp_bytes(rp, &size))) {
+        return false;
+    }
+
+    const ecs_type_info_t *ti = NULL;
+    if (id) {
+        ti = ecs_get_type_info(world, id);
+    }
+    if (!ti) {
+        /* Component isn't registered in this world */
+        return true;
+    }
+
+    if (kind == EcsRecordValueBytes) {
+        if (size == ti->size) {
+            *value_out = data;
+        }
+    } else if (kind == EcsRecordValueJson) {
+#ifdef FLECS_JSON
+        char *json = ecs_os_malloc(size + 1);
+        ecs_os_memcpy(json, data, size);
+        json[size] = '\0';
+        void *tmp = ecs_value_new(world, ti->component);
+        if (ecs_ptr_from_json(world, ti->component, tmp, json, NULL)) {
+            *value_out = *tmp_out = tmp;
+        } else {
+            ecs_value_free(world, ti->component, tmp);
+        }
+        ecs_os_free(json);
+#endif
+    } else {
+        ecs_err("replay: invalid value kind %u", kind);
+        return false;
+    }
+
+    return true;
+}
+
+static
+void flecs_rp_value_free(
+    ecs_replayer_t *rp,
+    ecs_id_t id,
+    void *tmp)
+{
+    if (tmp) {
+        const ecs_type_info_t *ti = ecs_get_type_info(rp->world, id);
+        ecs_value_free(rp->world, ti->component, tmp);
+    }
+}
+
+/* Make entity alive with the recorded id. Returns false if a different
+ * generation of the entity is alive. */
+static
+bool flecs_rp_entity(
+    ecs_replayer_t *rp,
+    ecs_entity_t e)
+{
+    ecs_entity_t alive = ecs_get_alive(rp->world, (uint32_t)e);
+    if (!alive) {
+        ecs_make_alive(rp->world, e);
+        return true;
+    }
+    return alive == e;
+}
+
+static
+void flecs_rp_assign(
+    const ecs_type_info_t *ti,
+    void *dst,
+    const void *src,
+    bool construct)
+{
+    ecs_copy_t copy = construct ? ti->hooks.copy_ctor : ti->hooks.copy;
+    if (copy) {
+        copy(dst, src, 1, ti);
+    } else {
+        ecs_os_memcpy(dst, src, ti->size);
+    }
+}
+
+static
+int flecs_rp_cmd(
+    ecs_replayer_t *rp)
+{
+    ecs_world_t *world = rp->world;
+    uint8_t tag, kind;
+    uint64_t e;
+    ecs_id_t id;
+
+    if (!flecs_rp_u8(rp, &tag)) {
+        return -1;
+    }
+    if (tag != FLECS_RECORD_CMD) {
+        ecs_err("replay: expected command record");
+        return -1;
+    }
+
+    if (!flecs_rp_u8(rp, &kind) || !flecs_rp_u64(rp, &e) ||
+        !flecs_rp_id(rp, &id))
+    {
+        return -1;
+    }
+
+    /* Read command data before checking if command can be applied, so that
+     * the replayer always advances to the next command. */
+    bool valid = !e || flecs_rp_entity(rp, e);
+
+    switch(kind) {
+    case EcsCmdAdd:
+        if (valid && id) {
+            ecs_add_id(world, e, id);
+        }
+        break;
+    case EcsCmdRemove:
+        if (valid && id) {
+            ecs_remove_id(world, e, id);
+        }
+        break;
+    case EcsCmdSet:
+    case EcsCmdEmplace:
+    case EcsCmdEnsure: {
+        const void *value;
+        void *tmp;
+        if (!flecs_rp_value(rp, id, &value, &tmp)) {
+            return -1;
+        }
+        if (valid && id) {
+            const ecs_type_info_t *ti = ecs_get_type_info(world, id);
+            if (!value || !ti) {
+                ecs_add_id(world, e, id);
+            } else if (kind == EcsCmdSet) {
+                ecs_set_id(world, e, id, flecs_itosize(ti->size), value);
+            } else if (kind == EcsCmdEnsure) {
+                flecs_rp_assign(ti, ecs_ensure_id(world, e, id), value, false);
+            } else {
+                flecs_rp_assign(ti, ecs_emplace_id(world, e, id), value, true);
+            }
+        }
+        flecs_rp_value_free(rp, id, tmp);
+        break;
+    }
+    case EcsCmdModified:
+    case EcsCmdModifiedNoHook:
+        if (valid && id && ecs_has_id(world, e, id)) {
+            ecs_modified_id(world, e, id);
+        }
+        break;
+    case EcsCmdClone: {
+        uint8_t clone_value;
+        if (!flecs_rp_u8(rp, &clone_value)) {
+            return -1;
+        }
+        if (valid && id && ecs_is_alive(world, id)) {
+            ecs_clone(world, e, id, clone_value != 0);
+        }
+        break;
+    }
+    case EcsCmdPath: {
+        char *name = flecs_rp_str(rp);
+        if (!name) {
+            return -1;
+        }
+        if (valid) {
+            if (id) {
+                ecs_add_pair(world, e, EcsChildOf, id);
+            }
+            ecs_set_name(world, e, name);
+        }
+        ecs_os_free(name);
+        break;
+    }
+    case EcsCmdBulkNew: {
+        int32_t i, count;
+        if (!flecs_rp_i32(rp, &count)) {
+            return -1;
+        }
+        for (i = 0; i < count; i ++) {
+            uint64_t entity;
+            if (!flecs_rp_u64(rp, &entity)) {
+                return -1;
+            }
+            if (flecs_rp_entity(rp, entity) && id) {
+                ecs_add_id(world, entity, id);
+            }
+        }
+        break;
+    }
+    case EcsCmdDelete:
+        if (valid) {
+            ecs_delete(world, e);
+        }
+        break;
+    case EcsCmdClear:
+        if (valid) {
+            ecs_clear(world, e);
+        }
+        break;
+    case EcsCmdEnable:
+    case EcsCmdDisable:
+        if (valid && id) {
+            ecs_enable_id(world, e, id, kind == EcsCmdEnable);
+        }
+        break;
+    case EcsCmdEvent: {
+        ecs_id_t event;
+        int32_t i, count;
+        if (!flecs_rp_id(rp, &event) || !flecs_rp_i32(rp, &count)) {
+            return -1;
+        }
+        if (count < 0) {
+            ecs_err("replay: invalid id count for event");
+            return -1;
+        }
+
+        ecs_vec_t ids;
+        ecs_vec_init_t(NULL, &ids, ecs_id_t, count);
+        bool ids_valid = true;
+        for (i = 0; i < count; i ++) {
+            ecs_id_t *ptr = ecs_vec_append_t(NULL, &ids, ecs_id_t);
+            if (!flecs_rp_id(rp, ptr)) {
+                ecs_vec_fini_t(NULL, &ids, ecs_id_t);
+                return -1;
+            }
+            ids_valid &= ptr[0] != 0;
+        }
+
+        const void *param;
+        void *tmp;
+        if (!flecs_rp_value(rp, event, &param, &tmp)) {
+            ecs_vec_fini_t(NULL, &ids, ecs_id_t);
+            return -1;
+        }
+
+        if (valid && event && ids_valid) {
+            ecs_enqueue(world, &(ecs_event_desc_t) {
+                .event = event,
+                .ids = &(ecs_type_t){
+                    .array = ecs_vec_first(&ids), .count = count },
+                .entity = e,
+                .const_param = param
+            });
+        }
+
+        flecs_rp_value_free(rp, event, tmp);
+        ecs_vec_fini_t(NULL, &ids, ecs_id_t);
+        break;
+    }
+    case EcsCmdAddModified:
+    case EcsCmdOnDeleteAction:
+    case EcsCmdSkip:
+    default:
+        ecs_err("replay: invalid command kind %u", kind);
+        return -1;
+    }
+
+    return 0;
+}
+
+static
+int flecs_rp_sync(
+    ecs_replayer_t *rp,
+    int32_t count)
+{
+    ecs_world_t *world = rp->world;
+    int result = 0;
+    int32_t i;
+
+    ecs_defer_begin(world);
+    for (i = 0; i < count; i ++) {
+        if ((result = flecs_rp_cmd(rp))) {
+            break;
+        }
+    }
+    ecs_defer_end(world);
+
+    return result;
+}
+
+ecs_replayer_t* ecs_replayer_new(
+    ecs_world_t *world,
+    const void *data,
+    ecs_size_t size)
+{
+    ecs_poly_assert(world, ecs_world_t);
+    ecs_check(data != NULL, ECS_INVALID_PARAMETER, NULL);
+    ecs_check(size >= 0, ECS_INVALID_PARAMETER, NULL);
+
+    int32_t version;
+    if ((size < (4 + ECS_SIZEOF(int32_t))) ||
+        ecs_os_memcmp(data, FLECS_RECORDER_MAGIC, 4))
+    {
+        ecs_err("replay: data is not a recording");
+        goto error;
+    }
+
+    ecs_os_memcpy(&version, ECS_OFFSET(data, 4), ECS_SIZEOF(int32_t));
+    if (version != FLECS_RECORDER_VERSION) {
+        ecs_err("replay: unsupported recording version %d", version);
+        goto error;
+    }
+
+    ecs_replayer_t *rp = ecs_os_calloc_t(ecs_replayer_t);
+    rp->world = world;
+    rp->data = ecs_os_memdup(data, size);
+    rp->size = size;
+    rp->pos = 4 + ECS_SIZEOF(int32_t);
+    ecs_vec_init_t(NULL, &rp->names, ecs_entity_t, 0);
+    return rp;
+error:
+    return NULL;
+}
+
+ecs_replayer_t* ecs_replayer_from_file(
+    ecs_world_t *world,
+    const char *filename)
+{
+    ecs_check(filename != NULL, ECS_INVALID_PARAMETER, NULL);
+
+    FILE *file;
+    ecs_os_fopen(&file, filename, "rb");
+    if (!file) {
+        ecs_err("%s (%s)", ecs_os_strerror(errno), filename);
+        goto error;
+    }
+
+    fseek(file, 0, SEEK_END);
+    long bytes = ftell(file);
+    fseek(file, 0, SEEK_SET);
+    if (bytes < 0) {
+        fclose(file);
+        goto error;
+    }
+
+    size_t size = (size_t)bytes;
+    void *data = ecs_os_malloc(flecs_uto(ecs_size_t, size) + 1);
+    if (fread(data, 1, size, file) != size) {
+        ecs_err("%s: failed to read recording", filename);
+        ecs_os_free(data);
+        fclose(file);
+        goto error;
+    }
+    fclose(file);
+
+    ecs_replayer_t *rp = ecs_replayer_new(
+        world, data, flecs_uto(ecs_size_t, size));
+    ecs_os_free(data);
+    return rp;
+error:
+    return NULL;
+}
+
+int ecs_replayer_next_frame(
+    ecs_replayer_t *rp)
+{
+    ecs_check(rp != NULL, ECS_INVALID_PARAMETER, NULL);
+
+    bool has_frame = false;
+    uint64_t frame = 0;
+
+    while (rp->pos < rp->size) {
+        uint8_t kind = flecs_uto(uint8_t, rp->data[rp->pos]);
+        if (kind == FLECS_RECORD_NAME) {
+            rp->pos ++;
+            if (flecs_rp_name(rp)) {
+                goto error;
+            }
+        } else if (kind == FLECS_RECORD_SYNC) {
+            ecs_size_t start = rp->pos ++;
+            uint64_t sync_frame;
+            int32_t count;
+            if (!flecs_rp_u64(rp, &sync_frame) || !flecs_rp_i32(rp, &count)) {
+                goto error;
+            }
+
+            if (has_frame && (sync_frame != frame)) {
+                /* Sync belongs to the next frame */
+                rp->pos = start;
+                break;
+            }
+
+            has_frame = true;
+            frame = sync_frame;
+
+            if (flecs_rp_sync(rp, count)) {
+                goto error;
+            }
+        } else {
+            ecs_err("replay: invalid record kind %u", kind);
+            goto error;
+        }
+    }
+
+    return has_frame;
+error:
+    return -1;
+}
+
+void ecs_replayer_free(
+    ecs_replayer_t *rp)
+{
+    ecs_check(rp != NULL, ECS_INVALID_PARAMETER, NULL);
+    ecs_vec_fini_t(NULL, &rp->names, ecs_entity_t);
+    ecs_os_free(rp->data);
+    ecs_os_free(rp);
+error:
+    return;
+}
+
+int ecs_replay(
+    ecs_world_t *world,
+    const void *data,
+    ecs_size_t size)
+{
+    ecs_replayer_t *rp = ecs_replayer_new(world, data, size);
+    if (!rp) {
+        return -1;
+    }
+
+    int result;
+    while ((result = ecs_replayer_next_frame(rp)) > 0) { }
+
+    ecs_replayer_free(rp);
+    return result;
+}
+
+#endif
@@ -680,6 +680,10 @@ void flecs_world_stats_to_json(
     ECS_COUNTER_APPEND(reply, stats, memory.stack_alloc_count, "Pages allocated by stack allocators");
     ECS_COUNTER_APPEND(reply, stats, memory.stack_free_count, "Pages freed by stack allocators");
     ECS_GAUGE_APPEND(reply, stats, memory.stack_outstanding_alloc_count, "Outstanding page allocations");
+    ECS_GAUGE_APPEND(reply, stats, memory.allocator_bytes_in_use, "Bytes in use by block allocators");
+    ECS_GAUGE_APPEND(reply, stats, memory.allocator_bytes_reserved, "Bytes reserved by block allocators");
+    ECS_GAUGE_APPEND(reply, stats, memory.allocator_chunk_count, "Chunks in use by block allocators");
+    ECS_GAUGE_APPEND(reply, stats, memory.allocator_block_count, "Blocks allocated by block allocators");
 
     ECS_COUNTER_APPEND(reply, stats, http.request_received_count, "Received requests");
     ECS_COUNTER_APPEND(reply, stats, http.request_invalid_count, "Received invalid requests");
@@ -762,6 +766,49 @@ void flecs_pipeline_stats_to_json(
     ecs_strbuf_list_pop(reply, "]");
 }
 
+static
+void flecs_allocator_stats_to_json(
+    ecs_strbuf_t *reply,
+    const ecs_allocator_stats_t *stats)
+{
+    ecs_strbuf_list_push(reply, "{", ",");
+    ecs_strbuf_list_appendlit(reply, "\"bytes_in_use\":");
+    ecs_strbuf_appendint(reply, stats->bytes_in_use);
+    ecs_strbuf_list_appendlit(reply, "\"bytes_reserved\":");
+    ecs_strbuf_appendint(reply, stats->bytes_reserved);
+    ecs_strbuf_list_appendlit(reply, "\"chunk_count\":");
+    ecs_strbuf_appendint(reply, stats->chunk_count);
+    ecs_strbuf_list_appendlit(reply, "\"block_count\":");
+    ecs_strbuf_appendint(reply, stats->block_count);
+
+    ecs_strbuf_list_appendlit(reply, "\"sizes\":");
+    ecs_strbuf_list_push(reply, "[", ",");
+    int32_t i, count = ecs_vec_count(&stats->sizes);
+    ecs_allocator_size_stats_t *sizes = ecs_vec_first(&stats->sizes);
+    for (i = 0; i < count; i ++) {
+        ecs_allocator_size_stats_t *elem = &sizes[i];
+        ecs_strbuf_list_next(reply);
+        ecs_strbuf_list_push(reply, "{", ",");
+        ecs_strbuf_list_appendlit(reply, "\"size\":");
+        ecs_strbuf_appendint(reply, elem->size);
+        ecs_strbuf_list_appendlit(reply, "\"allocator_count\":");
+        ecs_strbuf_appendint(reply, elem->allocator_count);
+        ecs_strbuf_list_appendlit(reply, "\"block_count\":");
+        ecs_strbuf_appendint(reply, elem->block_count);
+        ecs_strbuf_list_appendlit(reply, "\"chunk_count\":");
+        ecs_strbuf_appendint(reply, elem->chunk_count);
+        ecs_strbuf_list_appendlit(reply, "\"chunk_count_max\":");
+        ecs_strbuf_appendint(reply, elem->chunk_count_max);
+        ecs_strbuf_list_appendlit(reply, "\"bytes_in_use\":");
+        ecs_strbuf_appendint(reply, elem->bytes_in_use);
+        ecs_strbuf_list_appendlit(reply, "\"bytes_reserved\":");
+        ecs_strbuf_appendint(reply, elem->bytes_reserved);
+        ecs_strbuf_list_pop(reply, "}");
+    }
+    ecs_strbuf_list_pop(reply, "]");
+    ecs_strbuf_list_pop(reply, "}");
+}
+
 static
 bool flecs_rest_reply_stats(
     ecs_world_t *world,
@@ -796,6 +843,13 @@ bool flecs_rest_reply_stats(
         flecs_pipeline_stats_to_json(world, &reply->body, stats);
         return true;
 
+    } else if (!ecs_os_strcmp(category, "allocators")) {
+        ecs_allocator_stats_t stats = {0};
+        ecs_allocator_stats_get(world, &stats);
+        flecs_allocator_stats_to_json(&reply->body, &stats);
+        ecs_allocator_stats_fini(&stats);
+        return true;
+
     } else {
         flecs_reply_error(reply, "bad request (unsupported category)");
         reply->code = 400;
@@ -34,7 +34,10 @@ const char* flecs_rule_op_str(
     case EcsRuleSelfUp:        return "selfup  ";
     case EcsRuleSelfUpId:      return "selfupid";
     case EcsRuleWith:          return "with    ";
+    case EcsRuleWithIds:       return "withids ";
+    case EcsRuleSelfUpWithIds: return "supwids ";
     case EcsRuleTrav:          return "trav    ";
+    case EcsRuleJoin:          return "join    ";
     case EcsRuleIds:           return "ids     ";
     case EcsRuleIdsRight:      return "idsr    ";
     case EcsRuleIdsLeft:       return "idsl    ";
@@ -90,11 +93,15 @@ static
 void flecs_rule_fini(
     ecs_rule_t *rule)
 {
+    flecs_rule_cache_fini(rule);
+
     if (rule->vars != &rule->vars_cache.var) {
         ecs_os_free(rule->vars);
     }
 
     ecs_os_free(rule->ops);
+    ecs_os_free(rule->plan_counts);
+    ecs_os_free(rule->profile);
     ecs_os_free(rule->src_vars);
     flecs_name_index_fini(&rule->tvar_index);
     flecs_name_index_fini(&rule->evar_index);
@@ -131,11 +138,18 @@ ecs_rule_t* ecs_rule_init(
 
     result->iterable.init = flecs_rule_iter_mixin_init;
 
+    /* Make sure table cache is up to date, as the plan uses table counts */
+    ecs_run_aperiodic(world, EcsAperiodicEmptyTables);
+
     /* Compile filter to operations */
     if (flecs_rule_compile(world, stage, result)) {
         goto error;
     }
 
+    if (result->filter.flags & EcsFilterCacheResults) {
+        flecs_rule_cache_init(world, result);
+    }
+
     ecs_entity_t entity = const_desc->entity;
     result->dtor = (ecs_poly_dtor_t)flecs_rule_fini;
 
@@ -198,9 +212,10 @@ int32_t flecs_rule_op_ref_str(
     return color_chars;
 }
 
-char* ecs_rule_str_w_profile(
+static
+char* flecs_rule_str(
     const ecs_rule_t *rule,
-    const ecs_iter_t *it)
+    const ecs_rule_op_profile_t *profile)
 {
     ecs_poly_assert(rule, ecs_rule_t);
 
@@ -215,14 +230,13 @@ char* ecs_rule_str_w_profile(
         ecs_flags16_t first_flags = flecs_rule_ref_flags(flags, EcsRuleFirst);
         ecs_flags16_t second_flags = flecs_rule_ref_flags(flags, EcsRuleSecond);
 
-        if (it) {
-#ifdef FLECS_DEBUG
-            const ecs_rule_iter_t *rit = &it->priv.iter.rule;
+        if (profile) {
             ecs_strbuf_append(&buf, 
-                "#[green]%4d -> #[red]%4d <- #[grey]  |   ",
-                rit->profile[i].count[0],
-                rit->profile[i].count[1]);
-#endif
+                "#[green]%4d -> #[red]%4d <- #[blue]%4d * #[grey]%8.2fus  |   ",
+                profile[i].count[0],
+                profile[i].count[1],
+                profile[i].match_count,
+                profile[i].time_spent * 1000.0 * 1000.0);
         }
 
         ecs_strbuf_append(&buf, 
@@ -310,10 +324,42 @@ char* ecs_rule_str_w_profile(
     return ecs_strbuf_get(&buf);
 }
 
+char* ecs_rule_str_w_profile(
+    const ecs_rule_t *rule,
+    const ecs_iter_t *it)
+{
+    ecs_poly_assert(rule, ecs_rule_t);
+    if (it) {
+        return flecs_rule_str(rule, it->priv.iter.rule.profile);
+    } else {
+        return flecs_rule_str(rule, rule->profile);
+    }
+}
+
 char* ecs_rule_str(
     const ecs_rule_t *rule)
 {
-    return ecs_rule_str_w_profile(rule, NULL);
+    return flecs_rule_str(rule, NULL);
+}
+
+ecs_rule_profile_t ecs_rule_get_profile(
+    const ecs_rule_t *rule)
+{
+    ecs_poly_assert(rule, ecs_rule_t);
+    return (ecs_rule_profile_t){
+        .ops = rule->profile,
+        .op_count = rule->profile ? rule->op_count : 0,
+        .iter_count = rule->profile_iter_count
+    };
+}
+
+void ecs_rule_reset_profile(
+    ecs_rule_t *rule)
+{
+    ecs_poly_assert(rule, ecs_rule_t);
+    ecs_os_free(rule->profile);
+    rule->profile = NULL;
+    rule->profile_iter_count = 0;
 }
 
 const ecs_filter_t* ecs_rule_get_filter(
@@ -0,0 +1,688 @@
+/**
+ * @file addons/rules/cache.c
+ * @brief Cache that stores the results of a rule.
+ *
+ * Rules created with EcsFilterCacheResults store their results, so that
+ * iterating the rule replays the stored results instead of evaluating the rule
+ * program. The cache is kept up to date with observers on the ids of the rule:
+ *
+ * - For rules for which the result only depends on the type of the $this
+ *   table, new tables are matched by evaluating the rule for just that table,
+ *   and deleted tables are removed from the cache.
+ * - Changes to entities that can be reached through traversal (like parents or
+ *   prefabs), or that are used as sources or variables by the rule invalidate
+ *   the cache, which causes it to be rederived on the next iteration.
+ *
+ * Results store entire tables, so adding entities to or removing entities from
+ * already matched tables does not invalidate the cache.
+ */
+
+#include "rules.h"
+
+#ifdef FLECS_RULES
+
+/* Kinds of events a rule cache observes for an id */
+#define EcsRuleCacheTableEvents  (1u << 0u) /* Table created/deleted */
+#define EcsRuleCacheEntityEvents (1u << 1u) /* Id added to/removed from entity */
+#define EcsRuleCacheTravEvents   (1u << 2u) /* Same, for traversable entities */
+#define EcsRuleCacheFillEvents   (1u << 3u) /* Table became non-empty */
+
+typedef struct {
+    ecs_id_t id;
+    ecs_flags32_t events;
+} ecs_rule_cache_observe_t;
+
+#define FLECS_RULE_CACHE_OBSERVE_MAX (FLECS_TERM_DESC_MAX * 4)
+
+typedef struct {
+    ecs_rule_cache_observe_t ids[FLECS_RULE_CACHE_OBSERVE_MAX];
+    int32_t count;
+} ecs_rule_cache_observe_list_t;
+
+static
+void flecs_rule_cache_observe(
+    ecs_rule_cache_observe_list_t *list,
+    ecs_id_t id,
+    ecs_flags32_t events)
+{
+    int32_t i;
+    for (i = 0; i < list->count; i ++) {
+        if (list->ids[i].id == id) {
+            list->ids[i].events |= events;
+            return;
+        }
+    }
+
+    ecs_assert(list->count < FLECS_RULE_CACHE_OBSERVE_MAX,
+        ECS_INTERNAL_ERROR, NULL);
+    list->ids[list->count].id = id;
+    list->ids[list->count].events = events;
+    list->count ++;
+}
+
+/* Find ids for which the cache needs to observe events. Returns false if the
+ * rule cannot be cached, in which case it is evaluated as a regular rule. */
+static
+bool flecs_rule_cache_find_ids(
+    ecs_world_t *world,
+    ecs_rule_t *rule,
+    ecs_rule_cache_observe_list_t *list,
+    bool *table_local_out)
+{
+    const ecs_filter_t *filter = &rule->filter;
+    ecs_flags32_t flags = filter->flags;
+    if (filter->term_count > FLECS_TERM_DESC_MAX) {
+        return false;
+    }
+
+    /* Results that depend on names or on sparse storage are not tracked */
+    if (flags & (EcsFilterHasPred|EcsFilterHasSparse)) {
+        return false;
+    }
+
+    bool table_local = !(flags & EcsFilterHasScopes);
+    bool has_match = false;
+    int32_t i, count = filter->term_count;
+
+    for (i = 0; i < count; i ++) {
+        ecs_term_t *term = &filter->terms[i];
+        ecs_entity_t first = term->first.id;
+        if (first == EcsScopeOpen || first == EcsScopeClose) {
+            continue;
+        }
+
+        ecs_oper_kind_t oper = term->oper;
+        if (oper == EcsAndFrom || oper == EcsOrFrom || oper == EcsNotFrom) {
+            return false;
+        }
+        if (oper == EcsAnd || oper == EcsOr) {
+            has_match = true;
+        }
+
+        /* Variables and the any wildcard can match any id */
+        ecs_id_t id = term->id;
+        if (ECS_IS_PAIR(id)) {
+            ecs_entity_t rel = ECS_PAIR_FIRST(id);
+            ecs_entity_t tgt = ECS_PAIR_SECOND(id);
+            if (rel == EcsAny || (term->first.flags & EcsIsVariable)) {
+                rel = EcsWildcard;
+            }
+            if (tgt == EcsAny || (term->second.flags & EcsIsVariable)) {
+                tgt = EcsWildcard;
+            }
+            if (rel != EcsWildcard) {
+                /* Union results are ranges within a table */
+                ecs_entity_t e = flecs_entities_get_alive(world, rel);
+                if (e && ecs_has_id(world, e, EcsUnion)) {
+                    return false;
+                }
+            }
+
+            /* For transitive relationships a target can match through the
+             * relationships of the target, which can be modified without
+             * creating or deleting tables. */
+            if (rel != EcsWildcard && ((term->flags & EcsTermTransitive) ||
+                (term->second.flags & EcsUp)))
+            {
+                flecs_rule_cache_observe(list, ecs_pair(rel, EcsWildcard),
+                    EcsRuleCacheTravEvents);
+            }
+
+            if ((term->second.flags & EcsIsVariable) &&
+                (term->second.id == EcsThis))
+            {
+                table_local = false;
+            }
+
+            id = ecs_pair(rel, tgt);
+        } else if (id == EcsWildcard || id == EcsAny ||
+            (term->first.flags & EcsIsVariable))
+        {
+            return false;
+        }
+
+        flecs_rule_cache_observe(list, id, EcsRuleCacheTableEvents);
+
+        if (!ecs_term_match_this(term) || (term->flags &
+            (EcsTermSrcFirstEq|EcsTermSrcSecondEq|EcsTermReflexive)))
+        {
+            table_local = false;
+        }
+
+        /* If an id is matched through traversal, the result depends on the
+         * entities that are traversed. */
+        ecs_entity_t trav = 0;
+        if (term->src.flags & EcsUp) {
+            trav = term->src.trav;
+        } else if (term->flags & EcsTermIdInherited) {
+            trav = EcsIsA;
+        }
+        if (trav) {
+            flecs_rule_cache_observe(list, id, EcsRuleCacheTravEvents);
+            flecs_rule_cache_observe(list, ecs_pair(trav, EcsWildcard),
+                EcsRuleCacheTableEvents|EcsRuleCacheTravEvents|
+                EcsRuleCacheFillEvents);
+        }
+    }
+
+    /* New tables are matched through the ids of terms that must match. Rules
+     * with only Not or Optional terms could match tables with any id. */
+    if (!has_match) {
+        return false;
+    }
+
+    /* If results don't only depend on the $this table, any change to an
+     * observed id can change the results. */
+    if (!table_local) {
+        for (i = 0; i < list->count; i ++) {
+            list->ids[i].events |= EcsRuleCacheEntityEvents;
+        }
+    }
+
+    *table_local_out = table_local;
+    return true;
+}
+
+/* Mark results for table as dead. Results are removed on the next update. */
+static
+void flecs_rule_cache_remove_table(
+    ecs_rule_cache_t *cache,
+    ecs_table_t *table)
+{
+    int32_t i, count = ecs_vec_count(&cache->results);
+    for (i = 0; i < count; i ++) {
+        ecs_rule_cache_elem_t *elem = ecs_vec_get(
+            &cache->results, cache->elem_size, i);
+        if (elem->table == table && !elem->entity) {
+            elem->dead = true;
+        }
+    }
+
+    if (ecs_map_is_init(&cache->pending)) {
+        ecs_map_remove(&cache->pending, table->id);
+    }
+}
+
+/* Evaluate rule for table on the next update */
+static
+void flecs_rule_cache_add_pending(
+    ecs_rule_cache_t *cache,
+    ecs_table_t *table)
+{
+    ecs_map_init_if(&cache->pending, NULL);
+    ecs_map_ensure_ref(&cache->pending, ecs_table_t, table->id)[0] = table;
+}
+
+static
+void flecs_rule_cache_on_table(
+    ecs_iter_t *it)
+{
+    ecs_rule_t *rule = it->ctx;
+    if (!rule) {
+        return;
+    }
+
+    ecs_rule_cache_t *cache = rule->cache;
+    ecs_table_t *table = it->table;
+
+    if (it->event == EcsOnTableCreate) {
+        if (!cache->table_local) {
+            cache->dirty = true;
+        } else if (!cache->dirty) {
+            flecs_rule_cache_add_pending(cache, table);
+        }
+    } else if (it->event == EcsOnTableDelete) {
+        flecs_rule_cache_remove_table(cache, table);
+        if (!cache->table_local) {
+            cache->dirty = true;
+        }
+    } else if (it->event == EcsOnTableFill) {
+        /* Traversal only finds tables that aren't empty, so reevaluate tables
+         * that were empty when results were last updated. */
+        if (!cache->table_local) {
+            cache->dirty = true;
+        } else if (!cache->dirty) {
+            flecs_rule_cache_remove_table(cache, table);
+            flecs_rule_cache_add_pending(cache, table);
+        }
+    }
+}
+
+static
+void flecs_rule_cache_on_entity(
+    ecs_iter_t *it)
+{
+    ecs_rule_t *rule = it->ctx;
+    if (rule) {
+        rule->cache->dirty = true;
+    }
+}
+
+static
+void flecs_rule_cache_on_trav(
+    ecs_iter_t *it)
+{
+    ecs_rule_t *rule = it->ctx;
+    if (!rule || rule->cache->dirty) {
+        return;
+    }
+
+    /* Only entities that are used as relationship target can change the
+     * results of other tables */
+    ecs_world_t *world = it->real_world;
+    int32_t i;
+    for (i = 0; i < it->count; i ++) {
+        if (flecs_id_record_get(world, ecs_pair(EcsWildcard, it->entities[i]))) {
+            rule->cache->dirty = true;
+            break;
+        }
+    }
+}
+
+static
+void flecs_rule_cache_observer_init(
+    ecs_world_t *world,
+    ecs_rule_t *rule,
+    ecs_id_t id,
+    ecs_iter_action_t callback,
+    ecs_entity_t event_1,
+    ecs_entity_t event_2)
+{
+    ecs_entity_t o = ecs_observer(world, {
+        .filter = {
+            .terms = {{
+                .id = id,
+                .src.flags = EcsSelf,
+                .inout = EcsInOutNone
+            }},
+            /* Prefabs and disabled entities can be matched by traversal */
+            .flags = EcsFilterNoData|EcsFilterMatchPrefab|
+                EcsFilterMatchDisabled
+        },
+        .events = { event_1, event_2 },
+        .callback = callback,
+        .ctx = rule
+    });
+
+    ecs_assert(o != 0, ECS_INTERNAL_ERROR, NULL);
+    ecs_vec_append_t(NULL, &rule->cache->observers, ecs_entity_t)[0] = o;
+}
+
+void flecs_rule_cache_init(
+    ecs_world_t *world,
+    ecs_rule_t *rule)
+{
+    ecs_rule_cache_observe_list_t list = {0};
+    bool table_local = false;
+    if (!flecs_rule_cache_find_ids(world, rule, &list, &table_local)) {
+        ecs_dbg_1("#[yellow]rule#[reset] results can't be cached");
+        return;
+    }
+
+    ecs_rule_cache_t *cache = rule->cache = ecs_os_calloc_t(ecs_rule_cache_t);
+    cache->table_local = table_local;
+    cache->dirty = true;
+
+    /* Result layout: header, ids, sources, variables, columns */
+    /* Anonymous variables can change when the rule is replanned, so only
+     * store public variables. The first variable ($this) is always stored as
+     * it contains the entity for results without a table. */
+    int32_t field_count = rule->filter.field_count;
+    int32_t var_count = rule->var_pub_count;
+    if (!var_count && rule->var_count) {
+        var_count = 1;
+    }
+    cache->var_count = var_count;
+
+    ecs_size_t size = ECS_SIZEOF(ecs_rule_cache_elem_t);
+    size += field_count * ECS_SIZEOF(ecs_id_t);
+    cache->sources_offset = size;
+    size += field_count * ECS_SIZEOF(ecs_entity_t);
+    cache->vars_offset = size;
+    size += var_count * ECS_SIZEOF(ecs_var_t);
+    cache->columns_offset = size;
+    size += field_count * ECS_SIZEOF(int32_t);
+    cache->elem_size = ECS_ALIGN(size, ECS_SIZEOF(void*));
+
+    ecs_vec_init(NULL, &cache->results, cache->elem_size, 0);
+    ecs_vec_init_t(NULL, &cache->observers, ecs_entity_t, 0);
+
+    int32_t i;
+    for (i = 0; i < list.count; i ++) {
+        ecs_id_t id = list.ids[i].id;
+        ecs_flags32_t events = list.ids[i].events;
+        if (events & EcsRuleCacheTableEvents) {
+            flecs_rule_cache_observer_init(world, rule, id,
+                flecs_rule_cache_on_table, EcsOnTableCreate, EcsOnTableDelete);
+        }
+        if (events & EcsRuleCacheFillEvents) {
+            flecs_rule_cache_observer_init(world, rule, id,
+                flecs_rule_cache_on_table, EcsOnTableFill, 0);
+        }
+        if (events & EcsRuleCacheEntityEvents) {
+            flecs_rule_cache_observer_init(world, rule, id,
+                flecs_rule_cache_on_entity, EcsOnAdd, EcsOnRemove);
+        } else if (events & EcsRuleCacheTravEvents) {
+            flecs_rule_cache_observer_init(world, rule, id,
+                flecs_rule_cache_on_trav, EcsOnAdd, EcsOnRemove);
+        }
+    }
+}
+
+void flecs_rule_cache_fini(
+    ecs_rule_t *rule)
+{
+    ecs_rule_cache_t *cache = rule->cache;
+    if (!cache) {
+        return;
+    }
+
+    ecs_world_t *world = rule->filter.world;
+    int32_t i, count = ecs_vec_count(&cache->observers);
+    ecs_entity_t *observers = ecs_vec_first(&cache->observers);
+    for (i = 0; i < count; i ++) {
+        ecs_entity_t o = observers[i];
+        if (!ecs_is_alive(world, o)) {
+            continue;
+        }
+
+        /* Observer could outlive the rule if the delete is deferred */
+        ecs_observer_t *poly = ecs_poly_get(world, o, ecs_observer_t);
+        if (poly) {
+            poly->ctx = NULL;
+        }
+        ecs_delete(world, o);
+    }
+
+    ecs_vec_fini_t(NULL, &cache->observers, ecs_entity_t);
+    ecs_vec_fini(NULL, &cache->results, cache->elem_size);
+    ecs_map_fini(&cache->pending);
+    ecs_os_free(cache);
+    rule->cache = NULL;
+}
+
+/* Store current result of iterator in cache */
+static
+bool flecs_rule_cache_append(
+    ecs_rule_cache_t *cache,
+    const ecs_iter_t *it)
+{
+    ecs_table_t *table = NULL;
+    ecs_entity_t entity = 0;
+    if (cache->var_count) {
+        const ecs_var_t *this_var = &it->priv.iter.rule.vars[0];
+        table = this_var->range.table;
+        entity = this_var->entity;
+        if (entity == EcsWildcard) {
+            entity = 0;
+        }
+    }
+
+    if (table && !entity) {
+        /* Only results for entire tables can be stored, as table ranges can
+         * change without creating or deleting tables. */
+        if (it->offset || (it->count != ecs_table_count(table))) {
+            return false;
+        }
+    }
+
+    ecs_rule_cache_elem_t *elem = ecs_vec_append(
+        NULL, &cache->results, cache->elem_size);
+    int32_t field_count = it->field_count;
+    elem->table = table;
+    elem->entity = entity;
+    elem->count = it->count;
+    elem->dead = false;
+
+    ecs_os_memcpy_n(ECS_OFFSET(elem, ECS_SIZEOF(ecs_rule_cache_elem_t)),
+        it->ids, ecs_id_t, field_count);
+    ecs_os_memcpy_n(ECS_OFFSET(elem, cache->sources_offset),
+        it->sources, ecs_entity_t, field_count);
+    ecs_os_memcpy_n(ECS_OFFSET(elem, cache->vars_offset),
+        it->priv.iter.rule.vars, ecs_var_t, cache->var_count);
+    ecs_os_memcpy_n(ECS_OFFSET(elem, cache->columns_offset),
+        it->columns, int32_t, field_count);
+    return true;
+}
+
+/* Evaluate rule and store the results. If table is set, only results for that
+ * table are evaluated. */
+static
+bool flecs_rule_cache_populate(
+    ecs_rule_t *rule,
+    ecs_table_t *table)
+{
+    ecs_rule_cache_t *cache = rule->cache;
+    ecs_world_t *world = rule->filter.world;
+    bool result = true;
+
+    /* Results are stored for empty tables so that tables becoming empty or
+     * non-empty don't invalidate the cache. Empty tables are skipped when the
+     * results are iterated. */
+    ecs_flags32_t filter_flags = rule->filter.flags;
+    rule->filter.flags |= EcsFilterMatchEmptyTables;
+    cache->updating = true;
+
+    ecs_iter_t it = ecs_rule_iter(world, rule);
+    ECS_BIT_SET(it.flags, EcsIterNoData);
+    if (table) {
+        ecs_iter_set_var_as_table(&it, 0, table);
+    }
+
+    while (ecs_rule_next_instanced(&it)) {
+        if (!flecs_rule_cache_append(cache, &it)) {
+            ecs_iter_fini(&it);
+            result = false;
+            break;
+        }
+    }
+
+    cache->updating = false;
+    rule->filter.flags = filter_flags;
+    return result;
+}
+
+bool flecs_rule_cache_update(
+    ecs_rule_t *rule)
+{
+    ecs_rule_cache_t *cache = rule->cache;
+    if (!cache || cache->updating) {
+        return false;
+    }
+
+    /* Results can't be modified while they are being iterated */
+    if (rule->iter_count || (rule->filter.world->flags & EcsWorldReadonly)) {
+        return !cache->dirty && !ecs_map_count(&cache->pending);
+    }
+
+    /* Make sure table fill events are delivered before results are updated */
+    flecs_process_pending_tables(rule->filter.world);
+
+    if (cache->dirty) {
+        ecs_vec_clear(&cache->results);
+        if (ecs_map_is_init(&cache->pending)) {
+            ecs_map_clear(&cache->pending);
+        }
+        if (!flecs_rule_cache_populate(rule, NULL)) {
+            goto disable;
+        }
+        cache->dirty = false;
+        return true;
+    }
+
+    /* Remove results for deleted tables */
+    int32_t i, count = ecs_vec_count(&cache->results);
+    ecs_size_t elem_size = cache->elem_size;
+    int32_t dst = 0;
+    for (i = 0; i < count; i ++) {
+        ecs_rule_cache_elem_t *elem = ecs_vec_get(
+            &cache->results, elem_size, i);
+        if (elem->dead) {
+            continue;
+        }
+        if (dst != i) {
+            ecs_os_memcpy(ecs_vec_get(&cache->results, elem_size, dst),
+                elem, elem_size);
+        }
+        dst ++;
+    }
+    ecs_vec_set_count(NULL, &cache->results, elem_size, dst);
+
+    /* Add results for tables created since the last update */
+    if (ecs_map_count(&cache->pending)) {
+        ecs_map_iter_t pit = ecs_map_iter(&cache->pending);
+        while (ecs_map_next(&pit)) {
+            ecs_table_t *table = ecs_map_ptr(&pit);
+            if (!flecs_rule_cache_populate(rule, table)) {
+                goto disable;
+            }
+        }
+        ecs_map_clear(&cache->pending);
+    }
+
+    return true;
+disable:
+    /* Rule produced results that can't be cached, evaluate it regularly */
+    ecs_dbg_1("#[yellow]rule#[reset] results can't be cached");
+    flecs_rule_cache_fini(rule);
+    return false;
+}
+
+bool flecs_rule_cache_next(
+    ecs_iter_t *it)
+{
+    ecs_rule_iter_t *rit = &it->priv.iter.rule;
+    const ecs_rule_t *rule = rit->rule;
+    ecs_rule_cache_t *cache = rule->cache;
+    ecs_world_t *world = it->real_world;
+    const ecs_filter_t *filter = &rule->filter;
+    int32_t field_count = filter->field_count;
+    int32_t i, var_count = cache->var_count;
+    bool match_empty = filter->flags & EcsFilterMatchEmptyTables;
+
+    if (!(it->flags & EcsIterIsValid)) {
+        rit->cache_index = 0;
+        flecs_iter_validate(it);
+    } else {
+        it->frame_offset += it->count;
+    }
+
+    int32_t count = ecs_vec_count(&cache->results);
+    while (rit->cache_index < count) {
+        ecs_rule_cache_elem_t *elem = ecs_vec_get(
+            &cache->results, cache->elem_size, rit->cache_index ++);
+        if (elem->dead) {
+            continue;
+        }
+
+        ecs_table_t *table = elem->table;
+        int32_t offset = 0, row_count = elem->count;
+        if (elem->entity) {
+            ecs_record_t *r = flecs_entities_get(world, elem->entity);
+            if (!r || !r->table) {
+                continue;
+            }
+            table = r->table;
+            offset = ECS_RECORD_TO_ROW(r->row);
+            row_count = 1;
+        } else if (table) {
+            row_count = ecs_table_count(table);
+            if (!row_count && !match_empty) {
+                continue;
+            }
+        }
+
+        ecs_os_memcpy_n(it->ids, ECS_OFFSET(elem,
+            ECS_SIZEOF(ecs_rule_cache_elem_t)), ecs_id_t, field_count);
+        ecs_os_memcpy_n(it->sources, ECS_OFFSET(elem, cache->sources_offset),
+            ecs_entity_t, field_count);
+        ecs_os_memcpy_n(rit->vars, ECS_OFFSET(elem, cache->vars_offset),
+            ecs_var_t, var_count);
+        ecs_os_memcpy_n(it->columns, ECS_OFFSET(elem, cache->columns_offset),
+            int32_t, field_count);
+
+        /* Entities may have moved to another table or row since the results
+         * were stored. */
+        for (i = 0; i < var_count; i ++) {
+            ecs_var_t *var = &rit->vars[i];
+            if (!var->range.table || !var->entity ||
+                var->entity == EcsWildcard)
+            {
+                continue;
+            }
+            ecs_record_t *r = flecs_entities_get(world, var->entity);
+            if (r && r->table) {
+                var->range.table = r->table;
+                var->range.offset = ECS_RECORD_TO_ROW(r->row);
+                var->range.count = 1;
+            }
+        }
+
+        it->table = table;
+        it->offset = offset;
+        it->count = row_count;
+        if (table) {
+            it->entities = ECS_ELEM_T(
+                table->data.entities.array, ecs_entity_t, offset);
+        } else if (row_count == 1 && var_count) {
+            it->entities = &rit->vars[0].entity;
+        } else {
+            it->entities = NULL;
+        }
+
+        if (it->flags & EcsIterNoData) {
+            return true;
+        }
+
+        ECS_BIT_CLEAR(it->flags, EcsIterHasShared);
+        ecs_flags64_t data_fields = filter->data_fields;
+        for (i = 0; i < field_count; i ++) {
+            it->ptrs[i] = NULL;
+            int32_t column = it->columns[i];
+            if (!column) {
+                continue;
+            }
+
+            ecs_entity_t src = it->sources[i];
+            if (!src) {
+                if (!(data_fields & (1llu << i))) {
+                    continue;
+                }
+                if (row_count && table->column_map) {
+                    int32_t storage_column = table->column_map[column - 1];
+                    if (storage_column != -1) {
+                        it->ptrs[i] = ECS_ELEM(
+                            table->data.columns[storage_column].data.array,
+                            it->sizes[i], offset);
+                    }
+                }
+                continue;
+            }
+
+            /* Source can have moved to another table, find column again */
+            ecs_record_t *r = flecs_entities_get(world, src);
+            if (!r || !r->table) {
+                continue;
+            }
+            const ecs_table_record_t *tr = flecs_table_record_get(
+                world, r->table, it->ids[i]);
+            if (!tr) {
+                continue;
+            }
+
+            it->columns[i] = tr->index + 1;
+            if ((data_fields & (1llu << i)) && tr->column != -1) {
+                it->ptrs[i] = ecs_vec_get(
+                    &r->table->data.columns[tr->column].data,
+                    it->sizes[i], ECS_RECORD_TO_ROW(r->row));
+                ECS_BIT_SET(it->flags, EcsIterHasShared);
+            }
+        }
+
+        return true;
+    }
+
+    return false;
+}
+
+#endif
@@ -1388,6 +1388,106 @@ bool flecs_rule_term_is_or(
     return (term->oper == EcsOr) || (!first_term && term[-1].oper == EcsOr);
 }
 
+/* Count the number of (R, *) pairs a join for relationship R has to index */
+static
+int64_t flecs_rule_join_build_count(
+    const ecs_world_t *world,
+    ecs_entity_t rel)
+{
+    ecs_id_record_t *idr = flecs_id_record_get(world, 
+        ecs_pair(rel, EcsWildcard));
+    if (!idr) {
+        return 0;
+    }
+
+    int64_t count = 0;
+    ecs_table_cache_iter_t it;
+    if (flecs_table_cache_iter(&idr->cache, &it)) {
+        const ecs_table_record_t *tr;
+        while ((tr = flecs_table_cache_next(&it, ecs_table_record_t))) {
+            count += ecs_table_count(tr->hdr.table) * tr->count;
+        }
+    }
+
+    return count;
+}
+
+/* Check if term should be evaluated with a join. Terms like (R, $t) with an 
+ * unknown source and known target are normally evaluated by looking up the 
+ * tables for (R, t) each time the term is evaluated. When the term is expected
+ * to be evaluated many times, it is cheaper to index all (R, *) pairs once,
+ * after which each evaluation is a single lookup. */
+static
+bool flecs_rule_term_use_join(
+    ecs_world_t *world,
+    ecs_rule_t *rule,
+    ecs_term_t *term,
+    ecs_rule_op_t *op,
+    ecs_rule_compile_ctx_t *ctx,
+    bool src_written,
+    bool second_written)
+{
+    if (op->kind != EcsRuleAnd || term->oper != EcsAnd) {
+        return false;
+    }
+
+    if (flecs_rule_term_is_or(&rule->filter, term) || ctx->cond_written) {
+        return false;
+    }
+
+    if (term->flags & (EcsTermIdInherited|EcsTermTransitive|
+        EcsTermMatchAny|EcsTermMatchAnySrc)) 
+    {
+        return false;
+    }
+
+    /* Relationship must be known, target must be a written variable */
+    if (!(term->first.flags & EcsIsEntity) || !second_written) {
+        return false;
+    }
+
+    if (flecs_term_id_is_wildcard(&term->src) || 
+        flecs_term_id_is_wildcard(&term->second)) 
+    {
+        return false;
+    }
+
+    const char *src_name = flecs_term_id_var_name(&term->src);
+    const char *second_name = flecs_term_id_var_name(&term->second);
+    if (!src_name || !second_name || src_written) {
+        return false;
+    }
+
+    /* Join yields entities, which doesn't work for the $this table variable */
+    if (term->src.id == EcsThis || !ecs_os_strcmp(src_name, second_name)) {
+        return false;
+    }
+
+    ecs_var_id_t evar = flecs_rule_find_var_id(rule, src_name, EcsVarEntity);
+    if (evar == EcsVarNone || rule->vars[evar].lookup) {
+        return false;
+    }
+
+    if (flecs_rule_is_written(evar, ctx->written)) {
+        return false;
+    }
+
+    if (ctx->est_count < EcsRuleJoinMinProbes) {
+        return false;
+    }
+
+    int64_t build_count = flecs_rule_join_build_count(world, term->first.id);
+    if (!build_count || 
+        (build_count > (ctx->est_count * EcsRuleJoinBuildFactor))) 
+    {
+        return false;
+    }
+
+    op->kind = EcsRuleJoin;
+    op->src.var = evar;
+    return true;
+}
+
 static
 int flecs_rule_compile_term(
     ecs_world_t *world,
@@ -1620,6 +1720,14 @@ int flecs_rule_compile_term(
         }
     }
 
+    /* If the term is expected to be evaluated many times for different values
+     * of its target, replace searching for the source with a join. */
+    if (flecs_rule_term_use_join(world, rule, term, &op, ctx, 
+        src_written, second_written))
+    {
+        src_var = op.src.var;
+    }
+
     /* Check if this term has variables that have been conditionally written,
      * like variables written by an optional term. */
     if (ctx->cond_written) {
@@ -1874,6 +1982,216 @@ int32_t flecs_rule_term_next_known(
     return -1;
 }
 
+/* Returns whether term can be evaluated in a different order than specified */
+static
+bool flecs_rule_term_can_reorder(
+    ecs_rule_t *rule,
+    ecs_term_t *term)
+{
+    if (term->oper != EcsAnd || flecs_rule_term_is_or(&rule->filter, term)) {
+        return false;
+    }
+
+    if (flecs_rule_is_builtin_pred(term)) {
+        return false;
+    }
+
+    /* Whether $this is a table or entity variable depends on whether it's
+     * first used as source or as (pair) id, so don't move terms that use it
+     * as id or that could change its first use. */
+    if (!rule->has_table_this) {
+        return false;
+    }
+    if (term->first.id == EcsThis && (term->first.flags & EcsIsVariable)) {
+        return false;
+    }
+    if (term->second.id == EcsThis && (term->second.flags & EcsIsVariable)) {
+        return false;
+    }
+
+    return true;
+}
+
+/* Get number of non-empty tables for id. Used to detect whether cardinalities
+ * changed since a rule was planned. */
+static
+int32_t flecs_rule_plan_table_count(
+    const ecs_world_t *world,
+    ecs_id_t id)
+{
+    ecs_id_record_t *idr = flecs_id_record_get(world, id);
+    if (!idr) {
+        return 0;
+    }
+    return idr->cache.tables.count;
+}
+
+/* Estimate the number of results a term yields given the variables that have
+ * been written so far. Terms for which all variables are known only filter
+ * results and have no cost. For terms that find a source the cost is the 
+ * number of matching tables (for table variables) or entities (for entity 
+ * variables). Unknown variables in the id multiply the cost by the average 
+ * number of times the id occurs in a matching table. */
+static
+int64_t flecs_rule_term_cost(
+    ecs_world_t *world,
+    ecs_rule_t *rule,
+    ecs_term_t *term,
+    ecs_rule_compile_ctx_t *ctx)
+{
+    ecs_rule_op_t dummy = {0};
+    flecs_rule_compile_term_id(NULL, rule, &dummy, &term->first, 
+        &dummy.first, EcsRuleFirst, EcsVarEntity, ctx, false);
+    flecs_rule_compile_term_id(NULL, rule, &dummy, &term->second, 
+        &dummy.second, EcsRuleSecond, EcsVarEntity, ctx, false);
+    flecs_rule_compile_term_id(NULL, rule, &dummy, &term->src, 
+        &dummy.src, EcsRuleSrc, EcsVarAny, ctx, false);
+
+    bool src_unknown = (dummy.flags & (EcsRuleIsVar << EcsRuleSrc)) &&
+        flecs_rule_var_is_unknown(rule, dummy.src.var, ctx);
+    bool id_unknown = 
+        ((dummy.flags & (EcsRuleIsVar << EcsRuleFirst)) &&
+            flecs_rule_var_is_unknown(rule, dummy.first.var, ctx)) ||
+        ((dummy.flags & (EcsRuleIsVar << EcsRuleSecond)) &&
+            flecs_rule_var_is_unknown(rule, dummy.second.var, ctx));
+
+    if (!src_unknown && !id_unknown) {
+        return 0;
+    }
+
+    ecs_id_record_t *idr = flecs_id_record_get(world, term->id);
+    if (!idr) {
+        /* Nothing matches the term, evaluating it first ends search early */
+        return 0;
+    }
+
+    int64_t table_count = 0, entity_count = 0, id_count = 0;
+    ecs_table_cache_iter_t it;
+    if (flecs_table_cache_iter(&idr->cache, &it)) {
+        const ecs_table_record_t *tr;
+        while ((tr = flecs_table_cache_next(&it, ecs_table_record_t))) {
+            table_count ++;
+            entity_count += ecs_table_count(tr->hdr.table);
+            id_count += tr->count;
+        }
+    }
+
+    if (!table_count) {
+        return 0;
+    }
+
+    int64_t fanout = 1;
+    if (id_unknown) {
+        fanout = (id_count + table_count - 1) / table_count;
+    }
+
+    if (!src_unknown) {
+        return fanout;
+    }
+
+    if (rule->vars[dummy.src.var].kind == EcsVarTable) {
+        return table_count * fanout;
+    } else {
+        return entity_count * fanout;
+    }
+}
+
+/* Find the term to compile next. Starts from the term picked by the default 
+ * order, which evaluates terms in the order they were specified, but prefers 
+ * known over unknown terms. If another term that can be evaluated at this 
+ * point is significantly cheaper given the current cardinalities in the 
+ * world, it is evaluated first. */
+static
+int32_t flecs_rule_term_next(
+    ecs_world_t *world,
+    ecs_rule_t *rule, 
+    ecs_rule_compile_ctx_t *ctx,
+    int32_t offset,
+    ecs_flags64_t compiled)
+{
+    ecs_filter_t *filter = &rule->filter;
+    ecs_term_t *terms = filter->terms;
+    int32_t i, count = filter->term_count;
+    int32_t next = offset;
+
+    /* If variables have been written, but this term has no known variables,
+     * first try to resolve terms that have known variables. This can 
+     * significantly reduce the search space. 
+     * Only perform this optimization after at least one variable has been
+     * written to, as all terms are unknown otherwise. */
+    if (ctx->written && flecs_rule_term_is_unknown(rule, &terms[offset], ctx)) {
+        int32_t term_index = flecs_rule_term_next_known(
+            rule, ctx, offset + 1, compiled);
+        if (term_index != -1) {
+            next = term_index;
+        }
+    }
+
+    if (!flecs_rule_term_can_reorder(rule, &terms[next])) {
+        return next;
+    }
+
+    int64_t next_cost = flecs_rule_term_cost(world, rule, &terms[next], ctx);
+    int32_t candidates = 0;
+
+    for (i = offset; i < count; i ++) {
+        ecs_term_t *term = &terms[i];
+        if (compiled & (1ull << i)) {
+            continue;
+        }
+
+        /* Don't reorder terms before/after scopes */
+        if (term->first.id == EcsScopeOpen || term->first.id == EcsScopeClose) {
+            break;
+        }
+
+        if (!flecs_rule_term_can_reorder(rule, term)) {
+            continue;
+        }
+
+        candidates ++;
+        if (i == next) {
+            continue;
+        }
+
+        int64_t cost = flecs_rule_term_cost(world, rule, term, ctx);
+        if ((cost * EcsRulePlanCostFactor) < next_cost && 
+            (next_cost - cost) > EcsRulePlanCostMin) 
+        {
+            next = i;
+            next_cost = cost;
+        }
+    }
+
+    /* Store cardinalities of terms that were considered for the plan, so that
+     * the rule can be replanned if they change significantly. */
+    if (candidates > 1) {
+        if (!rule->plan_counts) {
+            rule->plan_counts = ecs_os_malloc_n(int32_t, count);
+            for (i = 0; i < count; i ++) {
+                rule->plan_counts[i] = -1;
+            }
+        }
+
+        for (i = offset; i < count; i ++) {
+            ecs_term_t *term = &terms[i];
+            if (term->first.id == EcsScopeOpen || 
+                term->first.id == EcsScopeClose) 
+            {
+                break;
+            }
+            if (!(compiled & (1ull << i)) && 
+                flecs_rule_term_can_reorder(rule, term)) 
+            {
+                rule->plan_counts[i] = 
+                    flecs_rule_plan_table_count(world, term->id);
+            }
+        }
+    }
+
+    return next;
+}
+
 /* If the first part of a query contains more than one trivial term, insert a
  * special instruction which batch-evaluates multiple terms. */
 static
@@ -2005,7 +2323,104 @@ void flecs_rule_insert_populate(
     }
 }
 
-int flecs_rule_compile(
+/* Check if instruction tests a fixed id against an already written $this, in
+ * which case it yields at most one result and can be fused with others. */
+static
+bool flecs_rule_op_is_with_id(
+    const ecs_rule_op_t *op,
+    ecs_write_flags_t written)
+{
+    if (op->kind != EcsRuleAndId && op->kind != EcsRuleSelfUpId) {
+        return false;
+    }
+    if (!(op->flags & (EcsRuleIsVar << EcsRuleSrc)) || op->src.var != 0) {
+        return false;
+    }
+    if (!(written & 1) || (op->written & ~written)) {
+        return false;
+    }
+    return op->field_index != -1;
+}
+
+/* Check if instruction is a jump target for anything other than its direct
+ * neighbours. Instructions that are fused into another instruction are never
+ * evaluated by the straight-line program, so they can't be jumped into. */
+static
+bool flecs_rule_op_is_jump_target(
+    const ecs_rule_t *rule,
+    ecs_rule_lbl_t lbl)
+{
+    int32_t i, count = rule->op_count;
+    for (i = 0; i < count; i ++) {
+        const ecs_rule_op_t *op = &rule->ops[i];
+        if (op->prev == lbl && i != (lbl + 1)) {
+            return true;
+        }
+        if (op->next == lbl && i != (lbl - 1)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/* Replace sequences of instructions that test fixed ids against an already
+ * written $this table with a single instruction, which evaluates the entire
+ * sequence in one dispatch. The fused instructions stay in the program as
+ * operands of the first instruction, which jumps over them. */
+static
+void flecs_rule_fuse_ops(
+    ecs_rule_t *rule)
+{
+    ecs_rule_op_t *ops = rule->ops;
+    int32_t i, count = rule->op_count;
+    ecs_write_flags_t written = 0;
+
+    for (i = 0; i < count; i ++) {
+        ecs_rule_op_t *op = &ops[i];
+
+        /* Only fuse instructions in the straight-line part of the program */
+        if (op->prev != (i - 1) || op->next != (i + 1)) {
+            break;
+        }
+
+        if (flecs_rule_op_is_with_id(op, written)) {
+            int32_t end = i + 1;
+            for (; end < count; end ++) {
+                ecs_rule_op_t *cur = &ops[end];
+                if (cur->kind != op->kind) {
+                    break;
+                }
+                if (!flecs_rule_op_is_with_id(cur, written)) {
+                    break;
+                }
+                if (cur->prev != (end - 1) || cur->next != (end + 1)) {
+                    break;
+                }
+                if (flecs_rule_op_is_jump_target(rule, flecs_itolbl(end))) {
+                    break;
+                }
+            }
+
+            if ((end - i) >= 2 && end < count) {
+                if (op->kind == EcsRuleAndId) {
+                    op->kind = EcsRuleWithIds;
+                } else {
+                    op->kind = EcsRuleSelfUpWithIds;
+                }
+                op->other = flecs_itolbl(end - i);
+                op->next = flecs_itolbl(end);
+                ops[end].prev = flecs_itolbl(i);
+                i = end - 1;
+                continue;
+            }
+        }
+
+        written |= op->written;
+    }
+}
+
+static
+int flecs_rule_compile_ops(
     ecs_world_t *world,
     ecs_stage_t *stage,
     ecs_rule_t *rule)
@@ -2013,6 +2428,7 @@ int flecs_rule_compile(
     ecs_filter_t *filter = &rule->filter;
     ecs_term_t *terms = filter->terms;
     ecs_rule_compile_ctx_t ctx = {0};
+    ctx.est_count = 1;
     ecs_vec_reset_t(NULL, &stage->operations, ecs_rule_op_t);
     ctx.ops = &stage->operations;
     ctx.cur = ctx.ctrlflow;
@@ -2020,11 +2436,6 @@ int flecs_rule_compile(
     ctx.cur->lbl_begin = -1;
     ecs_vec_clear(ctx.ops);
 
-    /* Find all variables defined in query */
-    if (flecs_rule_discover_vars(stage, rule)) {
-        return -1;
-    }
-
     /* If rule contains fixed source terms, insert operation to set sources */
     int32_t i, term_count = filter->term_count;
     for (i = 0; i < term_count; i ++) {
@@ -2055,8 +2466,18 @@ int flecs_rule_compile(
     /* Insert trivial term search if query allows for it */
     int32_t trivial_terms = flecs_rule_insert_trivial_search(rule, &ctx);
 
-    /* Compile remaining query terms to instructions */
+    /* Sparse terms are not stored in tables, and are evaluated by the iterator
+     * after the rule has yielded a result. */
     ecs_flags64_t compiled = 0;
+    if (filter->flags & EcsFilterHasSparse) {
+        for (i = 0; i < term_count; i ++) {
+            if (terms[i].flags & EcsTermIsSparse) {
+                compiled |= (1ull << i);
+            }
+        }
+    }
+
+    /* Compile remaining query terms to instructions */
     for (i = trivial_terms; i < term_count; i ++) {
         ecs_term_t *term = &terms[i];
         int32_t compile = i;
@@ -2065,32 +2486,35 @@ int flecs_rule_compile(
             continue; /* Already compiled */
         }
 
-        bool can_reorder = true;
-        if (term->oper != EcsAnd || flecs_rule_term_is_or(&rule->filter, term)){
-            can_reorder = false;
-        }
-
-        /* If variables have been written, but this term has no known variables,
-         * first try to resolve terms that have known variables. This can 
-         * significantly reduce the search space. 
-         * Only perform this optimization after at least one variable has been
-         * written to, as all terms are unknown otherwise. */
-        if (can_reorder && ctx.written && 
-            flecs_rule_term_is_unknown(rule, term, &ctx)) 
-        {
-            int32_t term_index = flecs_rule_term_next_known(
-                rule, &ctx, i + 1, compiled);
-            if (term_index != -1) {
-                term = &rule->filter.terms[term_index];
-                compile = term_index;
+        int64_t cost = -1;
+        if (term->oper == EcsAnd && !flecs_rule_term_is_or(filter, term)) {
+            compile = flecs_rule_term_next(world, rule, &ctx, i, compiled);
+            if (compile != i) {
+                term = &terms[compile];
                 i --; /* Repeat current term */
             }
+            cost = flecs_rule_term_cost(world, rule, term, &ctx);
         }
 
         if (flecs_rule_compile_term(world, rule, term, &ctx)) {
             return -1;
         }
 
+        /* Keep track of how many results the compiled terms are expected to
+         * yield, which is used to decide whether to use a join. */
+        if (cost > 1) {
+            if (ctx.est_count > (INT32_MAX / cost)) {
+                ctx.est_count = INT32_MAX;
+            } else {
+                ctx.est_count *= cost;
+            }
+        } else if (!cost && !(term->flags & EcsTermIdInherited)) {
+            ecs_id_record_t *idr = flecs_id_record_get(world, term->id);
+            if (!idr || !flecs_table_cache_count(&idr->cache)) {
+                ctx.est_count = 0; /* Term doesn't match anything (yet) */
+            }
+        }
+
         compiled |= (1ull << compile);
     }
 
@@ -2199,9 +2623,74 @@ int flecs_rule_compile(
         rule->ops = ecs_os_malloc_n(ecs_rule_op_t, op_count);
         ecs_rule_op_t *rule_ops = ecs_vec_first_t(ctx.ops, ecs_rule_op_t);
         ecs_os_memcpy_n(rule->ops, rule_ops, ecs_rule_op_t, op_count);
+        flecs_rule_fuse_ops(rule);
     }
 
     return 0;
 }
 
+int flecs_rule_compile(
+    ecs_world_t *world,
+    ecs_stage_t *stage,
+    ecs_rule_t *rule)
+{
+    /* Find all variables defined in query */
+    if (flecs_rule_discover_vars(stage, rule)) {
+        return -1;
+    }
+
+    /* Compiling operations may add anonymous variables */
+    rule->var_discover_count = rule->var_count;
+
+    return flecs_rule_compile_ops(world, stage, rule);
+}
+
+bool flecs_rule_plan_is_stale(
+    const ecs_world_t *world,
+    const ecs_rule_t *rule)
+{
+    const int32_t *plan_counts = rule->plan_counts;
+    if (!plan_counts) {
+        return false;
+    }
+
+    const ecs_term_t *terms = rule->filter.terms;
+    int32_t i, count = rule->filter.term_count;
+    for (i = 0; i < count; i ++) {
+        int32_t prev = plan_counts[i];
+        if (prev == -1) {
+            continue;
+        }
+
+        int32_t cur = flecs_rule_plan_table_count(world, terms[i].id);
+        int32_t min = ECS_MIN(prev, cur), max = ECS_MAX(prev, cur);
+        if (max > (min * EcsRulePlanDriftFactor) && 
+            (max - min) > EcsRulePlanDriftMin) 
+        {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+int flecs_rule_replan(
+    ecs_world_t *world,
+    ecs_stage_t *stage,
+    ecs_rule_t *rule)
+{
+    ecs_assert(!rule->iter_count, ECS_INVALID_OPERATION,
+        "cannot replan rule while it is being iterated");
+
+    ecs_rule_reset_profile(rule);
+    ecs_os_free(rule->ops);
+    ecs_os_free(rule->plan_counts);
+    rule->ops = NULL;
+    rule->op_count = 0;
+    rule->plan_counts = NULL;
+    rule->var_count = rule->var_discover_count;
+
+    return flecs_rule_compile_ops(world, stage, rule);
+}
+
 #endif
@@ -548,6 +548,140 @@ bool flecs_rule_and(
     }
 }
 
+static
+void flecs_rule_join_build(
+    const ecs_rule_op_t *op,
+    const ecs_rule_run_ctx_t *ctx,
+    ecs_rule_join_ctx_t *op_ctx)
+{
+    ecs_world_t *world = ctx->world;
+    ecs_allocator_t *a = flecs_rule_get_allocator(ctx->it);
+    ecs_map_init(&op_ctx->index, a);
+    ecs_vec_init_t(a, &op_ctx->sources, ecs_entity_t, 0);
+    op_ctx->built = true;
+
+    ecs_id_record_t *idr = flecs_id_record_get(world, 
+        ecs_pair(op->first.entity, EcsWildcard));
+    if (!idr) {
+        return;
+    }
+
+    /* First pass: count number of sources per target */
+    ecs_table_cache_iter_t it;
+    const ecs_table_record_t *tr;
+    int32_t total = 0;
+    if (flecs_table_cache_iter(&idr->cache, &it)) {
+        while ((tr = flecs_table_cache_next(&it, ecs_table_record_t))) {
+            ecs_table_t *table = tr->hdr.table;
+            int32_t count = ecs_table_count(table);
+            ecs_id_t *ids = table->type.array;
+            int32_t i, end = tr->index + tr->count;
+            for (i = tr->index; i < end; i ++) {
+                ecs_map_key_t tgt = ECS_PAIR_SECOND(ids[i]);
+                ecs_map_ensure(&op_ctx->index, tgt)[0] += 
+                    flecs_ito(uint64_t, count);
+            }
+            total += count * tr->count;
+        }
+    }
+
+    /* Convert counts to offsets in sources vector */
+    ecs_map_iter_t mit = ecs_map_iter(&op_ctx->index);
+    uint64_t offset = 0;
+    while (ecs_map_next(&mit)) {
+        uint64_t count = ecs_map_value(&mit);
+        ecs_map_value(&mit) = offset << 32;
+        offset += count;
+    }
+
+    /* Second pass: store sources, grouped by target. The lower 32 bits of the
+     * index value are used as insertion cursor, and contain the number of 
+     * sources for the target after all sources have been inserted. */
+    ecs_vec_set_count_t(a, &op_ctx->sources, ecs_entity_t, total);
+    ecs_entity_t *sources = ecs_vec_first_t(&op_ctx->sources, ecs_entity_t);
+    if (flecs_table_cache_iter(&idr->cache, &it)) {
+        while ((tr = flecs_table_cache_next(&it, ecs_table_record_t))) {
+            ecs_table_t *table = tr->hdr.table;
+            int32_t row, count = ecs_table_count(table);
+            ecs_entity_t *entities = table->data.entities.array;
+            ecs_id_t *ids = table->type.array;
+            int32_t i, end = tr->index + tr->count;
+            for (i = tr->index; i < end; i ++) {
+                ecs_map_val_t *val = ecs_map_get(
+                    &op_ctx->index, ECS_PAIR_SECOND(ids[i]));
+                ecs_assert(val != NULL, ECS_INTERNAL_ERROR, NULL);
+                uint64_t cur = (val[0] >> 32) + (val[0] & 0xFFFFFFFF);
+                for (row = 0; row < count; row ++) {
+                    sources[cur + flecs_ito(uint64_t, row)] = entities[row];
+                }
+                val[0] += flecs_ito(uint64_t, count);
+            }
+        }
+    }
+}
+
+static
+bool flecs_rule_join(
+    const ecs_rule_op_t *op,
+    bool redo,
+    const ecs_rule_run_ctx_t *ctx)
+{
+    ecs_rule_join_ctx_t *op_ctx = flecs_op_ctx(ctx, join);
+
+    if (!redo) {
+        if (!op_ctx->built) {
+            flecs_rule_join_build(op, ctx, op_ctx);
+        }
+
+        ecs_entity_t tgt = flecs_rule_var_get_entity(op->second.var, ctx);
+        ecs_map_val_t *val = ecs_map_get(&op_ctx->index, (uint32_t)tgt);
+        if (!val) {
+            return false;
+        }
+
+        ecs_id_t id = ecs_pair(op->first.entity, tgt);
+        op_ctx->idr = flecs_id_record_get(ctx->world, id);
+        if (!op_ctx->idr) {
+            return false;
+        }
+
+        op_ctx->cur = flecs_uto(int32_t, val[0] >> 32);
+        op_ctx->end = op_ctx->cur + flecs_uto(int32_t, val[0] & 0xFFFFFFFF);
+    }
+
+    ecs_entity_t *sources = ecs_vec_first_t(&op_ctx->sources, ecs_entity_t);
+    while (op_ctx->cur < op_ctx->end) {
+        ecs_entity_t e = sources[op_ctx->cur ++];
+
+        /* Exclude entities that are used as markers by rule engine */
+        if ((e == EcsWildcard) || (e == EcsAny) || 
+            (e == EcsThis) || (e == EcsVariable)) 
+        {
+            continue;
+        }
+
+        ecs_record_t *r = flecs_entities_get(ctx->world, e);
+        if (!r || !r->table) {
+            continue;
+        }
+
+        /* Get column from the current table of the entity, so that the result
+         * stays valid if entities were moved since the index was built. */
+        ecs_table_t *table = r->table;
+        const ecs_table_record_t *tr = flecs_id_record_get_table(
+            op_ctx->idr, table);
+        if (!tr) {
+            continue;
+        }
+
+        flecs_rule_var_set_entity(op, op->src.var, e, ctx);
+        flecs_rule_set_match(op, table, tr->index, ctx);
+        return true;
+    }
+
+    return false;
+}
+
 static
 bool flecs_rule_select_id(
     const ecs_rule_op_t *op,
@@ -599,25 +733,16 @@ repeat: {}
 }
 
 static
-bool flecs_rule_with_id(
+bool flecs_rule_with_id_table(
     const ecs_rule_op_t *op,
-    bool redo,
+    ecs_rule_and_ctx_t *op_ctx,
+    ecs_table_t *table,
     const ecs_rule_run_ctx_t *ctx)
 {
-    if (redo) {
-        return false;
-    }
-
-    ecs_rule_and_ctx_t *op_ctx = flecs_op_ctx(ctx, and);
     ecs_iter_t *it = ctx->it;
     int8_t field = op->field_index;
     ecs_assert(field != -1, ECS_INTERNAL_ERROR, NULL);
 
-    ecs_table_t *table = flecs_rule_get_table(op, &op->src, EcsRuleSrc, ctx);
-    if (!table) {
-        return false;
-    }
-
     ecs_id_t id = it->ids[field];
     ecs_id_record_t *idr = op_ctx->idr;
     if (!idr || idr->id != id) {
@@ -636,6 +761,24 @@ bool flecs_rule_with_id(
     return true;
 }
 
+static
+bool flecs_rule_with_id(
+    const ecs_rule_op_t *op,
+    bool redo,
+    const ecs_rule_run_ctx_t *ctx)
+{
+    if (redo) {
+        return false;
+    }
+
+    ecs_table_t *table = flecs_rule_get_table(op, &op->src, EcsRuleSrc, ctx);
+    if (!table) {
+        return false;
+    }
+
+    return flecs_rule_with_id_table(op, flecs_op_ctx(ctx, and), table, ctx);
+}
+
 static
 bool flecs_rule_and_id(
     const ecs_rule_op_t *op,
@@ -651,6 +794,33 @@ bool flecs_rule_and_id(
     }
 }
 
+static
+bool flecs_rule_with_ids(
+    const ecs_rule_op_t *op,
+    bool redo,
+    const ecs_rule_run_ctx_t *ctx)
+{
+    if (redo) {
+        return false;
+    }
+
+    ecs_table_t *table = flecs_rule_get_table(op, &op->src, EcsRuleSrc, ctx);
+    if (!table) {
+        return false;
+    }
+
+    /* Fused instructions are stored directly after this instruction */
+    int32_t i, count = op->other;
+    ecs_rule_op_ctx_t *op_ctx = &ctx->op_ctx[ctx->op_index];
+    for (i = 0; i < count; i ++) {
+        if (!flecs_rule_with_id_table(&op[i], &op_ctx[i].is.and, table, ctx)) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
 static
 bool flecs_rule_up_select(
     const ecs_rule_op_t *op,
@@ -894,6 +1064,31 @@ bool flecs_rule_self_up_with(
     return false;
 }
 
+static
+bool flecs_rule_self_up_with_ids(
+    const ecs_rule_op_t *op,
+    bool redo,
+    ecs_rule_run_ctx_t *ctx)
+{
+    if (redo) {
+        return false;
+    }
+
+    /* Fused instructions are stored directly after this instruction. Each
+     * instruction uses its own context, so temporarily move the op index. */
+    ecs_rule_lbl_t op_index = ctx->op_index;
+    int32_t i, count = op->other;
+    bool result = true;
+    for (i = 0; i < count && result; i ++) {
+        ctx->op_index = flecs_itolbl(op_index + i);
+        ctx->written[ctx->op_index] = ctx->written[op_index];
+        result = flecs_rule_self_up_with(&op[i], false, ctx, true);
+    }
+
+    ctx->op_index = op_index;
+    return result;
+}
+
 static
 bool flecs_rule_up(
     const ecs_rule_op_t *op,
@@ -2406,59 +2601,152 @@ bool flecs_rule_populate_self(
     }
 }
 
+/* Use computed goto for dispatching instructions where it is supported. The
+ * address of each handler is looked up directly from the instruction kind,
+ * which avoids the range check of the switch statement. */
+#if defined(ECS_TARGET_GNU) && !defined(FLECS_NO_COMPUTED_GOTO)
+#define FLECS_RULE_COMPUTED_GOTO
+#endif
+
+#ifdef FLECS_RULE_COMPUTED_GOTO
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wpedantic"
+#define flecs_rule_case(kind) kind##_lbl: case kind
+#else
+#define flecs_rule_case(kind) case kind
+#endif
+
 static
 bool flecs_rule_dispatch(
     const ecs_rule_op_t *op,
     bool redo,
     ecs_rule_run_ctx_t *ctx)
 {
+#ifdef FLECS_RULE_COMPUTED_GOTO
+    static const void *handlers[] = {
+        [EcsRuleAnd] = &&EcsRuleAnd_lbl,
+        [EcsRuleAndId] = &&EcsRuleAndId_lbl,
+        [EcsRuleAndAny] = &&EcsRuleAndAny_lbl,
+        [EcsRuleTriv] = &&EcsRuleTriv_lbl,
+        [EcsRuleTrivData] = &&EcsRuleTrivData_lbl,
+        [EcsRuleTrivWildcard] = &&EcsRuleTrivWildcard_lbl,
+        [EcsRuleSelectAny] = &&EcsRuleSelectAny_lbl,
+        [EcsRuleUp] = &&EcsRuleUp_lbl,
+        [EcsRuleUpId] = &&EcsRuleUpId_lbl,
+        [EcsRuleSelfUp] = &&EcsRuleSelfUp_lbl,
+        [EcsRuleSelfUpId] = &&EcsRuleSelfUpId_lbl,
+        [EcsRuleWith] = &&EcsRuleWith_lbl,
+        [EcsRuleWithIds] = &&EcsRuleWithIds_lbl,
+        [EcsRuleSelfUpWithIds] = &&EcsRuleSelfUpWithIds_lbl,
+        [EcsRuleTrav] = &&EcsRuleTrav_lbl,
+        [EcsRuleJoin] = &&EcsRuleJoin_lbl,
+        [EcsRuleIds] = &&EcsRuleIds_lbl,
+        [EcsRuleIdsRight] = &&EcsRuleIdsRight_lbl,
+        [EcsRuleIdsLeft] = &&EcsRuleIdsLeft_lbl,
+        [EcsRuleEach] = &&EcsRuleEach_lbl,
+        [EcsRuleStore] = &&EcsRuleStore_lbl,
+        [EcsRuleReset] = &&EcsRuleReset_lbl,
+        [EcsRuleOr] = &&EcsRuleOr_lbl,
+        [EcsRuleOptional] = &&EcsRuleOptional_lbl,
+        [EcsRuleIf] = &&EcsRuleIf_lbl,
+        [EcsRuleEnd] = &&EcsRuleEnd_lbl,
+        [EcsRuleNot] = &&EcsRuleNot_lbl,
+        [EcsRulePredEq] = &&EcsRulePredEq_lbl,
+        [EcsRulePredNeq] = &&EcsRulePredNeq_lbl,
+        [EcsRulePredEqName] = &&EcsRulePredEqName_lbl,
+        [EcsRulePredNeqName] = &&EcsRulePredNeqName_lbl,
+        [EcsRulePredEqMatch] = &&EcsRulePredEqMatch_lbl,
+        [EcsRulePredNeqMatch] = &&EcsRulePredNeqMatch_lbl,
+        [EcsRuleLookup] = &&EcsRuleLookup_lbl,
+        [EcsRuleSetVars] = &&EcsRuleSetVars_lbl,
+        [EcsRuleSetThis] = &&EcsRuleSetThis_lbl,
+        [EcsRuleSetFixed] = &&EcsRuleSetFixed_lbl,
+        [EcsRuleSetIds] = &&EcsRuleSetIds_lbl,
+        [EcsRuleSetId] = &&EcsRuleSetId_lbl,
+        [EcsRuleContain] = &&EcsRuleContain_lbl,
+        [EcsRulePairEq] = &&EcsRulePairEq_lbl,
+        [EcsRulePopulate] = &&EcsRulePopulate_lbl,
+        [EcsRulePopulateSelf] = &&EcsRulePopulateSelf_lbl,
+        [EcsRuleYield] = &&EcsRuleYield_lbl,
+        [EcsRuleNothing] = &&EcsRuleNothing_lbl,
+    };
+
+    ecs_assert(op->kind <= EcsRuleNothing, ECS_INTERNAL_ERROR, NULL);
+    goto *handlers[op->kind];
+#endif
+
     switch(op->kind) {
-    case EcsRuleAnd: return flecs_rule_and(op, redo, ctx);
-    case EcsRuleAndId: return flecs_rule_and_id(op, redo, ctx);
-    case EcsRuleAndAny: return flecs_rule_and_any(op, redo, ctx);
-    case EcsRuleTriv: return flecs_rule_triv(op, redo, ctx);
-    case EcsRuleTrivData: return flecs_rule_triv_data(op, redo, ctx);
-    case EcsRuleTrivWildcard: return flecs_rule_triv_wildcard(op, redo, ctx);
-    case EcsRuleSelectAny: return flecs_rule_select_any(op, redo, ctx);
-    case EcsRuleUp: return flecs_rule_up(op, redo, ctx);
-    case EcsRuleUpId: return flecs_rule_up_id(op, redo, ctx);
-    case EcsRuleSelfUp: return flecs_rule_self_up(op, redo, ctx);
-    case EcsRuleSelfUpId: return flecs_rule_self_up_id(op, redo, ctx);
-    case EcsRuleWith: return flecs_rule_with(op, redo, ctx);
-    case EcsRuleTrav: return flecs_rule_trav(op, redo, ctx);
-    case EcsRuleIds: return flecs_rule_ids(op, redo, ctx);
-    case EcsRuleIdsRight: return flecs_rule_idsright(op, redo, ctx);
-    case EcsRuleIdsLeft: return flecs_rule_idsleft(op, redo, ctx);
-    case EcsRuleEach: return flecs_rule_each(op, redo, ctx);
-    case EcsRuleStore: return flecs_rule_store(op, redo, ctx);
-    case EcsRuleReset: return flecs_rule_reset(op, redo, ctx);
-    case EcsRuleOr: return flecs_rule_or(op, redo, ctx);
-    case EcsRuleOptional: return flecs_rule_optional(op, redo, ctx);
-    case EcsRuleIf: return flecs_rule_if(op, redo, ctx);
-    case EcsRuleEnd: return flecs_rule_end(op, redo, ctx);
-    case EcsRuleNot: return flecs_rule_not(op, redo, ctx);
-    case EcsRulePredEq: return flecs_rule_pred_eq(op, redo, ctx);
-    case EcsRulePredNeq: return flecs_rule_pred_neq(op, redo, ctx);
-    case EcsRulePredEqName: return flecs_rule_pred_eq_name(op, redo, ctx);
-    case EcsRulePredNeqName: return flecs_rule_pred_neq_name(op, redo, ctx);
-    case EcsRulePredEqMatch: return flecs_rule_pred_eq_match(op, redo, ctx);
-    case EcsRulePredNeqMatch: return flecs_rule_pred_neq_match(op, redo, ctx);
-    case EcsRuleLookup: return flecs_rule_lookup(op, redo, ctx);
-    case EcsRuleSetVars: return flecs_rule_setvars(op, redo, ctx);
-    case EcsRuleSetThis: return flecs_rule_setthis(op, redo, ctx);
-    case EcsRuleSetFixed: return flecs_rule_setfixed(op, redo, ctx);
-    case EcsRuleSetIds: return flecs_rule_setids(op, redo, ctx);
-    case EcsRuleSetId: return flecs_rule_setid(op, redo, ctx);
-    case EcsRuleContain: return flecs_rule_contain(op, redo, ctx);
-    case EcsRulePairEq: return flecs_rule_pair_eq(op, redo, ctx);
-    case EcsRulePopulate: return flecs_rule_populate(op, redo, ctx);
-    case EcsRulePopulateSelf: return flecs_rule_populate_self(op, redo, ctx);
-    case EcsRuleYield: return false;
-    case EcsRuleNothing: return false;
+    flecs_rule_case(EcsRuleAnd): return flecs_rule_and(op, redo, ctx);
+    flecs_rule_case(EcsRuleAndId): return flecs_rule_and_id(op, redo, ctx);
+    flecs_rule_case(EcsRuleAndAny): return flecs_rule_and_any(op, redo, ctx);
+    flecs_rule_case(EcsRuleTriv): return flecs_rule_triv(op, redo, ctx);
+    flecs_rule_case(EcsRuleTrivData): return flecs_rule_triv_data(op, redo, ctx);
+    flecs_rule_case(EcsRuleTrivWildcard): return flecs_rule_triv_wildcard(op, redo, ctx);
+    flecs_rule_case(EcsRuleSelectAny): return flecs_rule_select_any(op, redo, ctx);
+    flecs_rule_case(EcsRuleUp): return flecs_rule_up(op, redo, ctx);
+    flecs_rule_case(EcsRuleUpId): return flecs_rule_up_id(op, redo, ctx);
+    flecs_rule_case(EcsRuleSelfUp): return flecs_rule_self_up(op, redo, ctx);
+    flecs_rule_case(EcsRuleSelfUpId): return flecs_rule_self_up_id(op, redo, ctx);
+    flecs_rule_case(EcsRuleWith): return flecs_rule_with(op, redo, ctx);
+    flecs_rule_case(EcsRuleWithIds): return flecs_rule_with_ids(op, redo, ctx);
+    flecs_rule_case(EcsRuleSelfUpWithIds): return flecs_rule_self_up_with_ids(op, redo, ctx);
+    flecs_rule_case(EcsRuleTrav): return flecs_rule_trav(op, redo, ctx);
+    flecs_rule_case(EcsRuleJoin): return flecs_rule_join(op, redo, ctx);
+    flecs_rule_case(EcsRuleIds): return flecs_rule_ids(op, redo, ctx);
+    flecs_rule_case(EcsRuleIdsRight): return flecs_rule_idsright(op, redo, ctx);
+    flecs_rule_case(EcsRuleIdsLeft): return flecs_rule_idsleft(op, redo, ctx);
+    flecs_rule_case(EcsRuleEach): return flecs_rule_each(op, redo, ctx);
+    flecs_rule_case(EcsRuleStore): return flecs_rule_store(op, redo, ctx);
+    flecs_rule_case(EcsRuleReset): return flecs_rule_reset(op, redo, ctx);
+    flecs_rule_case(EcsRuleOr): return flecs_rule_or(op, redo, ctx);
+    flecs_rule_case(EcsRuleOptional): return flecs_rule_optional(op, redo, ctx);
+    flecs_rule_case(EcsRuleIf): return flecs_rule_if(op, redo, ctx);
+    flecs_rule_case(EcsRuleEnd): return flecs_rule_end(op, redo, ctx);
+    flecs_rule_case(EcsRuleNot): return flecs_rule_not(op, redo, ctx);
+    flecs_rule_case(EcsRulePredEq): return flecs_rule_pred_eq(op, redo, ctx);
+    flecs_rule_case(EcsRulePredNeq): return flecs_rule_pred_neq(op, redo, ctx);
+    flecs_rule_case(EcsRulePredEqName): return flecs_rule_pred_eq_name(op, redo, ctx);
+    flecs_rule_case(EcsRulePredNeqName): return flecs_rule_pred_neq_name(op, redo, ctx);
+    flecs_rule_case(EcsRulePredEqMatch): return flecs_rule_pred_eq_match(op, redo, ctx);
+    flecs_rule_case(EcsRulePredNeqMatch): return flecs_rule_pred_neq_match(op, redo, ctx);
+    flecs_rule_case(EcsRuleLookup): return flecs_rule_lookup(op, redo, ctx);
+    flecs_rule_case(EcsRuleSetVars): return flecs_rule_setvars(op, redo, ctx);
+    flecs_rule_case(EcsRuleSetThis): return flecs_rule_setthis(op, redo, ctx);
+    flecs_rule_case(EcsRuleSetFixed): return flecs_rule_setfixed(op, redo, ctx);
+    flecs_rule_case(EcsRuleSetIds): return flecs_rule_setids(op, redo, ctx);
+    flecs_rule_case(EcsRuleSetId): return flecs_rule_setid(op, redo, ctx);
+    flecs_rule_case(EcsRuleContain): return flecs_rule_contain(op, redo, ctx);
+    flecs_rule_case(EcsRulePairEq): return flecs_rule_pair_eq(op, redo, ctx);
+    flecs_rule_case(EcsRulePopulate): return flecs_rule_populate(op, redo, ctx);
+    flecs_rule_case(EcsRulePopulateSelf): return flecs_rule_populate_self(op, redo, ctx);
+    flecs_rule_case(EcsRuleYield): return false;
+    flecs_rule_case(EcsRuleNothing): return false;
     }
     return false;
 }
 
+#ifdef FLECS_RULE_COMPUTED_GOTO
+#pragma GCC diagnostic pop
+#endif
+
+static
+bool flecs_rule_dispatch_w_profile(
+    const ecs_rule_op_t *op,
+    bool redo,
+    ecs_rule_run_ctx_t *ctx,
+    ecs_rule_op_profile_t *profile)
+{
+    ecs_time_t t = {0};
+    ecs_time_measure(&t);
+
+    bool result = flecs_rule_dispatch(op, redo, ctx);
+
+    profile->count[redo] ++;
+    profile->match_count += result;
+    profile->time_spent += ecs_time_measure(&t);
+    return result;
+}
+
 static
 bool flecs_rule_run_until(
     bool redo,
@@ -2476,12 +2764,17 @@ bool flecs_rule_run_until(
     const ecs_rule_op_t *op = &ops[ctx->op_index];
     ecs_assert(op->kind != until, ECS_INTERNAL_ERROR, NULL);
 
+    ecs_rule_op_profile_t *profile = ctx->rit->profile;
+
     do {
-        #ifdef FLECS_DEBUG
-        ctx->rit->profile[ctx->op_index].count[redo] ++;
-        #endif
+        bool result;
+        if (profile) {
+            result = flecs_rule_dispatch_w_profile(
+                op, redo, ctx, &profile[ctx->op_index]);
+        } else {
+            result = flecs_rule_dispatch(op, redo, ctx);
+        }
 
-        bool result = flecs_rule_dispatch(op, redo, ctx);
         cur = (&op->prev)[result];
         redo = cur < ctx->op_index;
 
@@ -2533,6 +2826,15 @@ void flecs_rule_iter_init(
         }
     }
 
+    /* Profiling requires evaluating the rule program, so don't use trivial
+     * iterator modes when profiling. */
+    if (it->flags & EcsIterProfile) {
+        ctx->rit->profile = flecs_iter_calloc_n(
+            it, ecs_rule_op_profile_t, rule->op_count);
+        flecs_iter_validate(it);
+        return;
+    }
+
     ecs_flags32_t flags = rule->filter.flags;
     if (flags & EcsFilterIsTrivial) {
         if ((flags & EcsFilterMatchOnlySelf) || 
@@ -2566,13 +2868,30 @@ void flecs_rule_iter_init(
     flecs_iter_validate(it);
 }
 
-bool ecs_rule_next_instanced(
+static
+bool flecs_rule_next_instanced(
     ecs_iter_t *it)
 {
     ecs_assert(it != NULL, ECS_INVALID_PARAMETER, NULL);
     ecs_assert(it->next == ecs_rule_next, ECS_INVALID_PARAMETER, NULL);
 
     ecs_rule_iter_t *rit = &it->priv.iter.rule;
+
+    /* Replay cached results, unless variables are constrained or the rule is
+     * profiled, both of which require evaluating the rule program. */
+    if (it->flags & EcsIterCached) {
+        if ((it->flags & EcsIterIsValid) || 
+            !(it->constrained_vars || (it->flags & EcsIterProfile)))
+        {
+            if (flecs_rule_cache_next(it)) {
+                return true;
+            }
+            ecs_iter_fini(it);
+            return false;
+        }
+        ECS_BIT_CLEAR(it->flags, EcsIterCached);
+    }
+
     ecs_rule_run_ctx_t ctx;
     ctx.world = it->real_world;
     ctx.rule = rit->rule;
@@ -2663,6 +2982,12 @@ done:
     return false;
 }
 
+bool ecs_rule_next_instanced(
+    ecs_iter_t *it)
+{
+    return flecs_sparse_filter_next(it, flecs_rule_next_instanced);
+}
+
 bool ecs_rule_next(
     ecs_iter_t *it)
 {
@@ -2695,6 +3020,12 @@ void flecs_rule_iter_fini_ctx(
         case EcsRuleTrav:
             flecs_rule_trav_cache_fini(a, &ctx[i].is.trav.cache);
             break;
+        case EcsRuleJoin:
+            if (ctx[i].is.join.built) {
+                ecs_map_fini(&ctx[i].is.join.index);
+                ecs_vec_fini_t(a, &ctx[i].is.join.sources, ecs_entity_t);
+            }
+            break;
         case EcsRuleUp:
         case EcsRuleSelfUp:
         case EcsRuleUpId:
@@ -2713,6 +3044,29 @@ void flecs_rule_iter_fini_ctx(
     }
 }
 
+/* Add profile of iterator to rule */
+static
+void flecs_rule_profile_add(
+    ecs_rule_t *rule,
+    const ecs_rule_op_profile_t *profile)
+{
+    int32_t i, count = rule->op_count;
+    if (!rule->profile) {
+        rule->profile = ecs_os_calloc_n(ecs_rule_op_profile_t, count);
+    }
+
+    for (i = 0; i < count; i ++) {
+        ecs_rule_op_profile_t *dst = &rule->profile[i];
+        const ecs_rule_op_profile_t *src = &profile[i];
+        dst->count[0] += src->count[0];
+        dst->count[1] += src->count[1];
+        dst->match_count += src->match_count;
+        dst->time_spent += src->time_spent;
+    }
+
+    rule->profile_iter_count ++;
+}
+
 static
 void flecs_rule_iter_fini(
     ecs_iter_t *it)
@@ -2723,20 +3077,18 @@ void flecs_rule_iter_fini(
     int32_t op_count = rit->rule->op_count;
     int32_t var_count = rit->rule->var_count;
 
-#ifdef FLECS_DEBUG
-    if (it->flags & EcsIterProfile) {
-        char *str = ecs_rule_str_w_profile(rit->rule, it);
-        printf("%s\n", str);
-        ecs_os_free(str);
+    if (rit->profile) {
+        flecs_rule_profile_add(ECS_CONST_CAST(ecs_rule_t*, rit->rule), 
+            rit->profile);
+        flecs_iter_free_n(rit->profile, ecs_rule_op_profile_t, op_count);
+        rit->profile = NULL;
     }
 
-    flecs_iter_free_n(rit->profile, ecs_rule_op_profile_t, op_count);
-#endif
-
     flecs_rule_iter_fini_ctx(it, rit);
     flecs_iter_free_n(rit->vars, ecs_var_t, var_count);
     flecs_iter_free_n(rit->written, ecs_write_flags_t, op_count);
     flecs_iter_free_n(rit->op_ctx, ecs_rule_op_ctx_t, op_count);
+    ecs_os_adec(&ECS_CONST_CAST(ecs_rule_t*, rit->rule)->iter_count);
     rit->vars = NULL;
     rit->written = NULL;
     rit->op_ctx = NULL;
@@ -2756,6 +3108,30 @@ ecs_iter_t ecs_rule_iter(
 
     ecs_run_aperiodic(rule->filter.world, EcsAperiodicEmptyTables);
 
+    /* If the number of tables matched by the terms changed significantly since
+     * the rule was planned, replan it. Only do this when the rule is not being
+     * iterated, as iterators point to the rule operations. */
+    ecs_world_t *real_world = rule->filter.world;
+    if (rule->plan_counts && !rule->iter_count && 
+        !(real_world->flags & EcsWorldReadonly) &&
+        flecs_rule_plan_is_stale(real_world, rule))
+    {
+        ecs_stage_t *stage = flecs_stage_from_world(&real_world);
+        if (flecs_rule_replan(real_world, stage, 
+            ECS_CONST_CAST(ecs_rule_t*, rule))) 
+        {
+            goto error;
+        }
+    }
+
+    /* Bring cached results up to date before the rule is iterated */
+    bool cached = false;
+    if (rule->cache) {
+        cached = flecs_rule_cache_update(ECS_CONST_CAST(ecs_rule_t*, rule));
+    }
+
+    ecs_os_ainc(&ECS_CONST_CAST(ecs_rule_t*, rule)->iter_count);
+
     int32_t i, var_count = rule->var_count, op_count = rule->op_count;
     it.world = ECS_CONST_CAST(ecs_world_t*, world);
     it.real_world = rule->filter.world;
@@ -2767,6 +3143,7 @@ ecs_iter_t ecs_rule_iter(
     it.sizes = rule->filter.sizes;
     it.system = rule->filter.entity;
     flecs_filter_apply_iter_flags(&it, &rule->filter);
+    ECS_BIT_COND(it.flags, EcsIterCached, cached);
 
     flecs_iter_init(world, &it, 
         flecs_iter_cache_ids |
@@ -2786,10 +3163,6 @@ ecs_iter_t ecs_rule_iter(
         rit->op_ctx = flecs_iter_calloc_n(&it, ecs_rule_op_ctx_t, op_count);
     }
 
-#ifdef FLECS_DEBUG
-    rit->profile = flecs_iter_calloc_n(&it, ecs_rule_op_profile_t, op_count);
-#endif
-
     for (i = 1; i < var_count; i ++) {
         rit->vars[i].entity = EcsWildcard;
     }
@@ -15,6 +15,24 @@ typedef int16_t ecs_rule_lbl_t;
 typedef ecs_flags64_t ecs_write_flags_t;
 
 #define EcsRuleMaxVarCount      (64)
+
+/* A term is only evaluated before the term picked by the default term order
+ * if its estimated cost is both this many times and this much lower. This 
+ * keeps the plan stable for rules that match few entities. */
+#define EcsRulePlanCostFactor   (4)
+#define EcsRulePlanCostMin      (64)
+
+/* A rule is replanned if the table count of a term it was planned with grows
+ * or shrinks by more than this factor, and by more than this many tables. */
+#define EcsRulePlanDriftFactor  (2)
+#define EcsRulePlanDriftMin     (8)
+
+/* A term that finds the sources for a pair with a known target is evaluated
+ * with a join if it is expected to be evaluated at least this many times, and
+ * the number of pairs to index is less than this factor times that number. */
+#define EcsRuleJoinMinProbes    (16)
+#define EcsRuleJoinBuildFactor  (4)
+
 #define EcsVarNone              ((ecs_var_id_t)-1)
 #define EcsThisName             "this"
 
@@ -52,7 +70,10 @@ typedef enum {
     EcsRuleSelfUp,         /* Self|up traversal */
     EcsRuleSelfUpId,       /* Self|up traversal for fixed id (like AndId) */
     EcsRuleWith,           /* Match id against fixed or variable source */
+    EcsRuleWithIds,        /* Fused AndId instructions for written $this */
+    EcsRuleSelfUpWithIds,  /* Fused SelfUpId instructions for written $this */
     EcsRuleTrav,           /* Support for transitive/reflexive queries */
+    EcsRuleJoin,           /* Find sources for (R, $known) with hash index */
     EcsRuleIds,            /* Test for existence of ids matching wildcard */
     EcsRuleIdsRight,       /* Find ids in use that match (R, *) wildcard */
     EcsRuleIdsLeft,        /* Find ids in use that match (*, T) wildcard */
@@ -124,6 +145,17 @@ typedef struct {
     int16_t remaining;
 } ecs_rule_and_ctx_t;
 
+/* Join context. Stores an index of (R, *) pairs keyed by target, so that
+ * finding the sources for (R, $t) doesn't require a search per value of $t. */
+typedef struct {
+    ecs_map_t index;       /* map<target, (offset << 32) | count> */
+    ecs_vec_t sources;     /* vector<ecs_entity_t>, grouped by target */
+    ecs_id_record_t *idr;  /* Record for (R, $t) of current probe */
+    int32_t cur;
+    int32_t end;
+    bool built;
+} ecs_rule_join_ctx_t;
+
 /* Down traversal cache (for resolving up queries w/unknown source) */
 typedef struct {
     ecs_table_t *table;
@@ -175,6 +207,7 @@ typedef struct {
 typedef struct {
     ecs_id_t id;
     ecs_id_record_t *idr;
+    ecs_table_t *table; /* Only used for up traversal */
     ecs_vec_t entities;
     bool up;
 } ecs_trav_cache_t;
@@ -229,6 +262,7 @@ typedef struct ecs_rule_op_ctx_t {
         ecs_rule_and_ctx_t and;
         ecs_rule_up_ctx_t up;
         ecs_rule_trav_ctx_t trav;
+        ecs_rule_join_ctx_t join;
         ecs_rule_ids_ctx_t ids;
         ecs_rule_eq_ctx_t eq;
         ecs_rule_each_ctx_t each;
@@ -259,6 +293,8 @@ typedef struct {
 
     int32_t scope; /* Nesting level of query scopes */
     ecs_flags32_t scope_is_not; /* Whether scope is prefixed with not */
+
+    int64_t est_count; /* Estimated number of results for compiled terms */
 } ecs_rule_compile_ctx_t;
 
 /* Rule run state */
@@ -280,6 +316,30 @@ typedef struct {
     const char *name;
 } ecs_rule_var_cache_t;
 
+/* Header of a cached rule result. The header is followed by the ids, sources,
+ * variables and columns of the result. */
+typedef struct {
+    ecs_table_t *table;           /* $this table (NULL if result has no table) */
+    ecs_entity_t entity;          /* $this entity, 0 if result is entire table */
+    int32_t count;                /* Entity count for results without table */
+    bool dead;                    /* Set when table is deleted */
+} ecs_rule_cache_elem_t;
+
+/* Cached rule results (see EcsFilterCacheResults) */
+typedef struct {
+    ecs_vec_t results;            /* Results, elem_size bytes per result */
+    ecs_size_t elem_size;         /* Size of a single result */
+    ecs_size_t sources_offset;    /* Offsets of arrays in a single result */
+    ecs_size_t vars_offset;
+    ecs_size_t columns_offset;
+    int32_t var_count;            /* Number of stored variables */
+    ecs_map_t pending;            /* Tables created since last update */
+    ecs_vec_t observers;          /* vec<ecs_entity_t> */
+    bool table_local;             /* Can results be derived per $this table */
+    bool dirty;                   /* Do results need to be rederived */
+    bool updating;                /* Are results being derived */
+} ecs_rule_cache_t;
+
 struct ecs_rule_t {
     ecs_header_t hdr;             /* Poly header */
     ecs_filter_t filter;          /* Filter */
@@ -288,6 +348,7 @@ struct ecs_rule_t {
     ecs_rule_var_t *vars;         /* Variables */
     int32_t var_count;            /* Number of variables */
     int32_t var_pub_count;        /* Number of public variables */
+    int32_t var_discover_count;   /* Number of variables before compiling ops */
     bool has_table_this;          /* Does rule have [$this] */
     ecs_hashmap_t tvar_index;     /* Name index for table variables */
     ecs_hashmap_t evar_index;     /* Name index for entity variables */
@@ -298,6 +359,17 @@ struct ecs_rule_t {
     ecs_rule_op_t *ops;           /* Operations */
     int32_t op_count;             /* Number of operations */
 
+    /* Planning */
+    int32_t *plan_counts;         /* Table counts per term used for plan */
+    int32_t iter_count;           /* Number of active iterators */
+
+    /* Profiling */
+    ecs_rule_op_profile_t *profile; /* Accumulated profile of iterators */
+    int32_t profile_iter_count;   /* Number of iterators in profile */
+
+    /* Result cache */
+    ecs_rule_cache_t *cache;      /* Only set if EcsFilterCacheResults is set */
+
     /* Mixins */
     ecs_iterable_t iterable;
     ecs_poly_dtor_t dtor;
@@ -334,6 +406,34 @@ int flecs_rule_compile(
     ecs_stage_t *stage,
     ecs_rule_t *rule);
 
+/* Check if cardinalities drifted too far from the ones used to plan rule */
+bool flecs_rule_plan_is_stale(
+    const ecs_world_t *world,
+    const ecs_rule_t *rule);
+
+/* Compile operations of an already compiled rule with current cardinalities */
+int flecs_rule_replan(
+    ecs_world_t *world,
+    ecs_stage_t *stage,
+    ecs_rule_t *rule);
+
+/* Create result cache & observers for rule */
+void flecs_rule_cache_init(
+    ecs_world_t *world,
+    ecs_rule_t *rule);
+
+/* Free result cache & observers */
+void flecs_rule_cache_fini(
+    ecs_rule_t *rule);
+
+/* Bring cache up to date. Returns false if the cache can't be used */
+bool flecs_rule_cache_update(
+    ecs_rule_t *rule);
+
+/* Return next result from cache */
+bool flecs_rule_cache_next(
+    ecs_iter_t *it);
+
 /* Get allocator from iterator */
 ecs_allocator_t* flecs_rule_get_allocator(
     const ecs_iter_t *it);
@@ -49,6 +49,41 @@ void flecs_rule_build_down_cache(
     }
 }
 
+/* Populate cache from the world-level traversal index. The index persists
+ * across iterations and rules, and is only rebuilt after (trav, *) pairs were
+ * added or removed. Returns false if the index couldn't be used. */
+static
+bool flecs_rule_down_cache_from_index(
+    ecs_world_t *world,
+    ecs_allocator_t *a,
+    ecs_trav_cache_t *cache,
+    ecs_entity_t trav,
+    ecs_entity_t entity)
+{
+    ecs_id_record_t *idr = flecs_id_record_get(world, ecs_pair(trav, entity));
+    if (!idr) {
+        return true; /* Nothing to traverse */
+    }
+
+    const ecs_vec_t *index = flecs_id_record_trav_index(world, idr);
+    if (!index) {
+        return false;
+    }
+
+    int32_t i, count = ecs_vec_count(index);
+    ecs_id_record_t **idrs = ecs_vec_first(index);
+    ecs_trav_elem_t *elems = ecs_vec_grow_t(
+        a, &cache->entities, ecs_trav_elem_t, count);
+    for (i = 0; i < count; i ++) {
+        elems[i].entity = flecs_entities_get_alive(
+            world, ECS_PAIR_SECOND(idrs[i]->id));
+        elems[i].idr = idrs[i];
+        elems[i].column = -1;
+    }
+
+    return true;
+}
+
 static
 void flecs_rule_build_up_cache(
     ecs_world_t *world,
@@ -81,7 +116,7 @@ void flecs_rule_build_up_cache(
             ecs_table_record_t *r_tr = flecs_id_record_get_table(
                 cache->idr, r->table);
             if (!r_tr) {
-                return;
+                continue;
             }
             flecs_rule_build_up_cache(world, a, ctx, cache, trav, r->table, 
                 r_tr, root_column);
@@ -106,7 +141,9 @@ void flecs_rule_get_trav_down_cache(
         ecs_world_t *world = ctx->it->real_world;
         ecs_allocator_t *a = flecs_rule_get_allocator(ctx->it);
         ecs_vec_reset_t(a, &cache->entities, ecs_trav_elem_t);
-        flecs_rule_build_down_cache(world, a, ctx, cache, trav, entity);
+        if (!flecs_rule_down_cache_from_index(world, a, cache, trav, entity)) {
+            flecs_rule_build_down_cache(world, a, ctx, cache, trav, entity);
+        }
         cache->id = ecs_pair(trav, entity);
         cache->up = false;
     }
@@ -140,10 +177,11 @@ void flecs_rule_get_trav_up_cache(
 
     ecs_id_t id = table->type.array[tr->index];
 
-    if (cache->id != id || !cache->up) {
+    if (cache->id != id || cache->table != table || !cache->up) {
         ecs_vec_reset_t(a, &cache->entities, ecs_trav_elem_t);
         flecs_rule_build_up_cache(world, a, ctx, cache, trav, table, tr, -1);
         cache->id = id;
+        cache->table = table;
         cache->up = true;
     }
 }
@@ -45,8 +45,10 @@ ecs_data_t* flecs_duplicate_data(
     result->entities = ecs_vec_copy_shrink_t(a, &main_data->entities, ecs_entity_t);
 
     /* Copy each column */
+    a = flecs_column_allocator(world);
     for (i = 0; i < column_count; i ++) {
         ecs_column_t *column = &result->columns[i];
+        column->reserved = 0;
         ecs_type_info_t *ti = column->ti;
         ecs_assert(ti != NULL, ECS_INTERNAL_ERROR, NULL);
         int32_t size = ti->size;
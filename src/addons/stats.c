@@ -242,6 +242,136 @@ void flecs_stats_copy_last(
     }
 }
 
+static
+void flecs_allocator_stats_add_size(
+    ecs_allocator_stats_t *s,
+    const ecs_block_allocator_t *ba,
+    int64_t bytes_in_use,
+    int64_t bytes_reserved)
+{
+    int32_t i, count = ecs_vec_count(&s->sizes);
+    ecs_allocator_size_stats_t *sizes = ecs_vec_first(&s->sizes);
+    for (i = 0; i < count; i ++) {
+        if (sizes[i].size >= ba->data_size) {
+            break;
+        }
+    }
+
+    if (i == count || sizes[i].size != ba->data_size) {
+        ecs_vec_append_t(NULL, &s->sizes, ecs_allocator_size_stats_t);
+        sizes = ecs_vec_first(&s->sizes);
+        ecs_os_memmove_n(&sizes[i + 1], &sizes[i], 
+            ecs_allocator_size_stats_t, (count - i));
+        ecs_os_zeromem(&sizes[i]);
+        sizes[i].size = ba->data_size;
+    }
+
+    ecs_allocator_size_stats_t *elem = &sizes[i];
+    elem->allocator_count ++;
+    elem->block_count += ba->block_count;
+    elem->chunk_count += ba->alloc_count;
+    elem->chunk_count_max += ba->alloc_count_max;
+    elem->bytes_in_use += bytes_in_use;
+    elem->bytes_reserved += bytes_reserved;
+}
+
+static
+void flecs_allocator_stats_add_ba(
+    ecs_allocator_stats_t *s,
+    const ecs_block_allocator_t *ba,
+    bool sizes)
+{
+    int64_t bytes_in_use = (int64_t)ba->alloc_count * ba->data_size;
+#ifdef FLECS_USE_OS_ALLOC
+    int64_t bytes_reserved = bytes_in_use;
+#else
+    int64_t bytes_reserved = (int64_t)ba->block_count * ba->block_size;
+#endif
+
+    s->bytes_in_use += bytes_in_use;
+    s->bytes_reserved += bytes_reserved;
+    s->chunk_count += ba->alloc_count;
+    s->block_count += ba->block_count;
+
+    /* Don't report allocators that have never been used */
+    if (sizes && (ba->block_count || ba->alloc_count_max)) {
+        flecs_allocator_stats_add_size(s, ba, bytes_in_use, bytes_reserved);
+    }
+}
+
+static
+void flecs_allocator_stats_add_allocator(
+    ecs_allocator_stats_t *s,
+    const ecs_allocator_t *a,
+    bool sizes)
+{
+    ecs_sparse_t *a_sizes = ECS_CONST_CAST(ecs_sparse_t*, &a->sizes);
+    int32_t i, count = flecs_sparse_count(a_sizes);
+    for (i = 0; i < count; i ++) {
+        ecs_block_allocator_t *ba = flecs_sparse_get_dense_t(
+            a_sizes, ecs_block_allocator_t, i);
+        flecs_allocator_stats_add_ba(s, ba, sizes);
+    }
+    flecs_allocator_stats_add_ba(s, &a->chunks, sizes);
+}
+
+static
+void flecs_allocator_stats_collect(
+    const ecs_world_t *world,
+    ecs_allocator_stats_t *s,
+    bool sizes)
+{
+    const ecs_world_allocators_t *wa = &world->allocators;
+    flecs_allocator_stats_add_allocator(s, &world->allocator, sizes);
+    flecs_allocator_stats_add_allocator(s, &world->column_allocator, sizes);
+    flecs_allocator_stats_add_ba(s, &wa->query_table, sizes);
+    flecs_allocator_stats_add_ba(s, &wa->query_table_match, sizes);
+    flecs_allocator_stats_add_ba(s, &wa->graph_edge_lo, sizes);
+    flecs_allocator_stats_add_ba(s, &wa->graph_edge, sizes);
+    flecs_allocator_stats_add_ba(s, &wa->id_record, sizes);
+    flecs_allocator_stats_add_ba(s, &wa->id_record_chunk, sizes);
+    flecs_allocator_stats_add_ba(s, &wa->table_diff, sizes);
+    flecs_allocator_stats_add_ba(s, &wa->sparse_chunk, sizes);
+    flecs_allocator_stats_add_ba(s, &wa->hashmap, sizes);
+    flecs_allocator_stats_add_ba(s, 
+        &world->store.entity_index.page_allocator, sizes);
+    flecs_allocator_stats_add_ba(s, &world->stack_pages.ba, sizes);
+
+    int32_t i, count = world->stage_count;
+    for (i = 0; i < count; i ++) {
+        const ecs_stage_t *stage = &world->stages[i];
+        flecs_allocator_stats_add_allocator(s, &stage->allocator, sizes);
+        flecs_allocator_stats_add_ba(s, 
+            &stage->allocators.cmd_entry_chunk, sizes);
+    }
+}
+
+void ecs_allocator_stats_get(
+    const ecs_world_t *world,
+    ecs_allocator_stats_t *stats)
+{
+    ecs_check(world != NULL, ECS_INVALID_PARAMETER, NULL);
+    ecs_check(stats != NULL, ECS_INVALID_PARAMETER, NULL);
+
+    world = ecs_get_world(world);
+
+    stats->bytes_in_use = 0;
+    stats->bytes_reserved = 0;
+    stats->chunk_count = 0;
+    stats->block_count = 0;
+    ecs_vec_clear(&stats->sizes);
+
+    flecs_allocator_stats_collect(world, stats, true);
+error:
+    return;
+}
+
+void ecs_allocator_stats_fini(
+    ecs_allocator_stats_t *stats)
+{
+    ecs_vec_fini_t(NULL, &stats->sizes, ecs_allocator_size_stats_t);
+}
+
 void ecs_world_stats_get(
     const ecs_world_t *world,
     ecs_world_stats_t *s)
@@ -326,6 +456,13 @@ void ecs_world_stats_get(
     ECS_COUNTER_RECORD(&s->memory.stack_free_count, t, ecs_stack_allocator_free_count);
     ECS_GAUGE_RECORD(&s->memory.stack_outstanding_alloc_count, t, outstanding_allocs);
 
+    ecs_allocator_stats_t alloc_stats = {0};
+    flecs_allocator_stats_collect(world, &alloc_stats, false);
+    ECS_GAUGE_RECORD(&s->memory.allocator_bytes_in_use, t, alloc_stats.bytes_in_use);
+    ECS_GAUGE_RECORD(&s->memory.allocator_bytes_reserved, t, alloc_stats.bytes_reserved);
+    ECS_GAUGE_RECORD(&s->memory.allocator_chunk_count, t, alloc_stats.chunk_count);
+    ECS_GAUGE_RECORD(&s->memory.allocator_block_count, t, alloc_stats.block_count);
+
 #ifdef FLECS_HTTP
     ECS_COUNTER_RECORD(&s->http.request_received_count, t, ecs_http_request_received_count);
     ECS_COUNTER_RECORD(&s->http.request_invalid_count, t, ecs_http_request_invalid_count);
@@ -830,6 +967,11 @@ void ecs_world_stats_log(
     flecs_counter_print("batched entities", t, &s->commands.batched_entity_count);
     flecs_counter_print("batched commands", t, &s->commands.batched_count);
     ecs_trace("");
+    flecs_gauge_print("allocator bytes in use", t, &s->memory.allocator_bytes_in_use);
+    flecs_gauge_print("allocator bytes reserved", t, &s->memory.allocator_bytes_reserved);
+    flecs_gauge_print("allocator chunks in use", t, &s->memory.allocator_chunk_count);
+    flecs_gauge_print("allocator blocks", t, &s->memory.allocator_block_count);
+    ecs_trace("");
     
 error:
     return;
@@ -31,6 +31,7 @@ ecs_entity_t ecs_run_intern(
     ecs_ftime_t delta_time,
     int32_t offset,
     int32_t limit,
+    bool balanced,
     void *param) 
 {
     ecs_ftime_t time_elapsed = delta_time;
@@ -100,7 +101,11 @@ ecs_entity_t ecs_run_intern(
     }
 
     if (stage_count > 1 && system_data->multi_threaded) {
-        wit = ecs_worker_iter(it, stage_index, stage_count);
+        if (balanced) {
+            wit = ecs_balanced_worker_iter(it, stage_index, stage_count);
+        } else {
+            wit = ecs_worker_iter(it, stage_index, stage_count);
+        }
         it = &wit;
     }
 
@@ -151,7 +156,7 @@ ecs_entity_t ecs_run_w_filter(
     ecs_system_t *system_data = ecs_poly_get(world, system, ecs_system_t);
     ecs_assert(system_data != NULL, ECS_INVALID_PARAMETER, NULL);
     return ecs_run_intern(world, stage, system, system_data, 0, 0, delta_time, 
-        offset, limit, param);
+        offset, limit, false, param);
 }
 
 ecs_entity_t ecs_run_worker(
@@ -168,7 +173,7 @@ ecs_entity_t ecs_run_worker(
 
     return ecs_run_intern(
         world, stage, system, system_data, stage_index, stage_count, 
-        delta_time, 0, 0, param);
+        delta_time, 0, 0, true, param);
 }
 
 ecs_entity_t ecs_run(
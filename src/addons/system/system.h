@@ -52,7 +52,9 @@ void ecs_system_activate(
     bool activate,
     const ecs_system_t *system_data);
 
-/* Internal function to run a system */
+/* Internal function to run a system. If balanced is true and the system runs on
+ * multiple workers, each worker gets a contiguous range of the matched entities
+ * instead of a part of each table (see ecs_balanced_worker_iter). */
 ecs_entity_t ecs_run_intern(
     ecs_world_t *world,
     ecs_stage_t *stage,
@@ -63,6 +65,7 @@ ecs_entity_t ecs_run_intern(
     ecs_ftime_t delta_time,
     int32_t offset,
     int32_t limit,
+    bool balanced,
     void *param);
 
 #endif
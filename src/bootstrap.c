@@ -357,6 +357,22 @@ void flecs_register_union(ecs_iter_t *it) {
     flecs_register_id_flag_for_relation(it, EcsUnion, EcsIdUnion, 0, 0);
 }
 
+static
+void flecs_register_sparse(ecs_iter_t *it) {
+    ecs_world_t *world = it->world;
+
+    int i, count = it->count;
+    for (i = 0; i < count; i ++) {
+        ecs_entity_t e = it->entities[i];
+        ecs_id_record_t *idr = flecs_id_record_ensure(world, e);
+        if (flecs_set_id_flag(idr, EcsIdSparse)) {
+            flecs_assert_relation_unused(world, e, EcsSparse);
+            ecs_vec_append_t(&world->allocator, &world->sparse_ids,
+                ecs_id_record_t*)[0] = idr;
+        }
+    }
+}
+
 static
 void flecs_register_slot_of(ecs_iter_t *it) {
     int i, count = it->count;
@@ -663,6 +679,7 @@ ecs_table_t* flecs_bootstrap_component_table(
     /* Preallocate enough memory for initial components */
     ecs_allocator_t *a = &world->allocator;
     ecs_vec_init_t(a, &data->entities, ecs_entity_t, EcsFirstUserComponentId);
+    a = flecs_column_allocator(world);
     ecs_vec_init_t(a, &data->columns[0].data, EcsComponent, EcsFirstUserComponentId);
     ecs_vec_init_t(a, &data->columns[1].data, EcsIdentifier, EcsFirstUserComponentId);
     ecs_vec_init_t(a, &data->columns[2].data, EcsIdentifier, EcsFirstUserComponentId);
@@ -842,6 +859,7 @@ void flecs_bootstrap(
     flecs_bootstrap_trait(world, EcsAlwaysOverride);
     flecs_bootstrap_trait(world, EcsTag);
     flecs_bootstrap_trait(world, EcsUnion);
+    flecs_bootstrap_trait(world, EcsSparse);
     flecs_bootstrap_trait(world, EcsExclusive);
     flecs_bootstrap_trait(world, EcsAcyclic);
     flecs_bootstrap_trait(world, EcsTraversable);
@@ -1003,6 +1021,12 @@ void flecs_bootstrap(
         .callback = flecs_register_union
     });
 
+    ecs_observer(world, {
+        .filter.terms = {{ .id = EcsSparse, .src.flags = EcsSelf }, match_prefab },
+        .events = {EcsOnAdd},
+        .callback = flecs_register_sparse
+    });
+
     /* Entities used as slot are marked as exclusive to ensure a slot can always
      * only point to a single entity. */
     ecs_observer(world, {
@@ -0,0 +1,409 @@
+/**
+ * @file cmd_queue.c
+ * @brief Multi producer, single consumer command queue.
+ *
+ * A command queue allows threads that are not managed by flecs to enqueue
+ * commands without locking. The queue is a fixed size ring of command slots.
+ * Each slot has a sequence number that indicates whether it can be written by
+ * a producer or read by the consumer, which removes the need for a lock:
+ *
+ * - a producer claims an index by atomically incrementing the queue head. The
+ *   slot for that index can be written when its sequence equals the index.
+ * - after writing the command, the producer increments the sequence, which
+ *   makes the slot visible to the consumer.
+ * - the consumer applies commands in index order until it finds a slot that
+ *   hasn't been published yet. After a command is applied, the sequence of the
+ *   slot is set to the index that can use the slot in the next round.
+ *
+ * Component values are stored in a value arena that reserves a fixed number of
+ * bytes per slot, so that enqueueing small values does not allocate.
+ */
+
+#include "private_api.h"
+
+#define ECS_CMD_QUEUE_DEFAULT_CAPACITY (4096)
+#define ECS_CMD_QUEUE_DEFAULT_VALUE_SIZE (64)
+
+typedef struct ecs_cmd_queue_slot_t {
+    int64_t seq;                     /* Index that can use the slot */
+    ecs_cmd_t cmd;                   /* Enqueued command */
+    ecs_entity_t event;              /* Event (used by event commands) */
+} ecs_cmd_queue_slot_t;
+
+struct ecs_cmd_queue_t {
+    ecs_world_t *world;
+    ecs_cmd_queue_slot_t *slots;
+    char *values;                    /* Value arena with value_size per slot */
+    int32_t capacity;
+    ecs_size_t value_size;
+    int64_t head;                    /* Next index claimed by a producer */
+    int64_t tail;                    /* Next index read by the consumer */
+    ecs_entity_t system;             /* System that drains queue (optional) */
+};
+
+static
+int64_t flecs_cmd_queue_load(
+    int64_t *value)
+{
+    return *(volatile int64_t*)value;
+}
+
+static
+ecs_cmd_queue_slot_t* flecs_cmd_queue_claim(
+    ecs_cmd_queue_t *queue,
+    ecs_cmd_kind_t kind,
+    ecs_entity_t entity,
+    ecs_id_t id)
+{
+    int64_t tail = flecs_cmd_queue_load(&queue->tail);
+    if ((flecs_cmd_queue_load(&queue->head) - tail) >= queue->capacity) {
+        return NULL;
+    }
+
+    int64_t index = ecs_os_lainc(&queue->head) - 1;
+    ecs_cmd_queue_slot_t *slot = &queue->slots[index % queue->capacity];
+
+    /* If multiple producers raced for the last free slots, the slot may still
+     * hold a command from the previous round. Wait until it's consumed. */
+    while (flecs_cmd_queue_load(&slot->seq) != index) { }
+
+    ecs_cmd_t *cmd = &slot->cmd;
+    cmd->kind = kind;
+    cmd->entity = entity;
+    cmd->id = id;
+    cmd->is._1.value = NULL;
+    cmd->is._1.size = 0;
+    slot->event = 0;
+    return slot;
+}
+
+static
+bool flecs_cmd_queue_publish(
+    ecs_cmd_queue_slot_t *slot)
+{
+    /* Atomic increment acts as barrier, so the command is fully written before
+     * the consumer can observe the new sequence. */
+    ecs_os_lainc(&slot->seq);
+    return true;
+}
+
+static
+void* flecs_cmd_queue_value(
+    ecs_cmd_queue_t *queue,
+    ecs_cmd_queue_slot_t *slot)
+{
+    int32_t index = flecs_ito(int32_t, slot - queue->slots);
+    return ECS_OFFSET(queue->values, queue->value_size * index);
+}
+
+static
+void flecs_cmd_queue_value_free(
+    ecs_cmd_queue_t *queue,
+    ecs_cmd_queue_slot_t *slot)
+{
+    void *value = slot->cmd.is._1.value;
+    if (value && value != flecs_cmd_queue_value(queue, slot)) {
+        ecs_os_free(value);
+    }
+}
+
+static
+void flecs_cmd_queue_apply(
+    ecs_world_t *world,
+    ecs_cmd_queue_slot_t *slot)
+{
+    ecs_cmd_t *cmd = &slot->cmd;
+    ecs_entity_t e = cmd->entity;
+    if (!e || !ecs_is_valid(world, e)) {
+        return;
+    }
+
+    switch(cmd->kind) {
+    case EcsCmdAdd:
+        ecs_add_id(world, e, cmd->id);
+        break;
+    case EcsCmdRemove:
+        ecs_remove_id(world, e, cmd->id);
+        break;
+    case EcsCmdSet:
+        ecs_set_id(world, e, cmd->id,
+            flecs_ito(size_t, cmd->is._1.size), cmd->is._1.value);
+        break;
+    case EcsCmdDelete:
+        ecs_delete(world, e);
+        break;
+    case EcsCmdEvent: {
+        ecs_event_desc_t desc = {
+            .event = slot->event,
+            .ids = &(ecs_type_t){ .array = &cmd->id, .count = 1 },
+            .entity = e
+        };
+        /* Enqueue event when deferred so it's emitted after the commands that
+         * were drained before it. */
+        if (ecs_is_deferred(world)) {
+            ecs_enqueue(world, &desc);
+        } else {
+            ecs_emit(world, &desc);
+        }
+        break;
+    }
+    case EcsCmdClone:
+    case EcsCmdBulkNew:
+    case EcsCmdEmplace:
+    case EcsCmdEnsure:
+    case EcsCmdModified:
+    case EcsCmdModifiedNoHook:
+    case EcsCmdAddModified:
+    case EcsCmdPath:
+    case EcsCmdClear:
+    case EcsCmdOnDeleteAction:
+    case EcsCmdEnable:
+    case EcsCmdDisable:
+    case EcsCmdSkip:
+    default:
+        ecs_abort(ECS_INTERNAL_ERROR, NULL);
+    }
+}
+
+#ifdef FLECS_PIPELINE
+static
+void flecs_cmd_queue_drain_system(
+    ecs_iter_t *it)
+{
+    ecs_cmd_queue_drain(it->world, it->ctx);
+}
+#endif
+
+ecs_cmd_queue_t* ecs_cmd_queue_new(
+    ecs_world_t *world,
+    const ecs_cmd_queue_desc_t *desc)
+{
+    ecs_poly_assert(world, ecs_world_t);
+    ecs_check(ecs_os_api.lainc_ != NULL, ECS_MISSING_OS_API, "lainc");
+
+    ecs_cmd_queue_desc_t default_desc = {0};
+    if (!desc) {
+        desc = &default_desc;
+    }
+
+    ecs_check(desc->capacity >= 0, ECS_INVALID_PARAMETER, NULL);
+    ecs_check(desc->value_size >= 0, ECS_INVALID_PARAMETER, NULL);
+
+    ecs_cmd_queue_t *queue = ecs_os_calloc_t(ecs_cmd_queue_t);
+    queue->world = world;
+    queue->capacity = desc->capacity;
+    if (!queue->capacity) {
+        queue->capacity = ECS_CMD_QUEUE_DEFAULT_CAPACITY;
+    }
+    queue->value_size = desc->value_size;
+    if (!queue->value_size) {
+        queue->value_size = ECS_CMD_QUEUE_DEFAULT_VALUE_SIZE;
+    }
+    queue->value_size = ECS_ALIGN(queue->value_size, ECS_SIZEOF(int64_t));
+
+    queue->slots = ecs_os_calloc_n(ecs_cmd_queue_slot_t, queue->capacity);
+    queue->values = ecs_os_malloc(queue->value_size * queue->capacity);
+
+    int32_t i;
+    for (i = 0; i < queue->capacity; i ++) {
+        queue->slots[i].seq = i;
+    }
+
+    if (desc->phase) {
+#ifdef FLECS_PIPELINE
+        queue->system = ecs_system(world, {
+            .entity = ecs_entity(world, {
+                .add = { ecs_dependson(desc->phase), desc->phase }
+            }),
+            .callback = flecs_cmd_queue_drain_system,
+            .ctx = queue
+        });
+#else
+        ecs_err("cannot drain command queue in phase: pipeline addon missing");
+#endif
+    }
+
+    return queue;
+error:
+    return NULL;
+}
+
+void ecs_cmd_queue_free(
+    ecs_cmd_queue_t *queue)
+{
+    ecs_check(queue != NULL, ECS_INVALID_PARAMETER, NULL);
+
+    if (queue->system) {
+        ecs_delete(queue->world, queue->system);
+    }
+
+    int64_t i, head = queue->head;
+    for (i = queue->tail; i < head; i ++) {
+        ecs_cmd_queue_slot_t *slot = &queue->slots[i % queue->capacity];
+        if (slot->seq == (i + 1)) {
+            flecs_cmd_queue_value_free(queue, slot);
+        }
+    }
+
+    ecs_os_free(queue->slots);
+    ecs_os_free(queue->values);
+    ecs_os_free(queue);
+error:
+    return;
+}
+
+bool ecs_cmd_queue_add(
+    ecs_cmd_queue_t *queue,
+    ecs_entity_t entity,
+    ecs_id_t id)
+{
+    ecs_check(queue != NULL, ECS_INVALID_PARAMETER, NULL);
+    ecs_check(entity != 0, ECS_INVALID_PARAMETER, NULL);
+    ecs_check(id != 0, ECS_INVALID_PARAMETER, NULL);
+
+    ecs_cmd_queue_slot_t *slot = flecs_cmd_queue_claim(
+        queue, EcsCmdAdd, entity, id);
+    if (!slot) {
+        return false;
+    }
+
+    return flecs_cmd_queue_publish(slot);
+error:
+    return false;
+}
+
+bool ecs_cmd_queue_remove(
+    ecs_cmd_queue_t *queue,
+    ecs_entity_t entity,
+    ecs_id_t id)
+{
+    ecs_check(queue != NULL, ECS_INVALID_PARAMETER, NULL);
+    ecs_check(entity != 0, ECS_INVALID_PARAMETER, NULL);
+    ecs_check(id != 0, ECS_INVALID_PARAMETER, NULL);
+
+    ecs_cmd_queue_slot_t *slot = flecs_cmd_queue_claim(
+        queue, EcsCmdRemove, entity, id);
+    if (!slot) {
+        return false;
+    }
+
+    return flecs_cmd_queue_publish(slot);
+error:
+    return false;
+}
+
+bool ecs_cmd_queue_set(
+    ecs_cmd_queue_t *queue,
+    ecs_entity_t entity,
+    ecs_id_t id,
+    size_t size,
+    const void *ptr)
+{
+    ecs_check(queue != NULL, ECS_INVALID_PARAMETER, NULL);
+    ecs_check(entity != 0, ECS_INVALID_PARAMETER, NULL);
+    ecs_check(id != 0, ECS_INVALID_PARAMETER, NULL);
+    ecs_check(size != 0, ECS_INVALID_PARAMETER, NULL);
+    ecs_check(ptr != NULL, ECS_INVALID_PARAMETER, NULL);
+
+    ecs_cmd_queue_slot_t *slot = flecs_cmd_queue_claim(
+        queue, EcsCmdSet, entity, id);
+    if (!slot) {
+        return false;
+    }
+
+    ecs_size_t value_size = flecs_uto(ecs_size_t, size);
+    void *value;
+    if (value_size <= queue->value_size) {
+        value = flecs_cmd_queue_value(queue, slot);
+    } else {
+        value = ecs_os_malloc(value_size);
+    }
+
+    ecs_os_memcpy(value, ptr, value_size);
+    slot->cmd.is._1.value = value;
+    slot->cmd.is._1.size = value_size;
+
+    return flecs_cmd_queue_publish(slot);
+error:
+    return false;
+}
+
+bool ecs_cmd_queue_delete(
+    ecs_cmd_queue_t *queue,
+    ecs_entity_t entity)
+{
+    ecs_check(queue != NULL, ECS_INVALID_PARAMETER, NULL);
+    ecs_check(entity != 0, ECS_INVALID_PARAMETER, NULL);
+
+    ecs_cmd_queue_slot_t *slot = flecs_cmd_queue_claim(
+        queue, EcsCmdDelete, entity, 0);
+    if (!slot) {
+        return false;
+    }
+
+    return flecs_cmd_queue_publish(slot);
+error:
+    return false;
+}
+
+bool ecs_cmd_queue_emit(
+    ecs_cmd_queue_t *queue,
+    ecs_entity_t event,
+    ecs_entity_t entity,
+    ecs_id_t id)
+{
+    ecs_check(queue != NULL, ECS_INVALID_PARAMETER, NULL);
+    ecs_check(event != 0, ECS_INVALID_PARAMETER, NULL);
+    ecs_check(entity != 0, ECS_INVALID_PARAMETER, NULL);
+    ecs_check(id != 0, ECS_INVALID_PARAMETER, NULL);
+
+    ecs_cmd_queue_slot_t *slot = flecs_cmd_queue_claim(
+        queue, EcsCmdEvent, entity, id);
+    if (!slot) {
+        return false;
+    }
+
+    slot->event = event;
+
+    return flecs_cmd_queue_publish(slot);
+error:
+    return false;
+}
+
+int32_t ecs_cmd_queue_drain(
+    ecs_world_t *world,
+    ecs_cmd_queue_t *queue)
+{
+    ecs_check(world != NULL, ECS_INVALID_PARAMETER, NULL);
+    ecs_check(queue != NULL, ECS_INVALID_PARAMETER, NULL);
+    ecs_check(ecs_get_world(world) == queue->world,
+        ECS_INVALID_PARAMETER, NULL);
+
+    int32_t count = 0;
+    int64_t index = queue->tail;
+    for (;; index ++) {
+        ecs_cmd_queue_slot_t *slot = &queue->slots[index % queue->capacity];
+        if (flecs_cmd_queue_load(&slot->seq) != (index + 1)) {
+            /* Slot hasn't been published yet */
+            break;
+        }
+
+        /* Increment acts as barrier, so the command isn't read before it was
+         * published. Producers only use tail to test if the queue is full. */
+        ecs_os_lainc(&queue->tail);
+
+        flecs_cmd_queue_apply(world, slot);
+        flecs_cmd_queue_value_free(queue, slot);
+
+        /* Release slot for the next round. The intermediate value is not a
+         * valid index for this slot, so producers keep waiting until the
+         * increment makes the slot available. */
+        slot->seq = index + queue->capacity - 1;
+        ecs_os_lainc(&slot->seq);
+        count ++;
+    }
+
+    return count;
+error:
+    return 0;
+}
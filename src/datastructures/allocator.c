@@ -9,9 +9,10 @@
 
 static
 ecs_size_t flecs_allocator_size(
+    const ecs_allocator_t *a,
     ecs_size_t size)
 {
-    return ECS_ALIGN(size, 16);
+    return ECS_ALIGN(size, a->align);
 }
 
 static
@@ -24,6 +25,14 @@ ecs_size_t flecs_allocator_size_hash(
 void flecs_allocator_init(
     ecs_allocator_t *a)
 {
+    flecs_allocator_init_aligned(a, 16);
+}
+
+void flecs_allocator_init_aligned(
+    ecs_allocator_t *a,
+    ecs_size_t align)
+{
+    a->align = align;
     flecs_ballocator_init_n(&a->chunks, ecs_block_allocator_t,
         FLECS_SPARSE_PAGE_SIZE);
     flecs_sparse_init_t(&a->sizes, NULL, &a->chunks, ecs_block_allocator_t);
@@ -52,8 +61,8 @@ ecs_block_allocator_t* flecs_allocator_get(
     }
 
     ecs_assert(a != NULL, ECS_INTERNAL_ERROR, NULL);
-    ecs_assert(size <= flecs_allocator_size(size), ECS_INTERNAL_ERROR, NULL);
-    size = flecs_allocator_size(size);
+    ecs_assert(size <= flecs_allocator_size(a, size), ECS_INTERNAL_ERROR, NULL);
+    size = flecs_allocator_size(a, size);
     ecs_size_t hash = flecs_allocator_size_hash(size);
     ecs_block_allocator_t *result = flecs_sparse_get_any_t(&a->sizes, 
         ecs_block_allocator_t, (uint32_t)hash);
@@ -61,7 +70,7 @@ ecs_block_allocator_t* flecs_allocator_get(
     if (!result) {
         result = flecs_sparse_ensure_fast_t(&a->sizes, 
             ecs_block_allocator_t, (uint32_t)hash);
-        flecs_ballocator_init(result, size);
+        flecs_ballocator_init_aligned(result, size, a->align);
     }
 
     ecs_assert(result->data_size == size, ECS_INTERNAL_ERROR, NULL);
@@ -15,7 +15,69 @@
 int64_t ecs_block_allocator_alloc_count = 0;
 int64_t ecs_block_allocator_free_count = 0;
 
-#ifndef FLECS_USE_OS_ALLOC
+/* Default alignment of chunks returned by block allocator */
+#define FLECS_BALLOC_ALIGN (16)
+
+/* Round pointer up to alignment */
+static
+void* flecs_balign_ptr(
+    void *ptr,
+    ecs_size_t align)
+{
+    uintptr_t addr = (uintptr_t)ptr;
+    uintptr_t mask = (uintptr_t)align - 1;
+    return (void*)((addr + mask) & ~mask);
+}
+
+#ifdef FLECS_ALLOCATOR_STATS
+static
+void flecs_balloc_stats_alloc(
+    ecs_block_allocator_t *ba)
+{
+    if (++ ba->alloc_count > ba->alloc_count_max) {
+        ba->alloc_count_max = ba->alloc_count;
+    }
+}
+
+#define flecs_balloc_stats_free(ba) ((ba)->alloc_count --)
+#else
+#define flecs_balloc_stats_alloc(ba)
+#define flecs_balloc_stats_free(ba)
+#endif
+
+#ifdef FLECS_USE_OS_ALLOC
+
+/* The OS allocator is not guaranteed to return memory with alignments larger
+ * than the default alignment. Allocate more memory than necessary, and store
+ * the pointer returned by the OS in front of the aligned memory. */
+static
+void* flecs_balloc_os_aligned(
+    ecs_block_allocator_t *ba)
+{
+    void *ptr = ecs_os_malloc(
+        ba->data_size + ba->align + ECS_SIZEOF(void*));
+    void *result = flecs_balign_ptr(
+        ECS_OFFSET(ptr, ECS_SIZEOF(void*)), ba->align);
+    ((void**)result)[-1] = ptr;
+    return result;
+}
+
+#else
+
+#ifdef FLECS_SANITIZE
+/* In sanitized builds each chunk stores the chunk size in a header that is
+ * used to detect memory returned to the wrong allocator. For aligned block
+ * allocators the header is padded to the alignment. */
+static
+ecs_size_t flecs_ballocator_header(
+    const ecs_block_allocator_t *ba)
+{
+    if (ba->align > FLECS_BALLOC_ALIGN) {
+        return ba->align;
+    }
+    return ECS_SIZEOF(int64_t);
+}
+#endif
 
 static
 ecs_block_allocator_chunk_header_t* flecs_balloc_block(
@@ -25,11 +87,16 @@ ecs_block_allocator_chunk_header_t* flecs_balloc_block(
         return NULL;
     }
 
+    ecs_size_t align = allocator->align;
+    ecs_size_t padding = align > FLECS_BALLOC_ALIGN ? align : 0;
     ecs_block_allocator_block_t *block = 
         ecs_os_malloc(ECS_SIZEOF(ecs_block_allocator_block_t) +
-            allocator->block_size);
+            allocator->block_size + padding);
     ecs_block_allocator_chunk_header_t *first_chunk = ECS_OFFSET(block, 
         ECS_SIZEOF(ecs_block_allocator_block_t));
+    if (padding) {
+        first_chunk = flecs_balign_ptr(first_chunk, align);
+    }
 
     block->memory = first_chunk;
     if (!allocator->block_tail) {
@@ -51,6 +118,7 @@ ecs_block_allocator_chunk_header_t* flecs_balloc_block(
     }
 
     ecs_os_linc(&ecs_block_allocator_alloc_count);
+    allocator->block_count ++;
 
     chunk->next = NULL;
     return first_chunk;
@@ -61,19 +129,33 @@ ecs_block_allocator_chunk_header_t* flecs_balloc_block(
 void flecs_ballocator_init(
     ecs_block_allocator_t *ba,
     ecs_size_t size)
+{
+    flecs_ballocator_init_aligned(ba, size, FLECS_BALLOC_ALIGN);
+}
+
+void flecs_ballocator_init_aligned(
+    ecs_block_allocator_t *ba,
+    ecs_size_t size,
+    ecs_size_t align)
 {
     ecs_assert(ba != NULL, ECS_INTERNAL_ERROR, NULL);
     ecs_assert(size != 0, ECS_INTERNAL_ERROR, NULL);
+    ecs_assert(align >= FLECS_BALLOC_ALIGN, ECS_INVALID_PARAMETER, NULL);
+    ecs_assert(!(align & (align - 1)), ECS_INVALID_PARAMETER, NULL);
     ba->data_size = size;
-#ifdef FLECS_SANITIZE
-    size += ECS_SIZEOF(int64_t);
+    ba->align = align;
+#if defined(FLECS_SANITIZE) && !defined(FLECS_USE_OS_ALLOC)
+    size += flecs_ballocator_header(ba);
 #endif
-    ba->chunk_size = ECS_ALIGN(size, 16);
+    ba->chunk_size = ECS_ALIGN(size, align);
     ba->chunks_per_block = ECS_MAX(4096 / ba->chunk_size, 1);
     ba->block_size = ba->chunks_per_block * ba->chunk_size;
     ba->head = NULL;
     ba->block_head = NULL;
     ba->block_tail = NULL;
+    ba->block_count = 0;
+    ba->alloc_count = 0;
+    ba->alloc_count_max = 0;
 }
 
 ecs_block_allocator_t* flecs_ballocator_new(
@@ -102,6 +184,7 @@ void flecs_ballocator_fini(
         block = next;
     }
     ba->block_head = NULL;
+    ba->block_count = 0;
 }
 
 void flecs_ballocator_free(
@@ -116,7 +199,12 @@ void* flecs_balloc(
 {
     void *result;
 #ifdef FLECS_USE_OS_ALLOC
-    result = ecs_os_malloc(ba->data_size);
+    if (ba->align > FLECS_BALLOC_ALIGN) {
+        result = flecs_balloc_os_aligned(ba);
+    } else {
+        result = ecs_os_malloc(ba->data_size);
+    }
+    flecs_balloc_stats_alloc(ba);
 #else
 
     if (!ba) return NULL;
@@ -127,12 +215,12 @@ void* flecs_balloc(
 
     result = ba->head;
     ba->head = ba->head->next;
+    flecs_balloc_stats_alloc(ba);
 
 #ifdef FLECS_SANITIZE
-    ecs_assert(ba->alloc_count >= 0, ECS_INTERNAL_ERROR, "corrupted allocator");
-    ba->alloc_count ++;
+    ecs_assert(ba->alloc_count > 0, ECS_INTERNAL_ERROR, "corrupted allocator");
     *(int64_t*)result = ba->chunk_size;
-    result = ECS_OFFSET(result, ECS_SIZEOF(int64_t));
+    result = ECS_OFFSET(result, flecs_ballocator_header(ba));
 #endif
 #endif
 
@@ -147,6 +235,12 @@ void* flecs_bcalloc(
     ecs_block_allocator_t *ba) 
 {
 #ifdef FLECS_USE_OS_ALLOC
+    flecs_balloc_stats_alloc(ba);
+    if (ba->align > FLECS_BALLOC_ALIGN) {
+        void *result = flecs_balloc_os_aligned(ba);
+        ecs_os_memset(result, 0, ba->data_size);
+        return result;
+    }
     return ecs_os_calloc(ba->data_size);
 #else
     if (!ba) return NULL;
@@ -161,7 +255,12 @@ void flecs_bfree(
     void *memory) 
 {
 #ifdef FLECS_USE_OS_ALLOC
-    (void)ba;
+    if (memory && ba) {
+        flecs_balloc_stats_free(ba);
+        if (ba->align > FLECS_BALLOC_ALIGN) {
+            memory = ((void**)memory)[-1];
+        }
+    }
     ecs_os_free(memory);
     return;
 #else
@@ -175,17 +274,17 @@ void flecs_bfree(
     }
 
 #ifdef FLECS_SANITIZE
-    memory = ECS_OFFSET(memory, -ECS_SIZEOF(int64_t));
+    memory = ECS_OFFSET(memory, -flecs_ballocator_header(ba));
     if (*(int64_t*)memory != ba->chunk_size) {
         ecs_err("chunk %p returned to wrong allocator "
             "(chunk = %ub, allocator = %ub)",
                 memory, *(int64_t*)memory, ba->chunk_size);
         ecs_abort(ECS_INTERNAL_ERROR, NULL);
     }
-
-    ba->alloc_count --;
 #endif
 
+    flecs_balloc_stats_free(ba);
+
     ecs_block_allocator_chunk_header_t *chunk = memory;
     chunk->next = ba->head;
     ba->head = chunk;
@@ -200,8 +299,22 @@ void* flecs_brealloc(
 {
     void *result;
 #ifdef FLECS_USE_OS_ALLOC
-    (void)src;
-    result = ecs_os_realloc(memory, dst->data_size);
+    if ((dst && dst->align > FLECS_BALLOC_ALIGN) || 
+        (src && src->align > FLECS_BALLOC_ALIGN)) 
+    {
+        result = dst ? flecs_balloc(dst) : NULL;
+        if (result && src && memory) {
+            ecs_os_memcpy(result, memory, 
+                ECS_MIN(src->data_size, dst->data_size));
+        }
+        flecs_bfree(src, memory);
+    } else {
+        result = ecs_os_realloc(memory, dst->data_size);
+        flecs_balloc_stats_alloc(dst);
+        if (memory && src) {
+            flecs_balloc_stats_free(src);
+        }
+    }
 #else
     if (dst == src) {
         return memory;
@@ -235,6 +348,12 @@ void* flecs_bdup(
 {
 #ifdef FLECS_USE_OS_ALLOC
     if (memory && ba->chunk_size) {
+        if (ba->align > FLECS_BALLOC_ALIGN) {
+            void *result = flecs_balloc(ba);
+            ecs_os_memcpy(result, memory, ba->data_size);
+            return result;
+        }
+        flecs_balloc_stats_alloc(ba);
         return ecs_os_memdup(memory, ba->data_size);
     } else {
         return NULL;
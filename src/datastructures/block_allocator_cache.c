@@ -0,0 +1,242 @@
+/**
+ * @file datastructures/block_allocator_cache.c
+ * @brief Magazine caches for block allocators.
+ *
+ * Block allocators are not thread safe. To let multiple threads allocate
+ * chunks of the same size without going to the OS allocator, a block allocator
+ * can be wrapped in a depot, which hands out chunks in magazines (fixed size
+ * arrays of chunks). Each thread gets a cache that holds a loaded and a
+ * previous magazine, and only synchronizes with the depot when both magazines
+ * are exhausted (on alloc) or full (on free).
+ *
+ * Magazines are recycled by the depot, so once a workload has warmed up the
+ * caches no longer call into the OS allocator.
+ */
+
+#include "../private_api.h"
+
+static
+void flecs_balloc_depot_lock(
+    ecs_balloc_depot_t *depot)
+{
+    if (depot->lock) {
+        ecs_os_mutex_lock(depot->lock);
+    }
+}
+
+static
+void flecs_balloc_depot_unlock(
+    ecs_balloc_depot_t *depot)
+{
+    if (depot->lock) {
+        ecs_os_mutex_unlock(depot->lock);
+    }
+}
+
+static
+ecs_balloc_magazine_t* flecs_balloc_magazine_pop(
+    ecs_balloc_magazine_t **list,
+    int32_t *count)
+{
+    ecs_balloc_magazine_t *result = *list;
+    if (result) {
+        *list = result->next;
+        result->next = NULL;
+        (*count) --;
+    }
+    return result;
+}
+
+static
+void flecs_balloc_magazine_push(
+    ecs_balloc_magazine_t **list,
+    int32_t *count,
+    ecs_balloc_magazine_t *mag)
+{
+    mag->next = *list;
+    *list = mag;
+    (*count) ++;
+}
+
+/* Must be called while holding the depot lock */
+static
+ecs_balloc_magazine_t* flecs_balloc_depot_empty(
+    ecs_balloc_depot_t *depot)
+{
+    ecs_balloc_magazine_t *result = flecs_balloc_magazine_pop(
+        &depot->empty, &depot->empty_count);
+    if (!result) {
+        result = ecs_os_malloc_t(ecs_balloc_magazine_t);
+        result->next = NULL;
+        result->count = 0;
+    }
+    return result;
+}
+
+void flecs_balloc_depot_init(
+    ecs_balloc_depot_t *depot,
+    ecs_size_t size)
+{
+    ecs_os_zeromem(depot);
+    flecs_ballocator_init(&depot->ba, size);
+    if (ecs_os_has_threading()) {
+        depot->lock = ecs_os_mutex_new();
+    }
+}
+
+void flecs_balloc_depot_fini(
+    ecs_balloc_depot_t *depot)
+{
+    ecs_balloc_magazine_t *mag;
+    while ((mag = flecs_balloc_magazine_pop(
+        &depot->full, &depot->full_count)))
+    {
+        int32_t i;
+        for (i = 0; i < mag->count; i ++) {
+            flecs_bfree(&depot->ba, mag->chunks[i]);
+        }
+        ecs_os_free(mag);
+    }
+
+    while ((mag = flecs_balloc_magazine_pop(
+        &depot->empty, &depot->empty_count)))
+    {
+        ecs_assert(mag->count == 0, ECS_INTERNAL_ERROR, NULL);
+        ecs_os_free(mag);
+    }
+
+    flecs_ballocator_fini(&depot->ba);
+
+    if (depot->lock) {
+        ecs_os_mutex_free(depot->lock);
+        depot->lock = 0;
+    }
+}
+
+void flecs_balloc_cache_init(
+    ecs_balloc_cache_t *cache,
+    ecs_balloc_depot_t *depot)
+{
+    ecs_assert(depot != NULL, ECS_INVALID_PARAMETER, NULL);
+    cache->depot = depot;
+    cache->loaded = NULL;
+    cache->previous = NULL;
+}
+
+static
+void flecs_balloc_cache_return(
+    ecs_balloc_depot_t *depot,
+    ecs_balloc_magazine_t *mag)
+{
+    if (!mag) {
+        return;
+    }
+
+    if (mag->count == FLECS_BALLOC_MAGAZINE_SIZE) {
+        flecs_balloc_magazine_push(&depot->full, &depot->full_count, mag);
+    } else {
+        /* Partially filled magazines can't be handed out as full magazines, so
+         * give their chunks back to the block allocator. */
+        int32_t i;
+        for (i = 0; i < mag->count; i ++) {
+            flecs_bfree(&depot->ba, mag->chunks[i]);
+        }
+        mag->count = 0;
+        flecs_balloc_magazine_push(&depot->empty, &depot->empty_count, mag);
+    }
+}
+
+void flecs_balloc_cache_fini(
+    ecs_balloc_cache_t *cache)
+{
+    ecs_balloc_depot_t *depot = cache->depot;
+    if (!depot) {
+        return;
+    }
+
+    flecs_balloc_depot_lock(depot);
+    flecs_balloc_cache_return(depot, cache->loaded);
+    flecs_balloc_cache_return(depot, cache->previous);
+    flecs_balloc_depot_unlock(depot);
+
+    cache->loaded = NULL;
+    cache->previous = NULL;
+}
+
+void* flecs_balloc_cache_alloc(
+    ecs_balloc_cache_t *cache)
+{
+    ecs_balloc_magazine_t *loaded = cache->loaded;
+    if (loaded && loaded->count) {
+        return loaded->chunks[-- loaded->count];
+    }
+
+    ecs_balloc_magazine_t *previous = cache->previous;
+    if (previous && previous->count) {
+        cache->previous = loaded;
+        cache->loaded = previous;
+        return previous->chunks[-- previous->count];
+    }
+
+    /* Both magazines are empty, exchange with depot */
+    ecs_balloc_depot_t *depot = cache->depot;
+    flecs_balloc_depot_lock(depot);
+    ecs_balloc_magazine_t *full = flecs_balloc_magazine_pop(
+        &depot->full, &depot->full_count);
+    if (full) {
+        if (previous) {
+            flecs_balloc_magazine_push(
+                &depot->empty, &depot->empty_count, previous);
+        }
+        cache->previous = loaded;
+        cache->loaded = loaded = full;
+    } else {
+        /* Depot has no full magazines, refill from block allocator */
+        if (!loaded) {
+            cache->loaded = loaded = flecs_balloc_depot_empty(depot);
+        }
+        int32_t i;
+        for (i = 0; i < FLECS_BALLOC_MAGAZINE_SIZE; i ++) {
+            loaded->chunks[i] = flecs_balloc(&depot->ba);
+        }
+        loaded->count = FLECS_BALLOC_MAGAZINE_SIZE;
+    }
+    flecs_balloc_depot_unlock(depot);
+
+    return loaded->chunks[-- loaded->count];
+}
+
+void flecs_balloc_cache_free(
+    ecs_balloc_cache_t *cache,
+    void *memory)
+{
+    if (!memory) {
+        return;
+    }
+
+    ecs_balloc_magazine_t *loaded = cache->loaded;
+    if (loaded && loaded->count < FLECS_BALLOC_MAGAZINE_SIZE) {
+        loaded->chunks[loaded->count ++] = memory;
+        return;
+    }
+
+    ecs_balloc_magazine_t *previous = cache->previous;
+    if (previous && previous->count < FLECS_BALLOC_MAGAZINE_SIZE) {
+        cache->previous = loaded;
+        cache->loaded = previous;
+        previous->chunks[previous->count ++] = memory;
+        return;
+    }
+
+    /* Both magazines are full, hand one to the depot for other threads */
+    ecs_balloc_depot_t *depot = cache->depot;
+    flecs_balloc_depot_lock(depot);
+    if (previous) {
+        flecs_balloc_magazine_push(&depot->full, &depot->full_count, previous);
+    }
+    cache->previous = loaded;
+    cache->loaded = loaded = flecs_balloc_depot_empty(depot);
+    flecs_balloc_depot_unlock(depot);
+
+    loaded->chunks[loaded->count ++] = memory;
+}
@@ -0,0 +1,65 @@
+/**
+ * @file datastructures/block_allocator_cache.h
+ * @brief Magazine caches for block allocators.
+ */
+
+#ifndef FLECS_BLOCK_ALLOCATOR_CACHE_H
+#define FLECS_BLOCK_ALLOCATOR_CACHE_H
+
+/** Number of chunks that fit in a single magazine */
+#define FLECS_BALLOC_MAGAZINE_SIZE (32)
+
+typedef struct ecs_balloc_magazine_t {
+    struct ecs_balloc_magazine_t *next;
+    int32_t count;
+    void *chunks[FLECS_BALLOC_MAGAZINE_SIZE];
+} ecs_balloc_magazine_t;
+
+/* A depot owns a block allocator and can be shared between threads. Chunks are
+ * exchanged with the depot in full magazines, so the lock is only taken once
+ * per FLECS_BALLOC_MAGAZINE_SIZE allocations or frees. */
+typedef struct ecs_balloc_depot_t {
+    ecs_block_allocator_t ba;
+    ecs_os_mutex_t lock;
+    ecs_balloc_magazine_t *full;     /* Magazines with count == SIZE */
+    ecs_balloc_magazine_t *empty;    /* Magazines with count == 0 */
+    int32_t full_count;
+    int32_t empty_count;
+} ecs_balloc_depot_t;
+
+/* A cache is owned by a single thread (or stage) and holds two magazines, which
+ * absorbs alternating alloc/free patterns without going to the depot. */
+typedef struct ecs_balloc_cache_t {
+    ecs_balloc_depot_t *depot;
+    ecs_balloc_magazine_t *loaded;
+    ecs_balloc_magazine_t *previous;
+} ecs_balloc_cache_t;
+
+FLECS_DBG_API
+void flecs_balloc_depot_init(
+    ecs_balloc_depot_t *depot,
+    ecs_size_t size);
+
+FLECS_DBG_API
+void flecs_balloc_depot_fini(
+    ecs_balloc_depot_t *depot);
+
+FLECS_DBG_API
+void flecs_balloc_cache_init(
+    ecs_balloc_cache_t *cache,
+    ecs_balloc_depot_t *depot);
+
+FLECS_DBG_API
+void flecs_balloc_cache_fini(
+    ecs_balloc_cache_t *cache);
+
+FLECS_DBG_API
+void* flecs_balloc_cache_alloc(
+    ecs_balloc_cache_t *cache);
+
+FLECS_DBG_API
+void flecs_balloc_cache_free(
+    ecs_balloc_cache_t *cache,
+    void *memory);
+
+#endif
@@ -58,7 +58,8 @@ ecs_page_t* flecs_sparse_page_new(
                      : ecs_os_calloc(sparse->size * FLECS_SPARSE_PAGE_SIZE);
 
     ecs_assert(result->sparse != NULL, ECS_INTERNAL_ERROR, NULL);
-    ecs_assert(result->data != NULL, ECS_INTERNAL_ERROR, NULL);
+    ecs_assert(!sparse->size || result->data != NULL, 
+        ECS_INTERNAL_ERROR, NULL);
 
     return result;
 }
@@ -489,6 +490,38 @@ void flecs_sparse_remove(
     }
 }
 
+void flecs_sparse_remove_fast(
+    ecs_sparse_t *sparse,
+    ecs_size_t size,
+    uint64_t index)
+{
+    ecs_assert(sparse != NULL, ECS_INVALID_PARAMETER, NULL);
+    ecs_assert(!size || size == sparse->size, ECS_INVALID_PARAMETER, NULL);
+    (void)size;
+
+    flecs_sparse_strip_generation(&index);
+    ecs_page_t *page = flecs_sparse_get_page(sparse, PAGE(index));
+    if (!page || !page->sparse) {
+        return;
+    }
+
+    int32_t offset = OFFSET(index);
+    int32_t dense = page->sparse[offset];
+    int32_t count = sparse->count;
+    if (!dense || (dense >= count)) {
+        /* Element is not alive, nothing to be done */
+        return;
+    }
+
+    /* Unlike flecs_sparse_remove, don't increase the generation so the index
+     * can be added again with the same id. */
+    if (dense != (count - 1)) {
+        flecs_sparse_swap_dense(sparse, page, dense, count - 1);
+    }
+
+    sparse->count --;
+}
+
 void* flecs_sparse_get_dense(
     const ecs_sparse_t *sparse,
     ecs_size_t size,
@@ -505,6 +538,21 @@ void* flecs_sparse_get_dense(
     return flecs_sparse_get_sparse(sparse, dense_index, dense_array[dense_index]);
 }
 
+bool flecs_sparse_has(
+    const ecs_sparse_t *sparse,
+    uint64_t index)
+{
+    ecs_assert(sparse != NULL, ECS_INVALID_PARAMETER, NULL);
+    flecs_sparse_strip_generation(&index);
+    ecs_page_t *page = flecs_sparse_get_page(sparse, PAGE(index));
+    if (!page || !page->sparse) {
+        return false;
+    }
+
+    int32_t dense = page->sparse[OFFSET(index)];
+    return dense && (dense < sparse->count);
+}
+
 bool flecs_sparse_is_alive(
     const ecs_sparse_t *sparse,
     uint64_t index)
@@ -12,15 +12,38 @@
 
 #include "../private_api.h"
 
-#define FLECS_STACK_PAGE_OFFSET ECS_ALIGN(ECS_SIZEOF(ecs_stack_page_t), 16)
-
 int64_t ecs_stack_allocator_alloc_count = 0;
 int64_t ecs_stack_allocator_free_count = 0;
 
 static
-ecs_stack_page_t* flecs_stack_page_new(uint32_t page_id) {
-    ecs_stack_page_t *result = ecs_os_malloc(
-        FLECS_STACK_PAGE_OFFSET + ECS_STACK_PAGE_SIZE);
+void* flecs_stack_page_alloc(
+    ecs_stack_t *stack)
+{
+    if (stack->cache) {
+        return flecs_balloc_cache_alloc(stack->cache);
+    } else {
+        return ecs_os_malloc(FLECS_STACK_PAGE_ALLOC_SIZE);
+    }
+}
+
+static
+void flecs_stack_page_free(
+    ecs_stack_t *stack,
+    void *page)
+{
+    if (stack->cache) {
+        flecs_balloc_cache_free(stack->cache, page);
+    } else {
+        ecs_os_free(page);
+    }
+}
+
+static
+ecs_stack_page_t* flecs_stack_page_new(
+    ecs_stack_t *stack,
+    uint32_t page_id)
+{
+    ecs_stack_page_t *result = flecs_stack_page_alloc(stack);
     result->data = ECS_OFFSET(result, FLECS_STACK_PAGE_OFFSET);
     result->next = NULL;
     result->id = page_id + 1;
@@ -35,7 +58,7 @@ void* flecs_stack_alloc(
 {
     ecs_stack_page_t *page = stack->tail_page;
     if (page == &stack->first && !page->data) {
-        page->data = ecs_os_malloc(ECS_STACK_PAGE_SIZE);
+        page->data = flecs_stack_page_alloc(stack);
         ecs_os_linc(&ecs_stack_allocator_alloc_count);
     }
 
@@ -52,7 +75,7 @@ void* flecs_stack_alloc(
         if (page->next) {
             page = page->next;
         } else {
-            page = page->next = flecs_stack_page_new(page->id);
+            page = page->next = flecs_stack_page_new(stack, page->id);
         }
         sp = 0;
         next_sp = flecs_ito(int16_t, size);
@@ -162,10 +185,18 @@ void flecs_stack_reset(
 
 void flecs_stack_init(
     ecs_stack_t *stack)
+{
+    flecs_stack_init_w_cache(stack, NULL);
+}
+
+void flecs_stack_init_w_cache(
+    ecs_stack_t *stack,
+    ecs_balloc_cache_t *cache)
 {
     ecs_os_zeromem(stack);
     stack->tail_page = &stack->first;
     stack->first.data = NULL;
+    stack->cache = cache;
 }
 
 void flecs_stack_fini(
@@ -181,11 +212,11 @@ void flecs_stack_fini(
         if (cur == &stack->first) {
             if (cur->data) {
                 ecs_os_linc(&ecs_stack_allocator_free_count);
+                flecs_stack_page_free(stack, cur->data);
             }
-            ecs_os_free(cur->data);
         } else {
             ecs_os_linc(&ecs_stack_allocator_free_count);
-            ecs_os_free(cur);
+            flecs_stack_page_free(stack, cur);
         }
     } while ((cur = next));
 }
@@ -16,10 +16,16 @@ typedef struct ecs_stack_page_t {
     uint32_t id;
 } ecs_stack_page_t;
 
+/* Pages are allocated with the page header in front of the page data */
+#define FLECS_STACK_PAGE_OFFSET ECS_ALIGN(ECS_SIZEOF(ecs_stack_page_t), 16)
+#define FLECS_STACK_PAGE_ALLOC_SIZE\
+    (FLECS_STACK_PAGE_OFFSET + ECS_STACK_PAGE_SIZE)
+
 typedef struct ecs_stack_t {
     ecs_stack_page_t first;
     ecs_stack_page_t *tail_page;
     ecs_stack_cursor_t *tail_cursor;
+    ecs_balloc_cache_t *cache;   /* Optional page cache, uses OS if NULL */
 #ifdef FLECS_DEBUG
     int32_t cursor_count;
 #endif
@@ -29,6 +35,13 @@ FLECS_DBG_API
 void flecs_stack_init(
     ecs_stack_t *stack);
 
+/* Initialize stack that gets its pages from a (thread local) page cache. The
+ * cache must have a depot with chunks of FLECS_STACK_PAGE_ALLOC_SIZE. */
+FLECS_DBG_API
+void flecs_stack_init_w_cache(
+    ecs_stack_t *stack,
+    ecs_balloc_cache_t *cache);
+
 FLECS_DBG_API
 void flecs_stack_fini(
     ecs_stack_t *stack);
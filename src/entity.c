@@ -542,6 +542,10 @@ void flecs_notify_on_add(
             flecs_set_union(world, table, row, count, added);
         }
 
+        if (table_flags & EcsTableHasPairs) {
+            flecs_id_record_trav_invalidate(world, added);
+        }
+
         if (table_flags & (EcsTableHasOnAdd|EcsTableHasIsA|EcsTableHasTraversable)) {
             flecs_emit(world, world, &(ecs_event_desc_t){
                 .event = EcsOnAdd,
@@ -568,6 +572,10 @@ void flecs_notify_on_remove(
     ecs_assert(removed != NULL, ECS_INTERNAL_ERROR, NULL);
     ecs_assert(count != 0, ECS_INTERNAL_ERROR, NULL);
 
+    if (removed->count && (table->flags & EcsTableHasPairs)) {
+        flecs_id_record_trav_invalidate(world, removed);
+    }
+
     if (removed->count && (table->flags & 
         (EcsTableHasOnRemove|EcsTableHasUnSet|EcsTableHasIsA|EcsTableHasTraversable))) 
     {
@@ -832,6 +840,83 @@ error:
     return;
 }
 
+/* Commit a range of entities in a table to a new table. Instead of moving the
+ * entities one by one, the range is moved with a single copy per column and a
+ * single event per range. */
+static
+void flecs_commit_range(
+    ecs_world_t *world,
+    ecs_table_t *src_table,
+    int32_t offset,
+    int32_t count,
+    ecs_table_t *dst_table,
+    ecs_table_diff_t *diff)
+{
+    ecs_assert(!(world->flags & EcsWorldReadonly), ECS_INTERNAL_ERROR, NULL);
+    ecs_assert(src_table != NULL, ECS_INTERNAL_ERROR, NULL);
+    ecs_assert(dst_table != NULL, ECS_INTERNAL_ERROR, NULL);
+
+    if (src_table == dst_table) {
+        /* Union relationships can change without changing the table */
+        if (diff->added.count) {
+            flecs_notify_on_add(world, src_table, src_table, offset, count,
+                &diff->added, 0);
+        }
+        return;
+    }
+
+    bool whole_table = !offset && (count == ecs_table_count(src_table));
+    if ((!whole_table || !dst_table->type.count) &&
+        ((src_table->flags | dst_table->flags) &
+            (EcsTableHasUnion|EcsTableHasToggle)))
+    {
+        /* Ranges of union & toggle columns can't be moved in bulk. Move
+         * entities one by one, starting from the end of the range so that
+         * entities that fill up the gaps are never part of the range. */
+        int32_t i;
+        for (i = count - 1; i >= 0; i --) {
+            ecs_entity_t e = ecs_vec_get_t(&src_table->data.entities,
+                ecs_entity_t, offset + i)[0];
+            ecs_record_t *r = flecs_entities_get(world, e);
+            flecs_commit(world, e, r, dst_table, diff, true, 0);
+        }
+        return;
+    }
+
+    bool is_trav = src_table->_->traversable_count != 0;
+
+    flecs_notify_on_remove(
+        world, src_table, dst_table, offset, count, &diff->removed);
+
+    if (dst_table->type.count) {
+        int32_t dst_row = flecs_table_move_range(
+            world, dst_table, src_table, offset, count, true);
+        flecs_notify_on_add(
+            world, dst_table, src_table, dst_row, count, &diff->added, 0);
+        flecs_update_name_index(world, src_table, dst_table, dst_row, count);
+    } else {
+        /* All components are removed, entities no longer have a table */
+        ecs_entity_t *entities = flecs_walloc_n(world, ecs_entity_t, count);
+        ecs_os_memcpy_n(entities, ecs_vec_get_t(&src_table->data.entities,
+            ecs_entity_t, offset), ecs_entity_t, count);
+
+        flecs_table_delete_range(world, src_table, offset, count, true);
+
+        int32_t i, traversable = 0;
+        for (i = 0; i < count; i ++) {
+            ecs_record_t *r = flecs_entities_get(world, entities[i]);
+            traversable += (r->row & EcsEntityIsTraversable) != 0;
+            r->table = NULL;
+        }
+        flecs_table_traversable_add(src_table, -traversable);
+        flecs_wfree_n(world, ecs_entity_t, count, entities);
+    }
+
+    if (is_trav) {
+        flecs_update_component_monitors(world, &diff->added, &diff->removed);
+    }
+}
+
 static
 const ecs_entity_t* flecs_bulk_new(
     ecs_world_t *world,
@@ -963,6 +1048,116 @@ void flecs_add_id_w_record(
                            * functions that are about to set the component. */
 }
 
+static
+ecs_id_record_t* flecs_sparse_id_record(
+    const ecs_world_t *world,
+    ecs_id_t id)
+{
+    if (!ecs_vec_count(&world->sparse_ids)) {
+        return NULL;
+    }
+
+    ecs_id_record_t *idr = flecs_id_record_get(world, id);
+    if (idr && (idr->flags & EcsIdSparse)) {
+        return idr;
+    }
+
+    return NULL;
+}
+
+static
+void* flecs_add_sparse(
+    ecs_world_t *world,
+    ecs_entity_t entity,
+    ecs_record_t *r,
+    ecs_id_record_t *idr,
+    bool construct)
+{
+    if (flecs_id_record_sparse_has(idr, entity)) {
+        return flecs_id_record_sparse_get(idr, entity);
+    }
+
+    void *ptr = flecs_id_record_sparse_insert(world, idr, entity);
+    flecs_record_add_flag(r, EcsEntityHasSparse);
+
+    const ecs_type_info_t *ti = idr->type_info;
+    if (ti) {
+        if (construct) {
+            ecs_xtor_t ctor = ti->hooks.ctor;
+            if (ctor) {
+                ctor(ptr, 1, ti);
+            } else {
+                ecs_os_memset(ptr, 0, ti->size);
+            }
+        }
+
+        ecs_iter_action_t on_add = ti->hooks.on_add;
+        if (on_add) {
+            flecs_invoke_hook(world, NULL, 1, 0, &entity, ptr, idr->id, ti, 
+                EcsOnAdd, on_add);
+        }
+    }
+
+    return ptr;
+}
+
+static
+void flecs_remove_sparse(
+    ecs_world_t *world,
+    ecs_entity_t entity,
+    ecs_id_record_t *idr)
+{
+    if (!flecs_id_record_sparse_has(idr, entity)) {
+        return;
+    }
+
+    const ecs_type_info_t *ti = idr->type_info;
+    if (ti) {
+        void *ptr = flecs_id_record_sparse_get(idr, entity);
+        ecs_iter_action_t on_remove = ti->hooks.on_remove;
+        if (on_remove) {
+            flecs_invoke_hook(world, NULL, 1, 0, &entity, ptr, idr->id, ti, 
+                EcsOnRemove, on_remove);
+        }
+
+        ecs_xtor_t dtor = ti->hooks.dtor;
+        if (dtor) {
+            dtor(ptr, 1, ti);
+        }
+    }
+
+    flecs_id_record_sparse_remove(idr, entity);
+}
+
+static
+void flecs_on_set_sparse(
+    ecs_world_t *world,
+    ecs_entity_t entity,
+    ecs_id_record_t *idr,
+    void *ptr)
+{
+    const ecs_type_info_t *ti = idr->type_info;
+    if (ti) {
+        ecs_iter_action_t on_set = ti->hooks.on_set;
+        if (on_set) {
+            flecs_invoke_hook(world, NULL, 1, 0, &entity, ptr, idr->id, ti, 
+                EcsOnSet, on_set);
+        }
+    }
+}
+
+void flecs_entity_remove_sparse(
+    ecs_world_t *world,
+    ecs_entity_t entity)
+{
+    ecs_vec_t *ids = &world->sparse_ids;
+    int32_t i;
+    for (i = 0; i < ecs_vec_count(ids); i ++) {
+        ecs_id_record_t *idr = ecs_vec_get_t(ids, ecs_id_record_t*, i)[0];
+        flecs_remove_sparse(world, entity, idr);
+    }
+}
+
 static
 void flecs_add_id(
     ecs_world_t *world,
@@ -976,6 +1171,14 @@ void flecs_add_id(
 
     ecs_record_t *r = flecs_entities_get(world, entity);
     ecs_assert(r != NULL, ECS_INTERNAL_ERROR, NULL);
+
+    ecs_id_record_t *idr = flecs_sparse_id_record(world, id);
+    if (idr) {
+        flecs_add_sparse(world, entity, r, idr, true);
+        flecs_defer_end(world, stage);
+        return;
+    }
+
     ecs_table_diff_t diff = ECS_TABLE_DIFF_INIT;
     ecs_table_t *src_table = r->table;
     ecs_table_t *dst_table = flecs_table_traverse_add(
@@ -999,6 +1202,14 @@ void flecs_remove_id(
 
     ecs_record_t *r = flecs_entities_get(world, entity);
     ecs_assert(r != NULL, ECS_INTERNAL_ERROR, NULL);
+
+    ecs_id_record_t *idr = flecs_sparse_id_record(world, id);
+    if (idr) {
+        flecs_remove_sparse(world, entity, idr);
+        flecs_defer_end(world, stage);
+        return;
+    }
+
     ecs_table_t *src_table = r->table;
     ecs_table_diff_t diff = ECS_TABLE_DIFF_INIT;
     ecs_table_t *dst_table = flecs_table_traverse_remove(
@@ -1024,6 +1235,15 @@ flecs_component_ptr_t flecs_ensure(
     ecs_check((id & ECS_COMPONENT_MASK) == id || 
         ECS_HAS_ID_FLAG(id, PAIR), ECS_INVALID_PARAMETER, NULL);
 
+    ecs_id_record_t *idr = flecs_sparse_id_record(world, id);
+    if (idr) {
+        ecs_check(idr->type_info != NULL, ECS_INVALID_PARAMETER, 
+            "cannot get pointer to sparse tag");
+        dst.ptr = flecs_add_sparse(world, entity, r, idr, true);
+        dst.ti = idr->type_info;
+        return dst;
+    }
+
     if (r->table) {
         dst = flecs_get_component_ptr(
             world, r->table, ECS_RECORD_TO_ROW(r->row), id);
@@ -1346,6 +1566,9 @@ ecs_entity_t ecs_new_w_id(
         ecs_table_diff_builder_t diff = ECS_TABLE_DIFF_INIT;
         flecs_table_diff_builder_init(world, &diff);
         for (i = 0; i < count; i ++) {
+            if (flecs_sparse_id_record(world, to_add.array[i])) {
+                continue;
+            }
             table = flecs_find_table_add(
                 world, table, to_add.array[i], &diff);
         }
@@ -1355,6 +1578,14 @@ ecs_entity_t ecs_new_w_id(
         ecs_record_t *r = flecs_entities_get(world, entity);
         flecs_new_entity(world, entity, r, table, &table_diff, true, true);
         flecs_table_diff_builder_fini(world, &diff);
+
+        for (i = 0; i < count; i ++) {
+            ecs_id_record_t *idr = flecs_sparse_id_record(
+                world, to_add.array[i]);
+            if (idr) {
+                flecs_add_sparse(world, entity, r, idr, true);
+            }
+        }
     } else {
         if (flecs_defer_cmd(stage)) {
             return entity;
@@ -1534,8 +1765,14 @@ int flecs_traverse_add(
     int32_t i = 0;
     ecs_id_t id;
     const ecs_id_t *ids = desc->add;
+    bool has_sparse = false;
     while ((i < FLECS_ID_DESC_MAX) && (id = ids[i ++])) {
         bool should_add = true;
+        if (flecs_sparse_id_record(world, id)) {
+            /* Sparse components are added after the entity is committed */
+            has_sparse = true;
+            continue;
+        }
         if (ECS_HAS_ID_FLAG(id, PAIR) && ECS_PAIR_FIRST(id) == EcsChildOf) {
             scope = ECS_PAIR_SECOND(id);
             if ((!desc->id && desc->name) || (name && !name_assigned)) {
@@ -1589,6 +1826,16 @@ int flecs_traverse_add(
         flecs_defer_end(world, &world->stages[0]);
     }
 
+    if (has_sparse) {
+        i = 0;
+        while ((i < FLECS_ID_DESC_MAX) && (id = ids[i ++])) {
+            ecs_id_record_t *idr = flecs_sparse_id_record(world, id);
+            if (idr) {
+                flecs_add_sparse(world, result, r, idr, true);
+            }
+        }
+    }
+
     /* Set name */
     if (name && !name_assigned) {
         ecs_add_path_w_sep(world, result, scope, name, sep, root_sep);
@@ -1878,6 +2125,8 @@ const ecs_entity_t* ecs_bulk_init(
         int32_t i = 0;
         ecs_id_t id;
         while ((id = desc->ids[i])) {
+            ecs_check(!flecs_sparse_id_record(world, id), ECS_INVALID_PARAMETER,
+                "sparse components cannot be added with bulk_init");
             table = flecs_find_table_add(world, table, id, &diff);
             i ++;
         }
@@ -2072,7 +2321,12 @@ void ecs_clear(
         if (r->row & EcsEntityIsTraversable) {
             flecs_table_traversable_add(table, -1);
         }
-    }    
+    }
+
+    if (r->row & EcsEntityHasSparse) {
+        flecs_entity_remove_sparse(world, entity);
+        r->row &= ~EcsEntityHasSparse;
+    }
 
     flecs_defer_end(world, stage);
 error:
@@ -2511,6 +2765,52 @@ bool flecs_on_delete_clear_ids(
     return true;
 }
 
+/* Sparse components aren't stored in tables, so the table-based cleanup below
+ * won't find them. Apply the cleanup action to each entity directly. */
+static
+void flecs_on_delete_sparse(
+    ecs_world_t *world,
+    ecs_id_record_t *idr,
+    ecs_entity_t action)
+{
+    ecs_sparse_t *sparse = idr->sparse;
+    int32_t i, count = flecs_sparse_count(sparse);
+    if (!count) {
+        return;
+    }
+
+    if (!action) {
+        action = ECS_ID_ON_DELETE(idr->flags);
+    }
+
+    if (action == EcsPanic) {
+        flecs_throw_invalid_delete(world, idr->id);
+        return;
+    }
+
+    /* Copy ids, as removing components changes the order of the storage */
+    ecs_allocator_t *a = &world->allocator;
+    ecs_vec_t ids;
+    ecs_vec_init_t(a, &ids, uint64_t, count);
+    ecs_os_memcpy_n(ecs_vec_grow_t(a, &ids, uint64_t, count), 
+        flecs_sparse_ids(sparse), uint64_t, count);
+
+    uint64_t *ids_arr = ecs_vec_first_t(&ids, uint64_t);
+    for (i = 0; i < count; i ++) {
+        ecs_entity_t e = flecs_entities_get_alive(world, ids_arr[i]);
+        if (!e) {
+            continue;
+        }
+
+        flecs_remove_sparse(world, e, idr);
+        if (action == EcsDelete) {
+            ecs_delete(world, e);
+        }
+    }
+
+    ecs_vec_fini_t(a, &ids, uint64_t);
+}
+
 static
 void flecs_on_delete(
     ecs_world_t *world,
@@ -2518,6 +2818,11 @@ void flecs_on_delete(
     ecs_entity_t action,
     bool delete_id)
 {
+    ecs_id_record_t *sparse_idr = flecs_sparse_id_record(world, id);
+    if (sparse_idr && sparse_idr->sparse) {
+        flecs_on_delete_sparse(world, sparse_idr, action);
+    }
+
     /* Cleanup can happen recursively. If a cleanup action is already in 
      * progress, only append ids to the marked_ids. The topmost cleanup
      * frame will handle the actual cleanup. */
@@ -2629,6 +2934,9 @@ void ecs_delete(
                     flecs_table_traversable_add(table, -1);
                 }
             }
+            if (row_flags & EcsEntityHasSparse) {
+                flecs_entity_remove_sparse(world, entity);
+            }
             /* Merge operations before deleting entity */
             flecs_defer_end(world, stage);
             flecs_defer_begin(world, stage);
@@ -2684,6 +2992,167 @@ error:
     return;
 }
 
+static
+int flecs_table_range_compare(
+    const void *ptr_a,
+    const void *ptr_b)
+{
+    const ecs_table_range_t *a = ptr_a;
+    const ecs_table_range_t *b = ptr_b;
+    if (a->table != b->table) {
+        return (a->table->id > b->table->id) - (a->table->id < b->table->id);
+    }
+    return (a->offset > b->offset) - (a->offset < b->offset);
+}
+
+void flecs_bulk_add_remove_id(
+    ecs_world_t *world,
+    ecs_table_range_t *ranges,
+    int32_t count,
+    ecs_id_t id,
+    bool remove)
+{
+    int32_t i, e;
+    for (i = 0; i < count; i ++) {
+        ecs_table_range_t *range = &ranges[i];
+        if (!range->count) {
+            range->count = ecs_table_count(range->table) - range->offset;
+        }
+    }
+
+    ecs_stage_t *stage = flecs_stage_from_world(&world);
+    if (flecs_defer_cmd(stage)) {
+        /* Tables can't be modified while deferred, enqueue per entity */
+        for (i = 0; i < count; i ++) {
+            ecs_table_range_t *range = &ranges[i];
+            ecs_entity_t *entities = ecs_vec_get_t(
+                &range->table->data.entities, ecs_entity_t, range->offset);
+            for (e = 0; e < range->count; e ++) {
+                if (remove) {
+                    flecs_defer_remove(stage, entities[e], id);
+                } else {
+                    flecs_defer_add(stage, entities[e], id);
+                }
+            }
+        }
+        return;
+    }
+
+    /* Ranges are applied in reverse order, so that entities that are moved
+     * into the gap left by a range are never part of a range that still has
+     * to be applied. Overlapping ranges are combined. */
+    if (count > 1) {
+        qsort(ranges, flecs_itosize(count), sizeof(ecs_table_range_t),
+            flecs_table_range_compare);
+
+        int32_t last = 0;
+        for (i = 1; i < count; i ++) {
+            ecs_table_range_t *cur = &ranges[i], *prev = &ranges[last];
+            int32_t prev_end = prev->offset + prev->count;
+            if ((cur->table == prev->table) && (cur->offset <= prev_end)) {
+                int32_t cur_end = cur->offset + cur->count;
+                if (cur_end > prev_end) {
+                    prev->count = cur_end - prev->offset;
+                }
+            } else {
+                ranges[++ last] = *cur;
+            }
+        }
+        count = last + 1;
+    }
+
+    ecs_id_record_t *idr = flecs_sparse_id_record(world, id);
+
+    for (i = count - 1; i >= 0; i --) {
+        ecs_table_range_t *range = &ranges[i];
+        ecs_table_t *table = range->table;
+        if (!range->count) {
+            continue;
+        }
+
+        if (idr) {
+            ecs_entity_t *entities = ecs_vec_get_t(
+                &table->data.entities, ecs_entity_t, range->offset);
+            for (e = 0; e < range->count; e ++) {
+                if (remove) {
+                    flecs_remove_sparse(world, entities[e], idr);
+                } else {
+                    ecs_record_t *r = flecs_entities_get(world, entities[e]);
+                    flecs_add_sparse(world, entities[e], r, idr, true);
+                }
+            }
+            continue;
+        }
+
+        ecs_id_t table_id = id;
+        ecs_table_diff_t diff = ECS_TABLE_DIFF_INIT;
+        ecs_table_t *dst_table;
+        if (remove) {
+            dst_table = flecs_table_traverse_remove(
+                world, table, &table_id, &diff);
+        } else {
+            dst_table = flecs_table_traverse_add(
+                world, table, &table_id, &diff);
+        }
+
+        flecs_commit_range(
+            world, table, range->offset, range->count, dst_table, &diff);
+    }
+
+    flecs_defer_end(world, stage);
+}
+
+void ecs_bulk_add_id(
+    ecs_world_t *world,
+    ecs_table_t *table,
+    int32_t offset,
+    int32_t count,
+    ecs_id_t id)
+{
+    ecs_check(world != NULL, ECS_INVALID_PARAMETER, NULL);
+    ecs_check(table != NULL, ECS_INVALID_PARAMETER, NULL);
+    ecs_check(offset >= 0, ECS_INVALID_PARAMETER, NULL);
+    ecs_check(count >= 0, ECS_INVALID_PARAMETER, NULL);
+    ecs_check((offset + count) <= ecs_table_count(table),
+        ECS_INVALID_PARAMETER, NULL);
+    ecs_check(ecs_id_is_valid(world, id), ECS_INVALID_PARAMETER, NULL);
+
+    if (offset == ecs_table_count(table)) {
+        return;
+    }
+
+    ecs_table_range_t range = { table, offset, count };
+    flecs_bulk_add_remove_id(world, &range, 1, id, false);
+error:
+    return;
+}
+
+void ecs_bulk_remove_id(
+    ecs_world_t *world,
+    ecs_table_t *table,
+    int32_t offset,
+    int32_t count,
+    ecs_id_t id)
+{
+    ecs_check(world != NULL, ECS_INVALID_PARAMETER, NULL);
+    ecs_check(table != NULL, ECS_INVALID_PARAMETER, NULL);
+    ecs_check(offset >= 0, ECS_INVALID_PARAMETER, NULL);
+    ecs_check(count >= 0, ECS_INVALID_PARAMETER, NULL);
+    ecs_check((offset + count) <= ecs_table_count(table),
+        ECS_INVALID_PARAMETER, NULL);
+    ecs_check(ecs_id_is_valid(world, id) || ecs_id_is_wildcard(id),
+        ECS_INVALID_PARAMETER, NULL);
+
+    if (offset == ecs_table_count(table)) {
+        return;
+    }
+
+    ecs_table_range_t range = { table, offset, count };
+    flecs_bulk_add_remove_id(world, &range, 1, id, true);
+error:
+    return;
+}
+
 void ecs_override_id(
     ecs_world_t *world,
     ecs_entity_t entity,
@@ -2769,19 +3238,23 @@ const void* ecs_get_id(
     ecs_record_t *r = flecs_entities_get(world, entity);
     ecs_assert(r != NULL, ECS_INVALID_PARAMETER, NULL);
 
-    ecs_table_t *table = r->table;
-    if (!table) {
-        return NULL;
-    }
-
     ecs_id_record_t *idr = flecs_id_record_get(world, id);
     if (!idr) {
         return NULL;
     }
 
-    const ecs_table_record_t *tr = flecs_id_record_get_table(idr, table);
-    if (!tr) {
-       return flecs_get_base_component(world, table, id, idr, 0);
+    if (idr->flags & EcsIdSparse) {
+        return flecs_id_record_sparse_get(idr, entity);
+    }
+
+    ecs_table_t *table = r->table;
+    if (!table) {
+        return NULL;
+    }
+
+    const ecs_table_record_t *tr = flecs_id_record_get_table(idr, table);
+    if (!tr) {
+       return flecs_get_base_component(world, table, id, idr, 0);
     } else {
         ecs_check(tr->column != -1, ECS_NOT_A_COMPONENT, NULL);
     }
@@ -2807,13 +3280,17 @@ void* ecs_get_mut_id(
     ecs_record_t *r = flecs_entities_get(world, entity);
     ecs_assert(r != NULL, ECS_INVALID_PARAMETER, NULL);
 
-    ecs_table_t *table = r->table;
-    if (!table) {
+    ecs_id_record_t *idr = flecs_id_record_get(world, id);
+    if (!idr) {
         return NULL;
     }
 
-    ecs_id_record_t *idr = flecs_id_record_get(world, id);
-    if (!idr) {
+    if (idr->flags & EcsIdSparse) {
+        return flecs_id_record_sparse_get(idr, entity);
+    }
+
+    ecs_table_t *table = r->table;
+    if (!table) {
         return NULL;
     }
 
@@ -3117,6 +3594,13 @@ void* ecs_emplace_id(
     }
 
     ecs_record_t *r = flecs_entities_get(world, entity);
+    ecs_id_record_t *idr = flecs_sparse_id_record(world, id);
+    if (idr) {
+        void *ptr = flecs_add_sparse(world, entity, r, idr, false);
+        flecs_defer_end(world, stage);
+        return ptr;
+    }
+
     flecs_add_id_w_record(world, entity, r, id, false /* Add without ctor */);
     flecs_defer_end(world, stage);
 
@@ -3145,6 +3629,16 @@ void flecs_modified_id_if(
         return;
     }
 
+    ecs_id_record_t *idr = flecs_sparse_id_record(world, id);
+    if (idr) {
+        void *ptr = flecs_id_record_sparse_get(idr, entity);
+        if (ptr && owned) {
+            flecs_on_set_sparse(world, entity, idr, ptr);
+        }
+        flecs_defer_end(world, stage);
+        return;
+    }
+
     ecs_record_t *r = flecs_entities_get(world, entity);
     ecs_table_t *table = r->table;
     if (!flecs_table_record_get(world, table, id)) {
@@ -3155,7 +3649,7 @@ void flecs_modified_id_if(
     ecs_type_t ids = { .array = &id, .count = 1 };
     flecs_notify_on_set(world, table, ECS_RECORD_TO_ROW(r->row), 1, &ids, owned);
 
-    flecs_table_mark_dirty(world, table, id);
+    flecs_table_mark_dirty(world, table, ECS_RECORD_TO_ROW(r->row), id);
     flecs_defer_end(world, stage);
 error:
     return;
@@ -3182,12 +3676,20 @@ void ecs_modified_id(
      * operations are being deferred. */
     ecs_check(ecs_has_id(world, entity, id), ECS_INVALID_PARAMETER, NULL);
 
+    ecs_id_record_t *idr = flecs_sparse_id_record(world, id);
+    if (idr) {
+        flecs_on_set_sparse(world, entity, idr, 
+            flecs_id_record_sparse_get(idr, entity));
+        flecs_defer_end(world, stage);
+        return;
+    }
+
     ecs_record_t *r = flecs_entities_get(world, entity);
     ecs_table_t *table = r->table;
     ecs_type_t ids = { .array = &id, .count = 1 };
     flecs_notify_on_set(world, table, ECS_RECORD_TO_ROW(r->row), 1, &ids, true);
 
-    flecs_table_mark_dirty(world, table, id);
+    flecs_table_mark_dirty(world, table, ECS_RECORD_TO_ROW(r->row), id);
     flecs_defer_end(world, stage);
 error:
     return;
@@ -3224,7 +3726,14 @@ void flecs_copy_ptr_w_id(
         ecs_os_memset(dst.ptr, 0, size);
     }
 
-    flecs_table_mark_dirty(world, r->table, id);
+    ecs_id_record_t *idr = flecs_sparse_id_record(world, id);
+    if (idr) {
+        flecs_on_set_sparse(world, entity, idr, dst.ptr);
+        flecs_defer_end(world, stage);
+        return;
+    }
+
+    flecs_table_mark_dirty(world, r->table, ECS_RECORD_TO_ROW(r->row), id);
 
     ecs_table_t *table = r->table;
     if (table->flags & EcsTableHasOnSet || ti->hooks.on_set) {
@@ -3273,7 +3782,16 @@ void flecs_move_ptr_w_id(
         ecs_os_memcpy(dst.ptr, ptr, flecs_utosize(size));
     }
 
-    flecs_table_mark_dirty(world, r->table, id);
+    ecs_id_record_t *idr = flecs_sparse_id_record(world, id);
+    if (idr) {
+        if (cmd_kind == EcsCmdSet) {
+            flecs_on_set_sparse(world, entity, idr, dst.ptr);
+        }
+        flecs_defer_end(world, stage);
+        return;
+    }
+
+    flecs_table_mark_dirty(world, r->table, ECS_RECORD_TO_ROW(r->row), id);
 
     if (cmd_kind == EcsCmdSet) {
         ecs_table_t *table = r->table;
@@ -3416,6 +3934,14 @@ bool ecs_has_id(
 
     ecs_record_t *r = flecs_entities_get_any(world, entity);
     ecs_assert(r != NULL, ECS_INTERNAL_ERROR, NULL);
+
+    if (r->row & EcsEntityHasSparse) {
+        ecs_id_record_t *idr = flecs_sparse_id_record(world, id);
+        if (idr) {
+            return flecs_id_record_sparse_has(idr, entity);
+        }
+    }
+
     ecs_table_t *table = r->table;
     if (!table) {
         return false;
@@ -3465,6 +3991,11 @@ bool ecs_owns_id(
     ecs_entity_t entity,
     ecs_id_t id)
 {
+    ecs_id_record_t *idr = flecs_sparse_id_record(ecs_get_world(world), id);
+    if (idr) {
+        return flecs_id_record_sparse_has(idr, entity);
+    }
+
     return (ecs_search(world, ecs_get_table(world, entity), id, 0) != -1);
 }
 
@@ -4513,7 +5044,7 @@ void flecs_flush_bulk_new(
         }
     }
 
-    ecs_os_free(entities);
+    flecs_stack_free_n(entities, ecs_entity_t, cmd->is._n.count);
 }
 
 static
@@ -4562,7 +5093,8 @@ void flecs_discard_cmd(
     ecs_cmd_t *cmd)
 {
     if (cmd->kind == EcsCmdBulkNew) {
-        ecs_os_free(cmd->is._n.entities);
+        flecs_stack_free_n(cmd->is._n.entities, ecs_entity_t, 
+            cmd->is._n.count);
     } else if (cmd->kind == EcsCmdEvent) {
         flecs_free_cmd_event(world, cmd->is._1.value);
     } else {
@@ -4672,6 +5204,155 @@ ecs_table_t* flecs_cmd_batch_add_diff(
     return dst;
 }
 
+/* Returns true if the commands for an entity contain a sparse component. Sparse
+ * components don't cause table moves, and are applied in queue order. */
+static
+bool flecs_cmd_batch_has_sparse(
+    ecs_world_t *world,
+    ecs_cmd_t *cmds,
+    int32_t start)
+{
+    int32_t cur = start;
+    do {
+        ecs_cmd_t *cmd = &cmds[cur];
+        if (cmd->id && flecs_sparse_id_record(world, cmd->id)) {
+            return true;
+        }
+
+        cur = cmd->next_for_entity;
+        if (cur < 0) {
+            cur *= -1;
+        }
+    } while (cur);
+
+    return false;
+}
+
+/* Copy values of set commands in batch to the component storage of entity. A
+ * set command is converted to a modified command, so that OnSet observers are
+ * invoked when the command is processed. */
+static
+void flecs_cmd_batch_set_values(
+    ecs_world_t *world,
+    ecs_record_t *r,
+    ecs_cmd_t *cmds,
+    int32_t start)
+{
+    ecs_cmd_t *cmd;
+    int32_t next_for_entity;
+    int32_t cur = start;
+    do {
+        cmd = &cmds[cur];
+        next_for_entity = cmd->next_for_entity;
+        if (next_for_entity < 0) {
+            next_for_entity *= -1;
+        }
+        switch(cmd->kind) {
+        case EcsCmdSet:
+        case EcsCmdEnsure: {
+            flecs_component_ptr_t ptr = {0};
+            if (r->table) {
+                ptr = flecs_get_component_ptr(world, 
+                    r->table, ECS_RECORD_TO_ROW(r->row), cmd->id);
+            }
+
+            /* It's possible that even though the component was set, the
+             * command queue also contained a remove command, so before we
+             * do anything ensure the entity actually has the component. */
+            if (ptr.ptr) {
+                const ecs_type_info_t *ti = ptr.ti;
+                ecs_move_t move = ti->hooks.move;
+                if (move) {
+                    move(ptr.ptr, cmd->is._1.value, 1, ti);
+                    ecs_xtor_t dtor = ti->hooks.dtor;
+                    if (dtor) {
+                        dtor(cmd->is._1.value, 1, ti);
+                        cmd->is._1.value = NULL;
+                    }
+                } else {
+                    ecs_os_memcpy(ptr.ptr, cmd->is._1.value, ti->size);
+                }
+                if (cmd->kind == EcsCmdSet) {
+                    /* A set operation is add + copy + modified. We just did
+                     * the add the copy, so the only thing that's left is a 
+                     * modified command, which will call the OnSet 
+                     * observers. */
+                    cmd->kind = EcsCmdModified;
+                } else {
+                    /* If this was a ensure, nothing's left to be done */
+                    cmd->kind = EcsCmdSkip;
+                }
+            } else {
+                /* The entity no longer has the component which means that
+                 * there was a remove command for the component in the
+                 * command queue. In that case skip the command. */
+                cmd->kind = EcsCmdSkip;
+            }
+            break;
+        }
+        case EcsCmdClone:
+        case EcsCmdBulkNew:
+        case EcsCmdAdd:
+        case EcsCmdRemove:
+        case EcsCmdEmplace:
+        case EcsCmdModified:
+        case EcsCmdModifiedNoHook:
+        case EcsCmdAddModified:
+        case EcsCmdPath:
+        case EcsCmdDelete:
+        case EcsCmdClear:
+        case EcsCmdOnDeleteAction:
+        case EcsCmdEnable:
+        case EcsCmdDisable:
+        case EcsCmdEvent:
+        case EcsCmdSkip:
+            break;
+        }
+    } while ((cur = next_for_entity));
+}
+
+/* Collapse modified commands for the same id in batch into the last one, so
+ * that OnSet observers are invoked once for an entity. Commands that could 
+ * observe the intermediate notifications (such as events) are not moved past. */
+static
+void flecs_cmd_batch_collapse_modified(
+    ecs_cmd_t *cmds,
+    int32_t start)
+{
+    int32_t cur = start;
+    do {
+        ecs_cmd_t *cmd = &cmds[cur];
+        int32_t next = cmd->next_for_entity;
+        if (next < 0) {
+            next *= -1;
+        }
+
+        if (cmd->kind == EcsCmdModified || cmd->kind == EcsCmdModifiedNoHook) {
+            int32_t later = next;
+            while (later) {
+                ecs_cmd_t *later_cmd = &cmds[later];
+                ecs_cmd_kind_t kind = later_cmd->kind;
+                if (kind == EcsCmdModified || kind == EcsCmdModifiedNoHook) {
+                    if (later_cmd->id == cmd->id) {
+                        /* If the on_set hook still has to run for the collapsed
+                         * command, run it for the remaining command. */
+                        if (cmd->kind == EcsCmdModified) {
+                            later_cmd->kind = EcsCmdModified;
+                        }
+                        cmd->kind = EcsCmdSkip;
+                        break;
+                    }
+                } else if (kind != EcsCmdSkip) {
+                    break;
+                }
+                later = later_cmd->next_for_entity;
+            }
+        }
+
+        cur = next;
+    } while (cur);
+}
+
 static
 void flecs_cmd_batch_for_entity(
     ecs_world_t *world,
@@ -4680,6 +5361,12 @@ void flecs_cmd_batch_for_entity(
     ecs_cmd_t *cmds,
     int32_t start)
 {
+    if (ecs_vec_count(&world->sparse_ids) && 
+        flecs_cmd_batch_has_sparse(world, cmds, start)) 
+    {
+        return;
+    }
+
     ecs_record_t *r = flecs_entities_get(world, entity);
     ecs_table_t *table = NULL;
     if (r) {
@@ -4832,78 +5519,635 @@ void flecs_cmd_batch_for_entity(
      * yet, as for entities that did have the component already the value will
      * have been assigned directly to the component storage. */
     if (has_set) {
-        cur = start;
-        do {
-            cmd = &cmds[cur];
-            next_for_entity = cmd->next_for_entity;
-            if (next_for_entity < 0) {
-                next_for_entity *= -1;
+        flecs_cmd_batch_set_values(world, r, cmds, start);
+    }
+
+    flecs_cmd_batch_collapse_modified(cmds, start);
+}
+
+#ifdef FLECS_PIPELINE
+
+/* Table that entities are moved from or to in a parallel merge. Tables that are
+ * connected by a move are joined in the same job, so that each table is only
+ * accessed by a single thread. */
+typedef struct ecs_merge_table_t {
+    ecs_table_t *table;
+    int32_t parent;                  /* Parent table in job, -1 if root */
+    int32_t added;                   /* Number of entities moved to table */
+    int32_t first_out;               /* First group that moves from table */
+    int32_t first_group;             /* First group in job (root only) */
+    int32_t last_group;              /* Last group in job (root only) */
+    bool was_empty;                  /* Was table empty before merge */
+} ecs_merge_table_t;
+
+/* Entities that are moved from the same source to the same destination */
+typedef struct ecs_merge_group_t {
+    ecs_table_t *src;
+    ecs_table_t *dst;
+    int32_t src_index;               /* Index of source in tables vector */
+    int32_t dst_index;               /* Index of destination in tables vector */
+    int32_t next_out;                /* Next group with same source table */
+    int32_t next;                    /* Next group in job */
+    int32_t first_move;
+    int32_t last_move;
+    bool parallel;                   /* Can group be moved on worker thread */
+} ecs_merge_group_t;
+
+typedef struct ecs_merge_move_t {
+    ecs_record_t *record;
+    ecs_entity_t entity;
+    int32_t cmd;                     /* First command for entity */
+    int32_t next;                    /* Next move in group */
+} ecs_merge_move_t;
+
+typedef struct ecs_merge_parallel_t {
+    ecs_cmd_t *cmds;
+    ecs_map_t table_index;           /* map<table id, index in tables + 1> */
+    ecs_vec_t tables;                /* vector<ecs_merge_table_t> */
+    ecs_vec_t groups;                /* vector<ecs_merge_group_t> */
+    ecs_vec_t moves;                 /* vector<ecs_merge_move_t> */
+    ecs_vec_t jobs;                  /* vector<int32_t>, root tables */
+    int32_t next;                    /* Next job to claim, incremented atomically */
+} ecs_merge_parallel_t;
+
+static
+int32_t flecs_merge_table_ensure(
+    ecs_world_t *world,
+    ecs_merge_parallel_t *m,
+    ecs_table_t *table)
+{
+    ecs_map_val_t *index = ecs_map_ensure(&m->table_index, table->id);
+    if (!index[0]) {
+        ecs_merge_table_t *mt = ecs_vec_append_t(
+            &world->allocator, &m->tables, ecs_merge_table_t);
+        mt->table = table;
+        mt->parent = -1;
+        mt->added = 0;
+        mt->first_out = -1;
+        mt->first_group = -1;
+        mt->last_group = -1;
+        mt->was_empty = ecs_table_count(table) == 0;
+        index[0] = flecs_ito(uint64_t, ecs_vec_count(&m->tables));
+    }
+    return flecs_ito(int32_t, index[0]) - 1;
+}
+
+static
+int32_t flecs_merge_table_root(
+    ecs_merge_table_t *tables,
+    int32_t index)
+{
+    int32_t root = index;
+    while (tables[root].parent != -1) {
+        root = tables[root].parent;
+    }
+
+    /* Shorten path for next lookup */
+    while (tables[index].parent != -1) {
+        int32_t parent = tables[index].parent;
+        if (parent != root) {
+            tables[index].parent = root;
+        }
+        index = parent;
+    }
+
+    return root;
+}
+
+/* Test whether entities can be moved between tables without invoking code that
+ * accesses world state. Moves that don't qualify are applied on the main thread
+ * when the command queue is processed. */
+static
+bool flecs_merge_group_is_parallel(
+    ecs_table_t *src,
+    ecs_table_t *dst)
+{
+    ecs_flags32_t flags = src->flags | dst->flags;
+    if (flags & (EcsTableHasBuiltins|EcsTableHasOnAdd|EcsTableHasOnRemove|
+        EcsTableHasUnSet|EcsTableHasIsA|EcsTableHasTraversable|
+        EcsTableHasUnion|EcsTableHasToggle|EcsTableHasName|EcsTableHasTarget))
+    {
+        return false;
+    }
+
+    if (src->_->lock || dst->_->lock) {
+        return false;
+    }
+
+    /* Adding or removing pairs invalidates traversal caches */
+    if (flags & EcsTableHasPairs) {
+        ecs_id_t *src_ids = src->type.array, *dst_ids = dst->type.array;
+        int32_t s = 0, s_count = src->type.count;
+        int32_t d = 0, d_count = dst->type.count;
+        while (s < s_count || d < d_count) {
+            ecs_id_t s_id = s < s_count ? src_ids[s] : 0;
+            ecs_id_t d_id = d < d_count ? dst_ids[d] : 0;
+            if (s_id == d_id) {
+                s ++;
+                d ++;
+                continue;
             }
-            switch(cmd->kind) {
-            case EcsCmdSet:
-            case EcsCmdEnsure: {
-                flecs_component_ptr_t ptr = {0};
-                if (r->table) {
-                    ptr = flecs_get_component_ptr(world, 
-                        r->table, ECS_RECORD_TO_ROW(r->row), cmd->id);
-                }
 
-                /* It's possible that even though the component was set, the
-                 * command queue also contained a remove command, so before we
-                 * do anything ensure the entity actually has the component. */
-                if (ptr.ptr) {
-                    const ecs_type_info_t *ti = ptr.ti;
-                    ecs_move_t move = ti->hooks.move;
-                    if (move) {
-                        move(ptr.ptr, cmd->is._1.value, 1, ti);
-                        ecs_xtor_t dtor = ti->hooks.dtor;
-                        if (dtor) {
-                            dtor(cmd->is._1.value, 1, ti);
-                            cmd->is._1.value = NULL;
-                        }
-                    } else {
-                        ecs_os_memcpy(ptr.ptr, cmd->is._1.value, ti->size);
-                    }
-                    if (cmd->kind == EcsCmdSet) {
-                        /* A set operation is add + copy + modified. We just did
-                         * the add the copy, so the only thing that's left is a 
-                         * modified command, which will call the OnSet 
-                         * observers. */
-                        cmd->kind = EcsCmdModified;
-                    } else {
-                        /* If this was a ensure, nothing's left to be done */
-                        cmd->kind = EcsCmdSkip;
-                    }
-                } else {
-                    /* The entity no longer has the component which means that
-                     * there was a remove command for the component in the
-                     * command queue. In that case skip the command. */
-                    cmd->kind = EcsCmdSkip;
+            if (d == d_count || (s < s_count && s_id < d_id)) {
+                if (ECS_IS_PAIR(s_id)) {
+                    return false;
                 }
-                break;
+                s ++;
+            } else {
+                if (ECS_IS_PAIR(d_id)) {
+                    return false;
+                }
+                d ++;
             }
-            case EcsCmdClone:
-            case EcsCmdBulkNew:
-            case EcsCmdAdd:
-            case EcsCmdRemove:
-            case EcsCmdEmplace:
-            case EcsCmdModified:
-            case EcsCmdModifiedNoHook:
-            case EcsCmdAddModified:
-            case EcsCmdPath:
-            case EcsCmdDelete:
-            case EcsCmdClear:
-            case EcsCmdOnDeleteAction:
-            case EcsCmdEnable:
-            case EcsCmdDisable:
-            case EcsCmdEvent:
-            case EcsCmdSkip:
-                break;
+        }
+    }
+
+    /* Add/remove hooks can access the world */
+    if (flags & (EcsTableHasCtors|EcsTableHasDtors)) {
+        int32_t i;
+        for (i = 0; i < src->column_count; i ++) {
+            const ecs_type_info_t *ti = src->data.columns[i].ti;
+            if (ti->hooks.on_add || ti->hooks.on_remove) {
+                return false;
+            }
+        }
+        for (i = 0; i < dst->column_count; i ++) {
+            const ecs_type_info_t *ti = dst->data.columns[i].ti;
+            if (ti->hooks.on_add || ti->hooks.on_remove) {
+                return false;
+            }
+        }
+    }
+
+    return true;
+}
+
+static
+ecs_merge_group_t* flecs_merge_group_ensure(
+    ecs_world_t *world,
+    ecs_merge_parallel_t *m,
+    ecs_table_t *src,
+    ecs_table_t *dst)
+{
+    int32_t src_index = flecs_merge_table_ensure(world, m, src);
+    ecs_merge_table_t *tables = ecs_vec_first_t(&m->tables, ecs_merge_table_t);
+    ecs_merge_group_t *groups = ecs_vec_first_t(&m->groups, ecs_merge_group_t);
+
+    int32_t cur;
+    for (cur = tables[src_index].first_out; cur != -1; 
+        cur = groups[cur].next_out) 
+    {
+        if (groups[cur].dst == dst) {
+            return &groups[cur];
+        }
+    }
+
+    int32_t dst_index = flecs_merge_table_ensure(world, m, dst);
+    tables = ecs_vec_first_t(&m->tables, ecs_merge_table_t);
+
+    int32_t index = ecs_vec_count(&m->groups);
+    ecs_merge_group_t *group = ecs_vec_append_t(
+        &world->allocator, &m->groups, ecs_merge_group_t);
+    group->src = src;
+    group->dst = dst;
+    group->src_index = src_index;
+    group->dst_index = dst_index;
+    group->next_out = tables[src_index].first_out;
+    group->next = -1;
+    group->first_move = -1;
+    group->last_move = -1;
+    group->parallel = flecs_merge_group_is_parallel(src, dst);
+    tables[src_index].first_out = index;
+
+    if (group->parallel) {
+        /* Join jobs of source and destination table */
+        int32_t src_root = flecs_merge_table_root(tables, src_index);
+        int32_t dst_root = flecs_merge_table_root(tables, dst_index);
+        if (src_root != dst_root) {
+            tables[dst_root].parent = src_root;
+        }
+    }
+
+    return group;
+}
+
+/* Same test as flecs_remove_invalid, without running cleanup actions */
+static
+bool flecs_merge_id_is_valid(
+    ecs_world_t *world,
+    ecs_id_t id)
+{
+    if (ECS_HAS_ID_FLAG(id, PAIR)) {
+        return flecs_entities_is_valid(world, ECS_PAIR_FIRST(id)) &&
+            flecs_entities_is_valid(world, ECS_PAIR_SECOND(id));
+    }
+    return flecs_entities_is_valid(world, id & ECS_COMPONENT_MASK);
+}
+
+/* Find destination table for the commands of an entity. If the entity can be 
+ * moved on a worker thread, add it to the move group for its tables. */
+static
+void flecs_merge_prepare_entity(
+    ecs_world_t *world,
+    ecs_merge_parallel_t *m,
+    ecs_table_diff_builder_t *diff,
+    ecs_entity_t entity,
+    ecs_cmd_t *cmds,
+    int32_t start)
+{
+    if (ecs_vec_count(&world->sparse_ids) && 
+        flecs_cmd_batch_has_sparse(world, cmds, start)) 
+    {
+        return;
+    }
+
+    ecs_record_t *r = flecs_entities_get(world, entity);
+    ecs_table_t *src = r->table;
+    if (!src || (r->row & EcsEntityIsTraversable)) {
+        return;
+    }
+
+    ecs_table_t *dst = src;
+    int32_t cur = start;
+    do {
+        ecs_cmd_t *cmd = &cmds[cur];
+        ecs_id_t id = cmd->id;
+        switch(cmd->kind) {
+        case EcsCmdAdd:
+        case EcsCmdAddModified:
+        case EcsCmdSet:
+        case EcsCmdEnsure:
+            if (!flecs_merge_id_is_valid(world, id)) {
+                goto done;
             }
-        } while ((cur = next_for_entity));
+            dst = flecs_find_table_add(world, dst, id, diff);
+            break;
+        case EcsCmdRemove:
+            if (!flecs_merge_id_is_valid(world, id)) {
+                goto done;
+            }
+            dst = flecs_find_table_remove(world, dst, id, diff);
+            break;
+        case EcsCmdClone:
+        case EcsCmdBulkNew:
+        case EcsCmdEmplace:
+        case EcsCmdModified:
+        case EcsCmdModifiedNoHook:
+        case EcsCmdPath:
+        case EcsCmdDelete:
+        case EcsCmdClear:
+        case EcsCmdOnDeleteAction:
+        case EcsCmdEnable:
+        case EcsCmdDisable:
+        case EcsCmdEvent:
+        case EcsCmdSkip:
+            goto done;
+        }
+
+        cur = cmd->next_for_entity;
+        if (cur < 0) {
+            cur *= -1;
+        }
+    } while (cur);
+
+    if (dst == src || !dst->type.count) {
+        goto done;
+    }
+
+    ecs_merge_group_t *group = flecs_merge_group_ensure(world, m, src, dst);
+    if (!group->parallel) {
+        goto done;
+    }
+
+    /* Entity will be moved by a worker. What's left for the main thread are
+     * the modified commands that invoke OnSet observers. */
+    world->info.cmd.batched_entity_count ++;
+    cur = start;
+    do {
+        ecs_cmd_t *cmd = &cmds[cur];
+        if (cmd->kind == EcsCmdAdd || cmd->kind == EcsCmdRemove) {
+            cmd->kind = EcsCmdSkip;
+        } else if (cmd->kind == EcsCmdAddModified) {
+            cmd->kind = EcsCmdModified;
+        }
+        world->info.cmd.batched_command_count ++;
+
+        cur = cmd->next_for_entity;
+        if (cur < 0) {
+            cur *= -1;
+        }
+    } while (cur);
+
+    /* Don't batch commands for entity again when queue is processed */
+    if (cmds[start].next_for_entity < 0) {
+        cmds[start].next_for_entity *= -1;
+    }
+
+    int32_t index = ecs_vec_count(&m->moves);
+    ecs_merge_move_t *move = ecs_vec_append_t(
+        &world->allocator, &m->moves, ecs_merge_move_t);
+    move->record = r;
+    move->entity = entity;
+    move->cmd = start;
+    move->next = -1;
+
+    if (group->last_move != -1) {
+        ecs_vec_get_t(&m->moves, ecs_merge_move_t, group->last_move)->next = 
+            index;
+    } else {
+        group->first_move = index;
+    }
+    group->last_move = index;
+
+    ecs_vec_get_t(&m->tables, ecs_merge_table_t, group->dst_index)->added ++;
+
+done:
+    flecs_table_diff_builder_clear(diff);
+}
+
+/* Collect command batches at the start of the queue that can be moved on worker
+ * threads. Stops at the first command that isn't batched (such as delete), as
+ * this could affect entities of commands that come after it. */
+static
+void flecs_merge_prepare(
+    ecs_world_t *world,
+    ecs_merge_parallel_t *m,
+    ecs_table_diff_builder_t *diff,
+    ecs_cmd_t *cmds,
+    int32_t count)
+{
+    int32_t i;
+    for (i = 0; i < count; i ++) {
+        ecs_cmd_t *cmd = &cmds[i];
+        ecs_cmd_kind_t kind = cmd->kind;
+        if (kind == EcsCmdClone || kind == EcsCmdBulkNew || 
+            kind == EcsCmdPath || kind == EcsCmdDelete || 
+            kind == EcsCmdOnDeleteAction || kind == EcsCmdEnable ||
+            kind == EcsCmdDisable || kind == EcsCmdEvent)
+        {
+            break;
+        }
+
+        /* Only the first command for an entity has an entry */
+        if (!cmd->entry) {
+            continue;
+        }
+
+        ecs_entity_t e = cmd->entity;
+        if (flecs_entities_is_alive(world, e)) {
+            flecs_merge_prepare_entity(world, m, diff, e, cmds, i);
+        }
     }
 }
 
+/* Move entity to destination table. Runs on a worker thread, storage has been
+ * reserved by the main thread so that no allocations are needed. */
+static
+void flecs_merge_move_entity(
+    ecs_world_t *world,
+    ecs_cmd_t *cmds,
+    ecs_merge_move_t *move,
+    ecs_table_t *src,
+    ecs_table_t *dst)
+{
+    ecs_record_t *r = move->record;
+    ecs_entity_t entity = move->entity;
+    ecs_assert(r->table == src, ECS_INTERNAL_ERROR, NULL);
+
+    int32_t src_row = ECS_RECORD_TO_ROW(r->row);
+    int32_t dst_row = flecs_table_append(world, dst, entity, false, false);
+    flecs_table_move(world, entity, entity, dst, dst_row, src, src_row, true);
+    r->table = dst;
+    r->row = ECS_ROW_TO_RECORD(dst_row, r->row & ECS_ROW_FLAGS_MASK);
+    flecs_table_delete(world, src, src_row, false);
+
+    flecs_cmd_batch_set_values(world, r, cmds, move->cmd);
+    flecs_cmd_batch_collapse_modified(cmds, move->cmd);
+}
+
+/* Worker task that claims jobs until all of them have been moved */
+static
+void flecs_merge_worker(
+    ecs_world_t *world,
+    ecs_stage_t *stage,
+    void *ctx)
+{
+    (void)stage;
+    ecs_merge_parallel_t *m = ctx;
+    ecs_merge_table_t *tables = ecs_vec_first_t(&m->tables, ecs_merge_table_t);
+    ecs_merge_group_t *groups = ecs_vec_first_t(&m->groups, ecs_merge_group_t);
+    ecs_merge_move_t *moves = ecs_vec_first_t(&m->moves, ecs_merge_move_t);
+    int32_t *jobs = ecs_vec_first_t(&m->jobs, int32_t);
+    int32_t i, job_count = ecs_vec_count(&m->jobs);
+
+    while ((i = ecs_os_ainc(&m->next) - 1) < job_count) {
+        int32_t g, mv;
+        for (g = tables[jobs[i]].first_group; g != -1; g = groups[g].next) {
+            ecs_merge_group_t *group = &groups[g];
+            for (mv = group->first_move; mv != -1; mv = moves[mv].next) {
+                flecs_merge_move_entity(world, m->cmds, &moves[mv], 
+                    group->src, group->dst);
+            }
+        }
+    }
+}
+
+/* Move entities for command batches in queue to their destination tables on 
+ * worker threads. Entities that are moved between the same tables, or between
+ * tables that share a source or destination, are moved by the same thread. 
+ * Anything that needs world state (creating tables, updating the empty state of
+ * tables and invoking observers) happens on the main thread. */
+static
+void flecs_merge_parallel(
+    ecs_world_t *world,
+    ecs_table_diff_builder_t *diff,
+    ecs_cmd_t *cmds,
+    int32_t count)
+{
+    if (!(world->flags & EcsWorldParallelMerge) || 
+        !flecs_workers_can_run_task(world)) 
+    {
+        return;
+    }
+
+    ecs_allocator_t *a = &world->allocator;
+    ecs_merge_parallel_t m = { .cmds = cmds };
+    ecs_map_init(&m.table_index, a);
+    ecs_vec_init_t(a, &m.tables, ecs_merge_table_t, 0);
+    ecs_vec_init_t(a, &m.groups, ecs_merge_group_t, 0);
+    ecs_vec_init_t(a, &m.moves, ecs_merge_move_t, 0);
+    ecs_vec_init_t(a, &m.jobs, int32_t, 0);
+
+    flecs_merge_prepare(world, &m, diff, cmds, count);
+
+    int32_t move_count = ecs_vec_count(&m.moves);
+    if (!move_count) {
+        goto done;
+    }
+
+    /* Reserve storage so that workers don't have to allocate */
+    ecs_merge_table_t *tables = ecs_vec_first_t(&m.tables, ecs_merge_table_t);
+    int32_t i, table_count = ecs_vec_count(&m.tables);
+    for (i = 0; i < table_count; i ++) {
+        if (tables[i].added) {
+            flecs_table_reserve(world, tables[i].table, tables[i].added);
+        }
+    }
+
+    /* Assign groups to jobs, in the order in which they were created */
+    ecs_merge_group_t *groups = ecs_vec_first_t(&m.groups, ecs_merge_group_t);
+    int32_t group_count = ecs_vec_count(&m.groups);
+    for (i = 0; i < group_count; i ++) {
+        ecs_merge_group_t *group = &groups[i];
+        if (group->first_move == -1) {
+            continue;
+        }
+
+        ecs_merge_table_t *root = &tables[
+            flecs_merge_table_root(tables, group->src_index)];
+        if (root->last_group != -1) {
+            groups[root->last_group].next = i;
+        } else {
+            root->first_group = i;
+            ecs_vec_append_t(a, &m.jobs, int32_t)[0] = 
+                flecs_ito(int32_t, root - tables);
+        }
+        root->last_group = i;
+    }
+
+    ECS_BIT_SET(world->flags, EcsWorldParallelMerging);
+    if (ecs_vec_count(&m.jobs) > 1) {
+        flecs_workers_run_task(world, flecs_merge_worker, &m);
+    } else {
+        /* Not worth waking up workers for a single job */
+        flecs_merge_worker(world, &world->stages[0], &m);
+    }
+    ECS_BIT_CLEAR(world->flags, EcsWorldParallelMerging);
+
+    /* Tables that became empty or non-empty weren't registered by workers */
+    for (i = 0; i < table_count; i ++) {
+        ecs_table_t *table = tables[i].table;
+        if (tables[i].was_empty != (ecs_table_count(table) == 0)) {
+            flecs_table_set_empty(world, table);
+        }
+    }
+
+    world->info.cmd.parallel_entity_count += move_count;
+
+done:
+    ecs_map_fini(&m.table_index);
+    ecs_vec_fini_t(a, &m.tables, ecs_merge_table_t);
+    ecs_vec_fini_t(a, &m.groups, ecs_merge_group_t);
+    ecs_vec_fini_t(a, &m.moves, ecs_merge_move_t);
+    ecs_vec_fini_t(a, &m.jobs, int32_t);
+}
+
+#endif
+
+/* OnSet notifications of modified commands are coalesced while merging, so that
+ * observers are invoked once for a range of entities in the same table instead
+ * of once per entity. */
+typedef struct ecs_cmd_on_set_t {
+    ecs_table_t *table;
+    ecs_id_t id;
+    int32_t row;
+    bool owned;
+    ecs_vec_t entities;              /* vector<ecs_entity_t> */
+} ecs_cmd_on_set_t;
+
+/* Invoke OnSet notifications for coalesced modified commands. Observers that 
+ * ran since the commands were coalesced could have moved entities, in which 
+ * case notifications are sent one entity at a time. */
+static
+void flecs_cmd_on_set_flush(
+    ecs_world_t *world,
+    ecs_stage_t *stage,
+    ecs_cmd_on_set_t *batch)
+{
+    int32_t i, count = ecs_vec_count(&batch->entities);
+    if (!count) {
+        return;
+    }
+
+    ecs_table_t *table = batch->table;
+    ecs_id_t id = batch->id;
+    int32_t row = batch->row;
+    ecs_entity_t *entities = ecs_vec_first_t(&batch->entities, ecs_entity_t);
+
+    bool valid = (row + count) <= ecs_table_count(table) && 
+        flecs_table_record_get(world, table, id) != NULL;
+    if (valid) {
+        ecs_entity_t *stored = ecs_vec_get_t(
+            &table->data.entities, ecs_entity_t, row);
+        valid = !ecs_os_memcmp(stored, entities, 
+            count * ECS_SIZEOF(ecs_entity_t));
+    }
+
+    if (valid) {
+        ecs_type_t ids = { .array = &id, .count = 1 };
+        flecs_defer_begin(world, stage);
+        flecs_notify_on_set(world, table, row, count, &ids, batch->owned);
+        for (i = 0; i < count; i ++) {
+            flecs_table_mark_dirty(world, table, row + i, id);
+        }
+        flecs_defer_end(world, stage);
+    } else {
+        for (i = 0; i < count; i ++) {
+            if (flecs_entities_is_alive(world, entities[i])) {
+                flecs_modified_id_if(world, entities[i], id, batch->owned);
+            }
+        }
+    }
+
+    ecs_vec_clear(&batch->entities);
+    batch->table = NULL;
+}
+
+/* Add modified command to the current range if the entity is stored in the row
+ * after the last entity of the range, otherwise start a new range. */
+static
+void flecs_cmd_on_set_add(
+    ecs_world_t *world,
+    ecs_stage_t *stage,
+    ecs_cmd_on_set_t *batch,
+    ecs_entity_t entity,
+    ecs_id_t id,
+    bool owned)
+{
+    if (flecs_sparse_id_record(world, id)) {
+        flecs_cmd_on_set_flush(world, stage, batch);
+        flecs_modified_id_if(world, entity, id, owned);
+        return;
+    }
+
+    ecs_record_t *r = flecs_entities_get(world, entity);
+    ecs_table_t *table = r->table;
+    if (!table || !flecs_table_record_get(world, table, id)) {
+        return;
+    }
+
+    int32_t row = ECS_RECORD_TO_ROW(r->row);
+    int32_t count = ecs_vec_count(&batch->entities);
+    if (count) {
+        if ((batch->table != table) || (batch->id != id) || 
+            (batch->owned != owned) || (batch->row + count != row))
+        {
+            flecs_cmd_on_set_flush(world, stage, batch);
+            count = 0;
+        }
+    }
+
+    if (!count) {
+        batch->table = table;
+        batch->id = id;
+        batch->row = row;
+        batch->owned = owned;
+    }
+
+    ecs_vec_append_t(&world->allocator, &batch->entities, ecs_entity_t)[0] = 
+        entity;
+}
+
 /* Leave safe section. Run all deferred commands. */
 bool flecs_defer_end(
     ecs_world_t *world,
@@ -4939,6 +6183,13 @@ bool flecs_defer_end(
                     world->on_commands_ctx_active);
             }
 
+            /* Internal callback for recording commands that are merged with
+             * the world. Commands enqueued while merging are not recorded. */
+            if (world->on_commands_record && merge_to_world && !stage->cmd_sp) {
+                world->on_commands_record(stage, queue, 
+                    world->on_commands_record_ctx);
+            }
+
             ecs_cmd_t *cmds = ecs_vec_first(queue);
             int32_t i, count = ecs_vec_count(queue);
 
@@ -4946,6 +6197,15 @@ bool flecs_defer_end(
             flecs_table_diff_builder_init(world, &diff);
             flecs_commands_push(stage);
 
+            ecs_cmd_on_set_t on_set = {0};
+            ecs_vec_init_t(&world->allocator, &on_set.entities, ecs_entity_t, 0);
+
+#ifdef FLECS_PIPELINE
+            if (merge_to_world) {
+                flecs_merge_parallel(world, &diff, cmds, count);
+            }
+#endif
+
             for (i = 0; i < count; i ++) {
                 ecs_cmd_t *cmd = &cmds[i];
                 ecs_entity_t e = cmd->entity;
@@ -4978,6 +6238,14 @@ bool flecs_defer_end(
 
                 ecs_id_t id = cmd->id;
 
+                /* Coalesced OnSet notifications are sent before a command that
+                 * could depend on them is executed. */
+                if ((kind != EcsCmdSet) && (kind != EcsCmdAddModified) &&
+                    (kind != EcsCmdModified) && (kind != EcsCmdModifiedNoHook)) 
+                {
+                    flecs_cmd_on_set_flush(world, dst_stage, &on_set);
+                }
+
                 switch(kind) {
                 case EcsCmdAdd:
                     ecs_assert(id != 0, ECS_INTERNAL_ERROR, NULL);
@@ -5002,9 +6270,19 @@ bool flecs_defer_end(
                     world->info.cmd.other_count ++;
                     break;
                 case EcsCmdSet:
-                    flecs_move_ptr_w_id(world, dst_stage, e, 
-                        cmd->id, flecs_itosize(cmd->is._1.size), 
-                        cmd->is._1.value, kind);
+                    if (merge_to_world) {
+                        /* Assign value without notifying, and coalesce the
+                         * OnSet notification with other set commands. */
+                        flecs_move_ptr_w_id(world, dst_stage, e, 
+                            cmd->id, flecs_itosize(cmd->is._1.size), 
+                            cmd->is._1.value, EcsCmdEnsure);
+                        flecs_cmd_on_set_add(
+                            world, dst_stage, &on_set, e, id, true);
+                    } else {
+                        flecs_move_ptr_w_id(world, dst_stage, e, 
+                            cmd->id, flecs_itosize(cmd->is._1.size), 
+                            cmd->is._1.value, kind);
+                    }
                     world->info.cmd.set_count ++;
                     break;
                 case EcsCmdEmplace:
@@ -5023,16 +6301,25 @@ bool flecs_defer_end(
                     world->info.cmd.ensure_count ++;
                     break;
                 case EcsCmdModified:
-                    flecs_modified_id_if(world, e, id, true);
-                    world->info.cmd.modified_count ++;
-                    break;
-                case EcsCmdModifiedNoHook:
-                    flecs_modified_id_if(world, e, id, false);
+                case EcsCmdModifiedNoHook: {
+                    bool owned = kind == EcsCmdModified;
+                    if (merge_to_world) {
+                        flecs_cmd_on_set_add(
+                            world, dst_stage, &on_set, e, id, owned);
+                    } else {
+                        flecs_modified_id_if(world, e, id, owned);
+                    }
                     world->info.cmd.modified_count ++;
                     break;
+                }
                 case EcsCmdAddModified:
                     flecs_add_id(world, e, id);
-                    flecs_modified_id_if(world, e, id, true);
+                    if (merge_to_world) {
+                        flecs_cmd_on_set_add(
+                            world, dst_stage, &on_set, e, id, true);
+                    } else {
+                        flecs_modified_id_if(world, e, id, true);
+                    }
                     world->info.cmd.set_count ++;
                     break;
                 case EcsCmdDelete: {
@@ -5098,6 +6385,9 @@ bool flecs_defer_end(
                 }
             }
 
+            flecs_cmd_on_set_flush(world, dst_stage, &on_set);
+            ecs_vec_fini_t(&world->allocator, &on_set.entities, ecs_entity_t);
+
             flecs_stack_reset(&commands->stack);
             ecs_vec_clear(queue);
             flecs_commands_pop(stage);
@@ -5,8 +5,9 @@
  * After a table has been matched by a query, additional filters may have to
  * be applied before returning entities to the application. The two scenarios
  * under which this happens are queries for union relationship pairs (entities
- * for multiple targets are stored in the same table) and toggles (components 
- * that are enabled/disabled with a bitset).
+ * for multiple targets are stored in the same table), toggles (components 
+ * that are enabled/disabled with a bitset) and sparse components (components
+ * that are stored outside of tables).
  */
 
 #include "private_api.h"
@@ -648,3 +649,196 @@ int flecs_entity_filter_next(
         return result;
     }
 }
+
+static
+bool flecs_sparse_term_match(
+    const ecs_term_t *term,
+    ecs_entity_t e)
+{
+    ecs_oper_kind_t oper = term->oper;
+    if (oper == EcsOptional) {
+        return true;
+    }
+
+    bool has = flecs_id_record_sparse_has(term->idr, e);
+    if (oper == EcsNot) {
+        return !has;
+    }
+
+    return has;
+}
+
+static
+bool flecs_sparse_this_match(
+    const ecs_filter_t *filter,
+    ecs_entity_t e)
+{
+    const ecs_term_t *terms = filter->terms;
+    int32_t i, count = filter->term_count;
+    for (i = 0; i < count; i ++) {
+        const ecs_term_t *term = &terms[i];
+        if (!(term->flags & EcsTermIsSparse) || !ecs_term_match_this(term)) {
+            continue;
+        }
+        if (!flecs_sparse_term_match(term, e)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static
+void flecs_sparse_populate(
+    ecs_iter_t *it,
+    const ecs_filter_t *filter,
+    bool clear)
+{
+    const ecs_term_t *terms = filter->terms;
+    int32_t i, count = filter->term_count;
+    it->sparse_fields = 0;
+
+    for (i = 0; i < count; i ++) {
+        const ecs_term_t *term = &terms[i];
+        if (!(term->flags & EcsTermIsSparse)) {
+            continue;
+        }
+
+        int32_t field = term->field_index;
+        void *ptr = NULL;
+        if (!clear) {
+            ecs_entity_t e;
+            if (ecs_term_match_this(term)) {
+                if (!it->count) {
+                    continue;
+                }
+                e = it->entities[0];
+            } else if (term->src.flags & EcsIsEntity) {
+                e = term->src.id;
+            } else {
+                continue;
+            }
+
+            if (flecs_id_record_sparse_has(term->idr, e)) {
+                it->sparse_fields |= 1u << field;
+                ptr = flecs_id_record_sparse_get(term->idr, e);
+            }
+        }
+
+        if (it->ptrs && (term->inout != EcsInOutNone)) {
+            it->ptrs[field] = ptr;
+        }
+    }
+}
+
+bool flecs_sparse_filter_next(
+    ecs_iter_t *it,
+    ecs_iter_next_action_t next)
+{
+    const ecs_filter_t *filter = it->query;
+    if (!filter || !(filter->flags & EcsFilterHasSparse) || 
+        (it->flags & (EcsIterEntityOptional|EcsIterTableOnly))) 
+    {
+        return next(it);
+    }
+
+    ecs_entity_filter_iter_t *ent_it = it->priv.entity_iter;
+    const ecs_term_t *terms = filter->terms;
+    int32_t i, term_count = filter->term_count;
+
+    /* If a sparse term for $this returns data, or can be optionally set, each
+     * entity has to be returned separately. Otherwise return ranges of entities
+     * for which all sparse terms match. */
+    bool match_this = false, per_entity = false;
+    for (i = 0; i < term_count; i ++) {
+        const ecs_term_t *term = &terms[i];
+        if (!(term->flags & EcsTermIsSparse) || !ecs_term_match_this(term)) {
+            continue;
+        }
+        match_this = true;
+        if (term->oper == EcsOptional) {
+            per_entity = true;
+        } else if (term->oper != EcsNot && term->inout != EcsInOutNone && 
+            term->idr->type_info) 
+        {
+            per_entity = true;
+        }
+    }
+
+    do {
+        if (ent_it->sparse_active) {
+            /* Restore range returned by the iterator. Clear sparse pointers
+             * first, so they're not offset with the entity range. */
+            flecs_sparse_populate(it, filter, true);
+            int32_t shift = it->offset - ent_it->sparse_offset;
+            if (shift) {
+                flecs_offset_iter(it, -shift);
+            }
+            it->offset = ent_it->sparse_offset;
+            it->count = ent_it->sparse_count;
+            it->frame_offset = ent_it->sparse_frame_offset;
+
+            int32_t row = ent_it->sparse_row, end = it->count;
+            ecs_entity_t *entities = it->entities;
+            while (row < end && !flecs_sparse_this_match(filter, entities[row])) {
+                row ++;
+            }
+
+            if (row == end) {
+                ent_it->sparse_active = false;
+                continue;
+            }
+
+            int32_t last = row + 1;
+            if (!per_entity) {
+                while (last < end && 
+                    flecs_sparse_this_match(filter, entities[last])) 
+                {
+                    last ++;
+                }
+            }
+
+            ent_it->sparse_row = last;
+            if (row) {
+                flecs_offset_iter(it, row);
+            }
+            it->offset += row;
+            it->count = last - row;
+            it->frame_offset += row;
+            flecs_sparse_populate(it, filter, false);
+            return true;
+        }
+
+        if (!next(it)) {
+            return false;
+        }
+
+        /* Evaluate sparse terms with a fixed source */
+        for (i = 0; i < term_count; i ++) {
+            const ecs_term_t *term = &terms[i];
+            if (!(term->flags & EcsTermIsSparse)) {
+                continue;
+            }
+            if (ecs_term_match_this(term) || !(term->src.flags & EcsIsEntity)) {
+                continue;
+            }
+            if (!flecs_sparse_term_match(term, term->src.id)) {
+                break;
+            }
+        }
+
+        if (i != term_count) {
+            continue;
+        }
+
+        if (!match_this || !it->count || !it->entities) {
+            flecs_sparse_populate(it, filter, false);
+            return true;
+        }
+
+        ent_it->sparse_active = true;
+        ent_it->sparse_offset = it->offset;
+        ent_it->sparse_count = it->count;
+        ent_it->sparse_frame_offset = it->frame_offset;
+        ent_it->sparse_row = 0;
+    } while (true);
+}
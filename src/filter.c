@@ -836,6 +836,30 @@ int flecs_term_finalize(
         return -1;
     }
 
+    /* Sparse components aren't stored in tables and can't be inherited. They
+     * are evaluated per entity after a table has been matched. */
+    if (id_flags & EcsIdSparse) {
+        if (src_flags & (EcsUp | EcsDown)) {
+            flecs_filter_error(ctx, "sparse component cannot be traversed");
+            return -1;
+        }
+        if ((src->flags & EcsIsVariable) && (src->id != EcsThis)) {
+            flecs_filter_error(ctx, 
+                "sparse component can only be matched on $this or entity");
+            return -1;
+        }
+        if (term->oper != EcsAnd && term->oper != EcsNot && 
+            term->oper != EcsOptional) 
+        {
+            flecs_filter_error(ctx, "invalid operator for sparse component");
+            return -1;
+        }
+        src->flags &= ~(EcsUp | EcsDown);
+        src->flags |= EcsSelf;
+        src->trav = 0;
+        term->flags |= EcsTermIsSparse;
+    }
+
     if (term->id_flags & ECS_AND) {
         term->oper = EcsAndFrom;
         term->id &= ECS_COMPONENT_MASK;
@@ -873,7 +897,7 @@ int flecs_term_finalize(
     if (!ecs_term_match_this(term)) {
         trivial_term = false;
     }
-    if (term->flags & EcsTermIdInherited) {
+    if (term->flags & (EcsTermIdInherited|EcsTermIsSparse)) {
         trivial_term = false;
     }
     if (src->trav && src->trav != EcsIsA) {
@@ -1179,6 +1203,132 @@ ecs_term_t* flecs_filter_or_other_type(
     }
 }
 
+/* Get id that is added to filter signature for term. Returns 0 if the term
+ * can't be represented in the signature. */
+static
+ecs_id_t flecs_filter_signature_id(
+    const ecs_world_t *world,
+    const ecs_term_t *term)
+{
+    ecs_id_t id = term->id;
+    if (!ECS_IS_PAIR(id)) {
+        if (id & ECS_ID_FLAGS_MASK) {
+            return 0;
+        }
+        if (id == EcsWildcard || id == EcsAny) {
+            return 0;
+        }
+        if (term->first.flags & EcsIsVariable) {
+            return 0;
+        }
+        return id;
+    }
+
+    ecs_entity_t first = ECS_PAIR_FIRST(id);
+    ecs_entity_t second = ECS_PAIR_SECOND(id);
+    if (first == EcsAny || (term->first.flags & EcsIsVariable)) {
+        first = EcsWildcard;
+    }
+    if (second == EcsAny || (term->second.flags & EcsIsVariable)) {
+        second = EcsWildcard;
+    }
+    if (!first || !second) {
+        return 0;
+    }
+    if (first == EcsWildcard && second == EcsWildcard) {
+        return 0;
+    }
+
+    /* Union pairs are stored as (Union, Relationship) */
+    if (first != EcsWildcard) {
+        ecs_id_record_t *idr = flecs_id_record_get(world, 
+            ecs_pair(first, EcsWildcard));
+        if (idr && (idr->flags & EcsIdUnion)) {
+            return 0;
+        }
+    }
+
+    return ecs_pair(first, second);
+}
+
+/* Compute signatures with the ids a table must have to match the filter */
+static
+void flecs_filter_init_signature(
+    const ecs_world_t *world,
+    ecs_filter_t *f)
+{
+    ecs_os_zeromem(&f->signature);
+    ecs_os_zeromem(&f->signature_up);
+    ecs_os_zeromem(&f->signature_trav);
+
+    ecs_entity_t up_trav = 0;
+    int32_t i, term_count = f->term_count;
+    for (i = 0; i < term_count; i ++) {
+        ecs_term_t *term = &f->terms[i];
+        if (term->oper != EcsAnd || (i && term[-1].oper == EcsOr)) {
+            continue;
+        }
+        if (!ecs_term_match_this(term)) {
+            continue;
+        }
+        if (term->flags & (EcsTermIsSparse|EcsTermTransitive|
+            EcsTermReflexive|EcsTermIdInherited)) 
+        {
+            continue;
+        }
+
+        ecs_id_t id = flecs_filter_signature_id(world, term);
+        if (!id) {
+            continue;
+        }
+
+        const ecs_term_id_t *src = &term->src;
+        if (src->flags & EcsDown) {
+            continue;
+        }
+
+        if (!(src->flags & EcsUp)) {
+            flecs_id_signature_add(&f->signature, id);
+        } else if (!(src->flags & EcsSelf)) {
+            /* Table must have the traversed relationship */
+            flecs_id_signature_add(&f->signature, 
+                ecs_pair(src->trav, EcsWildcard));
+        } else {
+            /* Table must have the id, or have the traversed relationship. Only
+             * one relationship is tracked, which is typically IsA. */
+            if (!up_trav) {
+                up_trav = src->trav;
+                flecs_id_signature_add(&f->signature_trav, 
+                    ecs_pair(up_trav, EcsWildcard));
+            }
+            if (src->trav == up_trav) {
+                flecs_id_signature_add(&f->signature_up, id);
+            }
+        }
+    }
+}
+
+bool flecs_filter_signature_match(
+    const ecs_filter_t *filter,
+    const ecs_table_t *table)
+{
+    /* Flattened tables can match up terms without the relationship */
+    if (table->flags & EcsTableHasTarget) {
+        return true;
+    }
+
+    const ecs_id_signature_t *sig = &table->_->signature;
+    if (!flecs_id_signature_has(sig, &filter->signature)) {
+        return false;
+    }
+
+    if (!flecs_id_signature_has(sig, &filter->signature_up)) {
+        return flecs_id_signature_has(sig, &filter->signature_trav);
+    }
+
+    return true;
+}
+
 int ecs_filter_finalize(
     const ecs_world_t *world,
     ecs_filter_t *f)
@@ -1294,10 +1444,23 @@ int ecs_filter_finalize(
         if (filter_term) {
             filter_terms ++;
             term->flags |= EcsTermNoData;
+        } else if (term->flags & EcsTermIsSparse) {
+            /* Sparse data isn't stored in tables, so iterators populate it
+             * for each entity after matching the table. */
+            term->flags |= EcsTermNoData;
         } else {
             f->data_fields |= (1llu << term->field_index);
         }
 
+        if (term->flags & EcsTermIsSparse) {
+            if (i && term[-1].oper == EcsOr) {
+                flecs_filter_error(&ctx, 
+                    "sparse component cannot be used with OR operator");
+                return -1;
+            }
+            ECS_BIT_SET(f->flags, EcsFilterHasSparse);
+        }
+
         if (term->oper != EcsNot || !ecs_term_match_this(term)) {
             ECS_BIT_CLEAR(f->flags, EcsFilterMatchAnything);
         }
@@ -1349,6 +1512,28 @@ int ecs_filter_finalize(
         return -1;
     }
 
+    if (f->flags & EcsFilterHasSparse) {
+        /* Sparse terms for $this are evaluated for the entities of tables that
+         * are matched by the other terms, so there must be at least one. */
+        bool this_sparse = false, this_table = false;
+        for (i = 0; i < term_count; i ++) {
+            ecs_term_t *term = &terms[i];
+            if (!ecs_term_match_this(term)) {
+                continue;
+            }
+            if (term->flags & EcsTermIsSparse) {
+                this_sparse = true;
+            } else if (term->oper == EcsAnd) {
+                this_table = true;
+            }
+        }
+        if (this_sparse && !this_table) {
+            flecs_filter_error(&ctx, 
+                "sparse component requires a non-sparse term for $this");
+            return -1;
+        }
+    }
+
     f->field_count = flecs_ito(int8_t, field_count);
 
     if (field_count) {
@@ -1413,6 +1598,8 @@ int ecs_filter_finalize(
 
     ECS_BIT_COND(f->flags, EcsFilterHasCondSet, cond_set);
 
+    flecs_filter_init_signature(world, f);
+
     /* Check if this is a trivial filter */
     if ((f->flags & EcsFilterMatchOnlyThis)) {
         if (!(f->flags & 
@@ -2326,6 +2513,17 @@ bool flecs_filter_match_table(
         match_count = *matches_left;
     }
 
+    /* Reject tables that can't match before looking up table records. When
+     * a term is skipped the signature can't be used, as it contains the id of
+     * the skipped term. */
+    if (table && (skip_term == -1) && 
+        !(iter_flags & (EcsFilterPopulate|EcsIterIgnoreThis))) 
+    {
+        if (!flecs_filter_signature_match(filter, table)) {
+            return false;
+        }
+    }
+
     for (i = 0; i < count; i ++) {
         ecs_term_t *term = &terms[i];
         ecs_oper_kind_t oper = term->oper;
@@ -2347,6 +2545,23 @@ bool flecs_filter_match_table(
             continue;
         }
 
+        if (term->flags & EcsTermIsSparse) {
+            /* Sparse terms are evaluated per entity by the iterator */
+            if (ids) {
+                ids[t_i] = term->id;
+            }
+            if (columns) {
+                columns[t_i] = 0;
+            }
+            if (sources) {
+                sources[t_i] = ecs_term_match_this(term) ? 0 : src_id;
+            }
+            if (match_indices) {
+                match_indices[t_i] = 0;
+            }
+            continue;
+        }
+
         if (!ecs_term_match_this(term)) {
             if (ecs_is_alive(world, src_id)) {
                 match_table = ecs_get_table(world, src_id);
@@ -2936,6 +3151,10 @@ int32_t ecs_filter_pivot_term(
             continue;
         }
 
+        if (term->flags & EcsTermIsSparse) {
+            continue;
+        }
+
         ecs_id_record_t *idr = flecs_query_id_record_get(world, id);
         if (!idr) {
             /* If one of the terms does not match with any data, iterator 
@@ -3109,7 +3328,8 @@ error:
     return false;
 }
 
-bool ecs_filter_next_instanced(
+static
+bool flecs_filter_next_instanced(
     ecs_iter_t *it)
 {
     ecs_check(it != NULL, ECS_INVALID_PARAMETER, NULL);
@@ -3235,6 +3455,17 @@ bool ecs_filter_next_instanced(
 
                     table = term_iter->table;
 
+                    /* Reject tables that can't match the other terms. The
+                     * table matches the pivot term, so the signature of the
+                     * filter can be used even though the term is skipped. */
+                    if (table && !(it->flags & EcsIterIgnoreThis) &&
+                        !flecs_filter_signature_match(filter, table))
+                    {
+                        it->table = table;
+                        iter->matches_left = 0;
+                        continue;
+                    }
+
                     if (pivot_term != -1) {
                         int32_t index = term->field_index;
                         it->ids[index] = term_iter->id;
@@ -3355,3 +3586,9 @@ yield:
     ECS_BIT_SET(it->flags, EcsIterIsValid);
     return true;    
 }
+
+bool ecs_filter_next_instanced(
+    ecs_iter_t *it)
+{
+    return flecs_sparse_filter_next(it, flecs_filter_next_instanced);
+}
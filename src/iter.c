@@ -407,7 +407,8 @@ bool ecs_field_is_set(
     ecs_assert(index >= 1, ECS_INVALID_PARAMETER, NULL);
     int32_t column = it->columns[index - 1];
     if (!column) {
-        return false;
+        /* Sparse components aren't matched with a table column */
+        return (it->sparse_fields & (1u << (index - 1))) != 0;
     } else if (column < 0) {
         if (it->references) {
             column = -column - 1;
@@ -594,6 +595,90 @@ error:
     return 0;
 }
 
+static
+void flecs_iter_add_remove_id(
+    ecs_iter_t *it,
+    ecs_id_t id,
+    bool remove)
+{
+    ECS_BIT_SET(it->flags, EcsIterNoData);
+    ECS_BIT_SET(it->flags, EcsIterIsInstanced);
+
+    /* Collect results before modifying tables, as moving entities while the
+     * iterator is still running would invalidate it */
+    ecs_vec_t ranges, entities;
+    ecs_vec_init_t(NULL, &ranges, ecs_table_range_t, 0);
+    ecs_vec_init_t(NULL, &entities, ecs_entity_t, 0);
+
+    while (ecs_iter_next(it)) {
+        int32_t i, count = it->count;
+        if (!count) {
+            continue;
+        }
+
+        if (it->table) {
+            ecs_assert(flecs_table_entities_array(it->table)[it->offset] ==
+                it->entities[0], ECS_INTERNAL_ERROR, NULL);
+            ecs_table_range_t *range = ecs_vec_append_t(
+                NULL, &ranges, ecs_table_range_t);
+            range->table = it->table;
+            range->offset = it->offset;
+            range->count = count;
+        } else {
+            for (i = 0; i < count; i ++) {
+                ecs_vec_append_t(NULL, &entities, ecs_entity_t)[0] =
+                    it->entities[i];
+            }
+        }
+    }
+
+    ecs_world_t *world = it->world;
+    if (ecs_vec_count(&ranges)) {
+        flecs_bulk_add_remove_id(world, ecs_vec_first(&ranges),
+            ecs_vec_count(&ranges), id, remove);
+    }
+
+    /* Entities that are not stored in a table aren't moved by ranges */
+    int32_t i, count = ecs_vec_count(&entities);
+    ecs_entity_t *ids = ecs_vec_first(&entities);
+    for (i = 0; i < count; i ++) {
+        if (remove) {
+            ecs_remove_id(world, ids[i], id);
+        } else {
+            ecs_add_id(world, ids[i], id);
+        }
+    }
+
+    ecs_vec_fini_t(NULL, &ranges, ecs_table_range_t);
+    ecs_vec_fini_t(NULL, &entities, ecs_entity_t);
+}
+
+void ecs_iter_add_id(
+    ecs_iter_t *it,
+    ecs_id_t id)
+{
+    ecs_check(it != NULL, ECS_INVALID_PARAMETER, NULL);
+    ecs_check(it->next != NULL, ECS_INVALID_PARAMETER, NULL);
+    ecs_check(ecs_id_is_valid(it->real_world, id),
+        ECS_INVALID_PARAMETER, NULL);
+    flecs_iter_add_remove_id(it, id, false);
+error:
+    return;
+}
+
+void ecs_iter_remove_id(
+    ecs_iter_t *it,
+    ecs_id_t id)
+{
+    ecs_check(it != NULL, ECS_INVALID_PARAMETER, NULL);
+    ecs_check(it->next != NULL, ECS_INVALID_PARAMETER, NULL);
+    ecs_check(ecs_id_is_valid(it->real_world, id) || ecs_id_is_wildcard(id),
+        ECS_INVALID_PARAMETER, NULL);
+    flecs_iter_add_remove_id(it, id, true);
+error:
+    return;
+}
+
 ecs_entity_t ecs_iter_first(
     ecs_iter_t *it)
 {
@@ -875,7 +960,6 @@ error:
     return (ecs_iter_t){ 0 };
 }
 
-static
 void flecs_offset_iter(
     ecs_iter_t *it,
     int32_t offset)
@@ -1027,6 +1111,150 @@ error:
     return (ecs_iter_t){ 0 };
 }
 
+static
+int32_t flecs_worker_match_weight(
+    const ecs_query_table_match_t *match)
+{
+    if (!match->table) {
+        return 1;
+    }
+    if (match->count) {
+        return match->count;
+    }
+    return ecs_table_count(match->table);
+}
+
+/* Assign a contiguous range of the entities matched by a query to a worker.
+ * The range is computed from the prefix sum of the entity counts of all
+ * matches, so that each worker gets the same number of entities. Only the
+ * matches on the range boundaries are divided between workers, so that each
+ * worker visits roughly 1/Nth of the matched tables. */
+static
+void flecs_worker_partition_query(
+    ecs_iter_t *it,
+    ecs_worker_iter_t *worker)
+{
+    ecs_query_iter_t *iter = &it->priv.iter.query;
+    ecs_query_table_match_t *cur, *last = iter->last, *end = last;
+    int64_t total = 0, pos = 0, lo, hi;
+    int32_t index = worker->index, count = worker->count, skipped = 0;
+
+    for (cur = iter->node; cur != last; cur = cur->next) {
+        total += flecs_worker_match_weight(cur);
+    }
+
+    if (!total) {
+        /* Nothing to divide, let the first worker process the (empty) matches
+         * so that iteration behaves the same as without partitioning. */
+        if (index) {
+            iter->node = last;
+        }
+        return;
+    }
+
+    lo = (total * index) / count;
+    hi = (total * (index + 1)) / count;
+    if (lo == hi) {
+        iter->node = last;
+        return;
+    }
+
+    for (cur = iter->node; cur != last; cur = cur->next) {
+        int64_t weight = flecs_worker_match_weight(cur);
+        int64_t start = pos;
+        pos += weight;
+
+        if (pos <= lo) {
+            if (cur->table) {
+                skipped += ecs_table_count(cur->table);
+            }
+            continue;
+        }
+        if (start >= hi) {
+            end = cur;
+            break;
+        }
+
+        if (!worker->first) {
+            worker->first = cur;
+            worker->first_row = cur->offset + 
+                (int32_t)(lo > start ? lo - start : 0);
+        }
+
+        worker->last = cur;
+        worker->last_row = cur->offset + 
+            (int32_t)((hi < pos ? hi : pos) - start);
+    }
+
+    iter->node = worker->first;
+    iter->last = end;
+
+    /* Keep frame offset consistent with iterating all matches */
+    it->frame_offset += skipped;
+}
+
+ecs_iter_t ecs_balanced_worker_iter(
+    const ecs_iter_t *it,
+    int32_t index,
+    int32_t count)
+{
+    ecs_iter_t result = ecs_worker_iter(it, index, count);
+    if (!result.next) {
+        return result;
+    }
+
+    /* Entities can only be assigned to workers before the query iterator has
+     * returned its first result. */
+    if (it->next == ecs_query_next && !it->priv.iter.query.prev) {
+        ecs_worker_iter_t *worker = &result.priv.iter.worker;
+        flecs_worker_partition_query(result.chain_it, worker);
+        worker->balanced = true;
+    }
+
+    return result;
+}
+
+/* Clip result of query to the rows assigned to the worker */
+static
+bool flecs_worker_clip_balanced(
+    ecs_iter_t *it,
+    ecs_worker_iter_t *worker)
+{
+    if (!it->table) {
+        return true;
+    }
+
+    ecs_query_table_match_t *match = it->chain_it->priv.iter.query.prev;
+    int32_t offset = it->offset, end = offset + it->count;
+    int32_t first = offset, last = end;
+
+    if (match == worker->first && worker->first_row > first) {
+        first = worker->first_row;
+    }
+    if (match == worker->last && worker->last_row < last) {
+        last = worker->last_row;
+    }
+    if (first >= last) {
+        return false;
+    }
+    if (first == offset && last == end) {
+        return true;
+    }
+
+    int32_t skip = first - offset;
+    it->frame_offset += skip;
+    flecs_offset_iter(it, skip);
+    it->count = last - first;
+
+    if (ECS_BIT_IS_SET(it->flags, EcsIterIsInstanced)) {
+        it->offset += skip;
+    } else {
+        it->offset = 0;
+    }
+
+    return true;
+}
+
 static
 bool ecs_worker_next_instanced(
     ecs_iter_t *it)
@@ -1042,6 +1270,19 @@ bool ecs_worker_next_instanced(
     int32_t res_count = iter->count, res_index = iter->index;
     int32_t per_worker, instances_per_worker, first;
 
+    if (iter->balanced) {
+        /* Query only returns matches assigned to this worker */
+        do {
+            if (!ecs_iter_next(chain_it)) {
+                return false;
+            }
+
+            ecs_os_memcpy(it, chain_it, offsetof(ecs_iter_t, priv));
+            ECS_BIT_COND(it->flags, EcsIterIsInstanced, instanced);
+        } while (!flecs_worker_clip_balanced(it, iter));
+        return true;
+    }
+
     do {
         if (!ecs_iter_next(chain_it)) {
             return false;
@@ -1115,3 +1356,83 @@ bool ecs_worker_next(
 error:
     return false;
 }
+
+ecs_iter_t ecs_chunk_iter(
+    const ecs_iter_t *it,
+    int32_t chunk_size)
+{
+    ecs_check(it != NULL, ECS_INVALID_PARAMETER, NULL);
+    ecs_check(it->next != NULL, ECS_INVALID_PARAMETER, NULL);
+    ecs_check(chunk_size > 0, ECS_INVALID_PARAMETER, NULL);
+    ecs_check(!(chunk_size & (chunk_size - 1)), ECS_INVALID_PARAMETER, 
+        "chunk size must be a power of two");
+
+    ecs_iter_t result = *it;
+    result.priv.cache.stack_cursor = NULL; /* Don't copy allocator cursor */
+
+    result.priv.iter.chunk = (ecs_chunk_iter_t){
+        .size = chunk_size
+    };
+    result.next = ecs_chunk_next;
+    result.fini = ecs_chained_iter_fini;
+    result.chain_it = ECS_CONST_CAST(ecs_iter_t*, it);
+    ECS_BIT_SET(result.flags, EcsIterIsInstanced);
+
+    return result;
+error:
+    return (ecs_iter_t){ 0 };
+}
+
+bool ecs_chunk_next(
+    ecs_iter_t *it)
+{
+    ecs_check(it != NULL, ECS_INVALID_PARAMETER, NULL);
+    ecs_check(it->next == ecs_chunk_next, ECS_INVALID_PARAMETER, NULL);
+    ecs_check(it->chain_it != NULL, ECS_INVALID_PARAMETER, NULL);
+
+    ecs_iter_t *chain_it = it->chain_it;
+    ecs_chunk_iter_t *iter = &it->priv.iter.chunk;
+
+    if (iter->remaining) {
+        /* Advance to next chunk in current result of chained iterator */
+        int32_t prev = it->count;
+        flecs_offset_iter(it, prev);
+        it->offset += prev;
+        it->frame_offset += prev;
+    } else {
+        ECS_BIT_SET(chain_it->flags, EcsIterIsInstanced);
+
+        do {
+            if (!ecs_iter_next(chain_it)) {
+                return false;
+            }
+
+            /* Copy everything up to the private iterator data */
+            ecs_os_memcpy(it, chain_it, offsetof(ecs_iter_t, priv));
+            ECS_BIT_SET(it->flags, EcsIterIsInstanced);
+
+            if (!chain_it->table) {
+                it->instance_count = it->count;
+                return true; /* Task query */
+            }
+
+            iter->remaining = it->count;
+        } while (!iter->remaining);
+    }
+
+    /* Don't cross a chunk boundary, so that a chunk that starts on a boundary
+     * starts at an aligned address when aligned columns are enabled. */
+    int32_t size = iter->size;
+    int32_t count = size - (it->offset & (size - 1));
+    if (count > iter->remaining) {
+        count = iter->remaining;
+    }
+
+    it->count = count;
+    it->instance_count = count;
+    iter->remaining -= count;
+
+    return true;
+error:
+    return false;
+}
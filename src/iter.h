@@ -25,6 +25,11 @@ void flecs_iter_populate_data(
 bool flecs_iter_next_row(
     ecs_iter_t *it);
 
+/* Offset entities & component pointers of iterator for This variable */
+void flecs_offset_iter(
+    ecs_iter_t *it,
+    int32_t offset);
+
 bool flecs_iter_next_instanced(
     ecs_iter_t *it,
     bool result);
@@ -698,9 +698,7 @@ void flecs_emit_forward_and_cache_id(
     elem->record = tgt_record;
     elem->src = tgt;
     elem->id = idr->id;
-#ifndef NDEBUG
     elem->table = tgt_table;
-#endif
     ecs_assert(tgt_table == tgt_record->table, ECS_INTERNAL_ERROR, NULL);
 
     flecs_emit_forward_id(world, er, er_onset, emit_ids, it, table, idr,
@@ -733,6 +731,28 @@ bool flecs_emit_stack_has(
     return flecs_emit_stack_at(stack, idr) != ecs_vec_count(stack);
 }
 
+/* Entities can move to another table without an event that invalidates the
+ * cache, so also check that cached entities are still in the same table. */
+static
+bool flecs_emit_reachable_cache_valid(
+    const ecs_reachable_cache_t *rc)
+{
+    if (rc->current != rc->generation) {
+        return false;
+    }
+
+    const ecs_reachable_elem_t *elems = ecs_vec_first_t(&rc->ids, 
+        ecs_reachable_elem_t);
+    int32_t i, count = ecs_vec_count(&rc->ids);
+    for (i = 0; i < count; i ++) {
+        if (elems[i].record->table != elems[i].table) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
 static
 void flecs_emit_forward_cached_ids(
     ecs_world_t *world,
@@ -823,7 +843,7 @@ void flecs_emit_forward_table_up(
      * keep track so that we can update two records for the cost of one. */
     ecs_reachable_cache_t *rc = &tgt_idr->reachable;
     bool parent_revalidate = (reachable_ids != &rc->ids) && 
-        (rc->current != rc->generation);
+        !flecs_emit_reachable_cache_valid(rc);
     if (parent_revalidate) {
         ecs_vec_reset_t(a, &rc->ids, ecs_reachable_elem_t);
     }
@@ -855,7 +875,7 @@ void flecs_emit_forward_table_up(
             t[0] = tgt_table;
 
             ecs_reachable_cache_t *idr_rc = &idr->reachable;
-            if (idr_rc->current == idr_rc->generation) {
+            if (flecs_emit_reachable_cache_valid(idr_rc)) {
                 /* Cache hit, use cached ids to prevent traversing the same
                  * hierarchy multiple times. This especially speeds up code 
                  * where (deep) hierarchies are created. */
@@ -897,9 +917,7 @@ void flecs_emit_forward_table_up(
             elem->record = tgt_record;
             elem->src = tgt;
             elem->id = idr->id;
-#ifndef NDEBUG
             elem->table = tgt_table;
-#endif
         }
 
         /* Skip id if it's masked by a lower table in the tree */
@@ -982,7 +1000,7 @@ void flecs_emit_forward(
 {
     ecs_reachable_cache_t *rc = &idr->reachable;
 
-    if (rc->current != rc->generation) {
+    if (!flecs_emit_reachable_cache_valid(rc)) {
         /* Cache miss, iterate the tree to find ids to forward */
         if (ecs_should_log_3()) {
             char *idstr = ecs_id_str(world, idr->id);
@@ -812,6 +812,12 @@ int flecs_multi_observer_init(
         ecs_oper_kind_t oper = term->oper;
         ecs_id_t id = term->id;
 
+        /* Sparse components are not stored in tables, so table events can't
+         * be observed for them. */
+        if (term->flags & EcsTermIsSparse) {
+            continue;
+        }
+
         /* AndFrom & OrFrom terms insert multiple observers */
         if (oper == EcsAndFrom || oper == EcsOrFrom) {
             const ecs_type_t *type = ecs_get_type(world, id);
@@ -914,6 +920,19 @@ ecs_entity_t ecs_observer_init(
         /* Observer must have at least one term */
         ecs_check(observer->filter.term_count > 0, ECS_INVALID_PARAMETER, NULL);
 
+        /* Sparse components don't emit events, so only table events can be
+         * observed for filters that contain sparse terms. */
+        if (observer->filter.flags & EcsFilterHasSparse) {
+            int i;
+            for (i = 0; i < FLECS_EVENT_DESC_MAX && desc->events[i]; i ++) {
+                ecs_entity_t event = desc->events[i];
+                ecs_check(event == EcsOnTableCreate || 
+                    event == EcsOnTableDelete || event == EcsOnTableEmpty ||
+                    event == EcsOnTableFill, ECS_UNSUPPORTED, 
+                        "observer cannot match sparse component");
+            }
+        }
+
         poly->poly = observer;
 
         ecs_observable_t *observable = desc->observable;
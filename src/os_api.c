@@ -461,6 +461,14 @@ bool ecs_os_has_heap(void) {
         (ecs_os_api.free_ != NULL);
 }
 
+bool ecs_os_has_vmem(void) {
+    return 
+        (ecs_os_api.vmem_reserve_ != NULL) &&
+        (ecs_os_api.vmem_commit_ != NULL) &&
+        (ecs_os_api.vmem_decommit_ != NULL) &&
+        (ecs_os_api.vmem_release_ != NULL);
+}
+
 bool ecs_os_has_threading(void) {
     return
         (ecs_os_api.mutex_new_ != NULL) &&
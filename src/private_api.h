@@ -67,6 +67,19 @@ ecs_entity_t flecs_get_oneof(
     const ecs_world_t *world,
     ecs_entity_t e);
 
+/* Remove all sparse components from an entity */
+void flecs_entity_remove_sparse(
+    ecs_world_t *world,
+    ecs_entity_t entity);
+
+/* Add or remove id for ranges of entities. Ranges may be reordered. */
+void flecs_bulk_add_remove_id(
+    ecs_world_t *world,
+    ecs_table_range_t *ranges,
+    int32_t count,
+    ecs_id_t id,
+    bool remove);
+
 void flecs_notify_on_remove(
     ecs_world_t *world,
     ecs_table_t *table,
@@ -130,6 +143,12 @@ bool flecs_term_match_table(
     bool first,
     ecs_flags32_t iter_flags);
 
+/* Test if table can match filter. Returns false if table can't match, true if
+ * table may match. */
+bool flecs_filter_signature_match(
+    const ecs_filter_t *filter,
+    const ecs_table_t *table);
+
 /* Match table with filter */
 bool flecs_filter_match_table(
     ecs_world_t *world,
@@ -154,6 +173,25 @@ void flecs_query_notify(
     ecs_query_t *query,
     ecs_query_event_t *event);
 
+/* Rematch queries after component monitors were invalidated. If the world has
+ * worker threads, queries are matched in parallel. */
+void flecs_query_rematch_all(
+    ecs_world_t *world,
+    ecs_query_t **queries,
+    int32_t count);
+
+#ifdef FLECS_PIPELINE
+/* Test if worker threads are idle and can run a task outside of the pipeline */
+bool flecs_workers_can_run_task(
+    const ecs_world_t *world);
+
+/* Run task on all worker threads and the main thread, wait until done */
+void flecs_workers_run_task(
+    ecs_world_t *world,
+    ecs_worker_task_action_t action,
+    void *ctx);
+#endif
+
 ecs_id_t flecs_to_public_id(
     ecs_id_t id);
 
@@ -242,6 +280,11 @@ void flecs_entity_filter_fini(
 int flecs_entity_filter_next(
     ecs_entity_filter_iter_t *it);
 
+/* Split up results of an iterator into ranges that match sparse terms */
+bool flecs_sparse_filter_next(
+    ecs_iter_t *it,
+    ecs_iter_next_action_t next);
+
 ////////////////////////////////////////////////////////////////////////////////
 //// Utilities
 ////////////////////////////////////////////////////////////////////////////////
@@ -18,6 +18,7 @@
 
 #include "flecs.h"
 #include "storage/entity_index.h"
+#include "datastructures/block_allocator_cache.h"
 #include "datastructures/stack_allocator.h"
 #include "flecs/private/bitset.h"
 #include "flecs/private/switch_list.h"
@@ -148,6 +149,13 @@ typedef struct ecs_entity_filter_iter_t {
     int32_t sw_smallest;
     int32_t flat_tree_offset;
     int32_t target_count;
+
+    /* Range returned by iterator that is split up by sparse terms */
+    int32_t sparse_offset;
+    int32_t sparse_count;
+    int32_t sparse_row;
+    int32_t sparse_frame_offset;
+    bool sparse_active;
 } ecs_entity_filter_iter_t;
 
 /** Table match data.
@@ -180,6 +188,7 @@ typedef struct ecs_query_table_t {
     ecs_query_table_match_t *last;   /* Last discovered match for table */
     uint64_t table_id;
     int32_t rematch_count;           /* Track whether table was rematched */
+    int32_t sorted_count;            /* Number of rows sorted by last sort */
 } ecs_query_table_t;
 
 /** Points to the beginning & ending of a query group */
@@ -187,6 +196,9 @@ typedef struct ecs_query_table_list_t {
     ecs_query_table_match_t *first;
     ecs_query_table_match_t *last;
     ecs_query_group_info_t info;
+    int32_t slice_offset;            /* First sorted slice of list */
+    int32_t slice_count;             /* Number of sorted slices of list */
+    bool sort_dirty;                 /* Do sorted slices need to be rebuilt */
 } ecs_query_table_list_t;
 
 /* Query event type for notifying queries of world events */
@@ -230,6 +242,7 @@ struct ecs_query_t {
     /* Table sorting */
     ecs_entity_t order_by_component;
     ecs_order_by_action_t order_by;
+    ecs_order_by_key_action_t order_by_key;
     ecs_sort_table_action_t sort_table;
     ecs_vec_t table_slices;
     int32_t order_by_term;
@@ -314,6 +327,7 @@ typedef struct ecs_stage_allocators_t {
     ecs_stack_t iter_stack;
     ecs_stack_t deser_stack;
     ecs_block_allocator_t cmd_entry_chunk;
+    ecs_balloc_cache_t stack_pages;  /* Stage cache for world stack pages */
 } ecs_stage_allocators_t;
 
 /** Types for deferred operations */
@@ -484,6 +498,12 @@ typedef struct ecs_action_elem_t {
 
 typedef struct ecs_pipeline_state_t ecs_pipeline_state_t;
 
+/* Task that worker threads run outside of a pipeline operation */
+typedef void (*ecs_worker_task_action_t)(
+    ecs_world_t *world,
+    ecs_stage_t *stage,
+    void *ctx);
+
 /** The world stores and manages all ECS data. An application can have more than
  * one world, but data is not shared between worlds. */
 struct ecs_world_t {
@@ -492,6 +512,7 @@ struct ecs_world_t {
     /* --  Type metadata -- */
     ecs_id_record_t *id_index_lo;
     ecs_map_t id_index_hi;           /* map<id, ecs_id_record_t*> */
+    ecs_vec_t sparse_ids;            /* vector<ecs_id_record_t*> */
     ecs_sparse_t type_info;          /* sparse<type_id, type_info_t> */
 
     /* -- Cached handle to id records -- */
@@ -544,13 +565,24 @@ struct ecs_world_t {
     void *on_commands_ctx;
     void *on_commands_ctx_active;
 
+    /* Internal callback for recording commands. Unlike on_commands, the action
+     * stays active until it is reset, and is only invoked for command queues
+     * that are merged with the world. */
+    ecs_on_commands_action_t on_commands_record;
+    void *on_commands_record_ctx;
+
     /* -- Multithreading -- */
     ecs_os_cond_t worker_cond;       /* Signal that worker threads can start */
     ecs_os_cond_t sync_cond;         /* Signal that worker thread job is done */
     ecs_os_mutex_t sync_mutex;       /* Mutex for job_cond */
     int32_t workers_running;         /* Number of threads running */
     int32_t workers_waiting;         /* Number of workers waiting on sync */
+    int32_t workers_gen;             /* Incremented when workers are signalled */
+    int32_t workers_parked;          /* Number of workers blocked on worker_cond */
+    int32_t sync_parked;             /* Nonzero if main thread blocks on sync_cond */
     ecs_pipeline_state_t* pq;        /* Pointer to the pipeline for the workers to execute */
+    ecs_worker_task_action_t worker_task; /* Task to run instead of pipeline */
+    void *worker_task_ctx;           /* Context passed to worker task */
     bool workers_use_task_api;       /* Workers are short-lived tasks, not long-running threads */
 
     /* -- Time management -- */
@@ -573,6 +605,8 @@ struct ecs_world_t {
     /* -- Allocators -- */
     ecs_world_allocators_t allocators; /* Static allocation sizes */
     ecs_allocator_t allocator;       /* Dynamic allocation sizes */
+    ecs_allocator_t column_allocator; /* Aligned allocations for columns */
+    ecs_balloc_depot_t stack_pages;  /* Stack pages shared between stages */
 
     void *ctx;                       /* Application context */
     void *binding_ctx;               /* Binding-specific context */
@@ -638,12 +638,14 @@ bool flecs_query_check_match_monitor_term(
         query->filter.world, cur.table)[cur.column + 1];
 }
 
-/* Check if any term for match has changed */
+/* Check if any term for match has changed. If shared_only is true, only test
+ * fields that are not owned by the matched table. */
 static
-bool flecs_query_check_match_monitor(
+bool flecs_query_check_match_monitor_w_shared(
     ecs_query_t *query,
     ecs_query_table_match_t *match,
-    const ecs_iter_t *it)
+    const ecs_iter_t *it,
+    bool shared_only)
 {
     ecs_assert(match != NULL, ECS_INTERNAL_ERROR, NULL);
 
@@ -658,7 +660,7 @@ bool flecs_query_check_match_monitor(
         dirty_state = flecs_table_get_dirty_state(
             query->filter.world, table);
         ecs_assert(dirty_state != NULL, ECS_INTERNAL_ERROR, NULL);
-        if (monitor[0] != dirty_state[0]) {
+        if (!shared_only && (monitor[0] != dirty_state[0])) {
             return true;
         }
     }
@@ -683,7 +685,7 @@ bool flecs_query_check_match_monitor(
         if (columns[i] >= 0) {
             /* owned component */
             ecs_assert(dirty_state != NULL, ECS_INTERNAL_ERROR, NULL);
-            if (mon != dirty_state[column + 1]) {
+            if (!shared_only && (mon != dirty_state[column + 1])) {
                 return true;
             }
             continue;
@@ -769,6 +771,16 @@ bool flecs_query_check_match_monitor(
     return false;
 }
 
+/* Check if any term for match has changed */
+static
+bool flecs_query_check_match_monitor(
+    ecs_query_t *query,
+    ecs_query_table_match_t *match,
+    const ecs_iter_t *it)
+{
+    return flecs_query_check_match_monitor_w_shared(query, match, it, false);
+}
+
 /* Check if any term for matched table has changed */
 static
 bool flecs_query_check_table_monitor(
@@ -1035,6 +1047,10 @@ bool flecs_query_match_table(
         return false;
     }
 
+    if (!flecs_filter_signature_match(filter, table)) {
+        return false;
+    }
+
     ecs_iter_t it = flecs_filter_iter_w_flags(world, filter, EcsIterMatchVar|
         EcsIterIsInstanced|EcsIterNoData|EcsIterEntityOptional);
     ecs_iter_set_var_as_table(&it, var_id, table);
@@ -1055,22 +1071,223 @@ bool flecs_query_match_table(
 
 ECS_SORT_TABLE_WITH_COMPARE(_, flecs_query_sort_table_generic, order_by, static)
 
+/* Sort key with row of entity (or index of table) it was extracted from */
+typedef struct sort_key_t {
+    uint64_t key;
+    int32_t row;
+} sort_key_t;
+
+/* Rows of a table that are compared during incremental sorting. If keys is
+ * set rows are compared by key, otherwise the compare function is used. */
+typedef struct sort_rows_t {
+    const ecs_entity_t *entities;
+    const void *ptr;
+    int32_t size;
+    ecs_order_by_action_t compare;
+    const sort_key_t *keys;
+} sort_rows_t;
+
 static
-void flecs_query_sort_table(
+int flecs_query_compare_rows(
+    const sort_rows_t *rows,
+    int32_t a,
+    int32_t b)
+{
+    if (rows->keys) {
+        uint64_t key_a = rows->keys[a].key, key_b = rows->keys[b].key;
+        return (key_a > key_b) - (key_a < key_b);
+    }
+
+    const void *ptr_a = NULL, *ptr_b = NULL;
+    if (rows->ptr) {
+        ptr_a = ECS_ELEM(rows->ptr, rows->size, a);
+        ptr_b = ECS_ELEM(rows->ptr, rows->size, b);
+    }
+
+    return rows->compare(rows->entities[a], ptr_a, rows->entities[b], ptr_b);
+}
+
+/* Stable bottom-up merge sort for an array of row indices */
+static
+int32_t* flecs_query_sort_row_indices(
+    const sort_rows_t *rows,
+    int32_t *indices,
+    int32_t *tmp,
+    int32_t count)
+{
+    int32_t width;
+    for (width = 1; width < count; width *= 2) {
+        int32_t lo;
+        for (lo = 0; lo < count; lo += 2 * width) {
+            int32_t mid = ECS_MIN(lo + width, count);
+            int32_t hi = ECS_MIN(lo + 2 * width, count);
+            int32_t i = lo, j = mid, k = lo;
+            while (i < mid && j < hi) {
+                if (flecs_query_compare_rows(rows, indices[j], indices[i]) < 0) {
+                    tmp[k ++] = indices[j ++];
+                } else {
+                    tmp[k ++] = indices[i ++];
+                }
+            }
+            while (i < mid) {
+                tmp[k ++] = indices[i ++];
+            }
+            while (j < hi) {
+                tmp[k ++] = indices[j ++];
+            }
+        }
+
+        int32_t *swap = indices;
+        indices = tmp;
+        tmp = swap;
+    }
+
+    return indices;
+}
+
+/* Reorder table so that the entity that is currently at row order[i] is moved
+ * to row i. Rows that are already in the right place are not touched. */
+static
+void flecs_query_table_apply_order(
+    ecs_world_t *world,
+    ecs_table_t *table,
+    const int32_t *order,
+    int32_t count)
+{
+    int32_t i, first = 0;
+    while (first < count && order[first] == first) {
+        first ++;
+    }
+
+    if (first == count) {
+        return;
+    }
+
+    ecs_allocator_t *a = &world->allocator;
+    int32_t *pos = flecs_alloc_n(a, int32_t, count * 2);
+    int32_t *orig = &pos[count];
+    for (i = 0; i < count; i ++) {
+        pos[i] = orig[i] = i;
+    }
+
+    for (i = first; i < count; i ++) {
+        int32_t src_orig = order[i];
+        int32_t src = pos[src_orig];
+        if (src != i) {
+            int32_t moved = orig[i];
+            flecs_table_swap(world, table, i, src);
+            orig[src] = moved;
+            pos[moved] = src;
+            orig[i] = src_orig;
+            pos[src_orig] = i;
+        }
+    }
+
+    flecs_free_n(a, int32_t, count * 2, pos);
+}
+
+/* Incrementally sort a table that was sorted before. Rows that were appended
+ * after the sorted watermark and rows that are no longer in order are sorted
+ * separately and then merged with the rows that are still in order. Returns
+ * false if too many rows are out of order, in which case the table should be
+ * fully sorted. */
+static
+bool flecs_query_sort_table_incremental(
     ecs_world_t *world,
     ecs_table_t *table,
+    const sort_rows_t *rows,
+    int32_t count,
+    int32_t sorted_count)
+{
+    if (!sorted_count) {
+        return false;
+    }
+
+    /* Incremental sorting only pays off if few rows changed */
+    int32_t max_unsorted = count / 8;
+    if (count - sorted_count > max_unsorted) {
+        return false;
+    }
+
+    ecs_allocator_t *a = &world->allocator;
+    int32_t buf_count = count * 2 + (max_unsorted + 1) * 2;
+    int32_t *buf = flecs_alloc_n(a, int32_t, buf_count);
+    int32_t *kept = buf;
+    int32_t *order = &kept[count];
+    int32_t *unsorted = &order[count];
+    int32_t *tmp = &unsorted[max_unsorted + 1];
+    int32_t i, kept_count = 0, unsorted_count = 0;
+    bool result = false;
+
+    /* Find rows that are in order. If a row in the sorted range breaks the 
+     * order but is in order with the row before the last in-order row, the 
+     * last in-order row was modified and is the one that's out of place. */
+    for (i = 0; i < count; i ++) {
+        if (!kept_count || 
+            flecs_query_compare_rows(rows, i, kept[kept_count - 1]) >= 0) 
+        {
+            kept[kept_count ++] = i;
+            continue;
+        }
+
+        if (i < sorted_count && (kept_count == 1 || 
+            flecs_query_compare_rows(rows, i, kept[kept_count - 2]) >= 0)) 
+        {
+            unsorted[unsorted_count ++] = kept[kept_count - 1];
+            kept[kept_count - 1] = i;
+        } else {
+            unsorted[unsorted_count ++] = i;
+        }
+
+        if (unsorted_count > max_unsorted) {
+            goto done;
+        }
+    }
+
+    result = true;
+    if (!unsorted_count) {
+        goto done;
+    }
+
+    int32_t *sorted = flecs_query_sort_row_indices(
+        rows, unsorted, tmp, unsorted_count);
+
+    /* Merge unsorted rows into rows that are in order */
+    int32_t k = 0, u = 0, o = 0;
+    while (k < kept_count && u < unsorted_count) {
+        if (flecs_query_compare_rows(rows, sorted[u], kept[k]) < 0) {
+            order[o ++] = sorted[u ++];
+        } else {
+            order[o ++] = kept[k ++];
+        }
+    }
+    while (k < kept_count) {
+        order[o ++] = kept[k ++];
+    }
+    while (u < unsorted_count) {
+        order[o ++] = sorted[u ++];
+    }
+
+    ecs_assert(o == count, ECS_INTERNAL_ERROR, NULL);
+    flecs_query_table_apply_order(world, table, order, count);
+done:
+    flecs_free_n(a, int32_t, buf_count, buf);
+    return result;
+}
+
+static
+void flecs_query_sort_table(
+    ecs_world_t *world,
+    ecs_query_table_t *qt,
     int32_t column_index,
     ecs_order_by_action_t compare,
     ecs_sort_table_action_t sort)
 {
+    ecs_table_t *table = qt->hdr.table;
     ecs_data_t *data = &table->data;
-    if (!ecs_vec_count(&data->entities)) {
-        /* Nothing to sort */
-        return;
-    }
-
     int32_t count = flecs_table_data_count(data);
     if (count < 2) {
+        qt->sorted_count = count;
         return;
     }
 
@@ -1085,11 +1302,122 @@ void flecs_query_sort_table(
         ptr = ecs_vec_first(&column->data);
     }
 
-    if (sort) {
+    sort_rows_t rows = {
+        .entities = entities,
+        .ptr = ptr,
+        .size = size,
+        .compare = compare
+    };
+
+    if (flecs_query_sort_table_incremental(
+        world, table, &rows, count, qt->sorted_count)) 
+    {
+        /* Table was sorted incrementally */
+    } else if (sort) {
         sort(world, table, entities, ptr, size, 0, count - 1, compare);
     } else {
         flecs_query_sort_table_generic(world, table, entities, ptr, size, 0, count - 1, compare);
     }
+
+    qt->sorted_count = count;
+}
+
+/* Sort table by key. Keys are sorted with an LSD radix sort, after which the
+ * sorted order is applied to the table by swapping rows. */
+static
+void flecs_query_sort_table_by_key(
+    ecs_world_t *world,
+    ecs_query_table_t *qt,
+    int32_t column_index,
+    ecs_order_by_key_action_t order_by_key)
+{
+    ecs_table_t *table = qt->hdr.table;
+    ecs_data_t *data = &table->data;
+    int32_t i, count = flecs_table_data_count(data);
+    if (count < 2) {
+        qt->sorted_count = count;
+        return;
+    }
+
+    ecs_entity_t *entities = ecs_vec_first(&data->entities);
+
+    void *ptr = NULL;
+    int32_t size = 0;
+    if (column_index != -1) {
+        ecs_column_t *column = &data->columns[column_index];
+        size = column->size;
+        ptr = ecs_vec_first(&column->data);
+    }
+
+    ecs_allocator_t *a = &world->allocator;
+    sort_key_t *keys = flecs_alloc_n(a, sort_key_t, count);
+    sort_key_t *tmp = flecs_alloc_n(a, sort_key_t, count);
+    sort_key_t *keys_alloc = keys, *tmp_alloc = tmp;
+
+    /* Keep track of which bits differ between keys, so that passes over bytes
+     * that are the same for all keys can be skipped. */
+    uint64_t diff = 0;
+    bool sorted = true;
+    for (i = 0; i < count; i ++) {
+        const void *elem = ptr ? ECS_ELEM(ptr, size, i) : NULL;
+        uint64_t key = order_by_key(entities[i], elem);
+        keys[i].key = key;
+        keys[i].row = i;
+        if (i) {
+            diff |= key ^ keys[0].key;
+            sorted &= key >= keys[i - 1].key;
+        }
+    }
+
+    if (sorted) {
+        goto done;
+    }
+
+    sort_rows_t rows = { .keys = keys };
+    if (flecs_query_sort_table_incremental(
+        world, table, &rows, count, qt->sorted_count)) 
+    {
+        goto done;
+    }
+
+    int32_t shift;
+    for (shift = 0; shift < 64; shift += 8) {
+        if (!((diff >> shift) & 0xFF)) {
+            continue;
+        }
+
+        int32_t offsets[256] = {0};
+        int32_t b, total = 0;
+        for (i = 0; i < count; i ++) {
+            offsets[(keys[i].key >> shift) & 0xFF] ++;
+        }
+        for (b = 0; b < 256; b ++) {
+            int32_t b_count = offsets[b];
+            offsets[b] = total;
+            total += b_count;
+        }
+        for (i = 0; i < count; i ++) {
+            tmp[offsets[(keys[i].key >> shift) & 0xFF] ++] = keys[i];
+        }
+
+        sort_key_t *swap = keys;
+        keys = tmp;
+        tmp = swap;
+    }
+
+    /* Apply sorted order to table. The entity that was originally at row
+     * keys[i].row must be moved to row i. */
+    int32_t *order = flecs_alloc_n(a, int32_t, count);
+    for (i = 0; i < count; i ++) {
+        order[i] = keys[i].row;
+    }
+
+    flecs_query_table_apply_order(world, table, order, count);
+    flecs_free_n(a, int32_t, count, order);
+done:
+    flecs_free_n(a, sort_key_t, count, keys_alloc);
+    flecs_free_n(a, sort_key_t, count, tmp_alloc);
+    qt->sorted_count = count;
 }
 
 /* Helper struct for building sorted table ranges */
@@ -1128,6 +1456,152 @@ ecs_entity_t e_from_helper(
     }
 }
 
+static
+ecs_query_table_match_t* flecs_query_append_slice(
+    ecs_query_t *query,
+    ecs_query_table_match_t *cur,
+    sort_helper_t *helper)
+{
+    if (!cur || cur->columns != helper->match->columns) {
+        cur = ecs_vec_append_t(NULL, &query->table_slices, 
+            ecs_query_table_match_t);
+        *cur = *(helper->match);
+        cur->offset = helper->row;
+        cur->count = 1;
+    } else {
+        cur->count ++;
+    }
+
+    helper->row ++;
+    return cur;
+}
+
+static
+uint64_t flecs_query_key_from_helper(
+    ecs_order_by_key_action_t order_by_key,
+    sort_helper_t *helper)
+{
+    const void *ptr = helper->ptr ? ptr_from_helper(helper) : NULL;
+    return order_by_key(e_from_helper(helper), ptr);
+}
+
+static
+bool flecs_sort_key_lt(
+    const sort_key_t *a,
+    const sort_key_t *b)
+{
+    return (a->key < b->key) || ((a->key == b->key) && (a->row < b->row));
+}
+
+static
+void flecs_sort_heap_down(
+    sort_key_t *heap,
+    int32_t count,
+    int32_t i)
+{
+    do {
+        int32_t min = i, l = i * 2 + 1, r = l + 1;
+        if (l < count && flecs_sort_key_lt(&heap[l], &heap[min])) {
+            min = l;
+        }
+        if (r < count && flecs_sort_key_lt(&heap[r], &heap[min])) {
+            min = r;
+        }
+        if (min == i) {
+            break;
+        }
+        sort_key_t tmp = heap[i];
+        heap[i] = heap[min];
+        heap[min] = tmp;
+        i = min;
+    } while (true);
+}
+
+/* Merge sorted tables by finding the smallest entity across all tables with
+ * the order_by compare function. */
+static
+void flecs_query_merge_by_compare(
+    ecs_query_t *query,
+    sort_helper_t *helper,
+    int32_t to_sort,
+    ecs_query_table_match_t *cur)
+{
+    ecs_order_by_action_t compare = query->order_by;
+
+    bool proceed;
+    do {
+        int32_t j, min = 0;
+        proceed = true;
+
+        ecs_entity_t e1;
+        while (!(e1 = e_from_helper(&helper[min]))) {
+            min ++;
+            if (min == to_sort) {
+                proceed = false;
+                break;
+            }
+        }
+
+        if (!proceed) {
+            break;
+        }
+
+        for (j = min + 1; j < to_sort; j++) {
+            ecs_entity_t e2 = e_from_helper(&helper[j]);
+            if (!e2) {
+                continue;
+            }
+
+            const void *ptr1 = ptr_from_helper(&helper[min]);
+            const void *ptr2 = ptr_from_helper(&helper[j]);
+
+            if (compare(e1, ptr1, e2, ptr2) > 0) {
+                min = j;
+                e1 = e_from_helper(&helper[min]);
+            }
+        }
+
+        cur = flecs_query_append_slice(query, cur, &helper[min]);
+    } while (proceed);
+}
+
+/* Merge sorted tables by key. Instead of comparing the current entity of all
+ * tables, the next entity is found with a binary heap. Entities with equal 
+ * keys are returned in table order. */
+static
+void flecs_query_merge_by_key(
+    ecs_query_t *query,
+    sort_helper_t *helper,
+    int32_t to_sort,
+    ecs_query_table_match_t *cur)
+{
+    ecs_world_t *world = query->filter.world;
+    ecs_order_by_key_action_t order_by_key = query->order_by_key;
+    sort_key_t *heap = flecs_alloc_n(&world->allocator, sort_key_t, to_sort);
+    int32_t i, heap_count = to_sort;
+
+    for (i = 0; i < to_sort; i ++) {
+        heap[i].key = flecs_query_key_from_helper(order_by_key, &helper[i]);
+        heap[i].row = i;
+    }
+    for (i = heap_count / 2 - 1; i >= 0; i --) {
+        flecs_sort_heap_down(heap, heap_count, i);
+    }
+
+    while (heap_count) {
+        sort_helper_t *cur_helper = &helper[heap[0].row];
+        cur = flecs_query_append_slice(query, cur, cur_helper);
+        if (cur_helper->row < cur_helper->count) {
+            heap[0].key = flecs_query_key_from_helper(order_by_key, cur_helper);
+        } else {
+            heap[0] = heap[-- heap_count];
+        }
+        flecs_sort_heap_down(heap, heap_count, 0);
+    }
+
+    flecs_free_n(&world->allocator, sort_key_t, to_sort, heap);
+}
+
 static
 void flecs_query_build_sorted_table_range(
     ecs_query_t *query,
@@ -1138,7 +1612,6 @@ void flecs_query_build_sorted_table_range(
         "cannot sort query in multithreaded mode");
 
     ecs_entity_t id = query->order_by_component;
-    ecs_order_by_action_t compare = query->order_by;
     int32_t table_count = list->info.table_count;
     if (!table_count) {
         return;
@@ -1209,73 +1682,50 @@ void flecs_query_build_sorted_table_range(
 
     ecs_assert(to_sort != 0, ECS_INTERNAL_ERROR, NULL);
 
-    bool proceed;
-    do {
-        int32_t j, min = 0;
-        proceed = true;
-
-        ecs_entity_t e1;
-        while (!(e1 = e_from_helper(&helper[min]))) {
-            min ++;
-            if (min == to_sort) {
-                proceed = false;
-                break;
-            }
-        }
-
-        if (!proceed) {
-            break;
-        }
-
-        for (j = min + 1; j < to_sort; j++) {
-            ecs_entity_t e2 = e_from_helper(&helper[j]);
-            if (!e2) {
-                continue;
-            }
-
-            const void *ptr1 = ptr_from_helper(&helper[min]);
-            const void *ptr2 = ptr_from_helper(&helper[j]);
-
-            if (compare(e1, ptr1, e2, ptr2) > 0) {
-                min = j;
-                e1 = e_from_helper(&helper[min]);
-            }
-        }
+    if (query->order_by_key) {
+        flecs_query_merge_by_key(query, helper, to_sort, cur);
+    } else {
+        flecs_query_merge_by_compare(query, helper, to_sort, cur);
+    }
 
-        sort_helper_t *cur_helper = &helper[min];
-        if (!cur || cur->columns != cur_helper->match->columns) {
-            cur = ecs_vec_append_t(NULL, &query->table_slices, 
-                ecs_query_table_match_t);
-            *cur = *(cur_helper->match);
-            cur->offset = cur_helper->row;
-            cur->count = 1;
-        } else {
-            cur->count ++;
-        }
+    flecs_free_n(&world->allocator, sort_helper_t, table_count, helper);
+}
 
-        cur_helper->row ++;
-    } while (proceed);
+/* Build sorted slices for a list. If the slices from the previous build are
+ * still valid they are copied instead of merging the tables again. */
+static
+void flecs_query_build_sorted_list(
+    ecs_query_t *query,
+    ecs_query_table_list_t *list,
+    ecs_vec_t *prev_slices,
+    bool rebuild)
+{
+    int32_t offset = ecs_vec_count(&query->table_slices);
 
-    /* Iterate through the vector of slices to set the prev/next ptrs. This
-     * can't be done while building the vector, as reallocs may occur */
-    int32_t i, count = ecs_vec_count(&query->table_slices);    
-    ecs_query_table_match_t *nodes = ecs_vec_first(&query->table_slices);
-    for (i = 0; i < count; i ++) {
-        nodes[i].prev = &nodes[i - 1];
-        nodes[i].next = &nodes[i + 1];
+    if (rebuild || list->sort_dirty || !list->slice_count) {
+        flecs_query_build_sorted_table_range(query, list);
+    } else {
+        ecs_assert(list->slice_offset + list->slice_count <= 
+            ecs_vec_count(prev_slices), ECS_INTERNAL_ERROR, NULL);
+        ecs_query_table_match_t *dst = ecs_vec_grow_t(NULL, 
+            &query->table_slices, ecs_query_table_match_t, list->slice_count);
+        ecs_os_memcpy_n(dst, ecs_vec_get_t(prev_slices, 
+            ecs_query_table_match_t, list->slice_offset), 
+                ecs_query_table_match_t, list->slice_count);
     }
 
-    nodes[0].prev = NULL;
-    nodes[i - 1].next = NULL;
-
-    flecs_free_n(&world->allocator, sort_helper_t, table_count, helper);
+    list->slice_offset = offset;
+    list->slice_count = ecs_vec_count(&query->table_slices) - offset;
+    list->sort_dirty = false;
 }
 
 static
 void flecs_query_build_sorted_tables(
-    ecs_query_t *query)
+    ecs_query_t *query,
+    bool rebuild)
 {
-    ecs_vec_clear(&query->table_slices);
+    ecs_vec_t prev_slices = query->table_slices;
+    ecs_vec_init_t(NULL, &query->table_slices, ecs_query_table_match_t, 0);
 
     if (query->group_by) {
         /* Populate sorted node list in grouping order */
@@ -1288,15 +1738,57 @@ void flecs_query_build_sorted_tables(
                     &query->groups, ecs_query_table_list_t, group_id);
                 ecs_assert(list != NULL, ECS_INTERNAL_ERROR, NULL);
 
-                /* Sort tables in current group */
-                flecs_query_build_sorted_table_range(query, list);
+                /* Sort tables in current group, or reuse slices of previous
+                 * build if none of the tables in the group changed. */
+                flecs_query_build_sorted_list(
+                    query, list, &prev_slices, rebuild);
 
                 /* Find next group to sort */
                 cur = list->last->next;
             } while (cur);
         }
     } else {
-        flecs_query_build_sorted_table_range(query, &query->list);
+        flecs_query_build_sorted_list(
+            query, &query->list, &prev_slices, rebuild);
+    }
+
+    ecs_vec_fini_t(NULL, &prev_slices, ecs_query_table_match_t);
+
+    /* Iterate through the vector of slices to set the prev/next ptrs. This
+     * can't be done while building the vector, as reallocs may occur */
+    int32_t i, count = ecs_vec_count(&query->table_slices);
+    if (!count) {
+        return;
+    }
+
+    ecs_query_table_match_t *nodes = ecs_vec_first(&query->table_slices);
+    for (i = 0; i < count; i ++) {
+        nodes[i].prev = &nodes[i - 1];
+        nodes[i].next = &nodes[i + 1];
+    }
+
+    nodes[0].prev = NULL;
+    nodes[i - 1].next = NULL;
+}
+
+/* Mark sorted slices of the groups a table belongs to as dirty */
+static
+void flecs_query_sort_mark_dirty(
+    ecs_query_t *query,
+    ecs_query_table_t *qt)
+{
+    if (!query->group_by) {
+        query->list.sort_dirty = true;
+        return;
+    }
+
+    ecs_query_table_match_t *cur, *end = qt->last->next;
+    for (cur = qt->first; cur != end; cur = cur->next) {
+        ecs_query_table_list_t *list = flecs_query_get_group(
+            query, cur->group_id);
+        if (list) {
+            list->sort_dirty = true;
+        }
     }
 }
 
@@ -1306,7 +1798,8 @@ void flecs_query_sort_tables(
     ecs_query_t *query)
 {
     ecs_order_by_action_t compare = query->order_by;
-    if (!compare) {
+    ecs_order_by_key_action_t order_by_key = query->order_by_key;
+    if (!compare && !order_by_key) {
         return;
     }
 
@@ -1331,6 +1824,7 @@ void flecs_query_sort_tables(
         if (flecs_query_check_table_monitor(query, qt, 0)) {
             tables_sorted = true; /* Ensure ranges are rebuilt */
             dirty = true;
+            flecs_query_sort_mark_dirty(query, qt);
         }
 
         int32_t column = -1;
@@ -1361,12 +1855,20 @@ void flecs_query_sort_tables(
 
         /* Something has changed, sort the table. Prefers using 
          * flecs_query_sort_table when available */
-        flecs_query_sort_table(world, table, column, compare, sort);
+        if (order_by_key) {
+            flecs_query_sort_table_by_key(world, qt, column, order_by_key);
+        } else {
+            flecs_query_sort_table(world, qt, column, compare, sort);
+        }
         tables_sorted = true;
+        flecs_query_sort_mark_dirty(query, qt);
     }
 
-    if (tables_sorted || query->match_count != query->prev_match_count) {
-        flecs_query_build_sorted_tables(query);
+    bool tables_changed = query->match_count != query->prev_match_count;
+    if (tables_sorted || tables_changed) {
+        /* Only rebuild slices of groups with sorted tables, unless the set of
+         * matched tables changed. */
+        flecs_query_build_sorted_tables(query, tables_changed);
         query->match_count ++; /* Increase version if tables changed */
     }
 }
@@ -1598,29 +2100,126 @@ void flecs_query_table_match_free(
 
         flecs_bfree(&world->allocators.query_table_match, cur);
     }
-}
+}
+
+static
+void flecs_query_table_free(
+    ecs_query_t *query,
+    ecs_query_table_t *elem)
+{
+    flecs_query_table_match_free(query, elem, elem->first);
+    flecs_bfree(&query->filter.world->allocators.query_table, elem);
+}
+
+static
+void flecs_query_unmatch_table(
+    ecs_query_t *query,
+    ecs_table_t *table,
+    ecs_query_table_t *elem)
+{
+    if (!elem) {
+        elem = ecs_table_cache_get(&query->cache, table);
+    }
+    if (elem) {
+        ecs_table_cache_remove(&query->cache, elem->table_id, &elem->hdr);
+        flecs_query_table_free(query, elem);
+    }
+}
+
+/* State for applying rematch results to the cache of a query */
+typedef struct ecs_query_rematch_cursor_t {
+    ecs_table_t *table;
+    ecs_query_table_t *qt;
+    ecs_query_table_match_t *qm;
+    int32_t rematch_count;
+} ecs_query_rematch_cursor_t;
+
+static
+void flecs_query_rematch_begin(
+    ecs_world_t *world,
+    ecs_query_t *query,
+    ecs_query_rematch_cursor_t *cur)
+{
+    world->info.rematch_count_total ++;
+    cur->table = NULL;
+    cur->qt = NULL;
+    cur->qm = NULL;
+    cur->rematch_count = ++ query->rematch_count;
+}
+
+/* Update cache with a single rematch result */
+static
+void flecs_query_rematch_result(
+    ecs_world_t *world,
+    ecs_query_t *query,
+    ecs_query_rematch_cursor_t *cur,
+    ecs_iter_t *it)
+{
+    ecs_table_t *table = it->table;
+    ecs_query_table_t *qt = cur->qt;
+    ecs_query_table_match_t *qm = cur->qm;
+
+    if ((cur->table != table) || (!table && !qt)) {
+        if (qm && qm->next_match) {
+            flecs_query_table_match_free(query, qt, qm->next_match);
+            qm->next_match = NULL;
+        }
+
+        cur->table = table;
+
+        qt = ecs_table_cache_get(&query->cache, table);
+        if (!qt) {
+            qt = flecs_query_table_insert(world, query, table);
+        }
+
+        ecs_assert(qt->hdr.table == table, ECS_INTERNAL_ERROR, NULL);
+        qt->rematch_count = cur->rematch_count;
+        qm = NULL;
+    }
+    if (!qm) {
+        qm = qt->first;
+    } else {
+        qm = qm->next_match;
+    }
+    if (!qm) {
+        qm = flecs_query_add_table_match(query, qt, table);
+    }
+
+    flecs_query_set_table_match(world, query, qm, table, it);
+
+    if (table && ecs_table_count(table) && query->group_by) {
+        if (flecs_query_get_group_id(query, table) != qm->group_id) {
+            /* Update table group */
+            flecs_query_remove_table_node(query, qm);
+            flecs_query_insert_table_node(query, qm);
+        }
+    }
 
-static
-void flecs_query_table_free(
-    ecs_query_t *query,
-    ecs_query_table_t *elem)
-{
-    flecs_query_table_match_free(query, elem, elem->first);
-    flecs_bfree(&query->filter.world->allocators.query_table, elem);
+    cur->qt = qt;
+    cur->qm = qm;
 }
 
 static
-void flecs_query_unmatch_table(
+void flecs_query_rematch_end(
     ecs_query_t *query,
-    ecs_table_t *table,
-    ecs_query_table_t *elem)
+    ecs_query_rematch_cursor_t *cur)
 {
-    if (!elem) {
-        elem = ecs_table_cache_get(&query->cache, table);
+    ecs_query_table_t *qt = cur->qt;
+    ecs_query_table_match_t *qm = cur->qm;
+
+    if (qm && qm->next_match) {
+        flecs_query_table_match_free(query, qt, qm->next_match);
+        qm->next_match = NULL;
     }
-    if (elem) {
-        ecs_table_cache_remove(&query->cache, elem->table_id, &elem->hdr);
-        flecs_query_table_free(query, elem);
+
+    /* Iterate all tables in cache, remove ones that weren't just matched */
+    ecs_table_cache_iter_t cache_it;
+    if (flecs_table_cache_all_iter(&query->cache, &cache_it)) {
+        while ((qt = flecs_table_cache_next(&cache_it, ecs_query_table_t))) {
+            if (qt->rematch_count != cur->rematch_count) {
+                flecs_query_unmatch_table(query, qt->hdr.table, qt);
+            }
+        }
     }
 }
 
@@ -1632,9 +2231,6 @@ void flecs_query_rematch_tables(
     ecs_query_t *parent_query)
 {
     ecs_iter_t it, parent_it;
-    ecs_table_t *table = NULL;
-    ecs_query_table_t *qt = NULL;
-    ecs_query_table_match_t *qm = NULL;
 
     if (query->monitor_generation == world->monitor_generation) {
         return;
@@ -1653,8 +2249,8 @@ void flecs_query_rematch_tables(
     ECS_BIT_SET(it.flags, EcsIterNoData);
     ECS_BIT_SET(it.flags, EcsIterEntityOptional);
 
-    world->info.rematch_count_total ++;
-    int32_t rematch_count = ++ query->rematch_count;
+    ecs_query_rematch_cursor_t cur;
+    flecs_query_rematch_begin(world, query, &cur);
 
     ecs_time_t t = {0};
     if (world->flags & EcsWorldMeasureFrameTime) {
@@ -1662,63 +2258,188 @@ void flecs_query_rematch_tables(
     }
 
     while (ecs_filter_next(&it)) {
-        if ((table != it.table) || (!it.table && !qt)) {
-            if (qm && qm->next_match) {
-                flecs_query_table_match_free(query, qt, qm->next_match);
-                qm->next_match = NULL;
-            }
+        flecs_query_rematch_result(world, query, &cur, &it);
+    }
 
-            table = it.table;
+    flecs_query_rematch_end(query, &cur);
 
-            qt = ecs_table_cache_get(&query->cache, table);
-            if (!qt) {
-                qt = flecs_query_table_insert(world, query, table);
-            }
+    if (world->flags & EcsWorldMeasureFrameTime) {
+        world->info.rematch_time_total += (ecs_ftime_t)ecs_time_measure(&t);
+    }
+}
 
-            ecs_assert(qt->hdr.table == table, ECS_INTERNAL_ERROR, NULL);
-            qt->rematch_count = rematch_count;
-            qm = NULL;
-        }
-        if (!qm) {
-            qm = qt->first;
+#ifdef FLECS_PIPELINE
+
+/* Results of matching a query, produced by a worker thread */
+typedef struct ecs_query_rematch_t {
+    ecs_query_t *query;
+    ecs_allocator_t *allocator;      /* Allocator of stage that matched query */
+    ecs_vec_t tables;                /* vector<ecs_table_t*> */
+    ecs_vec_t ids;                   /* vector<ecs_id_t>, field_count per table */
+    ecs_vec_t columns;               /* vector<int32_t> */
+    ecs_vec_t sources;               /* vector<ecs_entity_t> */
+    ecs_vec_t sizes;                 /* vector<ecs_size_t> */
+} ecs_query_rematch_t;
+
+typedef struct ecs_query_rematch_job_t {
+    ecs_query_rematch_t *queries;
+    int32_t count;
+    int32_t next;                    /* Next query to claim, incremented atomically */
+} ecs_query_rematch_job_t;
+
+/* Match query against the world without modifying its cache. Only reads from
+ * the world, so this can run concurrently for different queries. */
+static
+void flecs_query_rematch_collect(
+    ecs_stage_t *stage,
+    ecs_query_rematch_t *r)
+{
+    ecs_query_t *query = r->query;
+    ecs_allocator_t *a = &stage->allocator;
+    int32_t field_count = query->filter.field_count;
+
+    r->allocator = a;
+    ecs_vec_init_t(a, &r->tables, ecs_table_t*, 0);
+    ecs_vec_init_t(a, &r->ids, ecs_id_t, 0);
+    ecs_vec_init_t(a, &r->columns, int32_t, 0);
+    ecs_vec_init_t(a, &r->sources, ecs_entity_t, 0);
+    ecs_vec_init_t(a, &r->sizes, ecs_size_t, 0);
+
+    ecs_iter_t it = flecs_filter_iter_w_flags(
+        (ecs_world_t*)stage, &query->filter, 0);
+    ECS_BIT_SET(it.flags, EcsIterIsInstanced);
+    ECS_BIT_SET(it.flags, EcsIterNoData);
+    ECS_BIT_SET(it.flags, EcsIterEntityOptional);
+
+    while (ecs_filter_next(&it)) {
+        ecs_vec_append_t(a, &r->tables, ecs_table_t*)[0] = it.table;
+        ecs_os_memcpy_n(ecs_vec_grow_t(a, &r->ids, ecs_id_t, field_count),
+            it.ids, ecs_id_t, field_count);
+        ecs_os_memcpy_n(ecs_vec_grow_t(a, &r->columns, int32_t, field_count),
+            it.columns, int32_t, field_count);
+        ecs_os_memcpy_n(ecs_vec_grow_t(a, &r->sources, ecs_entity_t, 
+            field_count), it.sources, ecs_entity_t, field_count);
+        ecs_size_t *sizes = ecs_vec_grow_t(
+            a, &r->sizes, ecs_size_t, field_count);
+        if (it.sizes) {
+            ecs_os_memcpy_n(sizes, it.sizes, ecs_size_t, field_count);
         } else {
-            qm = qm->next_match;
-        }
-        if (!qm) {
-            qm = flecs_query_add_table_match(query, qt, table);
+            ecs_os_memset_n(sizes, 0, ecs_size_t, field_count);
         }
+    }
+}
 
-        flecs_query_set_table_match(world, query, qm, table, &it);
+/* Worker task that claims queries until all of them have been matched */
+static
+void flecs_query_rematch_worker(
+    ecs_world_t *world,
+    ecs_stage_t *stage,
+    void *ctx)
+{
+    (void)world;
+    ecs_query_rematch_job_t *job = ctx;
+    int32_t i;
+    while ((i = ecs_os_ainc(&job->next) - 1) < job->count) {
+        flecs_query_rematch_collect(stage, &job->queries[i]);
+    }
+}
 
-        if (table && ecs_table_count(table) && query->group_by) {
-            if (flecs_query_get_group_id(query, table) != qm->group_id) {
-                /* Update table group */
-                flecs_query_remove_table_node(query, qm);
-                flecs_query_insert_table_node(query, qm);
-            }
-        }
+/* Apply results to query cache. Runs on the main thread after workers synced */
+static
+void flecs_query_rematch_merge(
+    ecs_world_t *world,
+    ecs_query_rematch_t *r)
+{
+    ecs_query_t *query = r->query;
+    ecs_allocator_t *a = r->allocator;
+    int32_t i, count = ecs_vec_count(&r->tables);
+    int32_t field_count = query->filter.field_count;
+    ecs_table_t **tables = ecs_vec_first_t(&r->tables, ecs_table_t*);
+    ecs_id_t *ids = ecs_vec_first_t(&r->ids, ecs_id_t);
+    int32_t *columns = ecs_vec_first_t(&r->columns, int32_t);
+    ecs_entity_t *sources = ecs_vec_first_t(&r->sources, ecs_entity_t);
+    ecs_size_t *sizes = ecs_vec_first_t(&r->sizes, ecs_size_t);
+
+    ecs_query_rematch_cursor_t cur;
+    flecs_query_rematch_begin(world, query, &cur);
+
+    ecs_iter_t it = { .world = world, .real_world = world };
+    for (i = 0; i < count; i ++) {
+        int32_t offset = i * field_count;
+        it.table = tables[i];
+        it.ids = &ids[offset];
+        it.columns = &columns[offset];
+        it.sources = &sources[offset];
+        it.sizes = &sizes[offset];
+        flecs_query_rematch_result(world, query, &cur, &it);
     }
 
-    if (qm && qm->next_match) {
-        flecs_query_table_match_free(query, qt, qm->next_match);
-        qm->next_match = NULL;
+    flecs_query_rematch_end(query, &cur);
+
+    ecs_vec_fini_t(a, &r->tables, ecs_table_t*);
+    ecs_vec_fini_t(a, &r->ids, ecs_id_t);
+    ecs_vec_fini_t(a, &r->columns, int32_t);
+    ecs_vec_fini_t(a, &r->sources, ecs_entity_t);
+    ecs_vec_fini_t(a, &r->sizes, ecs_size_t);
+
+    flecs_query_notify_subqueries(world, query, &(ecs_query_event_t){
+        .kind = EcsQueryTableRematch
+    });
+}
+
+/* Match queries on worker threads, one query per task */
+static
+bool flecs_query_rematch_parallel(
+    ecs_world_t *world,
+    ecs_query_t **queries,
+    int32_t count)
+{
+    if (count < 2 || !flecs_workers_can_run_task(world)) {
+        return false;
     }
 
-    /* Iterate all tables in cache, remove ones that weren't just matched */
-    ecs_table_cache_iter_t cache_it;
-    if (flecs_table_cache_all_iter(&query->cache, &cache_it)) {
-        while ((qt = flecs_table_cache_next(&cache_it, ecs_query_table_t))) {
-            if (qt->rematch_count != rematch_count) {
-                flecs_query_unmatch_table(query, qt->hdr.table, qt);
-            }
+    ecs_allocator_t *a = &world->allocator;
+    ecs_query_rematch_t *rematch = flecs_alloc_n(
+        a, ecs_query_rematch_t, count);
+    ecs_query_rematch_job_t job = { .queries = rematch };
+
+    int32_t i;
+    for (i = 0; i < count; i ++) {
+        ecs_query_t *q = queries[i];
+        if (q->monitor_generation == world->monitor_generation) {
+            continue; /* Query is registered for more than one monitor */
         }
+        q->monitor_generation = world->monitor_generation;
+        rematch[job.count ++].query = q;
+    }
+
+    ecs_time_t t = {0};
+    if (world->flags & EcsWorldMeasureFrameTime) {
+        ecs_time_measure(&t);
+    }
+
+    if (job.count > 1) {
+        flecs_workers_run_task(world, flecs_query_rematch_worker, &job);
+    } else {
+        /* Not worth waking up workers for a single query */
+        flecs_query_rematch_worker(world, &world->stages[0], &job);
+    }
+
+    /* Sync point: workers are done, apply results in registration order */
+    for (i = 0; i < job.count; i ++) {
+        flecs_query_rematch_merge(world, &rematch[i]);
     }
 
     if (world->flags & EcsWorldMeasureFrameTime) {
         world->info.rematch_time_total += (ecs_ftime_t)ecs_time_measure(&t);
     }
+
+    flecs_free_n(a, ecs_query_rematch_t, count, rematch);
+    return true;
 }
 
+#endif
+
 static
 void flecs_query_remove_subquery(
     ecs_query_t *parent, 
@@ -1779,15 +2500,37 @@ void flecs_query_notify(
     }
 }
 
+void flecs_query_rematch_all(
+    ecs_world_t *world,
+    ecs_query_t **queries,
+    int32_t count)
+{
+#ifdef FLECS_PIPELINE
+    if (flecs_query_rematch_parallel(world, queries, count)) {
+        return;
+    }
+#endif
+
+    int32_t i;
+    for (i = 0; i < count; i ++) {
+        flecs_query_notify(world, queries[i], &(ecs_query_event_t) {
+            .kind = EcsQueryTableRematch
+        });
+    }
+}
+
 static
 void flecs_query_order_by(
     ecs_world_t *world,
     ecs_query_t *query,
     ecs_entity_t order_by_component,
     ecs_order_by_action_t order_by,
+    ecs_order_by_key_action_t order_by_key,
     ecs_sort_table_action_t action)
 {
     ecs_check(query != NULL, ECS_INVALID_PARAMETER, NULL);
+    ecs_check(!order_by || !order_by_key, ECS_INVALID_PARAMETER, 
+        "cannot combine order_by and order_by_key");
     ecs_check(!(query->flags & EcsQueryIsOrphaned), ECS_INVALID_PARAMETER, NULL);
     ecs_check(!ecs_id_is_wildcard(order_by_component), 
         ECS_INVALID_PARAMETER, NULL);
@@ -1814,6 +2557,7 @@ void flecs_query_order_by(
 
     query->order_by_component = order_by_component;
     query->order_by = order_by;
+    query->order_by_key = order_by_key;
     query->order_by_term = order_by_term;
     query->sort_table = action;
 
@@ -1821,7 +2565,7 @@ void flecs_query_order_by(
     flecs_query_sort_tables(world, query);  
 
     if (!query->table_slices.array) {
-        flecs_query_build_sorted_tables(query);
+        flecs_query_build_sorted_tables(query, true);
     }
 
     query->flags &= ~EcsQueryTrivialIter;
@@ -2183,10 +2927,10 @@ ecs_query_t* ecs_query_init(
         result->parent = desc->parent;
     }
 
-    if (desc->order_by) {
+    if (desc->order_by || desc->order_by_key) {
         flecs_query_order_by(
             world, result, desc->order_by_component, desc->order_by,
-            desc->sort_table);
+            desc->order_by_key, desc->sort_table);
     }
 
     if (!ecs_query_table_count(result) && result->filter.term_count) {
@@ -2294,7 +3038,9 @@ ecs_iter_t ecs_query_iter(
         .last = NULL
     };
 
-    if (query->order_by && query->list.info.table_count) {
+    if ((query->order_by || query->order_by_key) && 
+        query->list.info.table_count) 
+    {
         it.node = ecs_vec_first(&query->table_slices);
     }
 
@@ -2413,10 +3159,38 @@ void* ecs_query_get_group_ctx(
     }
 }
 
+/* Stamp rows of a table that tracks row versions with the new column state */
+static
+void flecs_query_stamp_rows(
+    ecs_query_t *query,
+    ecs_query_table_match_t *qm,
+    ecs_table_t *table,
+    int32_t term,
+    int32_t column,
+    int32_t value)
+{
+    if (table == qm->table) {
+        int32_t offset = qm->offset, count = qm->count;
+        if (!count) {
+            count = ecs_table_count(table);
+        }
+        flecs_table_stamp_rows(table, column + 1, offset, count, value);
+    } else {
+        int32_t field = query->filter.terms[term].field_index;
+        ecs_entity_t src = qm->sources[field];
+        ecs_record_t *r = src ? flecs_entities_get(query->filter.world, src) : NULL;
+        if (r && r->table == table) {
+            flecs_table_stamp_rows(table, column + 1, 
+                ECS_RECORD_TO_ROW(r->row), 1, value);
+        }
+    }
+}
+
 static
 void flecs_query_mark_columns_dirty(
     ecs_query_t *query,
-    ecs_query_table_match_t *qm)
+    ecs_query_table_match_t *qm,
+    const ecs_iter_t *it)
 {
     ecs_table_t *table = qm->table;
     ecs_filter_t *filter = &query->filter;
@@ -2453,7 +3227,14 @@ void flecs_query_mark_columns_dirty(
 
             ecs_assert(tc.column >= 0, ECS_INTERNAL_ERROR, NULL);
 
-            dirty_state[tc.column + 1] ++;
+            int32_t value = ++ dirty_state[tc.column + 1];
+
+            /* Changed rows iterators stamp rows for each yielded range */
+            if ((tc.table->flags & EcsTableHasRowVersions) && 
+                !(it->flags & EcsIterChangedRows)) 
+            {
+                flecs_query_stamp_rows(query, qm, tc.table, i, tc.column, value);
+            }
         }
     }
 }
@@ -2477,7 +3258,7 @@ bool ecs_query_next_table(
         }
         if (query->flags & EcsQueryHasOutTerms) {
             if (it->count) {
-                flecs_query_mark_columns_dirty(query, prev);
+                flecs_query_mark_columns_dirty(query, prev, it);
             }
         }
     }
@@ -2658,7 +3439,8 @@ error:
     return false;
 }
 
-bool ecs_query_next_instanced(
+static
+bool flecs_query_next_instanced(
     ecs_iter_t *it)
 {
     ecs_check(it != NULL, ECS_INVALID_PARAMETER, NULL);
@@ -2670,12 +3452,18 @@ bool ecs_query_next_instanced(
 
     ecs_query_table_match_t *prev, *next, *cur = iter->node, *last = iter->last;
     if ((prev = iter->prev)) {
-        /* Match has been iterated, update monitor for change tracking */
-        if (flags & EcsQueryHasMonitor) {
+        /* Match has been iterated, update monitor for change tracking. A 
+         * changed rows iterator syncs after marking columns dirty, so that it
+         * doesn't return rows again that it wrote itself. */
+        bool sync_last = it->flags & EcsIterChangedRows;
+        if ((flags & EcsQueryHasMonitor) && !sync_last) {
             flecs_query_sync_match_monitor(query, prev);
         }
         if (flags & EcsQueryHasOutTerms) {
-            flecs_query_mark_columns_dirty(query, prev);
+            flecs_query_mark_columns_dirty(query, prev, it);
+        }
+        if ((flags & EcsQueryHasMonitor) && sync_last) {
+            flecs_query_sync_match_monitor(query, prev);
         }
     }
 
@@ -2718,6 +3506,231 @@ yield:
     return true;
 }
 
+/* Stamp owned [out] fields of the rows yielded by a changed rows iterator */
+static
+void flecs_query_changed_stamp(
+    ecs_iter_t *it,
+    ecs_query_t *query,
+    ecs_query_table_match_t *qm)
+{
+    ecs_table_t *table = qm->table;
+    if (!(query->flags & EcsQueryHasOutTerms) || 
+        !(table->flags & EcsTableHasRowVersions)) 
+    {
+        return;
+    }
+
+    const ecs_filter_t *filter = &query->filter;
+    int32_t *dirty_state = table->dirty_state;
+    int32_t t, term_count = filter->term_count;
+    for (t = 0; t < term_count; t ++) {
+        const ecs_term_t *term = &filter->terms[t];
+        if (term->inout == EcsIn || term->inout == EcsInOutNone) {
+            continue;
+        }
+
+        int32_t field = term->field_index;
+        int32_t column = qm->storage_columns[field];
+        if (column < 0 || qm->sources[field]) {
+            continue;
+        }
+
+        /* Dirty state is incremented when the iterator moves to the next
+         * match, stamp rows with the value it will have. */
+        flecs_table_stamp_rows(table, column + 1, it->offset, it->count,
+            dirty_state[column + 1] + 1);
+    }
+}
+
+/* Find next range of changed rows in match */
+static
+bool flecs_query_changed_next_range(
+    ecs_iter_t *it,
+    ecs_query_t *query,
+    ecs_query_table_match_t *qm)
+{
+    ecs_query_iter_t *iter = &it->priv.iter.query;
+    ecs_table_t *table = qm->table;
+
+    /* Restore range returned by the query */
+    int32_t shift = it->offset - iter->changed_offset;
+    if (shift) {
+        flecs_offset_iter(it, -shift);
+    }
+    it->offset = iter->changed_offset;
+    it->count = iter->changed_count;
+    it->frame_offset = iter->changed_frame_offset;
+
+    /* Collect owned fields that changed since the last iteration. Only those
+     * columns need to be tested for each row. */
+    int32_t columns[FLECS_TERM_DESC_MAX], monitors[FLECS_TERM_DESC_MAX];
+    int32_t *monitor = qm->monitor, *dirty_state = table->dirty_state;
+    int32_t i, changed_count = 0, field_count = query->filter.field_count;
+    for (i = 0; i < field_count; i ++) {
+        int32_t column = qm->storage_columns[i];
+        if (monitor[i + 1] == -1 || column < 0 || qm->sources[i]) {
+            continue;
+        }
+        if (monitor[i + 1] != dirty_state[column + 1]) {
+            columns[changed_count] = column + 1;
+            monitors[changed_count] = monitor[i + 1];
+            changed_count ++;
+        }
+    }
+
+    int32_t added = monitor[0];
+    bool test_added = added != dirty_state[0];
+    int32_t stride = table->column_count + 1;
+    int32_t *rv = flecs_table_row_versions(table, it->offset);
+    int32_t row = iter->changed_row, end = it->count;
+
+    for (; row < end; row ++) {
+        int32_t *v = &rv[row * stride];
+        if (test_added && v[0] > added) {
+            break;
+        }
+        for (i = 0; i < changed_count; i ++) {
+            if (v[columns[i]] > monitors[i]) {
+                break;
+            }
+        }
+        if (i != changed_count) {
+            break;
+        }
+    }
+
+    if (row == end) {
+        return false;
+    }
+
+    int32_t last = row + 1;
+    for (; last < end; last ++) {
+        int32_t *v = &rv[last * stride];
+        if (test_added && v[0] > added) {
+            continue;
+        }
+        for (i = 0; i < changed_count; i ++) {
+            if (v[columns[i]] > monitors[i]) {
+                break;
+            }
+        }
+        if (i == changed_count) {
+            break;
+        }
+    }
+
+    iter->changed_row = last;
+    iter->changed_yielded = true;
+    if (row) {
+        flecs_offset_iter(it, row);
+    }
+    it->offset += row;
+    it->count = last - row;
+    it->frame_offset += row;
+    flecs_query_changed_stamp(it, query, qm);
+    return true;
+}
+
+/* Next function for changed rows iterator. Skips matched tables that did not
+ * change since the last iteration, and only yields the ranges of rows that
+ * were added or written for tables that track row versions. Tables start 
+ * tracking row versions the first time they're visited by the iterator. */
+static
+bool flecs_query_next_changed(
+    ecs_iter_t *it)
+{
+    ecs_query_iter_t *iter = &it->priv.iter.query;
+    ecs_query_t *query = iter->query;
+    ecs_world_t *world = query->filter.world;
+
+    for (;;) {
+        ecs_query_table_match_t *qm;
+        if (iter->changed_active) {
+            qm = iter->prev;
+            if (flecs_query_changed_next_range(it, query, qm)) {
+                return true;
+            }
+
+            /* No rows changed, sync monitor so table isn't tested again */
+            iter->changed_active = false;
+            if (!iter->changed_yielded) {
+                flecs_query_sync_match_monitor(query, qm);
+                iter->prev = NULL;
+            }
+        }
+
+        if (!flecs_query_next_instanced(it)) {
+            return false;
+        }
+
+        qm = iter->prev;
+        ecs_table_t *table = qm->table;
+        if (!table || !it->count) {
+            return true;
+        }
+
+        /* Matches with entity filters can be yielded multiple times, test
+         * the monitor only for the first result. */
+        if (qm->entity_filter && (iter->changed_match == qm)) {
+            flecs_query_changed_stamp(it, query, qm);
+            return true;
+        }
+
+        bool fresh = flecs_query_get_match_monitor(query, qm);
+        if (!fresh && !flecs_query_check_match_monitor(query, qm, it)) {
+            iter->prev = NULL;
+            continue;
+        }
+
+        if (!(table->flags & EcsTableHasRowVersions)) {
+            if (!(world->flags & EcsWorldReadonly) && !table->_->lock) {
+                flecs_table_init_row_versions(world, table);
+            }
+            fresh = true;
+        }
+
+        if (fresh || qm->entity_filter || 
+            flecs_query_check_match_monitor_w_shared(query, qm, it, true)) 
+        {
+            /* Can't tell which rows changed, return all */
+            iter->changed_match = qm;
+            flecs_query_changed_stamp(it, query, qm);
+            return true;
+        }
+
+        iter->changed_active = true;
+        iter->changed_yielded = false;
+        iter->changed_row = 0;
+        iter->changed_offset = it->offset;
+        iter->changed_count = it->count;
+        iter->changed_frame_offset = it->frame_offset;
+    }
+}
+
+bool ecs_query_next_instanced(
+    ecs_iter_t *it)
+{
+    if (it->flags & EcsIterChangedRows) {
+        return flecs_sparse_filter_next(it, flecs_query_next_changed);
+    }
+    return flecs_sparse_filter_next(it, flecs_query_next_instanced);
+}
+
+ecs_iter_t ecs_query_changed_iter(
+    const ecs_world_t *world,
+    ecs_query_t *query)
+{
+    ecs_poly_assert(query, ecs_query_t);
+
+    /* Monitors are created when a table is first visited, which causes the
+     * iterator to return all rows of the table. */
+    query->flags |= EcsQueryHasMonitor;
+
+    ecs_iter_t it = ecs_query_iter(world, query);
+    ECS_BIT_SET(it.flags, EcsIterChangedRows);
+    return it;
+}
+
 bool ecs_query_changed(
     ecs_query_t *query,
     const ecs_iter_t *it)
@@ -2839,3 +3852,16 @@ void* ecs_query_get_binding_ctx(
 {
     return query->binding_ctx;
 }
+
+uint64_t ecs_float_to_sort_key(
+    double value)
+{
+    /* Flip all bits of negative values so that they sort in reverse order, and
+     * set the sign bit of positive values so they sort after negative values */
+    uint64_t bits;
+    ecs_os_memcpy(&bits, &value, ECS_SIZEOF(uint64_t));
+    if (bits & ((uint64_t)1 << 63)) {
+        return ~bits;
+    }
+    return bits | ((uint64_t)1 << 63);
+}
@@ -69,6 +69,108 @@ ecs_cmd_t* flecs_cmd_new_batched(
     return cmd;
 }
 
+/* Move commands from the queue of one stage to another. Commands for the same
+ * entity are linked up with commands already in the destination queue, so that
+ * they can be batched when the destination stage is flushed. The command 
+ * values stay in the stack of the source stage, which must not be reset before
+ * the destination queue has been flushed. */
+static
+void flecs_commands_move(
+    ecs_stage_t *dst,
+    ecs_stage_t *src)
+{
+    ecs_vec_t *src_queue = &src->cmd->queue;
+    int32_t i, count = ecs_vec_count(src_queue);
+    if (!count) {
+        return;
+    }
+
+    ecs_cmd_t *src_cmds = ecs_vec_first(src_queue);
+
+    /* Only the first command for an entity has an entry. Propagate it to the 
+     * other commands for the entity, so we know which commands are batched. */
+    for (i = 0; i < count; i ++) {
+        ecs_cmd_t *cmd = &src_cmds[i];
+        ecs_cmd_entry_t *entry = cmd->entry;
+        if (entry && entry->first == i) {
+            int32_t next = cmd->next_for_entity;
+            while (next) {
+                if (next < 0) {
+                    next *= -1;
+                }
+                src_cmds[next].entry = entry;
+                next = src_cmds[next].next_for_entity;
+            }
+        }
+    }
+
+    ecs_vec_t *dst_queue = &dst->cmd->queue;
+    ecs_vec_set_min_size_t(&dst->allocator, dst_queue, ecs_cmd_t, 
+        ecs_vec_count(dst_queue) + count);
+
+    for (i = 0; i < count; i ++) {
+        ecs_cmd_t *src_cmd = &src_cmds[i];
+        ecs_cmd_entry_t *src_entry = src_cmd->entry;
+        ecs_cmd_t *cmd;
+        if (src_entry) {
+            src_entry->first = -1;
+            cmd = flecs_cmd_new_batched(dst, src_cmd->entity);
+        } else {
+            cmd = flecs_cmd_new(dst);
+        }
+
+        int32_t next_for_entity = cmd->next_for_entity;
+        ecs_cmd_entry_t *entry = cmd->entry;
+        *cmd = *src_cmd;
+        cmd->next_for_entity = next_for_entity;
+        cmd->entry = entry;
+    }
+
+    ecs_vec_clear(src_queue);
+}
+
+/* Merge commands of all stages into a single queue. This batches commands for
+ * entities that were modified by multiple stages, so that each entity moves 
+ * tables once. Commands are gathered in stage order. */
+static
+bool flecs_stages_merge_combined(
+    ecs_world_t *world,
+    bool force_merge)
+{
+    int32_t i, count = ecs_get_stage_count(world);
+    ecs_stage_t *main_stage = &world->stages[0];
+    if (main_stage->defer != 1 || (!force_merge && !main_stage->auto_merge)) {
+        /* Queue of main stage won't be flushed, don't combine */
+        return false;
+    }
+
+    for (i = 1; i < count; i ++) {
+        ecs_stage_t *s = &world->stages[i];
+        if ((force_merge || s->auto_merge) && s->defer == 1) {
+            flecs_commands_move(main_stage, s);
+        }
+    }
+
+    flecs_defer_end(world, main_stage);
+
+    for (i = 1; i < count; i ++) {
+        ecs_stage_t *s = &world->stages[i];
+        if (!force_merge && !s->auto_merge) {
+            continue;
+        }
+
+        if (s->defer == 1) {
+            /* Commands have been flushed by main stage, release values */
+            s->defer --;
+            flecs_stack_reset(&s->cmd->stack);
+        } else {
+            flecs_defer_end(world, s);
+        }
+    }
+
+    return true;
+}
+
 static
 void flecs_stages_merge(
     ecs_world_t *world,
@@ -97,7 +199,9 @@ void flecs_stages_merge(
                 "mismatching defer_begin/defer_end detected");
             flecs_defer_end(world, stage);
         }
-    } else {
+    } else if (!(world->flags & EcsWorldCombinedMerge) ||
+        !flecs_stages_merge_combined(world, force_merge))
+    {
         /* Merge stages. Only merge if the stage has auto_merging turned on, or 
          * if this is a forced merge (like when ecs_merge is called) */
         int32_t i, count = ecs_get_stage_count(world);
@@ -278,7 +382,8 @@ bool flecs_defer_bulk_new(
     const ecs_entity_t **ids_out)
 {
     if (flecs_defer_cmd(stage)) {
-        ecs_entity_t *ids = ecs_os_malloc(count * ECS_SIZEOF(ecs_entity_t));
+        ecs_entity_t *ids = flecs_stack_alloc_n(
+            &stage->cmd->stack, ecs_entity_t, count);
 
         /* Use ecs_new_id as this is thread safe */
         int i;
@@ -576,7 +681,7 @@ void flecs_commands_init(
     ecs_stage_t *stage,
     ecs_commands_t *cmd)
 {
-    flecs_stack_init(&cmd->stack);
+    flecs_stack_init_w_cache(&cmd->stack, &stage->allocators.stack_pages);
     ecs_vec_init_t(&stage->allocator, &cmd->queue, ecs_cmd_t, 0);
     flecs_sparse_init_t(&cmd->entries, &stage->allocator,
         &stage->allocators.cmd_entry_chunk, ecs_cmd_entry_t);
@@ -623,8 +728,10 @@ void flecs_stage_init(
     stage->auto_merge = true;
     stage->async = false;
 
-    flecs_stack_init(&stage->allocators.iter_stack);
-    flecs_stack_init(&stage->allocators.deser_stack);
+    ecs_stage_allocators_t *sa = &stage->allocators;
+    flecs_balloc_cache_init(&sa->stack_pages, &world->stack_pages);
+    flecs_stack_init_w_cache(&sa->iter_stack, &sa->stack_pages);
+    flecs_stack_init_w_cache(&sa->deser_stack, &sa->stack_pages);
     flecs_allocator_init(&stage->allocator);
     flecs_ballocator_init_n(&stage->allocators.cmd_entry_chunk, ecs_cmd_entry_t,
         FLECS_SPARSE_PAGE_SIZE);
@@ -664,6 +771,7 @@ void flecs_stage_fini(
     flecs_stack_fini(&stage->allocators.iter_stack);
     flecs_stack_fini(&stage->allocators.deser_stack);
     flecs_ballocator_fini(&stage->allocators.cmd_entry_chunk);
+    flecs_balloc_cache_fini(&stage->allocators.stack_pages);
     flecs_allocator_fini(&stage->allocator);
 }
 
@@ -832,6 +940,22 @@ error:
     return;
 }
 
+void ecs_set_combined_merge(
+    ecs_world_t *world,
+    bool enable)
+{
+    ecs_poly_assert(world, ecs_world_t);
+    ECS_BIT_COND(world->flags, EcsWorldCombinedMerge, enable);
+}
+
+void ecs_set_parallel_merge(
+    ecs_world_t *world,
+    bool enable)
+{
+    ecs_poly_assert(world, ecs_world_t);
+    ECS_BIT_COND(world->flags, EcsWorldParallelMerge, enable);
+}
+
 void ecs_set_automerge(
     ecs_world_t *world,
     bool auto_merge)
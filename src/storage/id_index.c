@@ -362,6 +362,39 @@ void flecs_id_record_assert_empty(
         ECS_INTERNAL_ERROR, NULL);
 }
 
+static
+void flecs_id_record_sparse_fini(
+    ecs_world_t *world,
+    ecs_id_record_t *idr)
+{
+    ecs_sparse_t *sparse = idr->sparse;
+    if (sparse) {
+        const ecs_type_info_t *ti = idr->type_info;
+        ecs_xtor_t dtor = ti ? ti->hooks.dtor : NULL;
+        if (dtor) {
+            int32_t i, count = flecs_sparse_count(sparse);
+            for (i = 0; i < count; i ++) {
+                void *ptr = flecs_sparse_get_dense(sparse, 0, i);
+                dtor(ptr, 1, ti);
+            }
+        }
+
+        flecs_sparse_fini(sparse);
+        ecs_os_free(sparse);
+        idr->sparse = NULL;
+    }
+
+    ecs_vec_t *ids = &world->sparse_ids;
+    int32_t i, count = ecs_vec_count(ids);
+    ecs_id_record_t **arr = ecs_vec_first_t(ids, ecs_id_record_t*);
+    for (i = 0; i < count; i ++) {
+        if (arr[i] == idr) {
+            ecs_vec_remove_t(ids, ecs_id_record_t*, i);
+            break;
+        }
+    }
+}
+
 static
 void flecs_id_record_free(
     ecs_world_t *world,
@@ -384,6 +417,10 @@ void flecs_id_record_free(
             if (ECS_PAIR_FIRST(id) != EcsFlag) {
                 /* If id is not a wildcard, remove it from the wildcard lists */
                 flecs_remove_id_elem(idr, ecs_pair(rel, EcsWildcard));
+                if (idr->parent) {
+                    /* Traversal indices could contain this record */
+                    idr->parent->trav_generation ++;
+                }
                 flecs_remove_id_elem(idr, ecs_pair(EcsWildcard, tgt));
             }
         } else {
@@ -421,10 +458,19 @@ void flecs_id_record_free(
     world->info.component_id_count -= idr->type_info != NULL;
     world->info.tag_id_count -= idr->type_info == NULL;
 
+    if (idr->flags & EcsIdSparse) {
+        flecs_id_record_sparse_fini(world, idr);
+    }
+
     /* Unregister the id record from the world & free resources */
     ecs_table_cache_fini(&idr->cache);
     flecs_name_index_free(idr->name_index);
     ecs_vec_fini_t(&world->allocator, &idr->reachable.ids, ecs_reachable_elem_t);
+    if (idr->trav_index) {
+        ecs_vec_fini_t(&world->allocator, &idr->trav_index->idrs, 
+            ecs_id_record_t*);
+        flecs_free_t(&world->allocator, ecs_trav_index_t, idr->trav_index);
+    }
 
     ecs_id_t hash = flecs_id_record_hash(id);
     if (hash >= FLECS_HI_ID_RECORD_ID) {
@@ -502,6 +548,100 @@ ecs_id_record_t* flecs_query_id_record_get(
     return idr;
 }
 
+static
+void flecs_id_record_trav_index_build(
+    ecs_world_t *world,
+    ecs_vec_t *idrs,
+    ecs_entity_t trav,
+    ecs_id_record_t *idr)
+{
+    ecs_vec_append_t(&world->allocator, idrs, ecs_id_record_t*)[0] = idr;
+
+    ecs_table_cache_iter_t it;
+    if (flecs_table_cache_iter(&idr->cache, &it)) {
+        ecs_table_record_t *tr; 
+        while ((tr = flecs_table_cache_next(&it, ecs_table_record_t))) {
+            ecs_table_t *table = tr->hdr.table;
+            if (!table->_->traversable_count) {
+                continue;
+            }
+
+            int32_t i, count = ecs_table_count(table);
+            ecs_entity_t *entities = table->data.entities.array;
+            for (i = 0; i < count; i ++) {
+                ecs_record_t *r = flecs_entities_get(world, entities[i]);
+                if (!(r->row & EcsEntityIsTraversable)) {
+                    continue;
+                }
+
+                ecs_id_record_t *idr_e = flecs_id_record_get(world, 
+                    ecs_pair(trav, entities[i]));
+                if (idr_e) {
+                    flecs_id_record_trav_index_build(world, idrs, trav, idr_e);
+                }
+            }
+        }
+    }
+}
+
+const ecs_vec_t* flecs_id_record_trav_index(
+    ecs_world_t *world,
+    ecs_id_record_t *idr)
+{
+    ecs_poly_assert(world, ecs_world_t);
+    ecs_assert(idr != NULL, ECS_INTERNAL_ERROR, NULL);
+    ecs_assert(ECS_IS_PAIR(idr->id), ECS_INTERNAL_ERROR, NULL);
+    ecs_assert(!ecs_id_is_wildcard(idr->id), ECS_INTERNAL_ERROR, NULL);
+
+    ecs_id_record_t *idr_r = idr->parent;
+    if (!idr_r || !(idr->flags & EcsIdTraversable)) {
+        return NULL;
+    }
+
+    ecs_trav_index_t *index = idr->trav_index;
+    if (index && index->generation == idr_r->trav_generation) {
+        return &index->idrs;
+    }
+
+    /* Index is out of date. Can't rebuild it while other threads could be
+     * reading from it. */
+    if (world->flags & EcsWorldMultiThreaded) {
+        return NULL;
+    }
+
+    if (!index) {
+        index = idr->trav_index = flecs_calloc_t(
+            &world->allocator, ecs_trav_index_t);
+    } else {
+        ecs_vec_clear(&index->idrs);
+    }
+
+    flecs_id_record_trav_index_build(
+        world, &index->idrs, ECS_PAIR_FIRST(idr->id), idr);
+    index->generation = idr_r->trav_generation;
+
+    return &index->idrs;
+}
+
+void flecs_id_record_trav_invalidate(
+    ecs_world_t *world,
+    const ecs_type_t *type)
+{
+    int32_t i, count = type->count;
+    ecs_id_t *ids = type->array;
+    for (i = 0; i < count; i ++) {
+        ecs_id_t id = ids[i];
+        if (!ECS_IS_PAIR(id)) {
+            continue;
+        }
+
+        ecs_id_record_t *idr = flecs_id_record_get(world, id);
+        if (idr && (idr->flags & EcsIdTraversable) && idr->parent) {
+            idr->parent->trav_generation ++;
+        }
+    }
+}
+
 void flecs_id_record_claim(
     ecs_world_t *world,
     ecs_id_record_t *idr)
@@ -524,6 +664,54 @@ int32_t flecs_id_record_release(
     return rc;
 }
 
+void* flecs_id_record_sparse_get(
+    const ecs_id_record_t *idr,
+    ecs_entity_t entity)
+{
+    ecs_assert(idr->flags & EcsIdSparse, ECS_INTERNAL_ERROR, NULL);
+    if (!idr->sparse) {
+        return NULL;
+    }
+    return flecs_sparse_get_any(idr->sparse, 0, (uint32_t)entity);
+}
+
+bool flecs_id_record_sparse_has(
+    const ecs_id_record_t *idr,
+    ecs_entity_t entity)
+{
+    ecs_assert(idr->flags & EcsIdSparse, ECS_INTERNAL_ERROR, NULL);
+    if (!idr->sparse) {
+        return false;
+    }
+    return flecs_sparse_has(idr->sparse, (uint32_t)entity);
+}
+
+void* flecs_id_record_sparse_insert(
+    ecs_world_t *world,
+    ecs_id_record_t *idr,
+    ecs_entity_t entity)
+{
+    ecs_assert(idr->flags & EcsIdSparse, ECS_INTERNAL_ERROR, NULL);
+    ecs_sparse_t *sparse = idr->sparse;
+    if (!sparse) {
+        const ecs_type_info_t *ti = idr->type_info;
+        sparse = idr->sparse = ecs_os_calloc_t(ecs_sparse_t);
+        flecs_sparse_init(sparse, &world->allocator, 
+            &world->allocators.sparse_chunk, ti ? ti->size : 0);
+    }
+    return flecs_sparse_ensure(sparse, 0, (uint32_t)entity);
+}
+
+void flecs_id_record_sparse_remove(
+    ecs_id_record_t *idr,
+    ecs_entity_t entity)
+{
+    ecs_assert(idr->flags & EcsIdSparse, ECS_INTERNAL_ERROR, NULL);
+    if (idr->sparse) {
+        flecs_sparse_remove_fast(idr->sparse, 0, (uint32_t)entity);
+    }
+}
+
 void flecs_id_record_release_tables(
     ecs_world_t *world,
     ecs_id_record_t *idr)
@@ -666,4 +854,5 @@ void flecs_fini_id_records(
 
     ecs_map_fini(&world->id_index_hi);
     ecs_os_free(world->id_index_lo);
+    ecs_vec_fini_t(&world->allocator, &world->sparse_ids, ecs_id_record_t*);
 }
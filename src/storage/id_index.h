@@ -24,9 +24,7 @@ typedef struct ecs_reachable_elem_t {
     ecs_record_t *record;
     ecs_entity_t src;
     ecs_id_t id;
-#ifndef NDEBUG
     ecs_table_t *table;
-#endif
 } ecs_reachable_elem_t;
 
 typedef struct ecs_reachable_cache_t {
@@ -35,6 +33,14 @@ typedef struct ecs_reachable_cache_t {
     ecs_vec_t ids; /* vec<reachable_elem_t> */
 } ecs_reachable_cache_t;
 
+/* Transitive closure of a (R, tgt) record for a traversable relationship. The
+ * index contains the record itself and the (R, e) records for all entities e
+ * that (transitively) have (R, tgt). */
+typedef struct ecs_trav_index_t {
+    int32_t generation; /* Generation of (R, *) record when index was built */
+    ecs_vec_t idrs;     /* vec<ecs_id_record_t*> */
+} ecs_trav_index_t;
+
 /* Payload for id index which contains all data structures for an id. */
 struct ecs_id_record_t {
     /* Cache with all tables that contain the id. Must be first member. */
@@ -52,6 +58,9 @@ struct ecs_id_record_t {
     /* Name lookup index (currently only used for ChildOf pairs) */
     ecs_hashmap_t *name_index;
 
+    /* Storage for components with the Sparse trait, indexed by entity */
+    ecs_sparse_t *sparse;
+
     /* Lists for all id records that match a pair wildcard. The wildcard id
      * record is at the head of the list. */
     ecs_id_record_elem_t first;   /* (R, *) */
@@ -71,6 +80,13 @@ struct ecs_id_record_t {
 
     /* Cache invalidation counter */
     ecs_reachable_cache_t reachable;
+
+    /* Traversal index for (R, tgt) records of traversable relationships */
+    ecs_trav_index_t *trav_index;
+
+    /* Incremented when the entities with a (R, tgt) pair change. Only used on
+     * (R, *) records, invalidates the traversal indices of (R, tgt) records. */
+    int32_t trav_generation;
 };
 
 /* Get id record for id */
@@ -78,6 +94,18 @@ ecs_id_record_t* flecs_id_record_get(
     const ecs_world_t *world,
     ecs_id_t id);
 
+/* Get transitive closure for (R, tgt) record of a traversable relationship.
+ * Returns NULL if the index is out of date and the world is multithreaded, in
+ * which case the closure must be computed by the caller. */
+const ecs_vec_t* flecs_id_record_trav_index(
+    ecs_world_t *world,
+    ecs_id_record_t *idr);
+
+/* Invalidate traversal indices of relationships in type */
+void flecs_id_record_trav_invalidate(
+    ecs_world_t *world,
+    const ecs_type_t *type);
+
 /* Get id record for id for searching.
  * Same as flecs_id_record_get, but replaces (R, *) with (Union, R) if R is a
  * union relationship. */
@@ -136,6 +164,27 @@ ecs_table_record_t* flecs_id_record_get_table(
     const ecs_id_record_t *idr,
     const ecs_table_t *table);
 
+/* Get sparse component for entity, NULL if entity doesn't have it */
+void* flecs_id_record_sparse_get(
+    const ecs_id_record_t *idr,
+    ecs_entity_t entity);
+
+/* Test if entity has sparse component */
+bool flecs_id_record_sparse_has(
+    const ecs_id_record_t *idr,
+    ecs_entity_t entity);
+
+/* Insert sparse component for entity. Does not construct the value. */
+void* flecs_id_record_sparse_insert(
+    ecs_world_t *world,
+    ecs_id_record_t *idr,
+    ecs_entity_t entity);
+
+/* Remove sparse component for entity. Does not destruct the value. */
+void flecs_id_record_sparse_remove(
+    ecs_id_record_t *idr,
+    ecs_entity_t entity);
+
 /* Bootstrap cached id records */
 void flecs_init_id_records(
     ecs_world_t *world);
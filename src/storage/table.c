@@ -91,6 +91,11 @@ void flecs_table_check_sanity(ecs_table_t *table) {
 
     ecs_assert((table->_->traversable_count == 0) || 
         (table->flags & EcsTableHasTraversable), ECS_INTERNAL_ERROR, NULL);
+
+    if (table->flags & EcsTableHasRowVersions) {
+        ecs_assert(ecs_vec_count(&table->_->row_versions) == count,
+            ECS_INTERNAL_ERROR, NULL);
+    }
 }
 #else
 #define flecs_table_check_sanity(table)
@@ -291,6 +296,61 @@ void flecs_table_init_flags(
     }
 }
 
+/* Number of bits in an id signature */
+#define FLECS_ID_SIGNATURE_BITS (FLECS_ID_SIGNATURE_WORDS * 64)
+
+void flecs_id_signature_add(
+    ecs_id_signature_t *sig,
+    ecs_id_t id)
+{
+    /* Fibonacci hash, set two bits from the upper (best mixed) bits */
+    uint64_t hash = id * 11400714819323198485ull;
+    uint32_t b1 = (uint32_t)(hash >> 40) % FLECS_ID_SIGNATURE_BITS;
+    uint32_t b2 = (uint32_t)(hash >> 52) % FLECS_ID_SIGNATURE_BITS;
+    sig->bits[b1 / 64] |= 1ull << (b1 % 64);
+    sig->bits[b2 / 64] |= 1ull << (b2 % 64);
+}
+
+bool flecs_id_signature_has(
+    const ecs_id_signature_t *sig,
+    const ecs_id_signature_t *ids)
+{
+    int32_t i;
+    for (i = 0; i < FLECS_ID_SIGNATURE_WORDS; i ++) {
+        if ((sig->bits[i] & ids->bits[i]) != ids->bits[i]) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/* Initialize signature with the ids of the table. Pairs also add their 
+ * wildcard projections, so that a table with (Eats, Apples) can be tested
+ * for (Eats, *) and (*, Apples). */
+static
+void flecs_table_init_signature(
+    ecs_table_t *table)
+{
+    ecs_id_signature_t *sig = &table->_->signature;
+    ecs_id_t *ids = table->type.array;
+    int32_t i, count = table->type.count;
+
+    for (i = 0; i < count; i ++) {
+        ecs_id_t id = ids[i];
+        flecs_id_signature_add(sig, id);
+
+        if (ECS_IS_PAIR(id)) {
+            ecs_entity_t first = ECS_PAIR_FIRST(id);
+            ecs_entity_t second = ECS_PAIR_SECOND(id);
+            flecs_id_signature_add(sig, ecs_pair(first, EcsWildcard));
+            flecs_id_signature_add(sig, ecs_pair(EcsWildcard, second));
+            if (first == EcsUnion) {
+                flecs_id_signature_add(sig, ecs_pair(second, EcsWildcard));
+            }
+        }
+    }
+}
+
 /* Utility function that appends an element to the table record array */
 static
 void flecs_table_append_to_records(
@@ -326,6 +386,7 @@ void flecs_table_init(
 {
     /* Make sure table->flags is initialized */
     flecs_table_init_flags(world, table);
+    flecs_table_init_signature(table);
 
     /* The following code walks the table type to discover which id records the
      * table needs to register table records with. 
@@ -759,6 +820,22 @@ void flecs_table_invoke_remove_hooks(
     }
 }
 
+/* Remove entity from entity index, and cleanup its sparse components */
+static
+void flecs_table_remove_entity(
+    ecs_world_t *world,
+    ecs_entity_t e)
+{
+    if (ecs_vec_count(&world->sparse_ids)) {
+        ecs_record_t *record = flecs_entities_get(world, e);
+        if (record && (record->row & EcsEntityHasSparse)) {
+            flecs_entity_remove_sparse(world, e);
+        }
+    }
+
+    flecs_entities_remove(world, e);
+}
+
 /* Destruct all components and/or delete all entities in table in range */
 static
 void flecs_table_dtor_all(
@@ -815,14 +892,14 @@ void flecs_table_dtor_all(
                     ECS_INTERNAL_ERROR, NULL);
 
                 if (is_delete) {
-                    flecs_entities_remove(world, e);
+                    flecs_table_remove_entity(world, e);
                     ecs_assert(ecs_is_valid(world, e) == false, 
                         ECS_INTERNAL_ERROR, NULL);
                 } else {
                     // If this is not a delete, clear the entity index record
                     ecs_record_t *record = flecs_entities_get(world, e);
                     record->table = NULL;
-                    record->row = 0;
+                    record->row &= EcsEntityHasSparse;
                 }
             } else {
                 /* This should only happen in rare cases, such as when the data
@@ -838,7 +915,7 @@ void flecs_table_dtor_all(
             for (i = row; i < end; i ++) {
                 ecs_entity_t e = entities[i];
                 ecs_assert(!e || ecs_is_valid(world, e), ECS_INTERNAL_ERROR, NULL);
-                flecs_entities_remove(world, e);
+                flecs_table_remove_entity(world, e);
                 ecs_assert(!ecs_is_valid(world, e), ECS_INTERNAL_ERROR, NULL);
             } 
         } else {
@@ -854,6 +931,130 @@ void flecs_table_dtor_all(
     }
 }
 
+/* Row versions store a copy of the table dirty state for each row. Element 0 is
+ * the value of dirty_state[0] when the row was added to the table, element 
+ * column + 1 is the value of dirty_state[column + 1] when the column was last 
+ * written for that row. A query that stores the table dirty state in its
+ * monitor can compare the two to find the rows that changed since the last
+ * time the query was iterated. Versions are only tracked for tables that are
+ * iterated by a changed rows iterator. */
+static
+ecs_size_t flecs_table_row_versions_size(
+    const ecs_table_t *table)
+{
+    return ECS_SIZEOF(int32_t) * (table->column_count + 1);
+}
+
+/* Large columns are stored in reserved virtual memory when the OS API provides
+ * virtual memory functions. Growing such a column commits more pages of the
+ * reservation, which doesn't copy or move existing elements. */
+static
+bool flecs_table_column_use_vmem(
+    const ecs_column_t *column,
+    int32_t elem_count)
+{
+    if (column->reserved) {
+        return true;
+    }
+
+    return (column->size * elem_count >= FLECS_VMEM_COLUMN_THRESHOLD) &&
+        ecs_os_has_vmem();
+}
+
+/* Resize column that is (or will be) stored in virtual memory */
+static
+void flecs_table_column_vmem_resize(
+    ecs_world_t *world,
+    ecs_column_t *column,
+    int32_t elem_count)
+{
+    ecs_size_t size = column->size;
+    ecs_size_t bytes = size * elem_count;
+    ecs_size_t cur_bytes = size * column->data.size;
+    ecs_size_t reserved = column->reserved;
+    void *ptr = column->data.array;
+
+    if (reserved && bytes <= reserved) {
+        if (bytes > cur_bytes) {
+            if (!ecs_os_vmem_commit(
+                ECS_OFFSET(ptr, cur_bytes), bytes - cur_bytes)) 
+            {
+                ecs_abort(ECS_OUT_OF_MEMORY, NULL);
+            }
+        } else if (bytes < cur_bytes) {
+            ecs_os_vmem_decommit(ECS_OFFSET(ptr, bytes), cur_bytes - bytes);
+        }
+        column->data.size = elem_count;
+        return;
+    }
+
+    /* Column doesn't fit in reservation, move elements to new reservation */
+    ecs_size_t reserve = FLECS_VMEM_COLUMN_RESERVE;
+    if (reserve < bytes) {
+        reserve = bytes > (INT32_MAX / 2) ? bytes : bytes * 2;
+    }
+
+    void *dst = ecs_os_vmem_reserve(reserve);
+    if (!dst || !ecs_os_vmem_commit(dst, bytes)) {
+        ecs_abort(ECS_OUT_OF_MEMORY, NULL);
+    }
+
+    int32_t count = column->data.count;
+    if (count) {
+        ecs_type_info_t *ti = column->ti;
+        ecs_move_t move = ti->hooks.ctor_move_dtor;
+        if (move) {
+            move(dst, ptr, count, ti);
+        } else {
+            ecs_os_memcpy(dst, ptr, size * count);
+        }
+    }
+
+    if (reserved) {
+        ecs_os_vmem_release(ptr, reserved);
+    } else {
+        ecs_vec_fini(flecs_column_allocator(world), &column->data, size);
+    }
+
+    column->data.array = dst;
+    column->data.count = count;
+    column->data.size = elem_count;
+    column->reserved = reserve;
+}
+
+/* Set capacity of column */
+static
+void flecs_table_column_set_size(
+    ecs_world_t *world,
+    ecs_column_t *column,
+    int32_t elem_count)
+{
+    if (flecs_table_column_use_vmem(column, elem_count)) {
+        flecs_table_column_vmem_resize(world, column, elem_count);
+    } else {
+        ecs_vec_set_size(flecs_column_allocator(world), 
+            &column->data, column->size, elem_count);
+    }
+}
+
+/* Free column storage */
+static
+void flecs_table_column_fini(
+    ecs_world_t *world,
+    ecs_column_t *column)
+{
+    if (column->reserved) {
+        ecs_os_vmem_release(column->data.array, column->reserved);
+        column->data.array = NULL;
+        column->data.count = 0;
+        column->data.size = 0;
+        column->reserved = 0;
+    } else {
+        ecs_vec_fini(flecs_column_allocator(world), 
+            &column->data, column->size);
+    }
+}
+
 /* Cleanup table storage */
 static
 void flecs_table_fini_data(
@@ -888,8 +1089,7 @@ void flecs_table_fini_data(
             /* Sanity check */
             ecs_assert(columns[c].data.count == data->entities.count,
                 ECS_INTERNAL_ERROR, NULL);
-            ecs_vec_fini(&world->allocator,
-                &columns[c].data, columns[c].size);
+            flecs_table_column_fini(world, &columns[c]);
         }
         flecs_wfree_n(world, ecs_column_t, column_count, columns);
         data->columns = NULL;
@@ -916,6 +1116,12 @@ void flecs_table_fini_data(
         meta->bs_columns = NULL;
     }
 
+    if (data == &table->data) {
+        ecs_vec_fini(&world->allocator, &meta->row_versions,
+            flecs_table_row_versions_size(table));
+        table->flags &= ~EcsTableHasRowVersions;
+    }
+
     ecs_vec_fini_t(&world->allocator, &data->entities, ecs_entity_t);
 
     if (deactivate && count) {
@@ -1103,6 +1309,7 @@ void flecs_table_mark_table_dirty(
 void flecs_table_mark_dirty(
     ecs_world_t *world,
     ecs_table_t *table,
+    int32_t row,
     ecs_entity_t component)
 {
     ecs_assert(!table->_->lock, ECS_LOCKED_STORAGE, NULL);
@@ -1119,7 +1326,12 @@ void flecs_table_mark_dirty(
             return;
         }
 
-        table->dirty_state[tr->column + 1] ++;
+        int32_t value = ++ table->dirty_state[tr->column + 1];
+        if ((table->flags & EcsTableHasRowVersions) && 
+            (row < ecs_table_count(table))) 
+        {
+            flecs_table_stamp_rows(table, tr->column + 1, row, 1, value);
+        }
     }
 }
 
@@ -1142,6 +1354,100 @@ int32_t* flecs_table_get_dirty_state(
     return table->dirty_state;
 }
 
+/* Add row versions for rows appended to the table */
+static
+void flecs_table_row_versions_addn(
+    ecs_world_t *world,
+    ecs_table_t *table,
+    int32_t count)
+{
+    if (!(table->flags & EcsTableHasRowVersions) || !count) {
+        return;
+    }
+
+    ecs_size_t size = flecs_table_row_versions_size(table);
+    int32_t *rv = ecs_vec_grow(&world->allocator, 
+        &table->_->row_versions, size, count);
+    ecs_os_memset(rv, 0, size * count);
+
+    int32_t i, added = table->dirty_state[0];
+    int32_t stride = table->column_count + 1;
+    for (i = 0; i < count; i ++) {
+        rv[i * stride] = added;
+    }
+}
+
+/* Remove row version, move last row into removed row */
+static
+void flecs_table_row_versions_remove(
+    ecs_table_t *table,
+    int32_t row)
+{
+    if (table->flags & EcsTableHasRowVersions) {
+        ecs_vec_remove(&table->_->row_versions, 
+            flecs_table_row_versions_size(table), row);
+    }
+}
+
+void flecs_table_init_row_versions(
+    ecs_world_t *world,
+    ecs_table_t *table)
+{
+    ecs_assert(!table->_->lock, ECS_LOCKED_STORAGE, NULL);
+    if (table->flags & EcsTableHasRowVersions) {
+        return;
+    }
+
+    /* Existing rows get the current table state, as there is no way to tell
+     * when they were last changed. */
+    int32_t *dirty_state = flecs_table_get_dirty_state(world, table);
+    int32_t i, count = ecs_table_count(table);
+    int32_t stride = table->column_count + 1;
+    ecs_size_t size = flecs_table_row_versions_size(table);
+    ecs_vec_init(&world->allocator, &table->_->row_versions, size, count);
+    ecs_vec_set_count(&world->allocator, 
+        &table->_->row_versions, size, count);
+    int32_t *rv = ecs_vec_first(&table->_->row_versions);
+    for (i = 0; i < count; i ++) {
+        ecs_os_memcpy_n(&rv[i * stride], dirty_state, int32_t, stride);
+    }
+
+    table->flags |= EcsTableHasRowVersions;
+    flecs_table_check_sanity(table);
+}
+
+int32_t* flecs_table_row_versions(
+    const ecs_table_t *table,
+    int32_t row)
+{
+    if (!(table->flags & EcsTableHasRowVersions)) {
+        return NULL;
+    }
+    return ecs_vec_get(&table->_->row_versions, 
+        flecs_table_row_versions_size(table), row);
+}
+
+void flecs_table_stamp_rows(
+    ecs_table_t *table,
+    int32_t column,
+    int32_t offset,
+    int32_t count,
+    int32_t value)
+{
+    ecs_assert(table->flags & EcsTableHasRowVersions, 
+        ECS_INTERNAL_ERROR, NULL);
+    ecs_assert(column >= 0 && column <= table->column_count, 
+        ECS_INTERNAL_ERROR, NULL);
+    ecs_assert((offset + count) <= ecs_table_count(table), 
+        ECS_INTERNAL_ERROR, NULL);
+
+    int32_t i, stride = table->column_count + 1;
+    int32_t *rv = ecs_vec_first(&table->_->row_versions);
+    for (i = offset; i < (offset + count); i ++) {
+        rv[i * stride + column] = value;
+    }
+}
+
 /* Table move logic for switch (union relationship) column */
 static
 void flecs_table_move_switch_columns(
@@ -1305,6 +1611,7 @@ void flecs_table_grow_column(
 {
     ecs_assert(column != NULL, ECS_INTERNAL_ERROR, NULL);
 
+    ecs_allocator_t *a = flecs_column_allocator(world);
     ecs_type_info_t *ti = column->ti;
     int32_t size = column->size;
     int32_t count = column->data.count;
@@ -1315,6 +1622,12 @@ void flecs_table_grow_column(
 
     ecs_assert(dst_size >= dst_count, ECS_INTERNAL_ERROR, NULL);
 
+    /* Growing a column in virtual memory doesn't move existing elements */
+    if (can_realloc && flecs_table_column_use_vmem(column, dst_size)) {
+        flecs_table_column_vmem_resize(world, column, dst_size);
+        can_realloc = false;
+    }
+
     /* If the array could possibly realloc and the component has a move action 
      * defined, move old elements manually */
     ecs_move_t move_ctor;
@@ -1325,7 +1638,7 @@ void flecs_table_grow_column(
 
         /* Create  vector */
         ecs_vec_t dst;
-        ecs_vec_init(&world->allocator, &dst, size, dst_size);
+        ecs_vec_init(a, &dst, size, dst_size);
         dst.count = dst_count;
 
         void *src_buffer = column->data.array;
@@ -1341,22 +1654,24 @@ void flecs_table_grow_column(
         }
 
         /* Free old vector */
-        ecs_vec_fini(&world->allocator, &column->data, size);
+        ecs_vec_fini(a, &column->data, size);
 
         column->data = dst;
     } else {
         /* If array won't realloc or has no move, simply add new elements */
         if (can_realloc) {
-            ecs_vec_set_size(&world->allocator, &column->data, size, dst_size);
+            ecs_vec_set_size(a, &column->data, size, dst_size);
         }
 
-        result = ecs_vec_grow(&world->allocator, &column->data, size, to_add);
+        if (to_add) {
+            result = ecs_vec_grow(a, &column->data, size, to_add);
 
-        ecs_xtor_t ctor;
-        if (construct && (ctor = ti->hooks.ctor)) {
-            /* If new elements need to be constructed and component has a
-             * constructor, construct */
-            ctor(result, to_add, ti);
+            ecs_xtor_t ctor;
+            if (construct && (ctor = ti->hooks.ctor)) {
+                /* If new elements need to be constructed and component has a
+                 * constructor, construct */
+                ctor(result, to_add, ti);
+            }
         }
     }
 
@@ -1400,8 +1715,10 @@ int32_t flecs_table_grow_data(
     for (i = 0; i < column_count; i ++) {
         flecs_table_grow_column(world, &columns[i], to_add, size, true);
         ecs_assert(columns[i].data.size == size, ECS_INTERNAL_ERROR, NULL);
-        flecs_table_invoke_add_hooks(world, table, &columns[i], e, 
-            cur_count, to_add, false);
+        if (to_add) {
+            flecs_table_invoke_add_hooks(world, table, &columns[i], e, 
+                cur_count, to_add, false);
+        }
     }
 
     ecs_table__t *meta = table->_;
@@ -1424,6 +1741,9 @@ int32_t flecs_table_grow_data(
 
     /* If the table is monitored indicate that there has been a change */
     flecs_table_mark_table_dirty(world, table, 0);
+    if (data == &table->data) {
+        flecs_table_row_versions_addn(world, table, to_add);
+    }
 
     if (!(world->flags & EcsWorldReadonly) && !cur_count) {
         flecs_table_set_empty(world, table);
@@ -1438,13 +1758,20 @@ static
 void flecs_table_fast_append(
     ecs_world_t *world,
     ecs_column_t *columns,
-    int32_t count)
+    int32_t count,
+    int32_t size)
 {
     /* Add elements to each column array */
     int32_t i;
     for (i = 0; i < count; i ++) {
         ecs_column_t *column = &columns[i];
-        ecs_vec_append(&world->allocator, &column->data, column->size);
+        if ((column->data.count == column->data.size) && 
+            flecs_table_column_use_vmem(column, size)) 
+        {
+            flecs_table_column_vmem_resize(world, column, size);
+        }
+        ecs_vec_append(flecs_column_allocator(world), 
+            &column->data, column->size);
     }
 }
 
@@ -1482,7 +1809,8 @@ int32_t flecs_table_append(
 
     /* Fast path: no switch columns, no lifecycle actions */
     if (!(table->flags & EcsTableIsComplex)) {
-        flecs_table_fast_append(world, columns, column_count);
+        flecs_table_fast_append(world, columns, column_count, 
+            data->entities.size);
         if (!count) {
             flecs_table_set_empty(world, table); /* See below */
         }
@@ -1534,6 +1862,8 @@ int32_t flecs_table_append(
         flecs_bitset_addn(bs, 1);
     }
 
+    flecs_table_row_versions_addn(world, table, 1);
+
     /* If this is the first entity in this table, signal queries so that the
      * table moves from an inactive table to an active table. */
     if (!count) {
@@ -1704,6 +2034,8 @@ void flecs_table_delete(
         flecs_bitset_remove(&bs_columns[i], index);
     }
 
+    flecs_table_row_versions_remove(table, index);
+
     flecs_table_check_sanity(table);
 }
 
@@ -1852,6 +2184,274 @@ void flecs_table_move(
     flecs_table_check_sanity(src_table);
 }
 
+/* Delete range of entities from table. The gap is filled with the entities at
+ * the end of the table, so that each column is moved at most once. */
+void flecs_table_delete_range(
+    ecs_world_t *world,
+    ecs_table_t *table,
+    int32_t index,
+    int32_t count,
+    bool destruct)
+{
+    ecs_assert(world != NULL, ECS_INTERNAL_ERROR, NULL);
+    ecs_assert(table != NULL, ECS_INTERNAL_ERROR, NULL);
+    ecs_assert(!table->_->lock, ECS_LOCKED_STORAGE, NULL);
+    ecs_assert(!(table->flags & EcsTableHasTarget),
+        ECS_INVALID_OPERATION, NULL);
+    ecs_assert(!(table->flags & (EcsTableHasUnion|EcsTableHasToggle)),
+        ECS_INTERNAL_ERROR, NULL);
+
+    flecs_table_check_sanity(table);
+
+    ecs_data_t *data = &table->data;
+    int32_t table_count = data->entities.count;
+    ecs_assert(count > 0, ECS_INTERNAL_ERROR, NULL);
+    ecs_assert(index >= 0, ECS_INTERNAL_ERROR, NULL);
+    ecs_assert((index + count) <= table_count, ECS_INTERNAL_ERROR, NULL);
+
+    /* Number of entities after the range that will be moved into the gap */
+    int32_t to_move = table_count - (index + count);
+    if (to_move > count) {
+        to_move = count;
+    }
+    int32_t move_from = table_count - to_move;
+
+    ecs_entity_t *entities = data->entities.array;
+    ecs_column_t *columns = data->columns;
+    int32_t i, column_count = table->column_count;
+
+    if (destruct && (table->flags & EcsTableHasDtors)) {
+        for (i = 0; i < column_count; i ++) {
+            flecs_table_invoke_remove_hooks(world, table, &columns[i],
+                &entities[index], index, count, true);
+        }
+    }
+
+    /* Move entity ids from end of table into gap & update entity index */
+    for (i = 0; i < to_move; i ++) {
+        ecs_entity_t e = entities[move_from + i];
+        ecs_record_t *record = flecs_entities_get(world, e);
+        ecs_assert(record != NULL, ECS_INTERNAL_ERROR, NULL);
+        ecs_assert(record->table == table, ECS_INTERNAL_ERROR, NULL);
+        uint32_t row_flags = record->row & ECS_ROW_FLAGS_MASK;
+        record->row = ECS_ROW_TO_RECORD(index + i, row_flags);
+        entities[index + i] = e;
+    }
+    data->entities.count = table_count - count;
+
+    /* Values in the range have been moved or destructed, so the gap can be
+     * treated as uninitialized memory */
+    for (i = 0; i < column_count; i ++) {
+        ecs_column_t *column = &columns[i];
+        if (to_move) {
+            ecs_size_t size = column->size;
+            void *dst = ECS_ELEM(column->data.array, size, index);
+            void *src = ECS_ELEM(column->data.array, size, move_from);
+            ecs_type_info_t *ti = column->ti;
+            ecs_move_t move = ti->hooks.ctor_move_dtor;
+            if (move) {
+                move(dst, src, to_move, ti);
+            } else {
+                ecs_os_memcpy(dst, src, size * to_move);
+            }
+        }
+        column->data.count = table_count - count;
+    }
+
+    if (table->flags & EcsTableHasRowVersions) {
+        ecs_vec_t *rv = &table->_->row_versions;
+        ecs_size_t size = flecs_table_row_versions_size(table);
+        if (to_move) {
+            ecs_os_memcpy(ECS_ELEM(rv->array, size, index),
+                ECS_ELEM(rv->array, size, move_from), size * to_move);
+        }
+        rv->count = table_count - count;
+    }
+
+    /* If the table is monitored indicate that there has been a change */
+    flecs_table_mark_table_dirty(world, table, 0);
+
+    /* If table is empty, deactivate it */
+    if (table_count == count) {
+        flecs_table_set_empty(world, table);
+    }
+
+    flecs_table_check_sanity(table);
+}
+
+/* Invoke OnAdd or OnRemove hooks for columns in table that are not in other */
+static
+void flecs_table_invoke_diff_hooks(
+    ecs_world_t *world,
+    ecs_table_t *table,
+    ecs_table_t *other,
+    int32_t row,
+    int32_t count,
+    ecs_entity_t event)
+{
+    ecs_column_t *columns = table->data.columns;
+    ecs_column_t *other_columns = other->data.columns;
+    int32_t i, column_count = table->column_count;
+    int32_t o = 0, other_count = other->column_count;
+    ecs_entity_t *entities = ecs_vec_get_t(
+        &table->data.entities, ecs_entity_t, row);
+
+    for (i = 0; i < column_count; i ++) {
+        ecs_column_t *column = &columns[i];
+        ecs_id_t id = column->id;
+        while ((o < other_count) && (other_columns[o].id < id)) {
+            o ++;
+        }
+        if ((o < other_count) && (other_columns[o].id == id)) {
+            continue;
+        }
+
+        ecs_iter_action_t hook = (event == EcsOnAdd)
+            ? column->ti->hooks.on_add
+            : column->ti->hooks.on_remove;
+        if (hook) {
+            flecs_table_invoke_hook(world, table, hook, event, column,
+                entities, row, count);
+        }
+    }
+}
+
+/* Move range of entities from src to dst table. The entities are appended to
+ * the dst table and deleted from the src table, which takes a single move per
+ * column for the entire range. Returns the first row in the dst table. */
+int32_t flecs_table_move_range(
+    ecs_world_t *world,
+    ecs_table_t *dst_table,
+    ecs_table_t *src_table,
+    int32_t src_index,
+    int32_t count,
+    bool construct)
+{
+    ecs_assert(dst_table != NULL, ECS_INTERNAL_ERROR, NULL);
+    ecs_assert(src_table != NULL, ECS_INTERNAL_ERROR, NULL);
+    ecs_assert(dst_table != src_table, ECS_INTERNAL_ERROR, NULL);
+    ecs_assert(!dst_table->_->lock, ECS_LOCKED_STORAGE, NULL);
+    ecs_assert(!src_table->_->lock, ECS_LOCKED_STORAGE, NULL);
+    ecs_assert(!(dst_table->flags & EcsTableHasTarget),
+        ECS_INVALID_OPERATION, NULL);
+    ecs_assert(count > 0, ECS_INTERNAL_ERROR, NULL);
+
+    flecs_table_check_sanity(dst_table);
+    flecs_table_check_sanity(src_table);
+
+    ecs_data_t *src_data = &src_table->data;
+    ecs_data_t *dst_data = &dst_table->data;
+    int32_t src_count = src_data->entities.count;
+    int32_t dst_index = dst_data->entities.count;
+    ecs_assert((src_index + count) <= src_count, ECS_INTERNAL_ERROR, NULL);
+
+    /* If the entire table is moved, merge the storage of the two tables. This
+     * reuses the src columns when the dst table is empty. */
+    if (!src_index && (count == src_count) && construct) {
+        if (src_table->flags & EcsTableHasDtors) {
+            flecs_table_invoke_diff_hooks(world, src_table, dst_table,
+                0, count, EcsOnRemove);
+        }
+
+        flecs_table_merge(world, dst_table, src_table, dst_data, src_data);
+
+        if (dst_table->flags & EcsTableHasCtors) {
+            flecs_table_invoke_diff_hooks(world, dst_table, src_table,
+                dst_index, count, EcsOnAdd);
+        }
+        return dst_index;
+    }
+
+    ecs_assert(!((dst_table->flags | src_table->flags) &
+        (EcsTableHasUnion|EcsTableHasToggle)), ECS_INTERNAL_ERROR, NULL);
+
+    /* Append entity ids to dst table & update entity index */
+    ecs_entity_t *src_entities = ecs_vec_get_t(
+        &src_data->entities, ecs_entity_t, src_index);
+    ecs_entity_t *dst_entities = ecs_vec_grow_t(
+        &world->allocator, &dst_data->entities, ecs_entity_t, count);
+    ecs_os_memcpy_n(dst_entities, src_entities, ecs_entity_t, count);
+
+    int32_t i, traversable = 0;
+    for (i = 0; i < count; i ++) {
+        ecs_record_t *record = flecs_entities_get(world, dst_entities[i]);
+        ecs_assert(record != NULL, ECS_INTERNAL_ERROR, NULL);
+        uint32_t row_flags = ECS_RECORD_TO_ROW_FLAGS(record->row);
+        record->row = ECS_ROW_TO_RECORD(dst_index + i, row_flags);
+        record->table = dst_table;
+        traversable += (row_flags & EcsEntityIsTraversable) != 0;
+    }
+
+    /* Grow dst columns without constructing, values are moved in below */
+    int32_t size = dst_data->entities.size;
+    ecs_column_t *src_columns = src_data->columns;
+    ecs_column_t *dst_columns = dst_data->columns;
+    int32_t i_new = 0, dst_column_count = dst_table->column_count;
+    int32_t i_old = 0, src_column_count = src_table->column_count;
+    for (i = 0; i < dst_column_count; i ++) {
+        flecs_table_grow_column(world, &dst_columns[i], count, size, false);
+    }
+
+    for (; (i_new < dst_column_count) && (i_old < src_column_count); ) {
+        ecs_column_t *dst_column = &dst_columns[i_new];
+        ecs_column_t *src_column = &src_columns[i_old];
+        ecs_id_t dst_id = dst_column->id;
+        ecs_id_t src_id = src_column->id;
+
+        if (dst_id == src_id) {
+            ecs_size_t elem_size = dst_column->size;
+            ecs_type_info_t *ti = dst_column->ti;
+            void *dst = ECS_ELEM(dst_column->data.array, elem_size, dst_index);
+            void *src = ECS_ELEM(src_column->data.array, elem_size, src_index);
+            ecs_move_t move = ti->hooks.ctor_move_dtor;
+            if (move) {
+                move(dst, src, count, ti);
+            } else {
+                ecs_os_memcpy(dst, src, elem_size * count);
+            }
+        } else if (dst_id < src_id) {
+            flecs_table_invoke_add_hooks(world, dst_table, dst_column,
+                dst_entities, dst_index, count, construct);
+        } else {
+            flecs_table_invoke_remove_hooks(world, src_table, src_column,
+                src_entities, src_index, count, true);
+        }
+
+        i_new += dst_id <= src_id;
+        i_old += dst_id >= src_id;
+    }
+
+    for (; (i_new < dst_column_count); i_new ++) {
+        flecs_table_invoke_add_hooks(world, dst_table, &dst_columns[i_new],
+            dst_entities, dst_index, count, construct);
+    }
+
+    for (; (i_old < src_column_count); i_old ++) {
+        flecs_table_invoke_remove_hooks(world, src_table, &src_columns[i_old],
+            src_entities, src_index, count, true);
+    }
+
+    /* If the table is monitored indicate that there has been a change */
+    flecs_table_mark_table_dirty(world, dst_table, 0);
+    flecs_table_row_versions_addn(world, dst_table, count);
+
+    if (!dst_index) {
+        flecs_table_set_empty(world, dst_table);
+    }
+
+    if (traversable) {
+        flecs_table_traversable_add(dst_table, traversable);
+        flecs_table_traversable_add(src_table, -traversable);
+    }
+
+    /* Remove range from src table. Values have already been moved out. */
+    flecs_table_delete_range(world, src_table, src_index, count, false);
+
+    flecs_table_check_sanity(dst_table);
+
+    return dst_index;
+}
+
 /* Append n entities to table */
 int32_t flecs_table_appendn(
     ecs_world_t *world,
@@ -1891,6 +2491,25 @@ void flecs_table_set_size(
     }
 }
 
+/* Reserve storage for count entities that are added to table, so that adding
+ * them doesn't allocate */
+void flecs_table_reserve(
+    ecs_world_t *world,
+    ecs_table_t *table,
+    int32_t count)
+{
+    ecs_data_t *data = &table->data;
+    int32_t size = flecs_table_data_count(data) + count;
+    if (data->entities.size < size) {
+        flecs_table_set_size(world, table, data, size);
+    }
+
+    if (table->flags & EcsTableHasRowVersions) {
+        ecs_vec_set_min_size(&world->allocator, &table->_->row_versions,
+            flecs_table_row_versions_size(table), size);
+    }
+}
+
 /* Shrink table storage to fit number of entities */
 bool flecs_table_shrink(
     ecs_world_t *world,
@@ -1909,12 +2528,61 @@ bool flecs_table_shrink(
     int32_t i, count = table->column_count;
     for (i = 0; i < count; i ++) {
         ecs_column_t *column = &data->columns[i];
-        ecs_vec_reclaim(&world->allocator, &column->data, column->size);
+        if (!column->reserved) {
+            ecs_vec_reclaim(flecs_column_allocator(world), 
+                &column->data, column->size);
+        } else if (column->data.count) {
+            flecs_table_column_vmem_resize(world, column, column->data.count);
+        } else {
+            flecs_table_column_fini(world, column);
+        }
+    }
+
+    if (table->flags & EcsTableHasRowVersions) {
+        ecs_vec_reclaim(&world->allocator, &table->_->row_versions, 
+            flecs_table_row_versions_size(table));
     }
 
     return has_payload;
 }
 
+/* Move column storage of table from one allocator to another */
+void flecs_table_move_columns(
+    ecs_world_t *world,
+    ecs_table_t *table,
+    ecs_allocator_t *dst,
+    ecs_allocator_t *src)
+{
+    ecs_assert(table != NULL, ECS_INTERNAL_ERROR, NULL);
+    ecs_assert(!table->_->lock, ECS_LOCKED_STORAGE, NULL);
+    (void)world;
+
+    ecs_data_t *data = &table->data;
+    int32_t i, count = table->column_count;
+    for (i = 0; i < count; i ++) {
+        ecs_column_t *column = &data->columns[i];
+        int32_t size = column->size;
+        int32_t elem_count = column->data.count;
+        if (!column->data.array || column->reserved) {
+            continue; /* Columns in virtual memory don't use allocator */
+        }
+
+        ecs_vec_t vec;
+        ecs_vec_init(dst, &vec, size, column->data.size);
+        vec.count = elem_count;
+
+        ecs_move_t move = column->ti->hooks.ctor_move_dtor;
+        if (move) {
+            move(vec.array, column->data.array, elem_count, column->ti);
+        } else {
+            ecs_os_memcpy(vec.array, column->data.array, size * elem_count);
+        }
+
+        ecs_vec_fini(src, &column->data, size);
+        column->data = vec;
+    }
+}
+
 /* Return number of entities in table */
 int32_t flecs_table_data_count(
     const ecs_data_t *data)
@@ -1962,6 +2630,26 @@ void flecs_table_swap_bitset_columns(
     }
 }
 
+/* Swap operation for row versions */
+static
+void flecs_table_swap_row_versions(
+    ecs_table_t *table,
+    int32_t row_1,
+    int32_t row_2)
+{
+    if (!(table->flags & EcsTableHasRowVersions)) {
+        return;
+    }
+
+    ecs_size_t size = flecs_table_row_versions_size(table);
+    void *tmp = ecs_os_alloca(size);
+    void *el_1 = flecs_table_row_versions(table, row_1);
+    void *el_2 = flecs_table_row_versions(table, row_2);
+    ecs_os_memcpy(tmp, el_1, size);
+    ecs_os_memcpy(el_1, el_2, size);
+    ecs_os_memcpy(el_2, tmp, size);
+}
+
 /* Swap two rows in a table. Used for table sorting. */
 void flecs_table_swap(
     ecs_world_t *world,
@@ -2006,6 +2694,7 @@ void flecs_table_swap(
 
     flecs_table_swap_switch_columns(table, row_1, row_2);
     flecs_table_swap_bitset_columns(table, row_1, row_2);
+    flecs_table_swap_row_versions(table, row_1, row_2);
 
     ecs_column_t *columns = table->data.columns;
     if (!columns) {
@@ -2098,11 +2787,12 @@ void flecs_table_merge_column(
     int32_t dst_count = dst->data.count;
 
     if (!dst_count) {
-        ecs_vec_fini(&world->allocator, &dst->data, size);
+        flecs_table_column_fini(world, dst);
         *dst = *src;
         src->data.array = NULL;
         src->data.count = 0;
         src->data.size = 0;
+        src->reserved = 0;
 
     /* If the new table is not empty, copy the contents from the
      * src into the dst. */
@@ -2123,7 +2813,7 @@ void flecs_table_merge_column(
             ecs_os_memcpy(dst_ptr, src_ptr, size * src_count);
         }
 
-        ecs_vec_fini(&world->allocator, &src->data, size);
+        flecs_table_column_fini(world, src);
     }
 }
 
@@ -2155,7 +2845,7 @@ void flecs_table_merge_data(
     ecs_assert(dst_data->entities.count == src_count + dst_count, 
         ECS_INTERNAL_ERROR, NULL);
     int32_t column_size = dst_data->entities.size;
-    ecs_allocator_t *a = &world->allocator;
+    ecs_allocator_t *a = flecs_column_allocator(world);
 
     for (; (i_new < dst_column_count) && (i_old < src_column_count); ) {
         ecs_column_t *dst_column = &dst_columns[i_new];
@@ -2171,14 +2861,14 @@ void flecs_table_merge_data(
         } else if (dst_id < src_id) {
             /* New column, make sure vector is large enough. */
             ecs_size_t size = dst_column->size;
-            ecs_vec_set_size(a, &dst_column->data, size, column_size);
+            flecs_table_column_set_size(world, dst_column, column_size);
             ecs_vec_set_count(a, &dst_column->data, size, src_count + dst_count);
             flecs_table_invoke_ctor(dst_column, dst_count, src_count);
             i_new ++;
         } else if (dst_id > src_id) {
             /* Old column does not occur in new table, destruct */
             flecs_table_invoke_dtor(src_column, 0, src_count);
-            ecs_vec_fini(a, &src_column->data, src_column->size);
+            flecs_table_column_fini(world, src_column);
             i_old ++;
         }
     }
@@ -2191,7 +2881,7 @@ void flecs_table_merge_data(
         ecs_column_t *column = &dst_columns[i_new];
         int32_t size = column->size;
         ecs_assert(size != 0, ECS_INTERNAL_ERROR, NULL);
-        ecs_vec_set_size(a, &column->data, size, column_size);
+        flecs_table_column_set_size(world, column, column_size);
         ecs_vec_set_count(a, &column->data, size, src_count + dst_count);
         flecs_table_invoke_ctor(column, dst_count, src_count);
     }
@@ -2200,7 +2890,7 @@ void flecs_table_merge_data(
     for (; i_old < src_column_count; i_old ++) {
         ecs_column_t *column = &src_columns[i_old];
         flecs_table_invoke_dtor(column, 0, src_count);
-        ecs_vec_fini(a, &column->data, column->size);
+        flecs_table_column_fini(world, column);
     }    
 
     /* Mark entity column as dirty */
@@ -2267,6 +2957,23 @@ void flecs_table_merge(
             src_data, dst_data);
     }
 
+    /* Merged rows are new to the destination table */
+    if ((src_table != dst_table) && (src_data == &src_table->data)) {
+        if (src_table->flags & EcsTableHasRowVersions) {
+            ecs_vec_clear(&src_table->_->row_versions);
+        }
+    }
+    if (dst_data == &dst_table->data) {
+        if (move_data && (dst_table->flags & EcsTableHasRowVersions)) {
+            ecs_vec_clear(&dst_table->_->row_versions);
+            flecs_table_mark_table_dirty(world, dst_table, 0);
+            flecs_table_row_versions_addn(world, dst_table, 
+                ecs_table_count(dst_table));
+        } else {
+            flecs_table_row_versions_addn(world, dst_table, src_count);
+        }
+    }
+
     if (src_count) {
         if (!dst_count) {
             flecs_table_set_empty(world, dst_table);
@@ -31,6 +31,11 @@ typedef struct ecs_table_event_t {
      * initializing an event a bit simpler. */
 } ecs_table_event_t;
 
+/* Allocator used for component column storage */
+#define flecs_column_allocator(world)\
+    (((world)->flags & EcsWorldAlignedColumns) ?\
+        &(world)->column_allocator : &(world)->allocator)
+
 /** Infrequently accessed data not stored inline in ecs_table_t */
 typedef struct ecs_table__t {
     uint64_t hash;                   /* Type hash */
@@ -49,6 +54,9 @@ typedef struct ecs_table__t {
     int16_t bs_count;
     int16_t bs_offset;
     int16_t ft_offset;
+
+    ecs_id_signature_t signature;    /* Signature of ids in table type */
+    ecs_vec_t row_versions;          /* Per row dirty state, see flecs_table_init_row_versions */
 } ecs_table__t;
 
 /** Table column */
@@ -57,6 +65,7 @@ typedef struct ecs_column_t {
     ecs_id_t id;                     /* Component id */
     ecs_type_info_t *ti;             /* Component type info */
     ecs_size_t size;                 /* Component size */
+    ecs_size_t reserved;             /* Reserved bytes for vmem column */
 } ecs_column_t;
 
 /** Table data */
@@ -87,6 +96,16 @@ struct ecs_table_t {
     ecs_table__t *_;                 /* Infrequently accessed table metadata */
 };
 
+/* Add id to signature */
+void flecs_id_signature_add(
+    ecs_id_signature_t *sig,
+    ecs_id_t id);
+
+/* Test if signature (possibly) contains all ids of another signature */
+bool flecs_id_signature_has(
+    const ecs_id_signature_t *sig,
+    const ecs_id_signature_t *ids);
+
 /* Init table */
 void flecs_table_init(
     ecs_world_t *world,
@@ -168,6 +187,23 @@ void flecs_table_move(
     int32_t old_index,
     bool construct);
 
+/* Delete a range of entities from the table. */
+void flecs_table_delete_range(
+    ecs_world_t *world,
+    ecs_table_t *table,
+    int32_t index,
+    int32_t count,
+    bool destruct);
+
+/* Move a range of rows from one table to another */
+int32_t flecs_table_move_range(
+    ecs_world_t *world,
+    ecs_table_t *dst_table,
+    ecs_table_t *src_table,
+    int32_t src_index,
+    int32_t count,
+    bool construct);
+
 /* Grow table with specified number of records. Populate table with entities,
  * starting from specified entity id. */
 int32_t flecs_table_appendn(
@@ -184,11 +220,24 @@ void flecs_table_set_size(
     ecs_data_t *data,
     int32_t count);
 
+/* Reserve storage for count entities that are added to table */
+void flecs_table_reserve(
+    ecs_world_t *world,
+    ecs_table_t *table,
+    int32_t count);
+
 /* Shrink table to contents */
 bool flecs_table_shrink(
     ecs_world_t *world,
     ecs_table_t *table);
 
+/* Move column storage of table from one allocator to another */
+void flecs_table_move_columns(
+    ecs_world_t *world,
+    ecs_table_t *table,
+    ecs_allocator_t *dst,
+    ecs_allocator_t *src);
+
 /* Get dirty state for table columns */
 int32_t* flecs_table_get_dirty_state(
     ecs_world_t *world,
@@ -236,8 +285,27 @@ void flecs_table_swap(
 void flecs_table_mark_dirty(
     ecs_world_t *world,
     ecs_table_t *table,
+    int32_t row,
     ecs_entity_t component);
 
+/* Enable per-row change tracking for table */
+void flecs_table_init_row_versions(
+    ecs_world_t *world,
+    ecs_table_t *table);
+
+/* Get row versions for row. Returns NULL if table does not track versions. */
+int32_t* flecs_table_row_versions(
+    const ecs_table_t *table,
+    int32_t row);
+
+/* Stamp column of range of rows with value */
+void flecs_table_stamp_rows(
+    ecs_table_t *table,
+    int32_t column,
+    int32_t offset,
+    int32_t count,
+    int32_t value);
+
 void flecs_table_notify(
     ecs_world_t *world,
     ecs_table_t *table,
@@ -56,6 +56,7 @@ const ecs_entity_t EcsOneOf =                       FLECS_HI_COMPONENT_ID + 26;
 const ecs_entity_t EcsTrait =                       FLECS_HI_COMPONENT_ID + 27;
 const ecs_entity_t EcsRelationship =            FLECS_HI_COMPONENT_ID + 28;
 const ecs_entity_t EcsTarget =                  FLECS_HI_COMPONENT_ID + 29;
+const ecs_entity_t EcsSparse =                      FLECS_HI_COMPONENT_ID + 45;
 
 /* Builtin relationships */
 const ecs_entity_t EcsChildOf =                     FLECS_HI_COMPONENT_ID + 30;
@@ -389,7 +390,7 @@ ecs_world_t* flecs_suspend_readonly(
     state->defer_count = stage->defer;
     state->commands = stage->cmd->queue;
     state->defer_stack = stage->cmd->stack;
-    flecs_stack_init(&stage->cmd->stack);
+    flecs_stack_init_w_cache(&stage->cmd->stack, &stage->allocators.stack_pages);
     state->scope = stage->scope;
     state->with = stage->with;
     stage->defer = 0;
@@ -441,6 +442,11 @@ void flecs_eval_component_monitor(
 
     world->monitors.is_dirty = false;
 
+    /* Collect queries first, so they can be rematched in parallel */
+    ecs_allocator_t *a = &world->allocator;
+    ecs_vec_t queries;
+    ecs_vec_init_t(a, &queries, ecs_query_t*, 0);
+
     ecs_map_iter_t it = ecs_map_iter(&world->monitors.monitors);
     while (ecs_map_next(&it)) {
         ecs_monitor_t *m = ecs_map_ptr(&it);
@@ -450,15 +456,15 @@ void flecs_eval_component_monitor(
 
         m->is_dirty = false;
 
-        int32_t i, count = ecs_vec_count(&m->queries);
-        ecs_query_t **elems = ecs_vec_first(&m->queries);
-        for (i = 0; i < count; i ++) {
-            ecs_query_t *q = elems[i];
-            flecs_query_notify(world, q, &(ecs_query_event_t) {
-                .kind = EcsQueryTableRematch
-            });
-        }
+        int32_t count = ecs_vec_count(&m->queries);
+        ecs_os_memcpy_n(ecs_vec_grow_t(a, &queries, ecs_query_t*, count),
+            ecs_vec_first(&m->queries), ecs_query_t*, count);
     }
+
+    flecs_query_rematch_all(world, ecs_vec_first(&queries), 
+        ecs_vec_count(&queries));
+
+    ecs_vec_fini_t(a, &queries, ecs_query_t*);
 }
 
 void flecs_monitor_mark_dirty(
@@ -635,7 +641,7 @@ void flecs_fini_root_tables(
             for (i = count - 1; i >= 0; i --) {
                 ecs_record_t *r = flecs_entities_get(world, entities[i]);
                 ecs_assert(r != NULL, ECS_INTERNAL_ERROR, NULL);
-                if (!ECS_RECORD_TO_ROW_FLAGS(r->row)) {
+                if (!(ECS_RECORD_TO_ROW_FLAGS(r->row) & ~EcsEntityHasSparse)) {
                     ecs_delete(world, entities[i]);
                 }
             }
@@ -726,6 +732,9 @@ void flecs_world_allocators_init(
     ecs_world_allocators_t *a = &world->allocators;
 
     flecs_allocator_init(&world->allocator);
+    flecs_allocator_init_aligned(&world->column_allocator, 
+        FLECS_COLUMN_ALIGNMENT);
+    flecs_balloc_depot_init(&world->stack_pages, FLECS_STACK_PAGE_ALLOC_SIZE);
 
     ecs_map_params_init(&a->ptr, &world->allocator);
     ecs_map_params_init(&a->query_table_list, &world->allocator);
@@ -763,6 +772,8 @@ void flecs_world_allocators_fini(
     flecs_table_diff_builder_fini(world, &world->allocators.diff_builder);
 
     flecs_allocator_fini(&world->allocator);
+    flecs_allocator_fini(&world->column_allocator);
+    flecs_balloc_depot_fini(&world->stack_pages);
 }
 
 #define ECS_STRINGIFY_INNER(x) #x
@@ -800,6 +811,9 @@ static const char *flecs_addons_info[] = {
 #ifdef FLECS_SNAPSHOT
     "FLECS_SNAPSHOT",
 #endif
+#ifdef FLECS_RECORDER
+    "FLECS_RECORDER",
+#endif
 #ifdef FLECS_STATS
     "FLECS_STATS",
 #endif
@@ -962,6 +976,7 @@ ecs_world_t *ecs_mini(void) {
         &world->allocators.sparse_chunk, ecs_type_info_t);
     ecs_map_init_w_params(&world->id_index_hi, &world->allocators.ptr);
     world->id_index_lo = ecs_os_calloc_n(ecs_id_record_t, FLECS_HI_ID_RECORD_ID);
+    ecs_vec_init_t(a, &world->sparse_ids, ecs_id_record_t*, 0);
     flecs_observable_init(&world->observable);
     world->iterable.init = flecs_world_iter_init;
 
@@ -1646,6 +1661,36 @@ bool ecs_enable_range_check(
     return old_value;
 }
 
+bool ecs_enable_aligned_columns(
+    ecs_world_t *world,
+    bool enable)
+{
+    ecs_poly_assert(world, ecs_world_t);
+    ecs_check(!(world->flags & EcsWorldReadonly), 
+        ECS_INVALID_OPERATION, NULL);
+    ecs_check(!ecs_is_deferred(world), ECS_INVALID_OPERATION, NULL);
+
+    bool old_value = ECS_BIT_IS_SET(world->flags, EcsWorldAlignedColumns);
+    if (old_value == enable) {
+        return old_value;
+    }
+
+    ecs_allocator_t *src = flecs_column_allocator(world);
+    ECS_BIT_COND(world->flags, EcsWorldAlignedColumns, enable);
+    ecs_allocator_t *dst = flecs_column_allocator(world);
+
+    int32_t i, count = flecs_sparse_count(&world->store.tables);
+    for (i = 1; i < count; i ++) {
+        ecs_table_t *table = flecs_sparse_get_dense_t(&world->store.tables,
+            ecs_table_t, i);
+        flecs_table_move_columns(world, table, dst, src);
+    }
+
+    return old_value;
+error:
+    return false;
+}
+
 ecs_entity_t ecs_get_max_id(
     const ecs_world_t *world)
 {
@@ -2127,6 +2172,11 @@ void flecs_table_set_empty(
     ecs_assert(!(world->flags & EcsWorldReadonly), ECS_INTERNAL_ERROR, NULL);
     ecs_assert(table != NULL, ECS_INTERNAL_ERROR, NULL);
 
+    if (world->flags & EcsWorldParallelMerging) {
+        /* Tables are registered by main thread after workers are done */
+        return;
+    }
+
     if (ecs_table_count(table)) {
         table->_->generation = 0;
     }
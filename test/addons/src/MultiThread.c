@@ -1382,3 +1382,1073 @@ void MultiThread_run_single_thread_on_main(void) {
 
     ecs_fini(world);
 }
+
+static
+void stealing_test_entities(
+    int32_t thread_count,
+    int32_t entity_count,
+    int32_t table_count)
+{
+    ecs_world_t *world = init_world();
+
+    ecs_set_worker_sched(world, EcsWorkerSchedStealing);
+    test_int(ecs_get_worker_sched(world), EcsWorkerSchedStealing);
+
+    int i;
+    ecs_entity_t *handles = ecs_os_malloc_n(ecs_entity_t, entity_count);
+    ecs_entity_t *tags = NULL;
+    if (table_count) {
+        tags = ecs_os_malloc_n(ecs_entity_t, table_count);
+        for (i = 0; i < table_count; i ++) {
+            tags[i] = ecs_new_id(world);
+        }
+    }
+
+    for (i = 0; i < entity_count; i ++) {
+        handles[i] = ecs_new(world, Position);
+        ecs_set(world, handles[i], Position, {0});
+        if (table_count) {
+            ecs_add_id(world, handles[i], tags[i % table_count]);
+        }
+    }
+
+    ecs_set_threads(world, thread_count);
+    ecs_progress(world, 0);
+
+    for (i = 0; i < entity_count; i ++) {
+        test_int(ecs_get(world, handles[i], Position)->x, 1);
+    }
+
+    ecs_progress(world, 0);
+
+    for (i = 0; i < entity_count; i ++) {
+        test_int(ecs_get(world, handles[i], Position)->x, 2);
+    }
+
+    ecs_os_free(handles);
+    ecs_os_free(tags);
+
+    ecs_fini(world);
+}
+
+void MultiThread_stealing_2_thread_1_entity(void) {
+    stealing_test_entities(2, 1, 0);
+}
+
+void MultiThread_stealing_2_thread_1000_entity(void) {
+    stealing_test_entities(2, 1000, 0);
+}
+
+void MultiThread_stealing_6_thread_1000_entity(void) {
+    stealing_test_entities(6, 1000, 0);
+}
+
+void MultiThread_stealing_6_thread_1000_entity_100_tables(void) {
+    stealing_test_entities(6, 1000, 100);
+}
+
+static
+void CopyX(ecs_iter_t *it) {
+    Position *p = ecs_field(it, Position, 1);
+    int i;
+    for (i = 0; i < it->count; i ++) {
+        p[i].y = p[i].x;
+    }
+}
+
+void MultiThread_stealing_2_systems_in_op(void) {
+    ecs_world_t *world = init_world();
+
+    ecs_system(world, {
+        .entity = ecs_entity(world, { .add = { ecs_dependson(EcsOnUpdate) }}),
+        .query.filter.terms = {{ ecs_id(Position) }},
+        .multi_threaded = true,
+        .callback = CopyX
+    });
+
+    ecs_set_worker_sched(world, EcsWorkerSchedStealing);
+    ecs_set_threads(world, 4);
+
+    int i, ENTITIES = 2000;
+    ecs_entity_t *handles = ecs_os_malloc_n(ecs_entity_t, ENTITIES);
+    for (i = 0; i < ENTITIES; i ++) {
+        handles[i] = ecs_new(world, Position);
+        ecs_set(world, handles[i], Position, {0});
+    }
+
+    for (int f = 1; f < 10; f ++) {
+        ecs_progress(world, 0);
+        for (i = 0; i < ENTITIES; i ++) {
+            const Position *p = ecs_get(world, handles[i], Position);
+            test_int(p->x, f);
+            test_int(p->y, f);
+        }
+    }
+
+    ecs_os_free(handles);
+
+    ecs_fini(world);
+}
+
+void MultiThread_stealing_run_task_on_all_threads(void) {
+    ecs_world_t *world = ecs_init();
+
+    ecs_system(world, {
+        .entity = ecs_entity(world, { .add = { ecs_dependson(EcsOnUpdate) }}),
+        .multi_threaded = true,
+        .callback = dummy
+    });
+
+    ecs_set_worker_sched(world, EcsWorkerSchedStealing);
+    ecs_set_threads(world, 3);
+
+    main_thread = ecs_os_thread_self();
+
+    ecs_progress(world, 0);
+
+    test_int(invoked_count, 3);
+    test_int(invoked_main_count, 1);
+
+    ecs_fini(world);
+}
+
+void MultiThread_set_worker_sched_w_running_threads(void) {
+    ecs_world_t *world = init_world();
+
+    int i, ENTITIES = 500;
+    ecs_entity_t *handles = ecs_os_malloc_n(ecs_entity_t, ENTITIES);
+    for (i = 0; i < ENTITIES; i ++) {
+        handles[i] = ecs_new(world, Position);
+        ecs_set(world, handles[i], Position, {0});
+    }
+
+    test_int(ecs_get_worker_sched(world), EcsWorkerSchedSlice);
+
+    ecs_set_threads(world, 3);
+    ecs_progress(world, 0);
+
+    ecs_set_worker_sched(world, EcsWorkerSchedStealing);
+    test_int(ecs_get_worker_sched(world), EcsWorkerSchedStealing);
+    test_int(ecs_get_stage_count(world), 3);
+    ecs_progress(world, 0);
+
+    ecs_set_worker_sched(world, EcsWorkerSchedSlice);
+    test_int(ecs_get_worker_sched(world), EcsWorkerSchedSlice);
+    test_int(ecs_get_stage_count(world), 3);
+    ecs_progress(world, 0);
+
+    for (i = 0; i < ENTITIES; i ++) {
+        test_int(ecs_get(world, handles[i], Position)->x, 3);
+    }
+
+    ecs_os_free(handles);
+
+    ecs_fini(world);
+}
+
+void MultiThread_stealing_w_task_threads(void) {
+    ecs_world_t *world = init_world();
+
+    int i, ENTITIES = 500;
+    ecs_entity_t *handles = ecs_os_malloc_n(ecs_entity_t, ENTITIES);
+    for (i = 0; i < ENTITIES; i ++) {
+        handles[i] = ecs_new(world, Position);
+        ecs_set(world, handles[i], Position, {0});
+    }
+
+    ecs_set_worker_sched(world, EcsWorkerSchedStealing);
+    ecs_set_task_threads(world, 4);
+
+    ecs_progress(world, 0);
+    ecs_progress(world, 0);
+
+    for (i = 0; i < ENTITIES; i ++) {
+        test_int(ecs_get(world, handles[i], Position)->x, 2);
+    }
+
+    ecs_os_free(handles);
+
+    ecs_fini(world);
+}
+
+static int32_t balanced_invoked;
+static int32_t balanced_stage_count[6];
+
+static
+void CountPerStage(ecs_iter_t *it) {
+    int32_t stage_id = ecs_get_stage_id(it->world);
+    ecs_os_ainc(&balanced_invoked);
+    balanced_stage_count[stage_id] += it->count;
+}
+
+void MultiThread_balanced_6_thread_1000_entity_100_tables(void) {
+    ecs_world_t *world = ecs_init();
+
+    ECS_COMPONENT_DEFINE(world, Position);
+
+    ecs_system(world, {
+        .entity = ecs_entity(world, { .add = { ecs_dependson(EcsOnUpdate) }}),
+        .query.filter.terms = {{ ecs_id(Position) }},
+        .multi_threaded = true,
+        .callback = CountPerStage
+    });
+
+    int i;
+    ecs_entity_t tags[100];
+    for (i = 0; i < 100; i ++) {
+        tags[i] = ecs_new_id(world);
+    }
+
+    for (i = 0; i < 1000; i ++) {
+        ecs_entity_t e = ecs_new(world, Position);
+        ecs_add_id(world, e, tags[i % 100]);
+    }
+
+    balanced_invoked = 0;
+    ecs_os_zeromem(&balanced_stage_count);
+
+    ecs_set_threads(world, 6);
+    ecs_progress(world, 0);
+
+    /* Only tables on the boundary of a range are visited by two threads */
+    test_assert(balanced_invoked >= 100);
+    test_assert(balanced_invoked <= 105);
+
+    int32_t total = 0;
+    for (i = 0; i < 6; i ++) {
+        test_assert(balanced_stage_count[i] >= 166);
+        test_assert(balanced_stage_count[i] <= 167);
+        total += balanced_stage_count[i];
+    }
+    test_int(total, 1000);
+
+    ecs_fini(world);
+}
+
+void MultiThread_balanced_2_systems_in_op(void) {
+    ecs_world_t *world = ecs_init();
+
+    ECS_COMPONENT_DEFINE(world, Position);
+
+    ecs_system(world, {
+        .entity = ecs_entity(world, { .add = { ecs_dependson(EcsOnUpdate) }}),
+        .query.filter.terms = {{ ecs_id(Position) }},
+        .multi_threaded = true,
+        .callback = CountPerStage
+    });
+
+    ecs_system(world, {
+        .entity = ecs_entity(world, { .add = { ecs_dependson(EcsOnUpdate) }}),
+        .query.filter.terms = {{ ecs_id(Position) }},
+        .multi_threaded = true,
+        .callback = CountPerStage
+    });
+
+    int i;
+    ecs_entity_t tags[10];
+    for (i = 0; i < 10; i ++) {
+        tags[i] = ecs_new_id(world);
+    }
+
+    for (i = 0; i < 100; i ++) {
+        ecs_entity_t e = ecs_new(world, Position);
+        ecs_add_id(world, e, tags[i % 10]);
+    }
+
+    balanced_invoked = 0;
+    ecs_os_zeromem(&balanced_stage_count);
+
+    ecs_set_threads(world, 2);
+    ecs_progress(world, 0);
+
+    /* Systems that share an operation divide each table across threads, so
+     * that the same entities are processed by the same thread */
+    test_int(balanced_invoked, 40);
+    test_int(balanced_stage_count[0], 100);
+    test_int(balanced_stage_count[1], 100);
+
+    ecs_fini(world);
+}
+
+static int32_t parallel_a_started;
+static int32_t parallel_b_started;
+
+static
+bool wait_for_flag(int32_t *flag) {
+    int i;
+    for (i = 0; i < 1000; i ++) {
+        if (ecs_os_ainc(flag) > 1) {
+            ecs_os_adec(flag);
+            return true;
+        }
+        ecs_os_adec(flag);
+        ecs_os_sleep(0, 1000 * 1000);
+    }
+    return false;
+}
+
+static
+void ParallelA(ecs_iter_t *it) {
+    ecs_os_ainc(&parallel_a_started);
+    test_assert(wait_for_flag(&parallel_b_started));
+}
+
+static
+void ParallelB(ecs_iter_t *it) {
+    ecs_os_ainc(&parallel_b_started);
+    test_assert(wait_for_flag(&parallel_a_started));
+}
+
+void MultiThread_stealing_run_independent_systems_in_parallel(void) {
+    ecs_world_t *world = ecs_init();
+
+    ECS_COMPONENT_DEFINE(world, Position);
+    ECS_COMPONENT(world, Velocity);
+
+    ecs_system(world, {
+        .entity = ecs_entity(world, { .add = { ecs_dependson(EcsOnUpdate) }}),
+        .query.filter.terms = {{ ecs_id(Position) }},
+        .multi_threaded = true,
+        .callback = ParallelA
+    });
+
+    ecs_system(world, {
+        .entity = ecs_entity(world, { .add = { ecs_dependson(EcsOnUpdate) }}),
+        .query.filter.terms = {{ ecs_id(Velocity) }},
+        .multi_threaded = true,
+        .callback = ParallelB
+    });
+
+    ecs_set(world, 0, Position, {0, 0});
+    ecs_set(world, 0, Velocity, {0, 0});
+
+    ecs_set_worker_sched(world, EcsWorkerSchedStealing);
+    ecs_set_threads(world, 2);
+
+    parallel_a_started = 0;
+    parallel_b_started = 0;
+
+    /* Systems don't access the same components, so they can run at the same
+     * time. Each system waits for the other system to start. */
+    ecs_progress(world, 0);
+
+    test_int(parallel_a_started, 1);
+    test_int(parallel_b_started, 1);
+
+    ecs_fini(world);
+}
+
+static
+void SetX(ecs_iter_t *it) {
+    Position *p = ecs_field(it, Position, 1);
+    int i;
+    for (i = 0; i < it->count; i ++) {
+        /* Make sure the next system can start before this one finishes if the
+         * dependency isn't respected */
+        ecs_os_sleep(0, 1000);
+        p[i].x ++;
+    }
+}
+
+static
+void CopyXToVelocity(ecs_iter_t *it) {
+    const Position *p = ecs_field(it, Position, 1);
+    Velocity *v = ecs_field(it, Velocity, 2);
+    int i;
+    for (i = 0; i < it->count; i ++) {
+        v[i].x = p[i].x;
+    }
+}
+
+void MultiThread_stealing_dependent_systems_in_op(void) {
+    ecs_world_t *world = ecs_init();
+
+    ECS_COMPONENT_DEFINE(world, Position);
+    ECS_COMPONENT(world, Velocity);
+
+    ecs_system(world, {
+        .entity = ecs_entity(world, { .add = { ecs_dependson(EcsOnUpdate) }}),
+        .query.filter.terms = {{ ecs_id(Position) }},
+        .multi_threaded = true,
+        .callback = SetX
+    });
+
+    ecs_system(world, {
+        .entity = ecs_entity(world, { .add = { ecs_dependson(EcsOnUpdate) }}),
+        .query.filter.terms = {
+            { ecs_id(Position), .inout = EcsIn },
+            { ecs_id(Velocity), .inout = EcsOut }
+        },
+        .multi_threaded = true,
+        .callback = CopyXToVelocity
+    });
+
+    ecs_set_worker_sched(world, EcsWorkerSchedStealing);
+    ecs_set_threads(world, 4);
+
+    int i, ENTITIES = 100;
+    ecs_entity_t *handles = ecs_os_malloc_n(ecs_entity_t, ENTITIES);
+    for (i = 0; i < ENTITIES; i ++) {
+        handles[i] = ecs_set(world, 0, Position, {0, 0});
+        ecs_set(world, handles[i], Velocity, {0, 0});
+    }
+
+    for (int f = 1; f < 4; f ++) {
+        ecs_progress(world, 0);
+        for (i = 0; i < ENTITIES; i ++) {
+            test_int(ecs_get(world, handles[i], Position)->x, f);
+            test_int(ecs_get(world, handles[i], Velocity)->x, f);
+        }
+    }
+
+    ecs_os_free(handles);
+
+    ecs_fini(world);
+}
+
+static
+int32_t query_count(
+    ecs_query_t *q)
+{
+    int32_t result = 0;
+    ecs_iter_t it = ecs_query_iter(ecs_get_world(q), q);
+    while (ecs_query_next(&it)) {
+        result += it.count;
+    }
+    return result;
+}
+
+void MultiThread_rematch_queries_in_parallel(void) {
+    ecs_world_t *world = ecs_init();
+
+    ECS_COMPONENT_DEFINE(world, Position);
+    ECS_COMPONENT(world, Velocity);
+    ECS_TAG(world, TagA);
+
+    ecs_set_threads(world, 4);
+
+    ecs_entity_t parent = ecs_set(world, 0, Position, {10, 20});
+    ecs_entity_t child_1 = ecs_new_w_pair(world, EcsChildOf, parent);
+    ecs_entity_t child_2 = ecs_new_w_pair(world, EcsChildOf, parent);
+    ecs_add(world, child_2, TagA);
+    ecs_set(world, child_2, Velocity, {1, 2});
+
+    ecs_query_t *q[4];
+    q[0] = ecs_query(world, { .filter.terms = {
+        { ecs_id(Position), .src.flags = EcsUp, .src.trav = EcsChildOf }
+    }});
+    q[1] = ecs_query(world, { .filter.terms = {
+        { ecs_id(Position), .src.flags = EcsUp, .src.trav = EcsChildOf },
+        { TagA }
+    }});
+    q[2] = ecs_query(world, { .filter.terms = {
+        { ecs_id(Position), .src.flags = EcsUp, .src.trav = EcsChildOf },
+        { ecs_id(Velocity) }
+    }});
+    q[3] = ecs_query(world, { .filter.terms = {
+        { ecs_id(Position), .src.flags = EcsSelf|EcsUp, .src.trav = EcsChildOf },
+        { TagA, .oper = EcsNot }
+    }});
+
+    test_int(query_count(q[0]), 2);
+    test_int(query_count(q[1]), 1);
+    test_int(query_count(q[2]), 1);
+    test_int(query_count(q[3]), 2);
+
+    ecs_remove(world, parent, Position);
+    ecs_run_aperiodic(world, 0);
+
+    test_int(query_count(q[0]), 0);
+    test_int(query_count(q[1]), 0);
+    test_int(query_count(q[2]), 0);
+    test_int(query_count(q[3]), 0);
+
+    ecs_set(world, parent, Position, {30, 40});
+    ecs_run_aperiodic(world, 0);
+
+    test_int(query_count(q[0]), 2);
+    test_int(query_count(q[1]), 1);
+    test_int(query_count(q[2]), 1);
+    test_int(query_count(q[3]), 2);
+
+    ecs_iter_t it = ecs_query_iter(world, q[2]);
+    test_bool(true, ecs_query_next(&it));
+    test_int(it.count, 1);
+    test_uint(it.entities[0], child_2);
+    test_uint(ecs_field_src(&it, 1), parent);
+    const Position *p = ecs_field(&it, Position, 1);
+    test_int(p->x, 30);
+    test_int(p->y, 40);
+    test_bool(false, ecs_query_next(&it));
+
+    test_assert(child_1 != 0);
+
+    ecs_fini(world);
+}
+
+static ecs_entity_t rematch_parent;
+
+static
+void RemovePosition(ecs_iter_t *it) {
+    ecs_remove(it->world, rematch_parent, Position);
+}
+
+void MultiThread_rematch_queries_in_parallel_after_merge(void) {
+    ecs_world_t *world = ecs_init();
+
+    ECS_COMPONENT_DEFINE(world, Position);
+    ECS_TAG(world, TagA);
+    ECS_TAG(world, TagB);
+
+    ecs_set_worker_sched(world, EcsWorkerSchedStealing);
+    ecs_set_threads(world, 4);
+
+    ecs_entity_t parent = rematch_parent = ecs_set(world, 0, Position, {10, 20});
+    ecs_entity_t child = ecs_new_w_pair(world, EcsChildOf, parent);
+    ecs_add(world, child, TagA);
+    ecs_add(world, child, TagB);
+
+    ecs_query_t *q_a = ecs_query(world, { .filter.terms = {
+        { ecs_id(Position), .src.flags = EcsUp, .src.trav = EcsChildOf },
+        { TagA }
+    }});
+    ecs_query_t *q_b = ecs_query(world, { .filter.terms = {
+        { ecs_id(Position), .src.flags = EcsUp, .src.trav = EcsChildOf },
+        { TagB }
+    }});
+
+    ecs_system(world, {
+        .entity = ecs_entity(world, { .add = { ecs_dependson(EcsOnUpdate) }}),
+        .callback = RemovePosition
+    });
+
+    test_int(query_count(q_a), 1);
+    test_int(query_count(q_b), 1);
+
+    ecs_progress(world, 0);
+    test_assert(!ecs_has(world, parent, Position));
+
+    test_int(query_count(q_a), 0);
+    test_int(query_count(q_b), 0);
+
+    ecs_fini(world);
+}
+
+void MultiThread_rematch_queries_in_parallel_w_group_by(void) {
+    ecs_world_t *world = ecs_init();
+
+    ECS_COMPONENT_DEFINE(world, Position);
+    ECS_TAG(world, TagA);
+
+    ecs_set_threads(world, 3);
+
+    ecs_entity_t parent = ecs_set(world, 0, Position, {10, 20});
+    ecs_entity_t child = ecs_new_w_pair(world, EcsChildOf, parent);
+    ecs_entity_t grandchild = ecs_new_w_pair(world, EcsChildOf, child);
+    ecs_add(world, grandchild, TagA);
+
+    ecs_query_t *q_cascade = ecs_query(world, { .filter.terms = {
+        { ecs_id(Position), .src.flags = EcsCascade, .src.trav = EcsChildOf }
+    }});
+    ecs_query_t *q_tag = ecs_query(world, { .filter.terms = {
+        { ecs_id(Position), .src.flags = EcsUp, .src.trav = EcsChildOf },
+        { TagA }
+    }});
+
+    test_int(query_count(q_cascade), 2);
+    test_int(query_count(q_tag), 1);
+
+    ecs_remove(world, parent, Position);
+    ecs_run_aperiodic(world, 0);
+
+    test_int(query_count(q_cascade), 0);
+    test_int(query_count(q_tag), 0);
+
+    ecs_set(world, child, Position, {30, 40});
+    ecs_run_aperiodic(world, 0);
+
+    test_int(query_count(q_cascade), 1);
+    test_int(query_count(q_tag), 1);
+
+    ecs_iter_t it = ecs_query_iter(world, q_cascade);
+    test_bool(true, ecs_query_next(&it));
+    test_int(it.count, 1);
+    test_uint(it.entities[0], grandchild);
+    test_uint(ecs_field_src(&it, 1), child);
+    test_bool(false, ecs_query_next(&it));
+
+    ecs_fini(world);
+}
+
+#define PARALLEL_MERGE_COUNT (64)
+
+static ecs_entity_t parallel_merge_entities[PARALLEL_MERGE_COUNT];
+
+static
+void parallel_merge_populate(
+    ecs_world_t *world,
+    ecs_entity_t tag)
+{
+    int32_t i;
+    for (i = 0; i < PARALLEL_MERGE_COUNT; i ++) {
+        ecs_entity_t e = ecs_set(world, 0, Position, {i, i * 2});
+        if (i % 2) {
+            ecs_add_id(world, e, tag);
+        }
+        parallel_merge_entities[i] = e;
+    }
+}
+
+void MultiThread_parallel_merge_add(void) {
+    ecs_world_t *world = ecs_init();
+
+    ECS_COMPONENT_DEFINE(world, Position);
+    ECS_TAG(world, TagA);
+    ECS_TAG(world, TagB);
+
+    ecs_set_threads(world, 4);
+    ecs_set_parallel_merge(world, true);
+
+    parallel_merge_populate(world, TagA);
+
+    const ecs_world_info_t *info = ecs_get_world_info(world);
+    int64_t parallel_count = info->cmd.parallel_entity_count;
+
+    ecs_readonly_begin(world, true);
+    int32_t i;
+    for (i = 0; i < PARALLEL_MERGE_COUNT; i ++) {
+        ecs_world_t *stage = ecs_get_stage(world, i % 4);
+        ecs_add(stage, parallel_merge_entities[i], TagB);
+    }
+    ecs_readonly_end(world);
+
+    test_int(info->cmd.parallel_entity_count - parallel_count, 
+        PARALLEL_MERGE_COUNT);
+
+    for (i = 0; i < PARALLEL_MERGE_COUNT; i ++) {
+        ecs_entity_t e = parallel_merge_entities[i];
+        test_assert(ecs_has(world, e, TagB));
+        test_bool(ecs_has(world, e, TagA), i % 2);
+        const Position *p = ecs_get(world, e, Position);
+        test_assert(p != NULL);
+        test_int(p->x, i);
+        test_int(p->y, i * 2);
+    }
+
+    test_int(ecs_count(world, TagB), PARALLEL_MERGE_COUNT);
+
+    ecs_fini(world);
+}
+
+void MultiThread_parallel_merge_remove(void) {
+    ecs_world_t *world = ecs_init();
+
+    ECS_COMPONENT_DEFINE(world, Position);
+    ECS_TAG(world, TagA);
+    ECS_TAG(world, TagB);
+
+    ecs_set_threads(world, 4);
+    ecs_set_parallel_merge(world, true);
+
+    parallel_merge_populate(world, TagA);
+
+    int32_t i;
+    for (i = 0; i < PARALLEL_MERGE_COUNT; i ++) {
+        ecs_add(world, parallel_merge_entities[i], TagB);
+    }
+
+    const ecs_world_info_t *info = ecs_get_world_info(world);
+    int64_t parallel_count = info->cmd.parallel_entity_count;
+
+    ecs_readonly_begin(world, true);
+    for (i = 0; i < PARALLEL_MERGE_COUNT; i ++) {
+        ecs_world_t *stage = ecs_get_stage(world, i % 4);
+        ecs_remove(stage, parallel_merge_entities[i], TagB);
+    }
+    ecs_readonly_end(world);
+
+    test_int(info->cmd.parallel_entity_count - parallel_count, 
+        PARALLEL_MERGE_COUNT);
+
+    for (i = 0; i < PARALLEL_MERGE_COUNT; i ++) {
+        ecs_entity_t e = parallel_merge_entities[i];
+        test_assert(!ecs_has(world, e, TagB));
+        test_bool(ecs_has(world, e, TagA), i % 2);
+        const Position *p = ecs_get(world, e, Position);
+        test_assert(p != NULL);
+        test_int(p->x, i);
+        test_int(p->y, i * 2);
+    }
+
+    test_int(ecs_count(world, TagB), 0);
+
+    ecs_fini(world);
+}
+
+static int32_t parallel_merge_invoked = 0;
+
+static
+void ParallelMergeObserver(ecs_iter_t *it) {
+    parallel_merge_invoked += it->count;
+}
+
+void MultiThread_parallel_merge_set(void) {
+    ecs_world_t *world = ecs_init();
+
+    ECS_COMPONENT_DEFINE(world, Position);
+    ECS_COMPONENT(world, Velocity);
+    ECS_TAG(world, TagA);
+
+    ecs_set_threads(world, 4);
+    ecs_set_parallel_merge(world, true);
+
+    ECS_OBSERVER(world, ParallelMergeObserver, EcsOnSet, Velocity);
+
+    parallel_merge_populate(world, TagA);
+
+    const ecs_world_info_t *info = ecs_get_world_info(world);
+    int64_t parallel_count = info->cmd.parallel_entity_count;
+
+    ecs_readonly_begin(world, true);
+    int32_t i;
+    for (i = 0; i < PARALLEL_MERGE_COUNT; i ++) {
+        ecs_world_t *stage = ecs_get_stage(world, i % 4);
+        ecs_set(stage, parallel_merge_entities[i], Velocity, {i, -i});
+    }
+    test_int(parallel_merge_invoked, 0);
+    ecs_readonly_end(world);
+
+    test_int(info->cmd.parallel_entity_count - parallel_count, 
+        PARALLEL_MERGE_COUNT);
+    test_int(parallel_merge_invoked, PARALLEL_MERGE_COUNT);
+
+    for (i = 0; i < PARALLEL_MERGE_COUNT; i ++) {
+        ecs_entity_t e = parallel_merge_entities[i];
+        const Velocity *v = ecs_get(world, e, Velocity);
+        test_assert(v != NULL);
+        test_int(v->x, i);
+        test_int(v->y, -i);
+        const Position *p = ecs_get(world, e, Position);
+        test_assert(p != NULL);
+        test_int(p->x, i);
+        test_int(p->y, i * 2);
+    }
+
+    ecs_fini(world);
+}
+
+void MultiThread_parallel_merge_w_on_add_observer(void) {
+    ecs_world_t *world = ecs_init();
+
+    ECS_COMPONENT_DEFINE(world, Position);
+    ECS_TAG(world, TagA);
+    ECS_TAG(world, TagB);
+
+    ecs_set_threads(world, 4);
+    ecs_set_parallel_merge(world, true);
+
+    ECS_OBSERVER(world, ParallelMergeObserver, EcsOnAdd, TagB);
+
+    parallel_merge_populate(world, TagA);
+
+    const ecs_world_info_t *info = ecs_get_world_info(world);
+    int64_t parallel_count = info->cmd.parallel_entity_count;
+
+    ecs_readonly_begin(world, true);
+    int32_t i;
+    for (i = 0; i < PARALLEL_MERGE_COUNT; i ++) {
+        ecs_world_t *stage = ecs_get_stage(world, i % 4);
+        ecs_add(stage, parallel_merge_entities[i], TagB);
+    }
+    ecs_readonly_end(world);
+
+    /* Tables with OnAdd observers are merged on the main thread */
+    test_int(info->cmd.parallel_entity_count - parallel_count, 0);
+    test_int(parallel_merge_invoked, PARALLEL_MERGE_COUNT);
+    test_int(ecs_count(world, TagB), PARALLEL_MERGE_COUNT);
+
+    ecs_fini(world);
+}
+
+void MultiThread_parallel_merge_disabled(void) {
+    ecs_world_t *world = ecs_init();
+
+    ECS_COMPONENT_DEFINE(world, Position);
+    ECS_TAG(world, TagA);
+    ECS_TAG(world, TagB);
+
+    ecs_set_threads(world, 4);
+
+    parallel_merge_populate(world, TagA);
+
+    const ecs_world_info_t *info = ecs_get_world_info(world);
+    int64_t parallel_count = info->cmd.parallel_entity_count;
+
+    ecs_readonly_begin(world, true);
+    int32_t i;
+    for (i = 0; i < PARALLEL_MERGE_COUNT; i ++) {
+        ecs_world_t *stage = ecs_get_stage(world, i % 4);
+        ecs_add(stage, parallel_merge_entities[i], TagB);
+    }
+    ecs_readonly_end(world);
+
+    test_int(info->cmd.parallel_entity_count - parallel_count, 0);
+    test_int(ecs_count(world, TagB), PARALLEL_MERGE_COUNT);
+
+    ecs_fini(world);
+}
+
+void MultiThread_parallel_merge_empty_table(void) {
+    ecs_world_t *world = ecs_init();
+
+    ECS_COMPONENT_DEFINE(world, Position);
+    ECS_TAG(world, TagA);
+    ECS_TAG(world, TagB);
+
+    ecs_set_threads(world, 4);
+    ecs_set_parallel_merge(world, true);
+
+    ecs_query_t *q_a = ecs_query(world, { .filter.terms = {
+        { TagA }, { TagB, .oper = EcsNot }
+    }});
+    ecs_query_t *q_b = ecs_query(world, { .filter.terms = {{ TagB }}});
+
+    parallel_merge_populate(world, TagA);
+    test_int(query_count(q_a), PARALLEL_MERGE_COUNT / 2);
+    test_int(query_count(q_b), 0);
+
+    ecs_readonly_begin(world, true);
+    int32_t i;
+    for (i = 0; i < PARALLEL_MERGE_COUNT; i ++) {
+        ecs_world_t *stage = ecs_get_stage(world, i % 4);
+        ecs_add(stage, parallel_merge_entities[i], TagB);
+    }
+    ecs_readonly_end(world);
+
+    /* Source tables are now empty, destination tables are no longer empty */
+    test_int(query_count(q_a), 0);
+    test_int(query_count(q_b), PARALLEL_MERGE_COUNT);
+
+    ecs_iter_t it = ecs_query_iter(world, q_a);
+    test_bool(false, ecs_query_next(&it));
+
+    ecs_fini(world);
+}
+
+void MultiThread_parallel_merge_w_delete(void) {
+    ecs_world_t *world = ecs_init();
+
+    ECS_COMPONENT_DEFINE(world, Position);
+    ECS_TAG(world, TagA);
+    ECS_TAG(world, TagB);
+
+    ecs_set_threads(world, 2);
+    ecs_set_combined_merge(world, true);
+    ecs_set_parallel_merge(world, true);
+
+    parallel_merge_populate(world, TagA);
+
+    const ecs_world_info_t *info = ecs_get_world_info(world);
+    int64_t parallel_count = info->cmd.parallel_entity_count;
+
+    int32_t i, half = PARALLEL_MERGE_COUNT / 2;
+    ecs_readonly_begin(world, true);
+    ecs_world_t *s0 = ecs_get_stage(world, 0);
+    ecs_world_t *s1 = ecs_get_stage(world, 1);
+    for (i = 0; i < half; i ++) {
+        ecs_add(s0, parallel_merge_entities[i], TagB);
+    }
+    ecs_delete(s1, parallel_merge_entities[half]);
+    for (i = half + 1; i < PARALLEL_MERGE_COUNT; i ++) {
+        ecs_add(s1, parallel_merge_entities[i], TagB);
+    }
+    ecs_readonly_end(world);
+
+    /* Commands after the delete are merged on the main thread */
+    test_int(info->cmd.parallel_entity_count - parallel_count, half);
+
+    for (i = 0; i < PARALLEL_MERGE_COUNT; i ++) {
+        ecs_entity_t e = parallel_merge_entities[i];
+        if (i == half) {
+            test_assert(!ecs_is_alive(world, e));
+        } else {
+            test_assert(ecs_has(world, e, TagB));
+            const Position *p = ecs_get(world, e, Position);
+            test_assert(p != NULL);
+            test_int(p->x, i);
+            test_int(p->y, i * 2);
+        }
+    }
+
+    ecs_fini(world);
+}
+
+static ECS_TAG_DECLARE(ParallelMergeTag);
+
+static
+void AddParallelMergeTag(ecs_iter_t *it) {
+    int32_t i;
+    for (i = 0; i < it->count; i ++) {
+        ecs_add(it->world, it->entities[i], ParallelMergeTag);
+    }
+}
+
+void MultiThread_parallel_merge_w_progress(void) {
+    ecs_world_t *world = ecs_init();
+
+    ECS_COMPONENT_DEFINE(world, Position);
+    ECS_TAG_DEFINE(world, ParallelMergeTag);
+    ECS_TAG(world, TagA);
+
+    ecs_set_threads(world, 4);
+    ecs_set_parallel_merge(world, true);
+
+    ecs_system(world, {
+        .entity = ecs_entity(world, { .add = { ecs_dependson(EcsOnUpdate) }}),
+        .query.filter.terms = {
+            { ecs_id(Position) }, { ParallelMergeTag, .oper = EcsNot }
+        },
+        .callback = AddParallelMergeTag,
+        .multi_threaded = true
+    });
+
+    parallel_merge_populate(world, TagA);
+
+    const ecs_world_info_t *info = ecs_get_world_info(world);
+    int64_t parallel_count = info->cmd.parallel_entity_count;
+
+    ecs_progress(world, 0);
+
+    test_int(info->cmd.parallel_entity_count - parallel_count, 
+        PARALLEL_MERGE_COUNT);
+    test_int(ecs_count(world, ParallelMergeTag), PARALLEL_MERGE_COUNT);
+
+    int32_t i;
+    for (i = 0; i < PARALLEL_MERGE_COUNT; i ++) {
+        ecs_entity_t e = parallel_merge_entities[i];
+        test_assert(ecs_has(world, e, ParallelMergeTag));
+        test_bool(ecs_has(world, e, TagA), i % 2);
+    }
+
+    ecs_progress(world, 0);
+    test_int(ecs_count(world, ParallelMergeTag), PARALLEL_MERGE_COUNT);
+
+    ecs_fini(world);
+}
+
+#define CMD_QUEUE_PRODUCERS (4)
+#define CMD_QUEUE_PER_PRODUCER (256)
+
+typedef struct cmd_queue_producer_t {
+    ecs_cmd_queue_t *queue;
+    ecs_entity_t *entities;
+    ecs_entity_t component;
+    int32_t index;
+} cmd_queue_producer_t;
+
+static
+void* cmd_queue_produce(void *arg) {
+    cmd_queue_producer_t *p = arg;
+    int32_t i;
+    for (i = 0; i < CMD_QUEUE_PER_PRODUCER; i ++) {
+        ecs_entity_t e = p->entities[p->index * CMD_QUEUE_PER_PRODUCER + i];
+        Position v = { p->index, i };
+        while (!ecs_cmd_queue_set(p->queue, e, p->component, 
+            sizeof(Position), &v)) { }
+    }
+    return NULL;
+}
+
+static
+void cmd_queue_test_producers(int32_t capacity) {
+    ecs_world_t *world = ecs_init();
+
+    ECS_COMPONENT(world, Position);
+
+    const int32_t count = CMD_QUEUE_PRODUCERS * CMD_QUEUE_PER_PRODUCER;
+    ecs_entity_t entities[CMD_QUEUE_PRODUCERS * CMD_QUEUE_PER_PRODUCER];
+    int32_t i;
+    for (i = 0; i < count; i ++) {
+        entities[i] = ecs_new_id(world);
+    }
+
+    ecs_cmd_queue_t *q = ecs_cmd_queue_new(world, &(ecs_cmd_queue_desc_t){
+        .capacity = capacity
+    });
+
+    cmd_queue_producer_t producers[CMD_QUEUE_PRODUCERS];
+    ecs_os_thread_t threads[CMD_QUEUE_PRODUCERS];
+    for (i = 0; i < CMD_QUEUE_PRODUCERS; i ++) {
+        producers[i] = (cmd_queue_producer_t){ 
+            .queue = q, .entities = entities, 
+            .component = ecs_id(Position), .index = i };
+        threads[i] = ecs_os_thread_new(cmd_queue_produce, &producers[i]);
+    }
+
+    int32_t drained = 0;
+    while (drained != count) {
+        drained += ecs_cmd_queue_drain(world, q);
+    }
+
+    for (i = 0; i < CMD_QUEUE_PRODUCERS; i ++) {
+        ecs_os_thread_join(threads[i]);
+    }
+
+    test_int(ecs_cmd_queue_drain(world, q), 0);
+    test_int(ecs_count(world, Position), count);
+
+    for (i = 0; i < count; i ++) {
+        const Position *p = ecs_get(world, entities[i], Position);
+        test_assert(p != NULL);
+        test_int(p->x, i / CMD_QUEUE_PER_PRODUCER);
+        test_int(p->y, i % CMD_QUEUE_PER_PRODUCER);
+    }
+
+    ecs_cmd_queue_free(q);
+
+    ecs_fini(world);
+}
+
+void MultiThread_cmd_queue_multi_producer(void) {
+    cmd_queue_test_producers(0);
+}
+
+void MultiThread_cmd_queue_multi_producer_wrap(void) {
+    cmd_queue_test_producers(16);
+}
+
+void MultiThread_cmd_queue_drain_in_phase(void) {
+    ecs_world_t *world = ecs_init();
+
+    ECS_COMPONENT(world, Position);
+    ECS_TAG(world, Tag);
+
+    ecs_set_threads(world, 2);
+
+    ecs_entity_t e = ecs_new_id(world);
+
+    ecs_cmd_queue_t *q = ecs_cmd_queue_new(world, &(ecs_cmd_queue_desc_t){
+        .phase = EcsPreUpdate
+    });
+
+    test_bool(true, ecs_cmd_queue_add(q, e, Tag));
+    test_bool(true, ecs_cmd_queue_set(q, e, ecs_id(Position), 
+        sizeof(Position), &(Position){10, 20}));
+    test_assert(!ecs_has(world, e, Tag));
+
+    ecs_progress(world, 0);
+
+    test_assert(ecs_has(world, e, Tag));
+    const Position *p = ecs_get(world, e, Position);
+    test_assert(p != NULL);
+    test_int(p->x, 10);
+    test_int(p->y, 20);
+
+    test_bool(true, ecs_cmd_queue_remove(q, e, Tag));
+    ecs_progress(world, 0);
+    test_assert(!ecs_has(world, e, Tag));
+
+    ecs_cmd_queue_free(q);
+
+    ecs_fini(world);
+}
@@ -0,0 +1,523 @@
+#include <addons.h>
+
+typedef struct RecorderBuffer {
+    char *data;
+    ecs_size_t size;
+} RecorderBuffer;
+
+static
+void recorder_write(const void *data, ecs_size_t size, void *ctx) {
+    RecorderBuffer *buf = ctx;
+    buf->data = ecs_os_realloc(buf->data, buf->size + size);
+    ecs_os_memcpy(buf->data + buf->size, data, size);
+    buf->size += size;
+}
+
+static
+ecs_recorder_t* recorder_start(ecs_world_t *world, RecorderBuffer *buf) {
+    ecs_recorder_t *r = ecs_recorder_start(world, &(ecs_recorder_desc_t){
+        .callback = recorder_write,
+        .ctx = buf
+    });
+    test_assert(r != NULL);
+    return r;
+}
+
+void Recorder_record_add(void) {
+    RecorderBuffer buf = {0};
+    ecs_entity_t e;
+
+    {
+        ecs_world_t *world = ecs_mini();
+        ECS_TAG(world, TagA);
+
+        e = ecs_new_id(world);
+
+        ecs_recorder_t *r = recorder_start(world, &buf);
+        ecs_defer_begin(world);
+        ecs_add(world, e, TagA);
+        ecs_defer_end(world);
+        ecs_recorder_stop(r);
+
+        ecs_fini(world);
+    }
+
+    {
+        ecs_world_t *world = ecs_mini();
+        ECS_TAG(world, TagA);
+
+        test_int(ecs_replay(world, buf.data, buf.size), 0);
+        test_assert(ecs_is_alive(world, e));
+        test_assert(ecs_has(world, e, TagA));
+
+        ecs_fini(world);
+    }
+
+    ecs_os_free(buf.data);
+}
+
+void Recorder_record_remove(void) {
+    RecorderBuffer buf = {0};
+    ecs_entity_t e;
+
+    {
+        ecs_world_t *world = ecs_mini();
+        ECS_TAG(world, TagA);
+        ECS_TAG(world, TagB);
+
+        e = ecs_new_id(world);
+
+        ecs_recorder_t *r = recorder_start(world, &buf);
+        ecs_defer_begin(world);
+        ecs_add(world, e, TagA);
+        ecs_add(world, e, TagB);
+        ecs_defer_end(world);
+
+        ecs_defer_begin(world);
+        ecs_remove(world, e, TagA);
+        ecs_defer_end(world);
+        ecs_recorder_stop(r);
+
+        ecs_fini(world);
+    }
+
+    {
+        ecs_world_t *world = ecs_mini();
+        ECS_TAG(world, TagA);
+        ECS_TAG(world, TagB);
+
+        test_int(ecs_replay(world, buf.data, buf.size), 0);
+        test_assert(!ecs_has(world, e, TagA));
+        test_assert(ecs_has(world, e, TagB));
+
+        ecs_fini(world);
+    }
+
+    ecs_os_free(buf.data);
+}
+
+void Recorder_record_set(void) {
+    RecorderBuffer buf = {0};
+    ecs_entity_t e;
+
+    {
+        ecs_world_t *world = ecs_mini();
+        ECS_COMPONENT(world, Position);
+
+        e = ecs_new_id(world);
+
+        ecs_recorder_t *r = recorder_start(world, &buf);
+        ecs_defer_begin(world);
+        ecs_set(world, e, Position, {10, 20});
+        ecs_defer_end(world);
+
+        /* Set existing component, value is assigned in place */
+        ecs_defer_begin(world);
+        ecs_set(world, e, Position, {30, 40});
+        ecs_defer_end(world);
+        ecs_recorder_stop(r);
+
+        ecs_fini(world);
+    }
+
+    {
+        ecs_world_t *world = ecs_mini();
+        ECS_COMPONENT(world, Position);
+
+        ecs_replayer_t *rp = ecs_replayer_new(world, buf.data, buf.size);
+        test_assert(rp != NULL);
+
+        /* Both syncs were recorded outside of a frame */
+        test_int(ecs_replayer_next_frame(rp), 1);
+        test_int(ecs_replayer_next_frame(rp), 0);
+        ecs_replayer_free(rp);
+
+        const Position *p = ecs_get(world, e, Position);
+        test_assert(p != NULL);
+        test_int(p->x, 30);
+        test_int(p->y, 40);
+
+        ecs_fini(world);
+    }
+
+    ecs_os_free(buf.data);
+}
+
+void Recorder_record_delete(void) {
+    RecorderBuffer buf = {0};
+    ecs_entity_t e1, e2;
+
+    {
+        ecs_world_t *world = ecs_mini();
+        ECS_TAG(world, TagA);
+
+        e1 = ecs_new_id(world);
+        e2 = ecs_new_id(world);
+
+        ecs_recorder_t *r = recorder_start(world, &buf);
+        ecs_defer_begin(world);
+        ecs_add(world, e1, TagA);
+        ecs_add(world, e2, TagA);
+        ecs_defer_end(world);
+
+        ecs_defer_begin(world);
+        ecs_delete(world, e1);
+        ecs_defer_end(world);
+        ecs_recorder_stop(r);
+
+        ecs_fini(world);
+    }
+
+    {
+        ecs_world_t *world = ecs_mini();
+        ECS_TAG(world, TagA);
+
+        test_int(ecs_replay(world, buf.data, buf.size), 0);
+        test_assert(!ecs_is_alive(world, e1));
+        test_assert(ecs_is_alive(world, e2));
+        test_assert(ecs_has(world, e2, TagA));
+
+        ecs_fini(world);
+    }
+
+    ecs_os_free(buf.data);
+}
+
+void Recorder_record_pair(void) {
+    RecorderBuffer buf = {0};
+    ecs_entity_t e;
+
+    {
+        ecs_world_t *world = ecs_mini();
+        ECS_TAG(world, Likes);
+        ECS_TAG(world, Apples);
+
+        e = ecs_new_id(world);
+
+        ecs_recorder_t *r = recorder_start(world, &buf);
+        ecs_defer_begin(world);
+        ecs_add_pair(world, e, Likes, Apples);
+        ecs_defer_end(world);
+        ecs_recorder_stop(r);
+
+        ecs_fini(world);
+    }
+
+    {
+        ecs_world_t *world = ecs_mini();
+        ECS_TAG(world, Likes);
+        ECS_TAG(world, Apples);
+
+        test_int(ecs_replay(world, buf.data, buf.size), 0);
+        test_assert(ecs_has_pair(world, e, Likes, Apples));
+
+        ecs_fini(world);
+    }
+
+    ecs_os_free(buf.data);
+}
+
+void Recorder_record_different_component_ids(void) {
+    RecorderBuffer buf = {0};
+    ecs_entity_t e;
+
+    {
+        ecs_world_t *world = ecs_mini();
+        ECS_COMPONENT(world, Position);
+        ECS_COMPONENT(world, Velocity);
+
+        e = ecs_new_id(world);
+
+        ecs_recorder_t *r = recorder_start(world, &buf);
+        ecs_defer_begin(world);
+        ecs_set(world, e, Velocity, {1, 2});
+        ecs_defer_end(world);
+        ecs_recorder_stop(r);
+
+        ecs_fini(world);
+    }
+
+    {
+        ecs_world_t *world = ecs_mini();
+        /* Register in different order, so components have different ids */
+        ECS_COMPONENT(world, Velocity);
+        ECS_COMPONENT(world, Position);
+
+        test_int(ecs_replay(world, buf.data, buf.size), 0);
+        test_assert(!ecs_has(world, e, Position));
+
+        const Velocity *v = ecs_get(world, e, Velocity);
+        test_assert(v != NULL);
+        test_int(v->x, 1);
+        test_int(v->y, 2);
+
+        ecs_fini(world);
+    }
+
+    ecs_os_free(buf.data);
+}
+
+void Recorder_record_new_w_name(void) {
+    RecorderBuffer buf = {0};
+    ecs_entity_t parent, child;
+
+    {
+        ecs_world_t *world = ecs_mini();
+
+        parent = ecs_new_entity(world, "Parent");
+
+        ecs_recorder_t *r = recorder_start(world, &buf);
+        ecs_defer_begin(world);
+        child = ecs_entity(world, { .name = "Child" });
+        ecs_add_pair(world, child, EcsChildOf, parent);
+        ecs_defer_end(world);
+        ecs_recorder_stop(r);
+
+        test_str(ecs_get_name(world, child), "Child");
+
+        ecs_fini(world);
+    }
+
+    {
+        ecs_world_t *world = ecs_mini();
+        ecs_entity_t parent_2 = ecs_new_entity(world, "Parent");
+
+        test_int(ecs_replay(world, buf.data, buf.size), 0);
+        test_assert(ecs_is_alive(world, child));
+        test_str(ecs_get_name(world, child), "Child");
+        test_assert(ecs_has_pair(world, child, EcsChildOf, parent_2));
+        test_assert(ecs_lookup_fullpath(world, "Parent.Child") == child);
+
+        ecs_fini(world);
+    }
+
+    ecs_os_free(buf.data);
+}
+
+static
+void RecorderAddTagB(ecs_iter_t *it) {
+    ecs_id_t TagB = ecs_field_id(it, 2);
+    int i;
+    for (i = 0; i < it->count; i ++) {
+        ecs_add_id(it->world, it->entities[i], TagB);
+    }
+}
+
+void Recorder_record_observer_commands(void) {
+    RecorderBuffer buf = {0};
+    ecs_entity_t e;
+
+    {
+        ecs_world_t *world = ecs_mini();
+        ECS_TAG(world, TagA);
+        ECS_TAG(world, TagB);
+
+        ecs_observer(world, {
+            .filter.terms = {{ TagA }, { TagB, .oper = EcsNot }},
+            .events = { EcsOnAdd },
+            .callback = RecorderAddTagB
+        });
+
+        e = ecs_new_id(world);
+
+        ecs_recorder_t *r = recorder_start(world, &buf);
+        ecs_defer_begin(world);
+        ecs_add(world, e, TagA);
+        ecs_defer_end(world);
+        ecs_recorder_stop(r);
+
+        test_assert(ecs_has(world, e, TagB));
+
+        ecs_fini(world);
+    }
+
+    {
+        ecs_world_t *world = ecs_mini();
+        ECS_TAG(world, TagA);
+        ECS_TAG(world, TagB);
+
+        /* Commands from observer are not recorded, and are only reproduced if
+         * the observer exists in the replaying world. */
+        test_int(ecs_replay(world, buf.data, buf.size), 0);
+        test_assert(ecs_has(world, e, TagA));
+        test_assert(!ecs_has(world, e, TagB));
+
+        ecs_fini(world);
+    }
+
+    ecs_os_free(buf.data);
+}
+
+static ECS_COMPONENT_DECLARE(Position);
+static ECS_COMPONENT_DECLARE(Velocity);
+
+static
+void RecorderAddPosition(ecs_iter_t *it) {
+    Velocity *v = ecs_field(it, Velocity, 1);
+    int i;
+    for (i = 0; i < it->count; i ++) {
+        ecs_set(it->world, it->entities[i], Position, {v[i].x, v[i].y});
+    }
+}
+
+void Recorder_record_frames(void) {
+    RecorderBuffer buf = {0};
+    ecs_entity_t e[3];
+
+    {
+        ecs_world_t *world = ecs_init();
+        ECS_COMPONENT_DEFINE(world, Position);
+        ECS_COMPONENT_DEFINE(world, Velocity);
+
+        ecs_system(world, {
+            .entity = ecs_entity(world, {.add = {ecs_dependson(EcsOnUpdate)}}),
+            .query.filter.terms = {
+                { ecs_id(Velocity) }, { ecs_id(Position), .oper = EcsNot }
+            },
+            .callback = RecorderAddPosition
+        });
+
+        ecs_recorder_t *r = recorder_start(world, &buf);
+        int32_t i;
+        for (i = 0; i < 3; i ++) {
+            e[i] = ecs_new_id(world);
+            ecs_set(world, e[i], Velocity, {i, i});
+            ecs_progress(world, 0);
+        }
+        ecs_recorder_stop(r);
+
+        ecs_fini(world);
+    }
+
+    {
+        ecs_world_t *world = ecs_mini();
+        ECS_COMPONENT_DEFINE(world, Position);
+        ECS_COMPONENT_DEFINE(world, Velocity);
+
+        ecs_replayer_t *rp = ecs_replayer_new(world, buf.data, buf.size);
+        test_assert(rp != NULL);
+
+        int32_t i;
+        for (i = 0; i < 3; i ++) {
+            test_int(ecs_replayer_next_frame(rp), 1);
+            test_assert(ecs_has(world, e[i], Position));
+            if (i < 2) {
+                test_assert(!ecs_is_alive(world, e[i + 1]));
+            }
+
+            const Position *p = ecs_get(world, e[i], Position);
+            test_int(p->x, i);
+            test_int(p->y, i);
+        }
+
+        test_int(ecs_replayer_next_frame(rp), 0);
+        ecs_replayer_free(rp);
+
+        ecs_fini(world);
+    }
+
+    ecs_os_free(buf.data);
+}
+
+void Recorder_record_file(void) {
+    const char *filename = "recorder_test.bin";
+    ecs_entity_t e;
+
+    {
+        ecs_world_t *world = ecs_mini();
+        ECS_COMPONENT(world, Position);
+
+        e = ecs_new_id(world);
+
+        ecs_recorder_t *r = ecs_recorder_start(world, &(ecs_recorder_desc_t){
+            .filename = filename
+        });
+        test_assert(r != NULL);
+        ecs_defer_begin(world);
+        ecs_set(world, e, Position, {10, 20});
+        ecs_defer_end(world);
+        ecs_recorder_stop(r);
+
+        ecs_fini(world);
+    }
+
+    {
+        ecs_world_t *world = ecs_mini();
+        ECS_COMPONENT(world, Position);
+
+        ecs_replayer_t *rp = ecs_replayer_from_file(world, filename);
+        test_assert(rp != NULL);
+        test_int(ecs_replayer_next_frame(rp), 1);
+        test_int(ecs_replayer_next_frame(rp), 0);
+        ecs_replayer_free(rp);
+
+        const Position *p = ecs_get(world, e, Position);
+        test_assert(p != NULL);
+        test_int(p->x, 10);
+        test_int(p->y, 20);
+
+        ecs_fini(world);
+    }
+
+    remove(filename);
+}
+
+typedef struct RecorderName {
+    char *value;
+} RecorderName;
+
+void Recorder_record_value_w_hooks(void) {
+    RecorderBuffer buf = {0};
+    ecs_entity_t e;
+
+    {
+        ecs_world_t *world = ecs_init();
+        ECS_COMPONENT(world, RecorderName);
+
+        ecs_struct(world, {
+            .entity = ecs_id(RecorderName),
+            .members = {{ "value", ecs_id(ecs_string_t) }}
+        });
+
+        e = ecs_new_id(world);
+
+        ecs_recorder_t *r = recorder_start(world, &buf);
+        ecs_defer_begin(world);
+        ecs_set(world, e, RecorderName, {"Hello"});
+        ecs_defer_end(world);
+        ecs_recorder_stop(r);
+
+        ecs_fini(world);
+    }
+
+    {
+        ecs_world_t *world = ecs_init();
+        ECS_COMPONENT(world, RecorderName);
+
+        ecs_struct(world, {
+            .entity = ecs_id(RecorderName),
+            .members = {{ "value", ecs_id(ecs_string_t) }}
+        });
+
+        test_int(ecs_replay(world, buf.data, buf.size), 0);
+
+        const RecorderName *n = ecs_get(world, e, RecorderName);
+        test_assert(n != NULL);
+        test_str(n->value, "Hello");
+
+        ecs_fini(world);
+    }
+
+    ecs_os_free(buf.data);
+}
+
+void Recorder_replay_invalid(void) {
+    ecs_world_t *world = ecs_mini();
+
+    ecs_log_set_level(-4);
+    const char data[] = "not a recording";
+    test_assert(ecs_replayer_new(world, data, ECS_SIZEOF(data)) == NULL);
+    test_assert(ecs_replay(world, data, ECS_SIZEOF(data)) != 0);
+
+    ecs_fini(world);
+}
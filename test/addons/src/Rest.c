@@ -463,3 +463,54 @@ void Rest_request_commands_garbage_collect(void) {
 
     ecs_fini(world);
 }
+
+void Rest_query_profile(void) {
+    ecs_world_t *world = ecs_init();
+
+    ecs_http_server_t *srv = ecs_rest_server_init(world, NULL);
+    test_assert(srv != NULL);
+
+    ECS_COMPONENT(world, Position);
+
+    ecs_entity_t e = ecs_new_entity(world, "e");
+    ecs_set(world, e, Position, {10, 20});
+
+    ecs_http_reply_t reply = ECS_HTTP_REPLY_INIT;
+    test_int(0, ecs_http_server_request(srv, "GET",
+        "/query?q=Position&query_profile=true&results=false", &reply));
+    test_int(reply.code, 200);
+    
+    char *reply_str = ecs_strbuf_get(&reply.body);
+    test_assert(reply_str != NULL);
+    test_assert(strstr(reply_str, "\"query_profile\":{") != NULL);
+    test_assert(strstr(reply_str, "\"ops\":[{\"enter\":") != NULL);
+    test_assert(strstr(reply_str, "\"time_us\":") != NULL);
+    ecs_os_free(reply_str);
+
+    ecs_rest_server_fini(srv);
+
+    ecs_fini(world);
+}
+
+void Rest_request_stats_allocators(void) {
+    ecs_world_t *world = ecs_init();
+
+    ecs_http_server_t *srv = ecs_rest_server_init(world, NULL);
+    test_assert(srv != NULL);
+
+    ecs_http_reply_t reply = ECS_HTTP_REPLY_INIT;
+    test_int(0, ecs_http_server_request(srv, "GET",
+        "/stats/allocators", &reply));
+    test_int(reply.code, 200);
+
+    char *reply_str = ecs_strbuf_get(&reply.body);
+    test_assert(reply_str != NULL);
+    test_assert(strstr(reply_str, "\"bytes_reserved\":") != NULL);
+    test_assert(strstr(reply_str, "\"sizes\":[{\"size\":") != NULL);
+    test_assert(strstr(reply_str, "\"chunk_count_max\":") != NULL);
+    ecs_os_free(reply_str);
+
+    ecs_rest_server_fini(srv);
+
+    ecs_fini(world);
+}
@@ -7694,3 +7694,506 @@ void RulesBasic_2_trivial_mixed_2_tables_wildcard(void) {
 
     ecs_fini(world);
 }
+
+void RulesBasic_planned_by_cardinality(void) {
+    ecs_world_t *world = ecs_mini();
+
+    ECS_TAG(world, Foo);
+    ECS_TAG(world, Bar);
+
+    int i;
+    for (i = 0; i < 100; i ++) {
+        ecs_entity_t e = ecs_new(world, Foo);
+        ecs_add_id(world, e, ecs_new_id(world));
+    }
+
+    ecs_entity_t e = ecs_new(world, Foo);
+    ecs_add(world, e, Bar);
+
+    ecs_rule_t *r = ecs_rule(world, {
+        .expr = "Foo($x), Bar($x)"
+    });
+
+    ecs_log_enable_colors(false);
+
+    const char *expect = 
+    HEAD " 0. [-1,  1]  setids      "
+    LINE " 1. [ 0,  2]  selfupid    $[x]              (Bar)"
+    LINE " 2. [ 1,  3]  selfupid    $[x]              (Foo)"
+    LINE " 3. [ 2,  4]  each        $x                ($[x])"
+    LINE " 4. [ 3,  5]  setvars     "
+    LINE " 5. [ 4,  6]  yield       "
+    LINE "";
+    char *plan = ecs_rule_str(r);
+
+    test_str(expect, plan);
+    ecs_os_free(plan);
+
+    int x_var = ecs_rule_find_var(r, "x");
+    test_assert(x_var != -1);
+
+    ecs_iter_t it = ecs_rule_iter(world, r);
+    test_bool(true, ecs_rule_next(&it));
+    test_uint(e, ecs_iter_get_var(&it, x_var));
+    test_uint(Foo, ecs_field_id(&it, 1));
+    test_uint(Bar, ecs_field_id(&it, 2));
+    test_bool(false, ecs_rule_next(&it));
+
+    ecs_rule_fini(r);
+
+    ecs_fini(world);
+}
+
+void RulesBasic_replan_after_cardinality_change(void) {
+    ecs_world_t *world = ecs_mini();
+
+    ECS_TAG(world, Foo);
+    ECS_TAG(world, Bar);
+
+    ecs_rule_t *r = ecs_rule(world, {
+        .expr = "Foo($x), Bar($x)"
+    });
+
+    ecs_log_enable_colors(false);
+
+    const char *expect = 
+    HEAD " 0. [-1,  1]  setids      "
+    LINE " 1. [ 0,  2]  selfupid    $[x]              (Foo)"
+    LINE " 2. [ 1,  3]  selfupid    $[x]              (Bar)"
+    LINE " 3. [ 2,  4]  each        $x                ($[x])"
+    LINE " 4. [ 3,  5]  setvars     "
+    LINE " 5. [ 4,  6]  yield       "
+    LINE "";
+    char *plan = ecs_rule_str(r);
+    test_str(expect, plan);
+    ecs_os_free(plan);
+
+    int i;
+    for (i = 0; i < 100; i ++) {
+        ecs_entity_t e = ecs_new(world, Foo);
+        ecs_add_id(world, e, ecs_new_id(world));
+    }
+
+    ecs_entity_t e = ecs_new(world, Foo);
+    ecs_add(world, e, Bar);
+
+    int x_var = ecs_rule_find_var(r, "x");
+    test_assert(x_var != -1);
+
+    ecs_iter_t it = ecs_rule_iter(world, r);
+    test_bool(true, ecs_rule_next(&it));
+    test_uint(e, ecs_iter_get_var(&it, x_var));
+    test_uint(Foo, ecs_field_id(&it, 1));
+    test_uint(Bar, ecs_field_id(&it, 2));
+    test_bool(false, ecs_rule_next(&it));
+
+    expect = 
+    HEAD " 0. [-1,  1]  setids      "
+    LINE " 1. [ 0,  2]  selfupid    $[x]              (Bar)"
+    LINE " 2. [ 1,  3]  selfupid    $[x]              (Foo)"
+    LINE " 3. [ 2,  4]  each        $x                ($[x])"
+    LINE " 4. [ 3,  5]  setvars     "
+    LINE " 5. [ 4,  6]  yield       "
+    LINE "";
+    plan = ecs_rule_str(r);
+    test_str(expect, plan);
+    ecs_os_free(plan);
+
+    ecs_rule_fini(r);
+
+    ecs_fini(world);
+}
+
+void RulesBasic_no_replan_while_iterating(void) {
+    ecs_world_t *world = ecs_mini();
+
+    ECS_TAG(world, Foo);
+    ECS_TAG(world, Bar);
+
+    ecs_rule_t *r = ecs_rule(world, {
+        .expr = "Foo($x), Bar($x)"
+    });
+
+    ecs_log_enable_colors(false);
+
+    ecs_entity_t e = ecs_new(world, Foo);
+    ecs_add(world, e, Bar);
+
+    int x_var = ecs_rule_find_var(r, "x");
+    test_assert(x_var != -1);
+
+    ecs_iter_t it_1 = ecs_rule_iter(world, r);
+
+    int i;
+    for (i = 0; i < 100; i ++) {
+        ecs_entity_t f = ecs_new(world, Foo);
+        ecs_add_id(world, f, ecs_new_id(world));
+    }
+
+    /* Rule is still being iterated, plan should not change */
+    ecs_iter_t it_2 = ecs_rule_iter(world, r);
+    test_bool(true, ecs_rule_next(&it_2));
+    test_uint(e, ecs_iter_get_var(&it_2, x_var));
+    test_bool(false, ecs_rule_next(&it_2));
+
+    const char *expect = 
+    HEAD " 0. [-1,  1]  setids      "
+    LINE " 1. [ 0,  2]  selfupid    $[x]              (Foo)"
+    LINE " 2. [ 1,  3]  selfupid    $[x]              (Bar)"
+    LINE " 3. [ 2,  4]  each        $x                ($[x])"
+    LINE " 4. [ 3,  5]  setvars     "
+    LINE " 5. [ 4,  6]  yield       "
+    LINE "";
+    char *plan = ecs_rule_str(r);
+    test_str(expect, plan);
+    ecs_os_free(plan);
+
+    test_bool(true, ecs_rule_next(&it_1));
+    test_uint(e, ecs_iter_get_var(&it_1, x_var));
+    test_bool(false, ecs_rule_next(&it_1));
+
+    /* Iterators are done, rule can be replanned */
+    ecs_iter_t it_3 = ecs_rule_iter(world, r);
+    test_bool(true, ecs_rule_next(&it_3));
+    test_uint(e, ecs_iter_get_var(&it_3, x_var));
+    test_bool(false, ecs_rule_next(&it_3));
+
+    expect = 
+    HEAD " 0. [-1,  1]  setids      "
+    LINE " 1. [ 0,  2]  selfupid    $[x]              (Bar)"
+    LINE " 2. [ 1,  3]  selfupid    $[x]              (Foo)"
+    LINE " 3. [ 2,  4]  each        $x                ($[x])"
+    LINE " 4. [ 3,  5]  setvars     "
+    LINE " 5. [ 4,  6]  yield       "
+    LINE "";
+    plan = ecs_rule_str(r);
+    test_str(expect, plan);
+    ecs_os_free(plan);
+
+    ecs_rule_fini(r);
+
+    ecs_fini(world);
+}
+
+void RulesBasic_profile(void) {
+    ecs_world_t *world = ecs_mini();
+
+    ECS_TAG(world, Foo);
+    ECS_TAG(world, Bar);
+    ECS_TAG(world, Hello);
+
+    ecs_entity_t e1 = ecs_new(world, Foo);
+    ecs_add(world, e1, Bar);
+    ecs_entity_t e2 = ecs_new(world, Foo);
+    ecs_add(world, e2, Bar);
+    ecs_add(world, e2, Hello);
+    ecs_new(world, Foo);
+
+    ecs_rule_t *r = ecs_rule(world, {
+        .expr = "Foo, Bar"
+    });
+
+    test_assert(r != NULL);
+
+    ecs_rule_profile_t profile = ecs_rule_get_profile(r);
+    test_assert(profile.ops == NULL);
+    test_int(profile.op_count, 0);
+    test_int(profile.iter_count, 0);
+
+    ecs_iter_t it = ecs_rule_iter(world, r);
+    it.flags |= EcsIterProfile;
+    int32_t count = 0;
+    while (ecs_rule_next(&it)) {
+        count ++;
+    }
+    test_int(count, 2);
+
+    profile = ecs_rule_get_profile(r);
+    test_assert(profile.ops != NULL);
+    test_assert(profile.op_count > 1);
+    test_int(profile.iter_count, 1);
+
+    /* Last operation is yield, which is never evaluated */
+    const ecs_rule_op_profile_t *last = &profile.ops[profile.op_count - 1];
+    test_int(last->count[0], 0);
+    test_int(last->count[1], 0);
+
+    /* Bar is evaluated for each of the three tables with Foo */
+    const ecs_rule_op_profile_t *op = &profile.ops[profile.op_count - 2];
+    test_int(op->count[0], 3);
+    test_int(op->count[1], 2);
+    test_int(op->match_count, 2);
+    test_assert(op->time_spent >= 0);
+
+    char *str = ecs_rule_str_w_profile(r, NULL);
+    test_assert(str != NULL);
+    ecs_os_free(str);
+
+    ecs_rule_fini(r);
+
+    ecs_fini(world);
+}
+
+void RulesBasic_profile_accumulate(void) {
+    ecs_world_t *world = ecs_mini();
+
+    ECS_TAG(world, Foo);
+    ECS_TAG(world, Bar);
+
+    ecs_entity_t e1 = ecs_new(world, Foo);
+    ecs_add(world, e1, Bar);
+
+    ecs_rule_t *r = ecs_rule(world, {
+        .expr = "Foo, Bar"
+    });
+
+    test_assert(r != NULL);
+
+    for (int i = 0; i < 3; i ++) {
+        ecs_iter_t it = ecs_rule_iter(world, r);
+        it.flags |= EcsIterProfile;
+        test_bool(true, ecs_rule_next(&it));
+        test_bool(false, ecs_rule_next(&it));
+    }
+
+    /* Iterator without profile flag isn't added to profile */
+    ecs_iter_t it = ecs_rule_iter(world, r);
+    test_bool(true, ecs_rule_next(&it));
+    test_bool(false, ecs_rule_next(&it));
+
+    ecs_rule_profile_t profile = ecs_rule_get_profile(r);
+    test_assert(profile.ops != NULL);
+    test_int(profile.iter_count, 3);
+
+    const ecs_rule_op_profile_t *op = &profile.ops[profile.op_count - 2];
+    test_int(op->count[0], 3);
+    test_int(op->count[1], 3);
+    test_int(op->match_count, 3);
+
+    ecs_rule_reset_profile(r);
+
+    profile = ecs_rule_get_profile(r);
+    test_assert(profile.ops == NULL);
+    test_int(profile.op_count, 0);
+    test_int(profile.iter_count, 0);
+
+    ecs_rule_fini(r);
+
+    ecs_fini(world);
+}
+
+void RulesBasic_profile_iter_fini(void) {
+    ecs_world_t *world = ecs_mini();
+
+    ECS_TAG(world, Foo);
+
+    ecs_new(world, Foo);
+    ecs_new(world, Foo);
+
+    ecs_rule_t *r = ecs_rule(world, {
+        .expr = "Foo($x)"
+    });
+
+    test_assert(r != NULL);
+
+    ecs_iter_t it = ecs_rule_iter(world, r);
+    it.flags |= EcsIterProfile;
+    test_bool(true, ecs_rule_next(&it));
+    ecs_iter_fini(&it);
+
+    ecs_rule_profile_t profile = ecs_rule_get_profile(r);
+    test_assert(profile.ops != NULL);
+    test_int(profile.iter_count, 1);
+
+    const ecs_rule_op_profile_t *op = &profile.ops[profile.op_count - 2];
+    test_int(op->count[0], 1);
+    test_int(op->count[1], 0);
+    test_int(op->match_count, 1);
+
+    ecs_rule_fini(r);
+
+    ecs_fini(world);
+}
+
+void RulesBasic_fused_with_ids_plan(void) {
+    ecs_world_t *world = ecs_mini();
+
+    ECS_TAG(world, Foo);
+    ECS_TAG(world, Bar);
+    ECS_TAG(world, Hello);
+
+    ecs_rule_t *r = ecs_rule(world, {
+        .expr = "ChildOf($this, $p), Foo(self), Bar(self), Hello(self)"
+    });
+
+    ecs_log_enable_colors(false);
+
+    const char *expect = 
+    HEAD " 0. [-1,  1]  setids      "
+    LINE " 1. [ 0,  2]  and         $[this]           (ChildOf, $p)"
+    LINE " 2. [ 1,  5]  withids     $[this]           (Foo)"
+    LINE " 3. [ 2,  4]  andid       $[this]           (Bar)"
+    LINE " 4. [ 3,  5]  andid       $[this]           (Hello)"
+    LINE " 5. [ 2,  6]  yield       "
+    LINE "";
+    char *plan = ecs_rule_str(r);
+
+    test_str(expect, plan);
+    ecs_os_free(plan);
+
+    ecs_rule_fini(r);
+
+    ecs_fini(world);
+}
+
+void RulesBasic_fused_self_up_with_ids_plan(void) {
+    ecs_world_t *world = ecs_mini();
+
+    ECS_TAG(world, Foo);
+    ECS_TAG(world, Bar);
+
+    ecs_rule_t *r = ecs_rule(world, {
+        .expr = "ChildOf($this, $p), Foo, Bar"
+    });
+
+    ecs_log_enable_colors(false);
+
+    const char *expect = 
+    HEAD " 0. [-1,  1]  setids      "
+    LINE " 1. [ 0,  2]  and         $[this]           (ChildOf, $p)"
+    LINE " 2. [ 1,  4]  supwids     $[this]           (Foo)"
+    LINE " 3. [ 2,  4]  selfupid    $[this]           (Bar)"
+    LINE " 4. [ 2,  5]  yield       "
+    LINE "";
+    char *plan = ecs_rule_str(r);
+
+    test_str(expect, plan);
+    ecs_os_free(plan);
+
+    ecs_rule_fini(r);
+
+    ecs_fini(world);
+}
+
+void RulesBasic_fused_with_ids(void) {
+    ecs_world_t *world = ecs_mini();
+
+    ECS_COMPONENT(world, Position);
+    ECS_COMPONENT(world, Velocity);
+    ECS_TAG(world, Foo);
+
+    ecs_entity_t parent = ecs_new_id(world);
+    ecs_entity_t e1 = ecs_new_w_pair(world, EcsChildOf, parent);
+    ecs_entity_t e2 = ecs_new_w_pair(world, EcsChildOf, parent);
+    ecs_entity_t e3 = ecs_new_w_pair(world, EcsChildOf, parent);
+    ecs_set(world, e1, Position, {10, 20});
+    ecs_set(world, e1, Velocity, {1, 2});
+    ecs_set(world, e2, Position, {30, 40});
+    ecs_add(world, e2, Foo);
+    ecs_set(world, e3, Position, {50, 60});
+    ecs_set(world, e3, Velocity, {3, 4});
+    ecs_add(world, e3, Foo);
+
+    ecs_rule_t *r = ecs_rule(world, {
+        .expr = "ChildOf($this, $p), Position(self), Velocity(self)"
+    });
+
+    test_assert(r != NULL);
+
+    int32_t p_var = ecs_rule_find_var(r, "p");
+    test_assert(p_var != -1);
+
+    ecs_iter_t it = ecs_rule_iter(world, r);
+    test_bool(true, ecs_rule_next(&it));
+    test_int(1, it.count);
+    test_uint(e1, it.entities[0]);
+    test_uint(ecs_childof(parent), ecs_field_id(&it, 1));
+    test_uint(ecs_id(Position), ecs_field_id(&it, 2));
+    test_uint(ecs_id(Velocity), ecs_field_id(&it, 3));
+    test_uint(parent, ecs_iter_get_var(&it, p_var));
+    {
+        Position *p = ecs_field(&it, Position, 2);
+        Velocity *v = ecs_field(&it, Velocity, 3);
+        test_int(p[0].x, 10); test_int(p[0].y, 20);
+        test_int(v[0].x, 1); test_int(v[0].y, 2);
+    }
+
+    test_bool(true, ecs_rule_next(&it));
+    test_int(1, it.count);
+    test_uint(e3, it.entities[0]);
+    test_uint(ecs_childof(parent), ecs_field_id(&it, 1));
+    test_uint(ecs_id(Position), ecs_field_id(&it, 2));
+    test_uint(ecs_id(Velocity), ecs_field_id(&it, 3));
+    test_uint(parent, ecs_iter_get_var(&it, p_var));
+    {
+        Position *p = ecs_field(&it, Position, 2);
+        Velocity *v = ecs_field(&it, Velocity, 3);
+        test_int(p[0].x, 50); test_int(p[0].y, 60);
+        test_int(v[0].x, 3); test_int(v[0].y, 4);
+    }
+
+    test_bool(false, ecs_rule_next(&it));
+
+    ecs_rule_fini(r);
+
+    ecs_fini(world);
+}
+
+void RulesBasic_fused_self_up_with_ids(void) {
+    ecs_world_t *world = ecs_mini();
+
+    ECS_COMPONENT(world, Position);
+    ECS_COMPONENT(world, Velocity);
+
+    ecs_entity_t parent = ecs_new_id(world);
+    ecs_entity_t base = ecs_set(world, 0, Velocity, {1, 2});
+    ecs_entity_t e1 = ecs_new_w_pair(world, EcsChildOf, parent);
+    ecs_entity_t e2 = ecs_new_w_pair(world, EcsChildOf, parent);
+    ecs_entity_t e3 = ecs_new_w_pair(world, EcsChildOf, parent);
+    ecs_set(world, e1, Position, {10, 20});
+    ecs_add_pair(world, e1, EcsIsA, base);
+    ecs_set(world, e2, Position, {30, 40});
+    ecs_set(world, e3, Position, {50, 60});
+    ecs_set(world, e3, Velocity, {3, 4});
+
+    ecs_rule_t *r = ecs_rule(world, {
+        .expr = "ChildOf($this, $p), Position, Velocity"
+    });
+
+    test_assert(r != NULL);
+
+    ecs_iter_t it = ecs_rule_iter(world, r);
+    test_bool(true, ecs_rule_next(&it));
+    test_int(1, it.count);
+    test_uint(e1, it.entities[0]);
+    test_uint(ecs_id(Position), ecs_field_id(&it, 2));
+    test_uint(ecs_id(Velocity), ecs_field_id(&it, 3));
+    test_uint(0, ecs_field_src(&it, 2));
+    test_uint(base, ecs_field_src(&it, 3));
+    {
+        Position *p = ecs_field(&it, Position, 2);
+        Velocity *v = ecs_field(&it, Velocity, 3);
+        test_int(p[0].x, 10); test_int(p[0].y, 20);
+        test_int(v[0].x, 1); test_int(v[0].y, 2);
+    }
+
+    test_bool(true, ecs_rule_next(&it));
+    test_int(1, it.count);
+    test_uint(e3, it.entities[0]);
+    test_uint(ecs_id(Position), ecs_field_id(&it, 2));
+    test_uint(ecs_id(Velocity), ecs_field_id(&it, 3));
+    test_uint(0, ecs_field_src(&it, 2));
+    test_uint(0, ecs_field_src(&it, 3));
+    {
+        Position *p = ecs_field(&it, Position, 2);
+        Velocity *v = ecs_field(&it, Velocity, 3);
+        test_int(p[0].x, 50); test_int(p[0].y, 60);
+        test_int(v[0].x, 3); test_int(v[0].y, 4);
+    }
+
+    test_bool(false, ecs_rule_next(&it));
+
+    ecs_rule_fini(r);
+
+    ecs_fini(world);
+}
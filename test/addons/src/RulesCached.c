@@ -0,0 +1,876 @@
+#include <addons.h>
+
+void RulesCached_1_term(void) {
+    ecs_world_t *world = ecs_mini();
+
+    ECS_COMPONENT(world, Position);
+
+    ecs_entity_t e1 = ecs_set(world, 0, Position, {10, 20});
+    ecs_entity_t e2 = ecs_set(world, 0, Position, {30, 40});
+
+    ecs_rule_t *r = ecs_rule(world, {
+        .terms = {{ ecs_id(Position) }},
+        .flags = EcsFilterCacheResults
+    });
+    test_assert(r != NULL);
+
+    for (int i = 0; i < 2; i ++) {
+        ecs_iter_t it = ecs_rule_iter(world, r);
+        test_bool(true, ecs_rule_next(&it));
+        test_assert(it.flags & EcsIterCached);
+        test_int(2, it.count);
+        test_uint(e1, it.entities[0]);
+        test_uint(e2, it.entities[1]);
+        test_uint(ecs_id(Position), ecs_field_id(&it, 1));
+        test_uint(0, ecs_field_src(&it, 1));
+        Position *p = ecs_field(&it, Position, 1);
+        test_assert(p != NULL);
+        test_int(10, p[0].x); test_int(20, p[0].y);
+        test_int(30, p[1].x); test_int(40, p[1].y);
+        test_bool(false, ecs_rule_next(&it));
+    }
+
+    ecs_rule_fini(r);
+
+    ecs_fini(world);
+}
+
+void RulesCached_2_terms(void) {
+    ecs_world_t *world = ecs_mini();
+
+    ECS_COMPONENT(world, Position);
+    ECS_COMPONENT(world, Velocity);
+    ECS_TAG(world, Foo);
+
+    ecs_entity_t e1 = ecs_set(world, 0, Position, {10, 20});
+    ecs_set(world, e1, Velocity, {1, 2});
+    ecs_entity_t e2 = ecs_set(world, 0, Position, {30, 40});
+    ecs_set(world, e2, Velocity, {3, 4});
+    ecs_add(world, e2, Foo);
+    ecs_set(world, 0, Position, {50, 60});
+
+    ecs_rule_t *r = ecs_rule(world, {
+        .expr = "Position, Velocity",
+        .flags = EcsFilterCacheResults
+    });
+    test_assert(r != NULL);
+
+    for (int i = 0; i < 2; i ++) {
+        ecs_iter_t it = ecs_rule_iter(world, r);
+        test_bool(true, ecs_rule_next(&it));
+        test_int(1, it.count);
+        test_uint(e1, it.entities[0]);
+        Position *p = ecs_field(&it, Position, 1);
+        Velocity *v = ecs_field(&it, Velocity, 2);
+        test_int(10, p[0].x); test_int(1, v[0].x);
+
+        test_bool(true, ecs_rule_next(&it));
+        test_int(1, it.count);
+        test_uint(e2, it.entities[0]);
+        p = ecs_field(&it, Position, 1);
+        v = ecs_field(&it, Velocity, 2);
+        test_int(30, p[0].x); test_int(3, v[0].x);
+        test_bool(false, ecs_rule_next(&it));
+    }
+
+    ecs_rule_fini(r);
+
+    ecs_fini(world);
+}
+
+void RulesCached_add_to_matched_table(void) {
+    ecs_world_t *world = ecs_mini();
+
+    ECS_COMPONENT(world, Position);
+
+    ecs_entity_t e1 = ecs_set(world, 0, Position, {10, 20});
+
+    ecs_rule_t *r = ecs_rule(world, {
+        .expr = "Position",
+        .flags = EcsFilterCacheResults
+    });
+    test_assert(r != NULL);
+
+    {
+        ecs_iter_t it = ecs_rule_iter(world, r);
+        test_bool(true, ecs_rule_next(&it));
+        test_int(1, it.count);
+        test_uint(e1, it.entities[0]);
+        test_bool(false, ecs_rule_next(&it));
+    }
+
+    ecs_entity_t e2 = ecs_set(world, 0, Position, {30, 40});
+
+    {
+        ecs_iter_t it = ecs_rule_iter(world, r);
+        test_bool(true, ecs_rule_next(&it));
+        test_int(2, it.count);
+        test_uint(e1, it.entities[0]);
+        test_uint(e2, it.entities[1]);
+        Position *p = ecs_field(&it, Position, 1);
+        test_int(10, p[0].x);
+        test_int(30, p[1].x);
+        test_bool(false, ecs_rule_next(&it));
+    }
+
+    ecs_delete(world, e1);
+
+    {
+        ecs_iter_t it = ecs_rule_iter(world, r);
+        test_bool(true, ecs_rule_next(&it));
+        test_int(1, it.count);
+        test_uint(e2, it.entities[0]);
+        Position *p = ecs_field(&it, Position, 1);
+        test_int(30, p[0].x);
+        test_bool(false, ecs_rule_next(&it));
+    }
+
+    ecs_rule_fini(r);
+
+    ecs_fini(world);
+}
+
+void RulesCached_new_table(void) {
+    ecs_world_t *world = ecs_mini();
+
+    ECS_COMPONENT(world, Position);
+    ECS_COMPONENT(world, Velocity);
+    ECS_TAG(world, Foo);
+
+    ecs_entity_t e1 = ecs_set(world, 0, Position, {10, 20});
+    ecs_set(world, e1, Velocity, {1, 2});
+
+    ecs_rule_t *r = ecs_rule(world, {
+        .expr = "Position, Velocity",
+        .flags = EcsFilterCacheResults
+    });
+    test_assert(r != NULL);
+
+    {
+        ecs_iter_t it = ecs_rule_iter(world, r);
+        test_bool(true, ecs_rule_next(&it));
+        test_int(1, it.count);
+        test_uint(e1, it.entities[0]);
+        test_bool(false, ecs_rule_next(&it));
+    }
+
+    ecs_entity_t e2 = ecs_set(world, 0, Position, {30, 40});
+    ecs_add(world, e2, Foo);
+    ecs_set(world, e2, Velocity, {3, 4});
+
+    {
+        ecs_iter_t it = ecs_rule_iter(world, r);
+        test_bool(true, ecs_rule_next(&it));
+        test_assert(it.flags & EcsIterCached);
+        test_int(1, it.count);
+        test_uint(e1, it.entities[0]);
+        test_bool(true, ecs_rule_next(&it));
+        test_int(1, it.count);
+        test_uint(e2, it.entities[0]);
+        Position *p = ecs_field(&it, Position, 1);
+        Velocity *v = ecs_field(&it, Velocity, 2);
+        test_int(30, p[0].x); test_int(3, v[0].x);
+        test_bool(false, ecs_rule_next(&it));
+    }
+
+    ecs_rule_fini(r);
+
+    ecs_fini(world);
+}
+
+void RulesCached_empty_table(void) {
+    ecs_world_t *world = ecs_mini();
+
+    ECS_COMPONENT(world, Position);
+    ECS_TAG(world, Foo);
+
+    ecs_entity_t e1 = ecs_set(world, 0, Position, {10, 20});
+    ecs_entity_t e2 = ecs_set(world, 0, Position, {30, 40});
+    ecs_add(world, e2, Foo);
+
+    ecs_rule_t *r = ecs_rule(world, {
+        .expr = "Position",
+        .flags = EcsFilterCacheResults
+    });
+    test_assert(r != NULL);
+
+    {
+        ecs_iter_t it = ecs_rule_iter(world, r);
+        test_bool(true, ecs_rule_next(&it));
+        test_uint(e1, it.entities[0]);
+        test_bool(true, ecs_rule_next(&it));
+        test_uint(e2, it.entities[0]);
+        test_bool(false, ecs_rule_next(&it));
+    }
+
+    ecs_remove(world, e2, Foo);
+
+    {
+        ecs_iter_t it = ecs_rule_iter(world, r);
+        test_bool(true, ecs_rule_next(&it));
+        test_int(2, it.count);
+        test_uint(e1, it.entities[0]);
+        test_uint(e2, it.entities[1]);
+        test_bool(false, ecs_rule_next(&it));
+    }
+
+    ecs_add(world, e1, Foo);
+
+    {
+        ecs_iter_t it = ecs_rule_iter(world, r);
+        test_bool(true, ecs_rule_next(&it));
+        test_int(1, it.count);
+        test_uint(e2, it.entities[0]);
+        test_bool(true, ecs_rule_next(&it));
+        test_int(1, it.count);
+        test_uint(e1, it.entities[0]);
+        test_bool(false, ecs_rule_next(&it));
+    }
+
+    ecs_rule_fini(r);
+
+    ecs_fini(world);
+}
+
+void RulesCached_delete_table(void) {
+    ecs_world_t *world = ecs_mini();
+
+    ECS_COMPONENT(world, Position);
+    ECS_TAG(world, Foo);
+
+    ecs_entity_t e1 = ecs_set(world, 0, Position, {10, 20});
+    ecs_entity_t e2 = ecs_set(world, 0, Position, {30, 40});
+    ecs_add(world, e2, Foo);
+
+    ecs_rule_t *r = ecs_rule(world, {
+        .expr = "Position",
+        .flags = EcsFilterCacheResults
+    });
+    test_assert(r != NULL);
+
+    {
+        ecs_iter_t it = ecs_rule_iter(world, r);
+        test_bool(true, ecs_rule_next(&it));
+        test_uint(e1, it.entities[0]);
+        test_bool(true, ecs_rule_next(&it));
+        test_uint(e2, it.entities[0]);
+        test_bool(false, ecs_rule_next(&it));
+    }
+
+    ecs_delete(world, e2);
+    ecs_delete_empty_tables(world, 0, 0, 1, 0, 0);
+    test_assert(ecs_delete_empty_tables(world, 0, 0, 1, 0, 0) != 0);
+
+    {
+        ecs_iter_t it = ecs_rule_iter(world, r);
+        test_bool(true, ecs_rule_next(&it));
+        test_int(1, it.count);
+        test_uint(e1, it.entities[0]);
+        test_bool(false, ecs_rule_next(&it));
+    }
+
+    ecs_entity_t e3 = ecs_new(world, Foo);
+    ecs_set(world, e3, Position, {50, 60});
+
+    {
+        ecs_iter_t it = ecs_rule_iter(world, r);
+        test_bool(true, ecs_rule_next(&it));
+        test_int(1, it.count);
+        test_uint(e1, it.entities[0]);
+        test_bool(true, ecs_rule_next(&it));
+        test_int(1, it.count);
+        test_uint(e3, it.entities[0]);
+        Position *p = ecs_field(&it, Position, 1);
+        test_int(50, p[0].x);
+        test_bool(false, ecs_rule_next(&it));
+    }
+
+    ecs_rule_fini(r);
+
+    ecs_fini(world);
+}
+
+void RulesCached_pair_var(void) {
+    ecs_world_t *world = ecs_mini();
+
+    ECS_TAG(world, Likes);
+    ECS_TAG(world, Apples);
+    ECS_TAG(world, Pears);
+
+    ecs_entity_t e1 = ecs_new_w_pair(world, Likes, Apples);
+    ecs_entity_t e2 = ecs_new_w_pair(world, Likes, Pears);
+
+    ecs_rule_t *r = ecs_rule(world, {
+        .expr = "(Likes, $x)",
+        .flags = EcsFilterCacheResults
+    });
+    test_assert(r != NULL);
+
+    int32_t x_var = ecs_rule_find_var(r, "x");
+    test_assert(x_var != -1);
+
+    for (int i = 0; i < 2; i ++) {
+        ecs_iter_t it = ecs_rule_iter(world, r);
+        test_bool(true, ecs_rule_next(&it));
+        test_int(1, it.count);
+        test_uint(e1, it.entities[0]);
+        test_uint(ecs_pair(Likes, Apples), ecs_field_id(&it, 1));
+        test_uint(Apples, ecs_iter_get_var(&it, x_var));
+        test_bool(true, ecs_rule_next(&it));
+        test_int(1, it.count);
+        test_uint(e2, it.entities[0]);
+        test_uint(ecs_pair(Likes, Pears), ecs_field_id(&it, 1));
+        test_uint(Pears, ecs_iter_get_var(&it, x_var));
+        test_bool(false, ecs_rule_next(&it));
+    }
+
+    ecs_add_pair(world, e1, Likes, Pears);
+
+    {
+        ecs_iter_t it = ecs_rule_iter(world, r);
+        test_bool(true, ecs_rule_next(&it));
+        test_int(1, it.count);
+        test_uint(e2, it.entities[0]);
+        test_uint(Pears, ecs_iter_get_var(&it, x_var));
+        test_bool(true, ecs_rule_next(&it));
+        test_int(1, it.count);
+        test_uint(e1, it.entities[0]);
+        test_uint(Apples, ecs_iter_get_var(&it, x_var));
+        test_bool(true, ecs_rule_next(&it));
+        test_int(1, it.count);
+        test_uint(e1, it.entities[0]);
+        test_uint(Pears, ecs_iter_get_var(&it, x_var));
+        test_bool(false, ecs_rule_next(&it));
+    }
+
+    ecs_rule_fini(r);
+
+    ecs_fini(world);
+}
+
+void RulesCached_var_src(void) {
+    ecs_world_t *world = ecs_mini();
+
+    ECS_TAG(world, Likes);
+    ECS_TAG(world, Fruit);
+
+    ecs_entity_t apples = ecs_new_entity(world, "Apples");
+    ecs_entity_t pears = ecs_new_entity(world, "Pears");
+    ecs_add(world, apples, Fruit);
+
+    ecs_entity_t e1 = ecs_new_w_pair(world, Likes, apples);
+    ecs_entity_t e2 = ecs_new_w_pair(world, Likes, pears);
+
+    ecs_rule_t *r = ecs_rule(world, {
+        .expr = "(Likes, $x), Fruit($x)",
+        .flags = EcsFilterCacheResults
+    });
+    test_assert(r != NULL);
+
+    int32_t x_var = ecs_rule_find_var(r, "x");
+    test_assert(x_var != -1);
+
+    for (int i = 0; i < 2; i ++) {
+        ecs_iter_t it = ecs_rule_iter(world, r);
+        test_bool(true, ecs_rule_next(&it));
+        test_int(1, it.count);
+        test_uint(e1, it.entities[0]);
+        test_uint(apples, ecs_iter_get_var(&it, x_var));
+        test_uint(apples, ecs_field_src(&it, 2));
+        test_bool(false, ecs_rule_next(&it));
+    }
+
+    /* Changes the result without creating a table that matches the rule */
+    ecs_add(world, pears, Fruit);
+
+    {
+        ecs_iter_t it = ecs_rule_iter(world, r);
+        test_bool(true, ecs_rule_next(&it));
+        test_int(1, it.count);
+        test_uint(e1, it.entities[0]);
+        test_uint(apples, ecs_iter_get_var(&it, x_var));
+        test_bool(true, ecs_rule_next(&it));
+        test_int(1, it.count);
+        test_uint(e2, it.entities[0]);
+        test_uint(pears, ecs_iter_get_var(&it, x_var));
+        test_uint(pears, ecs_field_src(&it, 2));
+        test_bool(false, ecs_rule_next(&it));
+    }
+
+    ecs_remove(world, apples, Fruit);
+
+    {
+        ecs_iter_t it = ecs_rule_iter(world, r);
+        test_bool(true, ecs_rule_next(&it));
+        test_int(1, it.count);
+        test_uint(e2, it.entities[0]);
+        test_uint(pears, ecs_iter_get_var(&it, x_var));
+        test_bool(false, ecs_rule_next(&it));
+    }
+
+    ecs_rule_fini(r);
+
+    ecs_fini(world);
+}
+
+void RulesCached_fixed_src(void) {
+    ecs_world_t *world = ecs_mini();
+
+    ECS_COMPONENT(world, Position);
+    ECS_COMPONENT(world, Velocity);
+    ECS_TAG(world, Foo);
+
+    ecs_entity_t game = ecs_new_entity(world, "Game");
+    ecs_set(world, game, Velocity, {1, 2});
+
+    ecs_entity_t e1 = ecs_set(world, 0, Position, {10, 20});
+
+    ecs_rule_t *r = ecs_rule(world, {
+        .expr = "Position, Velocity(Game)",
+        .flags = EcsFilterCacheResults
+    });
+    test_assert(r != NULL);
+
+    {
+        ecs_iter_t it = ecs_rule_iter(world, r);
+        test_bool(true, ecs_rule_next(&it));
+        test_int(1, it.count);
+        test_uint(e1, it.entities[0]);
+        test_uint(game, ecs_field_src(&it, 2));
+        Velocity *v = ecs_field(&it, Velocity, 2);
+        test_int(1, v->x);
+        test_bool(false, ecs_rule_next(&it));
+    }
+
+    /* Moves source to a different table */
+    ecs_add(world, game, Foo);
+    ecs_set(world, game, Velocity, {3, 4});
+
+    {
+        ecs_iter_t it = ecs_rule_iter(world, r);
+        test_bool(true, ecs_rule_next(&it));
+        test_int(1, it.count);
+        test_uint(e1, it.entities[0]);
+        test_uint(game, ecs_field_src(&it, 2));
+        Velocity *v = ecs_field(&it, Velocity, 2);
+        test_int(3, v->x);
+        test_int(4, v->y);
+        test_bool(false, ecs_rule_next(&it));
+    }
+
+    ecs_remove(world, game, Velocity);
+
+    {
+        ecs_iter_t it = ecs_rule_iter(world, r);
+        test_bool(false, ecs_rule_next(&it));
+    }
+
+    ecs_rule_fini(r);
+
+    ecs_fini(world);
+}
+
+void RulesCached_up(void) {
+    ecs_world_t *world = ecs_mini();
+
+    ECS_COMPONENT(world, Position);
+    ECS_TAG(world, Foo);
+
+    ecs_entity_t p1 = ecs_new_id(world);
+    ecs_entity_t p2 = ecs_new_id(world);
+    ecs_set(world, p1, Position, {10, 20});
+
+    ecs_entity_t e1 = ecs_new_w_pair(world, EcsChildOf, p1);
+    ecs_entity_t e2 = ecs_new_w_pair(world, EcsChildOf, p2);
+
+    ecs_rule_t *r = ecs_rule(world, {
+        .expr = "Position(up(ChildOf))",
+        .flags = EcsFilterCacheResults
+    });
+    test_assert(r != NULL);
+
+    {
+        ecs_iter_t it = ecs_rule_iter(world, r);
+        test_bool(true, ecs_rule_next(&it));
+        test_int(1, it.count);
+        test_uint(e1, it.entities[0]);
+        test_uint(p1, ecs_field_src(&it, 1));
+        test_bool(false, ecs_rule_next(&it));
+    }
+
+    /* Parent is matched through traversal, so no new table matches */
+    ecs_set(world, p2, Position, {30, 40});
+
+    {
+        ecs_iter_t it = ecs_rule_iter(world, r);
+        test_bool(true, ecs_rule_next(&it));
+        test_int(1, it.count);
+        test_uint(e1, it.entities[0]);
+        test_uint(p1, ecs_field_src(&it, 1));
+        test_bool(true, ecs_rule_next(&it));
+        test_int(1, it.count);
+        test_uint(e2, it.entities[0]);
+        test_uint(p2, ecs_field_src(&it, 1));
+        Position *p = ecs_field(&it, Position, 1);
+        test_int(30, p->x);
+        test_bool(false, ecs_rule_next(&it));
+    }
+
+    ecs_remove(world, p1, Position);
+
+    {
+        ecs_iter_t it = ecs_rule_iter(world, r);
+        test_bool(true, ecs_rule_next(&it));
+        test_int(1, it.count);
+        test_uint(e2, it.entities[0]);
+        test_uint(p2, ecs_field_src(&it, 1));
+        test_bool(false, ecs_rule_next(&it));
+    }
+
+    /* Child moves to new table */
+    ecs_entity_t e3 = ecs_new_w_pair(world, EcsChildOf, p2);
+    ecs_add(world, e3, Foo);
+
+    {
+        ecs_iter_t it = ecs_rule_iter(world, r);
+        test_bool(true, ecs_rule_next(&it));
+        test_int(1, it.count);
+        test_uint(e2, it.entities[0]);
+        test_bool(true, ecs_rule_next(&it));
+        test_int(1, it.count);
+        test_uint(e3, it.entities[0]);
+        test_uint(p2, ecs_field_src(&it, 1));
+        test_bool(false, ecs_rule_next(&it));
+    }
+
+    ecs_rule_fini(r);
+
+    ecs_fini(world);
+}
+
+void RulesCached_inherited(void) {
+    ecs_world_t *world = ecs_mini();
+
+    ECS_COMPONENT(world, Position);
+    ECS_COMPONENT(world, Velocity);
+
+    ecs_entity_t base = ecs_new_w_id(world, EcsPrefab);
+    ecs_set(world, base, Position, {10, 20});
+
+    ecs_entity_t e1 = ecs_new_w_pair(world, EcsIsA, base);
+    ecs_set(world, e1, Velocity, {1, 2});
+
+    ecs_rule_t *r = ecs_rule(world, {
+        .expr = "Position, Velocity",
+        .flags = EcsFilterCacheResults
+    });
+    test_assert(r != NULL);
+
+    {
+        ecs_iter_t it = ecs_rule_iter(world, r);
+        test_bool(true, ecs_rule_next(&it));
+        test_int(1, it.count);
+        test_uint(e1, it.entities[0]);
+        test_uint(base, ecs_field_src(&it, 1));
+        Position *p = ecs_field(&it, Position, 1);
+        test_int(10, p->x);
+        test_bool(false, ecs_rule_next(&it));
+    }
+
+    ecs_remove(world, base, Position);
+
+    {
+        ecs_iter_t it = ecs_rule_iter(world, r);
+        test_bool(false, ecs_rule_next(&it));
+    }
+
+    ecs_set(world, base, Position, {30, 40});
+
+    {
+        ecs_iter_t it = ecs_rule_iter(world, r);
+        test_bool(true, ecs_rule_next(&it));
+        test_int(1, it.count);
+        test_uint(e1, it.entities[0]);
+        test_uint(base, ecs_field_src(&it, 1));
+        Position *p = ecs_field(&it, Position, 1);
+        test_int(30, p->x);
+        test_bool(false, ecs_rule_next(&it));
+    }
+
+    ecs_rule_fini(r);
+
+    ecs_fini(world);
+}
+
+void RulesCached_transitive(void) {
+    ecs_world_t *world = ecs_mini();
+
+    ECS_ENTITY(world, LocatedIn, Transitive);
+    ECS_TAG(world, Earth);
+    ECS_TAG(world, Netherlands);
+    ECS_TAG(world, Amsterdam);
+
+    ecs_add_pair(world, Amsterdam, LocatedIn, Netherlands);
+
+    ecs_entity_t e1 = ecs_new_w_pair(world, LocatedIn, Amsterdam);
+
+    ecs_rule_t *r = ecs_rule(world, {
+        .expr = "(LocatedIn, Earth)",
+        .flags = EcsFilterCacheResults
+    });
+    test_assert(r != NULL);
+
+    {
+        ecs_iter_t it = ecs_rule_iter(world, r);
+        test_bool(false, ecs_rule_next(&it));
+    }
+
+    ecs_add_pair(world, Netherlands, LocatedIn, Earth);
+
+    {
+        ecs_iter_t it = ecs_rule_iter(world, r);
+        test_bool(true, ecs_rule_next(&it));
+        test_int(1, it.count);
+        test_uint(Netherlands, it.entities[0]);
+        test_bool(true, ecs_rule_next(&it));
+        test_int(1, it.count);
+        test_uint(Amsterdam, it.entities[0]);
+        test_bool(true, ecs_rule_next(&it));
+        test_int(1, it.count);
+        test_uint(e1, it.entities[0]);
+        test_bool(false, ecs_rule_next(&it));
+    }
+
+    ecs_rule_fini(r);
+
+    ecs_fini(world);
+}
+
+void RulesCached_set_var(void) {
+    ecs_world_t *world = ecs_mini();
+
+    ECS_TAG(world, Likes);
+    ECS_TAG(world, Apples);
+    ECS_TAG(world, Pears);
+
+    ecs_entity_t e1 = ecs_new_w_pair(world, Likes, Apples);
+    ecs_entity_t e2 = ecs_new_w_pair(world, Likes, Pears);
+
+    ecs_rule_t *r = ecs_rule(world, {
+        .expr = "(Likes, $x)",
+        .flags = EcsFilterCacheResults
+    });
+    test_assert(r != NULL);
+
+    int32_t x_var = ecs_rule_find_var(r, "x");
+    test_assert(x_var != -1);
+
+    {
+        ecs_iter_t it = ecs_rule_iter(world, r);
+        ecs_iter_set_var(&it, x_var, Pears);
+        test_bool(true, ecs_rule_next(&it));
+        test_assert(!(it.flags & EcsIterCached));
+        test_int(1, it.count);
+        test_uint(e2, it.entities[0]);
+        test_uint(Pears, ecs_iter_get_var(&it, x_var));
+        test_bool(false, ecs_rule_next(&it));
+    }
+
+    {
+        ecs_iter_t it = ecs_rule_iter(world, r);
+        test_bool(true, ecs_rule_next(&it));
+        test_uint(e1, it.entities[0]);
+        test_bool(true, ecs_rule_next(&it));
+        test_uint(e2, it.entities[0]);
+        test_bool(false, ecs_rule_next(&it));
+    }
+
+    ecs_rule_fini(r);
+
+    ecs_fini(world);
+}
+
+void RulesCached_optional(void) {
+    ecs_world_t *world = ecs_mini();
+
+    ECS_COMPONENT(world, Position);
+    ECS_COMPONENT(world, Velocity);
+
+    ecs_entity_t e1 = ecs_set(world, 0, Position, {10, 20});
+    ecs_entity_t e2 = ecs_set(world, 0, Position, {30, 40});
+    ecs_set(world, e2, Velocity, {1, 2});
+
+    ecs_rule_t *r = ecs_rule(world, {
+        .expr = "Position(self), ?Velocity(self)",
+        .flags = EcsFilterCacheResults
+    });
+    test_assert(r != NULL);
+
+    for (int i = 0; i < 2; i ++) {
+        ecs_iter_t it = ecs_rule_iter(world, r);
+        test_bool(true, ecs_rule_next(&it));
+        test_int(1, it.count);
+        test_uint(e1, it.entities[0]);
+        test_bool(false, ecs_field_is_set(&it, 2));
+        test_assert(ecs_field(&it, Velocity, 2) == NULL);
+        test_bool(true, ecs_rule_next(&it));
+        test_int(1, it.count);
+        test_uint(e2, it.entities[0]);
+        test_bool(true, ecs_field_is_set(&it, 2));
+        Velocity *v = ecs_field(&it, Velocity, 2);
+        test_assert(v != NULL);
+        test_int(1, v->x);
+        test_bool(false, ecs_rule_next(&it));
+    }
+
+    ecs_rule_fini(r);
+
+    ecs_fini(world);
+}
+
+void RulesCached_fini_while_deferred(void) {
+    ecs_world_t *world = ecs_mini();
+
+    ECS_COMPONENT(world, Position);
+    ECS_TAG(world, Foo);
+
+    ecs_entity_t e1 = ecs_set(world, 0, Position, {10, 20});
+
+    ecs_rule_t *r = ecs_rule(world, {
+        .expr = "Position",
+        .flags = EcsFilterCacheResults
+    });
+    test_assert(r != NULL);
+
+    {
+        ecs_iter_t it = ecs_rule_iter(world, r);
+        test_bool(true, ecs_rule_next(&it));
+        test_uint(e1, it.entities[0]);
+        test_bool(false, ecs_rule_next(&it));
+    }
+
+    ecs_defer_begin(world);
+    ecs_add(world, e1, Foo);
+    ecs_rule_fini(r);
+    ecs_defer_end(world);
+
+    test_assert(ecs_has(world, e1, Foo));
+
+    ecs_fini(world);
+}
+
+void RulesCached_w_entity(void) {
+    ecs_world_t *world = ecs_mini();
+
+    ECS_COMPONENT(world, Position);
+
+    ecs_entity_t e1 = ecs_set(world, 0, Position, {10, 20});
+
+    ecs_entity_t re = ecs_new_id(world);
+    ecs_rule_t *r = ecs_rule(world, {
+        .entity = re,
+        .expr = "Position",
+        .flags = EcsFilterCacheResults
+    });
+    test_assert(r != NULL);
+
+    {
+        ecs_iter_t it = ecs_rule_iter(world, r);
+        test_bool(true, ecs_rule_next(&it));
+        test_uint(e1, it.entities[0]);
+        test_bool(false, ecs_rule_next(&it));
+    }
+
+    ecs_fini(world);
+}
+
+void RulesCached_not_cacheable(void) {
+    ecs_world_t *world = ecs_mini();
+
+    ECS_COMPONENT(world, Position);
+
+    ecs_entity_t e1 = ecs_new_entity(world, "ent_1");
+    ecs_set(world, e1, Position, {10, 20});
+    ecs_entity_t e2 = ecs_new_entity(world, "foo");
+    ecs_set(world, e2, Position, {30, 40});
+
+    ecs_rule_t *r = ecs_rule(world, {
+        .expr = "Position, $this ~= \"ent\"",
+        .flags = EcsFilterCacheResults
+    });
+    test_assert(r != NULL);
+
+    {
+        ecs_iter_t it = ecs_rule_iter(world, r);
+        test_bool(true, ecs_rule_next(&it));
+        test_assert(!(it.flags & EcsIterCached));
+        test_int(1, it.count);
+        test_uint(e1, it.entities[0]);
+        test_bool(false, ecs_rule_next(&it));
+    }
+
+    /* Renaming doesn't emit events for the ids of the rule */
+    ecs_set_name(world, e2, "ent_2");
+
+    {
+        ecs_iter_t it = ecs_rule_iter(world, r);
+        test_bool(true, ecs_rule_next(&it));
+        test_int(2, it.count);
+        test_uint(e1, it.entities[0]);
+        test_uint(e2, it.entities[1]);
+        test_bool(false, ecs_rule_next(&it));
+    }
+
+    ecs_rule_fini(r);
+
+    ecs_fini(world);
+}
+
+void RulesCached_up_empty_table(void) {
+    ecs_world_t *world = ecs_mini();
+
+    ECS_COMPONENT(world, Position);
+    ECS_TAG(world, Foo);
+
+    ecs_entity_t p = ecs_new_id(world);
+    ecs_entity_t e = ecs_new_w_pair(world, EcsChildOf, p);
+    ecs_add(world, e, Foo); /* (ChildOf, p) table is now empty */
+
+    ecs_rule_t *r = ecs_rule(world, {
+        .expr = "Position(up(ChildOf))",
+        .flags = EcsFilterCacheResults
+    });
+    test_assert(r != NULL);
+
+    {
+        ecs_iter_t it = ecs_rule_iter(world, r);
+        test_bool(false, ecs_rule_next(&it));
+    }
+
+    ecs_set(world, p, Position, {10, 20});
+
+    {
+        ecs_iter_t it = ecs_rule_iter(world, r);
+        test_bool(true, ecs_rule_next(&it));
+        test_int(1, it.count);
+        test_uint(e, it.entities[0]);
+        test_uint(p, ecs_field_src(&it, 1));
+        test_bool(false, ecs_rule_next(&it));
+    }
+
+    /* Move entity back to the table that was empty when results were built */
+    ecs_remove(world, e, Foo);
+
+    {
+        ecs_iter_t it = ecs_rule_iter(world, r);
+        test_bool(true, ecs_rule_next(&it));
+        test_int(1, it.count);
+        test_uint(e, it.entities[0]);
+        test_uint(p, ecs_field_src(&it, 1));
+        test_bool(false, ecs_rule_next(&it));
+    }
+
+    ecs_rule_fini(r);
+
+    ecs_fini(world);
+}
@@ -5099,3 +5099,227 @@ void RulesTransitive_any_target(void) {
 
     ecs_fini(world);
 }
+
+void RulesTransitive_1_this_src_add_after_iter(void) {
+    ecs_world_t *world = ecs_init();
+
+    populate_facts(world);
+
+    ecs_entity_t e1 = ecs_new_id(world);
+    ecs_entity_t e2 = ecs_new_id(world);
+
+    ecs_rule_t *r = ecs_rule(world, {
+        .expr = "LocatedIn($this, Washington)"
+    });
+
+    test_assert(r != NULL);
+
+    ecs_add_pair(world, e1, LocatedIn, Seattle);
+
+    {
+        ecs_iter_t it = ecs_rule_iter(world, r);
+        test_bool(true, ecs_rule_next(&it));
+        test_uint(1, it.count);
+        test_uint(ecs_pair(LocatedIn, Washington), ecs_field_id(&it, 1));
+        test_uint(Seattle, it.entities[0]);
+
+        test_bool(true, ecs_rule_next(&it));
+        test_uint(1, it.count);
+        test_uint(ecs_pair(LocatedIn, Seattle), ecs_field_id(&it, 1));
+        test_uint(e1, it.entities[0]);
+
+        test_bool(false, ecs_rule_next(&it));
+    }
+
+    ecs_entity_t Tacoma = ecs_new_w_pair(world, LocatedIn, Washington);
+    ecs_add_pair(world, e2, LocatedIn, Tacoma);
+
+    {
+        ecs_iter_t it = ecs_rule_iter(world, r);
+        test_bool(true, ecs_rule_next(&it));
+        test_uint(1, it.count);
+        test_uint(ecs_pair(LocatedIn, Washington), ecs_field_id(&it, 1));
+        test_uint(Seattle, it.entities[0]);
+
+        test_bool(true, ecs_rule_next(&it));
+        test_uint(1, it.count);
+        test_uint(ecs_pair(LocatedIn, Washington), ecs_field_id(&it, 1));
+        test_uint(Tacoma, it.entities[0]);
+
+        test_bool(true, ecs_rule_next(&it));
+        test_uint(1, it.count);
+        test_uint(ecs_pair(LocatedIn, Seattle), ecs_field_id(&it, 1));
+        test_uint(e1, it.entities[0]);
+
+        test_bool(true, ecs_rule_next(&it));
+        test_uint(1, it.count);
+        test_uint(ecs_pair(LocatedIn, Tacoma), ecs_field_id(&it, 1));
+        test_uint(e2, it.entities[0]);
+
+        test_bool(false, ecs_rule_next(&it));
+    }
+
+    ecs_rule_fini(r);
+
+    ecs_fini(world);
+}
+
+void RulesTransitive_1_this_src_remove_after_iter(void) {
+    ecs_world_t *world = ecs_init();
+
+    populate_facts(world);
+
+    ecs_entity_t e1 = ecs_new_id(world);
+    ecs_entity_t e2 = ecs_new_id(world);
+
+    ecs_rule_t *r = ecs_rule(world, {
+        .expr = "LocatedIn($this, California)"
+    });
+
+    test_assert(r != NULL);
+
+    ecs_add_pair(world, e1, LocatedIn, SanFrancisco);
+    ecs_add_pair(world, e2, LocatedIn, LosAngeles);
+
+    {
+        ecs_iter_t it = ecs_rule_iter(world, r);
+        test_bool(true, ecs_rule_next(&it));
+        test_uint(2, it.count);
+        test_uint(ecs_pair(LocatedIn, California), ecs_field_id(&it, 1));
+        test_uint(SanFrancisco, it.entities[0]);
+        test_uint(LosAngeles, it.entities[1]);
+
+        test_bool(true, ecs_rule_next(&it));
+        test_uint(1, it.count);
+        test_uint(ecs_pair(LocatedIn, SanFrancisco), ecs_field_id(&it, 1));
+        test_uint(e1, it.entities[0]);
+
+        test_bool(true, ecs_rule_next(&it));
+        test_uint(1, it.count);
+        test_uint(ecs_pair(LocatedIn, LosAngeles), ecs_field_id(&it, 1));
+        test_uint(e2, it.entities[0]);
+
+        test_bool(false, ecs_rule_next(&it));
+    }
+
+    ecs_remove_pair(world, LosAngeles, LocatedIn, California);
+
+    {
+        ecs_iter_t it = ecs_rule_iter(world, r);
+        test_bool(true, ecs_rule_next(&it));
+        test_uint(1, it.count);
+        test_uint(ecs_pair(LocatedIn, California), ecs_field_id(&it, 1));
+        test_uint(SanFrancisco, it.entities[0]);
+
+        test_bool(true, ecs_rule_next(&it));
+        test_uint(1, it.count);
+        test_uint(ecs_pair(LocatedIn, SanFrancisco), ecs_field_id(&it, 1));
+        test_uint(e1, it.entities[0]);
+
+        test_bool(false, ecs_rule_next(&it));
+    }
+
+    ecs_rule_fini(r);
+
+    ecs_fini(world);
+}
+
+void RulesTransitive_1_this_src_delete_tgt_after_iter(void) {
+    ecs_world_t *world = ecs_init();
+
+    populate_facts(world);
+
+    ecs_entity_t e1 = ecs_new_id(world);
+    ecs_entity_t e2 = ecs_new_id(world);
+
+    ecs_rule_t *r = ecs_rule(world, {
+        .expr = "LocatedIn($this, California)"
+    });
+
+    test_assert(r != NULL);
+
+    ecs_add_pair(world, e1, LocatedIn, SanFrancisco);
+    ecs_add_pair(world, e2, LocatedIn, LosAngeles);
+
+    {
+        ecs_iter_t it = ecs_rule_iter(world, r);
+        test_bool(true, ecs_rule_next(&it));
+        test_uint(2, it.count);
+        test_bool(true, ecs_rule_next(&it));
+        test_uint(1, it.count);
+        test_uint(e1, it.entities[0]);
+        test_bool(true, ecs_rule_next(&it));
+        test_uint(1, it.count);
+        test_uint(e2, it.entities[0]);
+        test_bool(false, ecs_rule_next(&it));
+    }
+
+    ecs_delete(world, SanFrancisco);
+
+    {
+        ecs_iter_t it = ecs_rule_iter(world, r);
+        test_bool(true, ecs_rule_next(&it));
+        test_uint(1, it.count);
+        test_uint(ecs_pair(LocatedIn, California), ecs_field_id(&it, 1));
+        test_uint(LosAngeles, it.entities[0]);
+
+        test_bool(true, ecs_rule_next(&it));
+        test_uint(1, it.count);
+        test_uint(ecs_pair(LocatedIn, LosAngeles), ecs_field_id(&it, 1));
+        test_uint(e2, it.entities[0]);
+
+        test_bool(false, ecs_rule_next(&it));
+    }
+
+    ecs_rule_fini(r);
+
+    ecs_fini(world);
+}
+
+void RulesTransitive_this_var_tgt_2_pairs_1st_tgt_not_transitive(void) {
+    ecs_world_t *world = ecs_mini();
+
+    ECS_ENTITY(world, LocatedIn, Transitive);
+    ECS_TAG(world, Foo);
+    ECS_TAG(world, Amsterdam);
+    ECS_TAG(world, Netherlands);
+    ECS_TAG(world, Europe);
+
+    /* Amsterdam has a table, but no LocatedIn relationship */
+    ecs_add(world, Amsterdam, Foo);
+    ecs_add_pair(world, Netherlands, LocatedIn, Europe);
+
+    ecs_entity_t e = ecs_new_w_pair(world, LocatedIn, Amsterdam);
+    ecs_add_pair(world, e, LocatedIn, Netherlands);
+
+    ecs_rule_t *r = ecs_rule(world, {
+        .expr = "LocatedIn($this, $x)"
+    });
+
+    test_assert(r != NULL);
+
+    int x_var = ecs_rule_find_var(r, "x");
+    test_assert(x_var != -1);
+
+    bool amsterdam = false, netherlands = false, europe = false;
+
+    ecs_iter_t it = ecs_rule_iter(world, r);
+    while (ecs_rule_next(&it)) {
+        if (it.entities[0] != e) {
+            continue;
+        }
+        test_int(1, it.count);
+        ecs_entity_t x = ecs_iter_get_var(&it, x_var);
+        amsterdam |= x == Amsterdam;
+        netherlands |= x == Netherlands;
+        europe |= x == Europe;
+    }
+
+    test_bool(true, amsterdam);
+    test_bool(true, netherlands);
+    test_bool(true, europe);
+
+    ecs_rule_fini(r);
+
+    ecs_fini(world);
+}
@@ -5847,17 +5847,6 @@ void RulesVariables_2_cycle_w_var(void) {
     {
         ecs_iter_t it = ecs_rule_iter(world, r);
 
-        test_bool(true, ecs_rule_next(&it));
-        test_uint(0, it.count);
-        test_uint(e2, ecs_field_id(&it, 1));
-        test_uint(e1, ecs_field_id(&it, 2));
-        test_uint(TagA, ecs_field_id(&it, 3));
-        test_uint(e1, ecs_field_src(&it, 1));
-        test_uint(e2, ecs_field_src(&it, 2));
-        test_uint(e2, ecs_field_src(&it, 3));
-        test_uint(e2, ecs_iter_get_var(&it, x_var));
-        test_uint(e1, ecs_iter_get_var(&it, y_var));
-
         test_bool(true, ecs_rule_next(&it));
         test_uint(0, it.count);
         test_uint(e1, ecs_field_id(&it, 1));
@@ -5869,6 +5858,17 @@ void RulesVariables_2_cycle_w_var(void) {
         test_uint(e1, ecs_iter_get_var(&it, x_var));
         test_uint(e2, ecs_iter_get_var(&it, y_var));
 
+        test_bool(true, ecs_rule_next(&it));
+        test_uint(0, it.count);
+        test_uint(e2, ecs_field_id(&it, 1));
+        test_uint(e1, ecs_field_id(&it, 2));
+        test_uint(TagA, ecs_field_id(&it, 3));
+        test_uint(e1, ecs_field_src(&it, 1));
+        test_uint(e2, ecs_field_src(&it, 2));
+        test_uint(e2, ecs_field_src(&it, 3));
+        test_uint(e2, ecs_iter_get_var(&it, x_var));
+        test_uint(e1, ecs_iter_get_var(&it, y_var));
+
         test_bool(false, ecs_rule_next(&it));
     }
 
@@ -9186,3 +9186,190 @@ void RulesVariables_2_trivial_1_any_component(void) {
 
     ecs_fini(world);
 }
+
+void RulesVariables_join_known_tgt(void) {
+    ecs_world_t *world = ecs_mini();
+
+    ECS_ENTITY(world, Likes, DontInherit);
+    ECS_ENTITY(world, Friend, DontInherit);
+    ECS_TAG(world, Foo);
+
+    ecs_entity_t tgts[20], srcs[20], friends[20] = {0};
+    for (int i = 0; i < 20; i ++) {
+        tgts[i] = ecs_new_id(world);
+        srcs[i] = ecs_new_w_pair(world, Likes, tgts[i]);
+        if (!(i % 4)) {
+            friends[i] = ecs_new_w_pair(world, Friend, tgts[i]);
+            ecs_add(world, friends[i], Foo);
+        }
+    }
+
+    ecs_entity_t f = ecs_new_w_pair(world, Friend, tgts[8]);
+
+    ecs_rule_t *r = ecs_rule(world, {
+        .expr = "Likes($x, $y), Friend($z, $y)"
+    });
+
+    test_assert(r != NULL);
+
+    char *plan = ecs_rule_str(r);
+    test_assert(strstr(plan, "join") != NULL);
+    ecs_os_free(plan);
+
+    int32_t x_var = ecs_rule_find_var(r, "x");
+    test_assert(x_var != -1);
+    int32_t y_var = ecs_rule_find_var(r, "y");
+    test_assert(y_var != -1);
+    int32_t z_var = ecs_rule_find_var(r, "z");
+    test_assert(z_var != -1);
+
+    int32_t count = 0, f_count = 0;
+    ecs_iter_t it = ecs_rule_iter(world, r);
+    while (ecs_rule_next(&it)) {
+        ecs_entity_t x = ecs_iter_get_var(&it, x_var);
+        ecs_entity_t y = ecs_iter_get_var(&it, y_var);
+        ecs_entity_t z = ecs_iter_get_var(&it, z_var);
+        test_assert(ecs_has_pair(world, x, Likes, y));
+        test_assert(ecs_has_pair(world, z, Friend, y));
+        test_uint(ecs_pair(Likes, y), ecs_field_id(&it, 1));
+        test_uint(ecs_pair(Friend, y), ecs_field_id(&it, 2));
+        test_uint(x, ecs_field_src(&it, 1));
+        test_uint(z, ecs_field_src(&it, 2));
+        if (z == f) {
+            test_uint(y, tgts[8]);
+            f_count ++;
+        }
+        count ++;
+    }
+
+    test_int(count, 6);
+    test_int(f_count, 1);
+
+    ecs_rule_fini(r);
+
+    ecs_fini(world);
+}
+
+void RulesVariables_join_known_tgt_w_component(void) {
+    ecs_world_t *world = ecs_mini();
+
+    ECS_ENTITY(world, Likes, DontInherit);
+    ECS_COMPONENT(world, Position);
+    ecs_add_id(world, ecs_id(Position), EcsDontInherit);
+
+    ecs_entity_t tgts[20];
+    for (int i = 0; i < 20; i ++) {
+        tgts[i] = ecs_new_id(world);
+        ecs_new_w_pair(world, Likes, tgts[i]);
+    }
+
+    ecs_entity_t e = ecs_new_id(world);
+    ecs_set_pair(world, e, Position, tgts[3], {10, 20});
+
+    ecs_rule_t *r = ecs_rule(world, {
+        .expr = "Likes($x, $y), Position($z, $y)"
+    });
+
+    test_assert(r != NULL);
+
+    char *plan = ecs_rule_str(r);
+    test_assert(strstr(plan, "join") != NULL);
+    ecs_os_free(plan);
+
+    int32_t z_var = ecs_rule_find_var(r, "z");
+    test_assert(z_var != -1);
+
+    ecs_iter_t it = ecs_rule_iter(world, r);
+    test_bool(true, ecs_rule_next(&it));
+    test_uint(e, ecs_iter_get_var(&it, z_var));
+    test_uint(ecs_pair(ecs_id(Position), tgts[3]), ecs_field_id(&it, 2));
+    test_uint(e, ecs_field_src(&it, 2));
+    {
+        Position *p = ecs_field(&it, Position, 2);
+        test_assert(p != NULL);
+        test_int(p->x, 10);
+        test_int(p->y, 20);
+    }
+    test_bool(false, ecs_rule_next(&it));
+
+    ecs_rule_fini(r);
+
+    ecs_fini(world);
+}
+
+void RulesVariables_join_known_tgt_entity_moved(void) {
+    ecs_world_t *world = ecs_mini();
+
+    ECS_ENTITY(world, Likes, DontInherit);
+    ECS_ENTITY(world, Friend, DontInherit);
+    ECS_TAG(world, Foo);
+
+    ecs_entity_t tgts[20];
+    for (int i = 0; i < 20; i ++) {
+        tgts[i] = ecs_new_id(world);
+        ecs_new_w_pair(world, Likes, tgts[i]);
+    }
+
+    ecs_entity_t f1 = ecs_new_w_pair(world, Friend, tgts[1]);
+    ecs_entity_t f2 = ecs_new_w_pair(world, Friend, tgts[2]);
+
+    ecs_rule_t *r = ecs_rule(world, {
+        .expr = "Likes($x, $y), Friend($z, $y)"
+    });
+
+    test_assert(r != NULL);
+
+    char *plan = ecs_rule_str(r);
+    test_assert(strstr(plan, "join") != NULL);
+    ecs_os_free(plan);
+
+    int32_t z_var = ecs_rule_find_var(r, "z");
+    test_assert(z_var != -1);
+
+    ecs_add(world, f1, Foo);
+    ecs_remove_pair(world, f2, Friend, tgts[2]);
+
+    ecs_iter_t it = ecs_rule_iter(world, r);
+    test_bool(true, ecs_rule_next(&it));
+    test_uint(f1, ecs_iter_get_var(&it, z_var));
+    test_uint(f1, ecs_field_src(&it, 2));
+    test_bool(false, ecs_rule_next(&it));
+
+    ecs_rule_fini(r);
+
+    ecs_fini(world);
+}
+
+void RulesVariables_no_join_few_probes(void) {
+    ecs_world_t *world = ecs_mini();
+
+    ECS_TAG(world, Likes);
+    ECS_TAG(world, Friend);
+
+    ecs_entity_t t = ecs_new_id(world);
+    ecs_entity_t e = ecs_new_w_pair(world, Likes, t);
+    ecs_entity_t f = ecs_new_w_pair(world, Friend, t);
+
+    ecs_rule_t *r = ecs_rule(world, {
+        .expr = "Likes($x, $y), Friend($z, $y)"
+    });
+
+    test_assert(r != NULL);
+
+    char *plan = ecs_rule_str(r);
+    test_assert(strstr(plan, "join") == NULL);
+    ecs_os_free(plan);
+
+    int32_t x_var = ecs_rule_find_var(r, "x");
+    int32_t z_var = ecs_rule_find_var(r, "z");
+
+    ecs_iter_t it = ecs_rule_iter(world, r);
+    test_bool(true, ecs_rule_next(&it));
+    test_uint(e, ecs_iter_get_var(&it, x_var));
+    test_uint(f, ecs_iter_get_var(&it, z_var));
+    test_bool(false, ecs_rule_next(&it));
+
+    ecs_rule_fini(r);
+
+    ecs_fini(world);
+}
@@ -1131,3 +1131,48 @@ void Run_run_staging(void) {
  
     ecs_fini(world);
 }
+
+void Run_run_worker_balanced(void) {
+    ecs_world_t *world = ecs_init();
+
+    ECS_COMPONENT(world, Position);
+
+    ECS_SYSTEM(world, Iter, 0, Position);
+
+    ecs_system(world, {
+        .entity = Iter,
+        .multi_threaded = true
+    });
+
+    int i;
+    ecs_entity_t ids[10];
+    for (i = 0; i < 10; i ++) {
+        ids[i] = ecs_set(world, 0, Position, {0, 0});
+        ecs_add_id(world, ids[i], ecs_new_id(world));
+    }
+
+    Probe ctx = {0};
+    ecs_set_ctx(world, &ctx, NULL);
+
+    test_int( ecs_run_worker(world, Iter, 0, 2, 1.0, NULL), 0);
+
+    /* Tables are assigned to a single worker */
+    test_int(ctx.count, 5);
+    test_int(ctx.invoked, 5);
+
+    for (i = 0; i < 10; i ++) {
+        const Position *p = ecs_get(world, ids[i], Position);
+        test_int(p->x, i < 5 ? 10 : 0);
+    }
+
+    test_int( ecs_run_worker(world, Iter, 1, 2, 1.0, NULL), 0);
+    test_int(ctx.count, 10);
+    test_int(ctx.invoked, 10);
+
+    for (i = 0; i < 10; i ++) {
+        const Position *p = ecs_get(world, ids[i], Position);
+        test_int(p->x, 10);
+    }
+
+    ecs_fini(world);
+}
@@ -312,3 +312,96 @@ void Stats_get_not_alive_entity_count(void) {
 
     ecs_fini(world);
 }
+
+void Stats_get_allocator_stats(void) {
+    ecs_world_t *world = ecs_init();
+
+    ECS_COMPONENT(world, Position);
+
+    int32_t i;
+    for (i = 0; i < 1000; i ++) {
+        ecs_entity_t e = ecs_new(world, Position);
+        ecs_add_pair(world, e, EcsChildOf, ecs_new_id(world));
+    }
+
+    ecs_allocator_stats_t stats = {0};
+    ecs_allocator_stats_get(world, &stats);
+
+    test_assert(stats.block_count != 0);
+    test_assert(stats.bytes_reserved != 0);
+    test_assert(ecs_vec_count(&stats.sizes) != 0);
+
+    /* Totals should add up to the sum of size classes */
+    int64_t bytes_in_use = 0, bytes_reserved = 0;
+    int32_t chunk_count = 0, block_count = 0;
+    int32_t count = ecs_vec_count(&stats.sizes);
+    ecs_allocator_size_stats_t *sizes = ecs_vec_first(&stats.sizes);
+    for (i = 0; i < count; i ++) {
+        if (i) {
+            test_assert(sizes[i - 1].size < sizes[i].size);
+        }
+        test_assert(sizes[i].allocator_count != 0);
+        test_assert(sizes[i].chunk_count_max >= sizes[i].chunk_count);
+        test_assert(sizes[i].bytes_reserved >= sizes[i].bytes_in_use);
+        bytes_in_use += sizes[i].bytes_in_use;
+        bytes_reserved += sizes[i].bytes_reserved;
+        chunk_count += sizes[i].chunk_count;
+        block_count += sizes[i].block_count;
+    }
+
+    test_int(bytes_in_use, stats.bytes_in_use);
+    test_int(bytes_reserved, stats.bytes_reserved);
+    test_int(chunk_count, stats.chunk_count);
+    test_int(block_count, stats.block_count);
+
+#ifdef FLECS_ALLOCATOR_STATS
+    test_assert(stats.chunk_count != 0);
+    test_assert(stats.bytes_in_use != 0);
+#endif
+
+    ecs_allocator_stats_fini(&stats);
+
+    ecs_fini(world);
+}
+
+void Stats_get_allocator_stats_twice(void) {
+    ecs_world_t *world = ecs_init();
+
+    ecs_allocator_stats_t stats = {0};
+    ecs_allocator_stats_get(world, &stats);
+
+    int64_t bytes_reserved = stats.bytes_reserved;
+    int32_t count = ecs_vec_count(&stats.sizes);
+    test_assert(count != 0);
+
+    /* Stats should be reset, not accumulated */
+    ecs_allocator_stats_get(world, &stats);
+    test_int(stats.bytes_reserved, bytes_reserved);
+    test_int(ecs_vec_count(&stats.sizes), count);
+
+    ecs_allocator_stats_fini(&stats);
+
+    ecs_fini(world);
+}
+
+void Stats_get_allocator_world_stats(void) {
+    ecs_world_t *world = ecs_init();
+
+    ecs_allocator_stats_t alloc_stats = {0};
+    ecs_allocator_stats_get(world, &alloc_stats);
+
+    ecs_world_stats_t stats = {0};
+    ecs_world_stats_get(world, &stats);
+
+    int32_t t = stats.t;
+    test_assert(stats.memory.allocator_block_count.gauge.avg[t] != 0);
+    test_assert(stats.memory.allocator_bytes_reserved.gauge.avg[t] != 0);
+    test_int(stats.memory.allocator_block_count.gauge.avg[t], 
+        alloc_stats.block_count);
+    test_int(stats.memory.allocator_chunk_count.gauge.avg[t], 
+        alloc_stats.chunk_count);
+
+    ecs_allocator_stats_fini(&alloc_stats);
+
+    ecs_fini(world);
+}
@@ -841,6 +841,16 @@ void RulesBasic_2_trivial_mixed_2_tables_wildcard(void);
 void RulesBasic_1_plan_any_src(void);
 void RulesBasic_1_plan_not_any_src(void);
 void RulesBasic_1_plan_optional_any_src(void);
+void RulesBasic_planned_by_cardinality(void);
+void RulesBasic_replan_after_cardinality_change(void);
+void RulesBasic_no_replan_while_iterating(void);
+void RulesBasic_profile(void);
+void RulesBasic_profile_accumulate(void);
+void RulesBasic_profile_iter_fini(void);
+void RulesBasic_fused_with_ids_plan(void);
+void RulesBasic_fused_self_up_with_ids_plan(void);
+void RulesBasic_fused_with_ids(void);
+void RulesBasic_fused_self_up_with_ids(void);
 
 // Testsuite 'RulesVariables'
 void RulesVariables_1_ent_src_w_var(void);
@@ -1005,6 +1015,10 @@ void RulesVariables_1_trivial_1_any(void);
 void RulesVariables_2_trivial_1_any(void);
 void RulesVariables_1_trivial_1_any_component(void);
 void RulesVariables_2_trivial_1_any_component(void);
+void RulesVariables_join_known_tgt(void);
+void RulesVariables_join_known_tgt_w_component(void);
+void RulesVariables_join_known_tgt_entity_moved(void);
+void RulesVariables_no_join_few_probes(void);
 
 // Testsuite 'RulesOperators'
 void RulesOperators_2_and_not(void);
@@ -1178,6 +1192,10 @@ void RulesTransitive_optional_transitive_var_tgt_written(void);
 void RulesTransitive_2_var_src_w_same_tgt_ent(void);
 void RulesTransitive_self_target(void);
 void RulesTransitive_any_target(void);
+void RulesTransitive_1_this_src_add_after_iter(void);
+void RulesTransitive_1_this_src_remove_after_iter(void);
+void RulesTransitive_1_this_src_delete_tgt_after_iter(void);
+void RulesTransitive_this_var_tgt_2_pairs_1st_tgt_not_transitive(void);
 
 // Testsuite 'RulesComponentInheritance'
 void RulesComponentInheritance_1_ent_0_lvl(void);
@@ -1410,6 +1428,26 @@ void RulesTraversal_this_cascade_childof_w_parent_flag(void);
 void RulesTraversal_this_written_self_cascade_childof_w_parent_flag(void);
 void RulesTraversal_this_written_cascade_childof_w_parent_flag(void);
 
+// Testsuite 'RulesCached'
+void RulesCached_1_term(void);
+void RulesCached_2_terms(void);
+void RulesCached_add_to_matched_table(void);
+void RulesCached_new_table(void);
+void RulesCached_empty_table(void);
+void RulesCached_delete_table(void);
+void RulesCached_pair_var(void);
+void RulesCached_var_src(void);
+void RulesCached_fixed_src(void);
+void RulesCached_up(void);
+void RulesCached_inherited(void);
+void RulesCached_transitive(void);
+void RulesCached_set_var(void);
+void RulesCached_optional(void);
+void RulesCached_fini_while_deferred(void);
+void RulesCached_w_entity(void);
+void RulesCached_not_cacheable(void);
+void RulesCached_up_empty_table(void);
+
 // Testsuite 'SystemPeriodic'
 void SystemPeriodic_1_type_1_component(void);
 void SystemPeriodic_1_type_3_component(void);
@@ -1552,6 +1590,9 @@ void Stats_get_pipeline_stats_after_progress_2_systems_one_merge(void);
 void Stats_get_entity_count(void);
 void Stats_get_pipeline_stats_w_task_system(void);
 void Stats_get_not_alive_entity_count(void);
+void Stats_get_allocator_stats(void);
+void Stats_get_allocator_stats_twice(void);
+void Stats_get_allocator_world_stats(void);
 
 // Testsuite 'Run'
 void Run_setup(void);
@@ -1576,6 +1617,7 @@ void Run_run_comb_10_entities_1_type(void);
 void Run_run_comb_10_entities_2_types(void);
 void Run_run_w_interrupt(void);
 void Run_run_staging(void);
+void Run_run_worker_balanced(void);
 
 // Testsuite 'MultiThread'
 void MultiThread_setup(void);
@@ -1629,6 +1671,32 @@ void MultiThread_bulk_new_in_no_readonly_w_multithread(void);
 void MultiThread_bulk_new_in_no_readonly_w_multithread_2(void);
 void MultiThread_run_first_worker_on_main(void);
 void MultiThread_run_single_thread_on_main(void);
+void MultiThread_stealing_2_thread_1_entity(void);
+void MultiThread_stealing_2_thread_1000_entity(void);
+void MultiThread_stealing_6_thread_1000_entity(void);
+void MultiThread_stealing_6_thread_1000_entity_100_tables(void);
+void MultiThread_stealing_2_systems_in_op(void);
+void MultiThread_stealing_run_task_on_all_threads(void);
+void MultiThread_set_worker_sched_w_running_threads(void);
+void MultiThread_stealing_w_task_threads(void);
+void MultiThread_balanced_6_thread_1000_entity_100_tables(void);
+void MultiThread_balanced_2_systems_in_op(void);
+void MultiThread_stealing_run_independent_systems_in_parallel(void);
+void MultiThread_stealing_dependent_systems_in_op(void);
+void MultiThread_rematch_queries_in_parallel(void);
+void MultiThread_rematch_queries_in_parallel_after_merge(void);
+void MultiThread_rematch_queries_in_parallel_w_group_by(void);
+void MultiThread_parallel_merge_add(void);
+void MultiThread_parallel_merge_remove(void);
+void MultiThread_parallel_merge_set(void);
+void MultiThread_parallel_merge_w_on_add_observer(void);
+void MultiThread_parallel_merge_disabled(void);
+void MultiThread_parallel_merge_empty_table(void);
+void MultiThread_parallel_merge_w_delete(void);
+void MultiThread_parallel_merge_w_progress(void);
+void MultiThread_cmd_queue_multi_producer(void);
+void MultiThread_cmd_queue_multi_producer_wrap(void);
+void MultiThread_cmd_queue_drain_in_phase(void);
 
 // Testsuite 'MultiThreadStaging'
 void MultiThreadStaging_setup(void);
@@ -1800,6 +1868,8 @@ void Rest_request_commands_2_syncs(void);
 void Rest_request_commands_no_frames(void);
 void Rest_request_commands_no_commands(void);
 void Rest_request_commands_garbage_collect(void);
+void Rest_query_profile(void);
+void Rest_request_stats_allocators(void);
 
 // Testsuite 'Metrics'
 void Metrics_member_gauge_1_entity(void);
@@ -1878,6 +1948,20 @@ void Alerts_member_range_from_var_after_remove(void);
 void Alerts_retained_alert_w_dead_source(void);
 void Alerts_alert_counts(void);
 
+// Testsuite 'Recorder'
+void Recorder_record_add(void);
+void Recorder_record_remove(void);
+void Recorder_record_set(void);
+void Recorder_record_delete(void);
+void Recorder_record_pair(void);
+void Recorder_record_different_component_ids(void);
+void Recorder_record_new_w_name(void);
+void Recorder_record_observer_commands(void);
+void Recorder_record_frames(void);
+void Recorder_record_file(void);
+void Recorder_record_value_w_hooks(void);
+void Recorder_replay_invalid(void);
+
 bake_test_case Parser_testcases[] = {
     {
         "resolve_this",
@@ -5181,6 +5265,46 @@ bake_test_case RulesBasic_testcases[] = {
     {
         "1_plan_optional_any_src",
         RulesBasic_1_plan_optional_any_src
+    },
+    {
+        "planned_by_cardinality",
+        RulesBasic_planned_by_cardinality
+    },
+    {
+        "replan_after_cardinality_change",
+        RulesBasic_replan_after_cardinality_change
+    },
+    {
+        "no_replan_while_iterating",
+        RulesBasic_no_replan_while_iterating
+    },
+    {
+        "profile",
+        RulesBasic_profile
+    },
+    {
+        "profile_accumulate",
+        RulesBasic_profile_accumulate
+    },
+    {
+        "profile_iter_fini",
+        RulesBasic_profile_iter_fini
+    },
+    {
+        "fused_with_ids_plan",
+        RulesBasic_fused_with_ids_plan
+    },
+    {
+        "fused_self_up_with_ids_plan",
+        RulesBasic_fused_self_up_with_ids_plan
+    },
+    {
+        "fused_with_ids",
+        RulesBasic_fused_with_ids
+    },
+    {
+        "fused_self_up_with_ids",
+        RulesBasic_fused_self_up_with_ids
     }
 };
 
@@ -5832,6 +5956,22 @@ bake_test_case RulesVariables_testcases[] = {
     {
         "2_trivial_1_any_component",
         RulesVariables_2_trivial_1_any_component
+    },
+    {
+        "join_known_tgt",
+        RulesVariables_join_known_tgt
+    },
+    {
+        "join_known_tgt_w_component",
+        RulesVariables_join_known_tgt_w_component
+    },
+    {
+        "join_known_tgt_entity_moved",
+        RulesVariables_join_known_tgt_entity_moved
+    },
+    {
+        "no_join_few_probes",
+        RulesVariables_no_join_few_probes
     }
 };
 
@@ -6514,6 +6654,22 @@ bake_test_case RulesTransitive_testcases[] = {
     {
         "any_target",
         RulesTransitive_any_target
+    },
+    {
+        "1_this_src_add_after_iter",
+        RulesTransitive_1_this_src_add_after_iter
+    },
+    {
+        "1_this_src_remove_after_iter",
+        RulesTransitive_1_this_src_remove_after_iter
+    },
+    {
+        "1_this_src_delete_tgt_after_iter",
+        RulesTransitive_1_this_src_delete_tgt_after_iter
+    },
+    {
+        "this_var_tgt_2_pairs_1st_tgt_not_transitive",
+        RulesTransitive_this_var_tgt_2_pairs_1st_tgt_not_transitive
     }
 };
 
@@ -7416,6 +7572,81 @@ bake_test_case RulesTraversal_testcases[] = {
     }
 };
 
+bake_test_case RulesCached_testcases[] = {
+    {
+        "1_term",
+        RulesCached_1_term
+    },
+    {
+        "2_terms",
+        RulesCached_2_terms
+    },
+    {
+        "add_to_matched_table",
+        RulesCached_add_to_matched_table
+    },
+    {
+        "new_table",
+        RulesCached_new_table
+    },
+    {
+        "empty_table",
+        RulesCached_empty_table
+    },
+    {
+        "delete_table",
+        RulesCached_delete_table
+    },
+    {
+        "pair_var",
+        RulesCached_pair_var
+    },
+    {
+        "var_src",
+        RulesCached_var_src
+    },
+    {
+        "fixed_src",
+        RulesCached_fixed_src
+    },
+    {
+        "up",
+        RulesCached_up
+    },
+    {
+        "inherited",
+        RulesCached_inherited
+    },
+    {
+        "transitive",
+        RulesCached_transitive
+    },
+    {
+        "set_var",
+        RulesCached_set_var
+    },
+    {
+        "optional",
+        RulesCached_optional
+    },
+    {
+        "fini_while_deferred",
+        RulesCached_fini_while_deferred
+    },
+    {
+        "w_entity",
+        RulesCached_w_entity
+    },
+    {
+        "not_cacheable",
+        RulesCached_not_cacheable
+    },
+    {
+        "up_empty_table",
+        RulesCached_up_empty_table
+    }
+};
+
 bake_test_case SystemPeriodic_testcases[] = {
     {
         "1_type_1_component",
@@ -7927,6 +8158,18 @@ bake_test_case Stats_testcases[] = {
     {
         "get_not_alive_entity_count",
         Stats_get_not_alive_entity_count
+    },
+    {
+        "get_allocator_stats",
+        Stats_get_allocator_stats
+    },
+    {
+        "get_allocator_stats_twice",
+        Stats_get_allocator_stats_twice
+    },
+    {
+        "get_allocator_world_stats",
+        Stats_get_allocator_world_stats
     }
 };
 
@@ -8014,6 +8257,10 @@ bake_test_case Run_testcases[] = {
     {
         "run_staging",
         Run_run_staging
+    },
+    {
+        "run_worker_balanced",
+        Run_run_worker_balanced
     }
 };
 
@@ -8217,6 +8464,110 @@ bake_test_case MultiThread_testcases[] = {
     {
         "run_single_thread_on_main",
         MultiThread_run_single_thread_on_main
+    },
+    {
+        "stealing_2_thread_1_entity",
+        MultiThread_stealing_2_thread_1_entity
+    },
+    {
+        "stealing_2_thread_1000_entity",
+        MultiThread_stealing_2_thread_1000_entity
+    },
+    {
+        "stealing_6_thread_1000_entity",
+        MultiThread_stealing_6_thread_1000_entity
+    },
+    {
+        "stealing_6_thread_1000_entity_100_tables",
+        MultiThread_stealing_6_thread_1000_entity_100_tables
+    },
+    {
+        "stealing_2_systems_in_op",
+        MultiThread_stealing_2_systems_in_op
+    },
+    {
+        "stealing_run_task_on_all_threads",
+        MultiThread_stealing_run_task_on_all_threads
+    },
+    {
+        "set_worker_sched_w_running_threads",
+        MultiThread_set_worker_sched_w_running_threads
+    },
+    {
+        "stealing_w_task_threads",
+        MultiThread_stealing_w_task_threads
+    },
+    {
+        "balanced_6_thread_1000_entity_100_tables",
+        MultiThread_balanced_6_thread_1000_entity_100_tables
+    },
+    {
+        "balanced_2_systems_in_op",
+        MultiThread_balanced_2_systems_in_op
+    },
+    {
+        "stealing_run_independent_systems_in_parallel",
+        MultiThread_stealing_run_independent_systems_in_parallel
+    },
+    {
+        "stealing_dependent_systems_in_op",
+        MultiThread_stealing_dependent_systems_in_op
+    },
+    {
+        "rematch_queries_in_parallel",
+        MultiThread_rematch_queries_in_parallel
+    },
+    {
+        "rematch_queries_in_parallel_after_merge",
+        MultiThread_rematch_queries_in_parallel_after_merge
+    },
+    {
+        "rematch_queries_in_parallel_w_group_by",
+        MultiThread_rematch_queries_in_parallel_w_group_by
+    },
+    {
+        "parallel_merge_add",
+        MultiThread_parallel_merge_add
+    },
+    {
+        "parallel_merge_remove",
+        MultiThread_parallel_merge_remove
+    },
+    {
+        "parallel_merge_set",
+        MultiThread_parallel_merge_set
+    },
+    {
+        "parallel_merge_w_on_add_observer",
+        MultiThread_parallel_merge_w_on_add_observer
+    },
+    {
+        "parallel_merge_disabled",
+        MultiThread_parallel_merge_disabled
+    },
+    {
+        "parallel_merge_empty_table",
+        MultiThread_parallel_merge_empty_table
+    },
+    {
+        "parallel_merge_w_delete",
+        MultiThread_parallel_merge_w_delete
+    },
+    {
+        "parallel_merge_w_progress",
+        MultiThread_parallel_merge_w_progress
+    },
+    {
+        "cmd_queue_multi_producer",
+        MultiThread_cmd_queue_multi_producer
+    },
+    {
+        "cmd_queue_multi_producer_wrap",
+        MultiThread_cmd_queue_multi_producer_wrap
+    },
+    {
+        "cmd_queue_drain_in_phase",
+        MultiThread_cmd_queue_drain_in_phase
     }
 };
 
@@ -8845,6 +9196,14 @@ bake_test_case Rest_testcases[] = {
     {
         "request_commands_garbage_collect",
         Rest_request_commands_garbage_collect
+    },
+    {
+        "query_profile",
+        Rest_query_profile
+    },
+    {
+        "request_stats_allocators",
+        Rest_request_stats_allocators
     }
 };
 
@@ -9147,6 +9506,57 @@ bake_test_case Alerts_testcases[] = {
 };
 
 
+bake_test_case Recorder_testcases[] = {
+    {
+        "record_add",
+        Recorder_record_add
+    },
+    {
+        "record_remove",
+        Recorder_record_remove
+    },
+    {
+        "record_set",
+        Recorder_record_set
+    },
+    {
+        "record_delete",
+        Recorder_record_delete
+    },
+    {
+        "record_pair",
+        Recorder_record_pair
+    },
+    {
+        "record_different_component_ids",
+        Recorder_record_different_component_ids
+    },
+    {
+        "record_new_w_name",
+        Recorder_record_new_w_name
+    },
+    {
+        "record_observer_commands",
+        Recorder_record_observer_commands
+    },
+    {
+        "record_frames",
+        Recorder_record_frames
+    },
+    {
+        "record_file",
+        Recorder_record_file
+    },
+    {
+        "record_value_w_hooks",
+        Recorder_record_value_w_hooks
+    },
+    {
+        "replay_invalid",
+        Recorder_replay_invalid
+    }
+};
+
 static bake_test_suite suites[] = {
     {
         "Parser",
@@ -9187,14 +9597,14 @@ static bake_test_suite suites[] = {
         "RulesBasic",
         NULL,
         NULL,
-        164,
+        174,
         RulesBasic_testcases
     },
     {
         "RulesVariables",
         NULL,
         NULL,
-        162,
+        166,
         RulesVariables_testcases
     },
     {
@@ -9208,7 +9618,7 @@ static bake_test_suite suites[] = {
         "RulesTransitive",
         NULL,
         NULL,
-        64,
+        68,
         RulesTransitive_testcases
     },
     {
@@ -9246,6 +9656,13 @@ static bake_test_suite suites[] = {
         93,
         RulesTraversal_testcases
     },
+    {
+        "RulesCached",
+        NULL,
+        NULL,
+        18,
+        RulesCached_testcases
+    },
     {
         "SystemPeriodic",
         NULL,
@@ -9313,21 +9730,21 @@ static bake_test_suite suites[] = {
         "Stats",
         NULL,
         NULL,
-        11,
+        14,
         Stats_testcases
     },
     {
         "Run",
         Run_setup,
         NULL,
-        21,
+        22,
         Run_testcases
     },
     {
         "MultiThread",
         MultiThread_setup,
         NULL,
-        50,
+        76,
         MultiThread_testcases
     },
     {
@@ -9383,7 +9800,7 @@ static bake_test_suite suites[] = {
         "Rest",
         NULL,
         NULL,
-        13,
+        15,
         Rest_testcases
     },
     {
@@ -9399,9 +9816,16 @@ static bake_test_suite suites[] = {
         NULL,
         36,
         Alerts_testcases
+    },
+    {
+        "Recorder",
+        NULL,
+        NULL,
+        12,
+        Recorder_testcases
     }
 };
 
 int main(int argc, char *argv[]) {
-    return bake_test_run("addons", argc, argv, suites, 36);
+    return bake_test_run("addons", argc, argv, suites, 38);
 }
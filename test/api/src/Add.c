@@ -411,3 +411,201 @@ void Add_add_random_id(void) {
 
     ecs_fini(world);
 }
+
+static int bulk_add_invoked = 0;
+static int bulk_add_count = 0;
+
+static void BulkOnAdd(ecs_iter_t *it) {
+    bulk_add_invoked ++;
+    bulk_add_count += it->count;
+}
+
+void Add_bulk_add_id_table(void) {
+    ecs_world_t *world = ecs_mini();
+
+    ECS_COMPONENT(world, Position);
+    ECS_COMPONENT(world, Velocity);
+
+    ecs_entity_t e[4];
+    int i;
+    for (i = 0; i < 4; i ++) {
+        e[i] = ecs_set(world, 0, Position, {i, i * 2});
+    }
+
+    ecs_table_t *table = ecs_get_table(world, e[0]);
+    ecs_bulk_add_id(world, table, 0, 0, ecs_id(Velocity));
+    test_int(ecs_table_count(table), 0);
+
+    ecs_table_t *dst = ecs_get_table(world, e[0]);
+    test_assert(dst != table);
+    test_int(ecs_table_count(dst), 4);
+
+    for (i = 0; i < 4; i ++) {
+        test_assert(ecs_get_table(world, e[i]) == dst);
+        test_assert(ecs_has(world, e[i], Velocity));
+        const Position *p = ecs_get(world, e[i], Position);
+        test_assert(p != NULL);
+        test_int(p->x, i);
+        test_int(p->y, i * 2);
+    }
+
+    ecs_fini(world);
+}
+
+void Add_bulk_add_id_range(void) {
+    ecs_world_t *world = ecs_mini();
+
+    ECS_COMPONENT(world, Position);
+    ECS_TAG(world, Tag);
+
+    ecs_entity_t e[6];
+    int i;
+    for (i = 0; i < 6; i ++) {
+        e[i] = ecs_set(world, 0, Position, {i, i * 2});
+    }
+
+    ecs_table_t *table = ecs_get_table(world, e[0]);
+    ecs_bulk_add_id(world, table, 1, 2, Tag);
+    test_int(ecs_table_count(table), 4);
+
+    for (i = 0; i < 6; i ++) {
+        test_bool(ecs_has(world, e[i], Tag), i == 1 || i == 2);
+        const Position *p = ecs_get(world, e[i], Position);
+        test_assert(p != NULL);
+        test_int(p->x, i);
+        test_int(p->y, i * 2);
+    }
+
+    ecs_fini(world);
+}
+
+void Add_bulk_add_id_w_hooks(void) {
+    ecs_world_t *world = ecs_mini();
+
+    ECS_COMPONENT(world, Position);
+    ECS_COMPONENT(world, Velocity);
+
+    ecs_observer(world, {
+        .filter.terms = {{ ecs_id(Velocity) }},
+        .events = { EcsOnAdd },
+        .callback = BulkOnAdd
+    });
+
+    ecs_entity_t e[4];
+    int i;
+    for (i = 0; i < 4; i ++) {
+        e[i] = ecs_new(world, Position);
+    }
+
+    ecs_table_t *table = ecs_get_table(world, e[0]);
+    ecs_bulk_add_id(world, table, 0, 3, ecs_id(Velocity));
+
+    /* Range is emitted as a single event */
+    test_int(bulk_add_invoked, 1);
+    test_int(bulk_add_count, 3);
+
+    ecs_bulk_add_id(world, table, 0, 1, ecs_id(Velocity));
+    test_int(bulk_add_invoked, 2);
+    test_int(bulk_add_count, 4);
+
+    for (i = 0; i < 4; i ++) {
+        test_assert(ecs_has(world, e[i], Velocity));
+    }
+
+    ecs_fini(world);
+}
+
+void Add_bulk_add_id_deferred(void) {
+    ecs_world_t *world = ecs_mini();
+
+    ECS_COMPONENT(world, Position);
+    ECS_TAG(world, Tag);
+
+    ecs_entity_t e1 = ecs_new(world, Position);
+    ecs_entity_t e2 = ecs_new(world, Position);
+    ecs_table_t *table = ecs_get_table(world, e1);
+
+    ecs_defer_begin(world);
+    ecs_bulk_add_id(world, table, 0, 0, Tag);
+    test_assert(!ecs_has(world, e1, Tag));
+    test_assert(!ecs_has(world, e2, Tag));
+    ecs_defer_end(world);
+
+    test_assert(ecs_has(world, e1, Tag));
+    test_assert(ecs_has(world, e2, Tag));
+
+    ecs_fini(world);
+}
+
+void Add_iter_add_id(void) {
+    ecs_world_t *world = ecs_mini();
+
+    ECS_COMPONENT(world, Position);
+    ECS_COMPONENT(world, Velocity);
+    ECS_TAG(world, Tag);
+
+    ecs_entity_t e1 = ecs_set(world, 0, Position, {10, 20});
+    ecs_entity_t e2 = ecs_set(world, 0, Position, {30, 40});
+    ecs_entity_t e3 = ecs_set(world, 0, Position, {50, 60});
+    ecs_set(world, e3, Velocity, {1, 2});
+    ecs_entity_t e4 = ecs_new(world, Velocity);
+
+    ecs_filter_t *f = ecs_filter(world, {
+        .terms = {{ ecs_id(Position) }}
+    });
+    test_assert(f != NULL);
+
+    ecs_iter_t it = ecs_filter_iter(world, f);
+    ecs_iter_add_id(&it, Tag);
+
+    test_assert(ecs_has(world, e1, Tag));
+    test_assert(ecs_has(world, e2, Tag));
+    test_assert(ecs_has(world, e3, Tag));
+    test_assert(!ecs_has(world, e4, Tag));
+
+    const Position *p = ecs_get(world, e2, Position);
+    test_int(p->x, 30);
+    test_int(p->y, 40);
+    p = ecs_get(world, e3, Position);
+    test_int(p->x, 50);
+    test_int(p->y, 60);
+    const Velocity *v = ecs_get(world, e3, Velocity);
+    test_int(v->x, 1);
+    test_int(v->y, 2);
+
+    ecs_filter_fini(f);
+
+    ecs_fini(world);
+}
+
+void Add_iter_add_id_w_query(void) {
+    ecs_world_t *world = ecs_mini();
+
+    ECS_COMPONENT(world, Position);
+    ECS_TAG(world, Tag);
+    ECS_TAG(world, Foo);
+
+    ecs_query_t *q = ecs_query(world, {
+        .filter.terms = {{ ecs_id(Position) }, { Tag, .oper = EcsNot }}
+    });
+    test_assert(q != NULL);
+
+    ecs_entity_t e1 = ecs_new(world, Position);
+    ecs_entity_t e2 = ecs_new(world, Position);
+    ecs_entity_t e3 = ecs_new(world, Position);
+    ecs_add(world, e3, Foo);
+
+    ecs_iter_t it = ecs_query_iter(world, q);
+    ecs_iter_add_id(&it, Tag);
+
+    test_assert(ecs_has(world, e1, Tag));
+    test_assert(ecs_has(world, e2, Tag));
+    test_assert(ecs_has(world, e3, Tag));
+
+    it = ecs_query_iter(world, q);
+    test_bool(false, ecs_query_next(&it));
+
+    ecs_query_fini(q);
+
+    ecs_fini(world);
+}
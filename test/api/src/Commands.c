@@ -3925,3 +3925,753 @@ void Commands_add_path_nested_to_created_deleted_parent_w_stage(void) {
 
     ecs_fini(world);
 }
+
+void Commands_combined_merge_2_stages(void) {
+    ecs_world_t *world = ecs_mini();
+
+    ECS_COMPONENT(world, Position);
+    ECS_COMPONENT(world, Velocity);
+
+    ecs_set_stage_count(world, 2);
+    ecs_set_combined_merge(world, true);
+
+    ecs_entity_t e = ecs_new_id(world);
+    const ecs_world_info_t *info = ecs_get_world_info(world);
+    int64_t batched_entity_count = info->cmd.batched_entity_count;
+
+    ecs_readonly_begin(world, true);
+    ecs_world_t *s0 = ecs_get_stage(world, 0);
+    ecs_world_t *s1 = ecs_get_stage(world, 1);
+    ecs_set(s0, e, Position, {10, 20});
+    ecs_set(s1, e, Velocity, {1, 2});
+    test_assert(!ecs_has(world, e, Position));
+    test_assert(!ecs_has(world, e, Velocity));
+    ecs_readonly_end(world);
+
+    /* Commands of both stages are batched for the entity */
+    test_int(info->cmd.batched_entity_count - batched_entity_count, 1);
+
+    const Position *p = ecs_get(world, e, Position);
+    test_assert(p != NULL);
+    test_int(p->x, 10);
+    test_int(p->y, 20);
+
+    const Velocity *v = ecs_get(world, e, Velocity);
+    test_assert(v != NULL);
+    test_int(v->x, 1);
+    test_int(v->y, 2);
+
+    ecs_fini(world);
+}
+
+void Commands_combined_merge_disabled(void) {
+    ecs_world_t *world = ecs_mini();
+
+    ECS_COMPONENT(world, Position);
+    ECS_COMPONENT(world, Velocity);
+
+    ecs_set_stage_count(world, 2);
+
+    ecs_entity_t e = ecs_new_id(world);
+    const ecs_world_info_t *info = ecs_get_world_info(world);
+    int64_t batched_entity_count = info->cmd.batched_entity_count;
+
+    ecs_readonly_begin(world, true);
+    ecs_world_t *s0 = ecs_get_stage(world, 0);
+    ecs_world_t *s1 = ecs_get_stage(world, 1);
+    ecs_set(s0, e, Position, {10, 20});
+    ecs_set(s1, e, Velocity, {1, 2});
+    ecs_readonly_end(world);
+
+    /* Each stage has a single command for the entity, nothing is batched */
+    test_int(info->cmd.batched_entity_count - batched_entity_count, 0);
+    test_assert(ecs_has(world, e, Position));
+    test_assert(ecs_has(world, e, Velocity));
+
+    ecs_fini(world);
+}
+
+void Commands_combined_merge_stage_order(void) {
+    ecs_world_t *world = ecs_mini();
+
+    ECS_COMPONENT(world, Position);
+    ECS_TAG(world, TagA);
+    ECS_TAG(world, TagB);
+
+    ecs_set_stage_count(world, 3);
+    ecs_set_combined_merge(world, true);
+
+    ecs_entity_t e1 = ecs_new(world, TagB);
+    ecs_entity_t e2 = ecs_new_id(world);
+
+    ecs_readonly_begin(world, true);
+    ecs_world_t *s0 = ecs_get_stage(world, 0);
+    ecs_world_t *s1 = ecs_get_stage(world, 1);
+    ecs_world_t *s2 = ecs_get_stage(world, 2);
+
+    /* Commands for the same entity are applied in stage order */
+    ecs_set(s2, e1, Position, {30, 40});
+    ecs_set(s0, e1, Position, {10, 20});
+    ecs_remove(s1, e1, TagA);
+    ecs_add(s0, e1, TagA);
+    ecs_add(s2, e1, TagB);
+    ecs_remove(s1, e1, TagB);
+
+    ecs_add(s1, e2, TagA);
+    ecs_set(s1, e2, Position, {50, 60});
+    ecs_remove(s2, e2, TagA);
+    ecs_readonly_end(world);
+
+    const Position *p = ecs_get(world, e1, Position);
+    test_assert(p != NULL);
+    test_int(p->x, 30);
+    test_int(p->y, 40);
+    test_assert(!ecs_has(world, e1, TagA));
+    test_assert(ecs_has(world, e1, TagB));
+
+    p = ecs_get(world, e2, Position);
+    test_assert(p != NULL);
+    test_int(p->x, 50);
+    test_int(p->y, 60);
+    test_assert(!ecs_has(world, e2, TagA));
+
+    ecs_fini(world);
+}
+
+void Commands_combined_merge_delete_in_other_stage(void) {
+    ecs_world_t *world = ecs_mini();
+
+    ECS_COMPONENT(world, Position);
+
+    ecs_set_stage_count(world, 2);
+    ecs_set_combined_merge(world, true);
+
+    ecs_entity_t e1 = ecs_new_id(world);
+    ecs_entity_t e2 = ecs_new_id(world);
+
+    ecs_readonly_begin(world, true);
+    ecs_world_t *s0 = ecs_get_stage(world, 0);
+    ecs_world_t *s1 = ecs_get_stage(world, 1);
+    ecs_set(s0, e1, Position, {10, 20});
+    ecs_delete(s1, e1);
+    ecs_set(s0, e2, Position, {10, 20});
+    ecs_readonly_end(world);
+
+    test_assert(!ecs_is_alive(world, e1));
+    test_assert(ecs_is_alive(world, e2));
+    test_assert(ecs_has(world, e2, Position));
+
+    ecs_fini(world);
+}
+
+void Commands_combined_merge_no_automerge_stage(void) {
+    ecs_world_t *world = ecs_mini();
+
+    ECS_COMPONENT(world, Position);
+    ECS_COMPONENT(world, Velocity);
+
+    ecs_set_stage_count(world, 2);
+    ecs_set_combined_merge(world, true);
+
+    ecs_entity_t e = ecs_new_id(world);
+
+    ecs_world_t *s1 = ecs_get_stage(world, 1);
+    ecs_set_automerge(s1, false);
+
+    ecs_readonly_begin(world, true);
+    ecs_world_t *s0 = ecs_get_stage(world, 0);
+    ecs_set(s0, e, Position, {10, 20});
+    ecs_set(s1, e, Velocity, {1, 2});
+    ecs_readonly_end(world);
+
+    test_assert(ecs_has(world, e, Position));
+    test_assert(!ecs_has(world, e, Velocity));
+
+    ecs_merge(s1);
+    test_assert(ecs_has(world, e, Velocity));
+
+    ecs_fini(world);
+}
+
+void Commands_combined_merge_repeated(void) {
+    ecs_world_t *world = ecs_mini();
+
+    ECS_COMPONENT(world, Position);
+
+    ecs_set_stage_count(world, 2);
+    ecs_set_combined_merge(world, true);
+
+    ecs_entity_t e = ecs_new_id(world);
+
+    int32_t i;
+    for (i = 0; i < 5; i ++) {
+        ecs_readonly_begin(world, true);
+        ecs_world_t *s0 = ecs_get_stage(world, 0);
+        ecs_world_t *s1 = ecs_get_stage(world, 1);
+        ecs_set(s0, e, Position, {i, i});
+        ecs_set(s1, e, Position, {i + 10, i + 10});
+        ecs_readonly_end(world);
+
+        const Position *p = ecs_get(world, e, Position);
+        test_assert(p != NULL);
+        test_int(p->x, i + 10);
+        test_int(p->y, i + 10);
+    }
+
+    ecs_fini(world);
+}
+
+void Commands_cmd_queue_add(void) {
+    ecs_world_t *world = ecs_mini();
+
+    ECS_TAG(world, Tag);
+
+    ecs_entity_t e = ecs_new_id(world);
+
+    ecs_cmd_queue_t *q = ecs_cmd_queue_new(world, NULL);
+    test_assert(q != NULL);
+
+    test_bool(true, ecs_cmd_queue_add(q, e, Tag));
+    test_assert(!ecs_has(world, e, Tag));
+
+    test_int(1, ecs_cmd_queue_drain(world, q));
+    test_assert(ecs_has(world, e, Tag));
+
+    test_int(0, ecs_cmd_queue_drain(world, q));
+
+    ecs_cmd_queue_free(q);
+
+    ecs_fini(world);
+}
+
+void Commands_cmd_queue_remove(void) {
+    ecs_world_t *world = ecs_mini();
+
+    ECS_TAG(world, Tag);
+
+    ecs_entity_t e = ecs_new(world, Tag);
+
+    ecs_cmd_queue_t *q = ecs_cmd_queue_new(world, NULL);
+    test_bool(true, ecs_cmd_queue_remove(q, e, Tag));
+    test_assert(ecs_has(world, e, Tag));
+
+    test_int(1, ecs_cmd_queue_drain(world, q));
+    test_assert(!ecs_has(world, e, Tag));
+
+    ecs_cmd_queue_free(q);
+
+    ecs_fini(world);
+}
+
+void Commands_cmd_queue_set(void) {
+    ecs_world_t *world = ecs_mini();
+
+    ECS_COMPONENT(world, Position);
+
+    ecs_entity_t e = ecs_new_id(world);
+
+    ecs_cmd_queue_t *q = ecs_cmd_queue_new(world, NULL);
+    Position p = {10, 20};
+    test_bool(true, ecs_cmd_queue_set(q, e, ecs_id(Position), 
+        sizeof(Position), &p));
+    p.x = 30; /* Value is copied */
+
+    test_int(1, ecs_cmd_queue_drain(world, q));
+
+    const Position *ptr = ecs_get(world, e, Position);
+    test_assert(ptr != NULL);
+    test_int(ptr->x, 10);
+    test_int(ptr->y, 20);
+
+    ecs_cmd_queue_free(q);
+
+    ecs_fini(world);
+}
+
+typedef struct LargeValue {
+    int32_t values[64];
+} LargeValue;
+
+void Commands_cmd_queue_set_large_value(void) {
+    ecs_world_t *world = ecs_mini();
+
+    ECS_COMPONENT(world, LargeValue);
+
+    ecs_entity_t e = ecs_new_id(world);
+
+    ecs_cmd_queue_t *q = ecs_cmd_queue_new(world, &(ecs_cmd_queue_desc_t){
+        .value_size = 16
+    });
+
+    LargeValue v;
+    int32_t i;
+    for (i = 0; i < 64; i ++) {
+        v.values[i] = i;
+    }
+
+    test_bool(true, ecs_cmd_queue_set(q, e, ecs_id(LargeValue), 
+        sizeof(LargeValue), &v));
+    test_int(1, ecs_cmd_queue_drain(world, q));
+
+    const LargeValue *ptr = ecs_get(world, e, LargeValue);
+    test_assert(ptr != NULL);
+    for (i = 0; i < 64; i ++) {
+        test_int(ptr->values[i], i);
+    }
+
+    ecs_cmd_queue_free(q);
+
+    ecs_fini(world);
+}
+
+void Commands_cmd_queue_delete(void) {
+    ecs_world_t *world = ecs_mini();
+
+    ECS_TAG(world, Tag);
+
+    ecs_entity_t e = ecs_new(world, Tag);
+
+    ecs_cmd_queue_t *q = ecs_cmd_queue_new(world, NULL);
+    test_bool(true, ecs_cmd_queue_delete(q, e));
+    test_bool(true, ecs_cmd_queue_add(q, e, Tag));
+    test_assert(ecs_is_alive(world, e));
+
+    test_int(2, ecs_cmd_queue_drain(world, q));
+    test_assert(!ecs_is_alive(world, e));
+
+    ecs_cmd_queue_free(q);
+
+    ecs_fini(world);
+}
+
+static int cmd_queue_event_invoked = 0;
+
+static void CmdQueueEvent(ecs_iter_t *it) {
+    test_int(it->count, 1);
+    cmd_queue_event_invoked ++;
+}
+
+void Commands_cmd_queue_emit(void) {
+    ecs_world_t *world = ecs_mini();
+
+    ECS_TAG(world, Tag);
+    ECS_TAG(world, Evt);
+
+    ecs_observer(world, {
+        .filter.terms = {{ Tag }},
+        .events = { Evt },
+        .callback = CmdQueueEvent
+    });
+
+    ecs_entity_t e = ecs_new(world, Tag);
+
+    ecs_cmd_queue_t *q = ecs_cmd_queue_new(world, NULL);
+    test_bool(true, ecs_cmd_queue_emit(q, Evt, e, Tag));
+    test_int(cmd_queue_event_invoked, 0);
+
+    test_int(1, ecs_cmd_queue_drain(world, q));
+    test_int(cmd_queue_event_invoked, 1);
+
+    ecs_cmd_queue_free(q);
+
+    ecs_fini(world);
+}
+
+void Commands_cmd_queue_full(void) {
+    ecs_world_t *world = ecs_mini();
+
+    ECS_TAG(world, TagA);
+    ECS_TAG(world, TagB);
+    ECS_TAG(world, TagC);
+
+    ecs_entity_t e = ecs_new_id(world);
+
+    ecs_cmd_queue_t *q = ecs_cmd_queue_new(world, &(ecs_cmd_queue_desc_t){
+        .capacity = 2
+    });
+
+    test_bool(true, ecs_cmd_queue_add(q, e, TagA));
+    test_bool(true, ecs_cmd_queue_add(q, e, TagB));
+    test_bool(false, ecs_cmd_queue_add(q, e, TagC));
+
+    test_int(2, ecs_cmd_queue_drain(world, q));
+    test_assert(ecs_has(world, e, TagA));
+    test_assert(ecs_has(world, e, TagB));
+    test_assert(!ecs_has(world, e, TagC));
+
+    /* Slots can be reused after drain */
+    test_bool(true, ecs_cmd_queue_add(q, e, TagC));
+    test_int(1, ecs_cmd_queue_drain(world, q));
+    test_assert(ecs_has(world, e, TagC));
+
+    ecs_cmd_queue_free(q);
+
+    ecs_fini(world);
+}
+
+void Commands_cmd_queue_not_alive(void) {
+    ecs_world_t *world = ecs_mini();
+
+    ECS_TAG(world, Tag);
+
+    ecs_entity_t e = ecs_new_id(world);
+    ecs_delete(world, e);
+
+    ecs_cmd_queue_t *q = ecs_cmd_queue_new(world, NULL);
+    test_bool(true, ecs_cmd_queue_add(q, e, Tag));
+
+    test_int(1, ecs_cmd_queue_drain(world, q));
+    test_assert(!ecs_is_alive(world, e));
+
+    ecs_cmd_queue_free(q);
+
+    ecs_fini(world);
+}
+
+void Commands_cmd_queue_drain_deferred(void) {
+    ecs_world_t *world = ecs_mini();
+
+    ECS_COMPONENT(world, Position);
+    ECS_TAG(world, Tag);
+
+    ecs_entity_t e = ecs_new_id(world);
+
+    ecs_cmd_queue_t *q = ecs_cmd_queue_new(world, NULL);
+    test_bool(true, ecs_cmd_queue_add(q, e, Tag));
+    test_bool(true, ecs_cmd_queue_set(q, e, ecs_id(Position),
+        sizeof(Position), &(Position){10, 20}));
+
+    ecs_defer_begin(world);
+    test_int(2, ecs_cmd_queue_drain(world, q));
+    test_assert(!ecs_has(world, e, Tag));
+    test_assert(!ecs_has(world, e, Position));
+    ecs_defer_end(world);
+
+    test_assert(ecs_has(world, e, Tag));
+    const Position *p = ecs_get(world, e, Position);
+    test_assert(p != NULL);
+    test_int(p->x, 10);
+    test_int(p->y, 20);
+
+    ecs_cmd_queue_free(q);
+
+    ecs_fini(world);
+}
+
+void Commands_cmd_queue_free_not_drained(void) {
+    ecs_world_t *world = ecs_mini();
+
+    ECS_COMPONENT(world, LargeValue);
+
+    ecs_entity_t e = ecs_new_id(world);
+
+    ecs_cmd_queue_t *q = ecs_cmd_queue_new(world, &(ecs_cmd_queue_desc_t){
+        .value_size = 16
+    });
+
+    LargeValue v = {{0}};
+    test_bool(true, ecs_cmd_queue_set(q, e, ecs_id(LargeValue), 
+        sizeof(LargeValue), &v));
+
+    ecs_cmd_queue_free(q);
+    test_assert(!ecs_has(world, e, LargeValue));
+
+    ecs_fini(world);
+}
+
+static int merge_on_set_invoked = 0;
+static int merge_on_set_count = 0;
+
+static void MergeOnSet(ecs_iter_t *it) {
+    merge_on_set_invoked ++;
+    merge_on_set_count += it->count;
+}
+
+void Commands_merge_on_set_batched(void) {
+    ecs_world_t *world = ecs_mini();
+
+    ECS_COMPONENT(world, Position);
+
+    ecs_observer(world, {
+        .filter.terms = {{ ecs_id(Position) }},
+        .events = { EcsOnSet },
+        .callback = MergeOnSet
+    });
+
+    ecs_entity_t e[10];
+    int32_t i;
+    for (i = 0; i < 10; i ++) {
+        e[i] = ecs_new_id(world);
+    }
+
+    ecs_defer_begin(world);
+    for (i = 0; i < 10; i ++) {
+        ecs_set(world, e[i], Position, {i, i});
+    }
+    test_int(merge_on_set_invoked, 0);
+    ecs_defer_end(world);
+
+    test_int(merge_on_set_invoked, 1);
+    test_int(merge_on_set_count, 10);
+
+    for (i = 0; i < 10; i ++) {
+        const Position *p = ecs_get(world, e[i], Position);
+        test_assert(p != NULL);
+        test_int(p->x, i);
+        test_int(p->y, i);
+    }
+
+    ecs_fini(world);
+}
+
+void Commands_merge_on_set_batched_existing(void) {
+    ecs_world_t *world = ecs_mini();
+
+    ECS_COMPONENT(world, Position);
+
+    ecs_entity_t e[10];
+    int32_t i;
+    for (i = 0; i < 10; i ++) {
+        e[i] = ecs_set(world, 0, Position, {0, 0});
+    }
+
+    ecs_observer(world, {
+        .filter.terms = {{ ecs_id(Position) }},
+        .events = { EcsOnSet },
+        .callback = MergeOnSet
+    });
+
+    ecs_defer_begin(world);
+    for (i = 0; i < 10; i ++) {
+        ecs_set(world, e[i], Position, {i, i});
+    }
+    ecs_defer_end(world);
+
+    test_int(merge_on_set_invoked, 1);
+    test_int(merge_on_set_count, 10);
+
+    ecs_defer_begin(world);
+    for (i = 0; i < 10; i ++) {
+        ecs_modified(world, e[i], Position);
+    }
+    ecs_defer_end(world);
+
+    test_int(merge_on_set_invoked, 2);
+    test_int(merge_on_set_count, 20);
+
+    ecs_fini(world);
+}
+
+void Commands_merge_on_set_not_contiguous(void) {
+    ecs_world_t *world = ecs_mini();
+
+    ECS_COMPONENT(world, Position);
+
+    ecs_entity_t e[4];
+    int32_t i;
+    for (i = 0; i < 4; i ++) {
+        e[i] = ecs_set(world, 0, Position, {0, 0});
+    }
+
+    ecs_observer(world, {
+        .filter.terms = {{ ecs_id(Position) }},
+        .events = { EcsOnSet },
+        .callback = MergeOnSet
+    });
+
+    ecs_defer_begin(world);
+    for (i = 3; i >= 0; i --) {
+        ecs_set(world, e[i], Position, {i, i});
+    }
+    ecs_defer_end(world);
+
+    test_int(merge_on_set_invoked, 4);
+    test_int(merge_on_set_count, 4);
+
+    for (i = 0; i < 4; i ++) {
+        const Position *p = ecs_get(world, e[i], Position);
+        test_int(p->x, i);
+        test_int(p->y, i);
+    }
+
+    ecs_fini(world);
+}
+
+void Commands_merge_on_set_different_tables(void) {
+    ecs_world_t *world = ecs_mini();
+
+    ECS_COMPONENT(world, Position);
+    ECS_TAG(world, Tag);
+
+    ecs_entity_t e1 = ecs_set(world, 0, Position, {0, 0});
+    ecs_entity_t e2 = ecs_set(world, 0, Position, {0, 0});
+    ecs_add(world, e2, Tag);
+    ecs_entity_t e3 = ecs_set(world, 0, Position, {0, 0});
+    ecs_add(world, e3, Tag);
+
+    ecs_observer(world, {
+        .filter.terms = {{ ecs_id(Position) }},
+        .events = { EcsOnSet },
+        .callback = MergeOnSet
+    });
+
+    ecs_defer_begin(world);
+    ecs_set(world, e1, Position, {1, 2});
+    ecs_set(world, e2, Position, {3, 4});
+    ecs_set(world, e3, Position, {5, 6});
+    ecs_defer_end(world);
+
+    test_int(merge_on_set_invoked, 2);
+    test_int(merge_on_set_count, 3);
+
+    ecs_fini(world);
+}
+
+void Commands_merge_on_set_collapse_duplicate(void) {
+    ecs_world_t *world = ecs_mini();
+
+    ECS_COMPONENT(world, Position);
+
+    ecs_observer(world, {
+        .filter.terms = {{ ecs_id(Position) }},
+        .events = { EcsOnSet },
+        .callback = MergeOnSet
+    });
+
+    ecs_entity_t e = ecs_new_id(world);
+
+    ecs_defer_begin(world);
+    ecs_set(world, e, Position, {10, 20});
+    ecs_set(world, e, Position, {30, 40});
+    ecs_modified(world, e, Position);
+    ecs_defer_end(world);
+
+    test_int(merge_on_set_invoked, 1);
+    test_int(merge_on_set_count, 1);
+
+    const Position *p = ecs_get(world, e, Position);
+    test_assert(p != NULL);
+    test_int(p->x, 30);
+    test_int(p->y, 40);
+
+    ecs_fini(world);
+}
+
+static int merge_on_set_hook_invoked = 0;
+
+static void MergeOnSetHook(ecs_iter_t *it) {
+    merge_on_set_hook_invoked += it->count;
+}
+
+void Commands_merge_on_set_collapse_duplicate_w_hook(void) {
+    ecs_world_t *world = ecs_mini();
+
+    ECS_COMPONENT(world, Position);
+
+    ecs_set_hooks(world, Position, {
+        .on_set = MergeOnSetHook
+    });
+
+    ecs_observer(world, {
+        .filter.terms = {{ ecs_id(Position) }},
+        .events = { EcsOnSet },
+        .callback = MergeOnSet
+    });
+
+    ecs_entity_t e1 = ecs_new_id(world);
+    ecs_entity_t e2 = ecs_new_id(world);
+
+    ecs_defer_begin(world);
+    ecs_set(world, e1, Position, {10, 20});
+    ecs_set(world, e1, Position, {30, 40});
+    ecs_set(world, e2, Position, {50, 60});
+    ecs_defer_end(world);
+
+    test_int(merge_on_set_hook_invoked, 2);
+    test_int(merge_on_set_invoked, 1);
+    test_int(merge_on_set_count, 2);
+
+    const Position *p = ecs_get(world, e1, Position);
+    test_int(p->x, 30);
+    test_int(p->y, 40);
+
+    ecs_fini(world);
+}
+
+void Commands_merge_on_set_w_delete(void) {
+    ecs_world_t *world = ecs_mini();
+
+    ECS_COMPONENT(world, Position);
+
+    ecs_observer(world, {
+        .filter.terms = {{ ecs_id(Position) }},
+        .events = { EcsOnSet },
+        .callback = MergeOnSet
+    });
+
+    ecs_entity_t e1 = ecs_new_id(world);
+    ecs_entity_t e2 = ecs_new_id(world);
+    ecs_entity_t e3 = ecs_new_id(world);
+
+    ecs_defer_begin(world);
+    ecs_set(world, e1, Position, {10, 20});
+    ecs_set(world, e2, Position, {30, 40});
+    ecs_delete(world, e1);
+    ecs_set(world, e3, Position, {50, 60});
+    ecs_defer_end(world);
+
+    /* Notifications are sent before the delete is executed */
+    test_int(merge_on_set_invoked, 2);
+    test_int(merge_on_set_count, 3);
+
+    test_assert(!ecs_is_alive(world, e1));
+    test_assert(ecs_has(world, e2, Position));
+    test_assert(ecs_has(world, e3, Position));
+
+    ecs_fini(world);
+}
+
+static ecs_entity_t merge_on_add_remove_from = 0;
+static ecs_id_t merge_on_add_remove_id = 0;
+
+static void MergeOnAddRemove(ecs_iter_t *it) {
+    ecs_remove_id(it->world, merge_on_add_remove_from, merge_on_add_remove_id);
+}
+
+void Commands_merge_on_set_entity_moved_by_observer(void) {
+    ecs_world_t *world = ecs_mini();
+
+    ECS_COMPONENT(world, Position);
+    ECS_TAG(world, Tag);
+
+    ecs_observer(world, {
+        .filter.terms = {{ ecs_id(Position) }},
+        .events = { EcsOnSet },
+        .callback = MergeOnSet
+    });
+
+    ecs_observer(world, {
+        .filter.terms = {{ Tag }},
+        .events = { EcsOnAdd },
+        .callback = MergeOnAddRemove
+    });
+
+    ecs_entity_t e1 = ecs_new_id(world);
+    ecs_entity_t e2 = ecs_new_id(world);
+    merge_on_add_remove_from = e1;
+    merge_on_add_remove_id = ecs_id(Position);
+
+    ecs_defer_begin(world);
+    ecs_set(world, e1, Position, {10, 20});
+    ecs_set(world, e2, Position, {30, 40});
+    ecs_add(world, e2, Tag);
+    ecs_defer_end(world);
+
+    /* e1 was moved by the OnAdd observer before the OnSet notification for e1 
+     * was sent, only e2 is notified. */
+    test_assert(!ecs_has(world, e1, Position));
+    test_assert(ecs_has(world, e2, Position));
+    test_int(merge_on_set_count, 1);
+
+    ecs_fini(world);
+}
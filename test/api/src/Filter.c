@@ -11883,3 +11883,147 @@ void Filter_filter_w_short_notation(void) {
 
     ecs_fini(world);
 }
+
+void Filter_filter_signature_wildcard_pair(void) {
+    ecs_world_t *world = ecs_mini();
+
+    ECS_TAG(world, Foo);
+    ECS_TAG(world, Likes);
+    ECS_TAG(world, Eats);
+    ECS_TAG(world, Apples);
+    ECS_TAG(world, Pears);
+
+    ecs_entity_t e1 = ecs_new(world, Foo);
+    ecs_add_pair(world, e1, Likes, Apples);
+    ecs_entity_t e2 = ecs_new(world, Foo);
+    ecs_add_pair(world, e2, Eats, Pears);
+    ecs_entity_t e3 = ecs_new(world, Foo);
+    ecs_add_pair(world, e3, Eats, Apples);
+
+    {
+        ecs_filter_t *f = ecs_filter(world, { .expr = "Foo, (Eats, *)" });
+        test_assert(f != NULL);
+
+        ecs_iter_t it = ecs_filter_iter(world, f);
+        test_bool(true, ecs_filter_next(&it));
+        test_int(1, it.count);
+        test_uint(e2, it.entities[0]);
+        test_uint(ecs_pair(Eats, Pears), ecs_field_id(&it, 2));
+        test_bool(true, ecs_filter_next(&it));
+        test_int(1, it.count);
+        test_uint(e3, it.entities[0]);
+        test_uint(ecs_pair(Eats, Apples), ecs_field_id(&it, 2));
+        test_bool(false, ecs_filter_next(&it));
+
+        ecs_filter_fini(f);
+    }
+
+    {
+        ecs_filter_t *f = ecs_filter(world, { .expr = "Foo, (*, Apples)" });
+        test_assert(f != NULL);
+
+        ecs_iter_t it = ecs_filter_iter(world, f);
+        test_bool(true, ecs_filter_next(&it));
+        test_int(1, it.count);
+        test_uint(e1, it.entities[0]);
+        test_uint(ecs_pair(Likes, Apples), ecs_field_id(&it, 2));
+        test_bool(true, ecs_filter_next(&it));
+        test_int(1, it.count);
+        test_uint(e3, it.entities[0]);
+        test_uint(ecs_pair(Eats, Apples), ecs_field_id(&it, 2));
+        test_bool(false, ecs_filter_next(&it));
+
+        ecs_filter_fini(f);
+    }
+
+    ecs_fini(world);
+}
+
+void Filter_filter_signature_inherited(void) {
+    ecs_world_t *world = ecs_mini();
+
+    ECS_COMPONENT(world, Position);
+    ECS_COMPONENT(world, Velocity);
+
+    ecs_entity_t base = ecs_new_w_id(world, EcsPrefab);
+    ecs_set(world, base, Velocity, {1, 2});
+
+    ecs_entity_t e1 = ecs_new_w_pair(world, EcsIsA, base);
+    ecs_set(world, e1, Position, {10, 20});
+    ecs_entity_t e2 = ecs_new(world, Position);
+
+    ecs_filter_t *f = ecs_filter(world, { .expr = "Position, Velocity" });
+    test_assert(f != NULL);
+
+    ecs_iter_t it = ecs_filter_iter(world, f);
+    test_bool(true, ecs_filter_next(&it));
+    test_int(1, it.count);
+    test_uint(e1, it.entities[0]);
+    test_uint(0, ecs_field_src(&it, 1));
+    test_uint(base, ecs_field_src(&it, 2));
+    test_bool(false, ecs_filter_next(&it));
+
+    test_assert(e2 != 0);
+
+    ecs_filter_fini(f);
+
+    ecs_fini(world);
+}
+
+void Filter_filter_signature_up(void) {
+    ecs_world_t *world = ecs_mini();
+
+    ECS_COMPONENT(world, Position);
+    ECS_COMPONENT(world, Velocity);
+
+    ecs_entity_t parent = ecs_new(world, Velocity);
+    ecs_entity_t e1 = ecs_new(world, Position);
+    ecs_add_pair(world, e1, EcsChildOf, parent);
+    ecs_new(world, Position);
+
+    ecs_filter_t *f = ecs_filter(world, { 
+        .expr = "Position, Velocity(up(ChildOf))" 
+    });
+    test_assert(f != NULL);
+
+    ecs_iter_t it = ecs_filter_iter(world, f);
+    test_bool(true, ecs_filter_next(&it));
+    test_int(1, it.count);
+    test_uint(e1, it.entities[0]);
+    test_uint(parent, ecs_field_src(&it, 2));
+    test_bool(false, ecs_filter_next(&it));
+
+    ecs_filter_fini(f);
+
+    ecs_fini(world);
+}
+
+void Filter_filter_signature_union(void) {
+    ecs_world_t *world = ecs_mini();
+
+    ECS_TAG(world, Foo);
+    ECS_ENTITY(world, Movement, Union);
+    ECS_TAG(world, Walking);
+    ECS_TAG(world, Running);
+
+    ecs_entity_t e1 = ecs_new(world, Foo);
+    ecs_add_pair(world, e1, Movement, Walking);
+    ecs_entity_t e2 = ecs_new(world, Foo);
+    ecs_add_pair(world, e2, Movement, Running);
+
+    ecs_filter_t *f = ecs_filter(world, { .expr = "Foo, (Movement, Running)" });
+    test_assert(f != NULL);
+
+    /* Union pairs aren't stored in the table type. Filters don't filter on
+     * the union target, so the table is returned as a whole. */
+    ecs_iter_t it = ecs_filter_iter(world, f);
+    test_bool(true, ecs_filter_next(&it));
+    test_int(2, it.count);
+    test_uint(e1, it.entities[0]);
+    test_uint(e2, it.entities[1]);
+    test_bool(false, ecs_filter_next(&it));
+
+    ecs_filter_fini(f);
+
+    ecs_fini(world);
+}
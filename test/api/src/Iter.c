@@ -2297,3 +2297,549 @@ void Iter_rule_eval_count(void) {
 
     ecs_fini(world);
 }
+
+void Iter_balanced_worker_iter_2(void) {
+    ecs_world_t *world = ecs_mini();
+
+    ECS_COMPONENT(world, Self);
+    ECS_TAG(world, TagA);
+    ECS_TAG(world, TagB);
+
+    ecs_entity_t e1 = ecs_new_id(world); ecs_set(world, e1, Self, {e1});
+    ecs_entity_t e2 = ecs_new_id(world); ecs_set(world, e2, Self, {e2});
+    ecs_entity_t e3 = ecs_new_id(world); ecs_set(world, e3, Self, {e3});
+    ecs_entity_t e4 = ecs_new_id(world); ecs_set(world, e4, Self, {e4});
+    ecs_entity_t e5 = ecs_new_id(world); ecs_set(world, e5, Self, {e5});
+
+    ecs_add(world, e3, TagA);
+    ecs_add(world, e4, TagA);
+    ecs_add(world, e5, TagB);
+
+    ecs_query_t *q = ecs_query(world, {
+        .filter.terms = {{ ecs_id(Self) }}
+    });
+
+    ecs_iter_t it_1 = ecs_query_iter(world, q);
+    ecs_iter_t pit_1 = ecs_balanced_worker_iter(&it_1, 0, 2);
+
+    ecs_iter_t it_2 = ecs_query_iter(world, q);
+    ecs_iter_t pit_2 = ecs_balanced_worker_iter(&it_2, 1, 2);
+
+    {
+        test_bool(ecs_worker_next(&pit_1), true);
+        test_int(pit_1.count, 2);
+        test_int(pit_1.entities[0], e1);
+        test_int(pit_1.entities[1], e2);
+
+        Self *ptr = ecs_field(&pit_1, Self, 1);
+        test_assert(ptr != NULL);
+        test_int(ptr[0].value, e1);
+        test_int(ptr[1].value, e2);
+    }
+
+    test_bool(ecs_worker_next(&pit_1), false);
+
+    {
+        test_bool(ecs_worker_next(&pit_2), true);
+        test_int(pit_2.count, 2);
+        test_int(pit_2.entities[0], e3);
+        test_int(pit_2.entities[1], e4);
+
+        Self *ptr = ecs_field(&pit_2, Self, 1);
+        test_assert(ptr != NULL);
+        test_int(ptr[0].value, e3);
+        test_int(ptr[1].value, e4);
+    }
+
+    {
+        test_bool(ecs_worker_next(&pit_2), true);
+        test_int(pit_2.count, 1);
+        test_int(pit_2.entities[0], e5);
+
+        Self *ptr = ecs_field(&pit_2, Self, 1);
+        test_assert(ptr != NULL);
+        test_int(ptr[0].value, e5);
+    }
+
+    test_bool(ecs_worker_next(&pit_2), false);
+
+    ecs_query_fini(q);
+
+    ecs_fini(world);
+}
+
+void Iter_balanced_worker_iter_many_tables(void) {
+    ecs_world_t *world = ecs_mini();
+
+    ECS_COMPONENT(world, Position);
+
+    ecs_query_t *q = ecs_query(world, {
+        .filter.terms = {{ ecs_id(Position) }}
+    });
+
+    int i, w, count = 0;
+    for (i = 0; i < 100; i ++) {
+        ecs_entity_t tag = ecs_new_id(world);
+        ecs_entity_t e = ecs_set(world, 0, Position, {i, 0});
+        ecs_add_id(world, e, tag);
+    }
+
+    for (w = 0; w < 4; w ++) {
+        ecs_iter_t it = ecs_query_iter(world, q);
+        ecs_iter_t pit = ecs_balanced_worker_iter(&it, w, 4);
+        int32_t worker_count = 0;
+        while (ecs_worker_next(&pit)) {
+            Position *p = ecs_field(&pit, Position, 1);
+            test_int(pit.count, 1);
+            test_int(p[0].x, count);
+            worker_count ++;
+            count ++;
+        }
+        test_int(worker_count, 25);
+    }
+
+    test_int(count, 100);
+
+    ecs_query_fini(q);
+
+    ecs_fini(world);
+}
+
+void Iter_balanced_worker_iter_large_table(void) {
+    ecs_world_t *world = ecs_mini();
+
+    ECS_COMPONENT(world, Position);
+
+    ecs_query_t *q = ecs_query(world, {
+        .filter.terms = {{ ecs_id(Position) }}
+    });
+
+    int i;
+    for (i = 0; i < 10; i ++) {
+        ecs_set(world, 0, Position, {0, 0});
+    }
+    for (i = 0; i < 10; i ++) {
+        ecs_entity_t tag = ecs_new_id(world);
+        ecs_entity_t e = ecs_set(world, 0, Position, {1, 0});
+        ecs_add_id(world, e, tag);
+    }
+
+    {
+        ecs_iter_t it = ecs_query_iter(world, q);
+        ecs_iter_t pit = ecs_balanced_worker_iter(&it, 0, 2);
+        test_bool(ecs_worker_next(&pit), true);
+        test_int(pit.count, 10);
+        Position *p = ecs_field(&pit, Position, 1);
+        test_int(p[0].x, 0);
+        test_bool(ecs_worker_next(&pit), false);
+    }
+
+    {
+        ecs_iter_t it = ecs_query_iter(world, q);
+        ecs_iter_t pit = ecs_balanced_worker_iter(&it, 1, 2);
+        int32_t count = 0;
+        while (ecs_worker_next(&pit)) {
+            Position *p = ecs_field(&pit, Position, 1);
+            test_int(pit.count, 1);
+            test_int(p[0].x, 1);
+            count ++;
+        }
+        test_int(count, 10);
+    }
+
+    ecs_query_fini(q);
+
+    ecs_fini(world);
+}
+
+void Iter_balanced_worker_iter_more_workers_than_tables(void) {
+    ecs_world_t *world = ecs_mini();
+
+    ECS_COMPONENT(world, Position);
+    ECS_TAG(world, Foo);
+
+    ecs_query_t *q = ecs_query(world, {
+        .filter.terms = {{ ecs_id(Position) }}
+    });
+
+    ecs_entity_t e1 = ecs_set(world, 0, Position, {10, 20});
+    ecs_entity_t e2 = ecs_set(world, 0, Position, {20, 30});
+    ecs_add(world, e2, Foo);
+
+    int w, count = 0;
+    for (w = 0; w < 4; w ++) {
+        ecs_iter_t it = ecs_query_iter(world, q);
+        ecs_iter_t pit = ecs_balanced_worker_iter(&it, w, 4);
+        while (ecs_worker_next(&pit)) {
+            test_int(pit.count, 1);
+            if (count) {
+                test_int(pit.entities[0], e2);
+            } else {
+                test_int(pit.entities[0], e1);
+            }
+            count ++;
+        }
+    }
+
+    test_int(count, 2);
+
+    ecs_query_fini(q);
+
+    ecs_fini(world);
+}
+
+void Iter_balanced_worker_iter_w_filter(void) {
+    ecs_world_t *world = ecs_mini();
+
+    ECS_COMPONENT(world, Position);
+    ECS_TAG(world, Foo);
+
+    ecs_filter_t *f = ecs_filter(world, {
+        .terms = {{ ecs_id(Position) }}
+    });
+
+    ecs_set(world, 0, Position, {10, 20});
+    ecs_entity_t e2 = ecs_set(world, 0, Position, {20, 30});
+    ecs_entity_t e3 = ecs_set(world, 0, Position, {30, 40});
+    ecs_entity_t e4 = ecs_set(world, 0, Position, {40, 50});
+    ecs_add(world, e3, Foo);
+    ecs_add(world, e4, Foo);
+
+    /* Filters don't support assigning tables up front, so entities are
+     * divided the same way as ecs_worker_iter */
+    ecs_iter_t it = ecs_filter_iter(world, f);
+    ecs_iter_t pit = ecs_balanced_worker_iter(&it, 1, 2);
+    test_bool(ecs_worker_next(&pit), true);
+    test_int(pit.count, 1);
+    test_int(pit.entities[0], e2);
+    test_bool(ecs_worker_next(&pit), true);
+    test_int(pit.count, 1);
+    test_int(pit.entities[0], e4);
+    test_bool(ecs_worker_next(&pit), false);
+
+    ecs_filter_fini(f);
+
+    ecs_fini(world);
+}
+
+void Iter_balanced_worker_iter_w_fini(void) {
+    ecs_world_t *world = ecs_mini();
+
+    ECS_COMPONENT(world, Position);
+    ECS_TAG(world, Foo);
+
+    ecs_query_t *q = ecs_query(world, {
+        .filter.terms = {{ ecs_id(Position) }}
+    });
+
+    ecs_entity_t e1 = ecs_set(world, 0, Position, {10, 20});
+    ecs_entity_t e2 = ecs_set(world, 0, Position, {20, 30});
+    ecs_add(world, e2, Foo);
+
+    ecs_iter_t it = ecs_query_iter(world, q);
+    ecs_iter_t pit = ecs_balanced_worker_iter(&it, 0, 2);
+    test_bool(true, ecs_worker_next(&pit));
+    test_int(pit.count, 1);
+    test_int(pit.entities[0], e1);
+    ecs_iter_fini(&pit);
+
+    ecs_query_fini(q);
+
+    ecs_fini(world);
+}
+
+void Iter_balanced_worker_iter_split_table(void) {
+    ecs_world_t *world = ecs_mini();
+
+    ECS_COMPONENT(world, Position);
+    ECS_TAG(world, Foo);
+
+    ecs_query_t *q = ecs_query(world, {
+        .filter.terms = {{ ecs_id(Position) }}
+    });
+
+    int i;
+    ecs_entity_t e[8];
+    for (i = 0; i < 8; i ++) {
+        e[i] = ecs_set(world, 0, Position, {i, 0});
+        if (i >= 4) {
+            ecs_add(world, e[i], Foo);
+        }
+    }
+
+    {
+        ecs_iter_t it = ecs_query_iter(world, q);
+        ecs_iter_t pit = ecs_balanced_worker_iter(&it, 0, 3);
+        test_bool(ecs_worker_next(&pit), true);
+        test_int(pit.count, 2);
+        test_int(pit.frame_offset, 0);
+        test_int(pit.entities[0], e[0]);
+        test_int(pit.entities[1], e[1]);
+        Position *p = ecs_field(&pit, Position, 1);
+        test_int(p[0].x, 0);
+        test_int(p[1].x, 1);
+        test_bool(ecs_worker_next(&pit), false);
+    }
+
+    {
+        ecs_iter_t it = ecs_query_iter(world, q);
+        ecs_iter_t pit = ecs_balanced_worker_iter(&it, 1, 3);
+        test_bool(ecs_worker_next(&pit), true);
+        test_int(pit.count, 2);
+        test_int(pit.frame_offset, 2);
+        test_int(pit.entities[0], e[2]);
+        test_int(pit.entities[1], e[3]);
+        Position *p = ecs_field(&pit, Position, 1);
+        test_int(p[0].x, 2);
+        test_int(p[1].x, 3);
+        test_bool(ecs_worker_next(&pit), true);
+        test_int(pit.count, 1);
+        test_int(pit.frame_offset, 4);
+        test_int(pit.entities[0], e[4]);
+        p = ecs_field(&pit, Position, 1);
+        test_int(p[0].x, 4);
+        test_bool(ecs_worker_next(&pit), false);
+    }
+
+    {
+        ecs_iter_t it = ecs_query_iter(world, q);
+        ecs_iter_t pit = ecs_balanced_worker_iter(&it, 2, 3);
+        test_bool(ecs_worker_next(&pit), true);
+        test_int(pit.count, 3);
+        test_int(pit.frame_offset, 5);
+        test_int(pit.entities[0], e[5]);
+        test_int(pit.entities[1], e[6]);
+        test_int(pit.entities[2], e[7]);
+        Position *p = ecs_field(&pit, Position, 1);
+        test_int(p[0].x, 5);
+        test_int(p[1].x, 6);
+        test_int(p[2].x, 7);
+        test_bool(ecs_worker_next(&pit), false);
+    }
+
+    ecs_query_fini(q);
+
+    ecs_fini(world);
+}
+
+void Iter_chunk_iter(void) {
+    ecs_world_t *world = ecs_mini();
+
+    ECS_COMPONENT(world, Position);
+
+    ecs_entity_t e[10];
+    for (int i = 0; i < 10; i ++) {
+        e[i] = ecs_set(world, 0, Position, {i, i});
+    }
+
+    ecs_query_t *q = ecs_query(world, { .filter.terms = {{ ecs_id(Position) }}});
+
+    ecs_iter_t it = ecs_query_iter(world, q);
+    ecs_iter_t cit = ecs_chunk_iter(&it, 4);
+
+    test_bool(ecs_chunk_next(&cit), true);
+    test_int(cit.count, 4);
+    test_int(cit.offset, 0);
+    test_int(cit.frame_offset, 0);
+    test_int(cit.entities[0], e[0]);
+    Position *p = ecs_field(&cit, Position, 1);
+    test_int(p[0].x, 0);
+    test_int(p[3].x, 3);
+
+    test_bool(ecs_chunk_next(&cit), true);
+    test_int(cit.count, 4);
+    test_int(cit.offset, 4);
+    test_int(cit.frame_offset, 4);
+    test_int(cit.entities[0], e[4]);
+    p = ecs_field(&cit, Position, 1);
+    test_int(p[0].x, 4);
+    test_int(p[3].x, 7);
+
+    test_bool(ecs_chunk_next(&cit), true);
+    test_int(cit.count, 2);
+    test_int(cit.offset, 8);
+    test_int(cit.frame_offset, 8);
+    test_int(cit.entities[0], e[8]);
+    test_int(cit.entities[1], e[9]);
+    p = ecs_field(&cit, Position, 1);
+    test_int(p[0].x, 8);
+    test_int(p[1].x, 9);
+
+    test_bool(ecs_chunk_next(&cit), false);
+
+    ecs_query_fini(q);
+
+    ecs_fini(world);
+}
+
+void Iter_chunk_iter_unaligned_offset(void) {
+    ecs_world_t *world = ecs_mini();
+
+    ECS_COMPONENT(world, Position);
+
+    ecs_entity_t e[10];
+    for (int i = 0; i < 10; i ++) {
+        e[i] = ecs_set(world, 0, Position, {i, i});
+    }
+
+    ecs_query_t *q = ecs_query(world, { .filter.terms = {{ ecs_id(Position) }}});
+
+    ecs_iter_t it = ecs_query_iter(world, q);
+    ecs_iter_t pit = ecs_page_iter(&it, 3, 0);
+    ecs_iter_t cit = ecs_chunk_iter(&pit, 4);
+
+    test_bool(ecs_chunk_next(&cit), true);
+    test_int(cit.count, 1);
+    test_int(cit.offset, 3);
+    test_int(cit.entities[0], e[3]);
+    Position *p = ecs_field(&cit, Position, 1);
+    test_int(p[0].x, 3);
+
+    test_bool(ecs_chunk_next(&cit), true);
+    test_int(cit.count, 4);
+    test_int(cit.offset, 4);
+    test_int(cit.entities[0], e[4]);
+    p = ecs_field(&cit, Position, 1);
+    test_int(p[0].x, 4);
+    test_int(p[3].x, 7);
+
+    test_bool(ecs_chunk_next(&cit), true);
+    test_int(cit.count, 2);
+    test_int(cit.offset, 8);
+    test_int(cit.entities[0], e[8]);
+    p = ecs_field(&cit, Position, 1);
+    test_int(p[0].x, 8);
+    test_int(p[1].x, 9);
+
+    test_bool(ecs_chunk_next(&cit), false);
+
+    ecs_query_fini(q);
+
+    ecs_fini(world);
+}
+
+void Iter_chunk_iter_2_tables(void) {
+    ecs_world_t *world = ecs_mini();
+
+    ECS_COMPONENT(world, Position);
+    ECS_TAG(world, Tag);
+
+    ecs_entity_t e[8];
+    for (int i = 0; i < 8; i ++) {
+        e[i] = ecs_set(world, 0, Position, {i, i});
+        if (i >= 5) {
+            ecs_add(world, e[i], Tag);
+        }
+    }
+
+    ecs_query_t *q = ecs_query(world, { .filter.terms = {{ ecs_id(Position) }}});
+
+    ecs_iter_t it = ecs_query_iter(world, q);
+    ecs_iter_t cit = ecs_chunk_iter(&it, 4);
+
+    test_bool(ecs_chunk_next(&cit), true);
+    test_int(cit.count, 4);
+    test_int(cit.entities[0], e[0]);
+
+    test_bool(ecs_chunk_next(&cit), true);
+    test_int(cit.count, 1);
+    test_int(cit.entities[0], e[4]);
+    Position *p = ecs_field(&cit, Position, 1);
+    test_int(p[0].x, 4);
+
+    test_bool(ecs_chunk_next(&cit), true);
+    test_int(cit.count, 3);
+    test_int(cit.offset, 0);
+    test_int(cit.entities[0], e[5]);
+    test_int(cit.entities[2], e[7]);
+    p = ecs_field(&cit, Position, 1);
+    test_int(p[0].x, 5);
+    test_int(p[2].x, 7);
+
+    test_bool(ecs_chunk_next(&cit), false);
+
+    ecs_query_fini(q);
+
+    ecs_fini(world);
+}
+
+void Iter_chunk_iter_aligned_columns(void) {
+    ecs_world_t *world = ecs_mini();
+
+    ECS_COMPONENT(world, Position);
+
+    test_bool(ecs_enable_aligned_columns(world, true), false);
+
+    ecs_entity_t e[20];
+    for (int i = 0; i < 20; i ++) {
+        e[i] = ecs_set(world, 0, Position, {i, i});
+    }
+
+    ecs_query_t *q = ecs_query(world, { .filter.terms = {{ ecs_id(Position) }}});
+
+    int32_t chunk_size = FLECS_COLUMN_ALIGNMENT / ECS_SIZEOF(Position);
+    int32_t count = 0;
+    ecs_iter_t it = ecs_query_iter(world, q);
+    ecs_iter_t cit = ecs_chunk_iter(&it, chunk_size);
+    while (ecs_chunk_next(&cit)) {
+        Position *p = ecs_field(&cit, Position, 1);
+        test_int((uintptr_t)p % FLECS_COLUMN_ALIGNMENT, 0);
+        test_assert(cit.count <= chunk_size);
+        for (int i = 0; i < cit.count; i ++) {
+            test_int(p[i].x, count + i);
+        }
+        count += cit.count;
+    }
+
+    test_int(count, 20);
+
+    ecs_query_fini(q);
+
+    ecs_fini(world);
+}
+
+void Iter_enable_aligned_columns_existing_tables(void) {
+    ecs_world_t *world = ecs_mini();
+
+    ECS_COMPONENT(world, Position);
+    ECS_COMPONENT(world, Velocity);
+
+    ecs_entity_t e[5];
+    for (int i = 0; i < 5; i ++) {
+        e[i] = ecs_set(world, 0, Position, {i, i});
+        ecs_set(world, e[i], Velocity, {i * 2, i * 2});
+    }
+
+    test_bool(ecs_enable_aligned_columns(world, true), false);
+    test_bool(ecs_enable_aligned_columns(world, true), true);
+
+    for (int i = 0; i < 5; i ++) {
+        const Position *p = ecs_get(world, e[i], Position);
+        test_assert(p != NULL);
+        test_int(p->x, i);
+        const Velocity *v = ecs_get(world, e[i], Velocity);
+        test_assert(v != NULL);
+        test_int(v->x, i * 2);
+    }
+
+    const Position *p = ecs_get(world, e[0], Position);
+    test_int((uintptr_t)p % FLECS_COLUMN_ALIGNMENT, 0);
+
+    /* Grow existing table */
+    ecs_entity_t e6 = ecs_new_id(world);
+    ecs_set(world, e6, Position, {5, 5});
+    ecs_set(world, e6, Velocity, {10, 10});
+    test_int(ecs_get(world, e6, Position)->x, 5);
+    test_int(ecs_get(world, e[4], Velocity)->x, 8);
+
+    test_bool(ecs_enable_aligned_columns(world, false), true);
+
+    for (int i = 0; i < 5; i ++) {
+        p = ecs_get(world, e[i], Position);
+        test_assert(p != NULL);
+        test_int(p->x, i);
+    }
+    test_int(ecs_get(world, e6, Velocity)->x, 10);
+
+    ecs_fini(world);
+}
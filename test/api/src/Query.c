@@ -10480,3 +10480,341 @@ void Query_default_query_flags(void) {
 
     ecs_fini(world);
 }
+
+void Query_changed_rows_first_iter(void) {
+    ecs_world_t *world = ecs_mini();
+
+    ECS_COMPONENT(world, Position);
+
+    ecs_entity_t e1 = ecs_new(world, Position);
+    ecs_entity_t e2 = ecs_new(world, Position);
+    ecs_entity_t e3 = ecs_new(world, Position);
+
+    ecs_query_t *q = ecs_query_new(world, "[in] Position");
+    test_assert(q != NULL);
+
+    ecs_iter_t it = ecs_query_changed_iter(world, q);
+    test_bool(true, ecs_query_next(&it));
+    test_int(3, it.count);
+    test_uint(e1, it.entities[0]);
+    test_uint(e2, it.entities[1]);
+    test_uint(e3, it.entities[2]);
+    test_bool(false, ecs_query_next(&it));
+
+    it = ecs_query_changed_iter(world, q);
+    test_bool(false, ecs_query_next(&it));
+
+    ecs_fini(world);
+}
+
+void Query_changed_rows_after_modified(void) {
+    ecs_world_t *world = ecs_mini();
+
+    ECS_COMPONENT(world, Position);
+
+    ecs_entity_t e1 = ecs_new(world, Position);
+    ecs_entity_t e2 = ecs_new(world, Position);
+    ecs_entity_t e3 = ecs_new(world, Position);
+    ecs_entity_t e4 = ecs_new(world, Position);
+    ecs_entity_t e5 = ecs_new(world, Position);
+
+    ecs_query_t *q = ecs_query_new(world, "[in] Position");
+    test_assert(q != NULL);
+
+    ecs_iter_t it = ecs_query_changed_iter(world, q);
+    test_bool(true, ecs_query_next(&it));
+    test_int(5, it.count);
+    test_bool(false, ecs_query_next(&it));
+
+    ecs_modified(world, e2, Position);
+    ecs_modified(world, e4, Position);
+
+    it = ecs_query_changed_iter(world, q);
+    test_bool(true, ecs_query_next(&it));
+    test_int(1, it.count);
+    test_uint(e2, it.entities[0]);
+    test_bool(true, ecs_query_next(&it));
+    test_int(1, it.count);
+    test_uint(e4, it.entities[0]);
+    test_bool(false, ecs_query_next(&it));
+
+    ecs_set(world, e1, Position, {10, 20});
+    ecs_set(world, e2, Position, {20, 30});
+
+    it = ecs_query_changed_iter(world, q);
+    test_bool(true, ecs_query_next(&it));
+    test_int(2, it.count);
+    test_uint(e1, it.entities[0]);
+    test_uint(e2, it.entities[1]);
+    const Position *p = ecs_field(&it, Position, 1);
+    test_int(p[0].x, 10);
+    test_int(p[1].x, 20);
+    test_bool(false, ecs_query_next(&it));
+
+    it = ecs_query_changed_iter(world, q);
+    test_bool(false, ecs_query_next(&it));
+
+    test_assert(e3 != 0);
+    test_assert(e5 != 0);
+
+    ecs_fini(world);
+}
+
+void Query_changed_rows_after_add(void) {
+    ecs_world_t *world = ecs_mini();
+
+    ECS_COMPONENT(world, Position);
+    ECS_TAG(world, Foo);
+
+    ecs_new(world, Position);
+    ecs_new(world, Position);
+    ecs_entity_t e3 = ecs_new(world, Position);
+
+    ecs_query_t *q = ecs_query_new(world, "[in] Position");
+    test_assert(q != NULL);
+
+    ecs_iter_t it = ecs_query_changed_iter(world, q);
+    test_bool(true, ecs_query_next(&it));
+    test_int(3, it.count);
+    test_bool(false, ecs_query_next(&it));
+
+    ecs_entity_t e4 = ecs_new(world, Position);
+
+    it = ecs_query_changed_iter(world, q);
+    test_bool(true, ecs_query_next(&it));
+    test_int(1, it.count);
+    test_uint(e4, it.entities[0]);
+    test_bool(false, ecs_query_next(&it));
+
+    /* Entity that moves to another table is new in that table */
+    ecs_add(world, e3, Foo);
+
+    it = ecs_query_changed_iter(world, q);
+    test_bool(true, ecs_query_next(&it));
+    test_int(1, it.count);
+    test_uint(e3, it.entities[0]);
+    test_bool(false, ecs_query_next(&it));
+
+    ecs_fini(world);
+}
+
+void Query_changed_rows_after_delete(void) {
+    ecs_world_t *world = ecs_mini();
+
+    ECS_COMPONENT(world, Position);
+
+    ecs_entity_t e1 = ecs_new(world, Position);
+    ecs_entity_t e2 = ecs_new(world, Position);
+    ecs_entity_t e3 = ecs_new(world, Position);
+    ecs_entity_t e4 = ecs_new(world, Position);
+
+    ecs_query_t *q = ecs_query_new(world, "[in] Position");
+    test_assert(q != NULL);
+
+    ecs_iter_t it = ecs_query_changed_iter(world, q);
+    test_bool(true, ecs_query_next(&it));
+    test_int(4, it.count);
+    test_bool(false, ecs_query_next(&it));
+
+    ecs_modified(world, e2, Position);
+    ecs_delete(world, e1);
+
+    it = ecs_query_changed_iter(world, q);
+    test_bool(true, ecs_query_next(&it));
+    test_int(1, it.count);
+    test_uint(e2, it.entities[0]);
+    test_bool(false, ecs_query_next(&it));
+
+    /* Deleting entity moves last entity, which keeps its version */
+    ecs_delete(world, e2);
+
+    it = ecs_query_changed_iter(world, q);
+    test_bool(false, ecs_query_next(&it));
+
+    ecs_modified(world, e4, Position);
+
+    it = ecs_query_changed_iter(world, q);
+    test_bool(true, ecs_query_next(&it));
+    test_int(1, it.count);
+    test_uint(e4, it.entities[0]);
+    test_bool(false, ecs_query_next(&it));
+
+    test_assert(e3 != 0);
+
+    ecs_fini(world);
+}
+
+void Query_changed_rows_skip_unchanged_table(void) {
+    ecs_world_t *world = ecs_mini();
+
+    ECS_COMPONENT(world, Position);
+    ECS_TAG(world, Foo);
+
+    ecs_entity_t e1 = ecs_new(world, Position);
+    ecs_entity_t e2 = ecs_new(world, Position);
+    ecs_add(world, e2, Foo);
+
+    ecs_query_t *q = ecs_query_new(world, "[in] Position");
+    test_assert(q != NULL);
+
+    ecs_iter_t it = ecs_query_changed_iter(world, q);
+    test_bool(true, ecs_query_next(&it));
+    test_int(1, it.count);
+    test_uint(e1, it.entities[0]);
+    test_bool(true, ecs_query_next(&it));
+    test_int(1, it.count);
+    test_uint(e2, it.entities[0]);
+    test_bool(false, ecs_query_next(&it));
+
+    ecs_modified(world, e2, Position);
+
+    it = ecs_query_changed_iter(world, q);
+    test_bool(true, ecs_query_next(&it));
+    test_int(1, it.count);
+    test_uint(e2, it.entities[0]);
+    test_bool(false, ecs_query_next(&it));
+
+    ecs_fini(world);
+}
+
+void Query_changed_rows_w_inout_writer(void) {
+    ecs_world_t *world = ecs_mini();
+
+    ECS_COMPONENT(world, Position);
+    ECS_COMPONENT(world, Velocity);
+
+    ecs_entity_t e1 = ecs_set(world, 0, Velocity, {1, 2});
+    ecs_entity_t e2 = ecs_set(world, 0, Velocity, {1, 2});
+    ecs_entity_t e3 = ecs_set(world, 0, Velocity, {1, 2});
+    ecs_set(world, e1, Position, {0, 0});
+    ecs_set(world, e2, Position, {0, 0});
+    ecs_set(world, e3, Position, {0, 0});
+
+    ecs_query_t *writer = ecs_query_new(world, "[inout] Position, [in] Velocity");
+    test_assert(writer != NULL);
+    ecs_query_t *reader = ecs_query_new(world, "[in] Position");
+    test_assert(reader != NULL);
+
+    ecs_iter_t it = ecs_query_changed_iter(world, writer);
+    test_bool(true, ecs_query_next(&it));
+    test_int(3, it.count);
+    test_bool(false, ecs_query_next(&it));
+
+    it = ecs_query_changed_iter(world, reader);
+    test_bool(true, ecs_query_next(&it));
+    test_int(3, it.count);
+    test_bool(false, ecs_query_next(&it));
+
+    ecs_set(world, e2, Velocity, {3, 4});
+
+    it = ecs_query_changed_iter(world, writer);
+    test_bool(true, ecs_query_next(&it));
+    test_int(1, it.count);
+    test_uint(e2, it.entities[0]);
+    Position *p = ecs_field(&it, Position, 1);
+    const Velocity *v = ecs_field(&it, Velocity, 2);
+    p[0].x += v[0].x;
+    p[0].y += v[0].y;
+    test_bool(false, ecs_query_next(&it));
+
+    it = ecs_query_changed_iter(world, reader);
+    test_bool(true, ecs_query_next(&it));
+    test_int(1, it.count);
+    test_uint(e2, it.entities[0]);
+    const Position *rp = ecs_field(&it, Position, 1);
+    test_int(rp[0].x, 3);
+    test_int(rp[0].y, 4);
+    test_bool(false, ecs_query_next(&it));
+
+    it = ecs_query_changed_iter(world, reader);
+    test_bool(false, ecs_query_next(&it));
+
+    ecs_fini(world);
+}
+
+void Query_changed_rows_w_regular_writer(void) {
+    ecs_world_t *world = ecs_mini();
+
+    ECS_COMPONENT(world, Position);
+    ECS_TAG(world, Foo);
+
+    ecs_entity_t e1 = ecs_new(world, Position);
+    ecs_entity_t e2 = ecs_new(world, Position);
+    ecs_entity_t e3 = ecs_new(world, Position);
+    ecs_add(world, e3, Foo);
+
+    ecs_query_t *writer = ecs_query_new(world, "[out] Position, Foo");
+    test_assert(writer != NULL);
+    ecs_query_t *reader = ecs_query_new(world, "[in] Position");
+    test_assert(reader != NULL);
+
+    ecs_iter_t it = ecs_query_changed_iter(world, reader);
+    test_bool(true, ecs_query_next(&it));
+    test_int(2, it.count);
+    test_uint(e1, it.entities[0]);
+    test_uint(e2, it.entities[1]);
+    test_bool(true, ecs_query_next(&it));
+    test_int(1, it.count);
+    test_uint(e3, it.entities[0]);
+    test_bool(false, ecs_query_next(&it));
+
+    it = ecs_query_iter(world, writer);
+    while (ecs_query_next(&it)) { }
+
+    it = ecs_query_changed_iter(world, reader);
+    test_bool(true, ecs_query_next(&it));
+    test_int(1, it.count);
+    test_uint(e3, it.entities[0]);
+    test_bool(false, ecs_query_next(&it));
+
+    ecs_fini(world);
+}
+
+void Query_changed_rows_w_shared(void) {
+    ecs_world_t *world = ecs_mini();
+
+    ECS_COMPONENT(world, Position);
+    ECS_COMPONENT(world, Velocity);
+
+    ecs_entity_t base = ecs_set(world, 0, Velocity, {1, 2});
+    ecs_entity_t e1 = ecs_new_w_pair(world, EcsIsA, base);
+    ecs_entity_t e2 = ecs_new_w_pair(world, EcsIsA, base);
+    ecs_set(world, e1, Position, {0, 0});
+    ecs_set(world, e2, Position, {0, 0});
+
+    ecs_query_t *q = ecs_query_new(world, "[in] Position, [in] Velocity(up)");
+    test_assert(q != NULL);
+
+    ecs_iter_t it = ecs_query_changed_iter(world, q);
+    test_bool(true, ecs_query_next(&it));
+    test_int(1, it.count);
+    test_uint(e1, it.entities[0]);
+    test_bool(true, ecs_query_next(&it));
+    test_int(1, it.count);
+    test_uint(e2, it.entities[0]);
+    test_bool(false, ecs_query_next(&it));
+
+    it = ecs_query_changed_iter(world, q);
+    test_bool(false, ecs_query_next(&it));
+
+    ecs_modified(world, e2, Position);
+
+    it = ecs_query_changed_iter(world, q);
+    test_bool(true, ecs_query_next(&it));
+    test_int(1, it.count);
+    test_uint(e2, it.entities[0]);
+    test_bool(false, ecs_query_next(&it));
+
+    ecs_set(world, base, Velocity, {3, 4});
+
+    it = ecs_query_changed_iter(world, q);
+    test_bool(true, ecs_query_next(&it));
+    test_int(1, it.count);
+    test_uint(e1, it.entities[0]);
+    test_bool(true, ecs_query_next(&it));
+    test_int(1, it.count);
+    test_uint(e2, it.entities[0]);
+    test_bool(false, ecs_query_next(&it));
+
+    ecs_fini(world);
+}
@@ -171,3 +171,123 @@ void Remove_not_added(void) {
 
     ecs_fini(world);
 }
+
+void Remove_bulk_remove_id_table(void) {
+    ecs_world_t *world = ecs_mini();
+
+    ECS_COMPONENT(world, Position);
+    ECS_COMPONENT(world, Velocity);
+
+    ecs_entity_t e[4];
+    int i;
+    for (i = 0; i < 4; i ++) {
+        e[i] = ecs_set(world, 0, Position, {i, i * 2});
+        ecs_set(world, e[i], Velocity, {i * 3, i * 4});
+    }
+
+    ecs_table_t *table = ecs_get_table(world, e[0]);
+    ecs_bulk_remove_id(world, table, 0, 0, ecs_id(Velocity));
+    test_int(ecs_table_count(table), 0);
+
+    for (i = 0; i < 4; i ++) {
+        test_assert(!ecs_has(world, e[i], Velocity));
+        const Position *p = ecs_get(world, e[i], Position);
+        test_assert(p != NULL);
+        test_int(p->x, i);
+        test_int(p->y, i * 2);
+    }
+
+    ecs_fini(world);
+}
+
+void Remove_bulk_remove_id_range(void) {
+    ecs_world_t *world = ecs_mini();
+
+    ECS_COMPONENT(world, Position);
+    ECS_COMPONENT(world, Velocity);
+
+    ecs_entity_t e[5];
+    int i;
+    for (i = 0; i < 5; i ++) {
+        e[i] = ecs_set(world, 0, Position, {i, i * 2});
+        ecs_set(world, e[i], Velocity, {i * 3, i * 4});
+    }
+
+    ecs_table_t *table = ecs_get_table(world, e[0]);
+    ecs_bulk_remove_id(world, table, 2, 3, ecs_id(Position));
+    test_int(ecs_table_count(table), 2);
+
+    for (i = 0; i < 5; i ++) {
+        test_bool(ecs_has(world, e[i], Position), i < 2);
+        const Velocity *v = ecs_get(world, e[i], Velocity);
+        test_assert(v != NULL);
+        test_int(v->x, i * 3);
+        test_int(v->y, i * 4);
+    }
+
+    ecs_fini(world);
+}
+
+void Remove_bulk_remove_last_component(void) {
+    ecs_world_t *world = ecs_mini();
+
+    ECS_COMPONENT(world, Position);
+
+    ecs_entity_t e[4];
+    int i;
+    for (i = 0; i < 4; i ++) {
+        e[i] = ecs_set(world, 0, Position, {i, i * 2});
+    }
+
+    ecs_table_t *table = ecs_get_table(world, e[0]);
+    ecs_bulk_remove_id(world, table, 1, 2, ecs_id(Position));
+    test_int(ecs_table_count(table), 2);
+
+    for (i = 0; i < 4; i ++) {
+        test_assert(ecs_is_alive(world, e[i]));
+        if (i == 1 || i == 2) {
+            test_assert(ecs_get_table(world, e[i]) == NULL);
+        } else {
+            const Position *p = ecs_get(world, e[i], Position);
+            test_assert(p != NULL);
+            test_int(p->x, i);
+            test_int(p->y, i * 2);
+        }
+    }
+
+    ecs_fini(world);
+}
+
+void Remove_iter_remove_id(void) {
+    ecs_world_t *world = ecs_mini();
+
+    ECS_COMPONENT(world, Position);
+    ECS_TAG(world, Tag);
+    ECS_TAG(world, Foo);
+
+    ecs_entity_t e1 = ecs_new(world, Position);
+    ecs_entity_t e2 = ecs_new(world, Position);
+    ecs_entity_t e3 = ecs_new(world, Position);
+    ecs_add(world, e1, Tag);
+    ecs_add(world, e2, Tag);
+    ecs_add(world, e3, Tag);
+    ecs_add(world, e3, Foo);
+
+    ecs_filter_t *f = ecs_filter(world, {
+        .terms = {{ Tag }}
+    });
+    test_assert(f != NULL);
+
+    ecs_iter_t it = ecs_filter_iter(world, f);
+    ecs_iter_remove_id(&it, Tag);
+
+    test_assert(!ecs_has(world, e1, Tag));
+    test_assert(!ecs_has(world, e2, Tag));
+    test_assert(!ecs_has(world, e3, Tag));
+    test_assert(ecs_has(world, e3, Foo));
+    test_assert(ecs_has(world, e1, Position));
+
+    ecs_filter_fini(f);
+
+    ecs_fini(world);
+}
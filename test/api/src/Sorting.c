@@ -80,10 +80,10 @@ void Sorting_sort_by_component_same_value_1(void) {
     
 
     test_assert(it.entities[0] == e5);
-    test_assert(it.entities[1] == e4);
-    test_assert(it.entities[2] == e3);
-    test_assert(it.entities[3] == e2);
-    test_assert(it.entities[4] == e1);
+    test_assert(it.entities[1] == e3);
+    test_assert(it.entities[2] == e4);
+    test_assert(it.entities[3] == e1);
+    test_assert(it.entities[4] == e2);
 
     test_assert(!ecs_query_next(&it));
 
@@ -113,12 +113,12 @@ void Sorting_sort_by_component_same_value_2(void) {
     test_assert(ecs_query_next(&it));
 
     test_int(it.count, 6);
-    test_assert(it.entities[0] == e4);
-    test_assert(it.entities[1] == e6);
-    test_assert(it.entities[2] == e2);
-    test_assert(it.entities[3] == e1);
-    test_assert(it.entities[4] == e3);
-    test_assert(it.entities[5] == e5);
+    test_assert(it.entities[0] == e2);
+    test_assert(it.entities[1] == e4);
+    test_assert(it.entities[2] == e6);
+    test_assert(it.entities[3] == e5);
+    test_assert(it.entities[4] == e1);
+    test_assert(it.entities[5] == e3);
 
     test_assert(!ecs_query_next(&it));
 
@@ -1991,3 +1991,444 @@ void Sorting_sort_w_nontrivial_component(void) {
 
     ecs_fini(world);
 }
+
+static
+uint64_t key_position(
+    ecs_entity_t e,
+    const void *ptr)
+{
+    const Position *p = ptr;
+    return ecs_float_to_sort_key(p->x);
+}
+
+static
+uint64_t key_entity(
+    ecs_entity_t e,
+    const void *ptr)
+{
+    return e;
+}
+
+void Sorting_sort_by_key(void) {
+    ecs_world_t *world = ecs_mini();
+
+    ECS_COMPONENT(world, Position);
+
+    ecs_entity_t e1 = ecs_set(world, 0, Position, {3, 0});
+    ecs_entity_t e2 = ecs_set(world, 0, Position, {1, 0});
+    ecs_entity_t e3 = ecs_set(world, 0, Position, {5, 0});
+    ecs_entity_t e4 = ecs_set(world, 0, Position, {2, 0});
+    ecs_entity_t e5 = ecs_set(world, 0, Position, {4, 0});
+
+    ecs_query_t *q = ecs_query_init(world, &(ecs_query_desc_t){
+        .filter.expr = "Position",
+        .order_by_component = ecs_id(Position),
+        .order_by_key = key_position
+    });
+
+    ecs_iter_t it = ecs_query_iter(world, q);
+
+    test_assert(ecs_query_next(&it));
+    test_int(it.count, 5);
+
+    test_assert(it.entities[0] == e2);
+    test_assert(it.entities[1] == e4);
+    test_assert(it.entities[2] == e1);
+    test_assert(it.entities[3] == e5);
+    test_assert(it.entities[4] == e3);
+
+    test_assert(!ecs_query_next(&it));
+
+    ecs_fini(world);
+}
+
+void Sorting_sort_by_key_negative_float(void) {
+    ecs_world_t *world = ecs_mini();
+
+    ECS_COMPONENT(world, Position);
+
+    ecs_entity_t e1 = ecs_set(world, 0, Position, {-1.5, 0});
+    ecs_entity_t e2 = ecs_set(world, 0, Position, {300, 0});
+    ecs_entity_t e3 = ecs_set(world, 0, Position, {-200, 0});
+    ecs_entity_t e4 = ecs_set(world, 0, Position, {0, 0});
+    ecs_entity_t e5 = ecs_set(world, 0, Position, {0.5, 0});
+
+    ecs_query_t *q = ecs_query_init(world, &(ecs_query_desc_t){
+        .filter.expr = "Position",
+        .order_by_component = ecs_id(Position),
+        .order_by_key = key_position
+    });
+
+    ecs_iter_t it = ecs_query_iter(world, q);
+
+    test_assert(ecs_query_next(&it));
+    test_int(it.count, 5);
+
+    test_assert(it.entities[0] == e3);
+    test_assert(it.entities[1] == e1);
+    test_assert(it.entities[2] == e4);
+    test_assert(it.entities[3] == e5);
+    test_assert(it.entities[4] == e2);
+
+    test_assert(!ecs_query_next(&it));
+
+    ecs_fini(world);
+}
+
+void Sorting_sort_by_key_2_tables(void) {
+    ecs_world_t *world = ecs_mini();
+
+    ECS_COMPONENT(world, Position);
+    ECS_COMPONENT(world, Velocity);
+
+    ecs_entity_t e1 = ecs_set(world, 0, Position, {3, 0});
+    ecs_entity_t e2 = ecs_set(world, 0, Position, {1, 0});
+    ecs_entity_t e3 = ecs_set(world, 0, Position, {5, 0});
+    ecs_entity_t e4 = ecs_set(world, 0, Position, {2, 0});
+    ecs_entity_t e5 = ecs_set(world, 0, Position, {4, 0});
+    ecs_add(world, e3, Velocity);
+    ecs_add(world, e4, Velocity);
+
+    ecs_query_t *q = ecs_query_init(world, &(ecs_query_desc_t){
+        .filter.expr = "Position",
+        .order_by_component = ecs_id(Position),
+        .order_by_key = key_position
+    });
+
+    ecs_iter_t it = ecs_query_iter(world, q);
+
+    test_assert(ecs_query_next(&it));
+    test_int(it.count, 1);
+    test_assert(it.entities[0] == e2);
+
+    test_assert(ecs_query_next(&it));
+    test_int(it.count, 1);
+    test_assert(it.entities[0] == e4);
+
+    test_assert(ecs_query_next(&it));
+    test_int(it.count, 2);
+    test_assert(it.entities[0] == e1);
+    test_assert(it.entities[1] == e5);
+
+    test_assert(ecs_query_next(&it));
+    test_int(it.count, 1);
+    test_assert(it.entities[0] == e3);
+
+    test_assert(!ecs_query_next(&it));
+
+    ecs_fini(world);
+}
+
+void Sorting_sort_by_key_after_set(void) {
+    ecs_world_t *world = ecs_mini();
+
+    ECS_COMPONENT(world, Position);
+
+    ecs_entity_t e1 = ecs_set(world, 0, Position, {3, 0});
+    ecs_entity_t e2 = ecs_set(world, 0, Position, {1, 0});
+    ecs_entity_t e3 = ecs_set(world, 0, Position, {5, 0});
+
+    ecs_query_t *q = ecs_query_init(world, &(ecs_query_desc_t){
+        .filter.expr = "Position",
+        .order_by_component = ecs_id(Position),
+        .order_by_key = key_position
+    });
+
+    ecs_iter_t it = ecs_query_iter(world, q);
+    test_assert(ecs_query_next(&it));
+    test_int(it.count, 3);
+    test_assert(it.entities[0] == e2);
+    test_assert(it.entities[1] == e1);
+    test_assert(it.entities[2] == e3);
+    test_assert(!ecs_query_next(&it));
+
+    ecs_set(world, e2, Position, {7, 0});
+    ecs_entity_t e4 = ecs_set(world, 0, Position, {4, 0});
+
+    it = ecs_query_iter(world, q);
+    test_assert(ecs_query_next(&it));
+    test_int(it.count, 4);
+    test_assert(it.entities[0] == e1);
+    test_assert(it.entities[1] == e4);
+    test_assert(it.entities[2] == e3);
+    test_assert(it.entities[3] == e2);
+    test_assert(!ecs_query_next(&it));
+
+    ecs_fini(world);
+}
+
+void Sorting_sort_by_key_many(void) {
+    ecs_world_t *world = ecs_mini();
+
+    ECS_COMPONENT(world, Position);
+    ECS_TAG(world, TagA);
+    ECS_TAG(world, TagB);
+
+    int i;
+    for (i = 0; i < 1000; i ++) {
+        ecs_entity_t e = ecs_set(world, 0, Position, {
+            (float)((i * 7919) % 1000) - 500, 0});
+        if (i % 3 == 1) {
+            ecs_add(world, e, TagA);
+        } else if (i % 3 == 2) {
+            ecs_add(world, e, TagB);
+        }
+    }
+
+    ecs_query_t *q = ecs_query_init(world, &(ecs_query_desc_t){
+        .filter.expr = "Position",
+        .order_by_component = ecs_id(Position),
+        .order_by_key = key_position
+    });
+
+    ecs_iter_t it = ecs_query_iter(world, q);
+    float prev = -1000;
+    int32_t count = 0;
+    while (ecs_query_next(&it)) {
+        Position *p = ecs_field(&it, Position, 1);
+        for (i = 0; i < it.count; i ++) {
+            test_assert(p[i].x >= prev);
+            test_assert(ecs_get(world, it.entities[i], Position) == &p[i]);
+            prev = p[i].x;
+            count ++;
+        }
+    }
+
+    test_int(count, 1000);
+
+    ecs_fini(world);
+}
+
+void Sorting_sort_by_key_entity(void) {
+    ecs_world_t *world = ecs_mini();
+
+    ECS_COMPONENT(world, Position);
+    ECS_TAG(world, Tag);
+
+    ecs_entity_t e1 = ecs_new(world, Position);
+    ecs_entity_t e2 = ecs_new(world, Position);
+    ecs_entity_t e3 = ecs_new(world, Position);
+    ecs_add(world, e1, Tag);
+
+    ecs_query_t *q = ecs_query_init(world, &(ecs_query_desc_t){
+        .filter.expr = "Position",
+        .order_by_key = key_entity
+    });
+
+    ecs_iter_t it = ecs_query_iter(world, q);
+    test_assert(ecs_query_next(&it));
+    test_int(it.count, 1);
+    test_assert(it.entities[0] == e1);
+    test_assert(ecs_query_next(&it));
+    test_int(it.count, 2);
+    test_assert(it.entities[0] == e2);
+    test_assert(it.entities[1] == e3);
+    test_assert(!ecs_query_next(&it));
+
+    ecs_fini(world);
+}
+
+static
+int32_t test_sorted_count(
+    ecs_world_t *world,
+    ecs_query_t *q)
+{
+    ecs_iter_t it = ecs_query_iter(world, q);
+    float prev = -1e9;
+    int32_t count = 0;
+    while (ecs_query_next(&it)) {
+        Position *p = ecs_field(&it, Position, 1);
+        int32_t i;
+        for (i = 0; i < it.count; i ++) {
+            test_assert(p[i].x >= prev);
+            test_assert(ecs_get_id(world, it.entities[i], 
+                ecs_field_id(&it, 1)) == &p[i]);
+            prev = p[i].x;
+            count ++;
+        }
+    }
+    return count;
+}
+
+void Sorting_sort_incremental_append(void) {
+    ecs_world_t *world = ecs_mini();
+
+    ECS_COMPONENT(world, Position);
+
+    ecs_query_t *q = ecs_query_init(world, &(ecs_query_desc_t){
+        .filter.expr = "Position",
+        .order_by_component = ecs_id(Position),
+        .order_by = compare_position
+    });
+
+    int i;
+    for (i = 0; i < 100; i ++) {
+        ecs_set(world, 0, Position, {(float)((i * 37) % 100), 0});
+    }
+
+    test_int(test_sorted_count(world, q), 100);
+
+    ecs_set(world, 0, Position, {50.5, 0});
+    ecs_set(world, 0, Position, {-1, 0});
+    ecs_set(world, 0, Position, {200, 0});
+    ecs_set(world, 0, Position, {10.5, 0});
+
+    test_int(test_sorted_count(world, q), 104);
+
+    ecs_fini(world);
+}
+
+void Sorting_sort_incremental_modify(void) {
+    ecs_world_t *world = ecs_mini();
+
+    ECS_COMPONENT(world, Position);
+
+    ecs_query_t *q = ecs_query_init(world, &(ecs_query_desc_t){
+        .filter.expr = "Position",
+        .order_by_component = ecs_id(Position),
+        .order_by = compare_position
+    });
+
+    ecs_entity_t entities[100];
+    int i;
+    for (i = 0; i < 100; i ++) {
+        entities[i] = ecs_set(world, 0, Position, {(float)((i * 37) % 100), 0});
+    }
+
+    test_int(test_sorted_count(world, q), 100);
+
+    ecs_set(world, entities[10], Position, {1000, 0});
+    ecs_set(world, entities[20], Position, {-1000, 0});
+    ecs_set(world, entities[30], Position, {55.5, 0});
+
+    test_int(test_sorted_count(world, q), 100);
+
+    ecs_fini(world);
+}
+
+void Sorting_sort_incremental_delete(void) {
+    ecs_world_t *world = ecs_mini();
+
+    ECS_COMPONENT(world, Position);
+
+    ecs_query_t *q = ecs_query_init(world, &(ecs_query_desc_t){
+        .filter.expr = "Position",
+        .order_by_component = ecs_id(Position),
+        .order_by = compare_position
+    });
+
+    ecs_entity_t entities[100];
+    int i;
+    for (i = 0; i < 100; i ++) {
+        entities[i] = ecs_set(world, 0, Position, {(float)((i * 37) % 100), 0});
+    }
+
+    test_int(test_sorted_count(world, q), 100);
+
+    ecs_delete(world, entities[5]);
+    ecs_delete(world, entities[50]);
+    ecs_delete(world, entities[75]);
+    ecs_set(world, 0, Position, {33.3f, 0});
+
+    test_int(test_sorted_count(world, q), 98);
+
+    ecs_fini(world);
+}
+
+void Sorting_sort_incremental_by_key(void) {
+    ecs_world_t *world = ecs_mini();
+
+    ECS_COMPONENT(world, Position);
+
+    ecs_query_t *q = ecs_query_init(world, &(ecs_query_desc_t){
+        .filter.expr = "Position",
+        .order_by_component = ecs_id(Position),
+        .order_by_key = key_position
+    });
+
+    ecs_entity_t entities[100];
+    int i;
+    for (i = 0; i < 100; i ++) {
+        entities[i] = ecs_set(world, 0, Position, {(float)((i * 37) % 100), 0});
+    }
+
+    test_int(test_sorted_count(world, q), 100);
+
+    ecs_set(world, entities[10], Position, {1000, 0});
+    ecs_set(world, entities[20], Position, {-1000, 0});
+    ecs_set(world, 0, Position, {40.5, 0});
+    ecs_set(world, 0, Position, {-5, 0});
+
+    test_int(test_sorted_count(world, q), 102);
+
+    ecs_fini(world);
+}
+
+static
+uint64_t group_by_tag(
+    ecs_world_t *world,
+    ecs_table_t *table,
+    ecs_id_t id,
+    void *ctx)
+{
+    return ecs_table_has_id(world, table, id) ? 2 : 1;
+}
+
+void Sorting_sort_incremental_w_group_by(void) {
+    ecs_world_t *world = ecs_mini();
+
+    ECS_COMPONENT(world, Position);
+    ECS_TAG(world, Tag);
+
+    ecs_query_t *q = ecs_query_init(world, &(ecs_query_desc_t){
+        .filter.expr = "Position",
+        .order_by_component = ecs_id(Position),
+        .order_by = compare_position,
+        .group_by = group_by_tag,
+        .group_by_id = Tag
+    });
+
+    ecs_entity_t e1 = ecs_set(world, 0, Position, {3, 0});
+    ecs_entity_t e2 = ecs_set(world, 0, Position, {1, 0});
+    ecs_entity_t e3 = ecs_set(world, 0, Position, {2, 0});
+    ecs_entity_t e4 = ecs_set(world, 0, Position, {6, 0});
+    ecs_entity_t e5 = ecs_set(world, 0, Position, {5, 0});
+    ecs_entity_t e6 = ecs_set(world, 0, Position, {4, 0});
+    ecs_add(world, e4, Tag);
+    ecs_add(world, e5, Tag);
+    ecs_add(world, e6, Tag);
+
+    ecs_iter_t it = ecs_query_iter(world, q);
+    test_assert(ecs_query_next(&it));
+    test_int(it.count, 3);
+    test_uint(it.group_id, 1);
+    test_assert(it.entities[0] == e2);
+    test_assert(it.entities[1] == e3);
+    test_assert(it.entities[2] == e1);
+    test_assert(ecs_query_next(&it));
+    test_int(it.count, 3);
+    test_uint(it.group_id, 2);
+    test_assert(it.entities[0] == e6);
+    test_assert(it.entities[1] == e5);
+    test_assert(it.entities[2] == e4);
+    test_assert(!ecs_query_next(&it));
+
+    ecs_set(world, e4, Position, {0, 0});
+
+    it = ecs_query_iter(world, q);
+    test_assert(ecs_query_next(&it));
+    test_int(it.count, 3);
+    test_uint(it.group_id, 1);
+    test_assert(it.entities[0] == e2);
+    test_assert(it.entities[1] == e3);
+    test_assert(it.entities[2] == e1);
+    test_assert(ecs_query_next(&it));
+    test_int(it.count, 3);
+    test_uint(it.group_id, 2);
+    test_assert(it.entities[0] == e4);
+    test_assert(it.entities[1] == e6);
+    test_assert(it.entities[2] == e5);
+    test_assert(!ecs_query_next(&it));
+
+    ecs_fini(world);
+}
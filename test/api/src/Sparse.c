@@ -0,0 +1,637 @@
+#include <api.h>
+
+static int ctor_invoked = 0;
+static int dtor_invoked = 0;
+static int on_add_invoked = 0;
+static int on_remove_invoked = 0;
+static int on_set_invoked = 0;
+
+static ECS_CTOR(Position, ptr, {
+    ptr->x = 10;
+    ptr->y = 20;
+    ctor_invoked ++;
+})
+
+static ECS_DTOR(Position, ptr, {
+    dtor_invoked ++;
+})
+
+static void Position_on_add(ecs_iter_t *it) {
+    test_int(it->count, 1);
+    test_assert(it->entities[0] != 0);
+    on_add_invoked ++;
+}
+
+static void Position_on_remove(ecs_iter_t *it) {
+    test_int(it->count, 1);
+    test_assert(it->entities[0] != 0);
+    on_remove_invoked ++;
+}
+
+static void Position_on_set(ecs_iter_t *it) {
+    test_int(it->count, 1);
+    Position *p = ecs_field(it, Position, 1);
+    test_assert(p != NULL);
+    on_set_invoked ++;
+}
+
+void Sparse_add_remove(void) {
+    ecs_world_t *world = ecs_mini();
+
+    ECS_COMPONENT(world, Position);
+    ecs_add_id(world, ecs_id(Position), EcsSparse);
+
+    ecs_entity_t e = ecs_new_id(world);
+    ecs_add(world, e, Position);
+    test_assert(ecs_has(world, e, Position));
+    test_assert(ecs_owns(world, e, Position));
+    test_assert(ecs_get_table(world, e) == NULL);
+
+    ecs_remove(world, e, Position);
+    test_assert(!ecs_has(world, e, Position));
+    test_assert(!ecs_owns(world, e, Position));
+
+    ecs_fini(world);
+}
+
+void Sparse_add_remove_tag(void) {
+    ecs_world_t *world = ecs_mini();
+
+    ECS_TAG(world, Foo);
+    ecs_add_id(world, Foo, EcsSparse);
+
+    ecs_entity_t e = ecs_new_id(world);
+    ecs_add(world, e, Foo);
+    test_assert(ecs_has(world, e, Foo));
+    test_assert(ecs_get_table(world, e) == NULL);
+
+    ecs_remove(world, e, Foo);
+    test_assert(!ecs_has(world, e, Foo));
+
+    ecs_fini(world);
+}
+
+void Sparse_set_get(void) {
+    ecs_world_t *world = ecs_mini();
+
+    ECS_COMPONENT(world, Position);
+    ECS_COMPONENT(world, Velocity);
+    ecs_add_id(world, ecs_id(Position), EcsSparse);
+
+    ecs_entity_t e1 = ecs_set(world, 0, Position, {10, 20});
+    ecs_entity_t e2 = ecs_set(world, 0, Position, {30, 40});
+    ecs_set(world, e2, Velocity, {1, 2});
+
+    const Position *p = ecs_get(world, e1, Position);
+    test_assert(p != NULL);
+    test_int(p->x, 10);
+    test_int(p->y, 20);
+
+    p = ecs_get(world, e2, Position);
+    test_assert(p != NULL);
+    test_int(p->x, 30);
+    test_int(p->y, 40);
+
+    /* Only the non-sparse component is stored in the table */
+    test_assert(ecs_get_table(world, e2) != NULL);
+    test_int(ecs_get_type(world, e2)->count, 1);
+
+    ecs_set(world, e1, Position, {50, 60});
+    Position *pm = ecs_get_mut(world, e1, Position);
+    test_assert(pm != NULL);
+    test_int(pm->x, 50);
+    test_int(pm->y, 60);
+
+    /* Removing one entity doesn't affect storage of the other */
+    ecs_remove(world, e1, Position);
+    test_assert(ecs_get(world, e1, Position) == NULL);
+    p = ecs_get(world, e2, Position);
+    test_assert(p != NULL);
+    test_int(p->x, 30);
+    test_int(p->y, 40);
+
+    ecs_fini(world);
+}
+
+void Sparse_ensure(void) {
+    ecs_world_t *world = ecs_mini();
+
+    ECS_COMPONENT(world, Position);
+    ecs_add_id(world, ecs_id(Position), EcsSparse);
+
+    ecs_entity_t e = ecs_new_id(world);
+    Position *p = ecs_ensure(world, e, Position);
+    test_assert(p != NULL);
+    p->x = 10;
+    p->y = 20;
+    test_assert(ecs_has(world, e, Position));
+    test_assert(ecs_ensure(world, e, Position) == p);
+
+    const Position *ptr = ecs_get(world, e, Position);
+    test_assert(ptr == p);
+    test_int(ptr->x, 10);
+    test_int(ptr->y, 20);
+
+    ecs_fini(world);
+}
+
+void Sparse_emplace(void) {
+    ecs_world_t *world = ecs_mini();
+
+    ECS_COMPONENT(world, Position);
+    ecs_set_hooks(world, Position, {
+        .ctor = ecs_ctor(Position)
+    });
+    ecs_add_id(world, ecs_id(Position), EcsSparse);
+
+    ecs_entity_t e = ecs_new_id(world);
+    Position *p = ecs_emplace(world, e, Position);
+    test_assert(p != NULL);
+    test_int(ctor_invoked, 0);
+    p->x = 10;
+    p->y = 20;
+
+    const Position *ptr = ecs_get(world, e, Position);
+    test_assert(ptr == p);
+    test_int(ptr->x, 10);
+    test_int(ptr->y, 20);
+
+    ecs_fini(world);
+}
+
+void Sparse_hooks(void) {
+    ecs_world_t *world = ecs_mini();
+
+    ECS_COMPONENT(world, Position);
+    ecs_set_hooks(world, Position, {
+        .ctor = ecs_ctor(Position),
+        .dtor = ecs_dtor(Position),
+        .on_add = Position_on_add,
+        .on_remove = Position_on_remove,
+        .on_set = Position_on_set
+    });
+    ecs_add_id(world, ecs_id(Position), EcsSparse);
+
+    ecs_entity_t e = ecs_new_id(world);
+    ecs_add(world, e, Position);
+    test_int(ctor_invoked, 1);
+    test_int(on_add_invoked, 1);
+    test_int(on_set_invoked, 0);
+
+    const Position *p = ecs_get(world, e, Position);
+    test_assert(p != NULL);
+    test_int(p->x, 10);
+    test_int(p->y, 20);
+
+    ecs_set(world, e, Position, {30, 40});
+    test_int(ctor_invoked, 1);
+    test_int(on_add_invoked, 1);
+    test_int(on_set_invoked, 1);
+
+    ecs_modified(world, e, Position);
+    test_int(on_set_invoked, 2);
+
+    ecs_remove(world, e, Position);
+    test_int(on_remove_invoked, 1);
+    test_int(dtor_invoked, 1);
+
+    ecs_fini(world);
+
+    test_int(dtor_invoked, 1);
+}
+
+void Sparse_delete_entity(void) {
+    ecs_world_t *world = ecs_mini();
+
+    ECS_COMPONENT(world, Position);
+    ECS_COMPONENT(world, Velocity);
+    ecs_set_hooks(world, Position, {
+        .dtor = ecs_dtor(Position),
+        .on_remove = Position_on_remove
+    });
+    ecs_add_id(world, ecs_id(Position), EcsSparse);
+
+    ecs_entity_t e1 = ecs_set(world, 0, Position, {10, 20});
+    ecs_entity_t e2 = ecs_set(world, 0, Position, {30, 40});
+    ecs_set(world, e2, Velocity, {1, 2});
+
+    ecs_delete(world, e1);
+    test_int(on_remove_invoked, 1);
+    test_int(dtor_invoked, 1);
+
+    ecs_delete(world, e2);
+    test_int(on_remove_invoked, 2);
+    test_int(dtor_invoked, 2);
+
+    /* Recycled id must not have the component */
+    ecs_entity_t e3 = ecs_new_id(world);
+    test_assert((uint32_t)e3 == (uint32_t)e2);
+    test_assert(!ecs_has(world, e3, Position));
+
+    ecs_fini(world);
+
+    test_int(dtor_invoked, 2);
+}
+
+void Sparse_delete_with_table(void) {
+    ecs_world_t *world = ecs_mini();
+
+    ECS_COMPONENT(world, Position);
+    ECS_COMPONENT(world, Velocity);
+    ecs_set_hooks(world, Position, {
+        .dtor = ecs_dtor(Position)
+    });
+    ecs_add_id(world, ecs_id(Position), EcsSparse);
+
+    ecs_entity_t e1 = ecs_new(world, Velocity);
+    ecs_entity_t e2 = ecs_new(world, Velocity);
+    ecs_set(world, e1, Position, {10, 20});
+    ecs_set(world, e2, Position, {30, 40});
+
+    ecs_delete_with(world, ecs_id(Velocity));
+    test_assert(!ecs_is_alive(world, e1));
+    test_assert(!ecs_is_alive(world, e2));
+    test_int(dtor_invoked, 2);
+
+    ecs_fini(world);
+
+    test_int(dtor_invoked, 2);
+}
+
+void Sparse_clear_entity(void) {
+    ecs_world_t *world = ecs_mini();
+
+    ECS_COMPONENT(world, Position);
+    ECS_COMPONENT(world, Velocity);
+    ecs_set_hooks(world, Position, {
+        .dtor = ecs_dtor(Position)
+    });
+    ecs_add_id(world, ecs_id(Position), EcsSparse);
+
+    ecs_entity_t e = ecs_set(world, 0, Position, {10, 20});
+    ecs_set(world, e, Velocity, {1, 2});
+
+    ecs_clear(world, e);
+    test_assert(ecs_is_alive(world, e));
+    test_assert(!ecs_has(world, e, Position));
+    test_assert(!ecs_has(world, e, Velocity));
+    test_int(dtor_invoked, 1);
+
+    ecs_fini(world);
+
+    test_int(dtor_invoked, 1);
+}
+
+void Sparse_delete_component(void) {
+    ecs_world_t *world = ecs_mini();
+
+    ECS_TAG(world, Foo);
+    ecs_add_id(world, Foo, EcsSparse);
+
+    ecs_entity_t e = ecs_new_id(world);
+    ecs_add(world, e, Foo);
+    test_assert(ecs_has(world, e, Foo));
+
+    ecs_delete(world, Foo);
+    test_assert(ecs_is_alive(world, e));
+
+    ecs_fini(world);
+}
+
+void Sparse_delete_component_w_delete_policy(void) {
+    ecs_world_t *world = ecs_mini();
+
+    ECS_TAG(world, Foo);
+    ecs_add_id(world, Foo, EcsSparse);
+    ecs_add_pair(world, Foo, EcsOnDelete, EcsDelete);
+
+    ecs_entity_t e1 = ecs_new_id(world);
+    ecs_entity_t e2 = ecs_new_id(world);
+    ecs_add(world, e1, Foo);
+    ecs_add(world, e2, Foo);
+
+    ecs_delete(world, Foo);
+    test_assert(!ecs_is_alive(world, e1));
+    test_assert(!ecs_is_alive(world, e2));
+
+    ecs_fini(world);
+}
+
+void Sparse_deferred(void) {
+    ecs_world_t *world = ecs_mini();
+
+    ECS_COMPONENT(world, Position);
+    ECS_COMPONENT(world, Velocity);
+    ecs_add_id(world, ecs_id(Position), EcsSparse);
+
+    ecs_entity_t e = ecs_new_id(world);
+
+    ecs_defer_begin(world);
+    ecs_set(world, e, Position, {10, 20});
+    ecs_set(world, e, Velocity, {1, 2});
+    test_assert(!ecs_has(world, e, Position));
+    test_assert(!ecs_has(world, e, Velocity));
+    ecs_defer_end(world);
+
+    test_assert(ecs_has(world, e, Position));
+    test_assert(ecs_has(world, e, Velocity));
+    const Position *p = ecs_get(world, e, Position);
+    test_assert(p != NULL);
+    test_int(p->x, 10);
+    test_int(p->y, 20);
+
+    ecs_defer_begin(world);
+    ecs_remove(world, e, Position);
+    ecs_remove(world, e, Velocity);
+    ecs_add(world, e, Position);
+    ecs_defer_end(world);
+
+    test_assert(ecs_has(world, e, Position));
+    test_assert(!ecs_has(world, e, Velocity));
+
+    ecs_fini(world);
+}
+
+void Sparse_add_in_use(void) {
+    install_test_abort();
+
+    ecs_world_t *world = ecs_mini();
+
+    ECS_COMPONENT(world, Position);
+    ecs_new(world, Position);
+
+    test_expect_abort();
+    ecs_add_id(world, ecs_id(Position), EcsSparse);
+}
+
+void Sparse_filter(void) {
+    ecs_world_t *world = ecs_mini();
+
+    ECS_COMPONENT(world, Position);
+    ECS_COMPONENT(world, Velocity);
+    ecs_add_id(world, ecs_id(Position), EcsSparse);
+
+    ecs_entity_t e1 = ecs_new(world, Velocity);
+    ecs_entity_t e2 = ecs_new(world, Velocity);
+    ecs_entity_t e3 = ecs_new(world, Velocity);
+    ecs_set(world, e1, Position, {10, 20});
+    ecs_set(world, e3, Position, {30, 40});
+
+    ecs_filter_t *f = ecs_filter(world, {
+        .terms = {{ ecs_id(Position) }, { ecs_id(Velocity) }}
+    });
+    test_assert(f != NULL);
+
+    ecs_iter_t it = ecs_filter_iter(world, f);
+    test_bool(true, ecs_filter_next(&it));
+    test_int(it.count, 1);
+    test_uint(it.entities[0], e1);
+    Position *p = ecs_field(&it, Position, 1);
+    test_assert(p != NULL);
+    test_int(p->x, 10);
+    test_int(p->y, 20);
+    test_assert(ecs_field_is_set(&it, 1));
+
+    test_bool(true, ecs_filter_next(&it));
+    test_int(it.count, 1);
+    test_uint(it.entities[0], e3);
+    p = ecs_field(&it, Position, 1);
+    test_assert(p != NULL);
+    test_int(p->x, 30);
+    test_int(p->y, 40);
+
+    test_bool(false, ecs_filter_next(&it));
+
+    ecs_filter_fini(f);
+
+    (void)e2;
+
+    ecs_fini(world);
+}
+
+void Sparse_filter_not(void) {
+    ecs_world_t *world = ecs_mini();
+
+    ECS_TAG(world, Foo);
+    ECS_COMPONENT(world, Velocity);
+    ecs_add_id(world, Foo, EcsSparse);
+
+    ecs_entity_t e1 = ecs_new(world, Velocity);
+    ecs_entity_t e2 = ecs_new(world, Velocity);
+    ecs_entity_t e3 = ecs_new(world, Velocity);
+    ecs_entity_t e4 = ecs_new(world, Velocity);
+    ecs_add(world, e1, Foo);
+    ecs_add(world, e4, Foo);
+
+    ecs_filter_t *f = ecs_filter(world, {
+        .terms = {{ ecs_id(Velocity) }, { Foo, .oper = EcsNot }}
+    });
+    test_assert(f != NULL);
+
+    /* Consecutive entities that match are returned as single result */
+    ecs_iter_t it = ecs_filter_iter(world, f);
+    test_bool(true, ecs_filter_next(&it));
+    test_int(it.count, 2);
+    test_uint(it.entities[0], e2);
+    test_uint(it.entities[1], e3);
+    Velocity *v = ecs_field(&it, Velocity, 1);
+    test_assert(v == ecs_get(world, e2, Velocity));
+    test_assert(!ecs_field_is_set(&it, 2));
+
+    test_bool(false, ecs_filter_next(&it));
+
+    ecs_filter_fini(f);
+
+    ecs_fini(world);
+}
+
+void Sparse_filter_optional(void) {
+    ecs_world_t *world = ecs_mini();
+
+    ECS_COMPONENT(world, Position);
+    ECS_COMPONENT(world, Velocity);
+    ecs_add_id(world, ecs_id(Position), EcsSparse);
+
+    ecs_entity_t e1 = ecs_new(world, Velocity);
+    ecs_entity_t e2 = ecs_new(world, Velocity);
+    ecs_set(world, e2, Position, {10, 20});
+
+    ecs_filter_t *f = ecs_filter(world, {
+        .terms = {
+            { ecs_id(Velocity) },
+            { ecs_id(Position), .oper = EcsOptional }
+        }
+    });
+    test_assert(f != NULL);
+
+    ecs_iter_t it = ecs_filter_iter(world, f);
+    test_bool(true, ecs_filter_next(&it));
+    test_int(it.count, 1);
+    test_uint(it.entities[0], e1);
+    test_assert(!ecs_field_is_set(&it, 2));
+    test_assert(ecs_field(&it, Position, 2) == NULL);
+
+    test_bool(true, ecs_filter_next(&it));
+    test_int(it.count, 1);
+    test_uint(it.entities[0], e2);
+    test_assert(ecs_field_is_set(&it, 2));
+    Position *p = ecs_field(&it, Position, 2);
+    test_assert(p != NULL);
+    test_int(p->x, 10);
+    test_int(p->y, 20);
+
+    test_bool(false, ecs_filter_next(&it));
+
+    ecs_filter_fini(f);
+
+    ecs_fini(world);
+}
+
+void Sparse_filter_fixed_src(void) {
+    ecs_world_t *world = ecs_mini();
+
+    ECS_COMPONENT(world, Position);
+    ECS_COMPONENT(world, Velocity);
+    ecs_add_id(world, ecs_id(Position), EcsSparse);
+
+    ecs_entity_t e1 = ecs_new(world, Velocity);
+    ecs_entity_t s = ecs_new_id(world);
+
+    ecs_filter_t *f = ecs_filter(world, {
+        .terms = {
+            { ecs_id(Velocity) },
+            { ecs_id(Position), .src.id = s }
+        }
+    });
+    test_assert(f != NULL);
+
+    ecs_iter_t it = ecs_filter_iter(world, f);
+    test_bool(false, ecs_filter_next(&it));
+
+    ecs_set(world, s, Position, {10, 20});
+
+    it = ecs_filter_iter(world, f);
+    test_bool(true, ecs_filter_next(&it));
+    test_int(it.count, 1);
+    test_uint(it.entities[0], e1);
+    test_uint(ecs_field_src(&it, 2), s);
+    Position *p = ecs_field(&it, Position, 2);
+    test_assert(p != NULL);
+    test_int(p->x, 10);
+    test_int(p->y, 20);
+    test_bool(false, ecs_filter_next(&it));
+
+    ecs_filter_fini(f);
+
+    ecs_fini(world);
+}
+
+void Sparse_query(void) {
+    ecs_world_t *world = ecs_mini();
+
+    ECS_COMPONENT(world, Position);
+    ECS_COMPONENT(world, Velocity);
+    ecs_add_id(world, ecs_id(Position), EcsSparse);
+
+    ecs_query_t *q = ecs_query(world, {
+        .filter.terms = {{ ecs_id(Position) }, { ecs_id(Velocity) }}
+    });
+    test_assert(q != NULL);
+
+    ecs_entity_t e1 = ecs_new(world, Velocity);
+    ecs_entity_t e2 = ecs_new(world, Velocity);
+    ecs_set(world, e2, Position, {10, 20});
+
+    ecs_iter_t it = ecs_query_iter(world, q);
+    test_bool(true, ecs_query_next(&it));
+    test_int(it.count, 1);
+    test_uint(it.entities[0], e2);
+    Position *p = ecs_field(&it, Position, 1);
+    test_assert(p != NULL);
+    test_int(p->x, 10);
+    test_int(p->y, 20);
+    test_bool(false, ecs_query_next(&it));
+
+    ecs_add(world, e1, Position);
+    test_int(ecs_query_entity_count(q), 2);
+
+    it = ecs_query_iter(world, q);
+    test_bool(true, ecs_query_next(&it));
+    test_int(it.count, 1);
+    test_uint(it.entities[0], e1);
+    test_bool(true, ecs_query_next(&it));
+    test_int(it.count, 1);
+    test_uint(it.entities[0], e2);
+    test_bool(false, ecs_query_next(&it));
+
+    ecs_query_fini(q);
+
+    ecs_fini(world);
+}
+
+void Sparse_rule(void) {
+    ecs_world_t *world = ecs_mini();
+
+    ECS_COMPONENT(world, Position);
+    ECS_COMPONENT(world, Velocity);
+    ecs_add_id(world, ecs_id(Position), EcsSparse);
+
+    ecs_entity_t e1 = ecs_new(world, Velocity);
+    ecs_entity_t e2 = ecs_new(world, Velocity);
+    ecs_set(world, e2, Position, {10, 20});
+
+    ecs_rule_t *r = ecs_rule(world, {
+        .terms = {{ ecs_id(Position) }, { ecs_id(Velocity) }}
+    });
+    test_assert(r != NULL);
+
+    ecs_iter_t it = ecs_rule_iter(world, r);
+    test_bool(true, ecs_rule_next(&it));
+    test_int(it.count, 1);
+    test_uint(it.entities[0], e2);
+    Position *p = ecs_field(&it, Position, 1);
+    test_assert(p != NULL);
+    test_int(p->x, 10);
+    test_int(p->y, 20);
+    test_bool(false, ecs_rule_next(&it));
+
+    ecs_rule_fini(r);
+
+    (void)e1;
+
+    ecs_fini(world);
+}
+
+void Sparse_filter_only_sparse(void) {
+    ecs_world_t *world = ecs_mini();
+
+    ECS_COMPONENT(world, Position);
+    ecs_add_id(world, ecs_id(Position), EcsSparse);
+
+    ecs_log_set_level(-4);
+    ecs_filter_t *f = ecs_filter(world, {
+        .terms = {{ ecs_id(Position) }}
+    });
+    test_assert(f == NULL);
+
+    ecs_fini(world);
+}
+
+void Sparse_filter_sparse_up(void) {
+    ecs_world_t *world = ecs_mini();
+
+    ECS_COMPONENT(world, Position);
+    ECS_COMPONENT(world, Velocity);
+    ecs_add_id(world, ecs_id(Position), EcsSparse);
+
+    ecs_log_set_level(-4);
+    ecs_filter_t *f = ecs_filter(world, {
+        .terms = {
+            { ecs_id(Velocity) },
+            { ecs_id(Position), .src.flags = EcsUp }
+        }
+    });
+    test_assert(f == NULL);
+
+    ecs_fini(world);
+}
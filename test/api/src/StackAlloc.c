@@ -63,3 +63,230 @@ void StackAlloc_multiple_overlapping_cursors(void) {
     ecs_fini(world);
 
 }
+
+static
+int64_t os_alloc_count(void) {
+    return ecs_os_api_malloc_count + ecs_os_api_calloc_count;
+}
+
+void StackAlloc_cache_alloc_free(void) {
+    ecs_world_t *world = ecs_mini();
+
+    ecs_balloc_depot_t depot;
+    flecs_balloc_depot_init(&depot, ECS_SIZEOF(int64_t));
+
+    ecs_balloc_cache_t cache;
+    flecs_balloc_cache_init(&cache, &depot);
+
+    int64_t *ptrs[100];
+    int32_t i;
+    for (i = 0; i < 100; i ++) {
+        ptrs[i] = flecs_balloc_cache_alloc(&cache);
+        test_assert(ptrs[i] != NULL);
+        *ptrs[i] = i;
+    }
+
+    for (i = 0; i < 100; i ++) {
+        test_int(*ptrs[i], i);
+        flecs_balloc_cache_free(&cache, ptrs[i]);
+    }
+
+    /* Chunks are held by the cache and depot, so allocating them again should
+     * not hit the OS allocator */
+    int64_t alloc_count = os_alloc_count();
+
+    for (i = 0; i < 100; i ++) {
+        ptrs[i] = flecs_balloc_cache_alloc(&cache);
+        test_assert(ptrs[i] != NULL);
+    }
+
+    test_int(os_alloc_count(), alloc_count);
+
+    for (i = 0; i < 100; i ++) {
+        flecs_balloc_cache_free(&cache, ptrs[i]);
+    }
+
+    flecs_balloc_cache_fini(&cache);
+    flecs_balloc_depot_fini(&depot);
+
+    ecs_fini(world);
+}
+
+void StackAlloc_cache_exchange_w_depot(void) {
+    ecs_world_t *world = ecs_mini();
+
+    ecs_balloc_depot_t depot;
+    flecs_balloc_depot_init(&depot, ECS_SIZEOF(int64_t));
+
+    ecs_balloc_cache_t cache_a, cache_b;
+    flecs_balloc_cache_init(&cache_a, &depot);
+    flecs_balloc_cache_init(&cache_b, &depot);
+
+    /* Allocate in one cache, free in the other */
+    int32_t count = FLECS_BALLOC_MAGAZINE_SIZE * 4;
+    void **ptrs = ecs_os_malloc_n(void*, count);
+    int32_t i;
+    for (i = 0; i < count; i ++) {
+        ptrs[i] = flecs_balloc_cache_alloc(&cache_a);
+    }
+
+    for (i = 0; i < count; i ++) {
+        flecs_balloc_cache_free(&cache_b, ptrs[i]);
+    }
+
+    /* Full magazines should have been handed to the depot */
+    test_assert(depot.full_count > 0);
+
+    /* Cache a should be able to allocate from magazines returned by b */
+    int64_t alloc_count = os_alloc_count();
+    int32_t full_count = depot.full_count;
+    for (i = 0; i < FLECS_BALLOC_MAGAZINE_SIZE; i ++) {
+        ptrs[i] = flecs_balloc_cache_alloc(&cache_a);
+    }
+    test_int(os_alloc_count(), alloc_count);
+    test_int(depot.full_count, full_count - 1);
+
+    for (i = 0; i < FLECS_BALLOC_MAGAZINE_SIZE; i ++) {
+        flecs_balloc_cache_free(&cache_a, ptrs[i]);
+    }
+
+    ecs_os_free(ptrs);
+
+    flecs_balloc_cache_fini(&cache_a);
+    flecs_balloc_cache_fini(&cache_b);
+    flecs_balloc_depot_fini(&depot);
+
+    ecs_fini(world);
+}
+
+typedef struct cache_thread_ctx_t {
+    ecs_balloc_depot_t *depot;
+    int32_t errors;
+} cache_thread_ctx_t;
+
+static
+void* cache_thread(void *arg) {
+    cache_thread_ctx_t *ctx = arg;
+    ecs_balloc_cache_t cache;
+    flecs_balloc_cache_init(&cache, ctx->depot);
+
+    int64_t *ptrs[256];
+    int32_t i, j;
+    for (j = 0; j < 100; j ++) {
+        for (i = 0; i < 256; i ++) {
+            ptrs[i] = flecs_balloc_cache_alloc(&cache);
+            *ptrs[i] = i + j;
+        }
+        for (i = 0; i < 256; i ++) {
+            if (*ptrs[i] != i + j) {
+                ctx->errors ++;
+            }
+            flecs_balloc_cache_free(&cache, ptrs[i]);
+        }
+    }
+
+    flecs_balloc_cache_fini(&cache);
+    return NULL;
+}
+
+void StackAlloc_cache_multithreaded(void) {
+    ecs_world_t *world = ecs_mini();
+
+    ecs_balloc_depot_t depot;
+    flecs_balloc_depot_init(&depot, ECS_SIZEOF(int64_t));
+
+    cache_thread_ctx_t ctx[4] = {{0}};
+    ecs_os_thread_t threads[4];
+    int32_t i;
+    for (i = 0; i < 4; i ++) {
+        ctx[i].depot = &depot;
+        threads[i] = ecs_os_thread_new(cache_thread, &ctx[i]);
+    }
+
+    for (i = 0; i < 4; i ++) {
+        ecs_os_thread_join(threads[i]);
+        test_int(ctx[i].errors, 0);
+    }
+
+    flecs_balloc_depot_fini(&depot);
+
+    ecs_fini(world);
+}
+
+void StackAlloc_stack_w_cache(void) {
+    ecs_world_t *world = ecs_mini();
+
+    ecs_balloc_depot_t depot;
+    flecs_balloc_depot_init(&depot, FLECS_STACK_PAGE_ALLOC_SIZE);
+
+    ecs_balloc_cache_t cache;
+    flecs_balloc_cache_init(&cache, &depot);
+
+    ecs_stack_t stack;
+    flecs_stack_init_w_cache(&stack, &cache);
+
+    ecs_stack_cursor_t *cursor = flecs_stack_get_cursor(&stack);
+    int32_t i;
+    for (i = 0; i < 4; i ++) {
+        void *ptr = flecs_stack_calloc(&stack, ECS_STACK_PAGE_SIZE / 2, 16);
+        test_assert(ptr != NULL);
+    }
+    test_assert(stack.tail_page != &stack.first);
+    flecs_stack_restore_cursor(&stack, cursor);
+    flecs_stack_fini(&stack);
+
+    /* Pages of the next stack should come from the cache */
+    int64_t alloc_count = os_alloc_count();
+    flecs_stack_init_w_cache(&stack, &cache);
+    cursor = flecs_stack_get_cursor(&stack);
+    for (i = 0; i < 4; i ++) {
+        void *ptr = flecs_stack_calloc(&stack, ECS_STACK_PAGE_SIZE / 2, 16);
+        test_assert(ptr != NULL);
+    }
+    test_int(os_alloc_count(), alloc_count);
+    flecs_stack_restore_cursor(&stack, cursor);
+    flecs_stack_fini(&stack);
+
+    flecs_balloc_cache_fini(&cache);
+    flecs_balloc_depot_fini(&depot);
+
+    ecs_fini(world);
+}
+
+void StackAlloc_stage_steady_state_no_os_alloc(void) {
+    ecs_world_t *world = ecs_mini();
+
+    ECS_COMPONENT(world, Position);
+
+    /* Warm up stage allocators, after which deferred commands should no longer
+     * need the OS allocator */
+    ecs_entity_t e = ecs_new_id(world);
+    int32_t i;
+    for (i = 0; i < 2; i ++) {
+        ecs_defer_begin(world);
+        ecs_set(world, e, Position, {10, 20});
+        ecs_bulk_new(world, Position, 10);
+        ecs_defer_end(world);
+    }
+
+    int64_t alloc_count = os_alloc_count();
+
+    for (i = 0; i < 10; i ++) {
+        ecs_defer_begin(world);
+        ecs_set(world, e, Position, {10 + i, 20 + i});
+        ecs_defer_end(world);
+    }
+
+#ifndef FLECS_USE_OS_ALLOC /* Block allocators use OS allocator */
+    test_int(os_alloc_count(), alloc_count);
+#else
+    (void)alloc_count;
+#endif
+
+    const Position *p = ecs_get(world, e, Position);
+    test_assert(p != NULL);
+    test_int(p->x, 19);
+    test_int(p->y, 29);
+
+    ecs_fini(world);
+}
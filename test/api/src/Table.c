@@ -377,3 +377,115 @@ void Table_get_column_size(void) {
 
     ecs_fini(world);
 }
+
+typedef struct Large {
+    int32_t value;
+    char payload[1020];
+} Large;
+
+void Table_vmem_column_no_move(void) {
+    ecs_world_t *world = ecs_mini();
+
+    test_assert(ecs_os_has_vmem());
+
+    ECS_COMPONENT(world, Large);
+
+    /* Exceed threshold for storing column in virtual memory */
+    int32_t i, count = FLECS_VMEM_COLUMN_THRESHOLD / ECS_SIZEOF(Large) + 1;
+    ecs_entity_t *entities = ecs_os_malloc_n(ecs_entity_t, count * 4);
+    for (i = 0; i < count; i ++) {
+        entities[i] = ecs_set(world, 0, Large, {i});
+    }
+
+    /* Virtual memory column starts at a page boundary */
+    const Large *first = ecs_get(world, entities[0], Large);
+    test_assert(first != NULL);
+    test_int((uintptr_t)first % 4096, 0);
+
+    for (; i < count * 4; i ++) {
+        entities[i] = ecs_set(world, 0, Large, {i});
+    }
+
+    test_assert(ecs_get(world, entities[0], Large) == first);
+
+    for (i = 0; i < count * 4; i ++) {
+        const Large *ptr = ecs_get(world, entities[i], Large);
+        test_assert(ptr != NULL);
+        test_int(ptr->value, i);
+    }
+
+    ecs_os_free(entities);
+
+    ecs_fini(world);
+}
+
+void Table_vmem_column_merge(void) {
+    ecs_world_t *world = ecs_mini();
+
+    ECS_COMPONENT(world, Large);
+    ECS_COMPONENT(world, Position);
+    ECS_TAG(world, Tag);
+
+    int32_t i, count = FLECS_VMEM_COLUMN_THRESHOLD / ECS_SIZEOF(Large) * 2;
+    ecs_entity_t *entities = ecs_os_malloc_n(ecs_entity_t, count);
+    for (i = 0; i < count; i ++) {
+        entities[i] = ecs_set(world, 0, Large, {i});
+        ecs_add(world, entities[i], Tag);
+        if (i % 2) {
+            ecs_set(world, entities[i], Position, {i, i});
+        }
+    }
+
+    /* Merges the tables with Tag into the tables without Tag */
+    ecs_remove_all(world, Tag);
+
+    for (i = 0; i < count; i ++) {
+        test_assert(!ecs_has(world, entities[i], Tag));
+        const Large *ptr = ecs_get(world, entities[i], Large);
+        test_assert(ptr != NULL);
+        test_int(ptr->value, i);
+        if (i % 2) {
+            const Position *p = ecs_get(world, entities[i], Position);
+            test_assert(p != NULL);
+            test_int(p->x, i);
+        }
+    }
+
+    ecs_os_free(entities);
+
+    ecs_fini(world);
+}
+
+void Table_vmem_column_shrink(void) {
+    ecs_world_t *world = ecs_mini();
+
+    ECS_COMPONENT(world, Large);
+
+    int32_t i, count = FLECS_VMEM_COLUMN_THRESHOLD / ECS_SIZEOF(Large) * 2;
+    ecs_entity_t *entities = ecs_os_malloc_n(ecs_entity_t, count);
+    for (i = 0; i < count; i ++) {
+        entities[i] = ecs_set(world, 0, Large, {i});
+    }
+
+    for (i = 0; i < count; i ++) {
+        ecs_delete(world, entities[i]);
+    }
+
+    /* Shrink empty table, releases column storage */
+    test_int(ecs_delete_empty_tables(world, ecs_id(Large), 1, 0, 0, 0), 0);
+    test_int(ecs_delete_empty_tables(world, ecs_id(Large), 1, 0, 0, 0), 0);
+
+    for (i = 0; i < count / 2; i ++) {
+        entities[i] = ecs_set(world, 0, Large, {i});
+    }
+
+    for (i = 0; i < count / 2; i ++) {
+        const Large *ptr = ecs_get(world, entities[i], Large);
+        test_assert(ptr != NULL);
+        test_int(ptr->value, i);
+    }
+
+    ecs_os_free(entities);
+
+    ecs_fini(world);
+}
@@ -293,6 +293,12 @@ void Add_invalid_pair_w_0(void);
 void Add_invalid_pair_w_0_rel(void);
 void Add_invalid_pair_w_0_obj(void);
 void Add_add_random_id(void);
+void Add_bulk_add_id_table(void);
+void Add_bulk_add_id_range(void);
+void Add_bulk_add_id_w_hooks(void);
+void Add_bulk_add_id_deferred(void);
+void Add_iter_add_id(void);
+void Add_iter_add_id_w_query(void);
 
 // Testsuite 'Switch'
 void Switch_get_case_no_switch(void);
@@ -343,6 +349,29 @@ void Switch_add_switch_to_prefab_instance(void);
 void Switch_get_case_w_generation(void);
 void Switch_get_case_w_generation_not_alive(void);
 
+// Testsuite 'Sparse'
+void Sparse_add_remove(void);
+void Sparse_add_remove_tag(void);
+void Sparse_set_get(void);
+void Sparse_ensure(void);
+void Sparse_emplace(void);
+void Sparse_hooks(void);
+void Sparse_delete_entity(void);
+void Sparse_delete_with_table(void);
+void Sparse_clear_entity(void);
+void Sparse_delete_component(void);
+void Sparse_delete_component_w_delete_policy(void);
+void Sparse_deferred(void);
+void Sparse_add_in_use(void);
+void Sparse_filter(void);
+void Sparse_filter_not(void);
+void Sparse_filter_optional(void);
+void Sparse_filter_fixed_src(void);
+void Sparse_query(void);
+void Sparse_rule(void);
+void Sparse_filter_only_sparse(void);
+void Sparse_filter_sparse_up(void);
+
 // Testsuite 'EnabledComponents'
 void EnabledComponents_is_component_enabled(void);
 void EnabledComponents_is_empty_entity_disabled(void);
@@ -408,6 +437,10 @@ void Remove_2_again(void);
 void Remove_2_overlap(void);
 void Remove_1_from_empty(void);
 void Remove_not_added(void);
+void Remove_bulk_remove_id_table(void);
+void Remove_bulk_remove_id_range(void);
+void Remove_bulk_remove_last_component(void);
+void Remove_iter_remove_id(void);
 
 // Testsuite 'GlobalComponentIds'
 void GlobalComponentIds_declare(void);
@@ -1058,6 +1091,17 @@ void Sorting_sort_component_not_queried_for(void);
 void Sorting_sort_by_wildcard(void);
 void Sorting_sort_shared_w_delete(void);
 void Sorting_sort_w_nontrivial_component(void);
+void Sorting_sort_by_key(void);
+void Sorting_sort_by_key_negative_float(void);
+void Sorting_sort_by_key_2_tables(void);
+void Sorting_sort_by_key_after_set(void);
+void Sorting_sort_by_key_many(void);
+void Sorting_sort_by_key_entity(void);
+void Sorting_sort_incremental_append(void);
+void Sorting_sort_incremental_modify(void);
+void Sorting_sort_incremental_delete(void);
+void Sorting_sort_incremental_by_key(void);
+void Sorting_sort_incremental_w_group_by(void);
 
 // Testsuite 'SortingEntireTable'
 void SortingEntireTable_sort_by_component(void);
@@ -1403,6 +1447,10 @@ void Filter_flag_match_only_this(void);
 void Filter_flag_match_only_this_w_ref(void);
 void Filter_filter_w_alloc(void);
 void Filter_filter_w_short_notation(void);
+void Filter_filter_signature_wildcard_pair(void);
+void Filter_filter_signature_inherited(void);
+void Filter_filter_signature_up(void);
+void Filter_filter_signature_union(void);
 
 // Testsuite 'FilterStr'
 void FilterStr_one_term(void);
@@ -1689,6 +1737,14 @@ void Query_cached_match_empty_w_order_by(void);
 void Query_cached_match_new_empty_w_order_by(void);
 void Query_cached_match_empty_w_bitset(void);
 void Query_default_query_flags(void);
+void Query_changed_rows_first_iter(void);
+void Query_changed_rows_after_modified(void);
+void Query_changed_rows_after_add(void);
+void Query_changed_rows_after_delete(void);
+void Query_changed_rows_skip_unchanged_table(void);
+void Query_changed_rows_w_inout_writer(void);
+void Query_changed_rows_w_regular_writer(void);
+void Query_changed_rows_w_shared(void);
 
 // Testsuite 'Iter'
 void Iter_page_iter_0_0(void);
@@ -1739,6 +1795,18 @@ void Iter_to_str(void);
 void Iter_filter_eval_count(void);
 void Iter_query_eval_count(void);
 void Iter_rule_eval_count(void);
+void Iter_balanced_worker_iter_2(void);
+void Iter_balanced_worker_iter_many_tables(void);
+void Iter_balanced_worker_iter_large_table(void);
+void Iter_balanced_worker_iter_more_workers_than_tables(void);
+void Iter_balanced_worker_iter_w_filter(void);
+void Iter_balanced_worker_iter_w_fini(void);
+void Iter_balanced_worker_iter_split_table(void);
+void Iter_chunk_iter(void);
+void Iter_chunk_iter_unaligned_offset(void);
+void Iter_chunk_iter_2_tables(void);
+void Iter_chunk_iter_aligned_columns(void);
+void Iter_enable_aligned_columns_existing_tables(void);
 
 // Testsuite 'Pairs'
 void Pairs_type_w_one_pair(void);
@@ -2609,6 +2677,30 @@ void Commands_add_path_to_deleted_parent_w_stage(void);
 void Commands_add_path_nested_w_stage(void);
 void Commands_add_path_nested_to_deleted_parent_w_stage(void);
 void Commands_add_path_nested_to_created_deleted_parent_w_stage(void);
+void Commands_combined_merge_2_stages(void);
+void Commands_combined_merge_disabled(void);
+void Commands_combined_merge_stage_order(void);
+void Commands_combined_merge_delete_in_other_stage(void);
+void Commands_combined_merge_no_automerge_stage(void);
+void Commands_combined_merge_repeated(void);
+void Commands_cmd_queue_add(void);
+void Commands_cmd_queue_remove(void);
+void Commands_cmd_queue_set(void);
+void Commands_cmd_queue_set_large_value(void);
+void Commands_cmd_queue_delete(void);
+void Commands_cmd_queue_emit(void);
+void Commands_cmd_queue_full(void);
+void Commands_cmd_queue_not_alive(void);
+void Commands_cmd_queue_drain_deferred(void);
+void Commands_cmd_queue_free_not_drained(void);
+void Commands_merge_on_set_batched(void);
+void Commands_merge_on_set_batched_existing(void);
+void Commands_merge_on_set_not_contiguous(void);
+void Commands_merge_on_set_different_tables(void);
+void Commands_merge_on_set_collapse_duplicate(void);
+void Commands_merge_on_set_collapse_duplicate_w_hook(void);
+void Commands_merge_on_set_w_delete(void);
+void Commands_merge_on_set_entity_moved_by_observer(void);
 
 // Testsuite 'SingleThreadStaging'
 void SingleThreadStaging_setup(void);
@@ -2713,6 +2805,9 @@ void Table_get_depth(void);
 void Table_get_depth_non_acyclic(void);
 void Table_get_depth_2_paths(void);
 void Table_get_column_size(void);
+void Table_vmem_column_no_move(void);
+void Table_vmem_column_merge(void);
+void Table_vmem_column_shrink(void);
 
 // Testsuite 'Poly'
 void Poly_iter_query(void);
@@ -2772,6 +2867,11 @@ void Error_last_error(void);
 // Testsuite 'StackAlloc'
 void StackAlloc_init_fini(void);
 void StackAlloc_multiple_overlapping_cursors(void);
+void StackAlloc_cache_alloc_free(void);
+void StackAlloc_cache_exchange_w_depot(void);
+void StackAlloc_cache_multithreaded(void);
+void StackAlloc_stack_w_cache(void);
+void StackAlloc_stage_steady_state_no_os_alloc(void);
 
 bake_test_case Id_testcases[] = {
     {
@@ -3875,6 +3975,30 @@ bake_test_case Add_testcases[] = {
     {
         "add_random_id",
         Add_add_random_id
+    },
+    {
+        "bulk_add_id_table",
+        Add_bulk_add_id_table
+    },
+    {
+        "bulk_add_id_range",
+        Add_bulk_add_id_range
+    },
+    {
+        "bulk_add_id_w_hooks",
+        Add_bulk_add_id_w_hooks
+    },
+    {
+        "bulk_add_id_deferred",
+        Add_bulk_add_id_deferred
+    },
+    {
+        "iter_add_id",
+        Add_iter_add_id
+    },
+    {
+        "iter_add_id_w_query",
+        Add_iter_add_id_w_query
     }
 };
 
@@ -4069,6 +4193,93 @@ bake_test_case Switch_testcases[] = {
     }
 };
 
+bake_test_case Sparse_testcases[] = {
+    {
+        "add_remove",
+        Sparse_add_remove
+    },
+    {
+        "add_remove_tag",
+        Sparse_add_remove_tag
+    },
+    {
+        "set_get",
+        Sparse_set_get
+    },
+    {
+        "ensure",
+        Sparse_ensure
+    },
+    {
+        "emplace",
+        Sparse_emplace
+    },
+    {
+        "hooks",
+        Sparse_hooks
+    },
+    {
+        "delete_entity",
+        Sparse_delete_entity
+    },
+    {
+        "delete_with_table",
+        Sparse_delete_with_table
+    },
+    {
+        "clear_entity",
+        Sparse_clear_entity
+    },
+    {
+        "delete_component",
+        Sparse_delete_component
+    },
+    {
+        "delete_component_w_delete_policy",
+        Sparse_delete_component_w_delete_policy
+    },
+    {
+        "deferred",
+        Sparse_deferred
+    },
+    {
+        "add_in_use",
+        Sparse_add_in_use
+    },
+    {
+        "filter",
+        Sparse_filter
+    },
+    {
+        "filter_not",
+        Sparse_filter_not
+    },
+    {
+        "filter_optional",
+        Sparse_filter_optional
+    },
+    {
+        "filter_fixed_src",
+        Sparse_filter_fixed_src
+    },
+    {
+        "query",
+        Sparse_query
+    },
+    {
+        "rule",
+        Sparse_rule
+    },
+    {
+        "filter_only_sparse",
+        Sparse_filter_only_sparse
+    },
+    {
+        "filter_sparse_up",
+        Sparse_filter_sparse_up
+    }
+};
+
 bake_test_case EnabledComponents_testcases[] = {
     {
         "is_component_enabled",
@@ -4320,6 +4531,22 @@ bake_test_case Remove_testcases[] = {
     {
         "not_added",
         Remove_not_added
+    },
+    {
+        "bulk_remove_id_table",
+        Remove_bulk_remove_id_table
+    },
+    {
+        "bulk_remove_id_range",
+        Remove_bulk_remove_id_range
+    },
+    {
+        "bulk_remove_last_component",
+        Remove_bulk_remove_last_component
+    },
+    {
+        "iter_remove_id",
+        Remove_iter_remove_id
     }
 };
 
@@ -6816,6 +7043,50 @@ bake_test_case Sorting_testcases[] = {
     {
         "sort_w_nontrivial_component",
         Sorting_sort_w_nontrivial_component
+    },
+    {
+        "sort_by_key",
+        Sorting_sort_by_key
+    },
+    {
+        "sort_by_key_negative_float",
+        Sorting_sort_by_key_negative_float
+    },
+    {
+        "sort_by_key_2_tables",
+        Sorting_sort_by_key_2_tables
+    },
+    {
+        "sort_by_key_after_set",
+        Sorting_sort_by_key_after_set
+    },
+    {
+        "sort_by_key_many",
+        Sorting_sort_by_key_many
+    },
+    {
+        "sort_by_key_entity",
+        Sorting_sort_by_key_entity
+    },
+    {
+        "sort_incremental_append",
+        Sorting_sort_incremental_append
+    },
+    {
+        "sort_incremental_modify",
+        Sorting_sort_incremental_modify
+    },
+    {
+        "sort_incremental_delete",
+        Sorting_sort_incremental_delete
+    },
+    {
+        "sort_incremental_by_key",
+        Sorting_sort_incremental_by_key
+    },
+    {
+        "sort_incremental_w_group_by",
+        Sorting_sort_incremental_w_group_by
     }
 };
 
@@ -8186,6 +8457,22 @@ bake_test_case Filter_testcases[] = {
     {
         "filter_w_short_notation",
         Filter_filter_w_short_notation
+    },
+    {
+        "filter_signature_wildcard_pair",
+        Filter_filter_signature_wildcard_pair
+    },
+    {
+        "filter_signature_inherited",
+        Filter_filter_signature_inherited
+    },
+    {
+        "filter_signature_up",
+        Filter_filter_signature_up
+    },
+    {
+        "filter_signature_union",
+        Filter_filter_signature_union
     }
 };
 
@@ -9320,6 +9607,38 @@ bake_test_case Query_testcases[] = {
     {
         "default_query_flags",
         Query_default_query_flags
+    },
+    {
+        "changed_rows_first_iter",
+        Query_changed_rows_first_iter
+    },
+    {
+        "changed_rows_after_modified",
+        Query_changed_rows_after_modified
+    },
+    {
+        "changed_rows_after_add",
+        Query_changed_rows_after_add
+    },
+    {
+        "changed_rows_after_delete",
+        Query_changed_rows_after_delete
+    },
+    {
+        "changed_rows_skip_unchanged_table",
+        Query_changed_rows_skip_unchanged_table
+    },
+    {
+        "changed_rows_w_inout_writer",
+        Query_changed_rows_w_inout_writer
+    },
+    {
+        "changed_rows_w_regular_writer",
+        Query_changed_rows_w_regular_writer
+    },
+    {
+        "changed_rows_w_shared",
+        Query_changed_rows_w_shared
     }
 };
 
@@ -9515,6 +9834,54 @@ bake_test_case Iter_testcases[] = {
     {
         "rule_eval_count",
         Iter_rule_eval_count
+    },
+    {
+        "balanced_worker_iter_2",
+        Iter_balanced_worker_iter_2
+    },
+    {
+        "balanced_worker_iter_many_tables",
+        Iter_balanced_worker_iter_many_tables
+    },
+    {
+        "balanced_worker_iter_large_table",
+        Iter_balanced_worker_iter_large_table
+    },
+    {
+        "balanced_worker_iter_more_workers_than_tables",
+        Iter_balanced_worker_iter_more_workers_than_tables
+    },
+    {
+        "balanced_worker_iter_w_filter",
+        Iter_balanced_worker_iter_w_filter
+    },
+    {
+        "balanced_worker_iter_w_fini",
+        Iter_balanced_worker_iter_w_fini
+    },
+    {
+        "balanced_worker_iter_split_table",
+        Iter_balanced_worker_iter_split_table
+    },
+    {
+        "chunk_iter",
+        Iter_chunk_iter
+    },
+    {
+        "chunk_iter_unaligned_offset",
+        Iter_chunk_iter_unaligned_offset
+    },
+    {
+        "chunk_iter_2_tables",
+        Iter_chunk_iter_2_tables
+    },
+    {
+        "chunk_iter_aligned_columns",
+        Iter_chunk_iter_aligned_columns
+    },
+    {
+        "enable_aligned_columns_existing_tables",
+        Iter_enable_aligned_columns_existing_tables
     }
 };
 
@@ -12914,6 +13281,102 @@ bake_test_case Commands_testcases[] = {
     {
         "add_path_nested_to_created_deleted_parent_w_stage",
         Commands_add_path_nested_to_created_deleted_parent_w_stage
+    },
+    {
+        "combined_merge_2_stages",
+        Commands_combined_merge_2_stages
+    },
+    {
+        "combined_merge_disabled",
+        Commands_combined_merge_disabled
+    },
+    {
+        "combined_merge_stage_order",
+        Commands_combined_merge_stage_order
+    },
+    {
+        "combined_merge_delete_in_other_stage",
+        Commands_combined_merge_delete_in_other_stage
+    },
+    {
+        "combined_merge_no_automerge_stage",
+        Commands_combined_merge_no_automerge_stage
+    },
+    {
+        "combined_merge_repeated",
+        Commands_combined_merge_repeated
+    },
+    {
+        "cmd_queue_add",
+        Commands_cmd_queue_add
+    },
+    {
+        "cmd_queue_remove",
+        Commands_cmd_queue_remove
+    },
+    {
+        "cmd_queue_set",
+        Commands_cmd_queue_set
+    },
+    {
+        "cmd_queue_set_large_value",
+        Commands_cmd_queue_set_large_value
+    },
+    {
+        "cmd_queue_delete",
+        Commands_cmd_queue_delete
+    },
+    {
+        "cmd_queue_emit",
+        Commands_cmd_queue_emit
+    },
+    {
+        "cmd_queue_full",
+        Commands_cmd_queue_full
+    },
+    {
+        "cmd_queue_not_alive",
+        Commands_cmd_queue_not_alive
+    },
+    {
+        "cmd_queue_drain_deferred",
+        Commands_cmd_queue_drain_deferred
+    },
+    {
+        "cmd_queue_free_not_drained",
+        Commands_cmd_queue_free_not_drained
+    },
+    {
+        "merge_on_set_batched",
+        Commands_merge_on_set_batched
+    },
+    {
+        "merge_on_set_batched_existing",
+        Commands_merge_on_set_batched_existing
+    },
+    {
+        "merge_on_set_not_contiguous",
+        Commands_merge_on_set_not_contiguous
+    },
+    {
+        "merge_on_set_different_tables",
+        Commands_merge_on_set_different_tables
+    },
+    {
+        "merge_on_set_collapse_duplicate",
+        Commands_merge_on_set_collapse_duplicate
+    },
+    {
+        "merge_on_set_collapse_duplicate_w_hook",
+        Commands_merge_on_set_collapse_duplicate_w_hook
+    },
+    {
+        "merge_on_set_w_delete",
+        Commands_merge_on_set_w_delete
+    },
+    {
+        "merge_on_set_entity_moved_by_observer",
+        Commands_merge_on_set_entity_moved_by_observer
     }
 };
 
@@ -13307,6 +13770,18 @@ bake_test_case Table_testcases[] = {
     {
         "get_column_size",
         Table_get_column_size
+    },
+    {
+        "vmem_column_no_move",
+        Table_vmem_column_no_move
+    },
+    {
+        "vmem_column_merge",
+        Table_vmem_column_merge
+    },
+    {
+        "vmem_column_shrink",
+        Table_vmem_column_shrink
     }
 };
 
@@ -13515,6 +13990,26 @@ bake_test_case StackAlloc_testcases[] = {
     {
         "multiple_overlapping_cursors",
         StackAlloc_multiple_overlapping_cursors
+    },
+    {
+        "cache_alloc_free",
+        StackAlloc_cache_alloc_free
+    },
+    {
+        "cache_exchange_w_depot",
+        StackAlloc_cache_exchange_w_depot
+    },
+    {
+        "cache_multithreaded",
+        StackAlloc_cache_multithreaded
+    },
+    {
+        "stack_w_cache",
+        StackAlloc_stack_w_cache
+    },
+    {
+        "stage_steady_state_no_os_alloc",
+        StackAlloc_stage_steady_state_no_os_alloc
     }
 };
 
@@ -13566,7 +14061,7 @@ static bake_test_suite suites[] = {
         "Add",
         NULL,
         NULL,
-        26,
+        32,
         Add_testcases
     },
     {
@@ -13576,6 +14071,13 @@ static bake_test_suite suites[] = {
         47,
         Switch_testcases
     },
+    {
+        "Sparse",
+        NULL,
+        NULL,
+        21,
+        Sparse_testcases
+    },
     {
         "EnabledComponents",
         NULL,
@@ -13587,7 +14089,7 @@ static bake_test_suite suites[] = {
         "Remove",
         NULL,
         NULL,
-        10,
+        14,
         Remove_testcases
     },
     {
@@ -13699,7 +14201,7 @@ static bake_test_suite suites[] = {
         "Sorting",
         NULL,
         NULL,
-        38,
+        49,
         Sorting_testcases
     },
     {
@@ -13713,7 +14215,7 @@ static bake_test_suite suites[] = {
         "Filter",
         NULL,
         NULL,
-        307,
+        311,
         Filter_testcases
     },
     {
@@ -13727,14 +14229,14 @@ static bake_test_suite suites[] = {
         "Query",
         NULL,
         NULL,
-        253,
+        261,
         Query_testcases
     },
     {
         "Iter",
         NULL,
         NULL,
-        48,
+        60,
         Iter_testcases
     },
     {
@@ -13825,7 +14327,7 @@ static bake_test_suite suites[] = {
         "Commands",
         NULL,
         NULL,
-        133,
+        157,
         Commands_testcases
     },
     {
@@ -13846,7 +14348,7 @@ static bake_test_suite suites[] = {
         "Table",
         NULL,
         NULL,
-        14,
+        17,
         Table_testcases
     },
     {
@@ -13874,11 +14376,11 @@ static bake_test_suite suites[] = {
         "StackAlloc",
         NULL,
         NULL,
-        2,
+        7,
         StackAlloc_testcases
     }
 };
 
 int main(int argc, char *argv[]) {
-    return bake_test_run("api", argc, argv, suites, 51);
+    return bake_test_run("api", argc, argv, suites, 52);
 }
@@ -118,3 +118,47 @@ void Iterable_worker_iter(void) {
 
     test_int(count, 2);
 }
+
+void Iterable_chunk_each(void) {
+    flecs::world ecs;
+
+    for (int i = 0; i < 10; i ++) {
+        ecs.entity().set<Position>({ static_cast<float>(i), 0 });
+    }
+
+    auto q = ecs.query<Position>();
+
+    int32_t count = 0;
+    q.chunk(4).each([&](Position& p) {
+        test_int(p.x, count);
+        count ++;
+    });
+
+    test_int(count, 10);
+}
+
+void Iterable_chunk_iter_aligned(void) {
+    flecs::world ecs;
+
+    ecs.enable_aligned_columns();
+
+    for (int i = 0; i < 20; i ++) {
+        ecs.entity().set<Position>({ static_cast<float>(i), 0 });
+    }
+
+    auto q = ecs.query<Position>();
+
+    const int32_t chunk_size = FLECS_COLUMN_ALIGNMENT / sizeof(Position);
+    int32_t count = 0;
+    q.chunk(chunk_size).iter([&](flecs::iter& it) {
+        test_assert(it.count() <= chunk_size);
+        Position *p = it.field_aligned<Position>(1);
+        test_int(reinterpret_cast<uintptr_t>(p) % FLECS_COLUMN_ALIGNMENT, 0);
+        for (auto i : it) {
+            test_int(p[i].x, count);
+            count ++;
+        }
+    });
+
+    test_int(count, 20);
+}
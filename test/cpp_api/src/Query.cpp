@@ -597,6 +597,37 @@ void Query_sort_by(void) {
     });
 }
 
+static
+uint64_t key_position(
+    flecs::entity_t e,
+    const Position *p)
+{
+    return ecs_float_to_sort_key(p->x);
+}
+
+void Query_sort_by_key(void) {
+    flecs::world world;
+
+    world.entity().set<Position>({1, 0});
+    world.entity().set<Position>({6, 0});
+    world.entity().set<Position>({-2, 0});
+    world.entity().set<Position>({5, 0});
+    world.entity().set<Position>({4, 0});
+
+    auto q = world.query_builder<Position>()
+        .order_by_key(key_position)
+        .build();
+
+    q.iter([](flecs::iter it, Position *p) {
+        test_int(it.count(), 5);
+        test_int(p[0].x, -2);
+        test_int(p[1].x, 1);
+        test_int(p[2].x, 4);
+        test_int(p[3].x, 5);
+        test_int(p[4].x, 6);
+    });
+}
+
 void Query_changed(void) {
     flecs::world world;
 
@@ -516,6 +516,8 @@ void Iterable_page_each(void);
 void Iterable_page_iter(void);
 void Iterable_worker_each(void);
 void Iterable_worker_iter(void);
+void Iterable_chunk_each(void);
+void Iterable_chunk_iter_aligned(void);
 
 // Testsuite 'Query'
 void Query_action(void);
@@ -612,6 +614,7 @@ void Query_optional_pair_term(void);
 void Query_empty_tables_each(void);
 void Query_empty_tables_each_w_entity(void);
 void Query_empty_tables_each_w_iter(void);
+void Query_sort_by_key(void);
 
 // Testsuite 'QueryBuilder'
 void QueryBuilder_builder_assign_same_type(void);
@@ -3355,6 +3358,14 @@ bake_test_case Iterable_testcases[] = {
     {
         "worker_iter",
         Iterable_worker_iter
+    },
+    {
+        "chunk_each",
+        Iterable_chunk_each
+    },
+    {
+        "chunk_iter_aligned",
+        Iterable_chunk_iter_aligned
     }
 };
 
@@ -3734,6 +3745,10 @@ bake_test_case Query_testcases[] = {
     {
         "empty_tables_each_w_iter",
         Query_empty_tables_each_w_iter
+    },
+    {
+        "sort_by_key",
+        Query_sort_by_key
     }
 };
 
@@ -6721,14 +6736,14 @@ static bake_test_suite suites[] = {
         "Iterable",
         NULL,
         NULL,
-        4,
+        6,
         Iterable_testcases
     },
     {
         "Query",
         NULL,
         NULL,
-        94,
+        95,
         Query_testcases
     },
     {